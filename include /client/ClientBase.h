@@ -4,19 +4,43 @@
 #include "common/Logger.h"
 #include <string>
 #include <memory>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
 
 namespace transport {
 
 class ClientBase {
 public:
+    // Odgovor na zahtjev iz tabele (nullptr -> konekcija pala prije odgovora)
+    using ResponseCallback = std::function<void(std::unique_ptr<Message>)>;
+
     ClientBase(const std::string& client_name);
     virtual ~ClientBase() = default;
     
     virtual bool connect(const std::string& server, int port) = 0;
     virtual void disconnect() = 0;
 
+    // Broj zahtjeva poslanih bez odgovora (pipelining na jednoj konekciji)
+    size_t pendingRequests() const;
+
 protected:
     virtual void handleMessage(std::unique_ptr<Message> message) = 0;
+
+    // Tabela zahtjeva u letu: server vraća sequence_id zahtjeva u odgovoru, pa više
+    // zahtjeva može čekati istovremeno. trackRequest dodjeljuje sequence_id i upisuje
+    // zahtjev PRIJE slanja (odgovor može stići prije nego što se send vrati).
+    std::future<std::unique_ptr<Message>> trackRequest(Message& request);
+    uint32_t trackRequest(Message& request, ResponseCallback callback);
+    // Odgovor sa poznatim sequence_id završava zahtjev (true); ostalo je nezatraženo
+    // (npr. MULTICAST_UPDATE sa sequence_id 0) i ostaje pozivaocu
+    bool completeRequest(std::unique_ptr<Message>& response);
+    // Pri prekidu konekcije: svi zahtjevi u letu dobijaju nullptr
+    void failPendingRequests();
+    void failRequest(uint32_t sequence_id);
     
     void logInfo(const std::string& message);
     void logError(const std::string& message);
@@ -24,6 +48,10 @@ protected:
 private:
     std::string client_name_;
     std::shared_ptr<Logger> logger_;
+
+    mutable std::mutex                             pending_mutex_;
+    std::unordered_map<uint32_t, ResponseCallback> pending_;
+    std::atomic<uint32_t>                          next_sequence_id_{0};
 };
 
 } // namespace transport
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace transport {
+
+// Perzistentan FIFO red na uređaju (store-and-forward): zapisi koji čekaju vezu prema
+// serveru. Fajl je memorijski mapiran i fiksne veličine (ring), pa memorija i disk ostaju
+// ograničeni; pun red odbija nove zapise.
+//
+// Fajl: [magic "TPQ1"][u32 verzija][u64 kapacitet] pa dva slota stanja na 64 i 96:
+//   [u64 seq][u64 head][u64 head_id][u32 crc32] - upis ide u stariji slot, važi ispravan sa većim seq
+// Podaci od 128: [u32 payload_len][u32 crc32][u64 id][payload] (poravnato na 8 B); zapis koji ne
+// stane do kraja fajla počinje ispočetka (marker 0xFFFFFFFF ili ostatak < 16 B se preskače).
+// append() je trajan kad se vrati (msync zapisa). Pri open() se zapisi od head-a provjeravaju
+// redom (CRC + uzastopni id); prvi neispravan je kraj reda (pokidan zadnji upis).
+class OfflineQueue {
+public:
+    struct Entry {
+        uint64_t             id{0};
+        std::vector<uint8_t> payload;
+    };
+
+    struct Stats {
+        size_t   records{0};
+        size_t   bytes_used{0};     // uključuje preskočene krajeve ringa
+        size_t   capacity{0};
+        uint64_t appended{0};
+        uint64_t popped{0};
+        uint64_t rejected_full{0};
+    };
+
+    OfflineQueue() = default;
+    ~OfflineQueue();
+
+    OfflineQueue(const OfflineQueue&) = delete;
+    OfflineQueue& operator=(const OfflineQueue&) = delete;
+
+    // capacity_bytes važi samo za nov fajl; postojeći zadržava svoj kapacitet
+    bool open(const std::string& path, size_t capacity_bytes = 1u << 20);
+    void close();
+    bool isOpen() const;
+
+    // id zapisa (0 -> red zatvoren, pun ili zapis veći od kapaciteta)
+    uint64_t append(const std::vector<uint8_t>& payload);
+    // Kopije najstarijih zapisa (najviše max_records), bez uklanjanja
+    std::vector<Entry> peek(size_t max_records) const;
+    // Uklanja count najstarijih zapisa (nakon potvrde servera); vraća broj uklonjenih
+    size_t pop(size_t count);
+
+    size_t      size() const;
+    bool        empty() const { return size() == 0; }
+    Stats       getStats() const;
+    std::string lastError() const;
+
+private:
+    static constexpr size_t   kHeaderSize       = 128;
+    static constexpr size_t   kSlotOffset[2]    = {64, 96};
+    static constexpr size_t   kRecordHeaderSize = 16;
+    static constexpr uint32_t kVersion          = 1;
+    static constexpr uint32_t kWrapMarker       = 0xFFFFFFFFu;
+
+    uint8_t* data() const { return map_ + kHeaderSize; }
+    // Zapis na logičkoj poziciji pos (nakon preskakanja kraja ringa); false -> nema ispravnog
+    bool recordAt(uint64_t& pos, uint64_t limit, uint64_t expected_id, size_t& length) const;
+    bool readSlotsLocked();
+    void writeSlotLocked();
+    void recoverLocked();
+    void syncLocked(size_t offset, size_t length);
+    void closeLocked();
+
+    mutable std::mutex mutex_;
+    std::string        path_;
+    int                fd_{-1};
+    uint8_t*           map_{nullptr};
+    size_t             map_size_{0};
+    size_t             capacity_{0};      // bajtova u području podataka
+
+    // Logičke pozicije rastu monotono (fizička = pos % capacity_)
+    uint64_t    head_{0};
+    uint64_t    tail_{0};
+    uint64_t    head_id_{1};
+    uint64_t    next_id_{1};
+    uint64_t    slot_seq_{0};
+    size_t      records_{0};
+    std::string last_error_;
+
+    uint64_t appended_{0};
+    uint64_t popped_{0};
+    uint64_t rejected_full_{0};
+};
+
+} // namespace transport
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ClientBase.h"
+#include "OfflineQueue.h"
 #include "common/Message.h"
 #include "common/Logger.h"
 #include "common/TLSSocket.h"
@@ -9,18 +10,47 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <future>
+#include <mutex>
+#include <condition_variable>
 
 namespace transport {
 
 class PaymentDevice : public ClientBase {
 public:
     PaymentDevice();
-    ~PaymentDevice() = default;
+    ~PaymentDevice() override;
     
     // Uspostavlja TLS konekciju preko TLSSocket (Boost.Asio ispod haube)
     bool connect(const std::string& server, int port) override;
     void disconnect() override;
 
+    // Najveća verzija enkodiranja koju uređaj nudi pri connect-u (V2 = kompaktni TLV,
+    // bitno na mjerenim mobilnim linkovima). V1 preskače CONNECT razmjenu.
+    void setPreferredProtocolVersion(uint16_t version) { preferred_version_ = version; }
+    uint16_t getProtocolVersion() const { return socket_ ? socket_->getProtocolVersion() : PROTOCOL_V1; }
+
+    // Pipelining: zahtjev dobija sequence_id i šalje se odmah, bez čekanja odgovora
+    // na prethodne (auth/reserve/purchase se preklapaju na linku s velikim RTT-om).
+    // RX nit uparuje odgovore po sequence_id; nullptr -> slanje palo ili prekid konekcije.
+    std::future<std::unique_ptr<Message>> sendRequest(std::unique_ptr<Message> request);
+    bool sendRequest(std::unique_ptr<Message> request, ResponseCallback callback);
+
+    void setDeviceUri(const std::string& uri) { device_uri_ = uri; }
+
+    // Store-and-forward: kupovine koje ne stignu do servera (nema veze ili veza padne prije
+    // odgovora) čuvaju se u lokalnom redu (OfflineQueue) i šalju u BATCH porukama nakon connect-a.
+    // Svaka kupovina dobija idempotency_key, pa server ponovljenu kupovinu ne naplati dvaput.
+    bool enableOfflineQueue(const std::string& path, size_t capacity_bytes = 1u << 20);
+    // PURCHASE_TICKET: odgovor servera, ili uspjeh sa queued=1 kad je zahtjev u redu;
+    // nullptr -> nije poslan ni upisan (red isključen ili pun)
+    std::future<std::unique_ptr<Message>> submitPurchase(std::unique_ptr<Message> purchase);
+    // Šalje red redom u BATCH porukama; stavka se uklanja kad server da konačan status (< 500,
+    // osim 425). Staje na prekidu veze ili prvoj stavci za ponavljanje. Vraća broj uklonjenih
+    // stavki. connect() ga pokreće u pozadinskoj niti i ponavlja ostatak sa rastućim razmakom.
+    size_t drainOfflineQueue(size_t max_batch = 64);
+    size_t offlineQueueSize() const { return queue_ ? queue_->size() : 0; }
+
 protected:
     // Aplikativna obrada primljenih poruka
     void handleMessage(std::unique_ptr<Message> message) override;
@@ -28,9 +58,14 @@ protected:
 private:
     // RX petlja (blokirajuće čitanje poruka u posebnoj niti)
     void receiveLoop_();
+    void drainLoop_();
+    void negotiateProtocol_();
+    std::string nextIdempotencyKey_();
+    bool enqueueOffline_(const std::vector<uint8_t>& frame);
 
     std::string device_uri_;
     std::string vehicle_type_;
+    uint16_t    preferred_version_{PROTOCOL_MAX_VERSION};
 
     // TLS kanal (Boost.Asio ispod TLSSocket-a)
     std::unique_ptr<TLSSocket> socket_;
@@ -38,6 +73,14 @@ private:
     // Reader nit i flag
     std::unique_ptr<std::thread> rx_thread_;
     std::atomic<bool> running_{false};
+
+    // Kupovine koje čekaju vezu; drain_mutex_: jedan drain u isto vrijeme (red je FIFO)
+    std::unique_ptr<OfflineQueue> queue_;
+    std::mutex                    drain_mutex_;
+    std::unique_ptr<std::thread>  drain_thread_;
+    std::mutex                    drain_wait_mutex_;   // running_ = false budi drain_cv_
+    std::condition_variable       drain_cv_;
+    std::atomic<uint32_t>         key_counter_{0};
 };
 
 } // namespace transport
@@ -3,6 +3,8 @@
 #include "common/TLSSocket.h"
 #include "common/Message.h"
 #include "common/Logger.h"
+#include "common/VehicleStatus.h"
+#include "common/PriceCache.h"
 
 #include <string>
 #include <memory>
@@ -28,6 +30,19 @@ private:
     std::string session_token_;
     std::string current_urn_;
     bool authenticated_{false};
+
+    // UDP data plane (parametri iz AUTH odgovora; prazan ključ -> server ga nema uključenog)
+    std::string mcast_group_;
+    int         mcast_port_{0};
+    std::string mcast_key_;
+    uint64_t    mcast_seq_{0};
+
+    // Zadnje stanje vozila; ponovni 'status' za iste rute traži samo deltu od verzije
+    VehicleStatusView status_view_;
+    std::string       status_routes_;
+
+    // Lokalna kopija cjenovnika, osvježava se iz "price_updated" update-a
+    PriceCache prices_;
     
     // help + postojeći handleri
     void showHelp();
@@ -38,6 +53,13 @@ private:
     void handlePurchase(const std::string& input);
     void handleCreateGroup(const std::string& input);
     void handleListen(const std::string& input);
+    void handleListenMcast(const std::string& input);
+    // Propušteni datagrami [from, to] preko TLS-a; vraća broj ponovo primljenih update-a
+    size_t requestResync(uint64_t from_seq, uint64_t to_seq);
+    void handleStatus(const std::string& input);
+    void printStatus(const Message& status);
+    // Primijeni "price_updated" na lokalni cjenovnik i ispiši novu cijenu
+    void applyPriceUpdate(const Message& update);
 
     // NOVO: komande za članove grupe (lider)
     void handleAddMember(const std::string& input);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace transport {
+
+// Reciklirani bajt baferi za okvire: acquire() vraća prazan bafer sa kapacitetom
+// prethodnog korisnika, release() ga vraća (preveliki ili višak se oslobađaju).
+// Instanca nije thread-safe: štiti je vlasnik (npr. konekcija svojim tx mutex-om),
+// a local() je zaseban pool svake niti.
+class BufferPool {
+public:
+    explicit BufferPool(size_t max_buffers = 16, size_t max_capacity = 64 * 1024)
+        : max_buffers_(max_buffers), max_capacity_(max_capacity) {}
+
+    static BufferPool& local();
+
+    std::vector<uint8_t> acquire();
+    void                 release(std::vector<uint8_t>&& buffer);
+
+    size_t   size() const   { return free_.size(); }
+    uint64_t reused() const { return reused_; }
+
+private:
+    size_t                            max_buffers_;
+    size_t                            max_capacity_;
+    std::vector<std::vector<uint8_t>> free_;
+    uint64_t                          reused_{0};
+};
+
+} // namespace transport
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace transport {
+
+// Zajednički sat procesa:
+// - timestamp(): "YYYY-mm-dd HH:MM:SS" (lokalno vrijeme) tekuće sekunde. localtime/strftime
+//   se rade jednom po sekundi za cijeli proces; ostali pozivi kopiraju objavljeni bafer
+//   (seqlock nad atomic riječima: čitaoci bez brave, pisac ne čeka čitaoce)
+// - monotonicNanos(): steady_clock u ns, za mjerenja trajanja (metrike, tracing)
+class ClockService {
+public:
+    static constexpr size_t kTimestampLength = 19;
+
+    static std::string timestamp();
+    static void        formatTimestamp(char* out);                  // kTimestampLength znakova, bez '\0'
+    static void        formatTimestamp(std::time_t sec, char* out); // zadana sekunda (npr. vrijeme zapisa loga)
+    static std::time_t seconds() { return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()); }
+
+    static uint64_t monotonicNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    static uint64_t nanosSince(uint64_t start) { return monotonicNanos() - start; }
+
+    static uint64_t formatCount();   // broj stvarnih localtime/strftime formatiranja (testovi)
+};
+
+} // namespace transport
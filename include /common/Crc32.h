@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace transport {
+
+// CRC-32 (IEEE 802.3, poly 0xEDB88320) — isti checksum koji Message šalje na žici.
+// compute()/update() biraju najbržu implementaciju jednom, pri prvom pozivu:
+//   - ARMv8 CRC32 instrukcije (aarch64, ako ih CPU prijavi kroz HWCAP)
+//   - slicing-by-8 tabele (8 bajtova po iteraciji) na svim ostalim platformama
+// SSE4.2 crc32 računa CRC-32C (drugi polinom) pa nije kompatibilan sa postojećim okvirima.
+class Crc32 {
+public:
+    static uint32_t compute(const uint8_t* data, size_t size) { return update(0, data, size); }
+
+    // Nastavak nad sljedećim dijelom: update(update(0, a), b) == compute(a+b)
+    static uint32_t update(uint32_t crc, const uint8_t* data, size_t size);
+
+    // CRC spoja bez čitanja bajtova: combine(compute(a), compute(b), b.size()) == compute(a+b).
+    // shiftFactor(n) se može izračunati unaprijed za poznatu dužinu (npr. statični dio okvira)
+    static uint32_t combine(uint32_t crc_a, uint32_t crc_b, size_t size_b) {
+        return combineFactor(crc_a, crc_b, shiftFactor(size_b));
+    }
+    static uint32_t shiftFactor(size_t size);
+    static uint32_t combineFactor(uint32_t crc_a, uint32_t crc_b, uint32_t factor);
+
+    // Pojedinačne implementacije (benchmark / testovi)
+    static uint32_t bitwise(const uint8_t* data, size_t size);
+    static uint32_t slicing8(const uint8_t* data, size_t size);
+    static uint32_t hardware(const uint8_t* data, size_t size); // == slicing8 ako HW nije dostupan
+
+    static bool        hasHardware();
+    static const char* implementation();
+};
+
+} // namespace transport
@@ -8,6 +8,11 @@
 #include <condition_variable>
 #include <algorithm>
 #include <optional>    
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <functional>
 #include <sqlite3.h>
 #include "Message.h"
 
@@ -44,6 +49,17 @@ struct Vehicle {
     std::string last_update;
 };
 
+// Jedna stavka grupne admin izmjene (BULK_UPDATE_VEHICLES); prazna polja se ne diraju.
+// available_seats bez capacity nije dozvoljeno; capacity bez available_seats -> puno vozilo prazno.
+struct VehicleUpdate {
+    std::string                uri;
+    std::optional<bool>        active;
+    std::optional<std::string> route;
+    std::optional<VehicleType> type;
+    std::optional<int>         capacity;
+    std::optional<int>         available_seats;
+};
+
 struct Ticket {
     std::string ticket_id;
     std::string user_urn;
@@ -66,6 +82,22 @@ struct Payment {
     bool        successful;
 };
 
+// Jedna kupovina (karte + plaćanje) za purchaseTicketsBatch
+struct TicketPurchase {
+    std::vector<Ticket> tickets;
+    Payment             payment;
+};
+
+// Zadnje stanje vozila iz telemetrije (tabela vehicle_telemetry, upis ograničen intervalom)
+struct VehicleTelemetry {
+    std::string uri;
+    int         occupancy{0};
+    int32_t     lat_e6{0};
+    int32_t     lon_e6{0};
+    uint64_t    sample_ms{0};   // vrijeme zadnjeg uzorka (vozilo)
+    uint64_t    samples{0};     // ukupno primljenih uzoraka
+};
+
 struct PriceList {
     VehicleType vehicle_type;
     TicketType  ticket_type;
@@ -75,6 +107,21 @@ struct PriceList {
     std::string last_update;
 };
 
+// =========================
+//   Connection options
+// =========================
+// PRAGMA podešavanja koja se primjenjuju na svaku konekciju ([database] u server.conf)
+struct DatabaseOptions {
+    bool        wal_mode{false};          // journal_mode = WAL (inače DELETE)
+    std::string synchronous;              // OFF | NORMAL | FULL | EXTRA ("" = SQLite default)
+    int         cache_size{0};            // >0 broj stranica, <0 KiB, 0 = SQLite default
+    int         busy_timeout_ms{5000};    // čekanje na zaključavanje prije SQLITE_BUSY
+    int64_t     mmap_size{0};             // bajta memorijski mapiranog I/O (0 = isključeno)
+    std::string temp_store;               // DEFAULT | FILE | MEMORY ("" = SQLite default)
+    int         wal_autocheckpoint{1000}; // stranice; 0 = checkpoint radi pozadinski task
+    bool        create_schema{true};      // CREATE TABLE/INDEX IF NOT EXISTS pri otvaranju
+};
+
 // =========================
 //       Database
 // =========================
@@ -83,7 +130,7 @@ public:
     Database();
     ~Database();
 
-    bool initialize(const std::string& db_path);
+    bool initialize(const std::string& db_path, const DatabaseOptions& options = {});
     void close();
     bool isOpen() const { return db_ != nullptr; }
 
@@ -96,12 +143,26 @@ public:
     bool                     registerUser(const User& user);
     bool                     updateUser(const User& user);
     bool                     deleteUser(const std::string& urn);
+    // nullptr i za nepoznat URN i za grešku; greška ostavlja getLastErrorCode() != 0
     std::unique_ptr<User>    getUser(const std::string& urn);
     std::vector<User>        getAllUsers();
     bool                     authenticateUser(const std::string& urn, const std::string& pin);
 
+    // Čitanje velikih tabela po stranicama (keyset): redovi sa ključem > after ("" -> od
+    // početka), rastuće po primarnom ključu, najviše limit. Sljedeća stranica počinje od
+    // ključa zadnjeg reda. db_mutex_ se drži samo za jednu stranicu.
+    std::vector<User>    getUsersPage(const std::string& after_urn, size_t limit);
+    std::vector<Ticket>  getTicketsPage(const std::string& after_ticket_id, size_t limit);
+    std::vector<Payment> getPaymentsPage(const std::string& after_transaction_id, size_t limit);
+
+    // Prolaz kroz cijelu tabelu stranicu po stranicu; visit vraća false -> kraj.
+    // Između stranica konekcija je slobodna za druge upite. Vraća broj posjećenih redova.
+    size_t forEachUser(const std::function<bool(const User&)>& visit, size_t page_size = 512);
+    size_t forEachTicket(const std::function<bool(const Ticket&)>& visit, size_t page_size = 512);
+    size_t forEachPayment(const std::function<bool(const Payment&)>& visit, size_t page_size = 512);
+
     // Groups (by id) 
-    bool                  createGroup(const Group& group);
+    bool                  createGroup(const Group& group, int* group_id = nullptr);   // id nove grupe
     bool                  updateGroup(const Group& group);
     bool                  deleteGroup(int group_id);
     bool                  addGroupMember(int group_id, const std::string& member_urn);
@@ -114,6 +175,12 @@ public:
     std::string getGroupLeader(const std::string& group_name);
     bool        addUserToGroup(const std::string& urn, const std::string& group_name);
     bool        removeUserFromGroup(const std::string& urn, const std::string& group_name);
+    // Aktivna grupa sa aktivnim članovima (dva upita); nullptr ako ne postoji
+    std::unique_ptr<Group> getGroupByName(const std::string& group_name);
+    // Svi članovi u jednoj transakciji, jedan iskaz po članu (provjera korisnika i
+    // upis/reaktivacija zajedno); prvi nepostojeći korisnik (SQLITE_NOTFOUND) ili
+    // već aktivan član (SQLITE_CONSTRAINT) poništava cijelu grupu izmjena
+    bool        addUsersToGroup(int group_id, const std::vector<std::string>& urns);
 
     // Vehicles
     bool                      registerVehicle(const Vehicle& vehicle);
@@ -122,8 +189,21 @@ public:
     std::unique_ptr<Vehicle>  getVehicle(const std::string& uri);
     std::vector<Vehicle>      getVehiclesByType(VehicleType type);
     std::vector<Vehicle>      getAllVehicles();
+    // Broj redova i MAX(rowid) tabele vehicles (provjera da snimak inventara odgovara bazi)
+    bool                      getVehicleTableStats(size_t& rows, int64_t& max_rowid);
     bool                      updateSeatAvailability(const std::string& uri, int available_seats);
+    bool                      updateSeatAvailabilityBatch(const std::vector<std::pair<std::string, int>>& seats);
+    // Trenutna slobodna mjesta vozila (npr. iz SeatInventory); < 0 -> red se ne dira
+    using SeatCount = std::function<int(const std::string& uri)>;
+    // Kao gore, ali se vrijednosti čitaju tek pod write lock-om (BEGIN IMMEDIATE): od dva
+    // upisa istog vozila zadnji commit nosi i noviju vrijednost brojača
+    bool                      updateSeatAvailabilityBatch(const std::vector<std::string>& uris, const SeatCount& current);
+    // Telemetrija: INSERT OR REPLACE svih redova u jednom commit-u
+    bool                      upsertVehicleTelemetryBatch(const std::vector<VehicleTelemetry>& rows);
+    std::unique_ptr<VehicleTelemetry> getVehicleTelemetry(const std::string& uri);
     std::unique_ptr<Vehicle>  getVehicleByRouteAndType(const std::string& route, VehicleType type);
+    // Bilo koji tip na ruti; prednost: traženi tip, aktivno, sa slobodnim mjestima
+    std::unique_ptr<Vehicle>  getVehicleByRoute(const std::string& route, VehicleType preferred);
 
     // Tickets
     bool                    createTicket(const Ticket& ticket);
@@ -133,6 +213,24 @@ public:
     std::vector<Ticket>     getUserTickets(const std::string& urn);
     std::vector<Ticket>     getActiveTickets();
 
+    // Kupovina u jednoj BEGIN IMMEDIATE transakciji: uslovno skidanje mjesta,
+    // multi-row INSERT karata i zapis plaćanja (jedan commit). seat_number se
+    // popunjava u `tickets`. Greške: SQLITE_NOTFOUND (vozilo), SQLITE_FULL (mjesta).
+    // update_seats=false: mjesta (i seat_number) već vodi SeatInventory, upisuju se samo karte/plaćanje.
+    bool purchaseTickets(const std::string& vehicle_uri, std::vector<Ticket>& tickets,
+                         const Payment& payment, int* available_after = nullptr,
+                         bool update_seats = true);
+    // Mjesta vodi SeatInventory, ali brojač ide u istu transakciju: karte, plaćanje i
+    // available_seats = current(vehicle_uri), pročitano pod write lock-om
+    bool purchaseTickets(const std::string& vehicle_uri, std::vector<Ticket>& tickets,
+                         const Payment& payment, const SeatCount& current);
+    // Više kupovina u jednoj BEGIN IMMEDIATE transakciji (sve ili ništa, jedan commit);
+    // mjesta i seat_number već vodi SeatInventory (kao update_seats=false). Uz 'current'
+    // se u istoj transakciji upišu i brojači vozila iz seat_uris
+    bool purchaseTicketsBatch(const std::vector<TicketPurchase>& purchases,
+                              const std::vector<std::string>& seat_uris = {},
+                              const SeatCount& current = nullptr);
+
     // Payments
     bool                       recordPayment(const Payment& payment);
     bool                       updatePayment(const Payment& payment);
@@ -164,6 +262,10 @@ public:
     bool        restore(const std::string& backup_path);
     std::string getDatabaseInfo();
 
+    // WAL checkpoint (PASSIVE ne blokira čitaoce/pisce; truncate skraćuje -wal fajl)
+    bool        checkpoint(bool truncate = false, int* wal_frames = nullptr, int* checkpointed = nullptr);
+    std::string getPragma(const std::string& name);   // npr. "journal_mode" -> "wal"
+
     // ===== DODANO: admin helperi koje zove CentralServer =====
     bool updatePrice(VehicleType vehicle_type, TicketType ticket_type, double price);
     bool updateVehicle(const std::string& uri,
@@ -172,6 +274,21 @@ public:
                        std::optional<VehicleType> type = {});
     bool updateVehicleCapacity(const std::string& uri, int capacity, int available_seats);
 
+    // Grupne admin izmjene u jednoj BEGIN IMMEDIATE transakciji (sve ili ništa, jedan commit).
+    // Nepostojeće vozilo -> SQLITE_NOTFOUND i rollback cijelog batch-a.
+    bool updateVehiclesBatch(const std::vector<VehicleUpdate>& updates);
+    bool updatePricesBatch(const std::vector<PriceList>& prices);   // base_price po (vozilo, karta)
+
+    // Prepared-statement cache (po konekciji, ključ = SQL tekst)
+    struct StatementCacheStats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t invalidations{0};
+        size_t   cached{0};
+    };
+    StatementCacheStats getStatementCacheStats();
+    void                clearStatementCache();
+
     // Errors
     std::string getLastError() const { return last_error_; }
     int         getLastErrorCode() const { return last_error_code_; }
@@ -182,10 +299,27 @@ private:
     std::string last_error_;
     int         last_error_code_{0};
 
+    // Statement cache: pripremljeni iskazi se ne finalizuju nakon upotrebe,
+    // nego resetuju i vraćaju u keš (vidi prepareStatement/releaseStatement)
+    struct CachedStatement {
+        sqlite3_stmt* stmt{nullptr};
+        bool          in_use{false};
+        std::chrono::steady_clock::time_point started{};   // prepare -> release (tp_db_statement_seconds)
+    };
+    static constexpr size_t kMaxCachedStatements = 128;
+    std::unordered_map<std::string, CachedStatement> stmt_cache_;
+    uint64_t stmt_hits_{0};
+    uint64_t stmt_misses_{0};
+    uint64_t stmt_invalidations_{0};
+
     // Internals
     bool createTables();
+    bool applyOptions(const DatabaseOptions& options);
+    std::string queryPragma(const std::string& pragma);
     bool executeSQL(const std::string& sql);
     bool prepareStatement(const std::string& sql, sqlite3_stmt** stmt);
+    void releaseStatement(sqlite3_stmt* stmt);
+    void finalizeCachedStatements();
     void setLastError(const std::string& error, int code = -1);
     std::string hashPassword(const std::string& password);
     bool verifyPassword(const std::string& password, const std::string& hash);
@@ -199,16 +333,26 @@ private:
     std::string getPaymentsTableSQL();
     std::string getPriceListTableSQL();
     std::string getActiveConnectionsTableSQL();
+    std::string getVehicleIndexesSQL();
+    std::string getVehicleTelemetryTableSQL();
 
     // Row extractors
     User      extractUser(sqlite3_stmt* stmt);
     Group     extractGroup(sqlite3_stmt* stmt);
+
+    template <typename Row>
+    std::vector<Row> fetchPage(const std::string& sql, const std::string& after, size_t limit,
+                               Row (Database::*extract)(sqlite3_stmt*));
     Vehicle   extractVehicle(sqlite3_stmt* stmt);
     Ticket    extractTicket(sqlite3_stmt* stmt);
     Payment   extractPayment(sqlite3_stmt* stmt);
     PriceList extractPriceList(sqlite3_stmt* stmt);
 
     // Helpers
+    // INSERT karata i plaćanja unutar već otvorene transakcije (db_mutex_ zaključan)
+    bool insertPurchaseRows(const std::vector<Ticket>& tickets, const Payment& payment);
+    // available_seats = current(uri) za svako vozilo, u već otvorenoj transakciji
+    bool writeSeatCounts(const std::vector<std::string>& uris, const SeatCount& current);
     int  getGroupIdByName(const std::string& group_name);
     bool userExists(const std::string& urn);
 };
@@ -216,22 +360,123 @@ private:
 // =========================
 //     DatabasePool
 // =========================
+// Slobodne konekcije su na lock-free steku (indeksi + ABA tag u jednom atomiku);
+// mutex/cv se koriste samo kad je pool prazan. Uz thread affinity konekcija se
+// nakon lease-a "parkira" za tu nit (ne vraća se na stek) pa je ista nit
+// sljedeći put dobije bez CAS-a na zajedničkoj glavi; druge niti mogu ukrasti
+// parkiranu konekciju kad je stek prazan.
+// Svaka inicijalizacija pravi novi set slotova; zakup drži referencu na svoj set,
+// pa stari set živi dok se i posljednji zakup ne vrati (shutdown/re-init ne čekaju).
 class DatabasePool {
+    struct SlotSet;
+
 public:
+    // RAII zakup konekcije: destruktor je vraća u pool (i na ranim return-ovima)
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept { *this = std::move(other); }
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&)            = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        Database* operator->() const { return db_.get(); }
+        Database& operator*()  const { return *db_; }
+        Database* get()        const { return db_.get(); }
+        explicit operator bool() const { return db_ != nullptr; }
+
+        void release();
+
+    private:
+        friend class DatabasePool;
+        Lease(DatabasePool* pool, SlotSet* set, std::shared_ptr<Database> db, uint32_t slot)
+            : pool_(pool), set_(set), db_(std::move(db)), slot_(slot) {}
+
+        DatabasePool*             pool_{nullptr};
+        SlotSet*                  set_{nullptr};     // referenca u set_->refs
+        std::shared_ptr<Database> db_;
+        uint32_t                  slot_{0};
+    };
+
+    struct Stats {
+        uint64_t acquisitions{0};
+        uint64_t waits{0};            // zakupi koji su morali čekati na slobodnu konekciju
+        uint64_t total_wait_us{0};
+        uint64_t max_wait_us{0};
+        uint64_t affinity_hits{0};    // nit je dobila svoju parkiranu konekciju
+        uint64_t steals{0};           // uzeta tuđa parkirana konekcija
+        size_t   size{0};
+    };
+
     static DatabasePool& getInstance();
 
-    bool                         initialize(const std::string& db_path, int pool_size = 5);
+    bool                         initialize(const std::string& db_path, int pool_size = 5,
+                                            const DatabaseOptions& options = {});
+    Lease                        acquire();
+    void                         shutdown();
+
+    // Stari API (shared_ptr + ručni povrat), zadržan radi postojećih poziva
     std::shared_ptr<Database>    getConnection();
     void                         returnConnection(std::shared_ptr<Database> db);
-    void                         shutdown();
+
+    void  setThreadAffinity(bool enabled) { thread_affinity_ = enabled; }
+    bool  getThreadAffinity() const { return thread_affinity_; }
+    Stats getStats() const;
 
 private:
-    std::vector<std::shared_ptr<Database>> connections_;
-    std::vector<bool>                      available_;
-    std::mutex                             pool_mutex_;
-    std::condition_variable                pool_cv_;
-    std::string                            db_path_;
-    bool                                   initialized_{false};
+    enum SlotState : uint8_t { SLOT_FREE = 0, SLOT_IN_USE = 1, SLOT_PARKED = 2 };
+
+    struct Slot {
+        std::shared_ptr<Database> db;
+        std::atomic<uint8_t>      state{SLOT_FREE};
+        std::atomic<uint32_t>     next{0};      // sljedeći na steku (indeks+1, 0 = kraj)
+    };
+
+    // Jedna generacija pool-a; briše je onaj ko spusti refs na 0 (pool drži jednu
+    // referencu dok je set tekući, svaki zakup i pin po jednu)
+    struct SlotSet {
+        std::unique_ptr<Slot[]>                       slots;
+        size_t                                        count{0};
+        uint64_t                                      generation{0};
+        std::unordered_map<const Database*, uint32_t> slot_of;       // za returnConnection(shared_ptr)
+        std::atomic<uint64_t>                         free_head{0};  // [tag:32 | indeks+1:32]
+        std::atomic<uint32_t>                         parked{0};     // broj SLOT_PARKED slotova
+        std::atomic<uint32_t>                         steal_cursor{0};  // krađa kreće iza zadnje ukradene
+        std::atomic<int>                              refs{1};
+    };
+
+    SlotSet* pinCurrent();                       // tekući set sa referencom ili nullptr
+    void     unpin(SlotSet* set);
+    void     unpinLocked(SlotSet* set);          // pozivalac drži pool_mutex_
+    void     retireCurrent(SlotSet* next);       // pozivalac drži pool_mutex_
+    bool     tryAcquireSlot(SlotSet& set, uint32_t& slot);
+    bool     releaseSlot(SlotSet& set, uint32_t slot);   // false: slot nije bio zauzet
+    static void pushFree(SlotSet& set, uint32_t slot);
+    static bool popFree(SlotSet& set, uint32_t& slot);
+    void     recordWait(uint64_t us);
+
+    std::atomic<SlotSet*>                   current_{nullptr};
+    std::atomic<int>                        pinning_{0};      // niti između load-a current_ i refs++
+    std::vector<SlotSet*>                   retired_;         // pod pool_mutex_, čekaju povrat zakupa
+    std::atomic<size_t>                     slot_count_{0};
+    std::atomic<uint64_t>                   generation_{0};
+    std::atomic<bool>                       thread_affinity_{false};
+
+    std::mutex                              pool_mutex_;      // init/shutdown + čekanje
+    std::condition_variable                 pool_cv_;
+    std::atomic<int>                        waiters_{0};
+
+    // Metrike
+    std::atomic<uint64_t>                   acquisitions_{0};
+    std::atomic<uint64_t>                   waits_{0};
+    std::atomic<uint64_t>                   total_wait_us_{0};
+    std::atomic<uint64_t>                   max_wait_us_{0};
+    std::atomic<uint64_t>                   affinity_hits_{0};
+    std::atomic<uint64_t>                   steals_{0};
+
+    std::string                             db_path_;
+    bool                                    initialized_{false};
 
     DatabasePool()  = default;
     ~DatabasePool() { shutdown(); }
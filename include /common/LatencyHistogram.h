@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace transport {
+
+// Log-linearni histogram latencija (HDR stil): 32 linearna pod-bucketa po stepenu dvojke,
+// pa je greška percentila najviše ~3% u cijelom opsegu (1 ns .. ~18 min, veće se sabija
+// u zadnji bucket). record() je lock-free (relaxed atomici) i sigurno iz više niti;
+// percentili se računaju nad snapshot()-om koji se može i sabirati (merge).
+class LatencyHistogram {
+public:
+    static constexpr int    kSubBucketBits = 5;
+    static constexpr size_t kSubBuckets    = size_t{1} << kSubBucketBits;
+    static constexpr int    kMaxExponent   = 39;   // 2^40 ns
+    static constexpr size_t kBuckets       = kSubBuckets * (kMaxExponent - kSubBucketBits + 2);
+
+    struct Snapshot {
+        std::vector<uint64_t> counts;   // kBuckets (prazno dok se ništa ne zabilježi)
+        uint64_t count{0};
+        uint64_t sum{0};
+        uint64_t min{0};
+        uint64_t max{0};
+
+        void     merge(const Snapshot& other);
+        // q u [0, 1]; gornja granica bucketa (ne veća od max), 0 ako je prazan
+        uint64_t percentile(double q) const;
+        double   mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+    };
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void     record(uint64_t value);
+    Snapshot snapshot() const;
+    void     reset();
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    static size_t   bucketOf(uint64_t value);
+    static uint64_t upperBound(size_t bucket);   // najveća vrijednost koja pada u bucket
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
+};
+
+} // namespace transport
@@ -6,9 +6,45 @@
 #include <memory>
 #include <chrono>
 #include <map>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <type_traits>
 
 namespace transport {
 
+struct LogSink;   // fajl (+ rotacija) jednog Logger-a, vidi Logger.cpp
+
+namespace log_detail {
+
+// Bafer po niti za logf(); kapacitet ostaje između poziva
+std::string& threadBuffer();
+
+inline void append(std::string& out, std::string_view v) { out.append(v.data(), v.size()); }
+inline void append(std::string& out, const std::string& v) { out += v; }
+inline void append(std::string& out, const char* v) { out += (v ? v : "(null)"); }
+inline void append(std::string& out, char v) { out += v; }
+inline void append(std::string& out, bool v) { out += (v ? "true" : "false"); }
+
+template <typename T>
+void append(std::string& out, const T& v) {
+    if constexpr (std::is_enum_v<T>) {
+        out += std::to_string(static_cast<std::underlying_type_t<T>>(v));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        char buf[32];
+        const int n = std::snprintf(buf, sizeof(buf), "%g", static_cast<double>(v));
+        if (n > 0) out.append(buf, static_cast<size_t>(n));
+    } else {
+        static_assert(std::is_integral_v<T>, "logf: unsupported argument type");
+        out += std::to_string(v);
+    }
+}
+
+} // namespace log_detail
+
+// Pozivaoci samo stave poruku u zajednički lock-free red; formatiranje, vrijeme,
+// konzola i fajl se rade na jednoj pozadinskoj niti, u batch-evima.
 class Logger {
 public:
     enum class LogLevel {
@@ -19,35 +55,80 @@ public:
         CRITICAL = 4
     };
 
+    // Pun red: BLOCK čeka writer nit, DROP odbaci poruku (broji se u droppedMessages)
+    enum class OverflowPolicy { BLOCK, DROP };
+
+    struct AsyncOptions {
+        bool           enabled{true};
+        size_t         queue_size{8192};     // zaokruži se na stepen dvojke; važi prije prve poruke
+        OverflowPolicy overflow{OverflowPolicy::BLOCK};
+    };
+
     Logger(const std::string& name = "Logger");
     ~Logger();
 
     bool initialize(const std::string& log_file = "", LogLevel level = LogLevel::INFO);
     void setLogLevel(LogLevel level) { log_level_ = level; }
     void setLogFile(const std::string& log_file);
-    
+    // max_bytes == 0 -> bez rotacije; inače log -> log.1 -> ... -> log.<max_files>
+    void setRotation(uint64_t max_bytes, int max_files);
+
     void debug(const std::string& message);
     void info(const std::string& message);
     void warning(const std::string& message);
     void error(const std::string& message);
     void critical(const std::string& message);
-    
+
     void log(LogLevel level, const std::string& message);
-    
+
+    bool isEnabled(LogLevel level) const { return level >= log_level_.load(std::memory_order_relaxed); }
+
+    // Dijelovi poruke se spajaju (u bafer niti) tek ako je nivo uključen;
+    // za izbjegavanje i same evaluacije argumenata koristi TP_LOG_* makroe
+    template <typename... Args>
+    void logf(LogLevel level, const Args&... args) {
+        if (!isEnabled(level)) return;
+        std::string& buf = log_detail::threadBuffer();
+        buf.clear();
+        (log_detail::append(buf, args), ...);
+        log(level, buf);
+    }
+
     static std::shared_ptr<Logger> getLogger(const std::string& name);
 
+    // Globalno za sve Logger-e u procesu
+    static void     configureAsync(const AsyncOptions& options);
+    static void     setConsoleOutput(bool on);
+    static void     flush();                 // čeka da sve dosad predate poruke budu zapisane
+    static uint64_t droppedMessages();
+
 private:
     std::string name_;
-    LogLevel log_level_;
-    std::unique_ptr<std::ofstream> file_stream_;
+    std::atomic<LogLevel> log_level_;
+    std::shared_ptr<LogSink> sink_;          // zamjena preko std::atomic_store (setLogFile)
     std::mutex log_mutex_;
-    
-    std::string formatMessage(LogLevel level, const std::string& message);
-    std::string getCurrentTimestamp();
-    std::string levelToString(LogLevel level);
-    
+
     static std::map<std::string, std::shared_ptr<Logger>> loggers_;
     static std::mutex loggers_mutex_;
 };
 
 } // namespace transport
+
+// Nivoi ispod TRANSPORT_LOG_MIN_LEVEL (0 = DEBUG ... 4 = CRITICAL) se ne prevode;
+// ostali provjere nivo prije evaluacije argumenata. 'logger' je (shared_)ptr na Logger.
+#ifndef TRANSPORT_LOG_MIN_LEVEL
+#define TRANSPORT_LOG_MIN_LEVEL 0
+#endif
+
+#define TP_LOG(logger, level, ...)                                                  \
+    do {                                                                            \
+        if (static_cast<int>(level) >= TRANSPORT_LOG_MIN_LEVEL) {                   \
+            const auto& tp_log_ = (logger);                                         \
+            if (tp_log_ && tp_log_->isEnabled(level)) tp_log_->logf(level, __VA_ARGS__); \
+        }                                                                           \
+    } while (0)
+
+#define TP_LOG_DEBUG(logger, ...) TP_LOG(logger, ::transport::Logger::LogLevel::DEBUG, __VA_ARGS__)
+#define TP_LOG_INFO(logger, ...)  TP_LOG(logger, ::transport::Logger::LogLevel::INFO, __VA_ARGS__)
+#define TP_LOG_WARN(logger, ...)  TP_LOG(logger, ::transport::Logger::LogLevel::WARNING, __VA_ARGS__)
+#define TP_LOG_ERROR(logger, ...) TP_LOG(logger, ::transport::Logger::LogLevel::ERROR, __VA_ARGS__)
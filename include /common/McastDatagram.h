@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef struct evp_pkey_st EVP_PKEY;
+
+namespace transport {
+
+// UDP multicast data plane: MULTICAST_UPDATE okvir upakovan u datagram sa
+// rednim brojem i Ed25519 potpisom, tako da primalac odbaci lažne pakete i primijeti rupe.
+//
+//   [magic u32 "TPMD"][seq u64][okvir poruke (Header+Payload, V2)][Ed25519 potpis 64 B]
+//
+// Cijeli brojevi su big-endian; potpis pokriva sve bajtove prije njega. Klijenti dobijaju
+// samo javni ključ (AUTH preko TLS-a), pa ni prijavljen klijent ne može potpisati paket
+// koji bi ostali prihvatili.
+namespace mcast {
+
+constexpr uint32_t kDatagramMagic    = 0x54504D44;   // "TPMD"
+constexpr size_t   kHeaderLength     = 4 + 8;
+constexpr size_t   kSignatureLength  = 64;
+constexpr size_t   kKeyLength        = 32;           // Ed25519 privatni (seed) i javni ključ
+constexpr size_t   kMaxDatagram      = 1400;         // ispod tipičnog MTU-a, bez fragmentacije
+constexpr uint16_t kFrameVersion     = 2;            // PROTOCOL_V2: okvir u datagramu
+
+// Ključ za potpisivanje (samo centralni server)
+class Signer {
+public:
+    Signer();
+    ~Signer();
+    Signer(const Signer&) = delete;
+    Signer& operator=(const Signer&) = delete;
+
+    // seed od kKeyLength bajtova (npr. iz konfiguracije); prazno -> novi slučajan ključ
+    bool init(const std::string& seed = "");
+    bool ready() const { return pkey_ != nullptr; }
+    const std::string& publicKey() const { return public_key_; }
+    bool sign(const uint8_t* data, size_t len, uint8_t out[kSignatureLength]) const;
+
+private:
+    EVP_PKEY*   pkey_{nullptr};
+    std::string public_key_;
+};
+
+// false ako bi datagram bio veći od kMaxDatagram ili ključ nije spreman
+bool encodeDatagram(uint64_t seq, const uint8_t* frame, size_t frame_len,
+                    const Signer& signer, std::vector<uint8_t>& out);
+
+// true samo za ispravan magic i potpis javnim ključem; frame pokazuje u 'data'
+bool decodeDatagram(const uint8_t* data, size_t len, const std::string& public_key,
+                    uint64_t& seq, const uint8_t*& frame, size_t& frame_len);
+
+// Brza provjera (bez potpisa) da li je paket iz data plane-a, npr. da se odvoji od DISCOVER
+bool looksLikeDatagram(const uint8_t* data, size_t len);
+
+std::string toHex(const std::string& bytes);
+bool        fromHex(const std::string& hex, std::string& bytes);
+
+// Praćenje rednih brojeva na prijemu. Zakašnjeli i dupli paketi se odbacuju;
+// preskok prijavljuje opseg koji treba zatražiti preko TLS-a (MCAST_RESYNC).
+class SequenceTracker {
+public:
+    struct Result {
+        bool     accept{false};
+        bool     gap{false};
+        uint64_t gap_from{0};
+        uint64_t gap_to{0};
+    };
+
+    // last_seen iz AUTH odgovora (mcast_seq); 0 -> prvi primljeni paket je početak
+    void     reset(uint64_t last_seen) { last_ = last_seen; started_ = last_seen != 0; }
+    Result   onSequence(uint64_t seq);
+    uint64_t lastSeen() const { return last_; }
+
+private:
+    uint64_t last_{0};
+    bool     started_{false};
+};
+
+} // namespace mcast
+} // namespace transport
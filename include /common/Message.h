@@ -1,11 +1,15 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <cstdint>
 #include <memory>
 #include <optional>  // za opcione parametre u factory metodama
+#include <initializer_list>
+
+#include "SmallVector.h"
 
 namespace transport {
 
@@ -37,8 +41,40 @@ enum class MessageType : uint16_t {
     UPDATE_VEHICLE       = 20,     // ažuriranje vozila (active/route/type)
     UPDATE_CAPACITY      = 21,     // ažuriranje kapaciteta (capacity/available_seats)
 
+    // UDP data plane: klijent traži ponovno slanje propuštenih datagrama preko TLS-a
+    MCAST_RESYNC         = 22,     // session_id, from_seq, to_seq
+
+    // Odgovor na GET_VEHICLE_STATUS i delte za pretplaćene klijente
+    VEHICLE_STATUS       = 23,     // version, since_version, full, vehicles, removed
+
+    // N pod-zahtjeva (RESERVE_SEAT / PURCHASE_TICKET) u jednom okviru: count, items
+    BATCH                = 24,
+
+    // Replikacija centralni -> regionalni server (dnevnik promjena korisnika/vozila/cijena)
+    REPLICA_SYNC         = 25,     // server_id, epoch, key -> odgovor: epoch, offset regionalne kopije
+    REPLICA_BATCH        = 26,     // epoch, from, to, snapshot, count, encoding, raw_size, records
+
+    // Cjenovnik (centralni i regionalni server): odgovor price_version, count, fare.<vozilo>.<karta>
+    GET_PRICES           = 27,
+
+    // Grupne admin izmjene (jedna transakcija, jedna zamjena stanja u memoriji, jedan broadcast)
+    BULK_UPDATE_VEHICLES = 28,     // count, v.<i>.uri [, .active, .route, .vehicle_type, .capacity, .available_seats]
+    BULK_UPDATE_PRICES   = 29,     // count, fare.<vozilo>.<karta> (kao odgovor na GET_PRICES)
+
+    // Metrike servera (admin): format ("" ili "prometheus") -> ravna polja + text
+    GET_STATS            = 30,
+
+    // Admin pregled tabele po stranicama: table (users|tickets|payments), after, limit
+    // -> count, next ("" -> kraj), r.<i>.<polje>; sljedeći zahtjev šalje after = next
+    LIST_RECORDS         = 31,
+
+    // Mjerenja sa vozila (putnici, pozicija) preko VehicleServer-a: count, samples
+    // (common/Telemetry.h) -> odgovor accepted, dropped; agregira se po ruti u memoriji
+    VEHICLE_TELEMETRY    = 32,
+
     // NEW:
-    ADD_MEMBER_TO_GROUP  = 1001    // add member (bilo koji ulogovani korisnik)
+    ADD_MEMBER_TO_GROUP  = 1001,   // add member (bilo koji ulogovani korisnik)
+    ADD_MEMBERS_TO_GROUP = 1002    // session_id, group_name, count, m.<i>.urn (samo lider, jedna transakcija)
 };
 
 // =========================
@@ -57,11 +93,38 @@ enum class TicketType : uint8_t {
     GROUP_TOURIST  = 4
 };
 
+// =========================
+// Verzije protokola (header.version)
+// =========================
+// V1: polja kao [key_len][key][val_len][val], sve vrijednosti su tekst.
+// V2: tipizirani TLV — numerički ID polja, varint cijeli brojevi, IEEE double,
+//     sirovi binarni blobovi. Verzija se dogovara u CONNECT_REQUEST/RESPONSE
+//     ("protocol_version"); prijem uvijek razumije obje.
+constexpr uint16_t PROTOCOL_V1          = 1;
+constexpr uint16_t PROTOCOL_V2          = 2;
+constexpr uint16_t PROTOCOL_MAX_VERSION = PROTOCOL_V2;
+
+// "2.0" -> 2; prazno/nevažeće -> V1; ograničeno na [V1, PROTOCOL_MAX_VERSION]
+uint16_t parseProtocolVersion(std::string_view text);
+
+enum class FieldType : uint8_t {
+    STRING = 0,
+    INT    = 1,
+    DOUBLE = 2,
+    BOOL   = 3,
+    BINARY = 4
+};
+
+class MessageView;
+
 // =========================
 // Klasa Message (format okvira)
 // =========================
 class Message {
 public:
+    // sequence_id HEARTBEAT-a koji server šalje sam (keepalive), za razliku od odgovora/eha
+    static constexpr uint32_t kKeepaliveSequence = 0xFFFFFFFF;
+
     struct Header {
         uint32_t    magic       = 0x54504D50; // "TPMP" - Transport Protocol Message Protocol
         uint16_t    version     = 1;
@@ -72,20 +135,30 @@ public:
         uint32_t    checksum;
     } __attribute__((packed));
 
+    // Tipičan zahtjev/odgovor ima 3-8 polja: toliko ih staje u sam objekat
+    static constexpr size_t kInlineFields = 8;
+
     Message();
     explicit Message(MessageType type);
     ~Message();
 
+    // Objekti se recikliraju kroz listu slobodnih blokova po niti (make_unique/reset
+    // u stabilnom stanju ne idu u malloc); blok oslobođen na drugoj niti ide u njenu listu
+    static void* operator new(size_t size);
+    static void  operator delete(void* ptr, size_t size) noexcept;
+
     // Setters
     void setType(MessageType type)            { header_.type = type; }
     void setSequenceId(uint32_t seq_id)       { header_.sequence_id = seq_id; }
     void setSessionId(uint32_t session_id)    { header_.session_id = session_id; }
+    void setVersion(uint16_t version);        // enkodiranje payload-a pri serialize()
     
     // Getters
     MessageType getType() const               { return header_.type; }
     uint32_t    getSequenceId() const         { return header_.sequence_id; }
     uint32_t    getSessionId() const          { return header_.session_id; }
     uint32_t    getLength() const             { return header_.length; }
+    uint16_t    getVersion() const            { return header_.version; }
 
     // Data API
     void addString(const std::string& key, const std::string& value);
@@ -93,6 +166,8 @@ public:
     void addDouble(const std::string& key, double value);
     void addBool(const std::string& key, bool value);
     void addBinary(const std::string& key, const std::vector<uint8_t>& data);
+    // Više string polja odjednom (npr. data mapa iz factory-ja)
+    void addStrings(const std::map<std::string, std::string>& fields);
 
     std::string              getString(const std::string& key) const;
     int32_t                  getInt(const std::string& key) const;
@@ -103,16 +178,29 @@ public:
     bool hasKey(const std::string& key) const;
 
     // Serijalizacija
+    // serializeTo dodaje okvir na kraj 'out' u jednom prolazu (bafer pozivaoca se
+    // može reciklirati); ako je checksum zatražen, računa se nad istim bajtovima.
     std::vector<uint8_t> serialize() const;
+    void serializeTo(std::vector<uint8_t>& out) const;
+    void serializeTo(std::vector<uint8_t>& out, uint16_t version) const; // npr. verzija dogovorena na socketu
     bool deserialize(const std::vector<uint8_t>& data);
+    bool deserialize(const uint8_t* data, size_t size);
+
+    // Header iz mrežnog u host redoslijed (bytes >= sizeof(Header))
+    static Header decodeHeader(const uint8_t* bytes);
     
     // Stream (frame sa prefiksom dužine)
     std::vector<uint8_t> serializeStream() const;
     bool deserializeStream(const std::vector<uint8_t>& data);
 
     // Validacija
+    // calculateChecksum je O(1): checksum se upisuje pri svakoj serijalizaciji
+    // i pokriva sadržaj poruke u tom trenutku (uključujući kasnije dodana polja).
+    // finalize() ga izračuna jednom i zapamti: pozvati prije nego što se poruka
+    // dijeli među nitima ili šalje više puta (serializeTo je const i ne mijenja poruku).
     bool isValid() const;
     void calculateChecksum();
+    void finalize();
     bool verifyChecksum() const;
 
     // Utility
@@ -121,14 +209,172 @@ public:
     void   print() const;
 
 private:
-    Header                          header_{};
-    std::map<std::string, std::string> data_;
+    friend class MessageView;
+    friend class ResponseTemplate;
+
+    // Vrijednost se čuva u V1 tekstualnom obliku (osim BINARY: sirovi bajtovi),
+    // a tip i tačan broj služe za V2 enkodiranje i brze gettere
+    struct Field {
+        std::string value;
+        FieldType   type = FieldType::STRING;
+        int64_t     i    = 0;
+        double      d    = 0.0;
+    };
+
+    struct Entry {
+        std::string key;
+        Field       field;
+    };
+    // Sortirano po ključu (isti redoslijed na žici kao ranije std::map), binarna pretraga
+    using FieldStore = SmallVector<Entry, kInlineFields>;
+
+    Header                       header_{};
+    FieldStore                   data_;
+    bool                         checksum_pending_{false};
+    uint32_t                     length_v1_{0};   // dužina payload-a po verziji, vodi se inkrementalno
+    uint32_t                     length_v2_{0};
     
-    uint32_t            calculateCRC32(const std::vector<uint8_t>& data) const;
-    std::vector<uint8_t> encodeData() const;
-    bool                 decodeData(const std::vector<uint8_t>& data);
+    const Field* findField(std::string_view key) const;
+    void     setField(std::string_view key, Field field);   // ažurira dužine inkrementalno
+    uint32_t payloadLength(uint16_t version) const { return version == PROTOCOL_V2 ? length_v2_ : length_v1_; }
+    void     encodeHeader(std::vector<uint8_t>& out, uint16_t version, uint32_t checksum) const;
+    void     encodePayload(std::vector<uint8_t>& out, uint16_t version) const;
+    static void encodeEntry(std::vector<uint8_t>& out, uint16_t version, const Entry& entry);
+    void     assignFromView(const MessageView& view);
+    uint32_t frameChecksum(uint16_t version) const;   // CRC okvira sa checksum=0
+    uint32_t calculateCRC32(const uint8_t* data, size_t size) const;
+    uint32_t calculateCRC32(const std::vector<uint8_t>& data) const { return calculateCRC32(data.data(), data.size()); }
+};
+
+// =========================
+// MessageView (zero-copy dekodiranje)
+// =========================
+// Parsira okvir [Header][Payload] direktno iz bafera u koji je stigao: ključevi i
+// vrijednosti su string_view-ovi u taj bafer, tipizirani getteri parsiraju tek na upit.
+// View važi samo dok je bafer živ i nepromijenjen (npr. do sljedećeg prijema na socketu).
+class MessageView {
+public:
+    MessageView() = default;
+
+    // Isti raspored/pravila kao Message::deserialize; false -> view je prazan
+    bool parse(const uint8_t* data, size_t size);
+    void clear();
+
+    const Message::Header& header() const  { return header_; }
+    MessageType getType() const            { return header_.type; }
+    uint32_t    getSequenceId() const      { return header_.sequence_id; }
+    uint32_t    getSessionId() const       { return header_.session_id; }
+    uint32_t    getLength() const          { return header_.length; }
+    size_t      fieldCount() const         { return fields_.size(); }
+
+    // getStringView: tekst polja; za V2 brojeve/bool formatira se na upit u bafer polja,
+    // za V2 BINARY vraća sirove bajtove (getString vraća V1 tekstualni oblik)
+    bool             hasKey(std::string_view key) const;
+    std::string_view getStringView(std::string_view key) const;
+    std::string      getString(std::string_view key) const;
+    int32_t          getInt(std::string_view key) const;
+    double           getDouble(std::string_view key) const;
+    bool             getBool(std::string_view key) const;
+    std::vector<uint8_t> getBinary(std::string_view key) const;
+
+    // Za handlere koji još rade sa Message (kopira sva polja u mapu)
+    std::unique_ptr<Message> toMessage() const;
+
+private:
+    friend class Message;
+
+    struct Field {
+        std::string_view key;
+        std::string_view value;            // tekst (V1/STRING) ili sirovi bajtovi (BINARY)
+        FieldType        type = FieldType::STRING;
+        int64_t          i    = 0;
+        double           d    = 0.0;
+        mutable char     text[32];         // lijeno formatiran tekst V2 broja/bool-a
+        mutable uint8_t  text_len = 0;
+        mutable bool     text_ready = false;
+    };
+
+    const Field*     find(std::string_view key) const;
+    std::string_view textOf(const Field& f) const;
+    bool             parseV1(const uint8_t* p, size_t len);
+    bool             parseV2(const uint8_t* p, size_t len);
+
+    Message::Header    header_{};
+    std::vector<Field> fields_; // redoslijed sa žice; malo polja -> linearna pretraga
+};
+
+// BATCH "items": uzastopni serijalizovani okviri (svaki sa svojim headerom).
+// View-ovi pokazuju u 'data' i važe dok je bafer živ; false ako niz nije ispravan.
+bool splitBatchItems(const uint8_t* data, size_t size, std::vector<MessageView>& items);
+
+// =========================
+// ResponseTemplate (unaprijed serijalizovan odgovor)
+// =========================
+// Statična polja se enkodiraju jednom po verziji protokola; pri slanju se upisuju samo
+// vrijednosti slotova, dužina i sequence_id. Statični dijelovi nose unaprijed izračunat
+// CRC koji se spaja sa CRC-om ostatka (Crc32::combineFactor) kad je dio dovoljno dug da
+// se to isplati. Okvir je bajt-za-bajt isti kao Message sa istim poljima i checksumom.
+class ResponseTemplate {
+public:
+    static constexpr size_t kMaxSlots = 8;
+
+    enum class SlotType : uint8_t { STRING, INT };
+    struct Slot {
+        std::string key;
+        SlotType    type = SlotType::STRING;
+    };
+    // Vrijednost slota: tekst ili broj (broj u STRING slotu ide kao std::to_string)
+    struct Value {
+        Value(std::string_view s) : text(s) {}
+        Value(const std::string& s) : text(s) {}
+        Value(const char* s) : text(s) {}
+        Value(int v) : number(v), is_number(true) {}
+        Value(int64_t v) : number(v), is_number(true) {}
+
+        std::string_view text;
+        int64_t          number = 0;
+        bool             is_number = false;
+    };
+
+    // 'fixed': tip i statična polja; ključ slota ne smije biti i statično polje
+    ResponseTemplate(const Message& fixed, std::vector<Slot> slots);
+
+    MessageType type() const { return fixed_.getType(); }
+
+    // Dodaje okvir na kraj 'out'; values po redoslijedu slotova iz konstruktora
+    void render(std::vector<uint8_t>& out, uint16_t version, uint32_t sequence_id,
+                std::initializer_list<Value> values) const;
+    // Ista poruka kao Message (testovi, mjesta koja još šalju Message)
+    std::unique_ptr<Message> toMessage(std::initializer_list<Value> values) const;
+
+private:
+    // Statični bajtovi [offset, offset+length) iz Layout::bytes, pa vrijednost slota (slot >= 0)
+    struct Part {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint32_t crc    = 0;
+        uint32_t factor = 0;       // Crc32::shiftFactor(length)
+        int      slot   = -1;
+    };
+    struct Layout {
+        std::vector<uint8_t> bytes;
+        std::vector<Part>    parts;
+    };
+
+    void buildLayout(uint16_t version, Layout& layout) const;
+
+    Message           fixed_;
+    std::vector<Slot> slots_;
+    Layout            layouts_[2];   // V1, V2
 };
 
+struct VehicleStatusRecord;   // common/VehicleStatus.h
+struct ReplicationRecord;     // common/Replication.h
+class  PriceSnapshot;         // common/PriceCache.h
+struct VehicleUpdate;         // common/Database.h
+struct PriceList;             // common/Database.h
+struct TelemetrySample;       // common/Telemetry.h
+
 // =========================
 // MessageFactory 
 // =========================
@@ -136,8 +382,11 @@ private:
 class MessageFactory {
 public:
     // Connection
-    static std::unique_ptr<Message> createConnectRequest(const std::string& client_id);
-    static std::unique_ptr<Message> createConnectResponse(bool success, const std::string& reason = "");
+    // max_version: najveća verzija koju klijent nudi; odgovor nosi dogovorenu
+    static std::unique_ptr<Message> createConnectRequest(const std::string& client_id,
+                                                         uint16_t max_version = PROTOCOL_V1);
+    static std::unique_ptr<Message> createConnectResponse(bool success, const std::string& reason = "",
+                                                          uint16_t version = PROTOCOL_V1);
     
     // Auth
     static std::unique_ptr<Message> createAuthRequest(const std::string& urn, const std::string& pin = "");
@@ -163,6 +412,9 @@ public:
     static std::unique_ptr<Message> createRemoveMemberFromGroup(const std::string& group_name,
                                                                 const std::string& member_urn,
                                                                 const std::string& session_id_str = "");
+    static std::unique_ptr<Message> createAddMembersToGroup(const std::string& group_name,
+                                                            const std::vector<std::string>& member_urns,
+                                                            const std::string& session_id_str = "");
     
     // Admin / update poruke (NOVO)
     static std::unique_ptr<Message> createUpdatePrice(VehicleType vehicle_type,
@@ -178,14 +430,59 @@ public:
                                                          int capacity,
                                                          int available_seats);
 
+    // Grupne izmjene: sve stavke se primjenjuju zajedno ili nijedna
+    static std::unique_ptr<Message> createBulkUpdateVehicles(const std::vector<VehicleUpdate>& updates);
+    static std::unique_ptr<Message> createBulkUpdatePrices(const std::vector<PriceList>& prices);
+
     // Sistem / odgovori
     static std::unique_ptr<Message> createSuccessResponse(const std::string& message = "",
                                                           const std::map<std::string, std::string>& data = {});
     static std::unique_ptr<Message> createErrorResponse(const std::string& error_message, int error_code = -1);
     static std::unique_ptr<Message> createHeartbeat();
+
+    // Unaprijed serijalizovani odgovori (isti okvir kao odgovarajući create*):
+    static const ResponseTemplate& errorResponseTemplate();      // slotovi: error, error_code
+    static const ResponseTemplate& successResponseTemplate();    // slot: message
+    static const ResponseTemplate& connectAcceptedTemplate();    // success=true, reason; slot: protocol_version
+    static const ResponseTemplate& seatReservedTemplate();       // slotovi: route, vehicle_uri, available_seats
+    static std::unique_ptr<Message> createKeepalive();     // HEARTBEAT sa kKeepaliveSequence
     static std::unique_ptr<Message> createDisconnect();
     static std::unique_ptr<Message> createMulticastUpdate(const std::string& update_type,
                                                           const std::map<std::string, std::string>& data);
+    static std::unique_ptr<Message> createMcastResync(const std::string& session_id,
+                                                      uint64_t from_seq, uint64_t to_seq);
+
+    // Status vozila: routes = "A1,B2" (prazno/"*" -> sve); since_version 0 -> snapshot.
+    // subscribe + session_id -> server nakon odgovora šalje delte po rutama.
+    static std::unique_ptr<Message> createGetVehicleStatus(const std::string& routes,
+                                                           uint64_t since_version = 0,
+                                                           bool subscribe = false,
+                                                           const std::string& session_id = "");
+    // Pod-zahtjevi se serijalizuju u svojoj verziji; odgovor je jedan RESPONSE_SUCCESS
+    // sa statusom po stavci ("status" = "200,409,...")
+    static std::unique_ptr<Message> createBatch(const std::vector<std::unique_ptr<Message>>& items);
+
+    static std::unique_ptr<Message> createVehicleStatus(uint64_t version, uint64_t since_version, bool full,
+                                                        const std::vector<VehicleStatusRecord>& vehicles,
+                                                        const std::vector<VehicleStatusRecord>& removed);
+
+    // Replikacija: epoch identifikuje dnevnik (novi pri svakom pokretanju centralnog servera).
+    // Batch nosi zapise sa offset-om u (from, to]; snapshot zamjenjuje cijelu kopiju.
+    static std::unique_ptr<Message> createReplicaSync(const std::string& server_id, uint64_t epoch,
+                                                      const std::string& key = "");
+    static std::unique_ptr<Message> createReplicaBatch(uint64_t epoch, uint64_t from, uint64_t to, bool snapshot,
+                                                       const std::vector<ReplicationRecord>& records,
+                                                       int compression_level = 6);
+
+    static std::unique_ptr<Message> createGetPrices();
+    // format = "prometheus" -> odgovor uz ravna polja nosi i "text" (Prometheus text exposition)
+    static std::unique_ptr<Message> createGetStats(const std::string& format = "");
+    // admin_key: [admin] admin_key centralnog servera (AdminServer ga dodaje pri prosljeđivanju)
+    static std::unique_ptr<Message> createListRecords(const std::string& table, const std::string& after = "",
+                                                      int limit = 0, const std::string& admin_key = "");
+    // Uzorci jednog ili više vozila u jednom okviru (vozilo -> VehicleServer -> CentralServer)
+    static std::unique_ptr<Message> createVehicleTelemetry(const std::vector<TelemetrySample>& samples);
+    static std::unique_ptr<Message> createPriceList(const PriceSnapshot& prices);
 };
 
 } // namespace transport
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "ClockService.h"
+#include "LatencyHistogram.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace transport {
+namespace metrics {
+
+// Brojač razbijen na trake po niti (cache line po traci): inc() na vrućoj putanji
+// je jedan relaxed fetch_add bez dijeljenja linije među jezgrama; value() sabira trake.
+class Counter {
+public:
+    static constexpr size_t kStripes = 16;
+
+    void     inc(uint64_t n = 1) { cells_[stripe()].value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const;
+    void     reset();
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    static size_t stripe();
+
+    std::array<Cell, kStripes> cells_{};
+};
+
+// Trenutna vrijednost (npr. dubina reda); add() sa negativnim n smanjuje
+class Gauge {
+public:
+    void    set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void    add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const  { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Registar metrika procesa (jedan po procesu, kao DatabasePool/Logger).
+// - Metrika se traži po imenu familije i labelama (npr. labels = "type=\"RESERVE_SEAT\"");
+//   vraćena referenca važi do kraja procesa, pa je vruće putanje traže jednom i čuvaju pokazivač.
+// - Histogrami su LatencyHistogram; 'unit' je faktor za izvoz (1e-9: ns -> sekunde, 1: bez jedinice).
+// - renderPrometheus() daje text exposition format (histogram kao summary: kvantili, _sum, _count);
+//   collect() ravne parove ključ -> vrijednost za GET_STATS odgovor.
+class Registry {
+public:
+    static Registry& instance();
+
+    Counter&          counter(const std::string& name, const std::string& labels = "",
+                              const std::string& help = "");
+    Gauge&            gauge(const std::string& name, const std::string& labels = "",
+                            const std::string& help = "");
+    LatencyHistogram& histogram(const std::string& name, const std::string& labels = "",
+                                const std::string& help = "", double unit = 1e-9);
+
+    // Isključeno -> ScopedTimer ne čita sat i ne bilježi (brojači i dalje rade)
+    void setEnabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+    bool enabled() const     { return enabled_.load(std::memory_order_relaxed); }
+
+    std::string renderPrometheus() const;
+    // Ključ = ime + vrijednosti labela ("tp_handler_seconds.RESERVE_SEAT"); histogrami daju
+    // .count, .p50, .p99, .p999, .max (vremenski u mikrosekundama, sa sufiksom _us)
+    void        collect(std::map<std::string, std::string>& out) const;
+    void        reset();   // testovi / benchmark: nuluje sve vrijednosti, metrike ostaju registrovane
+
+private:
+    enum class Kind { COUNTER, GAUGE, HISTOGRAM };
+    struct Family {
+        Kind        kind{Kind::COUNTER};
+        std::string help;
+        double      unit{1.0};
+        std::map<std::string, std::unique_ptr<Counter>>          counters;
+        std::map<std::string, std::unique_ptr<Gauge>>            gauges;
+        std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+    };
+
+    Registry() = default;
+    Family& family(const std::string& name, Kind kind, const std::string& help, double unit);
+
+    mutable std::mutex                  mutex_;
+    std::map<std::string, Family>       families_;
+    std::atomic<bool>                   enabled_{true};
+};
+
+// Mjeri trajanje opsega u ns; nullptr histogram ili isključen registar -> ništa
+class ScopedTimer {
+public:
+    explicit ScopedTimer(LatencyHistogram* histogram)
+        : histogram_(histogram && Registry::instance().enabled() ? histogram : nullptr) {
+        if (histogram_) start_ns_ = ClockService::monotonicNanos();
+    }
+    ~ScopedTimer() {
+        if (histogram_) histogram_->record(ClockService::nanosSince(start_ns_));
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    static uint64_t elapsedNanos(std::chrono::steady_clock::time_point since) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - since).count());
+    }
+
+private:
+    LatencyHistogram* histogram_;
+    uint64_t          start_ns_{0};
+};
+
+} // namespace metrics
+} // namespace transport
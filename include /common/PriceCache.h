@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Database.h"
+#include "Message.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace transport {
+
+// Nepromjenjiv cjenovnik: cijena po (VehicleType, TicketType) u ravnom nizu
+// fiksne veličine, bez zaključavanja i bez upita prema bazi pri kupovini.
+class PriceSnapshot {
+public:
+    static constexpr size_t kVehicleTypes = 3;   // BUS, TRAM, TROLLEYBUS
+    static constexpr size_t kTicketTypes  = 4;   // INDIVIDUAL .. GROUP_TOURIST
+    static constexpr double kDefaultFare  = 1.0; // tip bez cijene u konfiguraciji/bazi
+
+    struct Fare {
+        double   base_price{kDefaultFare};
+        double   distance_multiplier{0.0};
+        double   time_multiplier{0.0};
+        uint64_t version{0};            // verzija snapshot-a pri zadnjoj promjeni (0 = default)
+    };
+
+    uint64_t version() const { return version_; }
+
+    // nullptr za tip van opsega
+    const Fare* find(VehicleType vehicle_type, TicketType ticket_type) const;
+    // base + distance * distance_multiplier + minutes * time_multiplier
+    double ticketPrice(VehicleType vehicle_type, TicketType ticket_type,
+                       double distance = 0.0, double minutes = 0.0) const;
+    // Grupni popust za tip karte, 0..1 ([discounts] *_group_discount)
+    double groupDiscount(TicketType ticket_type) const;
+
+    // Samo pri građenju novog snapshot-a (prije objave u PriceCache)
+    bool setFare(VehicleType vehicle_type, TicketType ticket_type, const Fare& fare);
+    void setGroupDiscount(TicketType ticket_type, double rate);
+    void setVersion(uint64_t version) { version_ = version; }
+    // Bazne cijene iz price_list tabele prepisuju one iz konfiguracije
+    void applyRows(const std::vector<PriceList>& rows);
+
+private:
+    static int index(VehicleType vehicle_type, TicketType ticket_type);
+
+    std::array<Fare, kVehicleTypes * kTicketTypes> fares_{};
+    std::array<double, kTicketTypes>               group_discount_{};
+    uint64_t                                       version_{0};
+};
+
+// RCU: čitaoci uzmu shared_ptr na trenutni snapshot (atomic_load) i koriste ga
+// bez brave; pisac napravi kopiju, izmijeni je i zamijeni pokazivač.
+class PriceCache {
+public:
+    PriceCache();
+
+    std::shared_ptr<const PriceSnapshot> get() const { return std::atomic_load(&current_); }
+    void publish(std::shared_ptr<const PriceSnapshot> snapshot);
+
+    // Kopija sa novom baznom cijenom i verzijom + 1; vraća objavljeni snapshot
+    std::shared_ptr<const PriceSnapshot> update(VehicleType vehicle_type, TicketType ticket_type,
+                                                double base_price);
+
+    // Grupna izmjena (npr. cijeli cjenovnik): sve bazne cijene u jednoj kopiji sa verzijom + 1,
+    // objavljenoj jednom; nepoznati tipovi se preskaču
+    std::shared_ptr<const PriceSnapshot> updateAll(const std::vector<PriceList>& rows);
+
+    // "price_updated" MULTICAST_UPDATE (vehicle_type, ticket_type, price, price_version) ili
+    // "price_list_updated" (price_version, fare.<vozilo>.<karta>). Cijena se primjenjuje
+    // samo ako je novija od te cijene u kopiji -> redoslijed nije bitan
+    bool applyUpdate(const Message& update);
+
+private:
+    std::shared_ptr<const PriceSnapshot> current_;   // samo kroz std::atomic_load/atomic_store
+    std::mutex                           write_mutex_;
+};
+
+} // namespace transport
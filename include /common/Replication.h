@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Database.h"
+#include "PriceCache.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace transport {
+
+// Jedna promjena iz dnevnika replikacije centralnog servera prema regionalnim.
+// key: URN korisnika / URI vozila / fareKey(); value: polja zapisa (prazno za brisanje)
+struct ReplicationRecord {
+    enum class Kind : uint8_t {
+        USER_UPSERT    = 1,
+        USER_DELETE    = 2,
+        VEHICLE_UPSERT = 3,
+        PRICE_UPSERT   = 4
+    };
+
+    uint64_t    offset{0};      // pozicija u dnevniku (snapshot: offset do kog snapshot važi)
+    Kind        kind{Kind::USER_UPSERT};
+    std::string key;
+    std::string value;
+};
+
+// "records" polje REPLICA_BATCH poruke:
+//   [count varint] { [kind u8][offset varint][key_len varint][key][val_len varint][val] }*
+// Okvir se komprimuje zlib-om ("encoding" = "zlib", "raw_size" = dužina prije kompresije)
+// samo kada je komprimovani oblik kraći; inače ide "raw".
+namespace replication {
+
+void encodeRecords(const std::vector<ReplicationRecord>& records, std::vector<uint8_t>& out);
+bool decodeRecords(const std::vector<uint8_t>& in, std::vector<ReplicationRecord>& records);
+
+// level 0 -> bez kompresije; true ako je `out` komprimovan
+bool compress(const std::vector<uint8_t>& in, std::vector<uint8_t>& out, int level);
+// raw_size dolazi od peer-a: više od kMaxRawBytes (ili od onoga što zlib može dati iz
+// `in`) se odbija prije alokacije
+constexpr size_t kMaxRawBytes = 256u << 20;
+bool decompress(const std::vector<uint8_t>& in, size_t raw_size, std::vector<uint8_t>& out);
+
+// Polja zapisa: vozilo "type|capacity|available|active|route", cijena "base|distance|time|version"
+std::string encodeVehicle(const Vehicle& vehicle);
+bool        decodeVehicle(const ReplicationRecord& record, Vehicle& vehicle);
+
+std::string fareKey(VehicleType vehicle_type, TicketType ticket_type);   // "1:1"
+std::string encodeFare(const PriceSnapshot::Fare& fare);
+bool        decodeFare(const ReplicationRecord& record, VehicleType& vehicle_type,
+                       TicketType& ticket_type, PriceSnapshot::Fare& fare);
+
+} // namespace replication
+
+} // namespace transport
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace transport {
+
+// Niz sa prvih N elemenata u samom objektu; tek N+1. element ide na heap (sve se tada
+// preseli, niz je uvijek kontinualan). Za male kolekcije čiji je tipičan broj poznat
+// (npr. polja poruke), pa u uobičajenom slučaju nema alokacije.
+template <typename T, size_t N>
+class SmallVector {
+public:
+    using value_type     = T;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+    ~SmallVector() {
+        clear();
+        if (!isInline()) ::operator delete(data_);
+    }
+
+    SmallVector(const SmallVector& other) {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            std::uninitialized_copy(other.begin(), other.end(), data_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        moveFrom(other);
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            clear();
+            if (!isInline()) ::operator delete(data_);
+            data_     = inlineData();
+            capacity_ = N;
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    iterator       begin()       { return data_; }
+    iterator       end()         { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end()   const { return data_ + size_; }
+
+    size_t size()     const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool   empty()    const { return size_ == 0; }
+    bool   isInline() const { return data_ == inlineData(); }
+
+    T&       operator[](size_t i)       { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T&       back()                     { return data_[size_ - 1]; }
+
+    void clear() {
+        std::destroy(begin(), end());
+        size_ = 0;      // kapacitet (i eventualni heap blok) ostaje za ponovnu upotrebu
+    }
+
+    void reserve(size_t n) {
+        if (n <= capacity_) return;
+        T* fresh = static_cast<T*>(::operator new(n * sizeof(T)));
+        std::uninitialized_move(begin(), end(), fresh);
+        std::destroy(begin(), end());
+        if (!isInline()) ::operator delete(data_);
+        data_     = fresh;
+        capacity_ = n;
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) reserve(capacity_ * 2);
+        ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+        return data_[size_++];
+    }
+    void push_back(T value) { emplace_back(std::move(value)); }
+
+    // Umetanje ispred 'pos' (pomjeranje repa za jedno mjesto)
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        const size_t index = static_cast<size_t>(pos - begin());
+        if (index == size_) return &emplace_back(std::forward<Args>(args)...);
+        T value(std::forward<Args>(args)...);
+        if (size_ == capacity_) reserve(capacity_ * 2);    // prije back(): reserve seli elemente
+        emplace_back(std::move(back()));
+        std::move_backward(begin() + index, end() - 2, end() - 1);
+        data_[index] = std::move(value);
+        return begin() + index;
+    }
+
+    iterator erase(const_iterator pos) {
+        const size_t index = static_cast<size_t>(pos - begin());
+        std::move(begin() + index + 1, end(), begin() + index);
+        std::destroy_at(data_ + size_ - 1);
+        --size_;
+        return begin() + index;
+    }
+
+private:
+    T*       inlineData()       { return reinterpret_cast<T*>(&storage_); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(&storage_); }
+
+    void moveFrom(SmallVector& other) {
+        if (other.isInline()) {
+            std::uninitialized_move(other.begin(), other.end(), data_);
+            size_ = other.size_;
+            other.clear();
+        } else {
+            // Heap blok se samo preuzima
+            data_           = other.data_;
+            size_           = other.size_;
+            capacity_       = other.capacity_;
+            other.data_     = other.inlineData();
+            other.size_     = 0;
+            other.capacity_ = N;
+        }
+    }
+
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage_;
+    T*     data_{inlineData()};
+    size_t size_{0};
+    size_t capacity_{N};
+};
+
+} // namespace transport
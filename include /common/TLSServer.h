@@ -1,8 +1,11 @@
 #pragma once
 #include <memory>
 #include <thread>
+#include <vector>
 #include <functional>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include "TLSSocket.h"
@@ -13,6 +16,15 @@ class TLSServer {
 public:
     using ConnectionCallback = std::function<void(std::unique_ptr<TLSSocket>)>;
 
+    // Način izvršavanja:
+    //  - THREAD_PER_CONNECTION: jedna io nit; callback se zove u zasebnoj (detached) niti
+    //  - WORKER_POOL: io_context radi na N worker niti; callback se zove direktno na io niti
+    //    i NE SMIJE blokirati (sesija treba koristiti async API TLSSocket-a)
+    //  - SHARDED: N io_context-a (shard-ova), svaki na svojoj niti (opciono vezanoj za jezgro);
+    //    prihvaćeni socketi se dijele round-robin, handshake i sesija rade na shard-u
+    //    koji posjeduje socket. Callback kao u WORKER_POOL modu (ne smije blokirati)
+    enum class ExecutionMode { THREAD_PER_CONNECTION, WORKER_POOL, SHARDED };
+
     TLSServer();
     ~TLSServer();
 
@@ -24,21 +36,84 @@ public:
 
     // Callback za svaku novu konekciju (predaje se kao gotov TLSSocket)
     void setConnectionCallback(ConnectionCallback cb) { on_connection_ = std::move(cb); }
+    // Prijem konekcije nakon handshake-a, prije callback-a (i prije niti u THREAD_PER_CONNECTION
+    // modu); false -> socket se zatvara. Radi na io niti: filter odgovara kratko (npr. 503) ili nikako
+    using ConnectionFilter = std::function<bool(std::unique_ptr<TLSSocket>&)>;
+    void setConnectionFilter(ConnectionFilter filter) { connection_filter_ = std::move(filter); }
+
+    // Mora se postaviti prije start(); worker_threads <= 0 -> hardware_concurrency
+    // (u SHARDED modu to je broj shard-ova)
+    void setExecutionMode(ExecutionMode mode, int worker_threads = 0);
+    ExecutionMode getExecutionMode() const { return mode_; }
+    int getWorkerThreads() const { return static_cast<int>(io_threads_.size()); }
+    // SHARDED: nit shard-a i veže se za jezgro i % hardware_concurrency (prije start())
+    void setCpuAffinity(bool enabled) { cpu_affinity_ = enabled; }
+    int getShardCount() const { return mode_ == ExecutionMode::SHARDED ? static_cast<int>(contexts_.size()) : 0; }
+    // Broj uspješnih handshake-ova po shard-u (prazno van SHARDED moda)
+    std::vector<uint64_t> getShardConnections() const;
+
+    // Konekcija koja ne završi TLS handshake u roku se zatvara (0 -> bez roka)
+    void setHandshakeTimeout(std::chrono::milliseconds timeout) { handshake_timeout_ = timeout; }
+    // Nastavak sesije (TLS 1.3 ticket-i / session cache); mora se postaviti prije start()
+    void setSessionResumption(bool enabled, int lifetime_seconds = 7200) {
+        session_resumption_ = enabled; session_lifetime_ = lifetime_seconds;
+    }
+
+    // TCP opcije za prihvaćene konekcije i acceptor; mora se postaviti prije start().
+    // reuse_port u WORKER_POOL modu -> jedan SO_REUSEPORT acceptor po worker niti,
+    // kernel raspoređuje nove konekcije među njima
+    void setSocketOptions(const SocketOptions& options) { socket_options_ = options; }
+    const SocketOptions& getSocketOptions() const { return socket_options_; }
+    int getAcceptorCount() const { return static_cast<int>(acceptors_.size()); }
+
+    struct Stats {
+        uint64_t handshakes{0};     // uspješni
+        uint64_t resumed{0};        // od toga nastavljene sesije (skraćeni handshake)
+        uint64_t failed{0};
+        uint64_t timed_out{0};
+        uint64_t rejected{0};       // odbio ConnectionFilter
+    };
+    Stats getStats() const;
 
 private:
-    void doAccept();
+    void doAccept(size_t acceptor_index);
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> openAcceptor(boost::asio::io_context& io, int port,
+                                                                 bool reuse_port);
+    size_t pickShard(size_t acceptor_index);
+    static bool pinToCpu(std::thread& thread, int cpu);
+    void dispatchConnection(std::unique_ptr<TLSSocket> client);
 
     // Non-copyable
     TLSServer(const TLSServer&) = delete;
     TLSServer& operator=(const TLSServer&) = delete;
 
-    boost::asio::io_context io_;
-    std::unique_ptr<std::thread> io_thread_;
-    std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor_;
+    // Jedan io_context (THREAD_PER_CONNECTION/WORKER_POOL) ili jedan po shard-u (SHARDED).
+    // Ostaju živi do destruktora: predati socketi se na njih oslanjaju i nakon stop()
+    // Dijeljeni: socket handler niti drži svoj kontekst (nit može nadživjeti server)
+    std::vector<std::shared_ptr<boost::asio::io_context>> contexts_;
+    std::vector<std::thread> io_threads_;
+    std::vector<std::unique_ptr<boost::asio::ip::tcp::acceptor>> acceptors_;
     std::unique_ptr<boost::asio::ssl::context> ssl_ctx_;
     std::atomic<bool> running_{false};
     ConnectionCallback on_connection_;
+    ConnectionFilter   connection_filter_;
+
+    ExecutionMode mode_{ExecutionMode::THREAD_PER_CONNECTION};
+    int           worker_threads_{0};
+    bool          cpu_affinity_{false};
+    std::atomic<size_t> next_shard_{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> shard_connections_;
+
+    std::chrono::milliseconds handshake_timeout_{std::chrono::seconds(10)};
+    bool                      session_resumption_{true};
+    int                       session_lifetime_{7200};
+    SocketOptions             socket_options_{};
+
+    std::atomic<uint64_t> handshakes_{0};
+    std::atomic<uint64_t> resumed_{0};
+    std::atomic<uint64_t> handshake_failures_{0};
+    std::atomic<uint64_t> handshake_timeouts_{0};
+    std::atomic<uint64_t> rejected_{0};
 };
 
 } // namespace transport
-
@@ -8,6 +8,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
@@ -15,14 +17,42 @@
 namespace transport {
 
 class Message;
+class MessageView;
+
+// Opcije TCP socketa za prihvaćene (TLSServer) i klijentske (connect) konekcije.
+// Iz ServerConfig: [server] tcp_nodelay, tcp_keepalive, socket_reuse_addr, socket_reuse_port;
+// [network] socket_buffer_size, keepalive_idle/keepalive_interval/keepalive_count
+struct SocketOptions {
+    bool tcp_nodelay{true};       // mali request/response okviri ne čekaju Nagle
+    bool keepalive{false};
+    int  keepalive_idle{0};       // s bez saobraćaja do prvog probe-a (0 -> OS default)
+    int  keepalive_interval{0};   // s između probe-ova (0 -> OS default)
+    int  keepalive_count{0};      // neuspjelih probe-ova do prekida (0 -> OS default)
+    int  buffer_size{0};          // SO_SNDBUF/SO_RCVBUF u bajtima (0 -> OS autotuning)
+    bool reuse_address{true};     // samo za acceptor
+    bool reuse_port{false};       // samo za acceptor: jedan acceptor po worker niti
+    // Rok jednog sync čitanja preko executor-a (server-side, klijent nakon enableFullDuplex);
+    // 0 -> bez roka. Po isteku veza se više ne čita (pozivalac je zatvara)
+    int  receive_timeout_ms{0};
+    // Najveći primljeni okvir (header + payload): dužina iz header-a se provjerava prije
+    // alokacije, veći okvir je greška prijema (pozivalac zatvara vezu). 0 -> bez granice
+    size_t max_frame_bytes{64u << 20};
+};
 
 class TLSSocket {
 public:
     enum class Mode { CLIENT, SERVER };
 
+    // Najveći plaintext jednog TLS record-a; sitni okviri se pakuju do ove granice
+    static constexpr size_t kMaxRecordPayload = 16 * 1024;
+
     TLSSocket(Mode mode = Mode::CLIENT);
     using ssl_stream_t = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
-    explicit TLSSocket(std::shared_ptr<ssl_stream_t> accepted_stream); // za server-side
+    // Server-side; io_owner drži io_context stream-a živim dok i socket živi. options su već
+    // primijenjene na prihvaćeni socket (TLSServer), ovdje se samo pamte (rok, max_frame_bytes)
+    explicit TLSSocket(std::shared_ptr<ssl_stream_t> accepted_stream,
+                       std::shared_ptr<boost::asio::io_context> io_owner = nullptr,
+                       const SocketOptions& options = {});
 
     ~TLSSocket();
 
@@ -32,7 +62,25 @@ public:
     bool listen(int backlog = 5);        // not supported
     std::unique_ptr<TLSSocket> accept(); // not supported
     void disconnect();
+    void close();                        // tvrdo zatvaranje TCP-a bez TLS close_notify
+    // Samo TCP shutdown (deskriptor ostaje): sigurno iz druge niti (async socket ga radi na
+    // svom executor-u); blokiran ili async read vlasnika završava greškom, pa vlasnik sam
+    // zatvara konekciju (idle reaper servera)
+    void shutdownTransport();
+    // Zadnja primljena poruka (ili uspostava veze); čitljivo iz drugih niti
+    std::chrono::steady_clock::time_point lastActivity() const {
+        return std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(last_activity_.load(std::memory_order_relaxed)));
+    }
     
+    // Primjenjuje se pri connect-u (klijent) ili odmah ako je socket već otvoren
+    void setSocketOptions(const SocketOptions& options);
+    // Opcije na otvorenom TCP socketu (bez reuse_*); false i last_error ako nešto nije prošlo
+    static bool applySocketOptions(boost::asio::ip::tcp::socket& socket, const SocketOptions& options,
+                                   std::string* error = nullptr);
+    // Stvarne vrijednosti sa socketa (getsockopt), npr. za dijagnostiku i testove
+    bool querySocketOptions(SocketOptions& out) const;
+
     bool isConnected() const { return connected_; }
     bool isTLSEstablished() const { return tls_established_; }
 
@@ -40,22 +88,86 @@ public:
     bool loadCertificate(const std::string& cert_file, const std::string& key_file);
     bool loadCACertificate(const std::string& ca_file);
     bool setupTLS();            // no-op
+    // Klijent: ponudi zadnju sesiju sa istim serverom (host:port) pri connect-u.
+    // Klijentski TLS kontekst je dijeljen po (cert, key, CA) u cijelom procesu.
+    void setSessionResumption(bool enabled) { session_resumption_ = enabled; }
+    bool isSessionResumed() const           { return session_resumed_; }   // zadnji handshake
     bool performTLSHandshake(); // no-op
 
+    // Verzija enkodiranja za odlazne poruke (dogovorena u CONNECT_REQUEST/RESPONSE);
+    // prijem razumije sve podržane verzije bez obzira na ovu postavku
+    void     setProtocolVersion(uint16_t version) { protocol_version_ = version; }
+    uint16_t getProtocolVersion() const          { return protocol_version_; }
+
     // Sync I/O
+    // Socket čiji stream vodi njegov executor (svaki server-side socket, klijent nakon
+    // enableFullDuplex/async čitanja; v. usesAsyncIo()): send*/sendMessage samo stave okvir
+    // u red async upisa i vrate true, a sync prijem čeka async_read na istom executor-u.
+    // SSL stanje tako dira samo jedna nit u trenutku i kad jedna nit čita, a druga
+    // (npr. tajmer heartbeat-a ili broadcast) piše na isti socket
     bool sendMessage(const Message& message);
+    // Već serijalizovan okvir (npr. dijeljeni broadcast bafer); cijeli okvir pod istim
+    // mutex-om kao sendMessage, pa se ne miješa s odgovorima handlera
+    bool sendFrame(const uint8_t* data, size_t length);
+    // Više gotovih okvira odjednom (npr. red broadcast ažuriranja): pakuju se u upise do
+    // kMaxRecordPayload umjesto po jednog TLS record-a i write poziva za svaki okvir
+    bool sendFrames(const boost::asio::const_buffer* frames, size_t count);
     std::unique_ptr<Message> receiveMessage();
+    // Zero-copy: view pokazuje u bafer konekcije i važi do sljedećeg prijema
+    bool receiveMessageView(MessageView& view);
+
+    // Faze zadnjeg prijema (samo dok je tracing uključen, inače nule): od dolaska headera
+    // do kraja payload-a, pa parsiranje. Server iz njih pravi spanove kad vidi traceparent.
+    struct ReceiveTiming {
+        std::chrono::steady_clock::time_point header_at{};
+        uint64_t read_ns{0};
+        uint64_t decode_ns{0};
+    };
+    const ReceiveTiming& lastReceiveTiming() const { return rx_timing_; }
     ssize_t send(const void* data, size_t length);
+    // Gather: dijelovi se kopiraju u zajednički bafer do kMaxRecordPayload i šalju jednim
+    // upisom (jedan TLS record); dio od kMaxRecordPayload ili veći ide direktno
+    ssize_t send(const boost::asio::const_buffer* buffers, size_t count);
+    // Upisi na TLS stream (sync i async) od otvaranja; za dijagnostiku i testove
+    uint64_t getWriteCalls() const;
     ssize_t receive(void* buffer, size_t length);
 
-    // Async API (nije implementirano u minimal portu)
+    // Async API
+    // Server-side socket koristi executor TLSServer-a (strand po konekciji);
+    // klijentski socket po potrebi pokreće vlastitu io nit.
+    // Ne miješati sync i async čitanje na istom socketu istovremeno.
     using MessageCallback = std::function<void(std::unique_ptr<Message>)>;
     using ErrorCallback   = std::function<void(const std::string&)>;
+    using WriteCallback   = std::function<void(bool ok)>;
+    using ViewCallback    = std::function<void(const MessageView&)>;
     void setMessageCallback(MessageCallback cb) { message_callback_ = std::move(cb); }
     void setErrorCallback(ErrorCallback cb)     { error_callback_   = std::move(cb); }
-    bool startAsyncReceive();
+    bool startAsyncReceive();   // kontinuirano: svaka poruka -> message_callback_, greška -> error_callback_
     void stopAsyncReceive();
 
+    // Stavlja okvir u red za slanje; okviri nakupljeni dok je upis u letu
+    // šalju se spojeni jednim async_write. Sigurno za poziv iz bilo koje niti.
+    // Completion (on_done) se zove na executor-u stream-a i ne dira TLSSocket, pa upis
+    // u letu smije nadživjeti objekat (npr. sesija zatvorena dok broadcast još piše)
+    bool asyncSendMessage(const Message& message, WriteCallback on_done = nullptr);
+    // Isto za gotove okvire (npr. dijeljeni broadcast bafer): kopiraju se u red kao jedan upis
+    bool asyncSendFrames(const boost::asio::const_buffer* frames, size_t count, WriteCallback on_done = nullptr);
+    size_t getPendingWrites() const;
+    // Stream pripada executor-u (strand-u) socketa: server-side uvijek, klijent nakon
+    // enableFullDuplex() ili prvog async čitanja
+    bool usesAsyncIo() const { return async_io_.load(std::memory_order_acquire); }
+    // Klijent: od sada sve operacije nad stream-om idu kroz vlastitu io nit, pa se
+    // receiveMessage iz jedne niti i sendMessage iz druge smiju preklapati.
+    // Sync prijem se tada ne smije zvati iz callback-a na toj io niti
+    bool enableFullDuplex();
+
+    // Jednokratno asinhrono čitanje jedne uokvirene poruke ([Header][Payload]).
+    // Completion se izvršava na io niti koja pokreće stream (npr. TLSServer worker);
+    // TLSSocket mora živjeti dok se jedan od callback-ova ne pozove.
+    void asyncReceiveMessage(MessageCallback on_message, ErrorCallback on_error);
+    // Isto, bez materijalizacije: view važi samo unutar callback-a
+    void asyncReceiveView(ViewCallback on_view, ErrorCallback on_error);
+
     // Stream helpers
     bool sendStream(const std::vector<uint8_t>& data) { return send(data.data(), data.size()) == (ssize_t)data.size(); }
     std::vector<uint8_t> receiveStream(size_t max_length = 8192) {
@@ -82,8 +194,18 @@ private:
     std::atomic<bool> connected_{false};
     std::atomic<bool> tls_established_{false};
     std::atomic<bool> async_running_{false};
+    std::atomic<bool> async_io_{false};
+    std::atomic<uint16_t> protocol_version_{1};
+    bool session_resumption_{true};
+    bool session_resumed_{false};
+    SocketOptions socket_options_{};
     std::string last_error_;
     std::string cert_file_, key_file_, ca_file_;
+    ReceiveTiming rx_timing_{};     // piše samo nit koja prima (sync ili completion na strand-u)
+    std::atomic<std::chrono::steady_clock::rep> last_activity_{0};
+    void touchActivity() {
+        last_activity_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
 
     // Async thread holderi (API kompatibilnost)
     std::unique_ptr<std::thread> receive_thread_;
@@ -92,7 +214,8 @@ private:
     MessageCallback message_callback_;
     ErrorCallback   error_callback_;
 
-    // Boost.Asio stanje
+    // Boost.Asio stanje; io_owner_ se uništava posljednji (kontekst nadživi stream)
+    std::shared_ptr<boost::asio::io_context> io_owner_;
     struct AsioState;
     std::shared_ptr<AsioState> asio_;
 
@@ -102,8 +225,19 @@ private:
     bool createSocket();
     void closeSocket();
     void asyncReceiveLoop();
+    bool receiveFrame();        // sync: jedan okvir u asio_->rx_buf
+    // Sync čitanje [offset, offset+length) bafera iz AsioState preko executor-a stream-a
+    bool readOnExecutor(std::vector<uint8_t>& buf, size_t offset, size_t length);
+    // Okvir sa ovom dužinom payload-a prelazi SocketOptions::max_frame_bytes
+    bool frameTooLarge(uint32_t payload) const;
+    void closeAfterFlush();     // close/disconnect kad stream pripada executor-u
+    static void closeStream(const std::shared_ptr<AsioState>& state);
+    void ensureIoThread();
+    void stopIoThread();
+    static void startWrite(const std::shared_ptr<AsioState>& state);
+    bool queueWrite(std::vector<uint8_t>&& bytes, WriteCallback on_done);
+    bool writesViaQueue() const { return usesAsyncIo(); }
     void setLastError(const std::string& error);
-    bool setSocketOptions();
     std::string getSSLError() const;
     void logSSLError(const std::string& operation) const;
 
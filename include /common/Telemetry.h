@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace transport {
+
+// Jedno mjerenje sa vozila (VEHICLE_TELEMETRY): putnici u vozilu i pozicija
+struct TelemetrySample {
+    std::string uri;
+    uint64_t    timestamp_ms{0};   // wall clock vozila (ms od epohe)
+    int         occupancy{0};      // putnika u vozilu (brojač na vratima)
+    int32_t     lat_e6{0};         // geografska širina * 1e6
+    int32_t     lon_e6{0};         // geografska dužina * 1e6
+};
+
+// Kompaktno binarno polje "samples" u VEHICLE_TELEMETRY:
+//   [count varint] { [uri_len u8][uri][timestamp zigzag varint][occupancy varint]
+//                    [lat_e6 zigzag varint][lon_e6 zigzag varint] }*
+// Vrijeme je razlika od prethodnog zapisa u okviru (prvi: od 0), pa uzastopni uzorci
+// zauzimaju 1-2 bajta za vrijeme. URI duži od 255 bajtova se skraćuje.
+namespace telemetry {
+
+void encodeSamples(const std::vector<TelemetrySample>& samples, std::vector<uint8_t>& out);
+bool decodeSamples(const std::vector<uint8_t>& in, std::vector<TelemetrySample>& samples);
+
+} // namespace telemetry
+
+} // namespace transport
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <boost/asio.hpp>
+
+namespace transport {
+
+class Logger;
+
+// Periodični poslovi procesa na jednoj niti (Asio steady_timer po poslu).
+// - Posao se ponavlja svakih 'interval' (fiksan ritam; ako kasni, sljedeći rok je od sada)
+// - Svi poslovi dijele nit: moraju biti kratki; blokirajući posao (npr. mrežni sync)
+//   ostaje u svojoj niti
+// - stop() otkaže sve tajmere i vraća se čim završi posao koji je trenutno u toku
+//   (nema spavanja do kraja intervala); nakon stop() servis se može ponovo pokrenuti
+class TimerService {
+public:
+    using Task = std::function<void()>;
+
+    TimerService();
+    ~TimerService();
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    void start();                       // idempotentno
+    void stop();                        // otkazuje i uklanja sve poslove
+    bool running() const { return running_; }
+
+    // Id posla (> 0); poslovi zakazani prije start() počinju kad se servis pokrene.
+    // run_now -> prvo izvršavanje odmah, umjesto nakon jednog intervala
+    uint64_t schedule(const std::string& name, std::chrono::milliseconds interval, Task task, bool run_now = false);
+    bool     cancel(uint64_t id);
+    size_t   size() const;
+    uint64_t runs() const { return runs_; }    // ukupno izvršenih poslova (testovi, statistika)
+
+private:
+    struct Entry {
+        std::string                 name;
+        std::chrono::milliseconds   interval;
+        Task                        task;
+        boost::asio::steady_timer   timer;
+        bool                        cancelled{false};
+
+        Entry(boost::asio::io_context& io, std::string n, std::chrono::milliseconds i, Task t)
+            : name(std::move(n)), interval(i), task(std::move(t)), timer(io) {}
+    };
+
+    void fire(const std::shared_ptr<Entry>& entry);   // izvrši posao i zakaži sljedeći rok (io nit)
+
+    boost::asio::io_context                                                   io_;
+    std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work_;
+    std::thread                                                               thread_;
+    std::atomic<bool>                                                         running_{false};
+    mutable std::mutex                                                        mutex_;
+    std::map<uint64_t, std::shared_ptr<Entry>>                                entries_;
+    uint64_t                                                                  next_id_{0};
+    std::atomic<uint64_t>                                                     runs_{0};
+    std::shared_ptr<Logger>                                                   logger_;   // greške poslova
+};
+
+} // namespace transport
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace transport {
+
+class Message;
+class MessageView;
+
+namespace tracing {
+
+// Kontekst se prenosi u polju poruke "traceparent" (W3C oblik):
+//   00-<trace id, 32 hex>-<span id pošiljaoca, 16 hex>-<01 uzorkovan | 00>
+// Odluku o uzorkovanju donosi onaj ko započne trace (klijent ili server bez dolaznog
+// konteksta); ostali je samo slijede, pa je trace ili potpun ili ga nema.
+constexpr const char* kTraceField = "traceparent";
+
+struct TraceContext {
+    uint64_t trace_hi{0};
+    uint64_t trace_lo{0};
+    uint64_t span_id{0};
+    bool     sampled{false};
+
+    bool        valid() const { return (trace_hi | trace_lo) != 0 && span_id != 0; }
+    std::string toHeader() const;
+    static TraceContext parse(std::string_view header);   // nevažeće -> prazan kontekst
+};
+
+// Jedan završen span (u redu za izvoz i iz readSpans)
+struct SpanRecord {
+    uint64_t    trace_hi{0};
+    uint64_t    trace_lo{0};
+    uint64_t    span_id{0};
+    uint64_t    parent_id{0};       // 0 -> korijen trace-a
+    int64_t     start_unix_ns{0};
+    uint64_t    duration_ns{0};
+    uint16_t    message_type{0};
+    int32_t     status{0};          // kod odgovora / greške, 0 ako nije postavljen
+    const char* name{""};           // string literal (ne kopira se na vrućoj putanji)
+    std::string decoded_name;       // popunjava samo readSpans
+    std::string service;            // popunjava samo readSpans
+};
+
+// Tracer procesa: spanovi idu u ograničen bafer, a zasebna nit ih periodično upisuje
+// u binarni fajl (magic "TPTRACE1", pa zapisi sa prefiksom dužine, vidi Tracing.cpp).
+// Dok nije konfigurisan (ili je isključen) Span ne čita sat i ne alocira.
+class Tracer {
+public:
+    struct Options {
+        std::string service = "transport";
+        std::string export_path;            // prazno -> tracing isključen
+        double      sample_rate = 0.0;      // korijenski trace-ovi na ovom procesu (0..1)
+        size_t      queue_limit = 8192;     // spanova na čekanju; višak se odbacuje
+        std::chrono::milliseconds flush_interval{200};
+    };
+    struct Stats {
+        uint64_t recorded{0};
+        uint64_t exported{0};
+        uint64_t dropped{0};
+        uint64_t write_errors{0};
+    };
+
+    static Tracer& instance();
+
+    bool  configure(const Options& options);    // false ako se fajl ne može otvoriti
+    void  shutdown();                           // upiše preostale spanove i zatvori fajl
+    bool  enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    bool  sampleRoot();                         // odluka za novi trace
+    void  submit(SpanRecord&& span);
+    bool  flush(std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    Stats getStats() const;
+
+    // Čitanje izvezenog fajla (testovi, alati)
+    static bool readSpans(const std::string& path, std::vector<SpanRecord>& out);
+
+private:
+    Tracer() = default;
+    ~Tracer();
+    void exportLoop();
+    bool writeBatch(const std::vector<SpanRecord>& batch);
+
+    Options                  options_;
+    std::atomic<bool>        enabled_{false};
+    std::atomic<uint64_t>    sample_threshold_{0};   // sample_rate * 2^64
+    mutable std::mutex       mutex_;
+    std::condition_variable  cv_;
+    std::condition_variable  flushed_cv_;
+    std::vector<SpanRecord>  pending_;
+    bool                     stop_{false};
+    bool                     writing_{false};
+    std::FILE*               file_{nullptr};
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<uint64_t>    recorded_{0};
+    std::atomic<uint64_t>    exported_{0};
+    std::atomic<uint64_t>    dropped_{0};
+    std::atomic<uint64_t>    write_errors_{0};
+};
+
+// Kontekst trenutne niti (uzorkovan span u toku ili nevažeći)
+const TraceContext& current();
+
+// RAII span. Prvi oblik je dijete trenutnog konteksta niti (ne radi ništa ako ga nema);
+// drugi započinje obradu zahtjeva: nastavlja 'parent' iz poruke, a bez njega sam odlučuje
+// o uzorkovanju. Dok je živ, uzorkovan span je trenutni kontekst niti.
+class Span {
+public:
+    explicit Span(const char* name, uint16_t message_type = 0);
+    Span(const char* name, const TraceContext& parent, uint16_t message_type);
+    ~Span();
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    bool                sampled() const { return active_; }
+    const TraceContext& context() const { return context_; }
+    void                setStatus(int status) { status_ = status; }
+    // Početak ranije od konstrukcije (npr. kad je stigao header zahtjeva)
+    void                setStartTime(std::chrono::steady_clock::time_point start) { if (active_) start_ = start; }
+
+private:
+    void begin(const char* name, const TraceContext& parent, uint16_t message_type, bool root);
+
+    bool                                  active_{false};
+    TraceContext                          context_;
+    TraceContext                          previous_;
+    uint64_t                              parent_id_{0};
+    const char*                           name_{""};
+    uint16_t                              message_type_{0};
+    int32_t                               status_{0};
+    std::chrono::steady_clock::time_point start_{};
+};
+
+// Završen korak mjeren izvan Span-a (npr. čitanje okvira prije nego što je kontekst poznat);
+// dijete trenutnog konteksta, ništa ako nit nema uzorkovan trace
+void recordSpan(const char* name, std::chrono::steady_clock::time_point start, uint64_t duration_ns,
+                uint16_t message_type = 0);
+
+// traceparent iz poruke; trenutni kontekst u poruku (ako je uzorkovan)
+TraceContext extract(const MessageView& view);
+TraceContext extract(const Message& message);
+void         inject(Message& message);
+
+} // namespace tracing
+} // namespace transport
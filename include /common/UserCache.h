@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Database.h"
+#include "Metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace transport {
+
+// Keš korisnika ispred Database::getUser (AUTH_REQUEST, REGISTER_USER), ključ je URN.
+// - Shardovi sa vlastitim mutex-om; izbacivanje CLOCK algoritmom (bit upotrebe po slotu,
+//   kazaljka preskače nedavno korištene), pa pogodak samo postavi bit.
+// - Negativni unosi pamte nepoznate URN-ove do negative_ttl, pa ponovljeni pokušaji sa
+//   nepostojećim URN-om ne idu u bazu.
+// - Database::registerUser/updateUser/deleteUser poništavaju URN u svim živim keševima
+//   procesa. Učitavanje iz baze započeto prije poništavanja se ne upisuje (epoha sharda).
+class UserCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        size_t               capacity    = 8192;   // zapisa ukupno (pozitivnih i negativnih)
+        size_t               shard_count = 16;
+        std::chrono::seconds negative_ttl{30};     // 0 -> nepoznati URN-ovi se ne pamte
+    };
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t negative_hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t   size{0};
+    };
+
+    // user != nullptr -> pogodak; missing -> poznato da ne postoji; inače promašaj, a
+    // ticket ide u put()/putMissing() nakon čitanja iz baze
+    struct Lookup {
+        std::shared_ptr<const User> user;
+        bool                        missing{false};
+        uint64_t                    ticket{0};
+
+        bool hit() const { return user || missing; }
+    };
+
+    UserCache();
+    explicit UserCache(Options options);
+    ~UserCache();
+
+    // Prije upotrebe (učitavanje konfiguracije): prazan keš sa novim dimenzijama
+    void configure(Options options);
+
+    Lookup lookup(const std::string& urn);
+    void   put(std::shared_ptr<const User> user, uint64_t ticket);
+    void   putMissing(const std::string& urn, uint64_t ticket);
+    void   invalidate(const std::string& urn);
+    void   clear();
+
+    // Čitanje kroz keš: na promašaju load() (npr. db->getUser) i upis rezultata. failed()
+    // poslije nullptr iz load() razlikuje grešku (ne pamti se) od nepoznatog URN-a
+    std::shared_ptr<const User> get(const std::string& urn,
+                                    const std::function<std::unique_ptr<User>()>& load,
+                                    const std::function<bool()>& failed = nullptr);
+
+    // Database putanje upisa: poništi URN u svim keševima procesa
+    static void invalidateEverywhere(const std::string& urn);
+
+    Stats  getStats() const;
+    size_t size() const;
+    // URN-ovi pozitivnih unosa, najviše max (snimak stanja za topli restart)
+    std::vector<std::string> keys(size_t max) const;
+
+private:
+    struct Slot {
+        std::string                 urn;
+        std::shared_ptr<const User> user;        // nullptr -> negativan unos
+        Clock::time_point           expires{};   // samo negativni
+        bool                        referenced{false};
+    };
+
+    struct Shard {
+        mutable std::mutex                      mutex;
+        std::unordered_map<std::string, size_t> index;   // URN -> slot
+        std::vector<Slot>                       slots;
+        std::vector<size_t>                     free;    // poništeni slotovi
+        size_t                                  hand{0};
+        uint64_t                                epoch{0}; // raste pri svakom poništavanju
+    };
+
+    void   build(const Options& options);
+    Shard& shardFor(const std::string& urn);
+    void   store(const std::string& urn, std::shared_ptr<const User> user, uint64_t ticket);
+    size_t claimSlotLocked(Shard& shard);
+    void   removeLocked(Shard& shard, size_t slot);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t                              shard_capacity_;
+    std::chrono::seconds                negative_ttl_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> negative_hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    // tp_user_cache_lookups_total{result="hit|negative_hit|miss"}, tp_user_cache_evictions_total
+    metrics::Counter* hit_counter_;
+    metrics::Counter* negative_counter_;
+    metrics::Counter* miss_counter_;
+    metrics::Counter* eviction_counter_;
+};
+
+} // namespace transport
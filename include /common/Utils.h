@@ -1,12 +1,29 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace transport {
 
 class Utils {
 public:
-    static std::string generateUUID();
+    // Vremenski sortirani identifikatori: 48 bita Unix ms + 80 slučajnih bita iz
+    // thread-local xoshiro256** (seed jednom po niti). U istoj ms na istoj niti slučajni
+    // dio se samo uvećava, pa ID-jevi jedne niti strogo rastu; leksikografski poredak
+    // prati vrijeme nastanka (novi redovi idu na kraj SQLite indeksa).
+    // Nisu tajne: tokeni sesije i dalje idu iz CSPRNG-a (SessionStore::generateToken).
+    static constexpr size_t kUlidLength = 26;     // Crockford base32
+    static constexpr size_t kUuidLength = 36;     // 8-4-4-4-12 hex
+
+    static std::string generateUUID();            // UUIDv7 (RFC 9562)
+    static std::string generateULID();
+    static std::string generateId(std::string_view prefix);   // prefix + ULID, npr. "TKT_01J9..."
+
+    // Upis u bafer pozivaoca, bez alokacije (kUlidLength / kUuidLength znakova, bez '\0')
+    static void formatULID(char* out);
+    static void formatUUID(char* out);
+
     static std::string getCurrentTimestamp();
 };
 
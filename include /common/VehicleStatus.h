@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Message.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace transport {
+
+// Stanje jednog vozila u VEHICLE_STATUS poruci (snapshot ili delta)
+struct VehicleStatusRecord {
+    std::string uri;
+    VehicleType type{VehicleType::BUS};
+    std::string route;
+    int         capacity{0};
+    int         available{0};
+    bool        active{true};
+    uint64_t    version{0};     // verzija inventara pri zadnjoj promjeni ovog vozila
+};
+
+// Kompaktno binarno polje za VEHICLE_STATUS ("vehicles" i "removed", isti format):
+//   [count varint] { [uri_len u8][uri][route_len u8][route][type u8][active u8]
+//                    [capacity varint][available varint][version varint] }*
+// URI i ruta duži od 255 bajtova se skraćuju (u bazi su kratki identifikatori).
+namespace vehicle_status {
+
+void encodeRecords(const std::vector<VehicleStatusRecord>& records, std::vector<uint8_t>& out);
+bool decodeRecords(const std::vector<uint8_t>& in, std::vector<VehicleStatusRecord>& records);
+
+// "A1,B2" -> {"A1","B2"}; prazno ili "*" -> {} (sve rute)
+std::vector<std::string> parseRoutes(const std::string& csv);
+
+} // namespace vehicle_status
+
+// Klijentska kopija stanja: primjenjuje snapshot i delte po verziji svakog vozila,
+// pa redoslijed dolaska (odgovor vs. delta sa broadcast niti) nije bitan
+class VehicleStatusView {
+public:
+    // false ako poruka nije ispravan VEHICLE_STATUS
+    bool apply(const Message& status);
+
+    // Za ponovno spajanje: since_version u GET_VEHICLE_STATUS
+    uint64_t version() const { return version_; }
+    const std::map<std::string, VehicleStatusRecord>& vehicles() const { return vehicles_; }
+    bool hasSnapshot() const { return has_snapshot_; }
+
+    // Odgovor iz kopije (edge čvor) sa istom semantikom kao SeatInventory::statusSince:
+    // zapisi noviji od since za rute (prazno -> sve); full ako je since 0, noviji od
+    // kopije ili stariji od zadnjeg snapshot-a (delte prije njega nisu poznate)
+    struct Delta {
+        uint64_t                         version{0};
+        bool                             full{false};
+        std::vector<VehicleStatusRecord> vehicles;
+        std::vector<VehicleStatusRecord> removed;   // samo uri + version
+    };
+    Delta since(const std::vector<std::string>& routes, uint64_t since_version) const;
+
+private:
+    uint64_t                                   version_{0};
+    uint64_t                                   floor_{0};       // verzija zadnjeg snapshot-a
+    bool                                       has_snapshot_{false};
+    std::map<std::string, VehicleStatusRecord> vehicles_;
+    std::map<std::string, uint64_t>            removed_;   // uri -> verzija brisanja
+};
+
+} // namespace transport
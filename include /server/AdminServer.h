@@ -2,26 +2,63 @@
 
 #include "ServerBase.h"
 #include "../common/TLSSocket.h"
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
 
 namespace transport {
 
+// Admin server: prihvata administrativne izmjene (cijene, vozila, kapacitet i njihove
+// grupne BULK_UPDATE_* varijante), provjerava ih i prosljeđuje centralnom serveru preko
+// jedne trajne TLS veze; odgovor centralnog servera ide nazad administratoru.
+// Konfiguracija: [admin] central_host, central_port, max_bulk_items, admin_key (isti kao
+// na centralnom serveru; dodaje se u LIST_RECORDS).
 class AdminServer : public ServerBase {
 public:
     AdminServer();
+    ~AdminServer() override;
     
     // Pokreće TLS/Asio accept petlju (cert/key ostaju iz ServerBase)
     bool start(int port, const std::string& config_file = "") override;
+    void stop() override;
+
+    void setCentralServer(const std::string& host, int port) { central_host_ = host; central_port_ = port; }
+    void setAdminKey(const std::string& key) { admin_key_ = key; }
+
+    struct RelayStats {
+        uint64_t relayed{0};        // zahtjevi proslijeđeni centralnom serveru
+        uint64_t rejected{0};       // odbijeni lokalno (tip, veličina)
+        uint64_t unavailable{0};    // centralni server nedostupan (502)
+    };
+    RelayStats getRelayStats() const;
 
 protected:
     // Obrada jedne TLS konekcije (poziva se iz connection callback-a)
     void handleClientMessage(std::unique_ptr<TLSSocket> client,
                              std::unique_ptr<Message> message) override;
 
-    // Aplikativna obrada poruke (stub/log dok ne dodamo tipove poruka)
+    // Admin poruke -> centralni server; ostalo 403
     void processMessage(std::unique_ptr<Message> message,
                         std::unique_ptr<TLSSocket>& client) override;
+
+private:
+    // Zahtjev + odgovor na vezi prema centralnom serveru; nullptr ako nije dostupan
+    std::unique_ptr<Message> relayToCentral(const Message& request);
+
+    std::string central_host_;
+    int         central_port_{0};
+    int         max_bulk_items_{4096};
+    int         relay_timeout_ms_{10000};  // rok odgovora centralnog servera
+    std::string admin_key_;
+
+    std::mutex                 upstream_mutex_;    // jedan zahtjev u letu na vezi
+    std::unique_ptr<TLSSocket> upstream_;
+
+    std::atomic<uint64_t> relayed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> unavailable_{0};
 };
 
 } // namespace transport
-
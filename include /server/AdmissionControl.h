@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace transport {
+
+// Prijem zahtjeva pod opterećenjem (ServerBase ga pita prije dispatch-a):
+// - token bucket po klijentu (ključ: URN, URI uređaja ili adresa peer-a): 'rate' zahtjeva/s,
+//   uz 'burst' odjednom; previše -> RATE_LIMITED sa vremenom do sljedećeg tokena
+// - ograničen broj zahtjeva u obradi (implicitni red: niti koje čekaju bazu, dnevnik,
+//   inventar); pun -> OVERLOADED odmah, umjesto da latencija raste bez granice
+// Bucket-i su u shardovima (mutex po shardu, kao SessionStore); kad shard pređe svoj dio
+// max_tracked_keys, izbacuje se najdavnije korišteni (LRU): neaktivni klijent bi ionako imao
+// pun bucket, a poplava novih ključeva ne briše stanje aktivnih.
+class AdmissionControl {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        double   rate{0.0};               // zahtjeva u sekundi po klijentu; 0 -> bez ograničenja
+        double   burst{0.0};              // kapacitet bucket-a; 0 -> max(1, rate)
+        int      max_inflight{0};         // zahtjeva u obradi na serveru; 0 -> bez ograničenja
+        uint32_t retry_after_ms{100};     // savjet klijentu za OVERLOADED / pun server
+        size_t   max_tracked_keys{65536};
+    };
+
+    enum class Decision { ADMIT, RATE_LIMITED, OVERLOADED };
+
+    struct Stats {
+        uint64_t admitted{0};
+        uint64_t rate_limited{0};
+        uint64_t overloaded{0};
+        int      inflight{0};
+        size_t   tracked_keys{0};
+    };
+
+    // Dozvola za jedan zahtjev; dok je živa, zahtjev se broji u max_inflight
+    class Ticket {
+    public:
+        Ticket() = default;
+        ~Ticket() { reset(); }
+        Ticket(Ticket&& other) noexcept : owner_(other.owner_), admitted_(other.admitted_) {
+            other.owner_    = nullptr;
+            other.admitted_ = false;
+        }
+        Ticket& operator=(Ticket&& other) noexcept;
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+
+        explicit operator bool() const { return admitted_; }
+        void reset();
+
+    private:
+        friend class AdmissionControl;
+        AdmissionControl* owner_{nullptr};   // != nullptr -> drži mjesto u inflight
+        bool              admitted_{false};
+    };
+
+    AdmissionControl() = default;
+    explicit AdmissionControl(const Options& options) { configure(options); }
+
+    // Nije thread-safe u odnosu na admit(); poziva se pri učitavanju konfiguracije
+    void           configure(const Options& options);
+    const Options& options() const { return options_; }
+    bool           enabled() const { return options_.rate > 0.0 || options_.max_inflight > 0; }
+
+    // retry_after_ms se postavlja za odbijene zahtjeve
+    Ticket admit(std::string_view key, Decision& decision, uint32_t& retry_after_ms,
+                 Clock::time_point now = Clock::now());
+    // Dozvola mimo limita (kontrolne poruke konekcije)
+    static Ticket bypass();
+
+    Stats getStats() const;
+
+private:
+    static constexpr size_t kShards = 16;
+
+    using LruList = std::list<const std::string*>;   // ključevi mape (stabilni pokazivači), najnoviji prvi
+
+    struct Bucket {
+        double            tokens{0.0};
+        Clock::time_point updated{};
+        LruList::iterator lru;
+    };
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Bucket> buckets;
+        LruList            lru;
+    };
+
+    // false + retry_after_ms ako bucket nema token
+    bool take(std::string_view key, Clock::time_point now, uint32_t& retry_after_ms);
+    static void evictOldest(Shard& shard);
+
+    Options                    options_;
+    double                     capacity_{1.0};
+    std::array<Shard, kShards> shards_;
+    std::atomic<int>           inflight_{0};
+    std::atomic<uint64_t>      admitted_{0};
+    std::atomic<uint64_t>      rate_limited_{0};
+    std::atomic<uint64_t>      overloaded_{0};
+};
+
+} // namespace transport
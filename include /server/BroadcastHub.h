@@ -0,0 +1,145 @@
+#pragma once
+
+#include "../common/Message.h"
+#include "../common/LatencyHistogram.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace transport {
+
+class TLSSocket;
+
+// Fan-out MULTICAST_UPDATE poruka prema prijavljenim klijentima.
+// - publish() samo stavi ažuriranje u redove pretplatnika i vrati se; slanje radi
+//   zasebna nit, pa spor klijent ne koči handler koji je izazvao broadcast.
+// - Poruka se serijalizuje jednom po verziji protokola u dijeljeni, nepromjenjiv bafer.
+// - Red po pretplatniku je ograničen: ažuriranje s istim ključem (tip + vozilo) koje
+//   još čeka zamjenjuje se novijim; ako se red ipak napuni, pretplatnik se izbacuje.
+// - Ažuriranja koja kod pretplatnika čekaju idu zajedno jednim upisom (Options::max_batch).
+// - unsubscribe() čeka slanje koje je u toku, pa nakon povratka hub više ne dira
+//   socket (pozvati prije uništavanja socketa, npr. iz onClientDisconnected).
+// - Socket async sesije (čitanje na strand-u, TLSSocket::usesAsyncIo()) dobija okvire kroz
+//   red async upisa socketa, nikad blokirajućim upisom sa niti hub-a; po pretplatniku je
+//   jedan upis u letu, a sljedeći krug zakazuje njegov completion (spor čitač puni red hub-a).
+// - Teme: prazna tema su MULTICAST_UPDATE poruke; ostale (npr. "status:A1") dobijaju
+//   samo socketi koji su se na njih prijavili. Red po socketu je zajednički za sve teme.
+class BroadcastHub {
+public:
+    struct Options {
+        size_t queue_limit = 64;   // ažuriranja na čekanju po pretplatniku
+        bool   coalesce    = true;
+        // Najviše ažuriranja jednog pretplatnika po upisu; spajaju se u TLS record-e do
+        // TLSSocket::kMaxRecordPayload umjesto po jednog record-a za svako ažuriranje
+        size_t max_batch   = 32;
+    };
+
+    struct Stats {
+        uint64_t published{0};
+        uint64_t delivered{0};
+        uint64_t coalesced{0};
+        uint64_t dropped_subscribers{0};
+        uint64_t send_failures{0};
+        uint64_t send_batches{0};        // upisi prema pretplatnicima (delivered / send_batches = ažuriranja po upisu)
+        size_t   subscribers{0};
+        size_t   queued{0};             // ažuriranja na čekanju u svim redovima
+        size_t   max_queue_depth{0};    // najduži red pretplatnika trenutno
+    };
+
+    BroadcastHub();
+    explicit BroadcastHub(Options options);
+    ~BroadcastHub();
+
+    void setOptions(Options options);
+    void start();
+    void stop();            // ažuriranja koja još čekaju se odbacuju
+    bool isRunning() const { return running_; }
+
+    void subscribe(TLSSocket* socket, const std::string& topic = "");
+    void unsubscribe(TLSSocket* socket);        // sve teme
+
+    // Prazan ključ -> ažuriranje se nikad ne spaja s drugim
+    void publish(std::unique_ptr<Message> update, std::string coalesce_key = "",
+                 const std::string& topic = "");
+
+    // Teme sa bar jednim aktivnim pretplatnikom
+    std::vector<std::string> activeTopics() const;
+
+    // Čeka da svi redovi budu ispražnjeni (testovi, gašenje)
+    bool waitIdle(std::chrono::milliseconds timeout);
+
+    Stats  getStats() const;
+    size_t subscriberCount() const;
+
+private:
+    struct Update {
+        std::unique_ptr<Message> message;
+        std::string              key;
+        std::chrono::steady_clock::time_point published_at;
+        // Okvir po verziji; gradi ga samo publisher nit, pri prvom slanju te verzije
+        std::array<std::shared_ptr<const std::vector<uint8_t>>, PROTOCOL_MAX_VERSION + 1> frames;
+    };
+
+    struct Subscriber {
+        TLSSocket* socket{nullptr};
+        // Pod mutex_
+        std::set<std::string>               topics;
+        std::deque<std::shared_ptr<Update>> queue;
+        bool scheduled{false};
+        bool dropped{false};
+        bool async{false};              // socket je u async modu (pri prijavi)
+        // Drži se tokom slanja; unsubscribe ga preuzima prije nego što vrati kontrolu
+        std::mutex send_mutex;
+        bool       alive{true};
+    };
+
+    // Async completion nadživi hub: poziva ga samo dok je hub pokrenut (stop() ga odvezuje)
+    struct Lifeline {
+        std::mutex    mutex;
+        BroadcastHub* hub{nullptr};
+    };
+
+    void publisherLoop();
+    const std::vector<uint8_t>& frameFor(Update& update, uint16_t version);
+    void dropLocked(Subscriber& sub);
+    void finishSend(const std::shared_ptr<Subscriber>& sub, const std::vector<std::shared_ptr<Update>>& batch,
+                    bool sent, std::chrono::steady_clock::time_point started);
+
+    Options options_;
+
+    mutable std::mutex      mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::unordered_map<TLSSocket*, std::shared_ptr<Subscriber>> subscribers_;
+    std::deque<std::shared_ptr<Subscriber>> ready_;
+    size_t in_flight_{0};
+
+    std::atomic<bool>            running_{false};
+    std::unique_ptr<std::thread> thread_;
+    std::shared_ptr<Lifeline>    lifeline_;
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> send_failures_{0};
+    std::atomic<uint64_t> send_batches_{0};
+
+    // Metrike procesa (metrics::Registry): publish -> slanje, trajanje slanja, dubina reda pri upisu
+    LatencyHistogram* delivery_latency_;
+    LatencyHistogram* send_latency_;
+    LatencyHistogram* queue_depth_;
+};
+
+} // namespace transport
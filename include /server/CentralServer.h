@@ -1,9 +1,22 @@
 #pragma once
 
 #include "ServerBase.h"
+#include "SeatInventory.h"
+#include "SessionStore.h"
+#include "BroadcastHub.h"
+#include "EventJournal.h"
+#include "ReplicationLog.h"
+#include "GroupIndex.h"
+#include "StateSnapshot.h"
+#include "TelemetryAggregator.h"
 #include "../common/Database.h"
+#include "../common/PriceCache.h"
+#include "../common/UserCache.h"
+#include "../common/Metrics.h"
+#include "../common/McastDatagram.h"
 #include "../common/TLSSocket.h"
 
+#include <deque>
 #include <map>
 #include <set>
 #include <thread>
@@ -14,6 +27,9 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 
 // Boost.Asio samo za UDP multicast (DISCOVER/ANNOUNCE)
 #include <boost/asio.hpp>
@@ -39,6 +55,21 @@ public:
     void setMulticastEnabled(bool on) { config_.enable_multicast = on; }
     void setMulticastAddress(const std::string& addr) { config_.multicast_address = addr; }
     void setMulticastPort(int port) { config_.multicast_port = port; }
+    // seat_reserved / ticket_purchased / price_updated kao potpisani UDP datagrami
+    void setMulticastDataPlane(bool on) { config_.multicast_data_plane = on; }
+    // Event journal (trajni upis kupovina/rezervacija); prazna putanja ga isključuje
+    void setJournalPath(const std::string& path) {
+        config_.journal_path    = path;
+        config_.journal_enabled = !path.empty();
+    }
+    // Snimak stanja za topli restart (sesije, inventar, vrući ključevi); prazna putanja ga isključuje
+    void setSnapshotPath(const std::string& path) {
+        config_.snapshot_path    = path;
+        config_.snapshot_enabled = !path.empty();
+    }
+    // Telemetrija: interval upisa zadnjeg stanja vozila u bazu i (opciono) slobodna mjesta iz brojača putnika
+    void setTelemetryPersistInterval(int ms) { config_.telemetry_persist_ms = ms; }
+    void setTelemetryFeedSeats(bool on) { config_.telemetry_feed_seats = on; }
 
     // Vehicle server registration
     bool registerVehicleServer(const std::string& server_id, VehicleType type, 
@@ -47,12 +78,32 @@ public:
     std::vector<std::string> getRegisteredVehicleServers();
 
     // Regional server communication
+    // Replikacija korisnika/vozila/cijena: dnevnik promjena se svakih [regional] sync_interval
+    // sekundi šalje u REPLICA_BATCH okvirima; regionalni server pri spajanju javlja svoj offset
     bool registerRegionalServer(const std::string& server_id, const std::string& address, int port);
+    // Pošalje sve zapise koje regionalni server još nema (snapshot ako je ispao iz prozora dnevnika)
     bool syncWithRegionalServer(const std::string& server_id);
     void broadcastToRegionalServers(std::unique_ptr<Message> message);
+    void setRegionalSyncInterval(int seconds) { config_.regional_sync_interval = seconds; }
+
+    struct RegionalSyncStats {
+        bool     active{false};
+        uint64_t acked{0};          // zadnji offset potvrđen od regionalnog servera
+        uint64_t connects{0};
+        uint64_t frames{0};
+        uint64_t snapshots{0};
+        uint64_t records{0};
+        uint64_t raw_bytes{0};      // zapisi prije kompresije
+        uint64_t wire_bytes{0};     // "records" polje kako je poslano
+    };
+    std::optional<RegionalSyncStats> getRegionalSyncStats(const std::string& server_id);
+    ReplicationLog::Stats            getReplicationStats() const { return replication_.getStats(); }
 
     // Price list management (javne administrativne operacije)
-    bool updatePriceList(VehicleType vehicle_type, TicketType ticket_type, double price);
+    // Upis u bazu + nova verzija cjenovnika u memoriji + "price_updated" broadcast
+    bool updatePriceList(VehicleType vehicle_type, TicketType ticket_type, double price,
+                         std::string* error = nullptr);
+    std::shared_ptr<const PriceSnapshot> getPrices() const { return prices_.get(); }
     bool updateVehicleCapacity(const std::string& uri, int capacity, int available_seats);
     void broadcastPriceUpdate();
 
@@ -72,13 +123,22 @@ public:
                                int passengers = 1);
 
     // Data aggregation from vehicle servers
+    // Promijenjena vozila iz agregatora telemetrije -> jedan upis u bazu (timer "data_collection")
     void collectVehicleData();
     void processVehicleUpdate(const std::string& server_id, std::unique_ptr<Message> message);
 
     // Statistics and monitoring
+    // Trenutno stanje (konekcije, sesije, inventar, redovi, pool); GET_STATS ga izvozi kao tp_<ključ> gauge-ve
     std::map<std::string, int> getSystemStatistics();
     std::vector<std::string> getActiveUsers();
-    std::map<VehicleType, int> getVehicleCapacityStatus();
+    std::map<VehicleType, int> getVehicleCapacityStatus();   // slobodna mjesta aktivnih vozila po tipu
+    SeatInventory::Stats       getSeatInventoryStats() const { return seat_inventory_.getStats(); }
+    size_t                     getActiveSessionCount() const { return sessions_.size(); }
+    UserCache::Stats           getUserCacheStats() const { return users_.getStats(); }
+    BroadcastHub::Stats        getBroadcastStats() const { return broadcast_.getStats(); }
+    EventJournal::Stats        getJournalStats() const { return journal_.getStats(); }
+    TelemetryAggregator::Stats getTelemetryStats() const { return telemetry_.getStats(); }
+    std::vector<TelemetryAggregator::RouteAggregate> getRouteTelemetry() const { return telemetry_.routes(); }
 
     // Multicast communication (limited use as per requirements)
     void sendMulticastUpdate(const std::string& update_type, 
@@ -89,6 +149,9 @@ protected:
                              std::unique_ptr<Message> message) override;
     void processMessage(std::unique_ptr<Message> message, 
                         std::unique_ptr<TLSSocket>& client) override;
+    void processMessageView(const MessageView& view,
+                            std::unique_ptr<TLSSocket>& client) override;
+    void onClientDisconnected(TLSSocket* client) override;
 
 private:
     struct VehicleServerInfo {
@@ -107,14 +170,8 @@ private:
         int port;
         bool active{false};
         std::unique_ptr<TLSSocket> connection;
-    };
-
-    struct ClientSession {
-        std::string session_id;
-        std::string user_urn;
-        bool authenticated{false};
-        std::chrono::system_clock::time_point last_activity{};
-        std::unique_ptr<TLSSocket> socket;
+        bool snapshot_needed{true};     // epoch regionalne kopije nije naš dnevnik
+        RegionalSyncStats stats;
     };
 
     // Server data
@@ -124,70 +181,189 @@ private:
     // Connected servers
     std::map<std::string, VehicleServerInfo> vehicle_servers_;
     std::map<std::string, RegionalServerInfo> regional_servers_;
-    std::mutex servers_mutex_;
+    std::mutex servers_mutex_;      // oba registra; replikacija drži bravu tokom razmjene sa regionalnim
+
+    // Client sessions (sharding po tokenu + timer wheel za istek)
+    SessionStore sessions_;
 
-    // Client sessions
-    std::map<std::string, ClientSession> client_sessions_;
-    std::mutex sessions_mutex_;
+    // Korisnici po URN-u ispred Database::getUser (AUTH_REQUEST, REGISTER_USER)
+    UserCache users_;
 
-    // Background tasks
-    std::unique_ptr<std::thread> data_collection_thread_;
-    std::unique_ptr<std::thread> heartbeat_thread_;
-    std::unique_ptr<std::thread> cleanup_thread_;
+    // Grupe: lider i članovi u memoriji (provjere bez upita), učitavanje pri prvom pristupu
+    GroupIndex groups_;
+    std::shared_ptr<const GroupIndex::Entry> findGroup(const std::string& group_name);
+
+    // Background tasks: periodični poslovi su na timers_ (ServerBase); regionalni sync
+    // radi blokirajući mrežni I/O pa ostaje u svojoj niti
+    std::unique_ptr<std::thread> regional_sync_thread_;
+    uint64_t                     status_pushed_{0};    // verzija inventara do koje su delte poslane (timer nit)
+
+    // Sjedišta u memoriji (rezervacija/kupovina bez SQLite round-tripa)
+    SeatInventory seat_inventory_;
     std::atomic<bool> background_running_{false};
 
-    // Multicast subscribers (live client sockets)
-    std::mutex broadcast_mutex_;
-    std::vector<TLSSocket*> subscribers_;
+    // Cjenovnik: [pricing]/[discounts] + price_list, zamjena snapshot-a pri UPDATE_PRICE
+    PriceCache prices_;
+    // Upis cijena u bazu i zamjena snapshot-a (i broadcast) istim redom: bez nje dva admina
+    // mogu commit-ovati A pa B, a snapshot završi na A
+    std::mutex price_write_mutex_;
+
+    // MULTICAST_UPDATE pretplatnici (autentifikovani klijenti), slanje na zasebnoj niti
+    BroadcastHub broadcast_;
+
+    // Append-only dnevnik: odgovor na kupovinu čeka samo njegov group commit,
+    // karte/plaćanja u SQLite upisuje journalApplyLoop (journal_applied_ = zadnji LSN u bazi)
+    EventJournal          journal_;
+    std::atomic<uint64_t> journal_applied_{0};
+
+    // Promjene korisnika/vozila/cijena za regionalne servere (seat brojači ne ulaze u dnevnik)
+    ReplicationLog replication_;
+
+    // VEHICLE_TELEMETRY: red + nit agregatora, u bazu ide samo zadnje stanje vozila po intervalu
+    TelemetryAggregator telemetry_;
+    // feed_seats: zadnja popunjenost primijenjena na mjesta (samo pozadinska nit); mjesta se
+    // pomjeraju za razliku, pa prodane a još neiskorištene karte ostaju skinute
+    std::map<std::string, int> fed_occupancy_;
+
+    // tp_handler_seconds{type=...}: popunjeno u konstruktoru, poslije samo čitanje (bez brave)
+    std::unordered_map<uint16_t, LatencyHistogram*> handler_latency_;
+    LatencyHistogram*                               handler_other_{nullptr};
+    LatencyHistogram* handlerHistogram(MessageType type) const;
 
     // Configuration
     struct Config {
         int max_connections = 1000;
         int heartbeat_interval = 30;       // seconds
         int session_timeout = 3600;        // seconds
-        int data_collection_interval = 60; // seconds
         bool enable_multicast = false;
         std::string multicast_address = "239.192.0.1"; // administrativni opseg
         int multicast_port = 30001;
+        bool multicast_data_plane = false;
+        int multicast_ttl = 1;
+        int multicast_resync_window = 1024;   // datagrama koji se čuvaju za MCAST_RESYNC
+        std::string multicast_signing_key;    // Ed25519 seed (hex); prazno -> slučajan ključ pri pokretanju
+        bool journal_enabled = false;
+        std::string journal_path = "central_journal.bin";
+        int journal_commit_delay_us = 100;     // group commit: čekanje na još zapisa prije msync-a
+        int journal_apply_interval_ms = 20;    // journal -> SQLite
+        long long journal_compact_bytes = 16ll << 20;   // [journal] compact_mb: prazni se kad je sve upisano
+        int batch_max_items = 256;             // [batch] max_items: stavki u jednoj BATCH poruci
+        int purchase_key_window = 65536;       // [batch] idempotency_window: zapamćenih idempotency_key u memoriji
+        bool regional_sync = true;             // [regional] enable_regional_sync
+        int regional_sync_interval = 300;      // seconds
+        std::string regional_servers;          // host:port,host:port
+        std::string regional_sync_key;         // dijeljena tajna u REPLICA_SYNC (regionalni bez ključa odbija sync)
+        int regional_timeout_ms = 5000;        // [regional] timeout_ms: rok za odgovor regionalnog servera
+        int regional_batch_records = 1024;     // zapisa u jednom REPLICA_BATCH okviru
+        int regional_compression = 6;          // zlib nivo, 0 = bez kompresije
+        int admin_bulk_max_items = 4096;       // [admin] max_bulk_items: stavki u BULK_UPDATE_* poruci
+        int admin_page_max_rows = 500;         // [admin] page_max_rows: redova u jednom LIST_RECORDS odgovoru
+        std::string admin_key;                 // [admin] admin_key: LIST_RECORDS samo uz ovaj ključ (prazno -> odbija)
+        bool snapshot_enabled = false;         // [snapshot] enabled
+        std::string snapshot_path = "central_snapshot.bin";
+        int snapshot_interval = 60;            // [snapshot] interval_s: periodični (crash) snimak
+        int telemetry_persist_ms = 5000;       // [telemetry] persist_interval_ms: upis zadnjeg stanja vozila
+        bool telemetry_feed_seats = false;     // [telemetry] feed_seats: promjena broja putnika pomjera slobodna mjesta
+        int telemetry_max_samples = 4096;      // [telemetry] max_samples: uzoraka u jednoj poruci
     } config_;
 
     // Internal methods
     bool initializeDatabase();
+    std::string databasePath() const { return db_path_.empty() ? "central_server.db" : db_path_; }
     void startBackgroundTasks();
     void stopBackgroundTasks();
     
     // Message handling methods
-    void handleConnectRequest(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    // Vrući handleri čitaju polja direktno iz view-a (bez mape); true ako je tip obrađen
+    bool dispatchView(const MessageView& view, std::unique_ptr<TLSSocket>& client);
+    void handleConnectRequest(const MessageView& view, std::unique_ptr<TLSSocket>& client);
     void handleAuthRequest(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
     void handleUserRegistration(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
     void handleDeviceRegistration(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
-    void handleSeatReservation(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
-    void handleTicketPurchase(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleSeatReservation(const MessageView& view, std::unique_ptr<TLSSocket>& client);
+    void handleTicketPurchase(const MessageView& view, std::unique_ptr<TLSSocket>& client);
+    // N rezervacija/kupovina: jedan trajni upis, odgovor sa statusom po stavci,
+    // jedan MULTICAST_UPDATE po vozilu
+    void handleBatch(const MessageView& view, std::unique_ptr<TLSSocket>& client);
+    // Provjera + skidanje mjesta u inventaru bez odgovora i trajnog upisa;
+    // vraća status (200 ili kod greške) i opis greške za odgovor
+    int  prepareReservation(const MessageView& view, journal_events::SeatChange& out, std::string& error);
+    int  preparePurchase(const MessageView& view, journal_events::Purchase& out, std::string& error);
     void handleGroupCreation(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
     void handleUserDeletion(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
 
     // NEW: group membership handlers
     void handleAddMemberToGroup(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleAddMembersToGroup(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
     void handleRemoveMemberFromGroup(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
 
     // NEW: admin update handlers (cjenovnik/vozila/kapacitet)
     void handleUpdatePrice(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
     void handleUpdateVehicle(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
     void handleUpdateCapacity(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    // Grupne izmjene: jedna transakcija, jedna zamjena inventara/cjenovnika u memoriji, jedan broadcast
+    void handleBulkUpdateVehicles(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleBulkUpdatePrices(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleMcastResync(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleVehicleStatus(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleGetStats(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleListRecords(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client);
+    void handleTelemetry(const MessageView& view, std::unique_ptr<TLSSocket>& client);
 
     // Background task methods
-    void dataCollectionLoop();
-    void heartbeatLoop();
-    void sessionCleanupLoop();
+    // Poslovi na timers_ (jedan prolaz po pozivu)
+    void checkpointWal();
+    void flushInventory();
+    void pushStatusDeltas();    // per-route delte za "status:<ruta>" pretplatnike
+    void drainJournal();
+    void regionalSyncLoop();
+
+    // Journal: otvaranje + oporavak (karte koje nisu stigle u bazu, stanje mjesta)
+    bool   openJournal();
+    // Upiše trajne zapise nakon journal_applied_ u bazu (idempotentno); broj zapisa
+    size_t applyJournal(Database& db);
+    void   compactJournal(Database& db);
+
+    // Snimak stanja: clean (stop(), sve upisano u bazu) vraća inventar i sesije, svaki
+    // snimak zagrijava keš korisnika i indeks grupa; false ako nema upotrebljivog snimka
+    bool readSnapshot(StateSnapshot::Data& data);
+    void warmFromSnapshot(const StateSnapshot::Data& data);
+    void writeSnapshot(bool clean);
+    // CAPACITY_SET zapisi (uri, kapacitet) sa stanjem mjesta iz inventara; čeka da budu
+    // trajni, false ako zapis nije upisan/potvrđen (true bez dnevnika)
+    bool journalCapacity(const std::vector<std::pair<std::string, int>>& capacities);
+
+    // Korisnik kroz keš; na promašaj iz db (ili konekcije iz pool-a). failed: greška baze,
+    // nullptr tada ne znači nepoznat URN i ne pamti se kao negativan unos
+    std::shared_ptr<const User> findUser(const std::string& urn, bool& failed, Database* db = nullptr);
+
+    // Vozilo iz inventara; na promašaj se jednom čita iz baze i dodaje u inventar
+    std::optional<SeatInventory::Snapshot> locateVehicle(const std::string& uri, const std::string& route,
+                                                         VehicleType type, bool any_type);
+    // Admin izmjena iz baze u inventar, na mjestu; uz seats_seen i nova mjesta
+    // (seats_seen = slobodna mjesta pročitana prije upisa u bazu, v. SeatInventory::amend)
+    void refreshInventory(const std::string& uri, std::optional<int> seats_seen = std::nullopt);
+    // Trenutni brojač iz inventara za upis mjesta u bazu (rad bez dnevnika)
+    Database::SeatCount liveSeats() const {
+        return [this](const std::string& u) { return seat_inventory_.availableOf(u); };
+    }
+    void loadPrices(Database& db);
 
     // Vehicle server communication
     bool connectToVehicleServer(VehicleServerInfo& server);
     void disconnectFromVehicleServer(const std::string& server_id);
     void sendToVehicleServer(const std::string& server_id, std::unique_ptr<Message> message);
 
-    // Regional server communication
+    // Regional server communication (pod servers_mutex_)
     bool connectToRegionalServer(RegionalServerInfo& server);
     void sendToRegionalServer(const std::string& server_id, std::unique_ptr<Message> message);
+    // Zahtjev + odgovor na vezi regionalnog servera; nullptr (i veza zatvorena) na grešku
+    std::unique_ptr<Message> exchangeWithRegional(RegionalServerInfo& server, const Message& request);
+    // Svi korisnici, vozila i cijene; `to` = head dnevnika prije čitanja
+    void buildReplicaSnapshot(std::vector<ReplicationRecord>& records, uint64_t& to);
+    void replicateUser(const std::string& urn, const std::string& name, bool deleted = false);
+    void replicateVehicle(const std::string& uri);
+    void replicatePrice(VehicleType vehicle_type, TicketType ticket_type, const PriceSnapshot::Fare& fare);
 
     // Session management
     std::string createSession(const std::string& user_urn, std::unique_ptr<TLSSocket> socket);
@@ -199,6 +375,15 @@ private:
     std::string generateSessionId();
     std::string generateTicketId();
     std::string generateTransactionId();
+
+    // Kupovina sa idempotency_key (offline red uređaja ponavlja zahtjev nakon prekida): transaction_id
+    // je "IK-" + ključ. Nedavni ključevi su u memoriji (prozor purchase_key_window), stariji se
+    // traže u payments. RECORDED (208) tek kad je prvi pokušaj trajno upisan (recordPurchaseKey),
+    // dotle IN_FLIGHT (425): ponovljen zahtjev ne smije dobiti potvrdu kupovine koja još može pasti
+    enum class PurchaseKeyState { CLAIMED, IN_FLIGHT, RECORDED };
+    PurchaseKeyState claimPurchaseKey(const std::string& transaction_id);
+    void recordPurchaseKey(const std::string& transaction_id);
+    void releasePurchaseKey(const std::string& transaction_id);
     std::string getCurrentTimestamp();
     bool        validateURN(const std::string& urn);
     bool        validateURI(const std::string& uri);
@@ -216,6 +401,8 @@ private:
     bool setupMulticast();
     void cleanupMulticast();
     void startMulticastReceive_();
+    // true ako je update poslan kao datagram (tada ne ide preko TLS broadcast-a)
+    bool publishDatagram(const std::string& update_type, const std::map<std::string, std::string>& data);
 
     std::unique_ptr<boost::asio::io_context>      mcast_io_;
     std::unique_ptr<std::thread>                  mcast_thread_;
@@ -223,6 +410,28 @@ private:
     boost::asio::ip::udp::endpoint                mcast_group_;
     boost::asio::ip::udp::endpoint                mcast_listen_ep_;
     std::array<char, 512>                         mcast_rx_buf_{};
+
+    // UDP data plane: redni brojevi, ključ za potpis i prozor za ponovno slanje preko TLS-a
+    struct McastReplayEntry {
+        uint64_t seq;
+        std::shared_ptr<const std::vector<uint8_t>> datagram;
+    };
+    std::mutex                   mcast_pub_mutex_;
+    bool                         mcast_data_ready_{false};   // pod mcast_pub_mutex_
+    mcast::Signer                mcast_signer_;
+    uint64_t                     mcast_seq_{0};
+    std::deque<McastReplayEntry> mcast_replay_;
+
+    // Ključ -> generacija zauzimanja; FIFO unos briše ključ samo ako generacija odgovara
+    // (oslobođen pa ponovo zauzet ključ ne izbacuje se preko starog unosa)
+    struct PurchaseKey {
+        uint64_t gen{0};
+        bool     recorded{false};   // kupovina trajno upisana (dnevnik/baza)
+    };
+    std::mutex                                     purchase_keys_mutex_;
+    std::unordered_map<std::string, PurchaseKey>   purchase_keys_;
+    std::deque<std::pair<std::string, uint64_t>>   purchase_key_order_;   // FIFO za izbacivanje iz prozora
+    uint64_t                                       purchase_key_seq_{0};
 };
 
 } // namespace transport
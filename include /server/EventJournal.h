@@ -0,0 +1,151 @@
+#pragma once
+
+#include "../common/Database.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace transport {
+
+// Append-only binarni dnevnik događaja (CentralServer): rezervacije, kupovine
+// (karte + plaćanje) i promjene kapaciteta. Fajl je memorijski mapiran; zapis je samo memcpy
+// pod kratkim mutex-om, a trajnost (msync) radi jedna committer nit za sve
+// zapise koji su se skupili (group commit) -> waitDurable() čeka taj commit.
+//
+// Fajl: zaglavlje [magic "TPJ1"][u32 verzija][u64 base_lsn] (64 B), pa zapisi:
+//   [u32 payload_len][u32 crc32][u64 lsn][u64 timestamp_ms][u8 tip][payload] (poravnato na 8 B)
+// CRC pokriva sve od lsn-a do kraja payload-a. Pri open() se zapisi provjeravaju
+// redom (CRC + uzastopni LSN); prvi neispravan je pokidan rep i tu dnevnik završava.
+class EventJournal {
+public:
+    enum class EventType : uint8_t {
+        SEAT_RESERVED     = 1,
+        TICKETS_PURCHASED = 2,
+        CAPACITY_SET      = 3,
+    };
+
+    struct Options {
+        size_t                    grow_bytes{16u << 20};   // fajl raste u ovim koracima
+        std::chrono::microseconds commit_delay{100};       // committer čeka još zapisa prije msync-a
+    };
+
+    struct Record {
+        uint64_t             lsn{0};
+        EventType            type{EventType::SEAT_RESERVED};
+        uint64_t             timestamp_ms{0};
+        std::vector<uint8_t> payload;
+    };
+
+    struct Stats {
+        uint64_t appended{0};
+        uint64_t commits{0};       // msync poziva (jedan pokriva sve zapise do tada)
+        uint64_t bytes{0};         // zauzeto u fajlu (bez zaglavlja)
+        uint64_t last_lsn{0};
+        uint64_t durable_lsn{0};
+    };
+
+    EventJournal() = default;
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    bool open(const std::string& path);
+    bool open(const std::string& path, const Options& options);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    // LSN novog zapisa (0 ako dnevnik nije otvoren / failed() / greška pri rastu fajla)
+    uint64_t append(EventType type, const std::vector<uint8_t>& payload);
+    // Čeka da zapis (i svi prije njega) bude na disku; false ako je dnevnik zatvoren ili failed()
+    bool     waitDurable(uint64_t lsn);
+    // msync/fdatasync nije uspio: stanje stranica na disku je nepoznato pa dnevnik više ne
+    // prima zapise (fail-stop); nepotvrđene zapise razrješava oporavak pri sljedećem startu
+    bool     failed() const;
+
+    // Kopije trajnih zapisa sa lsn > after_lsn, najviše max_records (redom)
+    std::vector<Record> read(uint64_t after_lsn, size_t max_records = 256) const;
+
+    // Ako od expected_last nije bilo novih zapisa: isprazni dnevnik (LSN ostaje monoton)
+    bool resetIfLast(uint64_t expected_last);
+
+    uint64_t    lastLsn() const;
+    uint64_t    durableLsn() const { return durable_lsn_.load(); }
+    Stats       getStats() const;
+    std::string lastError() const;
+
+private:
+    static constexpr size_t   kHeaderSize       = 64;
+    static constexpr size_t   kRecordHeaderSize = 25;
+    static constexpr uint32_t kVersion          = 1;
+
+    bool mapLocked(size_t size);
+    bool growLocked(size_t need);
+    void writeHeaderLocked();
+    void recoverLocked();
+    void committerLoop();
+
+    std::string path_;
+    Options     options_;
+    int         fd_{-1};
+
+    // map_mutex_: exclusive samo za remap (rast fajla); msync ga drži shared
+    mutable std::shared_mutex map_mutex_;
+    uint8_t*                  map_{nullptr};
+    size_t                    map_size_{0};
+
+    mutable std::mutex    mutex_;             // write_off_, offsets_, base/last lsn
+    size_t                write_off_{kHeaderSize};
+    size_t                synced_off_{kHeaderSize};   // do ovdje je msync urađen
+    uint64_t              base_lsn_{1};       // LSN prvog zapisa u fajlu
+    uint64_t              last_lsn_{0};
+    std::vector<size_t>   offsets_;           // offset zapisa base_lsn_ + i
+    std::string           last_error_;
+    bool                  grew_{false};       // fajl je rastao od zadnjeg commita (fdatasync)
+    bool                  failed_{false};     // commit nije uspio, vidi failed()
+
+    std::atomic<uint64_t>   durable_lsn_{0};
+    std::atomic<uint64_t>   appended_{0};
+    std::atomic<uint64_t>   commits_{0};
+    std::condition_variable commit_cv_;       // committer: ima posla
+    std::condition_variable durable_cv_;      // čekači: durable_lsn_ se pomjerio
+    size_t                  waiters_{0};      // pod mutex_
+    bool                    stop_{false};
+    std::thread             committer_;
+};
+
+// Sadržaj događaja (payload zapisa). Mjesta su apsolutna stanja vozila uz
+// seat_seq iz SeatInventory, pa pri oporavku važi zapis sa najvećim seat_seq.
+namespace journal_events {
+
+struct SeatChange {
+    std::string vehicle_uri;
+    std::string user_urn;       // prazno za CAPACITY_SET
+    std::string route;
+    int         seats{0};       // broj mjesta u ovoj promjeni (informativno)
+    int         capacity{0};
+    int         available{0};   // stanje nakon promjene
+    uint32_t    seat_seq{0};
+};
+
+struct Purchase {
+    SeatChange          seats;
+    std::vector<Ticket> tickets;
+    Payment             payment{};
+};
+
+std::vector<uint8_t> encode(const SeatChange& e);
+std::vector<uint8_t> encode(const Purchase& e);
+bool decode(const std::vector<uint8_t>& in, SeatChange& e);
+bool decode(const std::vector<uint8_t>& in, Purchase& e);
+
+} // namespace journal_events
+
+} // namespace transport
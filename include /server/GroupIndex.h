@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../common/Database.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace transport {
+
+// Grupe po imenu u memoriji CentralServera: id, lider i aktivni članovi. Provjera lidera
+// i članstva za ADD_MEMBER(S)_TO_GROUP / DELETE_GROUP_MEMBER ide bez upita prema bazi.
+// - Grupa se učita iz baze (Database::getGroupByName) pri prvom pristupu, poslije je
+//   handleri održavaju nakon uspješnog upisa (write-through); CentralServer je jedini
+//   pisac group tabela dok radi.
+// - Članstvo u memoriji je brza provjera (odbijanje bez upita); upis u bazu ostaje
+//   konačna provjera, pa zakašnjelo učitavanje ne može dodati člana dvaput.
+// - Zapis je nepromjenjiv (shared_ptr<const Entry>); izmjena pravi kopiju, pa čitalac
+//   drži konzistentan snimak i bez brave.
+// - Učitavanje započeto prije izmjene se ne upisuje (epoha, kao UserCache): izmjena
+//   neučitane grupe inače ne bi stigla do reda pročitanog prije upisa u bazu.
+class GroupIndex {
+public:
+    struct Entry {
+        int                   group_id{0};
+        std::string           leader_urn;
+        std::set<std::string> members;    // uključuje lidera
+    };
+    using Loader = std::function<std::unique_ptr<Group>()>;
+
+    // Iz memorije ili kroz load() (nullptr -> grupa ne postoji; ne pamti se)
+    std::shared_ptr<const Entry> find(const std::string& group_name, const Loader& load);
+    std::shared_ptr<const Entry> find(const std::string& group_name) const;   // samo memorija
+
+    void put(const std::string& group_name, Entry entry);
+    void addMembers(const std::string& group_name, const std::vector<std::string>& urns);
+    void removeMember(const std::string& group_name, const std::string& urn);
+    void erase(const std::string& group_name);
+    void clear();
+
+    size_t size() const;
+    // Imena grupa u memoriji (snimak stanja za topli restart)
+    std::vector<std::string> names() const;
+
+private:
+    mutable std::mutex                                            mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const Entry>> groups_;
+    uint64_t                                                      epoch_{0};   // raste pri svakoj izmjeni
+};
+
+} // namespace transport
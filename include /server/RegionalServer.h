@@ -0,0 +1,87 @@
+#pragma once
+
+#include "ServerBase.h"
+#include "SessionStore.h"
+#include "../common/PriceCache.h"
+#include "../common/Replication.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace transport {
+
+// Regionalni server: kopija korisnika, vozila i cjenovnika koju puni CentralServer
+// (REPLICA_SYNC + REPLICA_BATCH na vezi koju otvara centralni server), pa AUTH_REQUEST
+// i GET_PRICES odgovara bez odlaska na centralni server. Sesije su lokalne ovom serveru.
+// Kopija je u memoriji: nakon restarta javlja offset 0 i dobija snapshot.
+// Konfiguracija: [regional] sync_key (mora biti isti kao na centralnom serveru);
+// bez ključa server odbija REPLICA_SYNC.
+class RegionalServer : public ServerBase {
+public:
+    RegionalServer();
+    ~RegionalServer() override;
+
+    bool start(int port, const std::string& config_file = "") override;
+
+    void setSyncKey(const std::string& key) { sync_key_ = key; }
+
+    struct ReplicaStats {
+        uint64_t epoch{0};          // dnevnik centralnog servera iz kog je kopija
+        uint64_t offset{0};         // zadnji primijenjen zapis
+        size_t   users{0};
+        size_t   vehicles{0};
+        uint64_t batches{0};
+        uint64_t snapshots{0};
+        uint64_t records{0};
+        uint64_t rejected{0};       // batch-evi koji se ne nastavljaju na kopiju
+        uint64_t local_auth{0};
+        uint64_t price_reads{0};
+    };
+    ReplicaStats getReplicaStats() const;
+
+    bool hasUser(const std::string& urn) const;
+    bool getVehicle(const std::string& uri, Vehicle& out) const;
+    std::shared_ptr<const PriceSnapshot> getPrices() const { return prices_.get(); }
+
+protected:
+    void handleClientMessage(std::unique_ptr<TLSSocket> client,
+                             std::unique_ptr<Message> message) override;
+    void processMessage(std::unique_ptr<Message> message,
+                        std::unique_ptr<TLSSocket>& client) override;
+    void onClientDisconnected(TLSSocket* client) override;
+
+private:
+    // Veza koja je predstavila ispravan ključ postaje replikacijska (samo ona šalje REPLICA_BATCH)
+    void handleReplicaSync(const Message& request, std::unique_ptr<TLSSocket>& client);
+    void handleReplicaBatch(const Message& request, std::unique_ptr<TLSSocket>& client);
+    void handleAuthRequest(const Message& request, std::unique_ptr<TLSSocket>& client);
+
+    std::string sync_key_;
+
+    std::mutex                            peers_mutex_;
+    std::unordered_set<const TLSSocket*>  replica_peers_;
+
+    mutable std::shared_mutex                   replica_mutex_;
+    uint64_t                                    epoch_{0};
+    uint64_t                                    offset_{0};
+    std::unordered_map<std::string, std::string> users_;      // urn -> ime
+    std::unordered_map<std::string, Vehicle>     vehicles_;
+    PriceCache                                   prices_;
+
+    SessionStore sessions_;
+
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> snapshots_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> local_auth_{0};
+    std::atomic<uint64_t> price_reads_{0};
+};
+
+} // namespace transport
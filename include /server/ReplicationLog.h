@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../common/Replication.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace transport {
+
+// Uređen dnevnik promjena (korisnici, vozila, cijene) koje CentralServer šalje
+// regionalnim serverima. Offset-i rastu od 1 bez rupa; čuva se zadnjih `capacity`
+// zapisa, pa regionalni server koji je zaostao više od toga dobija snapshot.
+// epoch se mijenja pri svakom pokretanju (offset-i iz ranijeg dnevnika ne važe).
+class ReplicationLog {
+public:
+    struct Stats {
+        uint64_t epoch{0};
+        uint64_t head{0};          // zadnji dodijeljeni offset (0 = prazan)
+        uint64_t first{0};         // najstariji zapis u memoriji (0 = nema)
+        size_t   retained{0};
+    };
+
+    explicit ReplicationLog(size_t capacity = 65536);
+
+    ReplicationLog(const ReplicationLog&) = delete;
+    ReplicationLog& operator=(const ReplicationLog&) = delete;
+
+    uint64_t epoch() const { return epoch_; }
+    uint64_t head() const;
+    void     setCapacity(size_t capacity);
+
+    // Dodaje zapis na kraj; vraća njegov offset
+    uint64_t append(ReplicationRecord::Kind kind, std::string key, std::string value = "");
+
+    // Zapisi sa offset > from, najviše max; false ako from nije u prozoru dnevnika
+    // (stariji od najstarijeg zapisa ili noviji od head) -> treba snapshot
+    bool since(uint64_t from, size_t max, std::vector<ReplicationRecord>& out) const;
+
+    Stats getStats() const;
+
+private:
+    const uint64_t                epoch_;
+    mutable std::mutex            mutex_;
+    std::deque<ReplicationRecord> records_;
+    uint64_t                      head_{0};
+    size_t                        capacity_;
+};
+
+} // namespace transport
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "../common/Database.h"
+#include "../common/Message.h"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace transport {
+
+// In-memory inventar sjedišta (CentralServer).
+// Broj slobodnih mjesta po vozilu je atomski brojač: rezervacija/kupovina je
+// jedan CAS bez SQLite-a. Promjene se označe kao "dirty" i periodično upisuju
+// u tabelu vehicles u jednoj transakciji (write-behind, vidi flush()).
+// Mape štiti shared_mutex (struktura se mijenja samo pri load/upsert/remove).
+// Sekundarni indeks: ruta -> vozila grupisana po tipu, pa je "bilo koje vozilo
+// na ruti X sa slobodnim mjestom" jedan hash lookup.
+// Svaka promjena vozila dobija novu verziju inventara; statusSince() iz toga
+// vraća snapshot ili samo vozila promijenjena nakon verzije koju klijent već ima.
+class SeatInventory {
+public:
+    struct Snapshot {
+        std::string uri;
+        VehicleType type{VehicleType::BUS};
+        std::string route;
+        int         capacity{0};
+        int         available{0};
+        bool        active{true};
+        uint64_t    version{0};     // verzija inventara pri zadnjoj promjeni vozila
+        uint32_t    seat_seq{0};    // brojač promjena mjesta ovog vozila (uz 'available' atomski)
+    };
+
+    // Odgovor na GET_VEHICLE_STATUS: snapshot (full) ili delta od 'since'
+    struct RouteStatus {
+        uint64_t                 version{0};
+        bool                     full{false};
+        std::vector<Snapshot>    vehicles;
+        std::vector<Snapshot>    removed;   // uklonjena (ili premještena) vozila, samo u delti (uri/route/version)
+    };
+
+    struct Reservation {
+        bool found{false};      // vozilo postoji u inventaru
+        bool ok{false};         // mjesta su skinuta
+        int  capacity{0};
+        int  available{0};      // stanje nakon (uspješne) rezervacije, inače trenutno
+        int  first_seat{0};     // broj prvog dodijeljenog sjedišta (v. Entry::next_seat)
+        uint32_t seat_seq{0};   // seat_seq koji pripada 'available' (journal)
+    };
+
+    struct Stats {
+        uint64_t reservations{0};
+        uint64_t rejections{0};
+        uint64_t flushes{0};
+        uint64_t rows_flushed{0};
+        size_t   vehicles{0};
+    };
+
+    // Učitaj sva vozila iz baze (start servera); vraća broj vozila
+    size_t load(Database& db);
+    // Isto iz već pročitanih zapisa (snimak stanja pri toplom restartu)
+    size_t load(const std::vector<Vehicle>& vehicles);
+    // Trenutno stanje svih vozila (slobodna mjesta iz memorije, i još neupisana)
+    std::vector<Vehicle> exportVehicles() const;
+
+    // Autoritativne vrijednosti iz baze (registracija/admin izmjene)
+    void upsert(const Vehicle& vehicle);
+    // Grupna admin izmjena: sve stavke pod jednom bravom i sa istom verzijom,
+    // pa čitaoci i delte vide ili staro ili potpuno novo stanje
+    void upsertAll(const std::vector<Vehicle>& vehicles);
+    // Admin izmjena postojećeg vozila na mjestu, bez gaženja živog brojača: ruta/tip/
+    // aktivnost iz 'v'; uz set_seats i kapacitet, a v.available_seats važi za stanje
+    // seen_available (pročitano prije upisa u bazu) - rezervacije i storna od tada se
+    // prenose na novo stanje. false ako vozila nema (pozivalac radi upsert)
+    bool amend(const Vehicle& v, bool set_seats = false, int seen_available = 0);
+    // Grupna amend izmjena pod jednom bravom i sa istom verzijom (kao upsertAll):
+    // seen_available[i] kao kod amend (nullopt -> bez mjesta); vozila kojih nema se dodaju
+    void amendAll(const std::vector<Vehicle>& vehicles, const std::vector<std::optional<int>>& seen_available);
+    bool remove(const std::string& uri);
+
+    std::optional<Snapshot> find(const std::string& uri) const;
+    // Slobodna mjesta ili -1 ako vozila nema (Database::SeatCount za upis brojača)
+    int availableOf(const std::string& uri) const;
+    // Prvo aktivno vozilo na ruti/tipu sa slobodnim mjestom (inače prvo pronađeno)
+    std::optional<Snapshot> findByRouteAndType(const std::string& route, VehicleType type) const;
+    // Kao findByRouteAndType, a ako na ruti nema vozila tog tipa, bilo koji drugi tip
+    // (opet prednost ima vozilo sa slobodnim mjestom)
+    std::optional<Snapshot> findOnRoute(const std::string& route, VehicleType preferred) const;
+
+    Reservation reserve(const std::string& uri, int seats);
+    void        release(const std::string& uri, int seats);   // storno neuspjele kupovine
+    // Oporavak iz journal-a: postavi slobodna mjesta (dirty -> upiše ih sljedeći flush)
+    bool        restoreSeats(const std::string& uri, int available);
+    // Pomak slobodnih mjesta za 'delta' (ulazak/izlazak putnika), u granicama [0, kapacitet];
+    // rezervacije između dva uzorka ostaju. Vraća novo stanje ili -1 ako vozila nema
+    int         adjustSeats(const std::string& uri, int delta);
+
+    // Upiši sve izmijenjene brojače u bazu (jedan commit); vrijednosti se čitaju pod
+    // write lock-om baze, pa flush ne prepiše noviji upis kupovine starijim stanjem.
+    // Vraća broj redova
+    size_t flush(Database& db);
+    size_t dirtyCount() const;
+    Stats  getStats() const;
+
+    // Prazne rute -> sve rute. since == 0 ili starija od najstarijeg zapamćenog
+    // brisanja -> puni snapshot; inače samo vozila promijenjena nakon 'since'.
+    RouteStatus statusSince(const std::vector<std::string>& routes, uint64_t since) const;
+    uint64_t    version() const { return version_.load(); }
+
+private:
+    struct Entry {
+        std::string       uri;
+        VehicleType       type{VehicleType::BUS};
+        std::string       route;
+        bool              active{true};
+        std::atomic<int>  capacity{0};
+        // [seat_seq u32][available u32]: par se mijenja jednim CAS-om, pa je svako
+        // čitanje konzistentno (journal bira najveći seat_seq po vozilu)
+        std::atomic<uint64_t> seats{0};
+        // Zadnji dodijeljeni broj sjedišta: samo raste (storno ga ne vraća), pa se broj
+        // ne ponavlja dok server radi; pri učitavanju kreće iza već prodatih mjesta
+        std::atomic<int>  next_seat{0};
+        std::atomic<bool> dirty{false};
+        std::atomic<uint64_t> version{0};
+    };
+
+    // Zapis o vozilu koje je nestalo s rute (remove ili promjena rute)
+    struct Tombstone {
+        std::string uri;
+        std::string route;
+        uint64_t    version;
+    };
+    static constexpr size_t kMaxTombstones = 1024;
+
+    // Grupa po tipu: indeks = VehicleType - 1 (BUS, TRAM, TROLLEYBUS)
+    static constexpr size_t kVehicleTypes = 3;
+    struct RouteVehicles {
+        std::array<std::vector<std::shared_ptr<Entry>>, kVehicleTypes> by_type;
+        bool empty() const;
+    };
+
+    static size_t typeSlot(VehicleType type);
+    static std::optional<Snapshot> pick(const std::vector<std::shared_ptr<Entry>>& group);
+    void indexLocked(const std::shared_ptr<Entry>& e);
+    void unindexLocked(const std::shared_ptr<Entry>& e);
+    static Snapshot snapshotOf(const Entry& e);
+    static int      availableOf(uint64_t w) { return static_cast<int>(static_cast<uint32_t>(w)); }
+    static uint32_t seatSeqOf(uint64_t w)   { return static_cast<uint32_t>(w >> 32); }
+    static uint64_t packSeats(uint32_t seq, int available) {
+        return (static_cast<uint64_t>(seq) << 32) | static_cast<uint32_t>(available);
+    }
+    // Postavi 'available' uz seat_seq + 1; vraća novi par
+    static uint64_t storeSeats(Entry& e, int available);
+    uint64_t nextVersion() { return version_.fetch_add(1) + 1; }
+    void     tombstoneLocked(const Entry& e, uint64_t version);
+    void     upsertLocked(const Vehicle& vehicle, uint64_t version);
+    void     amendLocked(Entry& e, const Vehicle& vehicle, bool set_seats, int seen_available, uint64_t version);
+
+    mutable std::shared_mutex                                            mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Entry>>              by_uri_;
+    std::unordered_map<std::string, RouteVehicles>                       by_route_;
+    std::mutex                                                           flush_mutex_;
+
+    // Verzija inventara; mijenja se pod (bar) shared lock-om, pa statusSince uz kratki
+    // unique lock dobija verziju iza koje nema nijedne "poluupisane" promjene
+    std::atomic<uint64_t> version_{0};
+    std::deque<Tombstone> tombstones_;          // pod unique lock-om
+    uint64_t              delta_floor_{0};      // delta je moguća samo za since >= ovoga
+
+    std::atomic<uint64_t> reservations_{0};
+    std::atomic<uint64_t> rejections_{0};
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> rows_flushed_{0};
+};
+
+} // namespace transport
@@ -5,6 +5,11 @@
 
 #include "../common/Message.h"
 #include "../common/Logger.h"
+#include "../common/Database.h"
+#include "../common/Metrics.h"
+#include "../common/Tracing.h"
+#include "../common/TimerService.h"
+#include "AdmissionControl.h"
 
 #include <string>
 #include <memory>
@@ -14,9 +19,72 @@
 #include <mutex>
 #include <chrono>
 #include <algorithm>
+#include <map>
+#include <set>
 
 namespace transport {
 
+// Configuration structure for servers
+struct ServerConfig {
+    int port = 8080;
+    int max_connections = 100;
+    int connection_timeout = 300; // seconds
+    bool require_authentication = true;
+    bool enable_heartbeat = true;
+    int heartbeat_interval = 30; // seconds
+    std::string cert_file;
+    std::string key_file;
+    std::string log_file;
+    Logger::LogLevel log_level = Logger::LogLevel::INFO;
+    
+    // Database configuration
+    std::string database_path = "transport.db";
+    int database_pool_size = 5;
+    // [database] wal_mode, synchronous, cache_size, busy_timeout, mmap_size, temp_store;
+    // uz WAL checkpoint radi pozadinski task svakih wal_checkpoint_interval sekundi
+    DatabaseOptions database_options{
+        /*wal_mode*/ true, /*synchronous*/ "NORMAL", /*cache_size*/ 0, /*busy_timeout_ms*/ 5000,
+        /*mmap_size*/ 0, /*temp_store*/ "", /*wal_autocheckpoint*/ 0};
+    int wal_checkpoint_interval = 30; // seconds (0 -> SQLite auto-checkpoint)
+    bool database_thread_affinity = true; // [database] thread_affinity (samo uz worker_pool)
+    
+    // Network configuration
+    std::string bind_address = "0.0.0.0";
+    bool enable_ipv6 = false;
+    int socket_buffer_size = 65536;
+    // [server] tcp_nodelay, tcp_keepalive, socket_reuse_addr, socket_reuse_port;
+    // [network] socket_buffer_size (samo ako je naveden), keepalive_idle/interval/count
+    SocketOptions socket_options;
+    
+    // Security configuration
+    bool enable_tls = true;
+    std::vector<std::string> allowed_cipher_suites;
+    int tls_handshake_timeout = 10; // seconds
+
+    // Threading model (vidi TLSServer::ExecutionMode)
+    bool worker_pool = false;       // [server] worker_pool
+    int  worker_threads = 0;        // [server] worker_threads (0 -> hardware_concurrency)
+    int  io_shards = 0;             // [server] io_shards: > 0 -> io_context po jezgru (ima prednost)
+    bool io_cpu_affinity = false;   // [server] io_cpu_affinity: nit shard-a i na jezgru i
+    
+    bool loadFromFile(const std::string& config_file);
+    bool saveToFile(const std::string& config_file) const;
+    void setDefaults();
+    bool validate() const;
+
+    // Sirove vrijednosti iz .conf fajla ("sekcija.kljuc" -> vrijednost), za opcije
+    // koje čitaju pojedinačni serveri/moduli
+    std::string getString(const std::string& section, const std::string& key,
+                          const std::string& def = "") const;
+    int         getInt(const std::string& section, const std::string& key, int def = 0) const;
+    double      getDouble(const std::string& section, const std::string& key, double def = 0.0) const;
+    bool        getBool(const std::string& section, const std::string& key, bool def = false) const;
+    bool        has(const std::string& section, const std::string& key) const;
+
+private:
+    std::map<std::string, std::string> values_;
+};
+
 // Base class for all server types
 class ServerBase {
 public:
@@ -35,12 +103,29 @@ public:
     virtual bool loadConfiguration(const std::string& config_file);
     void setLogLevel(Logger::LogLevel level) { logger_->setLogLevel(level); }
     void setMaxConnections(int max_conn) { max_connections_ = max_conn; }
+    // Rate limit po klijentu i granica zahtjeva u obradi (prije start())
+    void setAdmission(const AdmissionControl::Options& options) { admission_.configure(options); }
     void setConnectionTimeout(int timeout) { connection_timeout_ = timeout; }
+    void setHeartbeat(bool enabled, int interval_seconds) {
+        enable_heartbeat_ = enabled; heartbeat_interval_ = interval_seconds;
+    }
+    void setWorkerPool(bool enabled, int worker_threads = 0) {
+        worker_pool_ = enabled; worker_threads_ = worker_threads;
+    }
+    // io_context po jezgru (TLSServer SHARDED); shards <= 0 -> isključeno
+    void setIoShards(int shards, bool cpu_affinity = false) {
+        io_shards_ = shards; io_cpu_affinity_ = cpu_affinity;
+    }
+    // Konekcije su async sesije na io nitima (WORKER_POOL ili SHARDED)
+    bool usesAsyncSessions() const { return worker_pool_ || io_shards_ > 0; }
+    const ServerConfig& getConfig() const { return server_config_; }
 
     // Statistics
     int getActiveConnections() const { return active_connections_; }
     int getTotalConnections() const { return total_connections_; }
     std::chrono::system_clock::time_point getStartTime() const { return start_time_; }
+    TLSServer::Stats getTlsStats() const { return tls_server_ ? tls_server_->getStats() : TLSServer::Stats{}; }
+    AdmissionControl::Stats getAdmissionStats() const { return admission_.getStats(); }
 
     // Certificate management
     bool setCertificates(const std::string& cert_file, const std::string& key_file);
@@ -52,11 +137,37 @@ protected:
                                      std::unique_ptr<Message> message) = 0;
     virtual void processMessage(std::unique_ptr<Message> message, 
                                 std::unique_ptr<TLSSocket>& client) = 0;
+    // Zero-copy ulaz (view nad baferom konekcije, važi samo tokom poziva);
+    // podrazumijevano materijalizuje Message i zove processMessage
+    virtual void processMessageView(const MessageView& view,
+                                    std::unique_ptr<TLSSocket>& client);
 
     // Common server functionality (na Boost.Asio kroz TLSServer/TLSSocket)
-    void startServer();                 // kreira TLSServer, postavlja callback i starta accept/TLS
+    bool startServer();                 // kreira TLSServer, postavlja callback i starta accept/TLS
     void acceptConnections();           // no-op (accept radi TLSServer interno)
     void handleClient(std::unique_ptr<TLSSocket> client_socket); // delegira na handleClientMessage
+
+    // Poziva se kad konekcija završi (oba moda); izvedene klase čiste svoje liste (npr. subscribere)
+    virtual void onClientDisconnected(TLSSocket* client);
+
+    // Žive konekcije za heartbeat i idle reaper. Socket je prijavljen dok traje njegova
+    // petlja/sesija; vlasnik ga odjavi prije zatvaranja (reaper radi samo TCP shutdown)
+    class TrackedConnection {
+    public:
+        TrackedConnection(ServerBase& server, TLSSocket* socket);
+        ~TrackedConnection();
+        TrackedConnection(const TrackedConnection&) = delete;
+        TrackedConnection& operator=(const TrackedConnection&) = delete;
+    private:
+        ServerBase& server_;
+        TLSSocket*  socket_;
+    };
+    void trackConnection(TLSSocket* socket);
+    void untrackConnection(TLSSocket* socket);
+    // Na timer niti, svake sekunde: HEARTBEAT konekcijama bez prijema heartbeat_interval
+    // (neuspjelo slanje -> mrtav peer), zatvaranje onih bez prijema connection_timeout
+    void maintainConnections();
+    void closeAllAsyncSessions();       // nakon tls_server_->stop(): zatvara preostale async sesije
     
     // Logging
     void logInfo(const std::string& message);
@@ -65,18 +176,54 @@ protected:
     void logDebug(const std::string& message);
 
     // Connection management (minimalni stubovi — konkretne liste vode izvedene klase po potrebi)
-    bool validateClient(std::unique_ptr<TLSSocket>& client);
+    bool validateClient(std::unique_ptr<TLSSocket>& client);   // true -> mjesto rezervisano
+    void releaseConnectionSlot();
     void disconnectClient(std::unique_ptr<TLSSocket>& client);
     void broadcastMessage(std::unique_ptr<Message> message);
 
+    // Admission control. admitConnection je TLSServer filter: pun server -> 503 + retry_after_ms.
+    // admitRequest pita AdmissionControl (ključ: urn, uri, session_id ili adresa peer-a); odbijen
+    // zahtjev odmah dobija 429 (rate limit) ili 503 (previše zahtjeva u obradi) sa retry_after_ms,
+    // a prazan Ticket znači da ga ne treba obrađivati. Ticket se drži do kraja obrade.
+    bool                     admitConnection(std::unique_ptr<TLSSocket>& client);
+    AdmissionControl::Ticket admitRequest(const MessageView& view, std::unique_ptr<TLSSocket>& client);
+    AdmissionControl::Ticket admitRequest(const Message& message, std::unique_ptr<TLSSocket>& client);
+    void sendRetryLater(std::unique_ptr<TLSSocket>& client, const std::string& error, int code,
+                        uint32_t retry_after_ms);
+
+    // Korelacija odgovora: dok je scope živ, sendResponse na ovoj niti upisuje
+    // sequence_id zahtjeva u odgovor (klijent može imati više zahtjeva u letu).
+    // Postavlja se na mjestu dispatch-a; broadcast-i zadržavaju sequence_id 0.
+    class RequestScope {
+    public:
+        explicit RequestScope(uint32_t sequence_id);
+        ~RequestScope();
+        RequestScope(const RequestScope&) = delete;
+        RequestScope& operator=(const RequestScope&) = delete;
+    private:
+        uint32_t previous_;
+    };
+
+    // Tracing: korijenski span zahtjeva počinje kad je stigao header, a čitanje i
+    // dekodiranje okvira (TLSSocket::lastReceiveTiming) se bilježe kao njegova djeca
+    void traceReceive(tracing::Span& root, const std::unique_ptr<TLSSocket>& client);
+
     // Message utilities
     void sendResponse(std::unique_ptr<TLSSocket>& client, std::unique_ptr<Message> response);
+    // Česti odgovori bez Message objekta: okvir se slaže iz šablona u thread-local bafer
+    void sendResponse(std::unique_ptr<TLSSocket>& client, const ResponseTemplate& response,
+                      std::initializer_list<ResponseTemplate::Value> values);
     void sendErrorResponse(std::unique_ptr<TLSSocket>& client, const std::string& error, int code = -1);
     void sendSuccessResponse(std::unique_ptr<TLSSocket>& client, const std::string& message = "");
 
+    // CONNECT_REQUEST: dogovori verziju enkodiranja (min(ponuđena, podržana)), pošalji
+    // CONNECT_RESPONSE u staroj verziji, pa prebaci socket na dogovorenu
+    uint16_t acceptConnect(std::string_view requested_version, std::unique_ptr<TLSSocket>& client);
+
     // Server state
     std::atomic<bool> running_{false};
     std::atomic<int>  active_connections_{0};
+    std::atomic<int>  admitted_connections_{0};   // rezervacije limita: od filtera do kraja sesije
     std::atomic<int>  total_connections_{0};
     
     std::string server_name_;
@@ -88,10 +235,18 @@ protected:
     std::string key_file_;
     std::unique_ptr<TLSServer> tls_server_;
 
+    // Periodični poslovi: heartbeat/reaper (ServerBase) i pozadinski poslovi izvedenih klasa.
+    // Pokreće ga startServer(), stop() ga gasi odmah (bez čekanja intervala)
+    TimerService timers_;
+
     // Threading
     std::unique_ptr<std::thread> accept_thread_; 
     std::vector<std::unique_ptr<std::thread>> client_threads_;
     std::mutex threads_mutex_;
+    bool worker_pool_{false};   // true -> TLSServer WORKER_POOL + async sesije
+    int  worker_threads_{0};
+    int  io_shards_{0};         // > 0 -> TLSServer SHARDED + async sesije
+    bool io_cpu_affinity_{false};
 
     // Configuration
     int  max_connections_{100};
@@ -103,6 +258,20 @@ protected:
     // Logging
     std::shared_ptr<Logger> logger_;
 
+    // tp_error_responses_total{server=...}: svaki sendErrorResponse (4xx/5xx odgovori)
+    metrics::Counter* error_responses_{nullptr};
+
+    AdmissionControl  admission_;
+    // tp_admission_rejected_total{server=...,reason="connections|rate_limited|overloaded"}
+    metrics::Counter* rejected_connections_{nullptr};
+    metrics::Counter* rejected_rate_limited_{nullptr};
+    metrics::Counter* rejected_overloaded_{nullptr};
+    metrics::Counter* heartbeats_sent_{nullptr};       // tp_heartbeats_sent_total{server=...}
+    metrics::Counter* connections_reaped_{nullptr};    // tp_connections_reaped_total{server=...}
+
+    // Sadržaj zadnjeg učitanog .conf fajla (izvedene klase čitaju svoje sekcije)
+    ServerConfig server_config_;
+
     // Client management (meta-info; izvedene klase obično drže vlastite socket liste)
     struct ClientInfo {
         std::string client_id;
@@ -117,43 +286,31 @@ protected:
     std::mutex clients_mutex_;
 
 private:
+    // Async sesija (WORKER_POOL): read -> processMessage -> read ... na worker nitima
+    struct AsyncSession {
+        std::unique_ptr<TLSSocket> socket;
+        bool closed{false};
+    };
+    void startAsyncSession(std::unique_ptr<TLSSocket> client);
+    void readNextMessage(const std::shared_ptr<AsyncSession>& session);
+    void closeAsyncSession(const std::shared_ptr<AsyncSession>& session);
+
+    std::set<std::shared_ptr<AsyncSession>> async_sessions_;
+    std::mutex                              async_sessions_mutex_;
+
+    struct LiveConnection {
+        std::chrono::steady_clock::time_point last_probe{};
+        bool                                  reaped{false};
+    };
+    std::map<TLSSocket*, LiveConnection> live_connections_;
+    std::mutex                           live_connections_mutex_;
+
+    AdmissionControl::Ticket admitKey(MessageType type, std::string_view key, std::unique_ptr<TLSSocket>& client);
+
     void cleanupFinishedThreads();
     void setupDefaultConfiguration();
     std::string generateClientId();
 };
 
-// Configuration structure for servers
-struct ServerConfig {
-    int port = 8080;
-    int max_connections = 100;
-    int connection_timeout = 300; // seconds
-    bool require_authentication = true;
-    bool enable_heartbeat = true;
-    int heartbeat_interval = 30; // seconds
-    std::string cert_file;
-    std::string key_file;
-    std::string log_file;
-    Logger::LogLevel log_level = Logger::LogLevel::INFO;
-    
-    // Database configuration
-    std::string database_path = "transport.db";
-    int database_pool_size = 5;
-    
-    // Network configuration
-    std::string bind_address = "0.0.0.0";
-    bool enable_ipv6 = false;
-    int socket_buffer_size = 65536;
-    
-    // Security configuration
-    bool enable_tls = true;
-    std::vector<std::string> allowed_cipher_suites;
-    int tls_handshake_timeout = 10; // seconds
-    
-    bool loadFromFile(const std::string& config_file);
-    bool saveToFile(const std::string& config_file) const;
-    void setDefaults();
-    bool validate() const;
-};
-
 } // namespace transport
 
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace transport {
+
+// Tabela sesija CentralServera.
+// - Sharding po hash-u tokena: svaki shard ima svoj mutex, pa PURCHASE_TICKET,
+//   ADD_MEMBER_TO_GROUP i provjera lidera ne čekaju jedni na druge.
+// - Tokeni su 128-bitni slučajni brojevi (32 hex znaka): nepogodivi, fiksne
+//   dužine, a hash je prvih 16 hex znakova (nema prolaza kroz cijeli string).
+// - Istek neaktivnih sesija radi hijerarhijski timer wheel po shardu; touch()
+//   ne pomjera timer (samo last_activity), nego se pri okidanju provjeri stvarno
+//   vrijeme i sesija po potrebi ponovo zakaže. expire() obrađuje samo dospjele
+//   slotove, bez prolaza kroz cijelu tabelu.
+class SessionStore {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kTokenLength = 32;
+
+    // Sesija za snimak stanja (topli restart)
+    struct Exported {
+        std::string               session_id;
+        std::string               user_urn;
+        std::chrono::milliseconds idle{0};     // neaktivnost u trenutku izvoza
+    };
+
+    explicit SessionStore(std::chrono::seconds idle_timeout = std::chrono::seconds(3600),
+                          size_t shard_count = 16,
+                          std::chrono::milliseconds tick = std::chrono::milliseconds(1000));
+
+    static std::string generateToken();
+
+    // Nova sesija; vraća token
+    std::string create(const std::string& user_urn);
+    // Validira i osvježava aktivnost; vraća URN korisnika
+    std::optional<std::string> touch(const std::string& session_id);
+    bool   contains(const std::string& session_id) const;
+    bool   remove(const std::string& session_id);
+
+    // Pomjeri wheel do `now` i izbaci istekle sesije; vraća broj izbačenih
+    size_t expire(Clock::time_point now = Clock::now());
+
+    void   setIdleTimeout(std::chrono::seconds timeout);
+    size_t size() const;
+    // URN-ovi sa bar jednom sesijom (bez duplikata, sortirano)
+    std::vector<std::string> users() const;
+
+    std::vector<Exported> exportSessions() const;
+    // Vraća izvezenu sesiju s istim tokenom; false za neispravan token, postojeći token
+    // ili idle >= timeout (sesija bi već bila istekla)
+    bool restore(const Exported& session);
+
+private:
+    struct TokenHash {
+        size_t operator()(const std::string& token) const noexcept;
+    };
+
+    struct Session {
+        std::string       user_urn;
+        Clock::time_point last_activity;
+    };
+
+    // Dva nivoa: L0 = kLevel0 tickova, L1 = kLevel1 slotova po kLevel0 tickova
+    struct TimerWheel {
+        static constexpr uint64_t kLevel0 = 256;
+        static constexpr uint64_t kLevel1 = 64;
+        struct Timer {
+            std::string session_id;
+            uint64_t    deadline;   // u tickovima
+        };
+        std::array<std::vector<Timer>, kLevel0> level0;
+        std::array<std::vector<Timer>, kLevel1> level1;
+        uint64_t current{0};
+
+        void schedule(Timer t);
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Session, TokenHash> sessions;
+        TimerWheel wheel;
+    };
+
+    Shard&       shardFor(const std::string& session_id);
+    const Shard& shardFor(const std::string& session_id) const;
+    uint64_t     tickOf(Clock::time_point t) const;
+    size_t       expireShard(Shard& shard, uint64_t to_tick, Clock::time_point now);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::chrono::milliseconds           tick_;
+    std::atomic<int64_t>                idle_timeout_ms_;
+    Clock::time_point                   epoch_;
+};
+
+} // namespace transport
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../common/Database.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace transport {
+
+// Binarni snimak stanja CentralServera za topli restart: sesije, inventar sjedišta i
+// "vrući" ključevi keševa (URN-ovi korisnika, imena grupi). Server ga upisuje periodično i
+// pri urednom gašenju; pri pokretanju ga učita prije prvog zahtjeva.
+// - clean: upisan u stop() nakon zadnjeg flush-a inventara i pražnjenja dnevnika, pa je
+//   baza u istom stanju. Samo tada se vraćaju inventar i sesije; server odmah briše
+//   oznaku (markConsumed), da pad poslije ne učita zastarjelo stanje.
+// - Periodični snimak (nakon pada) služi samo za zagrijavanje keševa: zapisi se ponovo
+//   čitaju iz baze, a inventar dolazi iz baze + dnevnika kao i bez snimka.
+//
+// Fajl (mmap pri čitanju, upis kroz .tmp + rename):
+//   [magic "TPS1"][u32 verzija][u32 flags][u32 broj sekcija][u64 created_ms][u64 body_size]
+//   [u32 crc32 tijela][u32 crc32 zaglavlja] (64 B), pa tabela sekcija [u32 tip][u32 stavki]
+//   [u64 offset][u64 size] i sekcije. Stringovi su [u32 dužina][bajtovi], brojevi little-endian.
+class StateSnapshot {
+public:
+    struct Session {
+        std::string session_id;
+        std::string user_urn;
+        uint64_t    idle_ms{0};     // neaktivnost u trenutku upisa
+    };
+
+    struct Data {
+        uint64_t                 created_ms{0};   // wall clock upisa
+        bool                     clean{false};
+        std::string              source;          // putanja baze (snimak druge baze se ignoriše)
+        int64_t                  vehicles_max_rowid{0};   // MAX(rowid) tabele vehicles pri upisu (uz broj vozila)
+        std::vector<Vehicle>     vehicles;
+        std::vector<Session>     sessions;
+        std::vector<std::string> users;
+        std::vector<std::string> groups;
+    };
+
+    // MISSING: fajla nema (prvo pokretanje); INVALID: fajl postoji ali nije upotrebljiv snimak
+    enum class ReadResult { OK, MISSING, INVALID };
+
+    static bool       write(const std::string& path, const Data& data, std::string* error = nullptr);
+    static ReadResult read(const std::string& path, Data& data, std::string* error = nullptr);
+    // Briše clean oznaku na mjestu (zaglavlje + msync); false ako fajl nije snimak
+    static bool markConsumed(const std::string& path);
+
+private:
+    static constexpr size_t   kHeaderSize = 64;
+    static constexpr uint32_t kVersion    = 1;
+    static constexpr uint32_t kFlagClean  = 1;
+
+    enum class Section : uint32_t { META = 1, VEHICLES = 2, SESSIONS = 3, USERS = 4, GROUPS = 5 };
+};
+
+} // namespace transport
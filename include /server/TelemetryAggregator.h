@@ -0,0 +1,163 @@
+#pragma once
+
+#include "../common/Database.h"
+#include "../common/Metrics.h"
+#include "../common/Telemetry.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace transport {
+
+// Prijem telemetrije vozila (VEHICLE_TELEMETRY) u CentralServer-u.
+// - Handleri samo stave uzorke u ograničen lock-free red (kao Logger); pun red odbacuje
+//   uzorke (telemetrija je "zadnje stanje pobjeđuje", sljedeći uzorak ga nadoknadi).
+// - Jedna nit agregatora prazni red u batch-evima i jedina piše stanje: zadnji uzorak po
+//   vozilu i klizni agregati po ruti, oba kao strukture nizova (SoA) indeksirane slotom,
+//   pa prolaz kroz rute/vozila čita samo kolone koje mu trebaju.
+// - Ništa se ne piše u bazu po uzorku: takeChanged() vraća vozila promijenjena od
+//   prethodnog poziva, a CentralServer ih upisuje jednim commit-om po intervalu.
+class TelemetryAggregator {
+public:
+    struct Options {
+        size_t               queue_size{65536};   // zaokruži se na stepen dvojke; važi pri start()
+        std::chrono::seconds window{300};         // klizni prosjek putnika po ruti (vremenska konstanta)
+        std::chrono::milliseconds max_skew{60000};  // vrijeme uzorka najviše ovoliko ispred sata servera
+    };
+
+    // Vozilo u inventaru; nullopt -> nepoznato vozilo (uzorak se odbacuje)
+    struct VehicleInfo {
+        std::string route;
+        int         capacity{0};
+    };
+    using Resolver = std::function<std::optional<VehicleInfo>(const std::string& uri)>;
+
+    struct RouteAggregate {
+        std::string route;
+        uint32_t    vehicles{0};        // vozila sa bar jednim uzorkom
+        int         occupancy{0};       // zbir zadnjih uzoraka vozila na ruti
+        int         capacity{0};        // zbir kapaciteta tih vozila
+        double      avg_occupancy{0};   // klizni prosjek 'occupancy' (po vremenu uzoraka)
+        uint64_t    samples{0};
+        uint64_t    last_sample_ms{0};
+    };
+
+    struct Stats {
+        uint64_t accepted{0};
+        uint64_t dropped{0};            // pun red
+        uint64_t processed{0};
+        uint64_t unknown_vehicle{0};
+        uint64_t stale{0};              // stariji od zadnjeg uzorka vozila
+        size_t   vehicles{0};
+        size_t   routes{0};
+    };
+
+    TelemetryAggregator();
+    ~TelemetryAggregator();
+
+    TelemetryAggregator(const TelemetryAggregator&) = delete;
+    TelemetryAggregator& operator=(const TelemetryAggregator&) = delete;
+
+    void configure(const Options& options);       // prije start()
+    // resolver se zove samo sa niti agregatora (nepoznato vozilo i refreshVehicles())
+    void start(Resolver resolver);
+    void stop();                                  // obradi sve predate uzorke pa zaustavi nit
+
+    // Iz bilo koje niti; vraća broj primljenih (ostali su odbačeni)
+    size_t submit(std::vector<TelemetrySample>& samples);
+    // Čeka da sve dosad predate uzorke obradi nit agregatora
+    void   drain();
+    // Ruta/kapacitet vozila se ponovo čitaju u sljedećem prolazu (admin izmjene vozila)
+    void   refreshVehicles();
+
+    std::vector<VehicleTelemetry>  takeChanged();
+    void                           markChanged(const std::vector<VehicleTelemetry>& rows);   // upis nije uspio
+    std::vector<RouteAggregate>    routes() const;
+    std::optional<RouteAggregate>  route(const std::string& name) const;
+    Stats                          getStats() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq{0};
+        TelemetrySample     sample;
+    };
+
+    bool tryPush(TelemetrySample& sample);
+    bool tryPop(TelemetrySample& out);
+    void run();
+    void wake();
+    bool pendingWork() const;
+    void applyLocked(const TelemetrySample& s, uint64_t max_ms);
+    void refreshLocked();
+    uint32_t routeSlotLocked(const std::string& route);
+    void     detachLocked(uint32_t v);
+    void     attachLocked(uint32_t v, const VehicleInfo& info);
+
+    // Red (Vyukov MPMC, jedan potrošač)
+    std::unique_ptr<Cell[]> cells_;
+    size_t                  mask_{0};
+    std::atomic<size_t>     head_{0};
+    size_t                  tail_{0};              // samo nit agregatora
+    std::atomic<uint64_t>   enqueued_{0};
+
+    std::thread             thread_;
+    std::atomic<bool>       running_{false};
+    std::atomic<bool>       sleeping_{false};
+    std::atomic<bool>       refresh_{false};
+    std::mutex              wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::mutex              drain_mutex_;
+    std::condition_variable drain_cv_;
+    uint64_t                done_{0};             // pod drain_mutex_
+    bool                    finished_{true};      // pod drain_mutex_: nit ne radi (nije pokrenuta ili je izašla)
+
+    Options  options_;
+    Resolver resolver_;
+
+    // Stanje: piše nit agregatora pod mutex_, čitaoci kratko zaključaju
+    mutable std::mutex                        mutex_;
+    std::unordered_map<std::string, uint32_t> vehicle_index_;
+    std::vector<std::string> v_uri_;
+    std::vector<uint32_t>    v_route_;
+    std::vector<int>         v_capacity_;
+    std::vector<int>         v_occupancy_;
+    std::vector<int32_t>     v_lat_;
+    std::vector<int32_t>     v_lon_;
+    std::vector<uint64_t>    v_sample_ms_;
+    std::vector<uint64_t>    v_samples_;
+    std::vector<uint8_t>     v_changed_;
+
+    std::unordered_map<std::string, uint32_t> route_index_;
+    std::vector<std::string> r_name_;
+    std::vector<uint32_t>    r_vehicles_;
+    std::vector<int>         r_occupancy_;
+    std::vector<int>         r_capacity_;
+    std::vector<double>      r_avg_;
+    std::vector<uint64_t>    r_samples_;
+    std::vector<uint64_t>    r_last_ms_;
+
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t              processed_{0};          // pod mutex_
+    uint64_t              unknown_{0};
+    uint64_t              stale_{0};
+
+    // tp_telemetry_samples_total{result="accepted|dropped|unknown|stale"}
+    metrics::Counter* accepted_counter_;
+    metrics::Counter* dropped_counter_;
+    metrics::Counter* unknown_counter_;
+    metrics::Counter* stale_counter_;
+};
+
+} // namespace transport
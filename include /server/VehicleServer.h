@@ -1,27 +1,146 @@
 #pragma once
 
 #include "ServerBase.h"
+#include "BroadcastHub.h"
 #include "../common/TLSSocket.h"
+#include "../common/Telemetry.h"
+#include "../common/VehicleStatus.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace transport {
 
+// Regionalni edge čvor ispred CentralServer-a:
+//  - drži kopiju stanja vozila/ruta (VehicleStatusView) koju puni jedna pretplata
+//    GET_VEHICLE_STATUS(subscribe) na centralni server, pa GET_VEHICLE_STATUS i
+//    provjere rezervacija/kupovina (ruta postoji, ima mjesta) rješava lokalno;
+//  - operacije koje mijenjaju stanje prosljeđuje preko JEDNE trajne TLS veze prema
+//    centralnom serveru: svaki proslijeđeni zahtjev dobija svoj sequence_id na vezi,
+//    pa istovremeni zahtjevi uređaja dijele vezu bez čekanja jedan na drugi;
+//  - MULTICAST_UPDATE i delte statusa sa veze se šire lokalnim pretplatnicima;
+//  - VEHICLE_TELEMETRY se potvrđuje lokalno i spaja na zadnji uzorak po vozilu; svakih
+//    telemetry_flush_ms ide na centralni server u okvirima od telemetry_batch uzoraka.
+// Konfiguracija: [edge] central_host, central_port, urn (servisni korisnik za
+// pretplatu), routes ("*" ili CSV), forward_timeout_ms, reconnect_interval_ms,
+// telemetry_flush_ms, telemetry_batch.
 class VehicleServer : public ServerBase {
 public:
     VehicleServer();
+    ~VehicleServer() override;
 
-    // Pokreće TLS/Asio accept petlju 
+    // Pokreće TLS/Asio accept petlju i vezu prema centralnom serveru
     bool start(int port, const std::string& config_file = "") override;
+    void stop() override;
+
+    // Prije start(); imaju prednost nad [edge] sekcijom konfiguracije
+    void setCentralServer(const std::string& host, int port) { central_host_ = host; central_port_ = port; }
+    void setEdgeIdentity(const std::string& urn) { edge_urn_ = urn; }
+    void setRoutes(const std::string& routes_csv) { routes_csv_ = routes_csv; }
+
+    struct EdgeStats {
+        uint64_t local_reads{0};        // GET_VEHICLE_STATUS iz kopije
+        uint64_t local_rejects{0};      // rezervacije/kupovine odbijene bez centralnog servera
+        uint64_t forwarded{0};          // proslijeđeni zahtjevi (uspješno odgovoreni)
+        uint64_t forward_failures{0};   // veza pala ili istekao rok
+        uint64_t link_connects{0};
+        uint64_t telemetry_received{0};    // uzorci primljeni od vozila
+        uint64_t telemetry_forwarded{0};   // uzorci koje je centralni server potvrdio
+        uint64_t telemetry_dropped{0};     // neuspjelo slanje ili pun bafer
+        uint64_t replica_version{0};
+        size_t   replica_vehicles{0};
+        bool     link_up{false};
+        bool     synced{false};         // kopija ima snapshot sa centralnog servera
+    };
+    EdgeStats getEdgeStats() const;
 
 protected:
     // Obrada jedne TLS konekcije (poziva se iz connection callback-a)
     void handleClientMessage(std::unique_ptr<TLSSocket> client,
                              std::unique_ptr<Message> message) override;
 
-    // Aplikativna obrada poruke (za sada samo stub/log)
+    // Lokalno čitanje / lokalna provjera / prosljeđivanje
     void processMessage(std::unique_ptr<Message> message,
                         std::unique_ptr<TLSSocket>& client) override;
+
+    void onClientDisconnected(TLSSocket* client) override;
+
+private:
+    using UpstreamCallback = std::function<void(std::unique_ptr<Message>)>;
+
+    void configureEdge();
+    void handleVehicleStatus(const Message& request, std::unique_ptr<TLSSocket>& client);
+    // 0 -> nije odlučeno lokalno (proslijedi); inače status lokalnog odbijanja
+    int  validateLocally(const Message& request, std::string& error) const;
+    void forward(std::unique_ptr<Message> request, std::unique_ptr<TLSSocket>& client);
+    void handleTelemetry(const Message& request, std::unique_ptr<TLSSocket>& client);
+    void flushTelemetry();      // timer "telemetry_flush"
+
+    // Veza prema centralnom serveru
+    void linkLoop();
+    bool openLink();
+    void closeLink();
+    void onUpstreamMessage(std::unique_ptr<Message> message);
+    bool sendUpstream(Message& request, UpstreamCallback callback);
+    void failUpstream();
+
+    // [edge]
+    std::string central_host_;
+    int         central_port_{0};
+    std::string edge_urn_;
+    std::string routes_csv_;
+    std::vector<std::string> routes_;
+    std::chrono::milliseconds forward_timeout_{5000};
+    std::chrono::milliseconds reconnect_interval_{1000};
+    std::chrono::milliseconds telemetry_flush_{200};
+    size_t                    telemetry_batch_{1024};
+
+    // Kopija stanja (pisac: link nit; čitaoci: niti klijenata)
+    mutable std::shared_mutex replica_mutex_;
+    VehicleStatusView         replica_;
+
+    // Trajna veza: jedna RX nit, slanje serijalizovano
+    std::unique_ptr<TLSSocket> upstream_;
+    std::mutex                 upstream_write_mutex_;
+    std::mutex                 link_mutex_;
+    std::thread                link_thread_;
+    std::atomic<bool>          link_running_{false};
+    std::atomic<bool>          link_up_{false};
+    std::string                upstream_session_;
+
+    // Zahtjevi u letu na vezi: sequence_id veze -> nastavak
+    std::mutex                                      pending_mutex_;
+    std::unordered_map<uint32_t, UpstreamCallback>  pending_;
+    std::atomic<uint32_t>                           next_upstream_seq_{0};
+
+    // Tokeni iz AUTH odgovora proslijeđenih kroz ovaj čvor (lokalna provjera pretplate)
+    std::mutex                      sessions_mutex_;
+    std::unordered_set<std::string> edge_sessions_;
+
+    // Zadnji uzorak po vozilu od prošlog slanja (dok veza ne radi, ostaje samo najnoviji)
+    std::mutex                                       telemetry_mutex_;
+    std::unordered_map<std::string, TelemetrySample> telemetry_pending_;
+
+    // Lokalni pretplatnici (MULTICAST_UPDATE i status:<ruta> teme)
+    BroadcastHub broadcast_;
+
+    std::atomic<uint64_t> local_reads_{0};
+    std::atomic<uint64_t> local_rejects_{0};
+    std::atomic<uint64_t> forwarded_{0};
+    std::atomic<uint64_t> forward_failures_{0};
+    std::atomic<uint64_t> link_connects_{0};
+    std::atomic<uint64_t> telemetry_received_{0};
+    std::atomic<uint64_t> telemetry_forwarded_{0};
+    std::atomic<uint64_t> telemetry_dropped_{0};
 };
 
 } // namespace transport
-
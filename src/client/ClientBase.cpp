@@ -3,6 +3,7 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <utility>
 
 namespace transport {
 
@@ -22,4 +23,68 @@ void ClientBase::logError(const std::string& message) {
     }
 }
 
+// ======================= Zahtjevi u letu =======================
+
+size_t ClientBase::pendingRequests() const {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return pending_.size();
+}
+
+std::future<std::unique_ptr<Message>> ClientBase::trackRequest(Message& request) {
+    auto promise = std::make_shared<std::promise<std::unique_ptr<Message>>>();
+    auto future  = promise->get_future();
+    trackRequest(request, [promise](std::unique_ptr<Message> response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+uint32_t ClientBase::trackRequest(Message& request, ResponseCallback callback) {
+    // 0 je rezervisan za nezatražene poruke (broadcast); preskoči ga i pri prelivanju
+    uint32_t seq = ++next_sequence_id_;
+    if (seq == 0) seq = ++next_sequence_id_;
+    request.setSequenceId(seq);
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_[seq] = std::move(callback);
+    return seq;
+}
+
+bool ClientBase::completeRequest(std::unique_ptr<Message>& response) {
+    if (!response || response->getSequenceId() == 0) return false;
+    ResponseCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        auto it = pending_.find(response->getSequenceId());
+        if (it == pending_.end()) return false;
+        callback = std::move(it->second);
+        pending_.erase(it);
+    }
+    // Callback van brave: smije poslati novi zahtjev
+    if (callback) callback(std::move(response));
+    return true;
+}
+
+void ClientBase::failRequest(uint32_t sequence_id) {
+    ResponseCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        auto it = pending_.find(sequence_id);
+        if (it == pending_.end()) return;
+        callback = std::move(it->second);
+        pending_.erase(it);
+    }
+    if (callback) callback(nullptr);
+}
+
+void ClientBase::failPendingRequests() {
+    std::unordered_map<uint32_t, ResponseCallback> pending;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending.swap(pending_);
+    }
+    for (auto& entry : pending) {
+        if (entry.second) entry.second(nullptr);
+    }
+}
+
 } // namespace transport
@@ -0,0 +1,297 @@
+#include "client/OfflineQueue.h"
+#include "common/Crc32.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace transport {
+
+namespace {
+
+const char kMagic[4] = {'T', 'P', 'Q', '1'};
+
+void put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+void put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+uint32_t get32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+uint64_t get64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+size_t align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+} // namespace
+
+OfflineQueue::~OfflineQueue() {
+    close();
+}
+
+bool OfflineQueue::open(const std::string& path, size_t capacity_bytes) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    closeLocked();
+    path_ = path;
+    last_error_.clear();
+    appended_ = popped_ = rejected_full_ = 0;
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        last_error_ = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        last_error_ = std::string("fstat: ") + std::strerror(errno);
+        closeLocked();
+        return false;
+    }
+
+    const bool fresh  = static_cast<size_t>(st.st_size) < kHeaderSize;
+    const size_t size = fresh ? kHeaderSize + align8(std::max<size_t>(capacity_bytes, 4096))
+                              : static_cast<size_t>(st.st_size);
+    if (fresh && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        last_error_ = std::string("ftruncate: ") + std::strerror(errno);
+        closeLocked();
+        return false;
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        last_error_ = std::string("mmap: ") + std::strerror(errno);
+        closeLocked();
+        return false;
+    }
+    map_      = static_cast<uint8_t*>(p);
+    map_size_ = size;
+
+    if (fresh) {
+        capacity_ = size - kHeaderSize;
+        std::memset(map_, 0, kHeaderSize);
+        std::memcpy(map_, kMagic, sizeof(kMagic));
+        put32(map_ + 4, kVersion);
+        put64(map_ + 8, capacity_);
+        head_ = tail_ = 0;
+        head_id_ = next_id_ = 1;
+        slot_seq_ = 0;
+        writeSlotLocked();
+        ::fsync(fd_);
+    } else {
+        capacity_ = static_cast<size_t>(get64(map_ + 8));
+        if (std::memcmp(map_, kMagic, sizeof(kMagic)) != 0 || get32(map_ + 4) != kVersion ||
+            capacity_ < kRecordHeaderSize || capacity_ % 8 != 0 || kHeaderSize + capacity_ > map_size_) {
+            last_error_ = "not a queue file (bad magic/version/size): " + path;
+            closeLocked();
+            return false;
+        }
+        if (!readSlotsLocked()) {
+            last_error_ = "queue state corrupt (no valid slot): " + path;
+            closeLocked();
+            return false;
+        }
+    }
+    recoverLocked();
+    return true;
+}
+
+void OfflineQueue::close() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    closeLocked();
+}
+
+void OfflineQueue::closeLocked() {
+    if (map_) ::munmap(map_, map_size_);
+    map_      = nullptr;
+    map_size_ = 0;
+    if (fd_ >= 0) ::close(fd_);
+    fd_       = -1;
+    records_  = 0;
+}
+
+bool OfflineQueue::isOpen() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return map_ != nullptr;
+}
+
+bool OfflineQueue::readSlotsLocked() {
+    bool found = false;
+    for (size_t offset : kSlotOffset) {
+        const uint8_t* s = map_ + offset;
+        if (Crc32::compute(s, 24) != get32(s + 24)) continue;      // pokidan upis ovog slota
+        const uint64_t seq = get64(s);
+        if (found && seq <= slot_seq_) continue;
+        slot_seq_ = seq;
+        head_     = get64(s + 8);
+        head_id_  = get64(s + 16);
+        found     = true;
+    }
+    return found;
+}
+
+void OfflineQueue::writeSlotLocked() {
+    // Stariji slot se prepisuje; pad usred upisa ostavlja drugi (prethodno stanje) ispravnim
+    ++slot_seq_;
+    uint8_t* s = map_ + kSlotOffset[slot_seq_ % 2];
+    put64(s, slot_seq_);
+    put64(s + 8, head_);
+    put64(s + 16, head_id_);
+    put32(s + 24, Crc32::compute(s, 24));
+    put32(s + 28, 0);
+    syncLocked(0, kHeaderSize);
+}
+
+void OfflineQueue::syncLocked(size_t offset, size_t length) {
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t start = offset - offset % page;
+    ::msync(map_ + start, offset + length - start, MS_SYNC);
+}
+
+bool OfflineQueue::recordAt(uint64_t& pos, uint64_t limit, uint64_t expected_id, size_t& length) const {
+    uint64_t p  = pos;
+    size_t phys = static_cast<size_t>(p % capacity_);
+    size_t room = capacity_ - phys;
+    if (room < kRecordHeaderSize || get32(data() + phys) == kWrapMarker) {
+        p   += room;
+        phys = 0;
+        room = capacity_;
+    }
+    if (p + kRecordHeaderSize > limit) return false;
+
+    const uint8_t* r   = data() + phys;
+    const uint32_t len = get32(r);
+    if (len == kWrapMarker) return false;
+    const size_t rec = align8(kRecordHeaderSize + len);
+    if (rec > room || p + rec > limit) return false;
+    if (get64(r + 8) != expected_id || Crc32::compute(r + 8, 8 + len) != get32(r + 4)) return false;
+
+    pos    = p;
+    length = len;
+    return true;
+}
+
+void OfflineQueue::recoverLocked() {
+    // Kraj reda nije u zaglavlju: to je zadnji ispravan zapis u nizu od head-a
+    uint64_t pos = head_;
+    uint64_t id  = head_id_;
+    size_t   len = 0;
+    records_ = 0;
+    while (recordAt(pos, head_ + capacity_, id, len)) {
+        pos += align8(kRecordHeaderSize + len);
+        ++id;
+        ++records_;
+    }
+    tail_    = records_ ? pos : head_;
+    next_id_ = id;
+}
+
+uint64_t OfflineQueue::append(const std::vector<uint8_t>& payload) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!map_) {
+        last_error_ = "queue not open";
+        return 0;
+    }
+    const size_t rec = align8(kRecordHeaderSize + payload.size());
+    if (payload.size() >= kWrapMarker || rec > capacity_) {
+        last_error_ = "record larger than queue capacity";
+        return 0;
+    }
+
+    uint64_t pos      = tail_;
+    size_t   phys     = static_cast<size_t>(pos % capacity_);
+    const size_t room = capacity_ - phys;
+    const size_t skip = room < rec ? room : 0;          // zapis se ne dijeli preko kraja ringa
+    if (tail_ + skip + rec - head_ > capacity_) {
+        ++rejected_full_;
+        last_error_ = "queue full";
+        return 0;
+    }
+    if (skip) {
+        if (room >= 4) put32(data() + phys, kWrapMarker);
+        syncLocked(kHeaderSize + phys, room);
+        pos += skip;
+        phys = 0;
+    }
+
+    uint8_t* r        = data() + phys;
+    const uint64_t id = next_id_;
+    const uint32_t len = static_cast<uint32_t>(payload.size());
+    put32(r, len);
+    put64(r + 8, id);
+    if (len) std::memcpy(r + kRecordHeaderSize, payload.data(), len);
+    std::memset(r + kRecordHeaderSize + len, 0, rec - kRecordHeaderSize - len);
+    put32(r + 4, Crc32::compute(r + 8, 8 + len));
+    syncLocked(kHeaderSize + phys, rec);
+
+    tail_ = pos + rec;
+    ++next_id_;
+    ++records_;
+    ++appended_;
+    return id;
+}
+
+std::vector<OfflineQueue::Entry> OfflineQueue::peek(size_t max_records) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::vector<Entry> out;
+    if (!map_) return out;
+    uint64_t pos = head_;
+    size_t   len = 0;
+    for (size_t n = 0; n < max_records && recordAt(pos, tail_, head_id_ + n, len); ++n) {
+        const size_t phys = static_cast<size_t>(pos % capacity_);
+        const uint8_t* p  = data() + phys + kRecordHeaderSize;
+        out.push_back({head_id_ + n, std::vector<uint8_t>(p, p + len)});
+        pos += align8(kRecordHeaderSize + len);
+    }
+    return out;
+}
+
+size_t OfflineQueue::pop(size_t count) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!map_) return 0;
+    uint64_t pos = head_;
+    size_t   len = 0;
+    size_t   n   = 0;
+    while (n < count && recordAt(pos, tail_, head_id_ + n, len)) {
+        pos += align8(kRecordHeaderSize + len);
+        ++n;
+    }
+    if (n == 0) return 0;
+
+    head_     = n == records_ ? tail_ : pos;
+    head_id_ += n;
+    records_ -= n;
+    popped_  += n;
+    writeSlotLocked();
+    return n;
+}
+
+size_t OfflineQueue::size() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return records_;
+}
+
+OfflineQueue::Stats OfflineQueue::getStats() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    Stats s;
+    s.records       = records_;
+    s.bytes_used    = static_cast<size_t>(tail_ - head_);
+    s.capacity      = capacity_;
+    s.appended      = appended_;
+    s.popped        = popped_;
+    s.rejected_full = rejected_full_;
+    return s;
+}
+
+std::string OfflineQueue::lastError() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return last_error_;
+}
+
+} // namespace transport
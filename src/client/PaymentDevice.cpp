@@ -1,14 +1,23 @@
 #include "client/PaymentDevice.h"
 #include "common/Message.h"
 #include "common/Logger.h"
+#include "common/Tracing.h"
+#include "common/Crc32.h"
 
+#include <algorithm>
 #include <utility>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 
 namespace transport {
 
 PaymentDevice::PaymentDevice() : ClientBase("PaymentDevice") {}
 
+PaymentDevice::~PaymentDevice() {
+    if (rx_thread_ || socket_) disconnect();
+}
+
 bool PaymentDevice::connect(const std::string& server, int port) {
     logInfo("Connecting to server: " + server + ":" + std::to_string(port));
 
@@ -21,19 +30,217 @@ bool PaymentDevice::connect(const std::string& server, int port) {
         return false;
     }
     logInfo("Connected");
+
+    negotiateProtocol_();
+
+    // Od ovdje sve poruke čita RX nit (odgovori idu u tabelu zahtjeva, ostalo u handleMessage).
+    // RX nit čita dok pozivaoci šalju: obje strane idu kroz io nit socketa, ne paralelno u SSL
+    if (!socket_->enableFullDuplex()) {
+        logError("Full-duplex mode unavailable: " + socket_->getLastError());
+        socket_.reset();
+        return false;
+    }
+    running_ = true;
+    rx_thread_ = std::make_unique<std::thread>(&PaymentDevice::receiveLoop_, this);
+
+    // Kupovine zabilježene dok veze nije bilo: u pozadini, connect() ne čeka odgovore servera
+    if (offlineQueueSize() > 0) drain_thread_ = std::make_unique<std::thread>(&PaymentDevice::drainLoop_, this);
+    return true;
+}
+
+void PaymentDevice::drainLoop_() {
+    auto backoff = std::chrono::milliseconds(500);
+    while (running_ && offlineQueueSize() > 0) {
+        const size_t before  = offlineQueueSize();
+        const size_t drained = drainOfflineQueue();
+        logInfo("Offline queue drained: " + std::to_string(drained) + "/" + std::to_string(before));
+        if (offlineQueueSize() == 0) break;
+        // Ostatak je za ponavljanje (5xx, 425 = ista kupovina još u obradi, prekid veze)
+        std::unique_lock<std::mutex> lk(drain_wait_mutex_);
+        drain_cv_.wait_for(lk, backoff, [this] { return !running_; });
+        backoff = std::min(backoff * 2, std::chrono::milliseconds(30000));
+    }
+}
+
+// ======================= Offline red (store-and-forward) =======================
+
+bool PaymentDevice::enableOfflineQueue(const std::string& path, size_t capacity_bytes) {
+    auto queue = std::make_unique<OfflineQueue>();
+    if (!queue->open(path, capacity_bytes)) {
+        logError("Offline queue unavailable: " + queue->lastError());
+        return false;
+    }
+    logInfo("Offline queue " + path + ": " + std::to_string(queue->size()) + " pending");
+    queue_ = std::move(queue);
+    return true;
+}
+
+std::string PaymentDevice::nextIdempotencyKey_() {
+    // Jedinstven i nakon restarta uređaja: CRC URI-ja + vrijeme (ns) + brojač. Najviše
+    // 8+1+19+1+10 znakova, ispod granice od 64 koju server provjerava za bilo koji URI
+    const std::string uri = device_uri_.empty() ? std::string("payment_device") : device_uri_;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char device[9];
+    std::snprintf(device, sizeof(device), "%08x",
+                  Crc32::compute(reinterpret_cast<const uint8_t*>(uri.data()), uri.size()));
+    return std::string(device) + "-" + std::to_string(ns) + "-" + std::to_string(++key_counter_);
+}
+
+bool PaymentDevice::enqueueOffline_(const std::vector<uint8_t>& frame) {
+    if (!queue_ || queue_->append(frame) == 0) {
+        logError("Purchase not queued: " + (queue_ ? queue_->lastError() : std::string("offline queue disabled")));
+        return false;
+    }
     return true;
 }
 
+std::future<std::unique_ptr<Message>> PaymentDevice::submitPurchase(std::unique_ptr<Message> purchase) {
+    auto promise = std::make_shared<std::promise<std::unique_ptr<Message>>>();
+    auto future  = promise->get_future();
+    if (!purchase) {
+        promise->set_value(nullptr);
+        return future;
+    }
+    if (!purchase->hasKey("idempotency_key")) {
+        purchase->addString("idempotency_key", nextIdempotencyKey_());
+        purchase->calculateChecksum();
+    }
+    const std::string key = purchase->getString("idempotency_key");
+    auto frame = std::make_shared<std::vector<uint8_t>>(purchase->serialize());
+
+    auto queued = [this, key, frame]() -> std::unique_ptr<Message> {
+        if (!enqueueOffline_(*frame)) return nullptr;
+        return MessageFactory::createSuccessResponse("Purchase queued offline", {
+            {"queued", "1"}, {"idempotency_key", key}});
+    };
+
+    // Redoslijed: dok stare kupovine čekaju, nove idu iza njih
+    if (!socket_ || !running_ || offlineQueueSize() > 0) {
+        promise->set_value(queued());
+        return future;
+    }
+    sendRequest(std::move(purchase), [promise, queued](std::unique_ptr<Message> response) {
+        // Bez odgovora server je kupovinu možda i obradio; ponovno slanje nosi isti ključ
+        promise->set_value(response ? std::move(response) : queued());
+    });
+    return future;
+}
+
+size_t PaymentDevice::drainOfflineQueue(size_t max_batch) {
+    if (!queue_) return 0;
+    std::lock_guard<std::mutex> lk(drain_mutex_);
+    max_batch = std::max<size_t>(1, max_batch);
+    size_t drained = 0;
+
+    while (socket_ && running_ && !queue_->empty()) {
+        const auto entries = queue_->peek(max_batch);
+        std::vector<std::unique_ptr<Message>> items;
+        for (const auto& entry : entries) {
+            auto item = std::make_unique<Message>();
+            if (!item->deserialize(entry.payload)) break;
+            items.push_back(std::move(item));
+        }
+        if (items.empty()) {
+            // Zapis prošao CRC, ali nije poruka (npr. drugačija verzija): ne može se poslati
+            logError("Offline queue: dropping unreadable record " + std::to_string(entries.front().id));
+            drained += queue_->pop(1);
+            continue;
+        }
+
+        auto reply = sendRequest(MessageFactory::createBatch(items)).get();
+        if (!reply) break;                                 // veza pala: ostatak čeka sljedeći connect
+        if (reply->getType() != MessageType::RESPONSE_SUCCESS) {
+            const int code = reply->getInt("error_code");
+            if (code == 413 && max_batch > 1) {            // server prima manje stavki po poruci
+                max_batch = std::max<size_t>(1, items.size() / 2);
+                continue;
+            }
+            logError("Offline queue: batch rejected (" + std::to_string(code) + "): " + reply->getString("error"));
+            break;
+        }
+
+        // status: jedan kod po stavci; 2xx/4xx su konačni (208 = već zabilježeno), 5xx i
+        // 425 (prvi pokušaj iste kupovine još u obradi) se ponavljaju
+        const std::string status = reply->getString("status");
+        size_t done = 0;
+        for (size_t pos = 0; done < items.size() && pos <= status.size(); ++done) {
+            const int code = std::atoi(status.c_str() + pos);
+            if (code <= 0 || code >= 500 || code == 425) break;
+            const size_t comma = status.find(',', pos);
+            pos = comma == std::string::npos ? status.size() + 1 : comma + 1;
+        }
+        drained += queue_->pop(done);
+        if (done < items.size()) break;
+    }
+    return drained;
+}
+
+std::future<std::unique_ptr<Message>> PaymentDevice::sendRequest(std::unique_ptr<Message> request) {
+    auto promise = std::make_shared<std::promise<std::unique_ptr<Message>>>();
+    auto future  = promise->get_future();
+    sendRequest(std::move(request), [promise](std::unique_ptr<Message> response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+bool PaymentDevice::sendRequest(std::unique_ptr<Message> request, ResponseCallback callback) {
+    if (!request || !socket_ || !running_) {
+        if (callback) callback(nullptr);
+        return false;
+    }
+    const uint32_t seq = trackRequest(*request, std::move(callback));
+    tracing::inject(*request);   // span pozivaoca (ako je uzorkovan) nastavlja se na serveru
+    if (!socket_->sendMessage(*request)) {
+        logError("Request send failed: " + socket_->getLastError());
+        failRequest(seq);
+        return false;
+    }
+    return true;
+}
+
+void PaymentDevice::negotiateProtocol_() {
+    if (preferred_version_ <= PROTOCOL_V1) return;
+
+    // CONNECT razmjena ide u V1; tek nakon odgovora prelazimo na dogovorenu verziju
+    auto request = MessageFactory::createConnectRequest(
+        device_uri_.empty() ? "payment_device" : device_uri_, preferred_version_);
+    if (!socket_->sendMessage(*request)) {
+        logError("CONNECT_REQUEST failed: " + socket_->getLastError());
+        return;
+    }
+
+    auto response = socket_->receiveMessage();
+    if (!response || response->getType() != MessageType::CONNECT_RESPONSE || !response->getBool("success")) {
+        logError("CONNECT_RESPONSE missing or rejected; staying on protocol v1");
+        return;
+    }
+
+    const uint16_t version = parseProtocolVersion(response->getString("protocol_version"));
+    socket_->setProtocolVersion(version);
+    logInfo("Protocol version negotiated: v" + std::to_string(version));
+}
+
 
 void PaymentDevice::disconnect() {
     logInfo("Disconnecting from server");
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lk(drain_wait_mutex_);
+        running_ = false;
+    }
+    drain_cv_.notify_all();
 
-    
+    // Zatvaranje (na io niti socketa) budi RX nit koja čeka u receiveMessage
+    if (socket_) socket_->close();
     if (rx_thread_ && rx_thread_->joinable()) {
         rx_thread_->join();
     }
     rx_thread_.reset();
+    failPendingRequests();
+    // Drain čeka odgovor (upravo oboren) ili razmak ponavljanja (probuđen)
+    if (drain_thread_ && drain_thread_->joinable()) drain_thread_->join();
+    drain_thread_.reset();
 
     socket_.reset();
     logInfo("Disconnected");
@@ -51,8 +258,11 @@ void PaymentDevice::receiveLoop_() {
             if (running_) logError("Receive failed or connection closed by peer");
             break;
         }
+        if (completeRequest(msg)) continue;
         handleMessage(std::move(msg));
     }
+    // Odgovori na zahtjeve u letu više neće stići
+    failPendingRequests();
 }
 
 void PaymentDevice::handleMessage(std::unique_ptr<Message> /*message*/) {
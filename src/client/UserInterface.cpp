@@ -3,7 +3,11 @@
 #include "common/TLSSocket.h"
 #include "common/Message.h"
 #include "common/Logger.h"
+#include "common/McastDatagram.h"
+#include "common/Tracing.h"
 
+#include <array>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -52,6 +56,14 @@ bool UserInterface::connect(const std::string& server, int port, const std::stri
         return false;
     }
 
+    // Dogovor verzije (data plane parametre server šalje samo V2 klijentu); bez odgovora ostaje V1
+    if (socket_->sendMessage(*MessageFactory::createConnectRequest("user_interface", PROTOCOL_V2))) {
+        auto response = socket_->receiveMessage();
+        if (response && response->getType() == MessageType::CONNECT_RESPONSE && response->getBool("success")) {
+            socket_->setProtocolVersion(parseProtocolVersion(response->getString("protocol_version")));
+        }
+    }
+
     logger_->info("Connected to server successfully");
     return true;
 }
@@ -79,6 +91,13 @@ bool UserInterface::authenticate(const std::string& urn) {
         session_token_ = response->getString("token"); // server šalje "token"
         current_urn_   = urn;
         authenticated_ = true;
+        mcast_key_.clear();
+        if (response->hasKey("mcast_key") &&
+            mcast::fromHex(response->getString("mcast_key"), mcast_key_)) {
+            mcast_group_ = response->getString("mcast_group");
+            mcast_port_  = response->getInt("mcast_port");
+            mcast_seq_   = std::strtoull(response->getString("mcast_seq").c_str(), nullptr, 10);
+        }
         logger_->info("Authentication successful");
     } else {
         logger_->warning("Authentication failed");
@@ -108,6 +127,10 @@ void UserInterface::startInteractiveSession() {
             handleAuthenticate(input);
         } else if (input == "listen") {
             handleListen(input);
+        } else if (input == "listen mcast") {
+            handleListenMcast(input);
+        } else if (input.rfind("status", 0) == 0) {
+            handleStatus(input);
         } else if (input.rfind("reserve", 0) == 0) {
             handleReserve(input);
         } else if (input.rfind("purchase", 0) == 0) {
@@ -146,6 +169,8 @@ void UserInterface::showHelp() {
     std::cout << "    - URI: either 'uri=bus125' or just 'bus125'\n";
     std::cout << "    - n: number of seats (default 1)\n";
     std::cout << "  listen                                - Listen for async multicast updates\n";
+    std::cout << "  listen mcast                          - Listen for UDP multicast updates (resync over TLS)\n";
+    std::cout << "  status [routes|*] [watch]             - Seat status per route (comma-separated), 'watch' streams deltas\n";
     std::cout << "  create_group <name> <leader_urn>      - Create user group\n";
     std::cout << "  add_member <name> <member_urn>        - Add member to group\n";
     std::cout << "  rm_member <name> <member_urn>         - Remove member from group (leader only)\n";
@@ -261,11 +286,17 @@ void UserInterface::handleReserve(const std::string& input) {
     if (!current_urn_.empty()) message->addString("urn", current_urn_);
     message->calculateChecksum();
 
+    // Klijent započinje trace (uzorkovanje po --trace-sample); server ga nastavlja
+    tracing::Span span("client.request", tracing::TraceContext{}, static_cast<uint16_t>(message->getType()));
+    tracing::inject(*message);
+
     if (socket_ && socket_->sendMessage(*message)) {
         auto response = socket_->receiveMessage();
         if (response && response->getType() == MessageType::RESPONSE_SUCCESS) {
+            span.setStatus(200);
             std::cout << "Seat reserved successfully!\n";
         } else {
+            if (response) span.setStatus(response->getInt("error_code"));
             std::cout << "Reservation failed: "
                       << (response ? response->getString("error") : "No response") << "\n";
         }
@@ -324,11 +355,16 @@ void UserInterface::handlePurchase(const std::string& input) {
     if (!session_token_.empty()) message->addString("session_id", session_token_);
     message->calculateChecksum();
 
+    tracing::Span span("client.request", tracing::TraceContext{}, static_cast<uint16_t>(message->getType()));
+    tracing::inject(*message);
+
     if (socket_ && socket_->sendMessage(*message)) {
         auto response = socket_->receiveMessage();
         if (response && response->getType() == MessageType::RESPONSE_SUCCESS) {
+            span.setStatus(200);
             std::cout << "Ticket purchased successfully!\n";
         } else {
+            if (response) span.setStatus(response->getInt("error_code"));
             std::cout << "Purchase failed: "
                       << (response ? response->getString("error") : "No response") << "\n";
         }
@@ -440,12 +476,153 @@ void UserInterface::handleListen(const std::string& /*input*/) {
         }
         if (msg->getType() == MessageType::MULTICAST_UPDATE) {
             std::cout << "[Update] " << msg->getString("update_type") << "\n";
+            applyPriceUpdate(*msg);
         } else {
             std::cout << "[Async] type=" << static_cast<int>(msg->getType()) << "\n";
         }
     }
 }
 
+void UserInterface::handleListenMcast(const std::string& /*input*/) {
+    using boost::asio::ip::udp;
+    if (!authenticated_) {
+        std::cout << "Please authenticate first\n";
+        return;
+    }
+    if (mcast_key_.empty()) {
+        std::cout << "Server has no multicast data plane; use 'listen'\n";
+        return;
+    }
+
+    try {
+        boost::asio::io_context io;
+        udp::socket sock(io);
+        sock.open(udp::v4());
+        sock.set_option(boost::asio::socket_base::reuse_address(true));
+        sock.bind(udp::endpoint(udp::v4(), static_cast<unsigned short>(mcast_port_)));
+        sock.set_option(boost::asio::ip::multicast::join_group(boost::asio::ip::make_address(mcast_group_)));
+
+        mcast::SequenceTracker tracker;
+        tracker.reset(mcast_seq_);
+        std::cout << "Listening on " << mcast_group_ << ":" << mcast_port_
+                  << " from seq " << mcast_seq_ << "... (Ctrl+C to stop)\n";
+
+        std::array<uint8_t, mcast::kMaxDatagram> buf{};
+        while (true) {
+            udp::endpoint from;
+            const size_t n = sock.receive_from(boost::asio::buffer(buf), from);
+
+            uint64_t seq = 0;
+            const uint8_t* frame = nullptr;
+            size_t frame_len = 0;
+            if (!mcast::decodeDatagram(buf.data(), n, mcast_key_, seq, frame, frame_len)) {
+                continue;   // DISCOVER/ANNOUNCE ili paket bez ispravnog potpisa
+            }
+            const auto r = tracker.onSequence(seq);
+            if (!r.accept) continue;
+            if (r.gap) {
+                std::cout << "[Gap] missing " << r.gap_from << ".." << r.gap_to << ", resyncing\n";
+                requestResync(r.gap_from, r.gap_to);
+            }
+            mcast_seq_ = seq;
+
+            Message msg;
+            if (msg.deserialize(frame, frame_len)) {
+                std::cout << "[Update #" << seq << "] " << msg.getString("update_type") << "\n";
+                applyPriceUpdate(msg);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Multicast listener stopped: " << e.what() << "\n";
+    }
+}
+
+void UserInterface::handleStatus(const std::string& input) {
+    auto parts = splitString(input, ' ');
+    const std::string routes = parts.size() > 1 ? parts[1] : "*";
+    const bool watch = parts.size() > 2 && parts[2] == "watch";
+    if (watch && !authenticated_) {
+        std::cout << "Please authenticate first\n";
+        return;
+    }
+    if (routes != status_routes_) {
+        status_view_   = VehicleStatusView{};
+        status_routes_ = routes;
+    }
+
+    auto req = MessageFactory::createGetVehicleStatus(routes, status_view_.version(), watch, session_token_);
+    if (!socket_ || !socket_->sendMessage(*req)) {
+        std::cout << "Failed to send status request\n";
+        return;
+    }
+    // Kod 'watch' delta sa broadcast niti može stići prije odgovora; view to pokriva
+    auto resp = socket_->receiveMessage();
+    if (!resp || resp->getType() != MessageType::VEHICLE_STATUS) {
+        std::cout << "Status failed: " << (resp ? resp->getString("error") : "No response") << "\n";
+        return;
+    }
+    printStatus(*resp);
+    if (!watch) return;
+
+    std::cout << "Watching routes " << routes << "... (Ctrl+C to stop)\n";
+    while (auto msg = socket_->receiveMessage()) {
+        if (msg->getType() == MessageType::VEHICLE_STATUS) printStatus(*msg);
+    }
+    std::cout << "Status stream closed\n";
+}
+
+void UserInterface::printStatus(const Message& status) {
+    const uint64_t before = status_view_.version();
+    if (!status_view_.apply(status)) {
+        std::cout << "Malformed VEHICLE_STATUS\n";
+        return;
+    }
+    std::cout << (status.getBool("full") ? "[Snapshot v" : "[Delta v") << status_view_.version()
+              << " from v" << before << "] " << status_view_.vehicles().size() << " vehicles\n";
+    for (const auto& kv : status_view_.vehicles()) {
+        const auto& v = kv.second;
+        if (v.version <= before && !status.getBool("full")) continue;   // delta: samo promijenjena
+        std::cout << "  " << v.uri << " route=" << v.route << " seats=" << v.available
+                  << "/" << v.capacity << (v.active ? "" : " (inactive)") << "\n";
+    }
+}
+
+void UserInterface::applyPriceUpdate(const Message& update) {
+    if (!prices_.applyUpdate(update)) return;   // nije price_updated ili je zastario
+    if (update.getString("update_type") == "price_list_updated") {
+        std::cout << "  price list -> version " << prices_.get()->version() << "\n";
+        return;
+    }
+    const auto vt = static_cast<VehicleType>(update.getInt("vehicle_type"));
+    const auto tt = static_cast<TicketType>(update.getInt("ticket_type"));
+    std::cout << "  price vehicle_type=" << static_cast<int>(vt) << " ticket_type=" << static_cast<int>(tt)
+              << " -> " << prices_.get()->ticketPrice(vt, tt) << "\n";
+}
+
+size_t UserInterface::requestResync(uint64_t from_seq, uint64_t to_seq) {
+    auto req = MessageFactory::createMcastResync(session_token_, from_seq, to_seq);
+    if (!socket_ || !socket_->sendMessage(*req)) return 0;
+
+    // Server šalje propuštene MULTICAST_UPDATE okvire pa završni odgovor
+    size_t replayed = 0;
+    while (auto msg = socket_->receiveMessage()) {
+        if (msg->getType() == MessageType::MULTICAST_UPDATE) {
+            std::cout << "[Resync #" << msg->getString("mcast_seq") << "] "
+                      << msg->getString("update_type") << "\n";
+            applyPriceUpdate(*msg);
+            ++replayed;
+            continue;
+        }
+        if (msg->getType() == MessageType::RESPONSE_ERROR) {
+            std::cout << "Resync failed: " << msg->getString("error") << "\n";
+        } else if (msg->getString("missing") != "0") {
+            std::cout << "Resync: " << msg->getString("missing") << " updates no longer available\n";
+        }
+        break;
+    }
+    return replayed;
+}
+
 std::vector<std::string> UserInterface::splitString(const std::string& str, char delimiter) {
     std::vector<std::string> tokens;
     std::string token;
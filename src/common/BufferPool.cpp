@@ -0,0 +1,25 @@
+#include "common/BufferPool.h"
+
+namespace transport {
+
+BufferPool& BufferPool::local() {
+    thread_local BufferPool pool;
+    return pool;
+}
+
+std::vector<uint8_t> BufferPool::acquire() {
+    if (free_.empty()) return {};
+    std::vector<uint8_t> buffer = std::move(free_.back());
+    free_.pop_back();
+    ++reused_;
+    return buffer;
+}
+
+void BufferPool::release(std::vector<uint8_t>&& buffer) {
+    // Jedan veliki okvir (npr. cjenovnik) ne smije trajno držati memoriju
+    if (buffer.capacity() == 0 || buffer.capacity() > max_capacity_ || free_.size() >= max_buffers_) return;
+    buffer.clear();
+    free_.push_back(std::move(buffer));
+}
+
+} // namespace transport
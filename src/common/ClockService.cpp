@@ -0,0 +1,85 @@
+#include "common/ClockService.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace transport {
+
+namespace {
+
+// Objavljeni timestamp: 19 znakova u tri 64-bitne riječi. seq je neparan dok pisac
+// upisuje; čitalac koji vidi promjenu seq-a (ili neparan) formatira sam.
+struct Published {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<int64_t>  sec{-1};
+    std::atomic<uint64_t> words[3]{};
+    std::atomic<bool>     writing{false};
+};
+
+Published           g_published;
+std::atomic<uint64_t> g_formats{0};
+
+void formatLocal(std::time_t sec, char* out) {
+    std::tm tm{};
+    localtime_r(&sec, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    std::memcpy(out, buf, ClockService::kTimestampLength);
+    g_formats.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool readPublished(std::time_t sec, char* out) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const uint64_t s1 = g_published.seq.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+        const int64_t cached = g_published.sec.load(std::memory_order_relaxed);
+        uint64_t words[3];
+        for (int i = 0; i < 3; ++i) words[i] = g_published.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (g_published.seq.load(std::memory_order_relaxed) != s1) continue;
+        if (cached != static_cast<int64_t>(sec)) return false;
+        std::memcpy(out, words, ClockService::kTimestampLength);
+        return true;
+    }
+    return false;
+}
+
+void publish(std::time_t sec, const char* text) {
+    // Jedan pisac; ostali samo koriste svoj rezultat. Starija sekunda ne gazi noviju.
+    if (g_published.writing.exchange(true, std::memory_order_acquire)) return;
+    if (g_published.sec.load(std::memory_order_relaxed) < static_cast<int64_t>(sec)) {
+        uint64_t words[3] = {0, 0, 0};
+        std::memcpy(words, text, ClockService::kTimestampLength);
+        const uint64_t s = g_published.seq.load(std::memory_order_relaxed);
+        g_published.seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        g_published.sec.store(static_cast<int64_t>(sec), std::memory_order_relaxed);
+        for (int i = 0; i < 3; ++i) g_published.words[i].store(words[i], std::memory_order_relaxed);
+        g_published.seq.store(s + 2, std::memory_order_release);
+    }
+    g_published.writing.store(false, std::memory_order_release);
+}
+
+} // namespace
+
+void ClockService::formatTimestamp(std::time_t sec, char* out) {
+    if (readPublished(sec, out)) return;
+    formatLocal(sec, out);
+    publish(sec, out);
+}
+
+void ClockService::formatTimestamp(char* out) {
+    formatTimestamp(seconds(), out);
+}
+
+std::string ClockService::timestamp() {
+    std::string ts(kTimestampLength, '\0');
+    formatTimestamp(&ts[0]);
+    return ts;
+}
+
+uint64_t ClockService::formatCount() {
+    return g_formats.load(std::memory_order_relaxed);
+}
+
+} // namespace transport
@@ -0,0 +1,178 @@
+#include "common/Crc32.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_acle.h>
+#define TRANSPORT_CRC32_ARM 1
+#endif
+
+namespace transport {
+
+namespace {
+
+constexpr uint32_t kPoly = 0xEDB88320u;
+
+using Table = std::array<std::array<uint32_t, 256>, 8>;
+
+// T[0] je klasična tabela po bajtu; T[k][b] = CRC bajta b praćenog sa k nula
+Table makeTables() {
+    Table t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (kPoly & (0u - (c & 1u)));
+        t[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t k = 1; k < 8; ++k) {
+            t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFFu];
+        }
+    }
+    return t;
+}
+
+const Table& tables() {
+    static const Table t = makeTables();
+    return t;
+}
+
+// Sirovi (ne-invertovani) koraci; update() radi ~ na ulazu i izlazu
+uint32_t rawSlicing8(uint32_t crc, const uint8_t* p, size_t n) {
+    const Table& t = tables();
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (n >= 8) {
+        uint32_t one, two;
+        std::memcpy(&one, p, 4);
+        std::memcpy(&two, p + 4, 4);
+        one ^= crc;
+        crc = t[7][one & 0xFFu]         ^ t[6][(one >> 8) & 0xFFu] ^
+              t[5][(one >> 16) & 0xFFu] ^ t[4][one >> 24]          ^
+              t[3][two & 0xFFu]         ^ t[2][(two >> 8) & 0xFFu] ^
+              t[1][(two >> 16) & 0xFFu] ^ t[0][two >> 24];
+        p += 8;
+        n -= 8;
+    }
+#endif
+    while (n--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFFu];
+    return crc;
+}
+
+#ifdef TRANSPORT_CRC32_ARM
+__attribute__((target("+crc")))
+uint32_t rawArm(uint32_t crc, const uint8_t* p, size_t n) {
+    while (n >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc = __crc32d(crc, v);
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = __crc32b(crc, *p++);
+    return crc;
+}
+
+bool armHasCrc() {
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+#endif
+
+// Množenje polinoma mod P u reflektovanom obliku (kao zlib crc32_combine); a != 0
+uint32_t multModP(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31, p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ kPoly : b >> 1;
+    }
+    return p;
+}
+
+// x^(2^k) mod P
+const std::array<uint32_t, 32>& x2nTable() {
+    static const std::array<uint32_t, 32> table = [] {
+        std::array<uint32_t, 32> t{};
+        uint32_t p = 1u << 30;          // x^1
+        t[0] = p;
+        for (size_t n = 1; n < t.size(); ++n) t[n] = p = multModP(p, p);
+        return t;
+    }();
+    return table;
+}
+
+using RawFn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+RawFn selectRaw() {
+#ifdef TRANSPORT_CRC32_ARM
+    if (armHasCrc()) return rawArm;
+#endif
+    return rawSlicing8;
+}
+
+RawFn bestRaw() {
+    static const RawFn fn = selectRaw();
+    return fn;
+}
+
+} // namespace
+
+uint32_t Crc32::update(uint32_t crc, const uint8_t* data, size_t size) {
+    return ~bestRaw()(~crc, data, size);
+}
+
+uint32_t Crc32::shiftFactor(size_t size) {
+    // x^(8*size) mod P: pomak CRC-a prvog dijela preko 'size' bajtova drugog
+    const auto& table = x2nTable();
+    uint32_t p = 1u << 31;              // x^0
+    for (unsigned k = 3; size; size >>= 1, ++k) {
+        if (size & 1) p = multModP(table[k & 31], p);
+    }
+    return p;
+}
+
+uint32_t Crc32::combineFactor(uint32_t crc_a, uint32_t crc_b, uint32_t factor) {
+    return multModP(factor, crc_a) ^ crc_b;
+}
+
+uint32_t Crc32::bitwise(const uint8_t* data, size_t size) {
+    // Originalna implementacija iz Message-a (8 iteracija po bajtu)
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t n = 0; n < size; ++n) {
+        crc ^= data[n];
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (kPoly & (-(static_cast<int32_t>(crc) & 1)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t Crc32::slicing8(const uint8_t* data, size_t size) {
+    return ~rawSlicing8(0xFFFFFFFFu, data, size);
+}
+
+uint32_t Crc32::hardware(const uint8_t* data, size_t size) {
+#ifdef TRANSPORT_CRC32_ARM
+    if (armHasCrc()) return ~rawArm(0xFFFFFFFFu, data, size);
+#endif
+    return slicing8(data, size);
+}
+
+bool Crc32::hasHardware() {
+#ifdef TRANSPORT_CRC32_ARM
+    return armHasCrc();
+#else
+    return false;
+#endif
+}
+
+const char* Crc32::implementation() {
+    return hasHardware() ? "armv8-crc32" : "slicing-by-8";
+}
+
+} // namespace transport
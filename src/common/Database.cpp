@@ -1,4 +1,8 @@
 #include "common/Database.h"
+#include "common/ClockService.h"
+#include "common/Metrics.h"
+#include "common/Tracing.h"
+#include "common/UserCache.h"
 #include <iostream>
 #include <sstream>
 #include <thread>
@@ -6,21 +10,13 @@
 #include <condition_variable>
 #include <algorithm>
 #include <ctime>
+#include <cctype>
 
 namespace transport {
 
 // ---------------------- mali helper za timestamp ----------------------
 static inline std::string nowISO() {
-    std::time_t t = std::time(nullptr);
-    std::tm tm{};
-#if defined(_WIN32)
-    localtime_s(&tm, &t);
-#else
-    tm = *std::localtime(&t);
-#endif
-    char buf[32];
-    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
-    return std::string(buf);
+    return ClockService::timestamp();
 }
 
 // ======================== Database (lifecycle) ========================
@@ -31,7 +27,7 @@ Database::~Database() {
     close();
 }
 
-bool Database::initialize(const std::string& db_path) {
+bool Database::initialize(const std::string& db_path, const DatabaseOptions& options) {
     std::lock_guard<std::mutex> lock(db_mutex_);
 
     int result = sqlite3_open(db_path.c_str(), &db_);
@@ -43,16 +39,101 @@ bool Database::initialize(const std::string& db_path) {
     // Enforcaj strane ključeve
     executeSQL("PRAGMA foreign_keys = ON;");
     // Omogući bolji paralelizam i čekanje na zaključavanja
-    //executeSQL("PRAGMA journal_mode = WAL;");
-    //executeSQL("PRAGMA synchronous = NORMAL;");
-    //executeSQL("PRAGMA busy_timeout = 5000;"); // čekaj do 5s ako je DB busy
+    if (!applyOptions(options)) return false;
 
-    return createTables();
+    return !options.create_schema || createTables();
+}
+
+static std::string upperWord(const std::string& v) {
+    std::string out;
+    for (char c : v) {
+        if (!std::isspace(static_cast<unsigned char>(c)))
+            out += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return out;
+}
+
+bool Database::applyOptions(const DatabaseOptions& options) {
+    // busy_timeout prvi: prebacivanje u WAL traži ekskluzivni lock ako je
+    // neka druga konekcija već otvorena
+    sqlite3_busy_timeout(db_, options.busy_timeout_ms > 0 ? options.busy_timeout_ms : 0);
+
+    if (options.wal_mode) {
+        // :memory: baza ne podržava WAL -> ostaje u svom modu (vidi getPragma("journal_mode"))
+        queryPragma("journal_mode = WAL");
+        executeSQL("PRAGMA wal_autocheckpoint = " + std::to_string(std::max(0, options.wal_autocheckpoint)) + ";");
+    }
+
+    if (!options.synchronous.empty()) {
+        const std::string v = upperWord(options.synchronous);
+        if (v != "OFF" && v != "NORMAL" && v != "FULL" && v != "EXTRA") {
+            setLastError("Invalid synchronous value: " + options.synchronous, SQLITE_MISUSE);
+            return false;
+        }
+        if (!executeSQL("PRAGMA synchronous = " + v + ";")) return false;
+    }
+
+    if (options.cache_size != 0) {
+        if (!executeSQL("PRAGMA cache_size = " + std::to_string(options.cache_size) + ";")) return false;
+    }
+
+    if (options.mmap_size > 0) {
+        if (!executeSQL("PRAGMA mmap_size = " + std::to_string(options.mmap_size) + ";")) return false;
+    }
+
+    if (!options.temp_store.empty()) {
+        const std::string v = upperWord(options.temp_store);
+        if (v != "DEFAULT" && v != "FILE" && v != "MEMORY") {
+            setLastError("Invalid temp_store value: " + options.temp_store, SQLITE_MISUSE);
+            return false;
+        }
+        if (!executeSQL("PRAGMA temp_store = " + v + ";")) return false;
+    }
+    return true;
+}
+
+std::string Database::getPragma(const std::string& name) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    return db_ ? queryPragma(name) : std::string();
+}
+
+std::string Database::queryPragma(const std::string& pragma) {
+    // Vraća prvu kolonu prvog reda "PRAGMA <pragma>" (npr. "journal_mode" -> "wal")
+    sqlite3_stmt* stmt = nullptr;
+    std::string out;
+    if (sqlite3_prepare_v2(db_, ("PRAGMA " + pragma + ";").c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return out;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* txt = sqlite3_column_text(stmt, 0);
+        if (txt) out = reinterpret_cast<const char*>(txt);
+    }
+    sqlite3_finalize(stmt);
+    return out;
+}
+
+bool Database::checkpoint(bool truncate, int* wal_frames, int* checkpointed) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    if (!db_) return false;
+
+    int log = 0, ckpt = 0;
+    int rc = sqlite3_wal_checkpoint_v2(db_, nullptr,
+                                       truncate ? SQLITE_CHECKPOINT_TRUNCATE : SQLITE_CHECKPOINT_PASSIVE,
+                                       &log, &ckpt);
+    if (wal_frames)   *wal_frames   = log;
+    if (checkpointed) *checkpointed = ckpt;
+    if (rc != SQLITE_OK) {
+        // SQLITE_BUSY kod TRUNCATE znači da je neki čitalac još aktivan; probaće se opet
+        setLastError("WAL checkpoint failed: " + std::string(sqlite3_errmsg(db_)), rc);
+        return false;
+    }
+    return true;
 }
 
 void Database::close() {
     std::lock_guard<std::mutex> lock(db_mutex_);
     if (db_) {
+        finalizeCachedStatements();
         sqlite3_close(db_);
         db_ = nullptr;
     }
@@ -69,7 +150,9 @@ bool Database::createTables() {
         getTicketsTableSQL(),
         getPaymentsTableSQL(),
         getPriceListTableSQL(),
-        getActiveConnectionsTableSQL()
+        getActiveConnectionsTableSQL(),
+        getVehicleIndexesSQL(),
+        getVehicleTelemetryTableSQL()
     };
 
     for (const auto& sql : create_statements) {
@@ -80,7 +163,28 @@ bool Database::createTables() {
     return true;
 }
 
+static bool isSchemaChange(const std::string& sql) {
+    size_t i = sql.find_first_not_of(" \t\r\n");
+    if (i == std::string::npos) return false;
+    auto starts = [&](const char* kw) {
+        size_t n = std::char_traits<char>::length(kw);
+        if (sql.size() - i < n) return false;
+        for (size_t k = 0; k < n; ++k) {
+            if (std::toupper(static_cast<unsigned char>(sql[i + k])) != kw[k]) return false;
+        }
+        return true;
+    };
+    return starts("CREATE") || starts("DROP") || starts("ALTER");
+}
+
 bool Database::executeSQL(const std::string& sql) {
+    // DDL mijenja shemu -> keširani planovi više ne važe. SQLite bi ih i sam
+    // re-pripremio (SQLITE_SCHEMA), ali čistimo keš da ne držimo mrtve iskaze.
+    if (isSchemaChange(sql) && !stmt_cache_.empty()) {
+        finalizeCachedStatements();
+        stmt_invalidations_++;
+    }
+
     char* error_msg = nullptr;
     int result = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &error_msg);
 
@@ -120,7 +224,7 @@ bool Database::registerUser(const User& user) {
     sqlite3_bind_text(stmt, 6, user.pin_hash.c_str(), -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE) {
         if (rc == SQLITE_CONSTRAINT) {
@@ -130,6 +234,7 @@ bool Database::registerUser(const User& user) {
         }
         return false;
     }
+    UserCache::invalidateEverywhere(user.urn);   // briše i negativan unos za ovaj URN
     return true;
 }
 
@@ -140,16 +245,21 @@ std::unique_ptr<User> Database::getUser(const std::string& urn) {
         "SELECT urn, name, age, registration_date, active, pin_hash "
         "FROM users WHERE urn = ?";
 
+    last_error_.clear();
+    last_error_code_ = 0;
     sqlite3_stmt* stmt = nullptr;
     if (!prepareStatement(sql, &stmt)) return nullptr;
 
     sqlite3_bind_text(stmt, 1, urn.c_str(), -1, SQLITE_STATIC);
 
     std::unique_ptr<User> user = nullptr;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
+    const int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
         user = std::make_unique<User>(extractUser(stmt));
+    } else if (rc != SQLITE_DONE) {
+        setLastError("Failed to get user: " + std::string(sqlite3_errmsg(db_)), rc);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return user;
 }
 
@@ -175,11 +285,12 @@ bool Database::updateUser(const User& user) {
     sqlite3_bind_text(stmt, 6, user.urn.c_str(), -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         setLastError("Failed to update user", rc);
         return false;
     }
+    UserCache::invalidateEverywhere(user.urn);
     return true;
 }
 
@@ -193,35 +304,100 @@ bool Database::deleteUser(const std::string& urn) {
     sqlite3_bind_text(stmt, 1, urn.c_str(), -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         setLastError("Failed to delete user", rc);
         return false;
     }
+    UserCache::invalidateEverywhere(urn);
     return true;
 }
 
 std::vector<User> Database::getAllUsers() {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    // Po stranicama, pa ostali upiti na ovoj konekciji ne čekaju cijelu tabelu
+    std::vector<User> out;
+    forEachUser([&](const User& u) { out.push_back(u); return true; });
+    return out;
+}
 
-    const std::string sql =
-        "SELECT urn, name, age, registration_date, active, pin_hash FROM users";
+// ======================== Paged reads (keyset) ========================
 
-    sqlite3_stmt* stmt = nullptr;
-    std::vector<User> out;
+template <typename Row>
+std::vector<Row> Database::fetchPage(const std::string& sql, const std::string& after, size_t limit,
+                                     Row (Database::*extract)(sqlite3_stmt*)) {
+    std::vector<Row> out;
+    if (limit == 0) return out;
 
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    sqlite3_stmt* stmt = nullptr;
     if (!prepareStatement(sql, &stmt)) return out;
+    sqlite3_bind_text (stmt, 1, after.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(limit));
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        out.emplace_back(extractUser(stmt));
-    }
-    sqlite3_finalize(stmt);
+    out.reserve(limit);
+    while (sqlite3_step(stmt) == SQLITE_ROW) out.push_back((this->*extract)(stmt));
+    releaseStatement(stmt);
     return out;
 }
 
+namespace {
+// Stranicu po stranicu dok visit ne kaže stop ili dok stranica nije kraća od page_size
+template <typename Row, typename FetchPage, typename KeyOf>
+size_t visitPages(FetchPage fetch, KeyOf key_of, const std::function<bool(const Row&)>& visit, size_t page_size) {
+    page_size = std::max<size_t>(1, page_size);
+    size_t visited = 0;
+    std::string after;
+    while (true) {
+        const std::vector<Row> page = fetch(after, page_size);
+        for (const Row& row : page) {
+            ++visited;
+            if (!visit(row)) return visited;
+        }
+        if (page.size() < page_size) return visited;
+        after = key_of(page.back());
+    }
+}
+} // namespace
+
+std::vector<User> Database::getUsersPage(const std::string& after_urn, size_t limit) {
+    return fetchPage<User>(
+        "SELECT urn, name, age, registration_date, active, pin_hash FROM users "
+        "WHERE urn > ? ORDER BY urn LIMIT ?",
+        after_urn, limit, &Database::extractUser);
+}
+
+std::vector<Ticket> Database::getTicketsPage(const std::string& after_ticket_id, size_t limit) {
+    return fetchPage<Ticket>(
+        "SELECT ticket_id, user_urn, type, vehicle_type, route, price, discount, purchase_date, seat_number, used "
+        "FROM tickets WHERE ticket_id > ? ORDER BY ticket_id LIMIT ?",
+        after_ticket_id, limit, &Database::extractTicket);
+}
+
+std::vector<Payment> Database::getPaymentsPage(const std::string& after_transaction_id, size_t limit) {
+    return fetchPage<Payment>(
+        "SELECT transaction_id, ticket_id, amount, payment_method, payment_date, successful "
+        "FROM payments WHERE transaction_id > ? ORDER BY transaction_id LIMIT ?",
+        after_transaction_id, limit, &Database::extractPayment);
+}
+
+size_t Database::forEachUser(const std::function<bool(const User&)>& visit, size_t page_size) {
+    return visitPages<User>([this](const std::string& after, size_t n) { return getUsersPage(after, n); },
+                            [](const User& u) { return u.urn; }, visit, page_size);
+}
+
+size_t Database::forEachTicket(const std::function<bool(const Ticket&)>& visit, size_t page_size) {
+    return visitPages<Ticket>([this](const std::string& after, size_t n) { return getTicketsPage(after, n); },
+                              [](const Ticket& t) { return t.ticket_id; }, visit, page_size);
+}
+
+size_t Database::forEachPayment(const std::function<bool(const Payment&)>& visit, size_t page_size) {
+    return visitPages<Payment>([this](const std::string& after, size_t n) { return getPaymentsPage(after, n); },
+                               [](const Payment& p) { return p.transaction_id; }, visit, page_size);
+}
+
 // ======================== Groups ========================
 
-bool Database::createGroup(const Group& group) {
+bool Database::createGroup(const Group& group, int* group_id_out) {
     std::lock_guard<std::mutex> lock(db_mutex_);
 
     // 1) kreiraj grupu
@@ -239,28 +415,15 @@ bool Database::createGroup(const Group& group) {
     sqlite3_bind_int (stmt, 4, group.active ? 1 : 0);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         setLastError("Failed to create group (is name unique?)", rc);
         return false;
     }
 
-    // 2) dohvati id
-    int group_id = -1;
-    {
-        const std::string q = "SELECT group_id FROM groups WHERE group_name = ? LIMIT 1";
-        sqlite3_stmt* s2 = nullptr;
-        if (!prepareStatement(q, &s2)) return false;
-        sqlite3_bind_text(s2, 1, group.group_name.c_str(), -1, SQLITE_STATIC);
-        if (sqlite3_step(s2) == SQLITE_ROW) {
-            group_id = sqlite3_column_int(s2, 0);
-        }
-        sqlite3_finalize(s2);
-    }
-    if (group_id < 0) {
-        setLastError("Failed to resolve new group_id", -1);
-        return false;
-    }
+    // 2) id upravo upisanog reda (ista konekcija, pod db_mutex_)
+    const int group_id = static_cast<int>(sqlite3_last_insert_rowid(db_));
+    if (group_id_out) *group_id_out = group_id;
 
     // 3) dodaj lidera kao člana
     const std::string sqlAdd =
@@ -272,7 +435,7 @@ bool Database::createGroup(const Group& group) {
     std::string jd = nowISO();
     sqlite3_bind_text(s3, 3, jd.c_str(), -1, SQLITE_STATIC);
     int r3 = sqlite3_step(s3);
-    sqlite3_finalize(s3);
+    releaseStatement(s3);
     if (r3 != SQLITE_DONE) {
         setLastError("Failed to add leader as group member", r3);
         return false;
@@ -294,7 +457,7 @@ int Database::getGroupIdByName(const std::string& group_name) {
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         gid = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return gid;
 }
 
@@ -304,7 +467,7 @@ bool Database::userExists(const std::string& urn) {
     if (!prepareStatement(sql, &stmt)) return false;
     sqlite3_bind_text(stmt, 1, urn.c_str(), -1, SQLITE_STATIC);
     bool ok = (sqlite3_step(stmt) == SQLITE_ROW);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return ok;
 }
 
@@ -323,7 +486,7 @@ std::string Database::getGroupLeader(const std::string& group_name) {
         const unsigned char* c0 = sqlite3_column_text(stmt, 0);
         leader = c0 ? reinterpret_cast<const char*>(c0) : "";
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return leader;
 }
 
@@ -353,7 +516,7 @@ bool Database::addUserToGroup(const std::string& urn, const std::string& group_n
     int rc = sqlite3_step(chk);
     if (rc == SQLITE_ROW) {
         int active = sqlite3_column_int(chk, 0);
-        sqlite3_finalize(chk);
+        releaseStatement(chk);
         if (active != 0) {
             // već aktivan član -> odbij
             setLastError("User already in group", SQLITE_CONSTRAINT);
@@ -371,7 +534,7 @@ bool Database::addUserToGroup(const std::string& urn, const std::string& group_n
 
         rc = sqlite3_step(upd);
         int changes = sqlite3_changes(db_);
-        sqlite3_finalize(upd);
+        releaseStatement(upd);
 
         if (rc != SQLITE_DONE || changes != 1) {
             setLastError("Failed to reactivate user in group", rc);
@@ -379,7 +542,7 @@ bool Database::addUserToGroup(const std::string& urn, const std::string& group_n
         }
         return true;
     }
-    sqlite3_finalize(chk);
+    releaseStatement(chk);
 
     // Novi član — INSERT
     sqlite3_stmt* ins = nullptr;
@@ -393,7 +556,7 @@ bool Database::addUserToGroup(const std::string& urn, const std::string& group_n
 
     rc = sqlite3_step(ins);
     int changes = sqlite3_changes(db_);
-    sqlite3_finalize(ins);
+    releaseStatement(ins);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to add user to group", rc);
@@ -424,7 +587,7 @@ bool Database::removeUserFromGroup(const std::string& urn, const std::string& gr
 
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db_);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to remove user from group", rc);
@@ -438,6 +601,85 @@ bool Database::removeUserFromGroup(const std::string& urn, const std::string& gr
     return true;
 }
 
+std::unique_ptr<Group> Database::getGroupByName(const std::string& group_name) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement("SELECT group_id, group_name, leader_urn, creation_date, active "
+                          "FROM groups WHERE group_name = ? AND active = 1 LIMIT 1", &stmt))
+        return nullptr;
+    sqlite3_bind_text(stmt, 1, group_name.c_str(), -1, SQLITE_STATIC);
+    std::unique_ptr<Group> group;
+    if (sqlite3_step(stmt) == SQLITE_ROW) group = std::make_unique<Group>(extractGroup(stmt));
+    releaseStatement(stmt);
+    if (!group) return nullptr;
+
+    if (!prepareStatement("SELECT member_urn FROM group_members WHERE group_id = ? AND active = 1", &stmt))
+        return nullptr;
+    sqlite3_bind_int(stmt, 1, group->group_id);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* c0 = sqlite3_column_text(stmt, 0);
+        if (c0) group->members.emplace_back(reinterpret_cast<const char*>(c0));
+    }
+    releaseStatement(stmt);
+    return group;
+}
+
+bool Database::addUsersToGroup(int group_id, const std::vector<std::string>& urns) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    last_error_.clear(); last_error_code_ = 0;
+    if (urns.empty()) return true;
+
+    // Red nastaje samo za postojećeg korisnika; neaktivan član se reaktivira, aktivan ostaje
+    // netaknut (0 izmjena)
+    const char* sql =
+        "INSERT INTO group_members (group_id, member_urn, join_date, active) "
+        "SELECT ?, urn, ?, 1 FROM users WHERE urn = ? "
+        "ON CONFLICT(group_id, member_urn) DO UPDATE SET active = 1, join_date = excluded.join_date "
+        "WHERE active = 0";
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement(sql, &stmt)) {
+        const std::string err = last_error_;
+        const int code        = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+
+    const std::string jd = nowISO();
+    for (const auto& urn : urns) {
+        sqlite3_bind_int (stmt, 1, group_id);
+        sqlite3_bind_text(stmt, 2, jd.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, urn.c_str(), -1, SQLITE_STATIC);
+
+        const int rc      = sqlite3_step(stmt);
+        const int changes = sqlite3_changes(db_);
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        if (rc != SQLITE_DONE || changes == 0) {
+            releaseStatement(stmt);
+            // Razlog samo na putanji greške: nema korisnika ili je već član
+            const bool known = rc == SQLITE_DONE && userExists(urn);
+            executeSQL("ROLLBACK;");
+            if (rc != SQLITE_DONE) setLastError("Failed to add user to group: " + urn, rc);
+            else if (!known)       setLastError("User not found: " + urn, SQLITE_NOTFOUND);
+            else                   setLastError("User already in group: " + urn, SQLITE_CONSTRAINT);
+            return false;
+        }
+    }
+    releaseStatement(stmt);
+    if (!executeSQL("COMMIT;")) {
+        const std::string err = last_error_;
+        const int code        = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+    return true;
+}
+
 // ======================== Vehicles / Tickets / Payments ========================
 
 bool Database::registerVehicle(const Vehicle& vehicle) {
@@ -459,7 +701,7 @@ bool Database::registerVehicle(const Vehicle& vehicle) {
     sqlite3_bind_text(stmt, 7, vehicle.last_update.c_str(), -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         setLastError("Failed to register vehicle", rc);
         return false;
@@ -484,10 +726,183 @@ std::unique_ptr<Vehicle> Database::getVehicle(const std::string& uri) {
         Vehicle v = extractVehicle(stmt);
         vehicle = std::make_unique<Vehicle>(v);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return vehicle;
 }
 
+std::vector<Vehicle> Database::getAllVehicles() {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    const std::string sql =
+        "SELECT uri, type, capacity, available_seats, route, active, last_update FROM vehicles";
+
+    sqlite3_stmt* stmt = nullptr;
+    std::vector<Vehicle> out;
+
+    if (!prepareStatement(sql, &stmt)) return out;
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        out.emplace_back(extractVehicle(stmt));
+    }
+    releaseStatement(stmt);
+    return out;
+}
+
+bool Database::getVehicleTableStats(size_t& rows, int64_t& max_rowid) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement("SELECT COUNT(*), COALESCE(MAX(rowid), 0) FROM vehicles", &stmt)) return false;
+    const int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        rows      = static_cast<size_t>(sqlite3_column_int64(stmt, 0));
+        max_rowid = sqlite3_column_int64(stmt, 1);
+    }
+    releaseStatement(stmt);
+    if (rc != SQLITE_ROW) {
+        setLastError("Failed to count vehicles", rc);
+        return false;
+    }
+    return true;
+}
+
+bool Database::updateSeatAvailabilityBatch(const std::vector<std::pair<std::string, int>>& seats) {
+    if (seats.empty()) return true;
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    // Jedan commit za cijeli batch (write-behind iz SeatInventory)
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement("UPDATE vehicles SET available_seats = ? WHERE uri = ?", &stmt)) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+    for (const auto& s : seats) {
+        sqlite3_bind_int (stmt, 1, s.second);
+        sqlite3_bind_text(stmt, 2, s.first.c_str(), -1, SQLITE_STATIC);
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE) {
+            releaseStatement(stmt);
+            executeSQL("ROLLBACK;");
+            setLastError("Failed to update available seats", rc);
+            return false;
+        }
+    }
+    releaseStatement(stmt);
+    if (!executeSQL("COMMIT;")) {
+        std::string err = last_error_;
+        int code = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+    return true;
+}
+
+bool Database::updateSeatAvailabilityBatch(const std::vector<std::string>& uris, const SeatCount& current) {
+    if (uris.empty()) return true;
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    last_error_.clear();
+    last_error_code_ = 0;
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+    if (!writeSeatCounts(uris, current) || !executeSQL("COMMIT;")) {
+        const std::string err = last_error_;
+        const int code        = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+    return true;
+}
+
+bool Database::writeSeatCounts(const std::vector<std::string>& uris, const SeatCount& current) {
+    if (uris.empty() || !current) return true;
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement("UPDATE vehicles SET available_seats = ? WHERE uri = ?", &stmt)) return false;
+    for (const auto& uri : uris) {
+        // Čita se tek ovdje: drugi upisi brojača čekaju na isti write lock
+        const int available = current(uri);
+        if (available < 0) continue;
+        sqlite3_bind_int (stmt, 1, available);
+        sqlite3_bind_text(stmt, 2, uri.c_str(), -1, SQLITE_STATIC);
+        const int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE) {
+            releaseStatement(stmt);
+            setLastError("Failed to update available seats", rc);
+            return false;
+        }
+    }
+    releaseStatement(stmt);
+    return true;
+}
+
+bool Database::upsertVehicleTelemetryBatch(const std::vector<VehicleTelemetry>& rows) {
+    if (rows.empty()) return true;
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement("INSERT OR REPLACE INTO vehicle_telemetry "
+                          "(uri, occupancy, lat_e6, lon_e6, sample_ms, samples, updated) "
+                          "VALUES (?, ?, ?, ?, ?, ?, datetime('now'))", &stmt)) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+    for (const auto& r : rows) {
+        sqlite3_bind_text (stmt, 1, r.uri.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int  (stmt, 2, r.occupancy);
+        sqlite3_bind_int  (stmt, 3, r.lat_e6);
+        sqlite3_bind_int  (stmt, 4, r.lon_e6);
+        sqlite3_bind_int64(stmt, 5, static_cast<sqlite3_int64>(r.sample_ms));
+        sqlite3_bind_int64(stmt, 6, static_cast<sqlite3_int64>(r.samples));
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE) {
+            releaseStatement(stmt);
+            executeSQL("ROLLBACK;");
+            setLastError("Failed to store vehicle telemetry", rc);
+            return false;
+        }
+    }
+    releaseStatement(stmt);
+    if (!executeSQL("COMMIT;")) {
+        std::string err = last_error_;
+        int code = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<VehicleTelemetry> Database::getVehicleTelemetry(const std::string& uri) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement("SELECT uri, occupancy, lat_e6, lon_e6, sample_ms, samples "
+                          "FROM vehicle_telemetry WHERE uri = ? LIMIT 1", &stmt)) return nullptr;
+    sqlite3_bind_text(stmt, 1, uri.c_str(), -1, SQLITE_STATIC);
+
+    std::unique_ptr<VehicleTelemetry> row;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        row = std::make_unique<VehicleTelemetry>();
+        const unsigned char* u = sqlite3_column_text(stmt, 0);
+        row->uri       = u ? reinterpret_cast<const char*>(u) : "";
+        row->occupancy = sqlite3_column_int(stmt, 1);
+        row->lat_e6    = sqlite3_column_int(stmt, 2);
+        row->lon_e6    = sqlite3_column_int(stmt, 3);
+        row->sample_ms = static_cast<uint64_t>(sqlite3_column_int64(stmt, 4));
+        row->samples   = static_cast<uint64_t>(sqlite3_column_int64(stmt, 5));
+    }
+    releaseStatement(stmt);
+    return row;
+}
+
 bool Database::updateSeatAvailability(const std::string& uri, int available_seats) {
     std::lock_guard<std::mutex> lock(db_mutex_);
 
@@ -500,7 +915,7 @@ bool Database::updateSeatAvailability(const std::string& uri, int available_seat
     sqlite3_bind_text(stmt, 2, uri.c_str(), -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         setLastError("Failed to update available seats", rc);
         return false;
@@ -530,7 +945,7 @@ bool Database::createTicket(const Ticket& ticket) {
     sqlite3_bind_int (stmt, 10, ticket.used ? 1 : 0);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         setLastError("Failed to insert ticket", rc);
         return false;
@@ -559,7 +974,226 @@ bool Database::recordPayment(const Payment& payment) {
     sqlite3_bind_int   (stmt, 6, payment.successful ? 1 : 0);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
+    if (rc != SQLITE_DONE) {
+        setLastError("Failed to insert payment", rc);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Ticket> Database::getTicket(const std::string& ticket_id) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    const std::string sql =
+        "SELECT ticket_id, user_urn, type, vehicle_type, route, price, discount, purchase_date, seat_number, used "
+        "FROM tickets WHERE ticket_id = ? LIMIT 1";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement(sql, &stmt)) return nullptr;
+    sqlite3_bind_text(stmt, 1, ticket_id.c_str(), -1, SQLITE_STATIC);
+
+    std::unique_ptr<Ticket> ticket;
+    if (sqlite3_step(stmt) == SQLITE_ROW) ticket = std::make_unique<Ticket>(extractTicket(stmt));
+    releaseStatement(stmt);
+    return ticket;
+}
+
+std::vector<Ticket> Database::getUserTickets(const std::string& urn) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    const std::string sql =
+        "SELECT ticket_id, user_urn, type, vehicle_type, route, price, discount, purchase_date, seat_number, used "
+        "FROM tickets WHERE user_urn = ?";
+
+    std::vector<Ticket> out;
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement(sql, &stmt)) return out;
+    sqlite3_bind_text(stmt, 1, urn.c_str(), -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW) out.emplace_back(extractTicket(stmt));
+    releaseStatement(stmt);
+    return out;
+}
+
+std::unique_ptr<Payment> Database::getPayment(const std::string& transaction_id) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    const std::string sql =
+        "SELECT transaction_id, ticket_id, amount, payment_method, payment_date, successful "
+        "FROM payments WHERE transaction_id = ? LIMIT 1";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement(sql, &stmt)) return nullptr;
+    sqlite3_bind_text(stmt, 1, transaction_id.c_str(), -1, SQLITE_STATIC);
+
+    std::unique_ptr<Payment> payment;
+    if (sqlite3_step(stmt) == SQLITE_ROW) payment = std::make_unique<Payment>(extractPayment(stmt));
+    releaseStatement(stmt);
+    return payment;
+}
+
+// ======================== Purchase (batch) ========================
+
+namespace {
+constexpr int kTicketColumns       = 10;
+constexpr int kMaxTicketRowsPerSQL = 32;   // 320 parametara < SQLITE_MAX_VARIABLE_NUMBER (999)
+
+std::string multiRowTicketInsertSQL(int rows) {
+    std::string sql =
+        "INSERT INTO tickets (ticket_id, user_urn, type, vehicle_type, route, price, discount, purchase_date, seat_number, used) "
+        "VALUES ";
+    for (int r = 0; r < rows; ++r) {
+        sql += (r == 0) ? "(?,?,?,?,?,?,?,?,?,?)" : ",(?,?,?,?,?,?,?,?,?,?)";
+    }
+    return sql;
+}
+} // namespace
+
+bool Database::purchaseTickets(const std::string& vehicle_uri, std::vector<Ticket>& tickets,
+                               const Payment& payment, int* available_after, bool update_seats) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    last_error_.clear();
+    last_error_code_ = 0;
+
+    const int count = static_cast<int>(tickets.size());
+    if (count < 1) {
+        setLastError("No tickets to purchase", SQLITE_MISUSE);
+        return false;
+    }
+
+    // IMMEDIATE: write lock odmah, pa se provjera i skidanje mjesta ne mogu preplesti
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+    auto fail = [this](std::string err, int code) {
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    };
+
+    sqlite3_stmt* stmt = nullptr;
+    int rc = SQLITE_OK;
+    int available = -1;
+    if (update_seats) {
+        // 1) Uslovno skidanje mjesta (nema read-modify-write sa zastarjelom vrijednošću)
+        if (!prepareStatement("UPDATE vehicles SET available_seats = available_seats - ?1 "
+                              "WHERE uri = ?2 AND available_seats >= ?1", &stmt)) {
+            return fail(last_error_, last_error_code_);
+        }
+        sqlite3_bind_int (stmt, 1, count);
+        sqlite3_bind_text(stmt, 2, vehicle_uri.c_str(), -1, SQLITE_TRANSIENT);
+        rc = sqlite3_step(stmt);
+        const int changes = sqlite3_changes(db_);
+        releaseStatement(stmt);
+        if (rc != SQLITE_DONE) return fail("Failed to update available seats", rc);
+
+        // 2) Stanje nakon skidanja (ili razlog odbijanja) – isti lock, konzistentno
+        if (!prepareStatement("SELECT capacity, available_seats FROM vehicles WHERE uri = ?", &stmt)) {
+            return fail(last_error_, last_error_code_);
+        }
+        sqlite3_bind_text(stmt, 1, vehicle_uri.c_str(), -1, SQLITE_TRANSIENT);
+        rc = sqlite3_step(stmt);
+        const bool found   = (rc == SQLITE_ROW);
+        const int capacity = found ? sqlite3_column_int(stmt, 0) : 0;
+        available          = found ? sqlite3_column_int(stmt, 1) : 0;
+        releaseStatement(stmt);
+
+        if (!found)       return fail("Vehicle not found", SQLITE_NOTFOUND);
+        if (changes == 0) {
+            if (available_after) *available_after = available;
+            return fail("Insufficient seats available", SQLITE_FULL);
+        }
+
+        const int first_seat = capacity - (available + count) + 1;
+        for (int i = 0; i < count; ++i) tickets[i].seat_number = std::to_string(first_seat + i);
+    }
+
+    // 3) Karte + plaćanje
+    if (!insertPurchaseRows(tickets, payment)) return fail(last_error_, last_error_code_);
+
+    if (!executeSQL("COMMIT;")) return fail(last_error_, last_error_code_);
+
+    if (available_after && update_seats) *available_after = available;
+    return true;
+}
+
+bool Database::purchaseTickets(const std::string& vehicle_uri, std::vector<Ticket>& tickets,
+                               const Payment& payment, const SeatCount& current) {
+    return purchaseTicketsBatch({{tickets, payment}}, {vehicle_uri}, current);
+}
+
+bool Database::purchaseTicketsBatch(const std::vector<TicketPurchase>& purchases,
+                                    const std::vector<std::string>& seat_uris, const SeatCount& current) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    last_error_.clear();
+    last_error_code_ = 0;
+    if (purchases.empty() && (seat_uris.empty() || !current)) return true;
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+    for (const auto& p : purchases) {
+        if (p.tickets.empty() || !insertPurchaseRows(p.tickets, p.payment)) {
+            const std::string err = p.tickets.empty() ? "No tickets to purchase" : last_error_;
+            const int code        = p.tickets.empty() ? SQLITE_MISUSE : last_error_code_;
+            executeSQL("ROLLBACK;");
+            setLastError(err, code);
+            return false;
+        }
+    }
+    if (!writeSeatCounts(seat_uris, current) || !executeSQL("COMMIT;")) {
+        const std::string err = last_error_;
+        const int code        = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+    return true;
+}
+
+bool Database::insertPurchaseRows(const std::vector<Ticket>& tickets, const Payment& payment) {
+    const int count = static_cast<int>(tickets.size());
+    sqlite3_stmt* stmt = nullptr;
+    int rc = SQLITE_OK;
+
+    // Karte: multi-row INSERT po blokovima
+    for (int base = 0; base < count; base += kMaxTicketRowsPerSQL) {
+        const int rows = std::min(kMaxTicketRowsPerSQL, count - base);
+        if (!prepareStatement(multiRowTicketInsertSQL(rows), &stmt)) {
+            return false;
+        }
+        for (int r = 0; r < rows; ++r) {
+            const Ticket& t = tickets[base + r];
+            const int col = r * kTicketColumns;
+            sqlite3_bind_text  (stmt, col + 1,  t.ticket_id.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text  (stmt, col + 2,  t.user_urn.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int   (stmt, col + 3,  static_cast<int>(t.type));
+            sqlite3_bind_int   (stmt, col + 4,  static_cast<int>(t.vehicle_type));
+            sqlite3_bind_text  (stmt, col + 5,  t.route.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_double(stmt, col + 6,  t.price);
+            sqlite3_bind_double(stmt, col + 7,  t.discount);
+            sqlite3_bind_text  (stmt, col + 8,  t.purchase_date.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text  (stmt, col + 9,  t.seat_number.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int   (stmt, col + 10, t.used ? 1 : 0);
+        }
+        rc = sqlite3_step(stmt);
+        releaseStatement(stmt);
+        if (rc != SQLITE_DONE) {
+            setLastError("Failed to insert tickets", rc);
+            return false;
+        }
+    }
+
+    // Plaćanje
+    if (!prepareStatement("INSERT INTO payments (transaction_id, ticket_id, amount, payment_method, payment_date, successful) "
+                          "VALUES (?, ?, ?, ?, ?, ?)", &stmt)) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, payment.transaction_id.c_str(), -1, SQLITE_STATIC);
+    if (payment.ticket_id.empty()) sqlite3_bind_null(stmt, 2);
+    else                           sqlite3_bind_text(stmt, 2, payment.ticket_id.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_double(stmt, 3, payment.amount);
+    sqlite3_bind_text  (stmt, 4, payment.payment_method.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text  (stmt, 5, payment.payment_date.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int   (stmt, 6, payment.successful ? 1 : 0);
+    rc = sqlite3_step(stmt);
+    releaseStatement(stmt);
     if (rc != SQLITE_DONE) {
         setLastError("Failed to insert payment", rc);
         return false;
@@ -595,7 +1229,22 @@ std::unique_ptr<PriceList> Database::getPrice(VehicleType vehicle_type, TicketTy
         PriceList p = extractPriceList(stmt);
         out = std::make_unique<PriceList>(p);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
+    return out;
+}
+
+std::vector<PriceList> Database::getAllPrices() {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    const std::string sql =
+        "SELECT vehicle_type, ticket_type, base_price, distance_multiplier, time_multiplier, last_update "
+        "FROM price_list";
+
+    std::vector<PriceList> out;
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement(sql, &stmt)) return out;
+    while (sqlite3_step(stmt) == SQLITE_ROW) out.emplace_back(extractPriceList(stmt));
+    releaseStatement(stmt);
     return out;
 }
 
@@ -623,7 +1272,7 @@ bool Database::updatePriceList(const PriceList& price) {
 
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db_);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to update price_list", rc);
@@ -647,7 +1296,7 @@ bool Database::updatePriceList(const PriceList& price) {
     sqlite3_bind_text  (ins, 6, ts.c_str(), -1, SQLITE_TRANSIENT);
 
     rc = sqlite3_step(ins);
-    sqlite3_finalize(ins);
+    releaseStatement(ins);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to insert into price_list", rc);
@@ -677,6 +1326,30 @@ bool Database::isEligibleForGroupDiscount(TicketType ticket_type, int group_size
     return false;
 }
 
+std::unique_ptr<Vehicle> Database::getVehicleByRoute(const std::string& route, VehicleType preferred) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+
+    // Jedan upit umjesto po jednog za svaki tip: traženi tip prvi, zatim aktivna
+    // vozila sa slobodnim mjestima (idx_vehicles_route_type_active)
+    const std::string sql =
+        "SELECT uri, type, capacity, available_seats, route, active, last_update "
+        "FROM vehicles WHERE route = ? "
+        "ORDER BY (type = ?) DESC, active DESC, (available_seats > 0) DESC LIMIT 1";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement(sql, &stmt)) return nullptr;
+
+    sqlite3_bind_text(stmt, 1, route.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int (stmt, 2, static_cast<int>(preferred));
+
+    std::unique_ptr<Vehicle> vehicle = nullptr;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        vehicle = std::make_unique<Vehicle>(extractVehicle(stmt));
+    }
+    releaseStatement(stmt);
+    return vehicle;
+}
+
 std::unique_ptr<Vehicle> Database::getVehicleByRouteAndType(const std::string& route, VehicleType type) {
     std::lock_guard<std::mutex> lock(db_mutex_);
 
@@ -695,21 +1368,88 @@ std::unique_ptr<Vehicle> Database::getVehicleByRouteAndType(const std::string& r
         Vehicle v = extractVehicle(stmt);
         vehicle = std::make_unique<Vehicle>(v);
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return vehicle;
 }
 
 // ======================== Helpers (prepare, hash, extract) ========================
 
+// Poziva se uz zaključan db_mutex_. Pogodak u kešu vraća već pripremljen iskaz
+// (resetovan, bez vezanih parametara); promašaj ga priprema i ubacuje u keš.
+// Ako je isti SQL već u upotrebi (ugniježđen poziv), priprema se privremeni
+// iskaz koji releaseStatement finalizuje.
+namespace {
+
+LatencyHistogram* statementHistogram() {
+    static LatencyHistogram& h = metrics::Registry::instance().histogram(
+        "tp_db_statement_seconds", "", "Prepared statement time from prepare to release (bind + step)");
+    return metrics::Registry::instance().enabled() ? &h : nullptr;
+}
+
+} // namespace
+
 bool Database::prepareStatement(const std::string& sql, sqlite3_stmt** stmt) {
+    auto it = stmt_cache_.find(sql);
+    if (it != stmt_cache_.end() && !it->second.in_use) {
+        it->second.in_use = true;
+        if (statementHistogram() || tracing::current().sampled) it->second.started = std::chrono::steady_clock::now();
+        *stmt = it->second.stmt;
+        stmt_hits_++;
+        return true;
+    }
+    stmt_misses_++;
+
     int result = sqlite3_prepare_v2(db_, sql.c_str(), -1, stmt, nullptr);
     if (result != SQLITE_OK) {
         setLastError("Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)), result);
         return false;
     }
+    if (it == stmt_cache_.end() && stmt_cache_.size() < kMaxCachedStatements) {
+        stmt_cache_.emplace(sql, CachedStatement{*stmt, true, std::chrono::steady_clock::now()});
+    }
     return true;
 }
 
+void Database::releaseStatement(sqlite3_stmt* stmt) {
+    if (!stmt) return;
+    const char* sql = sqlite3_sql(stmt);
+    auto it = sql ? stmt_cache_.find(sql) : stmt_cache_.end();
+    if (it != stmt_cache_.end() && it->second.stmt == stmt) {
+        if (it->second.started != std::chrono::steady_clock::time_point{}) {
+            const uint64_t ns = metrics::ScopedTimer::elapsedNanos(it->second.started);
+            if (auto* h = statementHistogram()) h->record(ns);
+            tracing::recordSpan("sqlite.statement", it->second.started, ns);
+        }
+        it->second.started = {};
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        it->second.in_use = false;
+        return;
+    }
+    sqlite3_finalize(stmt);
+}
+
+void Database::finalizeCachedStatements() {
+    for (auto& kv : stmt_cache_) sqlite3_finalize(kv.second.stmt);
+    stmt_cache_.clear();
+}
+
+void Database::clearStatementCache() {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    finalizeCachedStatements();
+    stmt_invalidations_++;
+}
+
+Database::StatementCacheStats Database::getStatementCacheStats() {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    StatementCacheStats st;
+    st.hits          = stmt_hits_;
+    st.misses        = stmt_misses_;
+    st.invalidations = stmt_invalidations_;
+    st.cached        = stmt_cache_.size();
+    return st;
+}
+
 void Database::setLastError(const std::string& error, int code) {
     last_error_      = error;
     last_error_code_ = code;
@@ -878,6 +1618,29 @@ std::string Database::getVehiclesTableSQL() {
     )";
 }
 
+std::string Database::getVehicleIndexesSQL() {
+    // Pretraga po ruti (RESERVE_SEAT/PURCHASE_TICKET bez uri-ja)
+    return R"(
+        CREATE INDEX IF NOT EXISTS idx_vehicles_route_type_active
+            ON vehicles (route, type, active)
+    )";
+}
+
+std::string Database::getVehicleTelemetryTableSQL() {
+    // Jedan red po vozilu (zadnji uzorak); istorija ostaje u agregatima u memoriji
+    return R"(
+        CREATE TABLE IF NOT EXISTS vehicle_telemetry (
+            uri TEXT PRIMARY KEY,
+            occupancy INTEGER,
+            lat_e6 INTEGER,
+            lon_e6 INTEGER,
+            sample_ms INTEGER,
+            samples INTEGER,
+            updated TEXT
+        )
+    )";
+}
+
 std::string Database::getTicketsTableSQL() {
     return R"(
         CREATE TABLE IF NOT EXISTS tickets (
@@ -960,7 +1723,7 @@ bool Database::updatePrice(VehicleType vehicle_type, TicketType ticket_type, dou
 
     int rc = sqlite3_step(upd);
     int changes = sqlite3_changes(db_);
-    sqlite3_finalize(upd);
+    releaseStatement(upd);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to update price_list", rc);
@@ -981,7 +1744,7 @@ bool Database::updatePrice(VehicleType vehicle_type, TicketType ticket_type, dou
     sqlite3_bind_text  (ins, 4, ts.c_str(), -1, SQLITE_TRANSIENT);
 
     rc = sqlite3_step(ins);
-    sqlite3_finalize(ins);
+    releaseStatement(ins);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to insert into price_list", rc);
@@ -1027,7 +1790,7 @@ bool Database::updateVehicle(const std::string& uri,
 
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db_);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to update vehicle", rc);
@@ -1064,7 +1827,7 @@ bool Database::updateVehicleCapacity(const std::string& uri, int capacity, int a
 
     int rc = sqlite3_step(stmt);
     int changes = sqlite3_changes(db_);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     if (rc != SQLITE_DONE) {
         setLastError("Failed to update vehicle capacity", rc);
@@ -1077,61 +1840,431 @@ bool Database::updateVehicleCapacity(const std::string& uri, int capacity, int a
     return true;
 }
 
+bool Database::updateVehiclesBatch(const std::vector<VehicleUpdate>& updates) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    last_error_.clear(); last_error_code_ = 0;
+    if (updates.empty()) return true;
+
+    for (const auto& u : updates) {
+        if (u.uri.empty()) { setLastError("Empty URI", SQLITE_MISUSE); return false; }
+        if (!u.active && !u.route && !u.type && !u.capacity) {
+            setLastError("Nothing to update for " + u.uri, SQLITE_MISUSE);
+            return false;
+        }
+        if (u.available_seats && !u.capacity) {
+            setLastError("available_seats without capacity for " + u.uri, SQLITE_MISUSE);
+            return false;
+        }
+        if (u.capacity && (*u.capacity < 0 || u.available_seats.value_or(*u.capacity) < 0 ||
+                           u.available_seats.value_or(*u.capacity) > *u.capacity)) {
+            setLastError("Invalid capacity/available_seats for " + u.uri, SQLITE_MISUSE);
+            return false;
+        }
+    }
+
+    // Jedan statement za sve stavke: NULL parametar ostavlja postojeću kolonu
+    const char* sql =
+        "UPDATE vehicles SET active = COALESCE(?, active), route = COALESCE(?, route), "
+        "type = COALESCE(?, type), capacity = COALESCE(?, capacity), "
+        "available_seats = COALESCE(?, available_seats), last_update = ? WHERE uri = ?";
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+    sqlite3_stmt* stmt = nullptr;
+    if (!prepareStatement(sql, &stmt)) {
+        const std::string err = last_error_;
+        const int code        = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+
+    const std::string ts = nowISO();
+    for (const auto& u : updates) {
+        if (u.active) sqlite3_bind_int(stmt, 1, *u.active ? 1 : 0); else sqlite3_bind_null(stmt, 1);
+        if (u.route)  sqlite3_bind_text(stmt, 2, u.route->c_str(), -1, SQLITE_STATIC);
+        else          sqlite3_bind_null(stmt, 2);
+        if (u.type)   sqlite3_bind_int(stmt, 3, static_cast<int>(*u.type)); else sqlite3_bind_null(stmt, 3);
+        if (u.capacity) {
+            sqlite3_bind_int(stmt, 4, *u.capacity);
+            sqlite3_bind_int(stmt, 5, u.available_seats.value_or(*u.capacity));
+        } else {
+            sqlite3_bind_null(stmt, 4);
+            sqlite3_bind_null(stmt, 5);
+        }
+        sqlite3_bind_text(stmt, 6, ts.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 7, u.uri.c_str(), -1, SQLITE_STATIC);
+
+        const int rc      = sqlite3_step(stmt);
+        const int changes = sqlite3_changes(db_);
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        if (rc != SQLITE_DONE || changes == 0) {
+            releaseStatement(stmt);
+            executeSQL("ROLLBACK;");
+            if (rc != SQLITE_DONE) setLastError("Failed to update vehicle " + u.uri, rc);
+            else                   setLastError("Vehicle not found: " + u.uri, SQLITE_NOTFOUND);
+            return false;
+        }
+    }
+    releaseStatement(stmt);
+    if (!executeSQL("COMMIT;")) {
+        const std::string err = last_error_;
+        const int code        = last_error_code_;
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    }
+    return true;
+}
+
+bool Database::updatePricesBatch(const std::vector<PriceList>& prices) {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    last_error_.clear(); last_error_code_ = 0;
+    if (prices.empty()) return true;
+
+    const char* updSql =
+        "UPDATE price_list SET base_price=?, last_update=? "
+        "WHERE vehicle_type=? AND ticket_type=?";
+    const char* insSql =
+        "INSERT INTO price_list (vehicle_type, ticket_type, base_price, distance_multiplier, time_multiplier, last_update) "
+        "VALUES (?, ?, ?, 1.0, 1.0, ?)";
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) return false;
+    auto fail = [this](std::string err, int code) {
+        executeSQL("ROLLBACK;");
+        setLastError(err, code);
+        return false;
+    };
+
+    sqlite3_stmt* upd = nullptr;
+    sqlite3_stmt* ins = nullptr;
+    if (!prepareStatement(updSql, &upd)) return fail(last_error_, last_error_code_);
+    if (!prepareStatement(insSql, &ins)) {
+        releaseStatement(upd);
+        return fail(last_error_, last_error_code_);
+    }
+
+    const std::string ts = nowISO();
+    for (const auto& p : prices) {
+        sqlite3_bind_double(upd, 1, p.base_price);
+        sqlite3_bind_text  (upd, 2, ts.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int   (upd, 3, static_cast<int>(p.vehicle_type));
+        sqlite3_bind_int   (upd, 4, static_cast<int>(p.ticket_type));
+        int rc = sqlite3_step(upd);
+        const int changes = sqlite3_changes(db_);
+        sqlite3_reset(upd);
+        if (rc == SQLITE_DONE && changes == 0) {
+            // nije postojalo – INSERT
+            sqlite3_bind_int   (ins, 1, static_cast<int>(p.vehicle_type));
+            sqlite3_bind_int   (ins, 2, static_cast<int>(p.ticket_type));
+            sqlite3_bind_double(ins, 3, p.base_price);
+            sqlite3_bind_text  (ins, 4, ts.c_str(), -1, SQLITE_STATIC);
+            rc = sqlite3_step(ins);
+            sqlite3_reset(ins);
+        }
+        if (rc != SQLITE_DONE) {
+            releaseStatement(upd);
+            releaseStatement(ins);
+            return fail("Failed to update price_list", rc);
+        }
+    }
+    releaseStatement(upd);
+    releaseStatement(ins);
+    if (!executeSQL("COMMIT;")) return fail(last_error_, last_error_code_);
+    return true;
+}
+
 // ======================== DatabasePool ========================
 
+namespace {
+// Parkirana konekcija niti (thread affinity); generation poništava stare slotove
+struct AffinitySlot {
+    uint64_t generation{0};
+    uint32_t slot{0};
+    bool     valid{false};
+};
+thread_local AffinitySlot tls_affinity;
+
+uint64_t elapsedMicros(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+LatencyHistogram& poolWaitHistogram() {
+    static LatencyHistogram& h = metrics::Registry::instance().histogram(
+        "tp_db_pool_wait_seconds", "", "Wait for a pooled SQLite connection (0 when one is free)");
+    return h;
+}
+} // namespace
+
+DatabasePool::Lease& DatabasePool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_       = other.pool_;
+        set_        = other.set_;
+        db_         = std::move(other.db_);
+        slot_       = other.slot_;
+        other.pool_ = nullptr;
+        other.set_  = nullptr;
+    }
+    return *this;
+}
+
+void DatabasePool::Lease::release() {
+    if (pool_ && set_ && db_) {
+        pool_->releaseSlot(*set_, slot_);
+        pool_->unpin(set_);
+    }
+    pool_ = nullptr;
+    set_  = nullptr;
+    db_.reset();
+}
+
 DatabasePool& DatabasePool::getInstance() {
     static DatabasePool instance;
     return instance;
 }
 
-bool DatabasePool::initialize(const std::string& db_path, int pool_size) {
-    db_path_ = db_path;
-    connections_.resize(pool_size);
-    available_.resize(pool_size, true);
+bool DatabasePool::initialize(const std::string& db_path, int pool_size,
+                              const DatabaseOptions& options) {
+    if (pool_size < 1) pool_size = 1;
+
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    // Ponovna inicijalizacija: stari zakupi se vraćaju u svoj (povučeni) set
+    initialized_ = false;
+    retireCurrent(nullptr);
 
+    db_path_ = db_path;
+    auto set = std::make_unique<SlotSet>();
+    set->slots      = std::make_unique<Slot[]>(pool_size);
+    set->count      = static_cast<size_t>(pool_size);
+    set->generation = ++generation_;
+    // Shemu pravi prva konekcija; ostale dijele isti fajl (:memory: je zasebna baza po konekciji)
+    DatabaseOptions rest = options;
+    rest.create_schema   = options.create_schema && (db_path.empty() || db_path == ":memory:");
     for (int i = 0; i < pool_size; ++i) {
-        connections_[i] = std::make_shared<Database>();
-        if (!connections_[i]->initialize(db_path)) {
+        set->slots[i].db = std::make_shared<Database>();
+        if (!set->slots[i].db->initialize(db_path, i == 0 ? options : rest)) {
+            pool_cv_.notify_all();    // čekači vide !initialized_ i odustaju
             return false;
         }
     }
 
+    for (uint32_t i = static_cast<uint32_t>(set->count); i-- > 0; ) {
+        set->slot_of[set->slots[i].db.get()] = i;
+        pushFree(*set, i);            // slot 0 završi na vrhu steka
+    }
+    retireCurrent(set.release());
     initialized_ = true;
+    pool_cv_.notify_all();
     return true;
 }
 
-std::shared_ptr<Database> DatabasePool::getConnection() {
-    std::unique_lock<std::mutex> lock(pool_mutex_);
-    pool_cv_.wait(lock, [this] {
-        for (bool avail : available_) if (avail) return true;
-        return false;
-    });
+DatabasePool::SlotSet* DatabasePool::pinCurrent() {
+    // seq_cst par sa exchange + čekanjem u retireCurrent: ili vidimo novi set,
+    // ili retireCurrent sačeka da referenca na stari bude upisana
+    pinning_.fetch_add(1);
+    SlotSet* set = current_.load();
+    if (set) set->refs.fetch_add(1);
+    pinning_.fetch_sub(1);
+    return set;
+}
+
+void DatabasePool::unpin(SlotSet* set) {
+    if (set->refs.fetch_sub(1) != 1) return;
+    // Posljednja referenca povučenog seta (tekući drži referencu pool-a)
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    retired_.erase(std::remove(retired_.begin(), retired_.end(), set), retired_.end());
+    delete set;
+}
+
+void DatabasePool::unpinLocked(SlotSet* set) {
+    if (set->refs.fetch_sub(1) != 1) return;
+    retired_.erase(std::remove(retired_.begin(), retired_.end(), set), retired_.end());
+    delete set;
+}
 
-    for (size_t i = 0; i < available_.size(); ++i) {
-        if (available_[i]) {
-            available_[i] = false;
-            return connections_[i];
+void DatabasePool::retireCurrent(SlotSet* next) {
+    SlotSet* old = current_.exchange(next);
+    slot_count_  = next ? next->count : 0;
+    // Pin u toku je možda uzeo stari pokazivač: sačekaj da upiše referencu (par instrukcija)
+    while (pinning_.load() != 0) std::this_thread::yield();
+    if (!old) return;
+    retired_.push_back(old);
+    unpinLocked(old);              // referenca pool-a; zakupi u toku drže set dalje
+}
+
+void DatabasePool::pushFree(SlotSet& set, uint32_t slot) {
+    uint64_t head = set.free_head.load();
+    for (;;) {
+        set.slots[slot].next.store(static_cast<uint32_t>(head));
+        const uint64_t next_head = (((head >> 32) + 1) << 32) | (slot + 1);
+        if (set.free_head.compare_exchange_weak(head, next_head)) return;
+    }
+}
+
+bool DatabasePool::popFree(SlotSet& set, uint32_t& slot) {
+    uint64_t head = set.free_head.load();
+    for (;;) {
+        const uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0) return false;
+        const uint32_t next = set.slots[top - 1].next.load();
+        // Tag u gornjih 32 bita sprječava ABA (pop/push istog indeksa između load i CAS)
+        const uint64_t next_head = (((head >> 32) + 1) << 32) | next;
+        if (set.free_head.compare_exchange_weak(head, next_head)) {
+            slot = top - 1;
+            return true;
+        }
+    }
+}
+
+bool DatabasePool::tryAcquireSlot(SlotSet& set, uint32_t& slot) {
+    // 1) Vlastita parkirana konekcija
+    if (thread_affinity_ && tls_affinity.valid && tls_affinity.generation == set.generation) {
+        uint8_t expected = SLOT_PARKED;
+        if (set.slots[tls_affinity.slot].state.compare_exchange_strong(expected, SLOT_IN_USE)) {
+            set.parked--;
+            affinity_hits_++;
+            slot = tls_affinity.slot;
+            return true;
+        }
+    }
+    // 2) Slobodni stek (na steku su samo SLOT_FREE slotovi)
+    if (popFree(set, slot)) {
+        set.slots[slot].state = SLOT_IN_USE;
+        return true;
+    }
+    // 3) Tuđa parkirana konekcija (samo kad je stek prazan). Bez parkiranih nema prolaza;
+    // inače kursor: sljedeća krađa kreće iza prethodne, pa niti ne prolaze iste zauzete slotove
+    if (set.parked.load() == 0) return false;
+    const uint32_t n     = static_cast<uint32_t>(set.count);
+    const uint32_t start = set.steal_cursor.load(std::memory_order_relaxed);
+    for (uint32_t k = 0; k < n; ++k) {
+        const uint32_t i = (start + k) % n;
+        uint8_t expected = SLOT_PARKED;
+        if (set.slots[i].state.compare_exchange_strong(expected, SLOT_IN_USE)) {
+            set.parked--;
+            set.steal_cursor.store((i + 1) % n, std::memory_order_relaxed);
+            steals_++;
+            slot = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DatabasePool::releaseSlot(SlotSet& set, uint32_t slot) {
+    if (slot >= set.count) return false;
+
+    // Povučeni set se ne parkira: tu konekciju više niko ne traži
+    const bool park = thread_affinity_ && set.generation == generation_;
+    // parked raste prije stanja (kradljivac ne spušta brojač ispod nule)
+    if (park) set.parked++;
+    uint8_t expected = SLOT_IN_USE;
+    if (!set.slots[slot].state.compare_exchange_strong(expected, park ? SLOT_PARKED : SLOT_FREE)) {
+        if (park) set.parked--;
+        return false;             // dvostruki povrat
+    }
+    if (park) tls_affinity = AffinitySlot{set.generation, slot, true};
+    else      pushFree(set, slot);
+    // Par sa waiters_++ u acquire() (oba seq_cst): ili čekač vidi slot, ili mi vidimo čekača
+    if (waiters_ > 0) {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        pool_cv_.notify_one();
+    }
+    return true;
+}
+
+void DatabasePool::recordWait(uint64_t us) {
+    waits_++;
+    total_wait_us_ += us;
+    uint64_t prev = max_wait_us_.load();
+    while (us > prev && !max_wait_us_.compare_exchange_weak(prev, us)) {}
+}
+
+DatabasePool::Lease DatabasePool::acquire() {
+    tracing::Span span("db.pool.acquire");
+    uint32_t slot = 0;
+    SlotSet* set  = pinCurrent();
+    if (set && tryAcquireSlot(*set, slot)) {
+        poolWaitHistogram().record(0);
+    } else {
+        // Spori put: pool prazan -> čekaj povrat (cv je samo za ovaj slučaj)
+        const auto t0 = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(pool_mutex_);
+        waiters_++;
+        while (!(set && tryAcquireSlot(*set, slot))) {
+            if (!initialized_) {
+                waiters_--;
+                if (set) unpinLocked(set);
+                return Lease();
+            }
+            pool_cv_.wait(lock);      // budi ga releaseSlot, initialize ili shutdown
+            if (set != current_.load()) {
+                // Re-init za vrijeme čekanja: čekaj na novom setu
+                if (set) unpinLocked(set);
+                set = pinCurrent();
+            }
         }
+        waiters_--;
+        poolWaitHistogram().record(metrics::ScopedTimer::elapsedNanos(t0));
+        recordWait(elapsedMicros(t0));
     }
-    return nullptr;
+    acquisitions_++;
+    return Lease(this, set, set->slots[slot].db, slot);   // pin prelazi na zakup
+}
+
+std::shared_ptr<Database> DatabasePool::getConnection() {
+    Lease lease = acquire();
+    if (!lease) return nullptr;
+    // Konekcija (i referenca na njen set) ostaje zauzeta do returnConnection()
+    auto db = std::move(lease.db_);
+    lease.pool_ = nullptr;
+    lease.set_  = nullptr;
+    return db;
 }
 
 void DatabasePool::returnConnection(std::shared_ptr<Database> db) {
-    std::lock_guard<std::mutex> lock(pool_mutex_);
-    for (size_t i = 0; i < connections_.size(); ++i) {
-        if (connections_[i] == db) {
-            available_[i] = true;
-            pool_cv_.notify_one();
-            break;
+    if (!db) return;
+    SlotSet* owner = nullptr;
+    uint32_t slot  = 0;
+    {
+        // Tekući ili povučeni set; konekcija drži referencu pa set ne nestaje ispod nas
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        auto owns = [&](SlotSet* set) {
+            auto it = set->slot_of.find(db.get());
+            if (it == set->slot_of.end()) return false;
+            owner = set;
+            slot  = it->second;
+            return true;
+        };
+        SlotSet* current = current_.load();
+        if (!current || !owns(current)) {
+            for (SlotSet* set : retired_) if (owns(set)) break;
         }
     }
+    if (owner && releaseSlot(*owner, slot)) unpin(owner);
+}
+
+DatabasePool::Stats DatabasePool::getStats() const {
+    Stats st;
+    st.acquisitions  = acquisitions_;
+    st.waits         = waits_;
+    st.total_wait_us = total_wait_us_;
+    st.max_wait_us   = max_wait_us_;
+    st.affinity_hits = affinity_hits_;
+    st.steals        = steals_;
+    st.size          = slot_count_;
+    return st;
 }
 
 void DatabasePool::shutdown() {
     std::lock_guard<std::mutex> lock(pool_mutex_);
-    connections_.clear();
-    available_.clear();
+    // Zakupi u toku drže povučeni set; oslobađa ga posljednji povrat
+    generation_++;
+    retireCurrent(nullptr);
     initialized_ = false;
+    pool_cv_.notify_all();
 }
 
 } // namespace transport
@@ -0,0 +1,75 @@
+#include "common/LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace transport {
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < kSubBuckets) return static_cast<size_t>(value);
+    int exp = 63 - __builtin_clzll(value);                 // >= kSubBucketBits
+    if (exp > kMaxExponent) return kBuckets - 1;
+    const uint64_t sub = value >> (exp - kSubBucketBits);  // [kSubBuckets, 2 * kSubBuckets)
+    return kSubBuckets * static_cast<size_t>(exp - kSubBucketBits + 1) + static_cast<size_t>(sub - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::upperBound(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    const int      exp = static_cast<int>(bucket / kSubBuckets) + kSubBucketBits - 1;
+    const uint64_t sub = bucket % kSubBuckets + kSubBuckets;
+    return ((sub + 1) << (exp - kSubBucketBits)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t cur = min_.load(std::memory_order_relaxed);
+    while (value < cur && !min_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+    cur = max_.load(std::memory_order_relaxed);
+    while (value > cur && !max_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot s;
+    s.counts.resize(kBuckets);
+    for (size_t i = 0; i < kBuckets; ++i) s.counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    s.count = count_.load(std::memory_order_relaxed);
+    s.sum   = sum_.load(std::memory_order_relaxed);
+    s.max   = max_.load(std::memory_order_relaxed);
+    s.min   = s.count ? min_.load(std::memory_order_relaxed) : 0;
+    return s;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    if (other.count == 0) return;
+    if (counts.empty()) counts.resize(kBuckets);
+    for (size_t i = 0; i < other.counts.size() && i < counts.size(); ++i) counts[i] += other.counts[i];
+    min   = count ? std::min(min, other.min) : other.min;
+    max   = std::max(max, other.max);
+    count += other.count;
+    sum   += other.sum;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const {
+    if (count == 0 || counts.empty()) return 0;
+    q = std::clamp(q, 0.0, 1.0);
+    // Rang prve vrijednosti koja pokriva q (q = 1 -> zadnja)
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(upperBound(i), max);
+    }
+    return max;
+}
+
+} // namespace transport
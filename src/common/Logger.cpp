@@ -1,46 +1,366 @@
 #include "common/Logger.h"
-#include <iostream>
-#include <iomanip>
-#include <sstream>
+#include "common/ClockService.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
 #include <ctime>
+#include <iostream>
 #include <map>
+#include <thread>
+#include <vector>
 
 namespace transport {
 
 std::map<std::string, std::shared_ptr<Logger>> Logger::loggers_;
 std::mutex Logger::loggers_mutex_;
 
-Logger::Logger(const std::string& name) 
-    : name_(name), log_level_(LogLevel::INFO) {}
+// Izlaz jednog Logger-a. Piše ga writer nit (ili sinhroni put), uvijek pod mutex-om,
+// pa zamjena fajla/rotacija ne treba ništa od pozivalaca.
+struct LogSink {
+    std::string name;
+    std::string path;
+    std::FILE*  file{nullptr};
+    uint64_t    size{0};
+    std::atomic<uint64_t> max_bytes{0};
+    std::atomic<int>      max_files{0};
+    std::mutex  mutex;
+
+    ~LogSink() { if (file) std::fclose(file); }
+};
+
+namespace {
+
+const char* levelToString(Logger::LogLevel level) {
+    switch (level) {
+        case Logger::LogLevel::DEBUG:    return "DEBUG";
+        case Logger::LogLevel::INFO:     return "INFO";
+        case Logger::LogLevel::WARNING:  return "WARN";
+        case Logger::LogLevel::ERROR:    return "ERROR";
+        case Logger::LogLevel::CRITICAL: return "CRIT";
+        default:                         return "UNKNOWN";
+    }
+}
+
+// "YYYY-mm-dd HH:MM:SS"; nit kopira zajednički bafer sata najviše jednom u sekundi
+const std::string& timestampFor(std::time_t sec) {
+    thread_local std::time_t cached_sec = -1;
+    thread_local std::string cached(ClockService::kTimestampLength, ' ');
+    if (sec != cached_sec) {
+        ClockService::formatTimestamp(sec, &cached[0]);
+        cached_sec = sec;
+    }
+    return cached;
+}
+
+void appendLine(std::string& out, std::time_t sec, Logger::LogLevel level,
+                const std::string& name, const std::string& message) {
+    out += '[';
+    out += timestampFor(sec);
+    out += "] [";
+    out += levelToString(level);
+    out += "] [";
+    out += name;
+    out += "] ";
+    out += message;
+    out += '\n';
+}
+
+// Poziva se pod sink->mutex
+void rotateLocked(LogSink& sink) {
+    const int keep = sink.max_files.load();
+    std::fclose(sink.file);
+    sink.file = nullptr;
+    if (keep > 0) {
+        std::remove((sink.path + "." + std::to_string(keep)).c_str());
+        for (int i = keep - 1; i >= 1; --i) {
+            std::rename((sink.path + "." + std::to_string(i)).c_str(),
+                        (sink.path + "." + std::to_string(i + 1)).c_str());
+        }
+        std::rename(sink.path.c_str(), (sink.path + ".1").c_str());
+    }
+    sink.file = std::fopen(sink.path.c_str(), keep > 0 ? "a" : "w");
+    sink.size = 0;
+}
+
+// Zapiši linije (pod sink.mutex); rotira prije linije koja bi prešla max_bytes
+void writeLocked(LogSink& sink, const std::string& lines) {
+    if (!sink.file || lines.empty()) return;
+    const uint64_t limit = sink.max_bytes.load();
+    size_t from = 0;
+    if (limit > 0) {
+        size_t pos = 0;
+        while (pos < lines.size()) {
+            size_t end = lines.find('\n', pos);
+            end = end == std::string::npos ? lines.size() : end + 1;
+            if (sink.size + (end - from) > limit && (sink.size > 0 || pos > from)) {
+                std::fwrite(lines.data() + from, 1, pos - from, sink.file);
+                sink.size += pos - from;
+                rotateLocked(sink);
+                if (!sink.file) return;
+                from = pos;
+            }
+            pos = end;
+        }
+    }
+    std::fwrite(lines.data() + from, 1, lines.size() - from, sink.file);
+    sink.size += lines.size() - from;
+    std::fflush(sink.file);
+}
+
+std::mutex        g_console_mutex;
+std::atomic<bool> g_console{true};
+
+void writeConsole(const std::string& text) {
+    if (text.empty() || !g_console.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lk(g_console_mutex);
+    std::fwrite(text.data(), 1, text.size(), stdout);
+    std::fflush(stdout);
+}
+
+struct LogRecord {
+    Logger::LogLevel         level{Logger::LogLevel::INFO};
+    std::time_t              sec{0};
+    std::shared_ptr<LogSink> sink;
+    std::string              message;
+};
+
+// Ograničen red sa brojačem sekvence po ćeliji (Vyukov): više proizvođača se
+// usklađuje jednim CAS-om na head_, jedini potrošač je writer nit.
+class AsyncBackend {
+public:
+    AsyncBackend(size_t capacity, Logger::OverflowPolicy policy) : policy_(policy) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        mask_  = n - 1;
+        cells_ = std::make_unique<Cell[]>(n);
+        for (size_t i = 0; i < n; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+        writer_ = std::thread(&AsyncBackend::writerLoop, this);
+    }
+
+    ~AsyncBackend() {
+        running_ = false;
+        wake_cv_.notify_one();
+        if (writer_.joinable()) writer_.join();
+    }
+
+    void setPolicy(Logger::OverflowPolicy policy) { policy_ = policy; }
+
+    void push(LogRecord&& rec) {
+        while (!tryPush(rec)) {
+            if (policy_.load() == Logger::OverflowPolicy::DROP) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            wake_cv_.notify_one();
+            std::this_thread::yield();
+        }
+        enqueued_.fetch_add(1, std::memory_order_release);
+        if (sleeping_.load(std::memory_order_acquire)) wake_cv_.notify_one();
+    }
+
+    void flush() {
+        const uint64_t target = enqueued_.load(std::memory_order_acquire);
+        wake_cv_.notify_one();
+        std::unique_lock<std::mutex> lk(flush_mutex_);
+        flush_cv_.wait(lk, [&] { return written_ >= target; });
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq{0};
+        LogRecord           rec;
+    };
+
+    bool tryPush(LogRecord& rec) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            const size_t seq = c.seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.rec = std::move(rec);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;                // pun
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(LogRecord& out) {
+        Cell& c = cells_[tail_ & mask_];
+        const size_t seq = c.seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(tail_ + 1) < 0) return false;
+        out = std::move(c.rec);
+        c.rec = LogRecord{};
+        c.seq.store(tail_ + mask_ + 1, std::memory_order_release);
+        ++tail_;
+        return true;
+    }
+
+    void writerLoop() {
+        constexpr size_t kBatch = 512;
+        std::vector<LogRecord> batch;
+        batch.reserve(kBatch);
+        // Linije po fajlu u tekućem batch-u (obično jedan ili dva sinka)
+        std::vector<std::pair<LogSink*, std::string>> files;
+        std::string console;
+        uint64_t reported_drops = 0;
+
+        for (;;) {
+            LogRecord rec;
+            while (batch.size() < kBatch && tryPop(rec)) batch.push_back(std::move(rec));
 
-Logger::~Logger() {
-    if (file_stream_) {
-        file_stream_->close();
+            if (batch.empty()) {
+                if (!running_) break;
+                // Proizvođači bude nit samo kad spava; timeout pokriva propušteno buđenje
+                std::unique_lock<std::mutex> lk(wake_mutex_);
+                sleeping_.store(true, std::memory_order_release);
+                wake_cv_.wait_for(lk, std::chrono::milliseconds(10));
+                sleeping_.store(false, std::memory_order_release);
+                continue;
+            }
+
+            console.clear();
+            files.clear();
+            for (auto& r : batch) {
+                LogSink* s = r.sink.get();
+                appendLine(console, r.sec, r.level, s->name, r.message);
+                if (s->path.empty()) continue;
+                auto it = std::find_if(files.begin(), files.end(),
+                                       [s](const auto& f) { return f.first == s; });
+                if (it == files.end()) it = files.insert(files.end(), {s, std::string()});
+                appendLine(it->second, r.sec, r.level, s->name, r.message);
+            }
+            const uint64_t drops = dropped();
+            if (drops != reported_drops) {
+                console += "[Logger] " + std::to_string(drops - reported_drops) +
+                           " messages dropped (log queue full)\n";
+                reported_drops = drops;
+            }
+            writeConsole(console);
+            for (auto& f : files) {
+                std::lock_guard<std::mutex> lk(f.first->mutex);
+                writeLocked(*f.first, f.second);
+            }
+
+            {
+                std::lock_guard<std::mutex> lk(flush_mutex_);
+                written_ += batch.size();
+            }
+            flush_cv_.notify_all();
+            batch.clear();    // tek sad: batch drži sinkove živim dok se pišu
+        }
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t                  mask_{0};
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) size_t              tail_{0};    // samo writer nit
+
+    std::atomic<Logger::OverflowPolicy> policy_;
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<bool>     running_{true};
+    std::atomic<bool>     sleeping_{false};
+
+    std::mutex              wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::mutex              flush_mutex_;
+    std::condition_variable flush_cv_;
+    uint64_t                written_{0};   // pod flush_mutex_
+
+    std::thread writer_;
+};
+
+std::mutex             g_async_mutex;
+Logger::AsyncOptions   g_async_options;
+std::atomic<bool>      g_async_enabled{true};
+std::atomic<bool>      g_backend_gone{false};
+
+struct BackendHolder {
+    std::unique_ptr<AsyncBackend> backend;
+    ~BackendHolder() {
+        g_backend_gone = true;     // poruke iz statičkih destruktora idu sinhrono
+        backend.reset();
     }
+};
+
+AsyncBackend* backend() {
+    static BackendHolder holder;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        std::lock_guard<std::mutex> lk(g_async_mutex);
+        holder.backend = std::make_unique<AsyncBackend>(g_async_options.queue_size, g_async_options.overflow);
+    });
+    return holder.backend.get();
 }
 
+void writeSync(const LogRecord& rec) {
+    std::string line;
+    appendLine(line, rec.sec, rec.level, rec.sink->name, rec.message);
+    writeConsole(line);
+    std::lock_guard<std::mutex> lk(rec.sink->mutex);
+    writeLocked(*rec.sink, line);
+}
+
+} // namespace
+
+std::string& log_detail::threadBuffer() {
+    thread_local std::string buf;
+    return buf;
+}
+
+Logger::Logger(const std::string& name)
+    : name_(name), log_level_(LogLevel::INFO), sink_(std::make_shared<LogSink>()) {
+    sink_->name = name_;
+}
+
+Logger::~Logger() = default;
+
 bool Logger::initialize(const std::string& log_file, LogLevel level) {
     log_level_ = level;
-    
+
     if (!log_file.empty()) {
         setLogFile(log_file);
     }
-    
+
     return true;
 }
 
 void Logger::setLogFile(const std::string& log_file) {
     std::lock_guard<std::mutex> lock(log_mutex_);
-    
-    if (file_stream_) {
-        file_stream_->close();
-    }
-    
-    file_stream_ = std::make_unique<std::ofstream>(log_file, std::ios::app);
-    if (!file_stream_->is_open()) {
+
+    auto current = std::atomic_load(&sink_);
+    auto sink = std::make_shared<LogSink>();
+    sink->name = name_;
+    sink->path = log_file;
+    sink->max_bytes.store(current->max_bytes.load());
+    sink->max_files.store(current->max_files.load());
+    sink->file = std::fopen(log_file.c_str(), "a");
+    if (!sink->file) {
         std::cerr << "Warning: Failed to open log file: " << log_file << std::endl;
-        file_stream_.reset();
+        sink->path.clear();
+    } else {
+        std::fseek(sink->file, 0, SEEK_END);
+        const long pos = std::ftell(sink->file);
+        sink->size = pos > 0 ? static_cast<uint64_t>(pos) : 0;
     }
+    // Poruke već u redu se još zapisuju u stari fajl (drže njegov sink)
+    std::atomic_store(&sink_, std::move(sink));
+}
+
+void Logger::setRotation(uint64_t max_bytes, int max_files) {
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    auto sink = std::atomic_load(&sink_);
+    sink->max_bytes.store(max_bytes);
+    sink->max_files.store(std::max(0, max_files));
 }
 
 void Logger::debug(const std::string& message) {
@@ -64,66 +384,57 @@ void Logger::critical(const std::string& message) {
 }
 
 void Logger::log(LogLevel level, const std::string& message) {
-    if (level < log_level_) {
+    if (level < log_level_.load(std::memory_order_relaxed)) {
         return;
     }
-    
-    std::lock_guard<std::mutex> lock(log_mutex_);
-    
-    std::string formatted_message = formatMessage(level, message);
-    
-    // Always output to console for now
-    std::cout << formatted_message << std::endl;
-    
-    // Output to file if available
-    if (file_stream_ && file_stream_->is_open()) {
-        *file_stream_ << formatted_message << std::endl;
-        file_stream_->flush();
-    }
-}
-
-std::string Logger::formatMessage(LogLevel level, const std::string& message) {
-    std::ostringstream oss;
-    
-    oss << "[" << getCurrentTimestamp() << "] ";
-    oss << "[" << levelToString(level) << "] ";
-    oss << "[" << name_ << "] ";
-    oss << message;
-    
-    return oss.str();
-}
-
-std::string Logger::getCurrentTimestamp() {
-    auto now = std::time(nullptr);
-    auto tm = *std::localtime(&now);
-    
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
-}
-
-std::string Logger::levelToString(LogLevel level) {
-    switch (level) {
-        case LogLevel::DEBUG:    return "DEBUG";
-        case LogLevel::INFO:     return "INFO";
-        case LogLevel::WARNING:  return "WARN";
-        case LogLevel::ERROR:    return "ERROR";
-        case LogLevel::CRITICAL: return "CRIT";
-        default:                 return "UNKNOWN";
+
+    LogRecord rec;
+    rec.level   = level;
+    rec.sec     = std::time(nullptr);
+    rec.sink    = std::atomic_load(&sink_);
+    rec.message = message;
+
+    if (g_async_enabled.load(std::memory_order_relaxed) && !g_backend_gone.load()) {
+        backend()->push(std::move(rec));
+    } else {
+        writeSync(rec);
     }
 }
 
 std::shared_ptr<Logger> Logger::getLogger(const std::string& name) {
     std::lock_guard<std::mutex> lock(loggers_mutex_);
-    
+
     auto it = loggers_.find(name);
     if (it != loggers_.end()) {
         return it->second;
     }
-    
+
     auto logger = std::shared_ptr<Logger>(new Logger(name));
     loggers_[name] = logger;
     return logger;
 }
 
+void Logger::configureAsync(const AsyncOptions& options) {
+    {
+        std::lock_guard<std::mutex> lk(g_async_mutex);
+        g_async_options = options;
+    }
+    // Isključivanje: prvo isprazni red, da sinhrone poruke ne preteknu starije
+    if (!options.enabled) flush();
+    g_async_enabled = options.enabled;
+    if (!g_backend_gone.load()) backend()->setPolicy(options.overflow);
+}
+
+void Logger::setConsoleOutput(bool on) {
+    g_console = on;
+}
+
+void Logger::flush() {
+    if (!g_backend_gone.load()) backend()->flush();
+}
+
+uint64_t Logger::droppedMessages() {
+    return g_backend_gone.load() ? 0 : backend()->dropped();
+}
+
 } // namespace transport
@@ -0,0 +1,157 @@
+#include "common/McastDatagram.h"
+
+#include <openssl/evp.h>
+
+namespace transport {
+namespace mcast {
+
+namespace {
+
+inline void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int s = 24; s >= 0; s -= 8) out.push_back(static_cast<uint8_t>(v >> s));
+}
+inline void putU64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int s = 56; s >= 0; s -= 8) out.push_back(static_cast<uint8_t>(v >> s));
+}
+inline uint64_t getBE(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+struct MdCtxDeleter {
+    void operator()(EVP_MD_CTX* ctx) const { EVP_MD_CTX_free(ctx); }
+};
+using MdCtx = std::unique_ptr<EVP_MD_CTX, MdCtxDeleter>;
+
+} // namespace
+
+Signer::Signer() = default;
+
+Signer::~Signer() { EVP_PKEY_free(pkey_); }
+
+bool Signer::init(const std::string& seed) {
+    EVP_PKEY_free(pkey_);
+    pkey_ = nullptr;
+    public_key_.clear();
+    if (!seed.empty()) {
+        if (seed.size() != kKeyLength) return false;
+        pkey_ = EVP_PKEY_new_raw_private_key(EVP_PKEY_ED25519, nullptr,
+                                             reinterpret_cast<const unsigned char*>(seed.data()), seed.size());
+    } else if (EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, nullptr)) {
+        if (EVP_PKEY_keygen_init(ctx) != 1 || EVP_PKEY_keygen(ctx, &pkey_) != 1) pkey_ = nullptr;
+        EVP_PKEY_CTX_free(ctx);
+    }
+    if (!pkey_) return false;
+
+    size_t len = kKeyLength;
+    public_key_.resize(kKeyLength);
+    if (EVP_PKEY_get_raw_public_key(pkey_, reinterpret_cast<unsigned char*>(&public_key_[0]), &len) != 1 ||
+        len != kKeyLength) {
+        EVP_PKEY_free(pkey_);
+        pkey_ = nullptr;
+        public_key_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Signer::sign(const uint8_t* data, size_t len, uint8_t out[kSignatureLength]) const {
+    if (!pkey_) return false;
+    MdCtx ctx(EVP_MD_CTX_new());
+    size_t sig_len = kSignatureLength;
+    return ctx && EVP_DigestSignInit(ctx.get(), nullptr, nullptr, nullptr, pkey_) == 1 &&
+           EVP_DigestSign(ctx.get(), out, &sig_len, data, len) == 1 && sig_len == kSignatureLength;
+}
+
+bool encodeDatagram(uint64_t seq, const uint8_t* frame, size_t frame_len,
+                    const Signer& signer, std::vector<uint8_t>& out) {
+    if (!signer.ready() || kHeaderLength + frame_len + kSignatureLength > kMaxDatagram) return false;
+    out.clear();
+    out.reserve(kHeaderLength + frame_len + kSignatureLength);
+    putU32(out, kDatagramMagic);
+    putU64(out, seq);
+    out.insert(out.end(), frame, frame + frame_len);
+
+    uint8_t sig[kSignatureLength];
+    if (!signer.sign(out.data(), out.size(), sig)) return false;
+    out.insert(out.end(), sig, sig + kSignatureLength);
+    return true;
+}
+
+bool looksLikeDatagram(const uint8_t* data, size_t len) {
+    return len >= kHeaderLength + kSignatureLength && getBE(data, 4) == kDatagramMagic;
+}
+
+bool decodeDatagram(const uint8_t* data, size_t len, const std::string& public_key,
+                    uint64_t& seq, const uint8_t*& frame, size_t& frame_len) {
+    if (public_key.size() != kKeyLength || !looksLikeDatagram(data, len)) return false;
+    const size_t signed_len = len - kSignatureLength;
+
+    EVP_PKEY* pkey = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, nullptr,
+                                                 reinterpret_cast<const unsigned char*>(public_key.data()),
+                                                 public_key.size());
+    if (!pkey) return false;
+    MdCtx ctx(EVP_MD_CTX_new());
+    const bool valid = ctx && EVP_DigestVerifyInit(ctx.get(), nullptr, nullptr, nullptr, pkey) == 1 &&
+                       EVP_DigestVerify(ctx.get(), data + signed_len, kSignatureLength, data, signed_len) == 1;
+    EVP_PKEY_free(pkey);
+    if (!valid) return false;
+
+    seq       = getBE(data + 4, 8);
+    frame     = data + kHeaderLength;
+    frame_len = signed_len - kHeaderLength;
+    return true;
+}
+
+std::string toHex(const std::string& bytes) {
+    static const char* kHex = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        out.push_back(kHex[c >> 4]);
+        out.push_back(kHex[c & 0x0F]);
+    }
+    return out;
+}
+
+bool fromHex(const std::string& hex, std::string& bytes) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    if (hex.size() % 2 != 0) return false;
+    std::string out;
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        const int hi = nibble(hex[i]), lo = nibble(hex[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out.push_back(static_cast<char>((hi << 4) | lo));
+    }
+    bytes.swap(out);
+    return true;
+}
+
+SequenceTracker::Result SequenceTracker::onSequence(uint64_t seq) {
+    Result r;
+    if (!started_) {
+        started_ = true;
+        last_    = seq;
+        r.accept = true;
+        return r;
+    }
+    if (seq <= last_) return r;               // duplikat ili zakašnjeli paket
+    if (seq > last_ + 1) {
+        r.gap      = true;
+        r.gap_from = last_ + 1;
+        r.gap_to   = seq - 1;
+    }
+    last_    = seq;
+    r.accept = true;
+    return r;
+}
+
+} // namespace mcast
+} // namespace transport
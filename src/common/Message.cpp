@@ -1,13 +1,164 @@
 #include "common/Message.h"
+#include "common/Crc32.h"
+#include "common/VehicleStatus.h"
+#include "common/Database.h"
+#include "common/Replication.h"
+#include "common/PriceCache.h"
+#include "common/Telemetry.h"
 
 #include <sstream>
 #include <iostream>
 #include <cstring>
 #include <ctime>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+#include <charconv>
+#include <numeric>
+#include <stdexcept>
 #include <arpa/inet.h>
 
 namespace transport {
 
+namespace {
+
+// =========================
+// V2 enkodiranje: interni ID-jevi polja i varint helperi
+// =========================
+
+// Tabela se samo proširuje na kraju — ID je pozicija u nizu i ide na žicu.
+// Polja van tabele šalju se sa ID 0 i eksplicitnim ključem.
+const char* const kFieldNames[] = {
+    "",                 // 0: eksplicitni ključ
+    "message",          // 1
+    "error",
+    "error_code",
+    "success",
+    "reason",
+    "token",
+    "session_id",
+    "client_id",
+    "protocol_version",
+    "urn",              // 10
+    "pin",
+    "pin_hash",
+    "uri",
+    "vehicle_type",
+    "ticket_type",
+    "route",
+    "passengers",
+    "price",
+    "total_amount",
+    "capacity",         // 20
+    "available_seats",
+    "active",
+    "group_name",
+    "leader_urn",
+    "user_urn",
+    "vehicle_uri",
+    "update_type",
+    "timestamp",
+    "name",
+    "age",              // 30
+    "items",
+};
+constexpr uint32_t kFieldCount = sizeof(kFieldNames) / sizeof(kFieldNames[0]);
+
+uint32_t fieldId(std::string_view key) {
+    static const std::map<std::string_view, uint32_t> ids = []{
+        std::map<std::string_view, uint32_t> m;
+        for (uint32_t i = 1; i < kFieldCount; ++i) m.emplace(kFieldNames[i], i);
+        return m;
+    }();
+    auto it = ids.find(key);
+    return it != ids.end() ? it->second : 0;
+}
+
+size_t varintSize(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; ++n; }
+    return n;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool getVarint(const uint8_t* p, size_t len, size_t& pos, uint64_t& out) {
+    out = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= len) return false;
+        const uint8_t b = p[pos++];
+        out |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v)    { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t  unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+void putDouble(std::vector<uint8_t>& out, double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    for (int shift = 56; shift >= 0; shift -= 8) out.push_back(static_cast<uint8_t>(bits >> shift));
+}
+
+double getDoubleBE(const uint8_t* p) {
+    uint64_t bits = 0;
+    for (int k = 0; k < 8; ++k) bits = (bits << 8) | p[k];
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// V1 tekstualni oblik binarnog polja: "1,2,250"
+std::string binaryToText(std::string_view raw) {
+    std::string encoded;
+    encoded.reserve(raw.size() * 4);
+    for (unsigned char byte : raw) {
+        encoded += std::to_string(byte);
+        encoded += ",";
+    }
+    if (!encoded.empty()) encoded.pop_back();
+    return encoded;
+}
+
+size_t binaryTextSize(std::string_view raw) {
+    size_t n = raw.empty() ? 0 : raw.size() - 1; // zarezi
+    for (unsigned char byte : raw) n += byte >= 100 ? 3 : byte >= 10 ? 2 : 1;
+    return n;
+}
+
+std::vector<uint8_t> textToBinary(std::string_view text) {
+    std::vector<uint8_t> result;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view token = text.substr(0, comma);
+        int value = 0;
+        if (!token.empty() && std::from_chars(token.data(), token.data() + token.size(), value).ec == std::errc{})
+            result.push_back(static_cast<uint8_t>(value));
+        if (comma == std::string_view::npos) break;
+        text.remove_prefix(comma + 1);
+    }
+    return result;
+}
+
+} // namespace
+
+uint16_t parseProtocolVersion(std::string_view text) {
+    int major = 0;
+    std::from_chars(text.data(), text.data() + text.size(), major);
+    if (major < PROTOCOL_V1) return PROTOCOL_V1;
+    if (major > PROTOCOL_MAX_VERSION) return PROTOCOL_MAX_VERSION;
+    return static_cast<uint16_t>(major);
+}
+
 // =========================
 // Message implementacija
 // =========================
@@ -23,131 +174,343 @@ Message::Message(MessageType type) {
 
 Message::~Message() = default;
 
+namespace {
+
+// Slobodni blokovi veličine Message po niti; ograničeno, višak ide u free()
+thread_local bool tls_free_list_gone = false;   // trivijalan: čitljiv i nakon gašenja liste
+
+struct MessageFreeList {
+    static constexpr size_t kMaxBlocks = 256;
+    void*  head  = nullptr;
+    size_t count = 0;
+
+    ~MessageFreeList() {
+        // Poruke koje se uništavaju kasnije u gašenju niti idu direktno u free()
+        tls_free_list_gone = true;
+        while (head) {
+            void* next = *static_cast<void**>(head);
+            ::operator delete(head);
+            head = next;
+        }
+    }
+};
+
+MessageFreeList& messageFreeList() {
+    thread_local MessageFreeList list;
+    return list;
+}
+
+} // namespace
+
+void* Message::operator new(size_t size) {
+    if (tls_free_list_gone) return ::operator new(size);
+    auto& list = messageFreeList();
+    if (size == sizeof(Message) && list.head) {
+        void* block = list.head;
+        list.head   = *static_cast<void**>(block);
+        --list.count;
+        return block;
+    }
+    return ::operator new(size);
+}
+
+void Message::operator delete(void* ptr, size_t size) noexcept {
+    if (!ptr) return;
+    if (tls_free_list_gone) return ::operator delete(ptr);
+    auto& list = messageFreeList();
+    if (size == sizeof(Message) && list.count < MessageFreeList::kMaxBlocks) {
+        *static_cast<void**>(ptr) = list.head;
+        list.head = ptr;
+        ++list.count;
+        return;
+    }
+    ::operator delete(ptr);
+}
+
+namespace {
+
+size_t fieldSizeV1(std::string_view key, const std::string& value, FieldType type) {
+    const size_t text = type == FieldType::BINARY ? binaryTextSize(value) : value.size();
+    return 2 * sizeof(uint32_t) + key.size() + text;
+}
+
+size_t fieldSizeV2(std::string_view key, const std::string& value, FieldType type, int64_t i) {
+    const uint32_t id = fieldId(key);
+    size_t n = varintSize((static_cast<uint64_t>(id) << 3) | static_cast<uint8_t>(type));
+    if (id == 0) n += varintSize(key.size()) + key.size();
+    switch (type) {
+        case FieldType::INT:    n += varintSize(zigzag(i)); break;
+        case FieldType::DOUBLE: n += 8; break;
+        case FieldType::BOOL:   n += 1; break;
+        default:                n += varintSize(value.size()) + value.size(); break;
+    }
+    return n;
+}
+
+} // namespace
+
+const Message::Field* Message::findField(std::string_view key) const {
+    auto it = std::lower_bound(data_.begin(), data_.end(), key,
+                               [](const Entry& e, std::string_view k) { return std::string_view(e.key) < k; });
+    return it != data_.end() && it->key == key ? &it->field : nullptr;
+}
+
+void Message::setField(std::string_view key, Field field) {
+    // Obje dužine se vode bez ponovnog enkodiranja cijelog payload-a
+    auto it = std::lower_bound(data_.begin(), data_.end(), key,
+                               [](const Entry& e, std::string_view k) { return std::string_view(e.key) < k; });
+    const bool exists = it != data_.end() && it->key == key;
+    if (exists) {
+        const Field& old = it->field;
+        length_v1_ -= static_cast<uint32_t>(fieldSizeV1(key, old.value, old.type));
+        length_v2_ -= static_cast<uint32_t>(fieldSizeV2(key, old.value, old.type, old.i));
+    }
+    length_v1_ += static_cast<uint32_t>(fieldSizeV1(key, field.value, field.type));
+    length_v2_ += static_cast<uint32_t>(fieldSizeV2(key, field.value, field.type, field.i));
+
+    if (exists) it->field = std::move(field);
+    else        data_.emplace(it, Entry{std::string(key), std::move(field)});
+
+    header_.length = payloadLength(header_.version);
+}
+
+void Message::setVersion(uint16_t version) {
+    header_.version = version == PROTOCOL_V2 ? PROTOCOL_V2 : PROTOCOL_V1;
+    header_.length  = payloadLength(header_.version);
+}
+
 void Message::addString(const std::string& key, const std::string& value) {
-    data_[key] = value;
-    header_.length = static_cast<uint32_t>(encodeData().size());
+    setField(key, Field{value, FieldType::STRING});
 }
 
 void Message::addInt(const std::string& key, int32_t value) {
-    data_[key] = std::to_string(value);
-    header_.length = static_cast<uint32_t>(encodeData().size());
+    setField(key, Field{std::to_string(value), FieldType::INT, value});
 }
 
 void Message::addDouble(const std::string& key, double value) {
-    data_[key] = std::to_string(value);
-    header_.length = static_cast<uint32_t>(encodeData().size());
+    setField(key, Field{std::to_string(value), FieldType::DOUBLE, 0, value});
 }
 
 void Message::addBool(const std::string& key, bool value) {
-    data_[key] = value ? "true" : "false";
-    header_.length = static_cast<uint32_t>(encodeData().size());
+    setField(key, Field{value ? "true" : "false", FieldType::BOOL, value ? 1 : 0});
 }
 
 void Message::addBinary(const std::string& key, const std::vector<uint8_t>& binary_data) {
-    std::string encoded;
-    encoded.reserve(binary_data.size() * 3);
-    for (uint8_t byte : binary_data) {
-        encoded += std::to_string(byte);
-        encoded += ",";
-    }
-    if (!encoded.empty()) encoded.pop_back();
-    data_[key] = std::move(encoded);
-    header_.length = static_cast<uint32_t>(encodeData().size());
+    // Sirovi bajtovi; V1 ih pri serijalizaciji pretvara u "b,b,b" tekst
+    setField(key, Field{std::string(binary_data.begin(), binary_data.end()), FieldType::BINARY});
+}
+
+void Message::addStrings(const std::map<std::string, std::string>& fields) {
+    for (const auto& pair : fields) addString(pair.first, pair.second);
 }
 
 std::string Message::getString(const std::string& key) const {
-    auto it = data_.find(key);
-    return it != data_.end() ? it->second : "";
+    const Field* f = findField(key);
+    if (!f) return "";
+    return f->type == FieldType::BINARY ? binaryToText(f->value) : f->value;
 }
 
 int32_t Message::getInt(const std::string& key) const {
-    auto it = data_.find(key);
-    return it != data_.end() ? std::stoi(it->second) : 0;
+    const Field* f = findField(key);
+    if (!f) return 0;
+    switch (f->type) {
+        case FieldType::INT:
+        case FieldType::BOOL:   return static_cast<int32_t>(f->i);
+        case FieldType::DOUBLE: return static_cast<int32_t>(f->d);
+        default:                return std::stoi(f->value);
+    }
 }
 
 double Message::getDouble(const std::string& key) const {
-    auto it = data_.find(key);
-    return it != data_.end() ? std::stod(it->second) : 0.0;
+    const Field* f = findField(key);
+    if (!f) return 0.0;
+    switch (f->type) {
+        case FieldType::DOUBLE: return f->d;
+        case FieldType::INT:    return static_cast<double>(f->i);
+        default:                return std::stod(f->value);
+    }
 }
 
 bool Message::getBool(const std::string& key) const {
-    auto it = data_.find(key);
-    return it != data_.end() && it->second == "true";
+    const Field* f = findField(key);
+    return f && f->value == "true";
 }
 
 std::vector<uint8_t> Message::getBinary(const std::string& key) const {
-    std::vector<uint8_t> result;
-    auto it = data_.find(key);
-    if (it != data_.end()) {
-        std::stringstream ss(it->second);
-        std::string token;
-        while (std::getline(ss, token, ',')) {
-            if (!token.empty())
-                result.push_back(static_cast<uint8_t>(std::stoi(token)));
-        }
-    }
-    return result;
+    const Field* f = findField(key);
+    if (!f) return {};
+    if (f->type == FieldType::BINARY) return std::vector<uint8_t>(f->value.begin(), f->value.end());
+    return textToBinary(f->value);
 }
 
 bool Message::hasKey(const std::string& key) const {
-    return data_.find(key) != data_.end();
+    return findField(key) != nullptr;
 }
 
 std::vector<uint8_t> Message::serialize() const {
     std::vector<uint8_t> result;
-    
+    serializeTo(result);
+    return result;
+}
+
+void Message::encodeHeader(std::vector<uint8_t>& out, uint16_t version, uint32_t checksum) const {
     // Header → mrežni redoslijed
     Header net_header = header_;
     net_header.magic       = htonl(net_header.magic);
-    net_header.version     = htons(net_header.version);
+    net_header.version     = htons(version);
     net_header.type        = static_cast<MessageType>(htons(static_cast<uint16_t>(net_header.type)));
-    net_header.length      = htonl(net_header.length);
+    net_header.length      = htonl(payloadLength(version));
     net_header.sequence_id = htonl(net_header.sequence_id);
     net_header.session_id  = htonl(net_header.session_id);
-    net_header.checksum    = htonl(net_header.checksum);
-    
+    net_header.checksum    = htonl(checksum);
+
     const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&net_header);
-    result.insert(result.end(), header_bytes, header_bytes + sizeof(Header));
-    
-    // Podaci
-    std::vector<uint8_t> data_bytes = encodeData();
-    result.insert(result.end(), data_bytes.begin(), data_bytes.end());
-    
-    return result;
+    out.insert(out.end(), header_bytes, header_bytes + sizeof(Header));
+}
+
+void Message::encodePayload(std::vector<uint8_t>& out, uint16_t version) const {
+    for (const auto& entry : data_) encodeEntry(out, version, entry);
+}
+
+void Message::encodeEntry(std::vector<uint8_t>& out, uint16_t version, const Entry& entry) {
+    if (version != PROTOCOL_V2) {
+        // V1: [key_len][key][val_len][val], dužine u mrežnom redoslijedu
+        const std::string text = entry.field.type == FieldType::BINARY ? binaryToText(entry.field.value)
+                                                                       : std::string();
+        const std::string& value = entry.field.type == FieldType::BINARY ? text : entry.field.value;
+
+        uint32_t key_len = htonl(static_cast<uint32_t>(entry.key.length()));
+        uint32_t val_len = htonl(static_cast<uint32_t>(value.length()));
+
+        const uint8_t* key_len_bytes = reinterpret_cast<const uint8_t*>(&key_len);
+        const uint8_t* val_len_bytes = reinterpret_cast<const uint8_t*>(&val_len);
+
+        out.insert(out.end(), key_len_bytes, key_len_bytes + sizeof(uint32_t));
+        out.insert(out.end(), entry.key.begin(), entry.key.end());
+        out.insert(out.end(), val_len_bytes, val_len_bytes + sizeof(uint32_t));
+        out.insert(out.end(), value.begin(), value.end());
+        return;
+    }
+
+    // V2: varint tag (id << 3 | tip), [ključ ako id==0], vrijednost po tipu
+    const Field&   f  = entry.field;
+    const uint32_t id = fieldId(entry.key);
+    putVarint(out, (static_cast<uint64_t>(id) << 3) | static_cast<uint8_t>(f.type));
+    if (id == 0) {
+        putVarint(out, entry.key.size());
+        out.insert(out.end(), entry.key.begin(), entry.key.end());
+    }
+    switch (f.type) {
+        case FieldType::INT:    putVarint(out, zigzag(f.i)); break;
+        case FieldType::DOUBLE: putDouble(out, f.d); break;
+        case FieldType::BOOL:   out.push_back(f.i ? 1 : 0); break;
+        default:
+            putVarint(out, f.value.size());
+            out.insert(out.end(), f.value.begin(), f.value.end());
+            break;
+    }
+}
+
+void Message::serializeTo(std::vector<uint8_t>& out) const {
+    serializeTo(out, header_.version);
+}
+
+void Message::serializeTo(std::vector<uint8_t>& out, uint16_t version) const {
+    const size_t start = out.size();
+    out.reserve(start + sizeof(Header) + payloadLength(version));
+
+    // Checksum pokriva okvir u verziji u kojoj se šalje; druga verzija -> računa se ovdje
+    const bool own_version = (version == header_.version);
+    const bool compute_crc = checksum_pending_ || !own_version;
+
+    // checksum se računa nad cijelim frameom sa checksum=0
+    encodeHeader(out, version, compute_crc ? 0 : header_.checksum);
+    encodePayload(out, version);
+
+    if (compute_crc) {
+        // Isti prolaz: CRC nad upravo upisanim bajtovima, pa zakrpi polje u header-u.
+        // Poruka se ne dira (const, može se serijalizovati iz više niti); pamti ga finalize()
+        const uint32_t crc = calculateCRC32(out.data() + start, out.size() - start);
+        const uint32_t net_crc = htonl(crc);
+        std::memcpy(out.data() + start + offsetof(Header, checksum), &net_crc, sizeof(uint32_t));
+    }
+}
+
+uint32_t Message::frameChecksum(uint16_t version) const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(sizeof(Header) + payloadLength(version));
+    encodeHeader(bytes, version, 0);
+    encodePayload(bytes, version);
+    return calculateCRC32(bytes);
+}
+
+void Message::finalize() {
+    if (!checksum_pending_) return;
+    header_.checksum  = frameChecksum(header_.version);
+    checksum_pending_ = false;
 }
 
 bool Message::deserialize(const std::vector<uint8_t>& data) {
-    if (data.size() < sizeof(Header)) return false;
-    
-    // Header ← host redoslijed
-    std::memcpy(&header_, data.data(), sizeof(Header));
-    header_.magic       = ntohl(header_.magic);
-    header_.version     = ntohs(header_.version);
-    header_.type        = static_cast<MessageType>(ntohs(static_cast<uint16_t>(header_.type)));
-    header_.length      = ntohl(header_.length);
-    header_.sequence_id = ntohl(header_.sequence_id);
-    header_.session_id  = ntohl(header_.session_id);
-    header_.checksum    = ntohl(header_.checksum);
-    
-    if (header_.magic != 0x54504D50) return false;
-    
-    if (data.size() >= sizeof(Header) + header_.length) {
-        std::vector<uint8_t> data_bytes(data.begin() + sizeof(Header),
-                                        data.begin() + sizeof(Header) + header_.length);
-        return decodeData(data_bytes);
+    return deserialize(data.data(), data.size());
+}
+
+bool Message::deserialize(const uint8_t* data, size_t size) {
+    // Jedan parser za oba puta: view nad baferom, pa polja direktno u mapu
+    MessageView view;
+    if (!view.parse(data, size)) {
+        data_.clear();
+        length_v1_ = length_v2_ = 0;
+        if (size >= sizeof(Header)) header_ = decodeHeader(data);
+        checksum_pending_ = false;
+        return false;
     }
-    return false;
+    assignFromView(view);
+    return true;
+}
+
+void Message::assignFromView(const MessageView& view) {
+    data_.clear();
+    length_v1_ = length_v2_ = 0;
+    header_ = view.header_;
+    checksum_pending_ = false;
+
+    for (const auto& f : view.fields_) {
+        Field field;
+        field.type = f.type;
+        field.i    = f.i;
+        field.d    = f.d;
+        switch (f.type) {
+            case FieldType::INT:    field.value = std::to_string(static_cast<int32_t>(f.i)); break;
+            case FieldType::DOUBLE: field.value = std::to_string(f.d); break;
+            case FieldType::BOOL:   field.value = f.i ? "true" : "false"; break;
+            default:                field.value.assign(f.value.data(), f.value.size()); break;
+        }
+        setField(f.key, std::move(field));
+    }
+    // Dužina sa žice (setField je postavio izračunatu; za validan okvir su iste)
+    header_.length = view.header_.length;
+}
+
+Message::Header Message::decodeHeader(const uint8_t* bytes) {
+    Header hdr{};
+    std::memcpy(&hdr, bytes, sizeof(Header));
+    hdr.magic       = ntohl(hdr.magic);
+    hdr.version     = ntohs(hdr.version);
+    hdr.type        = static_cast<MessageType>(ntohs(static_cast<uint16_t>(hdr.type)));
+    hdr.length      = ntohl(hdr.length);
+    hdr.sequence_id = ntohl(hdr.sequence_id);
+    hdr.session_id  = ntohl(hdr.session_id);
+    hdr.checksum    = ntohl(hdr.checksum);
+    return hdr;
 }
 
 std::vector<uint8_t> Message::serializeStream() const {
-    std::vector<uint8_t> serialized = serialize();
-    std::vector<uint8_t> result;
-    
-    uint32_t total_length = htonl(static_cast<uint32_t>(serialized.size()));
-    const uint8_t* length_bytes = reinterpret_cast<const uint8_t*>(&total_length);
-    result.insert(result.end(), length_bytes, length_bytes + sizeof(uint32_t));
-    result.insert(result.end(), serialized.begin(), serialized.end());
-    
+    // [u32 dužina][okvir] u jednom baferu; dužina se upisuje nakon serijalizacije
+    std::vector<uint8_t> result(sizeof(uint32_t));
+    serializeTo(result);
+
+    uint32_t total_length = htonl(static_cast<uint32_t>(result.size() - sizeof(uint32_t)));
+    std::memcpy(result.data(), &total_length, sizeof(uint32_t));
     return result;
 }
 
@@ -160,39 +523,35 @@ bool Message::deserializeStream(const std::vector<uint8_t>& data) {
     
     if (data.size() < sizeof(uint32_t) + length) return false;
     
-    std::vector<uint8_t> message_data(data.begin() + sizeof(uint32_t),
-                                      data.begin() + sizeof(uint32_t) + length);
-    return deserialize(message_data);
+    return deserialize(data.data() + sizeof(uint32_t), length);
 }
 
 void Message::calculateChecksum() {
-    // checksum se računa nad cijelim frameom sa checksum=0
-    header_.checksum = 0;
-    std::vector<uint8_t> bytes = serialize();
-    header_.checksum = calculateCRC32(bytes);
+    // Odgođeno: serializeTo računa CRC u istom prolazu u kojem piše okvir
+    checksum_pending_ = true;
 }
 
 bool Message::verifyChecksum() const {
-    // privremeno poništi checksum pri računanju
-    uint32_t original_checksum = header_.checksum;
-    const_cast<Message*>(this)->header_.checksum = 0;
-    std::vector<uint8_t> bytes = serialize();
-    uint32_t computed = calculateCRC32(bytes);
-    const_cast<Message*>(this)->header_.checksum = original_checksum;
-    return original_checksum == computed;
+    // Odgođen checksum se tek računa nad trenutnim sadržajem, pa je po definiciji ispravan
+    if (checksum_pending_) return true;
+
+    // checksum se provjerava nad cijelim frameom sa checksum=0
+    return header_.checksum == frameChecksum(header_.version);
 }
 
 bool Message::isValid() const {
     return header_.magic == 0x54504D50 &&
-           header_.version == 1 &&
+           (header_.version == PROTOCOL_V1 || header_.version == PROTOCOL_V2) &&
            verifyChecksum();
 }
 
 void Message::clear() {
     header_ = {};
     header_.magic = 0x54504D50;
-    header_.version = 1;
+    header_.version = PROTOCOL_V1;
     data_.clear();
+    length_v1_ = length_v2_ = 0;
+    checksum_pending_ = false;
 }
 
 size_t Message::size() const {
@@ -201,88 +560,420 @@ size_t Message::size() const {
 
 void Message::print() const {
     std::cout << "Message Type: " << static_cast<int>(header_.type) << "\n"
+              << "Version    : " << header_.version << "\n"
               << "Sequence ID: " << header_.sequence_id << "\n"
               << "Session ID : " << header_.session_id << "\n"
               << "Length     : " << header_.length << "\n"
               << "Data:\n";
-    for (const auto& pair : data_) {
-        std::cout << "  " << pair.first << ": " << pair.second << "\n";
+    for (const auto& entry : data_) {
+        std::cout << "  " << entry.key << ": " << getString(entry.key) << "\n";
     }
 }
 
-uint32_t Message::calculateCRC32(const std::vector<uint8_t>& data) const {
-    uint32_t crc = 0xFFFFFFFFu;
-    for (uint8_t byte : data) {
-        crc ^= byte;
-        for (int i = 0; i < 8; i++) {
-            crc = (crc >> 1) ^ (0xEDB88320u & (-(static_cast<int32_t>(crc) & 1)));
-        }
+uint32_t Message::calculateCRC32(const uint8_t* data, size_t size) const {
+    return Crc32::compute(data, size);
+}
+
+// =========================
+// MessageView implementacija
+// =========================
+
+void MessageView::clear() {
+    header_ = {};
+    fields_.clear(); // kapacitet ostaje za sljedeći okvir
+}
+
+bool MessageView::parse(const uint8_t* data, size_t size) {
+    clear();
+    if (size < sizeof(Message::Header)) return false;
+
+    header_ = Message::decodeHeader(data);
+    if (header_.magic != 0x54504D50) return false;
+    if (size < sizeof(Message::Header) + header_.length) return false;
+
+    const uint8_t* p = data + sizeof(Message::Header);
+    const bool ok = header_.version == PROTOCOL_V2 ? parseV2(p, header_.length)
+                                                   : parseV1(p, header_.length);
+    if (!ok) {
+        fields_.clear();
+        return false;
     }
-    return ~crc;
+    return true;
 }
 
-std::vector<uint8_t> Message::encodeData() const {
-    std::vector<uint8_t> result;
-    result.reserve(data_.size() * 12); // gruba procjena
-    for (const auto& pair : data_) {
-        uint32_t key_len = htonl(static_cast<uint32_t>(pair.first.length()));
-        uint32_t val_len = htonl(static_cast<uint32_t>(pair.second.length()));
-        
-        const uint8_t* key_len_bytes = reinterpret_cast<const uint8_t*>(&key_len);
-        const uint8_t* val_len_bytes = reinterpret_cast<const uint8_t*>(&val_len);
-        
-        result.insert(result.end(), key_len_bytes, key_len_bytes + sizeof(uint32_t));
-        result.insert(result.end(), pair.first.begin(), pair.first.end());
-        result.insert(result.end(), val_len_bytes, val_len_bytes + sizeof(uint32_t));
-        result.insert(result.end(), pair.second.begin(), pair.second.end());
+bool splitBatchItems(const uint8_t* data, size_t size, std::vector<MessageView>& items) {
+    items.clear();
+    size_t pos = 0;
+    while (pos < size) {
+        if (size - pos < sizeof(Message::Header)) return false;
+        const Message::Header hdr = Message::decodeHeader(data + pos);
+        const size_t frame = sizeof(Message::Header) + hdr.length;
+        if (hdr.length > size - pos - sizeof(Message::Header)) return false;
+        items.emplace_back();
+        if (!items.back().parse(data + pos, frame)) return false;
+        pos += frame;
     }
-    return result;
+    return true;
 }
 
-bool Message::decodeData(const std::vector<uint8_t>& data) {
-    data_.clear();
+bool MessageView::parseV1(const uint8_t* p, size_t len) {
+    // Payload: ponavlja se [key_len][key][val_len][val], dužine u mrežnom redoslijedu
     size_t pos = 0;
-    
-    while (pos + sizeof(uint32_t) <= data.size()) {
-        uint32_t key_len = 0;
-        std::memcpy(&key_len, data.data() + pos, sizeof(uint32_t));
-        key_len = ntohl(key_len);
+
+    auto readLen = [&](uint32_t& out) {
+        if (pos + sizeof(uint32_t) > len) return false;
+        std::memcpy(&out, p + pos, sizeof(uint32_t));
+        out = ntohl(out);
         pos += sizeof(uint32_t);
-        if (pos + key_len > data.size()) break;
-        
-        std::string key(data.begin() + pos, data.begin() + pos + key_len);
+        return true;
+    };
+
+    while (pos < len) {
+        uint32_t key_len = 0, val_len = 0;
+        if (!readLen(key_len) || pos + key_len > len) return false;
+        std::string_view key(reinterpret_cast<const char*>(p + pos), key_len);
         pos += key_len;
-        if (pos + sizeof(uint32_t) > data.size()) break;
-        
-        uint32_t val_len = 0;
-        std::memcpy(&val_len, data.data() + pos, sizeof(uint32_t));
-        val_len = ntohl(val_len);
-        pos += sizeof(uint32_t);
-        if (pos + val_len > data.size()) break;
-        
-        std::string value(data.begin() + pos, data.begin() + pos + val_len);
+
+        if (!readLen(val_len) || pos + val_len > len) return false;
+        std::string_view value(reinterpret_cast<const char*>(p + pos), val_len);
         pos += val_len;
-        data_[std::move(key)] = std::move(value);
+
+        Field f;
+        f.key   = key;
+        f.value = value;
+        fields_.push_back(f);
+    }
+    return pos == len;
+}
+
+bool MessageView::parseV2(const uint8_t* p, size_t len) {
+    size_t pos = 0;
+    while (pos < len) {
+        uint64_t tag = 0;
+        if (!getVarint(p, len, pos, tag)) return false;
+
+        Field f;
+        const uint64_t id = tag >> 3;
+        f.type = static_cast<FieldType>(tag & 0x7);
+        if (id == 0) {
+            uint64_t key_len = 0;
+            if (!getVarint(p, len, pos, key_len) || key_len > len - pos) return false;
+            f.key = std::string_view(reinterpret_cast<const char*>(p + pos), key_len);
+            pos += key_len;
+        } else if (id < kFieldCount) {
+            f.key = kFieldNames[id];
+        } else {
+            return false; // nepoznat ID (novija tabela kod pošiljaoca)
+        }
+
+        switch (f.type) {
+            case FieldType::INT: {
+                uint64_t v = 0;
+                if (!getVarint(p, len, pos, v)) return false;
+                f.i = unzigzag(v);
+                break;
+            }
+            case FieldType::DOUBLE:
+                if (len - pos < 8) return false;
+                f.d = getDoubleBE(p + pos);
+                pos += 8;
+                break;
+            case FieldType::BOOL:
+                if (pos >= len) return false;
+                f.i = p[pos++] ? 1 : 0;
+                break;
+            case FieldType::STRING:
+            case FieldType::BINARY: {
+                uint64_t n = 0;
+                if (!getVarint(p, len, pos, n) || n > len - pos) return false;
+                f.value = std::string_view(reinterpret_cast<const char*>(p + pos), n);
+                pos += n;
+                break;
+            }
+            default:
+                return false;
+        }
+        fields_.push_back(f);
+    }
+    return pos == len;
+}
+
+const MessageView::Field* MessageView::find(std::string_view key) const {
+    // Zadnje pojavljivanje pobjeđuje (isto kao punjenje mape u Message::deserialize)
+    for (auto it = fields_.rbegin(); it != fields_.rend(); ++it) {
+        if (it->key == key) return &*it;
+    }
+    return nullptr;
+}
+
+std::string_view MessageView::textOf(const Field& f) const {
+    switch (f.type) {
+        case FieldType::STRING:
+        case FieldType::BINARY:
+            return f.value;
+        case FieldType::BOOL:
+            return f.i ? "true" : "false";
+        default:
+            break;
+    }
+    if (!f.text_ready) {
+        // Isti tekst koji bi V1 poslao (std::to_string)
+        int n = f.type == FieldType::INT
+            ? std::snprintf(f.text, sizeof(f.text), "%d", static_cast<int32_t>(f.i))
+            : std::snprintf(f.text, sizeof(f.text), "%f", f.d);
+        f.text_len   = static_cast<uint8_t>(n > 0 && n < static_cast<int>(sizeof(f.text)) ? n : 0);
+        f.text_ready = true;
+    }
+    return std::string_view(f.text, f.text_len);
+}
+
+bool MessageView::hasKey(std::string_view key) const {
+    return find(key) != nullptr;
+}
+
+std::string_view MessageView::getStringView(std::string_view key) const {
+    const Field* f = find(key);
+    return f ? textOf(*f) : std::string_view{};
+}
+
+std::string MessageView::getString(std::string_view key) const {
+    const Field* f = find(key);
+    if (!f) return "";
+    if (f->type == FieldType::BINARY) return binaryToText(f->value);
+    return std::string(textOf(*f));
+}
+
+int32_t MessageView::getInt(std::string_view key) const {
+    const Field* f = find(key);
+    if (!f) return 0;
+    switch (f->type) {
+        case FieldType::INT:
+        case FieldType::BOOL:   return static_cast<int32_t>(f->i);
+        case FieldType::DOUBLE: return static_cast<int32_t>(f->d);
+        default:                break;
+    }
+    std::string_view v = f->value;
+    while (!v.empty() && (v.front() == ' ' || v.front() == '+')) v.remove_prefix(1);
+    int32_t out = 0;
+    std::from_chars(v.data(), v.data() + v.size(), out);
+    return out;
+}
+
+double MessageView::getDouble(std::string_view key) const {
+    const Field* f = find(key);
+    if (!f) return 0.0;
+    switch (f->type) {
+        case FieldType::DOUBLE: return f->d;
+        case FieldType::INT:    return static_cast<double>(f->i);
+        default:                break;
+    }
+    std::string_view v = f->value;
+    while (!v.empty() && v.front() == ' ') v.remove_prefix(1);
+    double out = 0.0;
+    std::from_chars(v.data(), v.data() + v.size(), out);
+    return out;
+}
+
+bool MessageView::getBool(std::string_view key) const {
+    const Field* f = find(key);
+    if (!f) return false;
+    if (f->type == FieldType::BOOL) return f->i != 0;
+    return f->value == "true";
+}
+
+std::vector<uint8_t> MessageView::getBinary(std::string_view key) const {
+    const Field* f = find(key);
+    if (!f) return {};
+    if (f->type == FieldType::BINARY) return std::vector<uint8_t>(f->value.begin(), f->value.end());
+    return textToBinary(f->value);
+}
+
+std::unique_ptr<Message> MessageView::toMessage() const {
+    auto msg = std::make_unique<Message>();
+    msg->assignFromView(*this);
+    return msg;
+}
+
+// =========================
+// ResponseTemplate implementacija
+// =========================
+
+namespace {
+
+// Kraći statični dio je brže provući kroz CRC nego ga spojiti (combine ~ 32 koraka u GF(2))
+constexpr uint32_t kCombineMinBytes = 128;
+
+void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    const uint32_t net = htonl(v);
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&net);
+    out.insert(out.end(), p, p + sizeof(uint32_t));
+}
+
+// INT slot nosi int32 (kao Message::addInt); tekstualna vrijednost se parsira
+int32_t slotInt(const ResponseTemplate::Value& v) {
+    if (v.is_number) return static_cast<int32_t>(v.number);
+    int64_t n = 0;
+    std::from_chars(v.text.data(), v.text.data() + v.text.size(), n);
+    return static_cast<int32_t>(n);
+}
+
+} // namespace
+
+ResponseTemplate::ResponseTemplate(const Message& fixed, std::vector<Slot> slots)
+    : fixed_(fixed), slots_(std::move(slots)) {
+    if (slots_.size() > kMaxSlots) throw std::invalid_argument("ResponseTemplate: too many slots");
+    for (const auto& slot : slots_) {
+        if (fixed_.findField(slot.key)) {
+            throw std::invalid_argument("ResponseTemplate: slot '" + slot.key + "' is also a fixed field");
+        }
     }
-    return pos == data.size();
+    buildLayout(PROTOCOL_V1, layouts_[0]);
+    buildLayout(PROTOCOL_V2, layouts_[1]);
+}
+
+void ResponseTemplate::buildLayout(uint16_t version, Layout& layout) const {
+    // Redoslijed polja je isti kao u Message::data_ (sortirano po ključu): statična polja i
+    // ključevi slotova idu u statične dijelove, a vrijednost slota prekida statični niz
+    std::vector<int> order(slots_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return slots_[a].key < slots_[b].key; });
+
+    auto& bytes = layout.bytes;
+    size_t run = 0;
+    auto close = [&](int slot) {
+        Part part;
+        part.offset = static_cast<uint32_t>(run);
+        part.length = static_cast<uint32_t>(bytes.size() - run);
+        part.crc    = Crc32::compute(bytes.data() + run, part.length);
+        part.factor = Crc32::shiftFactor(part.length);
+        part.slot   = slot;
+        layout.parts.push_back(part);
+        run = bytes.size();
+    };
+
+    auto it = fixed_.data_.begin();
+    for (int index : order) {
+        const Slot& slot = slots_[index];
+        for (; it != fixed_.data_.end() && it->key < slot.key; ++it) Message::encodeEntry(bytes, version, *it);
+
+        if (version != PROTOCOL_V2) {
+            putBE32(bytes, static_cast<uint32_t>(slot.key.size()));
+            bytes.insert(bytes.end(), slot.key.begin(), slot.key.end());
+        } else {
+            const FieldType type = slot.type == SlotType::INT ? FieldType::INT : FieldType::STRING;
+            const uint32_t  id   = fieldId(slot.key);
+            putVarint(bytes, (static_cast<uint64_t>(id) << 3) | static_cast<uint8_t>(type));
+            if (id == 0) {
+                putVarint(bytes, slot.key.size());
+                bytes.insert(bytes.end(), slot.key.begin(), slot.key.end());
+            }
+        }
+        close(index);
+    }
+    for (; it != fixed_.data_.end(); ++it) Message::encodeEntry(bytes, version, *it);
+    close(-1);
+}
+
+void ResponseTemplate::render(std::vector<uint8_t>& out, uint16_t version, uint32_t sequence_id,
+                              std::initializer_list<Value> values) const {
+    if (values.size() != slots_.size()) throw std::invalid_argument("ResponseTemplate: slot count mismatch");
+    const bool    v2     = (version == PROTOCOL_V2);
+    const Layout& layout = layouts_[v2 ? 1 : 0];
+
+    // 1) Tekst/broj svakog slota (brojevi u lokalnim baferima) i ukupna dužina payload-a
+    char             digits[kMaxSlots][24];
+    std::string_view text[kMaxSlots];
+    int32_t          number[kMaxSlots] = {};
+    size_t           length = layout.bytes.size();
+    size_t           i = 0;
+    for (const Value& v : values) {
+        const bool is_int = slots_[i].type == SlotType::INT;
+        if (is_int || v.is_number) {
+            const int64_t n = is_int ? slotInt(v) : v.number;
+            const auto res  = std::to_chars(digits[i], digits[i] + sizeof(digits[i]), n);
+            text[i]   = std::string_view(digits[i], static_cast<size_t>(res.ptr - digits[i]));
+            number[i] = static_cast<int32_t>(n);
+        } else {
+            text[i] = v.text;
+        }
+        if (!v2)          length += sizeof(uint32_t) + text[i].size();
+        else if (is_int)  length += varintSize(zigzag(number[i]));
+        else              length += varintSize(text[i].size()) + text[i].size();
+        ++i;
+    }
+
+    // 2) Header sa checksum=0; CRC teče od header-a kroz statične dijelove i vrijednosti
+    const size_t start = out.size();
+    out.reserve(start + sizeof(Message::Header) + length);
+    Message::Header header = fixed_.header_;
+    header.magic       = htonl(header.magic);
+    header.version     = htons(version);
+    header.type        = static_cast<MessageType>(htons(static_cast<uint16_t>(header.type)));
+    header.length      = htonl(static_cast<uint32_t>(length));
+    header.sequence_id = htonl(sequence_id);
+    header.session_id  = htonl(header.session_id);
+    header.checksum    = 0;
+    const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&header);
+    out.insert(out.end(), header_bytes, header_bytes + sizeof(header));
+    uint32_t crc = Crc32::compute(header_bytes, sizeof(header));
+
+    for (const Part& part : layout.parts) {
+        const uint8_t* fixed_bytes = layout.bytes.data() + part.offset;
+        out.insert(out.end(), fixed_bytes, fixed_bytes + part.length);
+        crc = part.length >= kCombineMinBytes ? Crc32::combineFactor(crc, part.crc, part.factor)
+                                              : Crc32::update(crc, fixed_bytes, part.length);
+        if (part.slot < 0) continue;
+
+        const size_t value_at = out.size();
+        const std::string_view value = text[part.slot];
+        if (!v2) {
+            putBE32(out, static_cast<uint32_t>(value.size()));
+            out.insert(out.end(), value.begin(), value.end());
+        } else if (slots_[part.slot].type == SlotType::INT) {
+            putVarint(out, zigzag(number[part.slot]));
+        } else {
+            putVarint(out, value.size());
+            out.insert(out.end(), value.begin(), value.end());
+        }
+        crc = Crc32::update(crc, out.data() + value_at, out.size() - value_at);
+    }
+
+    const uint32_t net_crc = htonl(crc);
+    std::memcpy(out.data() + start + offsetof(Message::Header, checksum), &net_crc, sizeof(uint32_t));
+}
+
+std::unique_ptr<Message> ResponseTemplate::toMessage(std::initializer_list<Value> values) const {
+    if (values.size() != slots_.size()) throw std::invalid_argument("ResponseTemplate: slot count mismatch");
+    auto message = std::make_unique<Message>(fixed_);
+    size_t i = 0;
+    for (const Value& v : values) {
+        const Slot& slot = slots_[i++];
+        if (slot.type == SlotType::INT) message->addInt(slot.key, slotInt(v));
+        else message->addString(slot.key, v.is_number ? std::to_string(v.number) : std::string(v.text));
+    }
+    message->calculateChecksum();
+    return message;
 }
 
 // =========================
 // MessageFactory implementacija
 // =========================
 
-std::unique_ptr<Message> MessageFactory::createConnectRequest(const std::string& client_id) {
+std::unique_ptr<Message> MessageFactory::createConnectRequest(const std::string& client_id,
+                                                             uint16_t max_version) {
     auto message = std::make_unique<Message>(MessageType::CONNECT_REQUEST);
     message->addString("client_id", client_id);
-    message->addString("protocol_version", "1.0");
+    message->addString("protocol_version", std::to_string(max_version) + ".0");
     message->calculateChecksum();
     return message;
 }
 
-std::unique_ptr<Message> MessageFactory::createConnectResponse(bool success, const std::string& reason) {
+std::unique_ptr<Message> MessageFactory::createConnectResponse(bool success, const std::string& reason,
+                                                              uint16_t version) {
     auto message = std::make_unique<Message>(MessageType::CONNECT_RESPONSE);
     message->addBool("success", success);
     if (!reason.empty()) message->addString("reason", reason);
+    message->addString("protocol_version", std::to_string(version) + ".0");
     message->calculateChecksum();
     return message;
 }
@@ -379,6 +1070,20 @@ std::unique_ptr<Message> MessageFactory::createRemoveMemberFromGroup(const std::
     return message;
 }
 
+std::unique_ptr<Message> MessageFactory::createAddMembersToGroup(const std::string& group_name,
+                                                                 const std::vector<std::string>& member_urns,
+                                                                 const std::string& session_id_str) {
+    auto message = std::make_unique<Message>(MessageType::ADD_MEMBERS_TO_GROUP);
+    message->addString("group_name", group_name);
+    message->addInt("count", static_cast<int32_t>(member_urns.size()));
+    for (size_t i = 0; i < member_urns.size(); ++i) {
+        message->addString("m." + std::to_string(i) + ".urn", member_urns[i]);
+    }
+    if (!session_id_str.empty()) message->addString("session_id", session_id_str);
+    message->calculateChecksum();
+    return message;
+}
+
 // admin ažuriranja
 
 std::unique_ptr<Message> MessageFactory::createUpdatePrice(VehicleType vehicle_type,
@@ -416,12 +1121,40 @@ std::unique_ptr<Message> MessageFactory::createUpdateCapacity(const std::string&
     return message;
 }
 
+std::unique_ptr<Message> MessageFactory::createBulkUpdateVehicles(const std::vector<VehicleUpdate>& updates) {
+    auto message = std::make_unique<Message>(MessageType::BULK_UPDATE_VEHICLES);
+    message->addInt("count", static_cast<int32_t>(updates.size()));
+    for (size_t i = 0; i < updates.size(); ++i) {
+        const auto& u = updates[i];
+        const std::string p = "v." + std::to_string(i) + ".";
+        message->addString(p + "uri", u.uri);
+        if (u.active)          message->addInt(p + "active", *u.active ? 1 : 0);
+        if (u.route)           message->addString(p + "route", *u.route);
+        if (u.type)            message->addInt(p + "vehicle_type", static_cast<int>(*u.type));
+        if (u.capacity)        message->addInt(p + "capacity", *u.capacity);
+        if (u.available_seats) message->addInt(p + "available_seats", *u.available_seats);
+    }
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createBulkUpdatePrices(const std::vector<PriceList>& prices) {
+    auto message = std::make_unique<Message>(MessageType::BULK_UPDATE_PRICES);
+    message->addInt("count", static_cast<int32_t>(prices.size()));
+    for (const auto& p : prices) {
+        message->addDouble("fare." + std::to_string(static_cast<int>(p.vehicle_type)) + "." +
+                           std::to_string(static_cast<int>(p.ticket_type)), p.base_price);
+    }
+    message->calculateChecksum();
+    return message;
+}
+
 // Sistem / servisne
 std::unique_ptr<Message> MessageFactory::createSuccessResponse(const std::string& message_text,
                                                               const std::map<std::string, std::string>& data) {
     auto response = std::make_unique<Message>(MessageType::RESPONSE_SUCCESS);
     if (!message_text.empty()) response->addString("message", message_text);
-    for (const auto& pair : data) response->addString(pair.first, pair.second);
+    response->addStrings(data);
     response->calculateChecksum();
     return response;
 }
@@ -441,6 +1174,46 @@ std::unique_ptr<Message> MessageFactory::createHeartbeat() {
     return message;
 }
 
+const ResponseTemplate& MessageFactory::errorResponseTemplate() {
+    static const ResponseTemplate tmpl(Message(MessageType::RESPONSE_ERROR),
+                                       {{"error", ResponseTemplate::SlotType::STRING},
+                                        {"error_code", ResponseTemplate::SlotType::INT}});
+    return tmpl;
+}
+
+const ResponseTemplate& MessageFactory::successResponseTemplate() {
+    static const ResponseTemplate tmpl(Message(MessageType::RESPONSE_SUCCESS),
+                                       {{"message", ResponseTemplate::SlotType::STRING}});
+    return tmpl;
+}
+
+const ResponseTemplate& MessageFactory::connectAcceptedTemplate() {
+    static const ResponseTemplate tmpl = [] {
+        Message fixed(MessageType::CONNECT_RESPONSE);
+        fixed.addBool("success", true);
+        fixed.addString("reason", "Connection established");
+        return ResponseTemplate(fixed, {{"protocol_version", ResponseTemplate::SlotType::STRING}});
+    }();
+    return tmpl;
+}
+
+const ResponseTemplate& MessageFactory::seatReservedTemplate() {
+    static const ResponseTemplate tmpl = [] {
+        Message fixed(MessageType::RESPONSE_SUCCESS);
+        fixed.addString("message", "Seat reserved successfully");
+        return ResponseTemplate(fixed, {{"route", ResponseTemplate::SlotType::STRING},
+                                        {"vehicle_uri", ResponseTemplate::SlotType::STRING},
+                                        {"available_seats", ResponseTemplate::SlotType::STRING}});
+    }();
+    return tmpl;
+}
+
+std::unique_ptr<Message> MessageFactory::createKeepalive() {
+    auto message = createHeartbeat();
+    message->setSequenceId(Message::kKeepaliveSequence);
+    return message;
+}
+
 std::unique_ptr<Message> MessageFactory::createDisconnect() {
     auto message = std::make_unique<Message>(MessageType::DISCONNECT);
     message->calculateChecksum();
@@ -451,10 +1224,151 @@ std::unique_ptr<Message> MessageFactory::createMulticastUpdate(const std::string
                                                                const std::map<std::string, std::string>& data) {
     auto message = std::make_unique<Message>(MessageType::MULTICAST_UPDATE);
     message->addString("update_type", update_type);
-    for (const auto& pair : data) message->addString(pair.first, pair.second);
+    message->addStrings(data);
     message->calculateChecksum();
     return message;
 }
 
-} // namespace transport
+std::unique_ptr<Message> MessageFactory::createGetVehicleStatus(const std::string& routes,
+                                                                uint64_t since_version,
+                                                                bool subscribe,
+                                                                const std::string& session_id) {
+    auto message = std::make_unique<Message>(MessageType::GET_VEHICLE_STATUS);
+    message->addString("routes", routes);
+    message->addString("since_version", std::to_string(since_version));
+    if (subscribe) message->addBool("subscribe", true);
+    if (!session_id.empty()) message->addString("session_id", session_id);
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createBatch(const std::vector<std::unique_ptr<Message>>& items) {
+    auto message = std::make_unique<Message>(MessageType::BATCH);
+    std::vector<uint8_t> blob;
+    int count = 0;
+    for (const auto& item : items) {
+        if (!item) continue;
+        item->serializeTo(blob);
+        ++count;
+    }
+    message->addInt("count", count);
+    message->addBinary("items", blob);
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createVehicleStatus(uint64_t version, uint64_t since_version, bool full,
+                                                             const std::vector<VehicleStatusRecord>& vehicles,
+                                                             const std::vector<VehicleStatusRecord>& removed) {
+    auto message = std::make_unique<Message>(MessageType::VEHICLE_STATUS);
+    message->addString("version", std::to_string(version));
+    message->addString("since_version", std::to_string(since_version));
+    message->addBool("full", full);
+    std::vector<uint8_t> blob;
+    vehicle_status::encodeRecords(vehicles, blob);
+    message->addBinary("vehicles", blob);
+    if (!removed.empty()) {
+        vehicle_status::encodeRecords(removed, blob);
+        message->addBinary("removed", blob);
+    }
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createMcastResync(const std::string& session_id,
+                                                           uint64_t from_seq, uint64_t to_seq) {
+    auto message = std::make_unique<Message>(MessageType::MCAST_RESYNC);
+    message->addString("session_id", session_id);
+    // 64-bitni redni brojevi kao tekst (addInt je 32-bitni)
+    message->addString("from_seq", std::to_string(from_seq));
+    message->addString("to_seq", std::to_string(to_seq));
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createReplicaSync(const std::string& server_id, uint64_t epoch,
+                                                           const std::string& key) {
+    auto message = std::make_unique<Message>(MessageType::REPLICA_SYNC);
+    message->addString("server_id", server_id);
+    message->addString("epoch", std::to_string(epoch));
+    if (!key.empty()) message->addString("key", key);
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createReplicaBatch(uint64_t epoch, uint64_t from, uint64_t to, bool snapshot,
+                                                            const std::vector<ReplicationRecord>& records,
+                                                            int compression_level) {
+    auto message = std::make_unique<Message>(MessageType::REPLICA_BATCH);
+    message->addString("epoch", std::to_string(epoch));
+    message->addString("from", std::to_string(from));
+    message->addString("to", std::to_string(to));
+    message->addBool("snapshot", snapshot);
+    message->addInt("count", static_cast<int32_t>(records.size()));
+
+    std::vector<uint8_t> raw, packed;
+    replication::encodeRecords(records, raw);
+    message->addInt("raw_size", static_cast<int32_t>(raw.size()));
+    if (replication::compress(raw, packed, compression_level)) {
+        message->addString("encoding", "zlib");
+        message->addBinary("records", packed);
+    } else {
+        message->addString("encoding", "raw");
+        message->addBinary("records", raw);
+    }
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createGetPrices() {
+    auto message = std::make_unique<Message>(MessageType::GET_PRICES);
+    message->calculateChecksum();
+    return message;
+}
 
+std::unique_ptr<Message> MessageFactory::createGetStats(const std::string& format) {
+    auto message = std::make_unique<Message>(MessageType::GET_STATS);
+    if (!format.empty()) message->addString("format", format);
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createListRecords(const std::string& table, const std::string& after,
+                                                          int limit, const std::string& admin_key) {
+    auto message = std::make_unique<Message>(MessageType::LIST_RECORDS);
+    message->addString("table", table);
+    if (!after.empty()) message->addString("after", after);
+    if (limit > 0) message->addInt("limit", limit);
+    if (!admin_key.empty()) message->addString("admin_key", admin_key);
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createVehicleTelemetry(const std::vector<TelemetrySample>& samples) {
+    auto message = std::make_unique<Message>(MessageType::VEHICLE_TELEMETRY);
+    std::vector<uint8_t> blob;
+    telemetry::encodeSamples(samples, blob);
+    message->addInt("count", static_cast<int32_t>(samples.size()));
+    message->addBinary("samples", blob);
+    message->calculateChecksum();
+    return message;
+}
+
+std::unique_ptr<Message> MessageFactory::createPriceList(const PriceSnapshot& prices) {
+    auto message = std::make_unique<Message>(MessageType::RESPONSE_SUCCESS);
+    message->addString("price_version", std::to_string(prices.version()));
+    int count = 0;
+    for (int v = 1; v <= static_cast<int>(PriceSnapshot::kVehicleTypes); ++v) {
+        for (int t = 1; t <= static_cast<int>(PriceSnapshot::kTicketTypes); ++t) {
+            const auto* fare = prices.find(static_cast<VehicleType>(v), static_cast<TicketType>(t));
+            if (!fare) continue;
+            message->addDouble("fare." + std::to_string(v) + "." + std::to_string(t), fare->base_price);
+            ++count;
+        }
+    }
+    message->addInt("count", count);
+    message->calculateChecksum();
+    return message;
+}
+
+} // namespace transport
@@ -0,0 +1,167 @@
+#include "common/Metrics.h"
+
+#include <cstdio>
+#include <sstream>
+
+namespace transport {
+namespace metrics {
+
+namespace {
+
+// Nit dobija traku jednom (round-robin), pa niti jednog pool-a ne dijele traku dok ih je <= kStripes
+std::atomic<size_t> next_stripe{0};
+
+std::string formatValue(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+// type="RESERVE_SEAT",shard="2" -> .RESERVE_SEAT.2 (ključevi u GET_STATS odgovoru)
+std::string labelSuffix(const std::string& labels) {
+    std::string out;
+    size_t pos = 0;
+    while ((pos = labels.find('"', pos)) != std::string::npos) {
+        const size_t end = labels.find('"', pos + 1);
+        if (end == std::string::npos) break;
+        out += '.';
+        out.append(labels, pos + 1, end - pos - 1);
+        pos = end + 1;
+    }
+    return out;
+}
+
+std::string withLabels(const std::string& name, const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return name;
+    std::string out = name + "{" + labels;
+    if (!labels.empty() && !extra.empty()) out += ",";
+    return out + extra + "}";
+}
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+} // namespace
+
+size_t Counter::stripe() {
+    thread_local const size_t slot = next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+    return slot;
+}
+
+uint64_t Counter::value() const {
+    uint64_t sum = 0;
+    for (const auto& c : cells_) sum += c.value.load(std::memory_order_relaxed);
+    return sum;
+}
+
+void Counter::reset() {
+    for (auto& c : cells_) c.value.store(0, std::memory_order_relaxed);
+}
+
+Registry& Registry::instance() {
+    static Registry registry;
+    return registry;
+}
+
+Registry::Family& Registry::family(const std::string& name, Kind kind, const std::string& help, double unit) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        it = families_.emplace(name, Family{}).first;
+        it->second.kind = kind;
+        it->second.unit = unit;
+    }
+    if (it->second.help.empty()) it->second.help = help;
+    return it->second;
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& labels, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto& slot = family(name, Kind::COUNTER, help, 1.0).counters[labels];
+    if (!slot) slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& labels, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto& slot = family(name, Kind::GAUGE, help, 1.0).gauges[labels];
+    if (!slot) slot = std::make_unique<Gauge>();
+    return *slot;
+}
+
+LatencyHistogram& Registry::histogram(const std::string& name, const std::string& labels,
+                                      const std::string& help, double unit) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto& slot = family(name, Kind::HISTOGRAM, help, unit).histograms[labels];
+    if (!slot) slot = std::make_unique<LatencyHistogram>();
+    return *slot;
+}
+
+std::string Registry::renderPrometheus() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::ostringstream out;
+    for (const auto& kv : families_) {
+        const std::string& name = kv.first;
+        const Family&      f    = kv.second;
+        if (!f.help.empty()) out << "# HELP " << name << ' ' << f.help << '\n';
+        switch (f.kind) {
+            case Kind::COUNTER:
+                out << "# TYPE " << name << " counter\n";
+                for (const auto& c : f.counters) out << withLabels(name, c.first) << ' ' << c.second->value() << '\n';
+                break;
+            case Kind::GAUGE:
+                out << "# TYPE " << name << " gauge\n";
+                for (const auto& g : f.gauges) out << withLabels(name, g.first) << ' ' << g.second->value() << '\n';
+                break;
+            case Kind::HISTOGRAM:
+                out << "# TYPE " << name << " summary\n";
+                for (const auto& h : f.histograms) {
+                    const auto snap = h.second->snapshot();
+                    if (snap.count) {
+                        for (double q : kQuantiles) {
+                            out << withLabels(name, h.first, "quantile=\"" + formatValue(q) + "\"") << ' '
+                                << formatValue(static_cast<double>(snap.percentile(q)) * f.unit) << '\n';
+                        }
+                    }
+                    out << withLabels(name + "_sum", h.first) << ' '
+                        << formatValue(static_cast<double>(snap.sum) * f.unit) << '\n';
+                    out << withLabels(name + "_count", h.first) << ' ' << snap.count << '\n';
+                }
+                break;
+        }
+    }
+    return out.str();
+}
+
+void Registry::collect(std::map<std::string, std::string>& out) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& kv : families_) {
+        const Family& f = kv.second;
+        for (const auto& c : f.counters) out[kv.first + labelSuffix(c.first)] = std::to_string(c.second->value());
+        for (const auto& g : f.gauges)   out[kv.first + labelSuffix(g.first)] = std::to_string(g.second->value());
+        for (const auto& h : f.histograms) {
+            const auto snap = h.second->snapshot();
+            if (!snap.count) continue;
+            // Vremenski histogrami (ns) u mikrosekundama, ostali u svojoj jedinici
+            const bool   time  = f.unit < 1.0;
+            const double scale = time ? f.unit * 1e6 : f.unit;
+            const std::string key    = kv.first + labelSuffix(h.first);
+            const std::string suffix = time ? "_us" : "";
+            out[key + ".count"] = std::to_string(snap.count);
+            out[key + ".p50" + suffix]  = formatValue(static_cast<double>(snap.percentile(0.5)) * scale);
+            out[key + ".p99" + suffix]  = formatValue(static_cast<double>(snap.percentile(0.99)) * scale);
+            out[key + ".p999" + suffix] = formatValue(static_cast<double>(snap.percentile(0.999)) * scale);
+            out[key + ".max" + suffix]  = formatValue(static_cast<double>(snap.max) * scale);
+        }
+    }
+}
+
+void Registry::reset() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto& kv : families_) {
+        for (auto& c : kv.second.counters)   c.second->reset();
+        for (auto& g : kv.second.gauges)     g.second->set(0);
+        for (auto& h : kv.second.histograms) h.second->reset();
+    }
+}
+
+} // namespace metrics
+} // namespace transport
@@ -0,0 +1,162 @@
+#include "common/PriceCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace transport {
+
+// ======================= PriceSnapshot =======================
+
+int PriceSnapshot::index(VehicleType vehicle_type, TicketType ticket_type) {
+    const int v = static_cast<int>(vehicle_type) - 1;
+    const int t = static_cast<int>(ticket_type) - 1;
+    if (v < 0 || v >= static_cast<int>(kVehicleTypes) || t < 0 || t >= static_cast<int>(kTicketTypes)) return -1;
+    return v * static_cast<int>(kTicketTypes) + t;
+}
+
+const PriceSnapshot::Fare* PriceSnapshot::find(VehicleType vehicle_type, TicketType ticket_type) const {
+    const int i = index(vehicle_type, ticket_type);
+    return i < 0 ? nullptr : &fares_[static_cast<size_t>(i)];
+}
+
+double PriceSnapshot::ticketPrice(VehicleType vehicle_type, TicketType ticket_type,
+                                  double distance, double minutes) const {
+    const Fare* f = find(vehicle_type, ticket_type);
+    if (!f) return kDefaultFare;
+    return f->base_price + distance * f->distance_multiplier + minutes * f->time_multiplier;
+}
+
+double PriceSnapshot::groupDiscount(TicketType ticket_type) const {
+    const int t = static_cast<int>(ticket_type) - 1;
+    if (t < 0 || t >= static_cast<int>(kTicketTypes)) return 0.0;
+    return group_discount_[static_cast<size_t>(t)];
+}
+
+bool PriceSnapshot::setFare(VehicleType vehicle_type, TicketType ticket_type, const Fare& fare) {
+    const int i = index(vehicle_type, ticket_type);
+    if (i < 0) return false;
+    fares_[static_cast<size_t>(i)] = fare;
+    return true;
+}
+
+void PriceSnapshot::setGroupDiscount(TicketType ticket_type, double rate) {
+    const int t = static_cast<int>(ticket_type) - 1;
+    if (t < 0 || t >= static_cast<int>(kTicketTypes)) return;
+    group_discount_[static_cast<size_t>(t)] = std::min(1.0, std::max(0.0, rate));
+}
+
+void PriceSnapshot::applyRows(const std::vector<PriceList>& rows) {
+    for (const auto& r : rows) {
+        const int i = index(r.vehicle_type, r.ticket_type);
+        if (i < 0) continue;
+        Fare& f = fares_[static_cast<size_t>(i)];
+        // UPDATE_PRICE vodi samo baznu cijenu; multiplikatori ostaju iz [pricing]
+        f.base_price = r.base_price;
+        f.version    = version_;
+    }
+}
+
+// ======================= PriceCache =======================
+
+PriceCache::PriceCache()
+    : current_(std::make_shared<const PriceSnapshot>()) {}
+
+void PriceCache::publish(std::shared_ptr<const PriceSnapshot> snapshot) {
+    if (!snapshot) return;
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::atomic_store(&current_, std::move(snapshot));
+}
+
+std::shared_ptr<const PriceSnapshot> PriceCache::update(VehicleType vehicle_type, TicketType ticket_type,
+                                                        double base_price) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto cur  = std::atomic_load(&current_);
+    auto next = std::make_shared<PriceSnapshot>(*cur);
+    const PriceSnapshot::Fare* old = cur->find(vehicle_type, ticket_type);
+    if (!old) return cur;
+
+    next->setVersion(cur->version() + 1);
+    PriceSnapshot::Fare f = *old;
+    f.base_price = base_price;
+    f.version    = next->version();
+    next->setFare(vehicle_type, ticket_type, f);
+
+    std::shared_ptr<const PriceSnapshot> published = std::move(next);
+    std::atomic_store(&current_, published);
+    return published;
+}
+
+std::shared_ptr<const PriceSnapshot> PriceCache::updateAll(const std::vector<PriceList>& rows) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto cur  = std::atomic_load(&current_);
+    auto next = std::make_shared<PriceSnapshot>(*cur);
+    next->setVersion(cur->version() + 1);
+    for (const auto& row : rows) {
+        const PriceSnapshot::Fare* old = cur->find(row.vehicle_type, row.ticket_type);
+        if (!old) continue;
+        PriceSnapshot::Fare f = *old;
+        f.base_price = row.base_price;
+        f.version    = next->version();
+        next->setFare(row.vehicle_type, row.ticket_type, f);
+    }
+
+    std::shared_ptr<const PriceSnapshot> published = std::move(next);
+    std::atomic_store(&current_, published);
+    return published;
+}
+
+bool PriceCache::applyUpdate(const Message& update) {
+    if (update.getType() != MessageType::MULTICAST_UPDATE) return false;
+    const std::string type = update.getString("update_type");
+    const bool whole_list  = (type == "price_list_updated");
+    if (!whole_list && type != "price_updated") return false;
+
+    // (vozilo, karta, cijena) iz poruke; verzija je zajednička
+    std::vector<PriceList> rows;
+    uint64_t version = 0;
+    try {
+        version = update.hasKey("price_version") ? std::stoull(update.getString("price_version")) : 0;
+        if (whole_list) {
+            for (int v = 1; v <= static_cast<int>(PriceSnapshot::kVehicleTypes); ++v) {
+                for (int t = 1; t <= static_cast<int>(PriceSnapshot::kTicketTypes); ++t) {
+                    const std::string key = "fare." + std::to_string(v) + "." + std::to_string(t);
+                    if (!update.hasKey(key)) continue;
+                    PriceList row{};
+                    row.vehicle_type = static_cast<VehicleType>(v);
+                    row.ticket_type  = static_cast<TicketType>(t);
+                    row.base_price   = update.getDouble(key);
+                    rows.push_back(row);
+                }
+            }
+        } else {
+            PriceList row{};
+            row.vehicle_type = static_cast<VehicleType>(update.getInt("vehicle_type"));
+            row.ticket_type  = static_cast<TicketType>(update.getInt("ticket_type"));
+            row.base_price   = update.getDouble("price");
+            rows.push_back(row);
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto cur = std::atomic_load(&current_);
+    auto next = std::make_shared<PriceSnapshot>(*cur);
+    bool changed = false;
+    for (const auto& row : rows) {
+        const PriceSnapshot::Fare* old = cur->find(row.vehicle_type, row.ticket_type);
+        // Bez verzije (stariji server) uvijek primijeni; inače samo novije od postojeće
+        if (!old || (version != 0 && version <= old->version)) continue;
+        PriceSnapshot::Fare f = *old;
+        f.base_price = row.base_price;
+        f.version    = version;
+        next->setFare(row.vehicle_type, row.ticket_type, f);
+        changed = true;
+    }
+    if (!changed) return false;
+    next->setVersion(std::max(cur->version(), version));
+    std::atomic_store(&current_, std::shared_ptr<const PriceSnapshot>(std::move(next)));
+    return true;
+}
+
+} // namespace transport
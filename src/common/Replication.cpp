@@ -0,0 +1,167 @@
+#include "common/Replication.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace transport {
+namespace replication {
+
+namespace {
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline bool getVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) return false;
+        const uint8_t b = in[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+inline void putString(std::vector<uint8_t>& out, const std::string& s) {
+    putVarint(out, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+inline bool getString(const std::vector<uint8_t>& in, size_t& pos, std::string& s) {
+    uint64_t n = 0;
+    if (!getVarint(in, pos, n) || n > in.size() - pos) return false;
+    s.assign(reinterpret_cast<const char*>(in.data() + pos), static_cast<size_t>(n));
+    pos += static_cast<size_t>(n);
+    return true;
+}
+
+// "a|b|c" -> n polja; zadnje polje uzima ostatak (ruta može sadržati '|')
+std::vector<std::string> splitFields(const std::string& value, size_t n) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (out.size() + 1 < n) {
+        const size_t bar = value.find('|', start);
+        if (bar == std::string::npos) break;
+        out.push_back(value.substr(start, bar - start));
+        start = bar + 1;
+    }
+    out.push_back(value.substr(start));
+    return out;
+}
+
+} // namespace
+
+void encodeRecords(const std::vector<ReplicationRecord>& records, std::vector<uint8_t>& out) {
+    out.clear();
+    putVarint(out, records.size());
+    for (const auto& r : records) {
+        out.push_back(static_cast<uint8_t>(r.kind));
+        putVarint(out, r.offset);
+        putString(out, r.key);
+        putString(out, r.value);
+    }
+}
+
+bool decodeRecords(const std::vector<uint8_t>& in, std::vector<ReplicationRecord>& records) {
+    records.clear();
+    size_t pos = 0;
+    uint64_t count = 0;
+    if (!getVarint(in, pos, count)) return false;
+    if (count > in.size()) return false;   // svaki zapis ima bar jedan bajt
+    records.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        if (pos >= in.size()) return false;
+        ReplicationRecord r;
+        const uint8_t kind = in[pos++];
+        if (kind < 1 || kind > 4) return false;
+        r.kind = static_cast<ReplicationRecord::Kind>(kind);
+        if (!getVarint(in, pos, r.offset) || !getString(in, pos, r.key) || !getString(in, pos, r.value)) {
+            return false;
+        }
+        records.push_back(std::move(r));
+    }
+    return pos == in.size();
+}
+
+bool compress(const std::vector<uint8_t>& in, std::vector<uint8_t>& out, int level) {
+    if (level <= 0 || in.empty()) return false;
+    uLongf len = compressBound(static_cast<uLong>(in.size()));
+    out.resize(len);
+    if (compress2(out.data(), &len, in.data(), static_cast<uLong>(in.size()), std::min(level, 9)) != Z_OK ||
+        len >= in.size()) {
+        out.clear();
+        return false;
+    }
+    out.resize(len);
+    return true;
+}
+
+bool decompress(const std::vector<uint8_t>& in, size_t raw_size, std::vector<uint8_t>& out) {
+    // deflate ne sažima više od ~1032:1
+    if (raw_size > kMaxRawBytes || raw_size / 1032 > in.size()) {
+        out.clear();
+        return false;
+    }
+    out.resize(raw_size);
+    uLongf len = static_cast<uLongf>(raw_size);
+    if (uncompress(out.data(), &len, in.data(), static_cast<uLong>(in.size())) != Z_OK || len != raw_size) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+std::string encodeVehicle(const Vehicle& vehicle) {
+    std::ostringstream os;
+    os << static_cast<int>(vehicle.type) << '|' << vehicle.capacity << '|' << vehicle.available_seats << '|'
+       << (vehicle.active ? 1 : 0) << '|' << vehicle.route;
+    return os.str();
+}
+
+bool decodeVehicle(const ReplicationRecord& record, Vehicle& vehicle) {
+    const auto f = splitFields(record.value, 5);
+    if (f.size() != 5 || record.key.empty()) return false;
+    vehicle.uri             = record.key;
+    vehicle.type            = static_cast<VehicleType>(std::atoi(f[0].c_str()));
+    vehicle.capacity        = std::atoi(f[1].c_str());
+    vehicle.available_seats = std::atoi(f[2].c_str());
+    vehicle.active          = f[3] == "1";
+    vehicle.route           = f[4];
+    return true;
+}
+
+std::string fareKey(VehicleType vehicle_type, TicketType ticket_type) {
+    return std::to_string(static_cast<int>(vehicle_type)) + ":" + std::to_string(static_cast<int>(ticket_type));
+}
+
+std::string encodeFare(const PriceSnapshot::Fare& fare) {
+    std::ostringstream os;
+    os.precision(17);
+    os << fare.base_price << '|' << fare.distance_multiplier << '|' << fare.time_multiplier << '|' << fare.version;
+    return os.str();
+}
+
+bool decodeFare(const ReplicationRecord& record, VehicleType& vehicle_type,
+                TicketType& ticket_type, PriceSnapshot::Fare& fare) {
+    const auto colon = record.key.find(':');
+    const auto f = splitFields(record.value, 4);
+    if (colon == std::string::npos || f.size() != 4) return false;
+    vehicle_type             = static_cast<VehicleType>(std::atoi(record.key.substr(0, colon).c_str()));
+    ticket_type              = static_cast<TicketType>(std::atoi(record.key.substr(colon + 1).c_str()));
+    fare.base_price          = std::strtod(f[0].c_str(), nullptr);
+    fare.distance_multiplier = std::strtod(f[1].c_str(), nullptr);
+    fare.time_multiplier     = std::strtod(f[2].c_str(), nullptr);
+    fare.version             = std::strtoull(f[3].c_str(), nullptr, 10);
+    return true;
+}
+
+} // namespace replication
+} // namespace transport
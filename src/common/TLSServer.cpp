@@ -1,7 +1,14 @@
 #include "common/TLSServer.h"
 #include "common/TLSSocket.h"
 
+#include <openssl/ssl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 namespace transport {
 
@@ -10,6 +17,12 @@ using boost::asio::ip::tcp;
 TLSServer::TLSServer() = default;
 TLSServer::~TLSServer() { stop(); }
 
+void TLSServer::setExecutionMode(ExecutionMode mode, int worker_threads) {
+    if (running_) return; // broj niti se ne mijenja u hodu
+    mode_           = mode;
+    worker_threads_ = worker_threads;
+}
+
 bool TLSServer::start(int port, const std::string& cert_file, const std::string& key_file) {
     if (running_) return true;
     running_ = true;
@@ -25,26 +38,73 @@ bool TLSServer::start(int port, const std::string& cert_file, const std::string&
         ssl_ctx_->use_certificate_chain_file(cert_file);
         ssl_ctx_->use_private_key_file(key_file, boost::asio::ssl::context::pem);
 
-        // TCP acceptor
-        acceptor_ = std::make_unique<tcp::acceptor>(
-            io_, tcp::endpoint(tcp::v4(), static_cast<unsigned short>(port)));
-        acceptor_->set_option(boost::asio::socket_base::reuse_address(true));
+        // Nastavak sesije: TLS 1.3 ticket-i (ključ ticket-a živi koliko i kontekst) i
+        // server-side cache za TLS 1.2; uređaji koji se često ponovo spajaju preskaču
+        // razmjenu ključeva i provjeru certifikata
+        SSL_CTX* native = ssl_ctx_->native_handle();
+        static const unsigned char kSessionContext[] = "transport-protocol";
+        SSL_CTX_set_session_id_context(native, kSessionContext, sizeof(kSessionContext) - 1);
+        if (session_resumption_) {
+            SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_set_timeout(native, static_cast<long>(session_lifetime_ > 0 ? session_lifetime_ : 7200));
+        } else {
+            SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_OFF);
+            SSL_CTX_set_options(native, SSL_OP_NO_TICKET);
+            SSL_CTX_set_num_tickets(native, 0);
+        }
+
+        // IO niti: jedna u THREAD_PER_CONNECTION modu, N u WORKER_POOL/SHARDED modu
+        int n = 1;
+        if (mode_ != ExecutionMode::THREAD_PER_CONNECTION) {
+            n = worker_threads_ > 0 ? worker_threads_
+                                    : static_cast<int>(std::thread::hardware_concurrency());
+            if (n < 1) n = 1;
+        }
+        const bool sharded = mode_ == ExecutionMode::SHARDED;
+        const int contexts = sharded ? n : 1;
+        contexts_.clear();
+        for (int i = 0; i < contexts; ++i) {
+            // Shard vrti tačno jedna nit (concurrency hint 1)
+            contexts_.push_back(sharded ? std::make_shared<boost::asio::io_context>(1)
+                                        : std::make_shared<boost::asio::io_context>());
+        }
+        next_shard_ = 0;
+        shard_connections_.reset(new std::atomic<uint64_t>[static_cast<size_t>(contexts)]);
+        for (int i = 0; i < contexts; ++i) shard_connections_[i] = 0;
+
+        // TCP acceptor(i): sa SO_REUSEPORT svaka worker nit (shard) ima svoj listen socket,
+        // pa accept opterećenje ne ide kroz jedan red
+        const bool per_worker = socket_options_.reuse_port && mode_ != ExecutionMode::THREAD_PER_CONNECTION && n > 1;
+        const int acceptors = per_worker ? n : 1;
+        for (int i = 0; i < acceptors; ++i) {
+            auto& io = *contexts_[sharded ? static_cast<size_t>(i) : 0];
+            acceptors_.push_back(openAcceptor(io, port, socket_options_.reuse_port));
+        }
 
         // Kreni prihvatati konekcije
-        doAccept();
-
-        // IO nit
-        io_.restart();
-        io_thread_ = std::make_unique<std::thread>([this]{
-            try {
-                io_.run();
-            } catch (const std::exception& e) {
-                std::cerr << "io_context error: " << e.what() << std::endl;
+        for (size_t i = 0; i < acceptors_.size(); ++i) doAccept(i);
+
+        io_threads_.reserve(static_cast<size_t>(n));
+        const int cpus = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int i = 0; i < n; ++i) {
+            boost::asio::io_context* io = contexts_[sharded ? static_cast<size_t>(i) : 0].get();
+            io_threads_.emplace_back([io]{
+                try {
+                    // Shard bez acceptora nema posla dok ne dobije prvi socket; radi do stop()
+                    auto work = boost::asio::make_work_guard(*io);
+                    io->run();
+                } catch (const std::exception& e) {
+                    std::cerr << "io_context error: " << e.what() << std::endl;
+                }
+            });
+            if (sharded && cpu_affinity_ && !pinToCpu(io_threads_.back(), i % cpus)) {
+                std::cerr << "Could not pin io shard " << i << " to CPU " << (i % cpus) << std::endl;
             }
-        });
+        }
     } catch (const std::exception& e) {
         std::cerr << "TLSServer start failed: " << e.what() << std::endl;
         running_ = false;
+        acceptors_.clear();
         return false;
     }
     return true;
@@ -55,42 +115,128 @@ void TLSServer::stop() {
     running_ = false;
 
     boost::system::error_code ec;
-    if (acceptor_) acceptor_->close(ec);
-    io_.stop();
+    for (auto& a : acceptors_) a->close(ec);
+    for (auto& io : contexts_) io->stop();
 
-    if (io_thread_ && io_thread_->joinable()) io_thread_->join();
+    for (auto& t : io_threads_) {
+        if (t.joinable()) t.join();
+    }
+    io_threads_.clear();
 
-    acceptor_.reset();
+    acceptors_.clear();
     ssl_ctx_.reset();
 }
 
-void TLSServer::doAccept() {
+TLSServer::Stats TLSServer::getStats() const {
+    Stats s;
+    s.handshakes = handshakes_.load();
+    s.resumed    = resumed_.load();
+    s.failed     = handshake_failures_.load();
+    s.timed_out  = handshake_timeouts_.load();
+    s.rejected   = rejected_.load();
+    return s;
+}
+
+std::vector<uint64_t> TLSServer::getShardConnections() const {
+    std::vector<uint64_t> out;
+    if (mode_ != ExecutionMode::SHARDED || !shard_connections_) return out;
+    for (size_t i = 0; i < contexts_.size(); ++i) out.push_back(shard_connections_[i].load());
+    return out;
+}
+
+bool TLSServer::pinToCpu(std::thread& thread, int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+}
+
+size_t TLSServer::pickShard(size_t acceptor_index) {
+    if (mode_ != ExecutionMode::SHARDED) return 0;
+    // Acceptor po shard-u (SO_REUSEPORT): kernel je već rasporedio, socket ostaje lokalan
+    if (acceptors_.size() > 1) return acceptor_index;
+    return next_shard_.fetch_add(1, std::memory_order_relaxed) % contexts_.size();
+}
+
+std::unique_ptr<tcp::acceptor> TLSServer::openAcceptor(boost::asio::io_context& io, int port, bool reuse_port) {
+    const tcp::endpoint endpoint(tcp::v4(), static_cast<unsigned short>(port));
+    auto acceptor = std::make_unique<tcp::acceptor>(io);
+    acceptor->open(endpoint.protocol());
+    acceptor->set_option(boost::asio::socket_base::reuse_address(socket_options_.reuse_address));
+    if (reuse_port) {
+        const int one = 1;
+        if (::setsockopt(acceptor->native_handle(), SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+            throw std::runtime_error("SO_REUSEPORT not supported");
+        }
+    }
+    acceptor->bind(endpoint);
+    acceptor->listen(boost::asio::socket_base::max_listen_connections);
+    return acceptor;
+}
+
+void TLSServer::doAccept(size_t acceptor_index) {
     if (!running_) return;
 
-    auto raw_socket = std::make_shared<tcp::socket>(io_);
-    acceptor_->async_accept(*raw_socket, [this, raw_socket](const boost::system::error_code& ec) {
+    // Svaka konekcija dobija svoj strand: read/write completion-i iste konekcije
+    // se nikad ne izvršavaju paralelno ni kad io_context vrti više niti. U SHARDED
+    // modu socket pripada ciljnom shard-u, pa handshake radi na njegovoj niti
+    const size_t shard = pickShard(acceptor_index);
+    auto raw_socket = std::make_shared<tcp::socket>(boost::asio::make_strand(*contexts_[shard]));
+    acceptors_[acceptor_index]->async_accept(*raw_socket,
+                                             [this, raw_socket, acceptor_index, shard](const boost::system::error_code& ec) {
         if (!running_) return;
         if (!ec) {
+            std::string opt_error;
+            if (!TLSSocket::applySocketOptions(*raw_socket, socket_options_, &opt_error)) {
+                std::cerr << "Socket options: " << opt_error << std::endl;
+            }
+
             // SSL stream nad prihvaćenim TCP socketom
             auto ssl_stream = std::make_shared<boost::asio::ssl::stream<tcp::socket>>(
                 std::move(*raw_socket), *ssl_ctx_);
 
+            // Rok za handshake: timer na istom strand-u zatvara TCP, pa handshake
+            // završava greškom (spor ili zlonamjeran klijent ne drži konekciju)
+            struct HandshakeState {
+                bool finished{false};
+                bool expired{false};
+            };
+            auto timer = std::make_shared<boost::asio::steady_timer>(ssl_stream->get_executor());
+            auto state = std::make_shared<HandshakeState>();
+            if (handshake_timeout_.count() > 0) {
+                timer->expires_after(handshake_timeout_);
+                timer->async_wait([ssl_stream, state](const boost::system::error_code& tec) {
+                    if (tec || state->finished) return;   // otkazan ili handshake već gotov
+                    state->expired = true;
+                    boost::system::error_code ignored;
+                    ssl_stream->lowest_layer().close(ignored);
+                });
+            }
+
             // TLS handshake (server strana)
             ssl_stream->async_handshake(
                 boost::asio::ssl::stream_base::server,
-                [this, ssl_stream](const boost::system::error_code& hec) {
+                [this, ssl_stream, timer, state, shard](const boost::system::error_code& hec) {
+                    state->finished = true;
+                    timer->cancel();
                     if (!running_) return;
-                    if (!hec) {
+                    if (!hec && !state->expired) {
+                        handshakes_++;
+                        if (SSL_session_reused(ssl_stream->native_handle())) resumed_++;
+                        shard_connections_[shard]++;
                         // Pretvori u tvoj TLSSocket (server-side ctor)
-                        auto clientSock = std::make_unique<TLSSocket>(ssl_stream);
-
-                        if (on_connection_) {
-                            // Pozovi korisnički callback u posebnoj niti da ne blokira accept petlju
-                            std::thread([cb = on_connection_, c = std::move(clientSock)]() mutable {
-                                cb(std::move(c));
-                            }).detach();
-                        }
+                        // Handler nit (THREAD_PER_CONNECTION) može nadživjeti server: socket
+                        // tada drži svoj kontekst. Async sesija ne smije (handler -> sesija ->
+                        // kontekst bi bio ciklus); nju zatvara ServerBase prije gašenja
+                        auto owner = mode_ == ExecutionMode::THREAD_PER_CONNECTION ? contexts_[shard] : nullptr;
+                        dispatchConnection(std::make_unique<TLSSocket>(ssl_stream, std::move(owner),
+                                                                       socket_options_));
+                    } else if (state->expired) {
+                        handshake_timeouts_++;
+                        std::cerr << "TLS handshake timed out after "
+                                  << handshake_timeout_.count() << " ms" << std::endl;
                     } else {
+                        handshake_failures_++;
                         std::cerr << "TLS handshake failed: " << hec.message() << std::endl;
                     }
                 });
@@ -99,9 +245,29 @@ void TLSServer::doAccept() {
         }
 
         // nastavi prihvat
-        doAccept();
+        doAccept(acceptor_index);
     });
 }
 
+void TLSServer::dispatchConnection(std::unique_ptr<TLSSocket> client) {
+    if (!on_connection_) return;
+    if (connection_filter_ && !connection_filter_(client)) {
+        rejected_++;
+        if (client) client->close();
+        return;
+    }
+
+    if (mode_ != ExecutionMode::THREAD_PER_CONNECTION) {
+        // Već smo na worker niti (shard-u); callback samo pokreće async sesiju
+        on_connection_(std::move(client));
+        return;
+    }
+
+    // Pozovi korisnički callback u posebnoj niti da ne blokira accept petlju
+    std::thread([cb = on_connection_, c = std::move(client)]() mutable {
+        cb(std::move(c));
+    }).detach();
+}
+
 } // namespace transport
 
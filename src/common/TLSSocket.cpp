@@ -1,40 +1,234 @@
 #include "common/TLSSocket.h"
+#include "common/BufferPool.h"
 #include "common/Message.h"
+#include "common/Tracing.h"
 
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
+#include <openssl/ssl.h>
 #include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 #include <cstring>
 #include <iostream>
+#include <map>
+#include <unordered_map>
+#include <utility>
 
 namespace transport {
 
 using boost::asio::ip::tcp;
 
+namespace {
+
+// Gornja granica jednog spojenog (coalesced) upisa: SSL stream piše bafer po bafer, pa
+// spojeni okviri do veličine record-a idu u jedan TLS record; ostatak u sljedeći krug
+constexpr size_t kMaxCoalescedWrite = TLSSocket::kMaxRecordPayload;
+
+// Rok za close_notify odgovor peer-a pri zatvaranju socketa na executor-u
+constexpr std::chrono::milliseconds kCloseTimeout{500};
+
+uint64_t nanosSince(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+// Klijentski TLS kontekst dijeljen po (cert, key, CA): fajlovi se čitaju jednom po
+// procesu, a zadnja sesija (TLS 1.3 ticket) se pamti po "host:port" za nastavak
+// sesije pri ponovnom spajanju (bez razmjene ključeva i provjere certifikata)
+struct ClientTlsContext {
+    ClientTlsContext() : ctx(boost::asio::ssl::context::tls_client) {}
+    ~ClientTlsContext() {
+        for (auto& kv : sessions) SSL_SESSION_free(kv.second);
+    }
+
+    // Referenca za SSL_set_session (pozivalac oslobađa) ili nullptr
+    SSL_SESSION* take(const std::string& peer) {
+        std::lock_guard<std::mutex> lk(sessions_mutex);
+        auto it = sessions.find(peer);
+        if (it == sessions.end()) return nullptr;
+        SSL_SESSION_up_ref(it->second);
+        return it->second;
+    }
+    // Preuzima referencu na sesiju
+    void store(const std::string& peer, SSL_SESSION* session) {
+        std::lock_guard<std::mutex> lk(sessions_mutex);
+        auto& slot = sessions[peer];
+        if (slot) SSL_SESSION_free(slot);
+        slot = session;
+    }
+    void forget(const std::string& peer) {
+        std::lock_guard<std::mutex> lk(sessions_mutex);
+        auto it = sessions.find(peer);
+        if (it == sessions.end()) return;
+        SSL_SESSION_free(it->second);
+        sessions.erase(it);
+    }
+
+    boost::asio::ssl::context                     ctx;
+    std::mutex                                    sessions_mutex;
+    std::unordered_map<std::string, SSL_SESSION*> sessions;
+};
+
+// ex_data indeksi (app data koristi Asio za verify callback)
+int peerIndex() {
+    static const int idx = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return idx;
+}
+int contextIndex() {
+    static const int idx = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return idx;
+}
+
+// OpenSSL javlja novu sesiju (kod TLS 1.3 ticket stiže nakon handshake-a, pri čitanju)
+int onNewClientSession(SSL* ssl, SSL_SESSION* session) {
+    auto* peer  = static_cast<const std::string*>(SSL_get_ex_data(ssl, peerIndex()));
+    auto* owner = static_cast<ClientTlsContext*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex()));
+    if (!peer || !owner || peer->empty()) return 0;
+    owner->store(*peer, session);
+    return 1;   // referenca je naša
+}
+
+std::shared_ptr<ClientTlsContext> sharedClientContext(const std::string& cert_file, const std::string& key_file,
+                                                      const std::string& ca_file) {
+    // Namjerno bez destrukcije: živi do kraja procesa (poslije OpenSSL cleanup-a se ne smije dirati)
+    static auto* mutex    = new std::mutex;
+    static auto* contexts = new std::map<std::string, std::shared_ptr<ClientTlsContext>>;
+
+    const std::string key = cert_file + '\n' + key_file + '\n' + ca_file;
+    std::lock_guard<std::mutex> lk(*mutex);
+    auto it = contexts->find(key);
+    if (it != contexts->end()) return it->second;
+
+    auto shared = std::make_shared<ClientTlsContext>();
+    auto& ctx = shared->ctx;
+    ctx.set_options(
+        boost::asio::ssl::context::default_workarounds
+        | boost::asio::ssl::context::no_sslv2
+        | boost::asio::ssl::context::single_dh_use);
+    if (!cert_file.empty() && !key_file.empty()) {
+        ctx.use_certificate_chain_file(cert_file);
+        ctx.use_private_key_file(key_file, boost::asio::ssl::context::pem);
+    }
+    if (!ca_file.empty()) {
+        ctx.load_verify_file(ca_file);
+        ctx.set_verify_mode(boost::asio::ssl::verify_peer);
+    } else {
+        ctx.set_verify_mode(boost::asio::ssl::verify_none);
+    }
+
+    SSL_CTX* native = ctx.native_handle();
+    SSL_CTX_set_ex_data(native, contextIndex(), shared.get());
+    SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(native, onNewClientSession);
+
+    contexts->emplace(key, shared);
+    return shared;
+}
+
+} // namespace
+
 // ===================== interna Asio struktura =====================
 struct TLSSocket::AsioState {
     boost::asio::io_context io;
-    std::unique_ptr<boost::asio::ssl::context> ssl_ctx; // kreiramo po potrebi
+    std::shared_ptr<ClientTlsContext> client_ctx;   // dijeljen među klijentskim socketima
+    std::string peer;                               // "host:port" -> ključ keša sesija
     std::shared_ptr<boost::asio::ssl::stream<tcp::socket>> stream; // dijeljeno zbog server ctor-a
     bool running = false;
+
+    // Klijentski mod: io nit drži posao dok je async API u upotrebi
+    std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work;
+
+    // Prijem: jedan bafer po konekciji ([Header][Payload]), kapacitet se zadržava
+    std::vector<uint8_t> rx_buf;
+    std::vector<uint8_t> rx_raw;        // receive(void*, n) kad stream pripada executor-u
+    bool rx_abandoned = false;          // sync read napušten (executor stao, rok istekao)
+
+    // Sync slanje: okvir se serijalizuje u isti bafer; mutex drži okvire cijelim
+    // kad više niti piše na isti socket (npr. handler + multicast update)
+    std::mutex           tx_sync_mutex;
+    std::vector<uint8_t> tx_sync_buf;
+
+    // Slanje: red okvira koji se spajaju u jedan async_write
+    struct PendingWrite {
+        std::vector<uint8_t> bytes;
+        WriteCallback        done;
+    };
+    std::mutex                 tx_mutex;
+    std::vector<PendingWrite>  tx_queue;
+    BufferPool                 tx_pool;     // baferi okvira iz reda, vraćaju se nakon spajanja
+    std::vector<uint8_t>       tx_buf;      // spojeni okviri u letu
+    std::vector<WriteCallback> tx_inflight; // callback-ovi okvira iz tx_buf
+    bool                       tx_in_progress = false;
+    std::atomic<uint64_t>      write_calls{0};
+
+    // close/disconnect socketa na executor-u: zatvara se tek kad se red upisa isprazni
+    bool                       close_pending = false;   // pod tx_mutex
+    bool                       closed = false;          // pod tx_mutex
+    std::condition_variable    closed_cv;
+};
+
+namespace {
+
+// Sync čitanje preko executor-a: token javlja kraj i kad se handler uništi bez poziva
+// (io_context ugašen ili uništen), pa pozivalac nikad ne čeka zauvijek
+struct ReadWait {
+    std::mutex                m;
+    std::condition_variable   cv;
+    bool                      done = false;
+    boost::system::error_code ec;
+
+    void finish(const boost::system::error_code& e) {
+        std::lock_guard<std::mutex> lk(m);
+        if (done) return;
+        done = true;
+        ec   = e;
+        cv.notify_all();
+    }
 };
 
+struct ReadToken {
+    std::shared_ptr<ReadWait> wait;
+    ~ReadToken() { wait->finish(boost::asio::error::operation_aborted); }
+};
+
+bool executorStopped(const boost::asio::any_io_executor& ex) {
+    // Stream-ovi uvijek žive na io_context-u (TLSServer kontekst ili AsioState::io)
+    auto& ctx = boost::asio::query(ex, boost::asio::execution::context);
+    return static_cast<boost::asio::io_context&>(ctx).stopped();
+}
+
+} // namespace
+
 // ===================== konstruktori / destruktor ==================
 TLSSocket::TLSSocket(Mode mode)
     : mode_(mode) {
     asio_ = std::make_shared<AsioState>();
 }
 
-TLSSocket::TLSSocket(std::shared_ptr<ssl_stream_t> accepted_stream)
-    : mode_(Mode::SERVER) {
+TLSSocket::TLSSocket(std::shared_ptr<ssl_stream_t> accepted_stream,
+                     std::shared_ptr<boost::asio::io_context> io_owner,
+                     const SocketOptions& options)
+    : mode_(Mode::SERVER), socket_options_(options), io_owner_(std::move(io_owner)) {
     asio_ = std::make_shared<AsioState>();
     asio_->stream = std::move(accepted_stream);
     connected_ = true;
     tls_established_ = true;
+    // Stream od početka pripada strand-u konekcije: sync pozivi idu kroz njega (v. usesAsyncIo())
+    async_io_ = true;
+    touchActivity();
+}
+
+bool TLSSocket::frameTooLarge(uint32_t payload) const {
+    return socket_options_.max_frame_bytes > 0 &&
+           sizeof(Message::Header) + payload > socket_options_.max_frame_bytes;
 }
 
 TLSSocket::~TLSSocket() {
     disconnect();
+    stopIoThread();
     cleanupSSL(); // no-op u Asio varijanti
 }
 
@@ -44,7 +238,79 @@ void TLSSocket::cleanupSSL() {}
 
 // ===================== POSIX server API (nije podržan ovdje) ======
 bool TLSSocket::createSocket() { return false; }
-bool TLSSocket::setSocketOptions() { return true; }
+
+// ===================== TCP opcije =================================
+bool TLSSocket::applySocketOptions(tcp::socket& socket, const SocketOptions& options, std::string* error) {
+    boost::system::error_code ec;
+    auto failed = [&](const char* what) {
+        if (error) *error = std::string(what) + ": " + ec.message();
+        return false;
+    };
+
+    socket.set_option(tcp::no_delay(options.tcp_nodelay), ec);
+    if (ec) return failed("TCP_NODELAY");
+    socket.set_option(boost::asio::socket_base::keep_alive(options.keepalive), ec);
+    if (ec) return failed("SO_KEEPALIVE");
+    if (options.keepalive) {
+        // Linux: vrijeme do prvog probe-a, razmak i broj probe-ova
+        const int fd = socket.native_handle();
+        const struct { int opt; int value; const char* name; } probes[] = {
+            {TCP_KEEPIDLE,  options.keepalive_idle,     "TCP_KEEPIDLE"},
+            {TCP_KEEPINTVL, options.keepalive_interval, "TCP_KEEPINTVL"},
+            {TCP_KEEPCNT,   options.keepalive_count,    "TCP_KEEPCNT"},
+        };
+        for (const auto& p : probes) {
+            if (p.value <= 0) continue;
+            if (::setsockopt(fd, IPPROTO_TCP, p.opt, &p.value, sizeof(p.value)) != 0) {
+                ec.assign(errno, boost::system::system_category());
+                return failed(p.name);
+            }
+        }
+    }
+    if (options.buffer_size > 0) {
+        socket.set_option(boost::asio::socket_base::send_buffer_size(options.buffer_size), ec);
+        if (ec) return failed("SO_SNDBUF");
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(options.buffer_size), ec);
+        if (ec) return failed("SO_RCVBUF");
+    }
+    return true;
+}
+
+void TLSSocket::setSocketOptions(const SocketOptions& options) {
+    socket_options_ = options;
+    if (asio_ && asio_->stream && asio_->stream->lowest_layer().is_open()) {
+        std::string err;
+        if (!applySocketOptions(asio_->stream->next_layer(), socket_options_, &err)) setLastError(err);
+    }
+}
+
+bool TLSSocket::querySocketOptions(SocketOptions& out) const {
+    if (!asio_ || !asio_->stream || !asio_->stream->lowest_layer().is_open()) return false;
+    auto& socket = asio_->stream->next_layer();
+    boost::system::error_code ec;
+    tcp::no_delay nodelay;
+    boost::asio::socket_base::keep_alive keepalive;
+    boost::asio::socket_base::send_buffer_size sndbuf;
+    socket.get_option(nodelay, ec);
+    if (!ec) socket.get_option(keepalive, ec);
+    if (!ec) socket.get_option(sndbuf, ec);
+    if (ec) return false;
+
+    out = SocketOptions{};
+    out.tcp_nodelay = nodelay.value();
+    out.keepalive   = keepalive.value();
+    out.buffer_size = sndbuf.value();   // Linux vraća udvostručenu vrijednost (bookkeeping)
+    const int fd = socket.native_handle();
+    socklen_t len = sizeof(int);
+    ::getsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE,  &out.keepalive_idle, &len);
+    len = sizeof(int);
+    ::getsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &out.keepalive_interval, &len);
+    len = sizeof(int);
+    ::getsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT,   &out.keepalive_count, &len);
+    out.reuse_address = false;
+    out.reuse_port    = false;
+    return true;
+}
 
 bool TLSSocket::bind(int) {
     setLastError("TLSSocket::bind is not supported in Asio mode. Use TLSServer.");
@@ -59,7 +325,13 @@ std::unique_ptr<TLSSocket> TLSSocket::accept() {
     return nullptr;
 }
 void TLSSocket::closeSocket() {
-    // Cleanup ide kroz disconnect(); nema raw fd-a ovdje
+    // Bez TLS shutdown-a: ne čekamo close_notify od peer-a (koristi se pri gašenju servera)
+    if (asio_ && asio_->stream) {
+        boost::system::error_code ec;
+        // shutdown budi nit blokiranu u sync read-u na istom socketu (sam close to ne radi)
+        asio_->stream->lowest_layer().shutdown(tcp::socket::shutdown_both, ec);
+        asio_->stream->lowest_layer().close(ec);
+    }
 }
 
 // ===================== TLS config (putanje) =======================
@@ -81,36 +353,41 @@ bool TLSSocket::connect(const std::string& hostname, int port) {
     }
 
     try {
-        // 1) ssl context
-        asio_->ssl_ctx = std::make_unique<boost::asio::ssl::context>(boost::asio::ssl::context::tls_client);
-        asio_->ssl_ctx->set_options(
-            boost::asio::ssl::context::default_workarounds
-            | boost::asio::ssl::context::no_sslv2
-            | boost::asio::ssl::context::single_dh_use);
-
-        if (!cert_file_.empty() && !key_file_.empty()) {
-            asio_->ssl_ctx->use_certificate_chain_file(cert_file_);
-            asio_->ssl_ctx->use_private_key_file(key_file_, boost::asio::ssl::context::pem);
-        }
-        if (!ca_file_.empty()) {
-            asio_->ssl_ctx->load_verify_file(ca_file_);
-            asio_->ssl_ctx->set_verify_mode(boost::asio::ssl::verify_peer);
-        } else {
-            asio_->ssl_ctx->set_verify_mode(boost::asio::ssl::verify_none);
-        }
+        // 1) dijeljeni ssl context (cert/key/CA se ne čitaju sa diska pri svakom spajanju)
+        asio_->client_ctx = sharedClientContext(cert_file_, key_file_, ca_file_);
+        asio_->peer       = hostname + ":" + std::to_string(port);
 
         // 2) socket + resolve + connect
         tcp::resolver resolver(asio_->io);
         auto endpoints = resolver.resolve(hostname, std::to_string(port));
-        asio_->stream = std::make_shared<boost::asio::ssl::stream<tcp::socket>>(asio_->io, *asio_->ssl_ctx);
+        asio_->stream = std::make_shared<boost::asio::ssl::stream<tcp::socket>>(asio_->io, asio_->client_ctx->ctx);
 
         boost::asio::connect(asio_->stream->lowest_layer(), endpoints);
+        std::string opt_error;
+        if (!applySocketOptions(asio_->stream->next_layer(), socket_options_, &opt_error)) {
+            throw std::runtime_error(opt_error);
+        }
 
-        // 3) TLS handshake
-        asio_->stream->handshake(boost::asio::ssl::stream_base::client);
+        // 3) TLS handshake; uz sačuvanu sesiju za isti server je skraćen
+        SSL* ssl = asio_->stream->native_handle();
+        SSL_set_ex_data(ssl, peerIndex(), &asio_->peer);
+        if (session_resumption_) {
+            if (SSL_SESSION* session = asio_->client_ctx->take(asio_->peer)) {
+                SSL_set_session(ssl, session);
+                SSL_SESSION_free(session);
+            }
+        }
+        try {
+            asio_->stream->handshake(boost::asio::ssl::stream_base::client);
+        } catch (...) {
+            asio_->client_ctx->forget(asio_->peer);   // npr. server sa novim ključem ticket-a
+            throw;
+        }
+        session_resumed_ = SSL_session_reused(ssl) == 1;
 
         connected_ = true;
         tls_established_ = true;
+        touchActivity();
         return true;
 
     } catch (const std::exception& e) {
@@ -131,11 +408,16 @@ ssize_t TLSSocket::send(const void* data, size_t length) {
         setLastError("TLS not established");
         return -1;
     }
+    if (usesAsyncIo()) {
+        const boost::asio::const_buffer buffer(data, length);
+        return asyncSendFrames(&buffer, 1) ? static_cast<ssize_t>(length) : -1;
+    }
     try {
         size_t total = 0;
         const uint8_t* p = static_cast<const uint8_t*>(data);
         while (total < length) {
             total += boost::asio::write(*asio_->stream, boost::asio::buffer(p + total, length - total));
+            asio_->write_calls.fetch_add(1, std::memory_order_relaxed);
         }
         return static_cast<ssize_t>(total);
     } catch (const std::exception& e) {
@@ -144,11 +426,64 @@ ssize_t TLSSocket::send(const void* data, size_t length) {
     }
 }
 
+ssize_t TLSSocket::send(const boost::asio::const_buffer* buffers, size_t count) {
+    if (count == 1) return send(buffers[0].data(), buffers[0].size());
+    if (!tls_established_ || !asio_ || !asio_->stream) {
+        setLastError("TLS not established");
+        return -1;
+    }
+    if (usesAsyncIo()) {
+        size_t length = 0;
+        for (size_t i = 0; i < count; ++i) length += buffers[i].size();
+        return asyncSendFrames(buffers, count) ? static_cast<ssize_t>(length) : -1;
+    }
+    // SSL stream šifruje svaki bafer sekvence posebno (record po baferu), pa se sitni
+    // dijelovi prvo spoje u thread-local bafer
+    auto& pool   = BufferPool::local();
+    auto  record = pool.acquire();
+    size_t total = 0;
+    try {
+        auto flush = [&] {
+            if (record.empty()) return;
+            boost::asio::write(*asio_->stream, boost::asio::buffer(record));
+            asio_->write_calls.fetch_add(1, std::memory_order_relaxed);
+            record.clear();
+        };
+        for (size_t i = 0; i < count; ++i) {
+            const auto* p = static_cast<const uint8_t*>(buffers[i].data());
+            const size_t n = buffers[i].size();
+            if (n >= kMaxRecordPayload) {
+                flush();
+                boost::asio::write(*asio_->stream, buffers[i]);
+                asio_->write_calls.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                if (record.size() + n > kMaxRecordPayload) flush();
+                record.insert(record.end(), p, p + n);
+            }
+            total += n;
+        }
+        flush();
+    } catch (const std::exception& e) {
+        setLastError(std::string("Asio TLS write failed: ") + e.what());
+        pool.release(std::move(record));
+        return -1;
+    }
+    pool.release(std::move(record));
+    return static_cast<ssize_t>(total);
+}
+
 ssize_t TLSSocket::receive(void* buffer, size_t length) {
     if (!tls_established_ || !asio_ || !asio_->stream) {
         setLastError("TLS not established");
         return -1;
     }
+    if (usesAsyncIo()) {
+        auto& raw = asio_->rx_raw;
+        raw.resize(length);
+        if (!readOnExecutor(raw, 0, length)) return -1;
+        std::memcpy(buffer, raw.data(), length);
+        return static_cast<ssize_t>(length);
+    }
     try {
         size_t total = 0;
         uint8_t* p = static_cast<uint8_t*>(buffer);
@@ -162,68 +497,197 @@ ssize_t TLSSocket::receive(void* buffer, size_t length) {
     }
 }
 
+bool TLSSocket::readOnExecutor(std::vector<uint8_t>& buf, size_t offset, size_t length) {
+    auto state = asio_;
+    if (state->rx_abandoned) {
+        setLastError("Asio TLS read failed: connection abandoned");
+        return false;
+    }
+
+    // async_read na executor-u stream-a (strand), pa nikad ne ide paralelno s upisom iz
+    // reda; pozivalac čeka completion. Ne zvati s niti koja vrti taj executor
+    auto wait  = std::make_shared<ReadWait>();
+    auto token = std::make_shared<ReadToken>();
+    token->wait = wait;
+    uint8_t* p = buf.data() + offset;
+    boost::asio::dispatch(state->stream->get_executor(), [state, p, length, token]() mutable {
+        boost::asio::async_read(*state->stream, boost::asio::buffer(p, length),
+            [token](const boost::system::error_code& ec, std::size_t) { token->wait->finish(ec); });
+    });
+    token.reset();
+
+    const int timeout_ms = socket_options_.receive_timeout_ms;
+    const auto deadline  = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    bool timed_out = false;
+    std::unique_lock<std::mutex> lk(wait->m);
+    while (!wait->cv.wait_for(lk, std::chrono::milliseconds(100), [&]{ return wait->done; })) {
+        // Executor više ne radi (server zaustavljen): read ostaje u redu i drži bafer
+        if (executorStopped(state->stream->get_executor())) {
+            state->rx_abandoned = true;
+            setLastError("Asio TLS read failed: io stopped");
+            return false;
+        }
+        if (timeout_ms > 0 && !timed_out && std::chrono::steady_clock::now() >= deadline) {
+            // Prekid na executor-u; čeka se completion (operation_aborted) jer op drži bafer
+            timed_out = true;
+            boost::asio::post(state->stream->get_executor(), [state]() {
+                boost::system::error_code ignored;
+                state->stream->lowest_layer().cancel(ignored);
+            });
+        }
+    }
+    if (timed_out) {
+        state->rx_abandoned = true;     // TLS record je možda prekinut u sredini
+        setLastError("Asio TLS read failed: receive timeout");
+        return false;
+    }
+    if (wait->ec) {
+        setLastError("Asio TLS read failed: " + wait->ec.message());
+        return false;
+    }
+    return true;
+}
+
 bool TLSSocket::sendMessage(const Message& message) {
     if (!tls_established_) {
         setLastError("TLS not established");
         return false;
     }
-    auto bytes = message.serialize(); // [Header][Payload]
+    if (writesViaQueue()) return asyncSendMessage(message);
+    std::lock_guard<std::mutex> lk(asio_->tx_sync_mutex);
+    auto& bytes = asio_->tx_sync_buf;
+    bytes.clear();
+    message.serializeTo(bytes, protocol_version_); // [Header][Payload], jedan prolaz
     return send(bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size());
 }
 
-std::unique_ptr<Message> TLSSocket::receiveMessage() {
+bool TLSSocket::sendFrame(const uint8_t* data, size_t length) {
     if (!tls_established_) {
         setLastError("TLS not established");
-        return nullptr;
+        return false;
+    }
+    if (writesViaQueue()) {
+        const boost::asio::const_buffer frame(data, length);
+        return asyncSendFrames(&frame, 1);
     }
+    std::lock_guard<std::mutex> lk(asio_->tx_sync_mutex);
+    return send(data, length) == static_cast<ssize_t>(length);
+}
 
-    // 1) header
-    std::vector<uint8_t> header_bytes(sizeof(Message::Header));
-    if (receive(header_bytes.data(), header_bytes.size()) != static_cast<ssize_t>(header_bytes.size())) {
-        return nullptr;
+bool TLSSocket::sendFrames(const boost::asio::const_buffer* frames, size_t count) {
+    if (!tls_established_) {
+        setLastError("TLS not established");
+        return false;
+    }
+    if (count == 0) return true;
+    if (writesViaQueue()) return asyncSendFrames(frames, count);
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i) length += frames[i].size();
+    std::lock_guard<std::mutex> lk(asio_->tx_sync_mutex);
+    return send(frames, count) == static_cast<ssize_t>(length);
+}
+
+bool TLSSocket::receiveFrame() {
+    if (!tls_established_) {
+        setLastError("TLS not established");
+        return false;
+    }
+
+    // 1) header direktno u bafer konekcije
+    auto& buf = asio_->rx_buf;
+    const bool on_executor = usesAsyncIo();
+    buf.resize(sizeof(Message::Header));
+    if (on_executor ? !readOnExecutor(buf, 0, buf.size())
+                    : receive(buf.data(), buf.size()) != static_cast<ssize_t>(buf.size())) {
+        return false;
     }
 
+    touchActivity();
+    const bool timed = tracing::Tracer::instance().enabled();
+    rx_timing_ = {};
+    if (timed) rx_timing_.header_at = std::chrono::steady_clock::now();
+
     // 2) doznaj payload dužinu
-    Message::Header hdr{};
-    std::memcpy(&hdr, header_bytes.data(), sizeof(Message::Header));
-    hdr.magic       = ntohl(hdr.magic);
-    hdr.version     = ntohs(hdr.version);
-    hdr.type        = static_cast<MessageType>(ntohs(static_cast<uint16_t>(hdr.type)));
-    hdr.length      = ntohl(hdr.length);
-    hdr.sequence_id = ntohl(hdr.sequence_id);
-    hdr.session_id  = ntohl(hdr.session_id);
-    hdr.checksum    = ntohl(hdr.checksum);
+    const Message::Header hdr = Message::decodeHeader(buf.data());
 
     if (hdr.magic != 0x54504D50) {
         setLastError("Invalid message magic");
-        return nullptr;
+        return false;
+    }
+    // Dužina dolazi od peer-a: bez provjere bi jedan header tražio alokaciju do 4 GiB
+    if (frameTooLarge(hdr.length)) {
+        setLastError("Frame too large: " + std::to_string(hdr.length) + " bytes");
+        return false;
     }
 
-    // 3) payload
-    std::vector<uint8_t> payload(hdr.length);
+    // 3) payload iza header-a, u isti bafer (deserialize očekuje [Header][Payload])
+    buf.resize(sizeof(Message::Header) + hdr.length);
     if (hdr.length > 0) {
-        if (receive(payload.data(), payload.size()) != static_cast<ssize_t>(payload.size())) {
-            return nullptr;
+        if (on_executor ? !readOnExecutor(buf, sizeof(Message::Header), hdr.length)
+                        : receive(buf.data() + sizeof(Message::Header), hdr.length) != static_cast<ssize_t>(hdr.length)) {
+            return false;
         }
     }
+    if (timed) rx_timing_.read_ns = nanosSince(rx_timing_.header_at);
+    // Keepalive nije odgovor: klijent uzvraća keepalive-om (server ga broji kao aktivnost),
+    // server uzvrat samo preskače - aktivnost je već zabilježena na header-u
+    if (hdr.type == MessageType::HEARTBEAT && hdr.sequence_id == Message::kKeepaliveSequence) {
+        if (mode_ == Mode::CLIENT && !sendMessage(*MessageFactory::createKeepalive())) return false;
+        return receiveFrame();
+    }
+    return true;
+}
 
-    // 4) sklopi [Header][Payload] i deserijalizuj
-    std::vector<uint8_t> full;
-    full.reserve(header_bytes.size() + payload.size());
-    full.insert(full.end(), header_bytes.begin(), header_bytes.end());
-    full.insert(full.end(), payload.begin(), payload.end());
+std::unique_ptr<Message> TLSSocket::receiveMessage() {
+    if (!receiveFrame()) return nullptr;
 
+    const auto decode_at = rx_timing_.header_at != std::chrono::steady_clock::time_point{}
+                               ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
     auto msg = std::make_unique<Message>();
-    if (!msg->deserialize(full)) {
+    if (!msg->deserialize(asio_->rx_buf)) {
         setLastError("Failed to deserialize message");
         return nullptr;
     }
+    if (decode_at != std::chrono::steady_clock::time_point{}) rx_timing_.decode_ns = nanosSince(decode_at);
     return msg;
 }
 
+bool TLSSocket::receiveMessageView(MessageView& view) {
+    if (!receiveFrame()) return false;
+
+    const auto decode_at = rx_timing_.header_at != std::chrono::steady_clock::time_point{}
+                               ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    if (!view.parse(asio_->rx_buf.data(), asio_->rx_buf.size())) {
+        setLastError("Failed to deserialize message");
+        return false;
+    }
+    if (decode_at != std::chrono::steady_clock::time_point{}) rx_timing_.decode_ns = nanosSince(decode_at);
+    return true;
+}
+
 // ===================== Disconnect / info ==========================
 void TLSSocket::disconnect() {
     async_running_ = false;
+    if (asio_ && asio_->stream && usesAsyncIo() && (mode_ == Mode::SERVER || receive_thread_)) {
+        // Stream pripada executor-u: TLS shutdown ide na njega, iza upisa iz reda. Nit van
+        // executor-a čeka kraj (kao ranije sync shutdown); io nit ne smije čekati samu sebe
+        closeAfterFlush();
+        auto& ctx = static_cast<boost::asio::io_context&>(
+            boost::asio::query(asio_->stream->get_executor(), boost::asio::execution::context));
+        bool closed = false;
+        if (!ctx.get_executor().running_in_this_thread()) {
+            std::unique_lock<std::mutex> lk(asio_->tx_mutex);
+            closed = asio_->closed_cv.wait_for(lk, kCloseTimeout * 2, [&]{ return asio_->closed; });
+        }
+        if (mode_ == Mode::CLIENT) stopIoThread();
+        // Executor stoji (server zaustavljen, io nit klijenta ugašena): zatvori ovdje
+        if (!closed && executorStopped(asio_->stream->get_executor())) closeSocket();
+        connected_ = false;
+        tls_established_ = false;
+        return;
+    }
+    // Klijentski async mod: zaustavi io nit prije sync shutdown-a (nema paralelnih op. nad stream-om)
+    stopIoThread();
     try {
         if (asio_ && asio_->stream) {
             boost::system::error_code ec;
@@ -235,6 +699,79 @@ void TLSSocket::disconnect() {
     tls_established_ = false;
 }
 
+void TLSSocket::shutdownTransport() {
+    if (!asio_ || !asio_->stream) return;
+    if (usesAsyncIo()) {
+        // Stream-om vlada njegov executor: shutdown ide na strand, ne paralelno s read-om
+        auto state = asio_;
+        boost::asio::post(state->stream->get_executor(), [state]{
+            boost::system::error_code ec;
+            state->stream->lowest_layer().shutdown(tcp::socket::shutdown_both, ec);
+        });
+        return;
+    }
+    boost::system::error_code ec;
+    asio_->stream->lowest_layer().shutdown(tcp::socket::shutdown_both, ec);
+}
+
+void TLSSocket::close() {
+    async_running_ = false;
+    if (asio_ && asio_->stream && usesAsyncIo() && (mode_ == Mode::SERVER || receive_thread_)) {
+        closeAfterFlush();      // npr. 503 iz filtera ode prije zatvaranja
+    } else {
+        closeSocket();
+    }
+    connected_ = false;
+    tls_established_ = false;
+}
+
+void TLSSocket::closeAfterFlush() {
+    auto state = asio_;
+    bool now = false;
+    {
+        std::lock_guard<std::mutex> lk(state->tx_mutex);
+        if (state->close_pending) return;
+        state->close_pending = true;
+        now = !state->tx_in_progress;   // inače zatvara completion zadnjeg upisa
+    }
+    if (executorStopped(state->stream->get_executor())) {
+        // Niko više ne vrti executor (server zaustavljen): zatvori odmah, peer vidi kraj
+        boost::system::error_code ec;
+        state->stream->lowest_layer().shutdown(tcp::socket::shutdown_both, ec);
+        state->stream->lowest_layer().close(ec);
+        std::lock_guard<std::mutex> lk(state->tx_mutex);
+        state->closed = true;
+        return;
+    }
+    if (now) boost::asio::post(state->stream->get_executor(), [state]{ closeStream(state); });
+}
+
+void TLSSocket::closeStream(const std::shared_ptr<AsioState>& state) {
+    // Na executor-u stream-a. close_notify (peer vidi uredan kraj, sesija ostaje u kešu),
+    // read u letu se prvo otkaže; peer koji ne odgovara ne drži konekciju duže od roka
+    auto finish = [state]{
+        boost::system::error_code ec;
+        state->stream->lowest_layer().shutdown(tcp::socket::shutdown_both, ec);
+        state->stream->lowest_layer().close(ec);
+        std::lock_guard<std::mutex> lk(state->tx_mutex);
+        state->closed = true;
+        state->closed_cv.notify_all();
+    };
+    boost::system::error_code ec;
+    state->stream->lowest_layer().cancel(ec);
+    if (!state->stream->lowest_layer().is_open()) return finish();
+
+    auto timer = std::make_shared<boost::asio::steady_timer>(state->stream->get_executor());
+    timer->expires_after(kCloseTimeout);
+    timer->async_wait([finish](const boost::system::error_code& tec) {
+        if (!tec) finish();
+    });
+    state->stream->async_shutdown([finish, timer](const boost::system::error_code&) {
+        timer->cancel();
+        finish();
+    });
+}
+
 std::string TLSSocket::getPeerAddress() const {
     try {
         if (asio_ && asio_->stream)
@@ -267,12 +804,275 @@ int TLSSocket::getLocalPort() const {
     return 0;
 }
 
-// ===================== Async API (stub) ===========================
+// ===================== Async API ==================================
+void TLSSocket::ensureIoThread() {
+    // Server-side stream živi na executor-u TLSServer-a; samo klijent vrti vlastiti io
+    if (mode_ != Mode::CLIENT || receive_thread_) return;
+
+    auto state = asio_;
+    state->io.restart();
+    state->work = std::make_unique<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+        state->io.get_executor());
+    receive_thread_ = std::make_unique<std::thread>([state]{
+        try {
+            state->io.run();
+        } catch (const std::exception& e) {
+            std::cerr << "TLSSocket io error: " << e.what() << std::endl;
+        }
+    });
+}
+
+void TLSSocket::stopIoThread() {
+    if (!receive_thread_) return;
+
+    asio_->work.reset();
+    asio_->io.stop();
+    if (receive_thread_->get_id() == std::this_thread::get_id()) {
+        receive_thread_->detach(); // pozvano iz callback-a na samoj io niti
+    } else if (receive_thread_->joinable()) {
+        receive_thread_->join();
+    }
+    receive_thread_.reset();
+}
+
+bool TLSSocket::enableFullDuplex() {
+    if (!tls_established_ || !asio_ || !asio_->stream) {
+        setLastError("TLS not established");
+        return false;
+    }
+    if (mode_ != Mode::CLIENT) return true;     // server-side stream je uvijek na strand-u
+    ensureIoThread();
+    async_io_.store(true, std::memory_order_release);
+    return true;
+}
+
 bool TLSSocket::startAsyncReceive() {
-    setLastError("Async receive not implemented in this minimal Asio port");
-    return false;
+    if (!tls_established_ || !asio_ || !asio_->stream) {
+        setLastError("TLS not established");
+        return false;
+    }
+    if (!message_callback_) {
+        setLastError("No message callback set");
+        return false;
+    }
+    if (async_running_.exchange(true)) return true;
+
+    ensureIoThread();
+    asyncReceiveLoop();
+    return true;
+}
+
+void TLSSocket::stopAsyncReceive() {
+    if (!async_running_.exchange(false)) return;
+
+    // Prekini read u letu; completion stiže kao operation_aborted i ne prijavljuje grešku
+    auto state = asio_;
+    if (state && state->stream) {
+        boost::asio::post(state->stream->get_executor(), [state]{
+            boost::system::error_code ec;
+            state->stream->lowest_layer().cancel(ec);
+        });
+    }
+}
+
+void TLSSocket::asyncReceiveLoop() {
+    if (!async_running_) return;
+
+    asyncReceiveMessage(
+        [this](std::unique_ptr<Message> msg) {
+            if (message_callback_) message_callback_(std::move(msg));
+            asyncReceiveLoop();
+        },
+        [this](const std::string& err) {
+            if (async_running_.exchange(false) && error_callback_) error_callback_(err);
+        });
+}
+
+void TLSSocket::asyncReceiveMessage(MessageCallback on_message, ErrorCallback on_error) {
+    asyncReceiveView(
+        [on_message = std::move(on_message)](const MessageView& view) {
+            if (on_message) on_message(view.toMessage());
+        },
+        std::move(on_error));
+}
+
+void TLSSocket::asyncReceiveView(ViewCallback on_view, ErrorCallback on_error) {
+    if (!tls_established_ || !asio_ || !asio_->stream) {
+        setLastError("TLS not established");
+        if (on_error) on_error(last_error_);
+        return;
+    }
+
+    ensureIoThread();
+    async_io_.store(true, std::memory_order_release);
+
+    auto state = asio_;
+    auto fail  = [this](const ErrorCallback& cb, const std::string& err) {
+        setLastError(err);
+        if (cb) cb(err);
+    };
+
+    // Sve operacije nad stream-om idu kroz njegov executor (strand na serveru)
+    boost::asio::dispatch(state->stream->get_executor(),
+        [this, state, fail, on_view = std::move(on_view), on_error = std::move(on_error)]() mutable {
+        // 1) header u bafer konekcije
+        state->rx_buf.resize(sizeof(Message::Header));
+        boost::asio::async_read(*state->stream, boost::asio::buffer(state->rx_buf),
+            [this, state, fail, on_view = std::move(on_view), on_error = std::move(on_error)]
+            (const boost::system::error_code& ec, std::size_t) mutable {
+                if (ec) return fail(on_error, "Asio TLS read failed: " + ec.message());
+
+                const Message::Header hdr = Message::decodeHeader(state->rx_buf.data());
+                if (hdr.magic != 0x54504D50) return fail(on_error, "Invalid message magic");
+                if (frameTooLarge(hdr.length))
+                    return fail(on_error, "Frame too large: " + std::to_string(hdr.length) + " bytes");
+                touchActivity();
+                rx_timing_ = {};
+                if (tracing::Tracer::instance().enabled()) rx_timing_.header_at = std::chrono::steady_clock::now();
+
+                // 2) payload u isti bafer, iza header-a (deserialize očekuje [Header][Payload])
+                state->rx_buf.resize(sizeof(Message::Header) + hdr.length);
+                auto payload = boost::asio::buffer(state->rx_buf.data() + sizeof(Message::Header), hdr.length);
+
+                boost::asio::async_read(*state->stream, payload,
+                    [this, state, fail, on_view = std::move(on_view), on_error = std::move(on_error)]
+                    (const boost::system::error_code& ec2, std::size_t) mutable {
+                        if (ec2) return fail(on_error, "Asio TLS read failed: " + ec2.message());
+
+                        // View pokazuje u rx_buf: važi do sljedećeg prijema na ovoj konekciji
+                        const bool timed = rx_timing_.header_at != std::chrono::steady_clock::time_point{};
+                        std::chrono::steady_clock::time_point decode_at{};
+                        if (timed) {
+                            decode_at = std::chrono::steady_clock::now();
+                            rx_timing_.read_ns = nanosSince(rx_timing_.header_at);
+                        }
+                        MessageView view;
+                        if (!view.parse(state->rx_buf.data(), state->rx_buf.size()))
+                            return fail(on_error, "Failed to deserialize message");
+                        if (timed) rx_timing_.decode_ns = nanosSince(decode_at);
+                        if (view.getType() == MessageType::HEARTBEAT &&
+                            view.getSequenceId() == Message::kKeepaliveSequence) {
+                            if (mode_ == Mode::CLIENT) asyncSendMessage(*MessageFactory::createKeepalive());
+                            return asyncReceiveView(std::move(on_view), std::move(on_error));
+                        }
+                        if (on_view) on_view(view);
+                    });
+            });
+    });
+}
+
+bool TLSSocket::asyncSendMessage(const Message& message, WriteCallback on_done) {
+    if (!tls_established_ || !asio_ || !asio_->stream) {
+        setLastError("TLS not established");
+        return false;
+    }
+
+    std::vector<uint8_t> bytes;
+    {
+        std::lock_guard<std::mutex> lk(asio_->tx_mutex);   // pool štiti tx_mutex
+        bytes = asio_->tx_pool.acquire();
+    }
+    message.serializeTo(bytes, protocol_version_);
+    return queueWrite(std::move(bytes), std::move(on_done));
+}
+
+bool TLSSocket::asyncSendFrames(const boost::asio::const_buffer* frames, size_t count, WriteCallback on_done) {
+    if (!tls_established_ || !asio_ || !asio_->stream) {
+        setLastError("TLS not established");
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    {
+        std::lock_guard<std::mutex> lk(asio_->tx_mutex);
+        bytes = asio_->tx_pool.acquire();
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const auto* p = static_cast<const uint8_t*>(frames[i].data());
+        bytes.insert(bytes.end(), p, p + frames[i].size());
+    }
+    return queueWrite(std::move(bytes), std::move(on_done));
+}
+
+bool TLSSocket::queueWrite(std::vector<uint8_t>&& bytes, WriteCallback on_done) {
+    ensureIoThread();
+
+    auto state = asio_;
+    bool start_write = false;
+    {
+        std::lock_guard<std::mutex> lk(state->tx_mutex);
+        if (state->close_pending) {
+            state->tx_pool.release(std::move(bytes));
+            setLastError("Connection closed");
+            return false;
+        }
+        state->tx_queue.push_back({std::move(bytes), std::move(on_done)});
+        if (!state->tx_in_progress) {
+            state->tx_in_progress = true;
+            start_write = true;
+        }
+    }
+    if (start_write) {
+        boost::asio::dispatch(state->stream->get_executor(), [state]{ startWrite(state); });
+    }
+    return true;
+}
+
+uint64_t TLSSocket::getWriteCalls() const {
+    return asio_ ? asio_->write_calls.load(std::memory_order_relaxed) : 0;
+}
+
+size_t TLSSocket::getPendingWrites() const {
+    if (!asio_) return 0;
+    std::lock_guard<std::mutex> lk(asio_->tx_mutex);
+    return asio_->tx_queue.size() + asio_->tx_inflight.size();
+}
+
+void TLSSocket::startWrite(const std::shared_ptr<AsioState>& state) {
+    // Spoji sve okvire iz reda (do kMaxCoalescedWrite) u jedan upis
+    {
+        std::lock_guard<std::mutex> lk(state->tx_mutex);
+        state->tx_buf.clear();
+        state->tx_inflight.clear();
+
+        size_t taken = 0;
+        while (taken < state->tx_queue.size()) {
+            auto& w = state->tx_queue[taken];
+            if (!state->tx_buf.empty() && state->tx_buf.size() + w.bytes.size() > kMaxCoalescedWrite) break;
+            state->tx_buf.insert(state->tx_buf.end(), w.bytes.begin(), w.bytes.end());
+            state->tx_pool.release(std::move(w.bytes));
+            state->tx_inflight.push_back(std::move(w.done));
+            ++taken;
+        }
+        state->tx_queue.erase(state->tx_queue.begin(), state->tx_queue.begin() + static_cast<std::ptrdiff_t>(taken));
+    }
+
+    state->write_calls.fetch_add(1, std::memory_order_relaxed);
+    // Completion drži samo state: socket može biti uništen prije nego što upis završi
+    boost::asio::async_write(*state->stream, boost::asio::buffer(state->tx_buf),
+        [state](const boost::system::error_code& ec, std::size_t) {
+            std::vector<WriteCallback> done;
+            bool more  = false;
+            bool close = false;
+            {
+                std::lock_guard<std::mutex> lk(state->tx_mutex);
+                done.swap(state->tx_inflight);
+                if (ec) {
+                    // Konekcija je pukla: odbaci i ostatak reda
+                    for (auto& w : state->tx_queue) done.push_back(std::move(w.done));
+                    state->tx_queue.clear();
+                }
+                more  = !state->tx_queue.empty();
+                close = !more && state->close_pending;
+                state->tx_in_progress = more;
+            }
+
+            for (auto& cb : done) {
+                if (cb) cb(!ec);
+            }
+            if (more) startWrite(state);
+            else if (close) closeStream(state);
+        });
 }
-void TLSSocket::stopAsyncReceive() {}
 
 int TLSSocket::getSocketError() const { return 0; }
 
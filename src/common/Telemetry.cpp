@@ -0,0 +1,83 @@
+#include "common/Telemetry.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace transport {
+namespace telemetry {
+
+namespace {
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline bool getVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) return false;
+        const uint8_t b = in[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+inline uint64_t zigzag(int64_t v)   { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t  unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+} // namespace
+
+void encodeSamples(const std::vector<TelemetrySample>& samples, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(1 + samples.size() * 20);
+    putVarint(out, samples.size());
+    uint64_t prev_ts = 0;
+    for (const auto& s : samples) {
+        const size_t n = std::min<size_t>(s.uri.size(), 255);
+        out.push_back(static_cast<uint8_t>(n));
+        out.insert(out.end(), s.uri.begin(), s.uri.begin() + static_cast<std::ptrdiff_t>(n));
+        putVarint(out, zigzag(static_cast<int64_t>(s.timestamp_ms - prev_ts)));
+        putVarint(out, static_cast<uint64_t>(std::max(0, s.occupancy)));
+        putVarint(out, zigzag(s.lat_e6));
+        putVarint(out, zigzag(s.lon_e6));
+        prev_ts = s.timestamp_ms;
+    }
+}
+
+bool decodeSamples(const std::vector<uint8_t>& in, std::vector<TelemetrySample>& samples) {
+    samples.clear();
+    if (in.empty()) return true;
+    size_t pos = 0;
+    uint64_t count = 0;
+    if (!getVarint(in, pos, count) || count > in.size()) return false;
+    samples.reserve(static_cast<size_t>(count));
+    uint64_t prev_ts = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        TelemetrySample s;
+        if (pos >= in.size()) return false;
+        const size_t n = in[pos++];
+        if (pos + n > in.size()) return false;
+        s.uri.assign(reinterpret_cast<const char*>(in.data() + pos), n);
+        pos += n;
+
+        uint64_t dt = 0, occ = 0, lat = 0, lon = 0;
+        if (!getVarint(in, pos, dt) || !getVarint(in, pos, occ) ||
+            !getVarint(in, pos, lat) || !getVarint(in, pos, lon)) return false;
+        if (occ > static_cast<uint64_t>(INT32_MAX)) return false;
+        s.timestamp_ms = prev_ts + static_cast<uint64_t>(unzigzag(dt));
+        s.occupancy    = static_cast<int>(occ);
+        s.lat_e6       = static_cast<int32_t>(unzigzag(lat));
+        s.lon_e6       = static_cast<int32_t>(unzigzag(lon));
+        prev_ts        = s.timestamp_ms;
+        samples.push_back(std::move(s));
+    }
+    return pos == in.size();
+}
+
+} // namespace telemetry
+} // namespace transport
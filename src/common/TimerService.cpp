@@ -0,0 +1,101 @@
+#include "common/TimerService.h"
+#include "common/Logger.h"
+
+namespace transport {
+
+TimerService::TimerService() : logger_(Logger::getLogger("TimerService")) {}
+
+TimerService::~TimerService() { stop(); }
+
+void TimerService::start() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (running_) return;
+    running_ = true;
+    if (io_.stopped()) io_.restart();
+    work_   = std::make_unique<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+        boost::asio::make_work_guard(io_));
+    thread_ = std::thread([this] { io_.run(); });
+}
+
+void TimerService::stop() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        running_ = false;
+        work_.reset();
+        io_.stop();                 // run() se vraća nakon posla u toku
+        thread.swap(thread_);
+    }
+    if (thread.joinable()) {
+        if (thread.get_id() == std::this_thread::get_id()) thread.detach();   // stop() iz posla
+        else thread.join();
+    }
+
+    // Nit više ne vrti io_: tajmeri se smiju dirati ovdje
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto& kv : entries_) {
+        kv.second->cancelled = true;
+        kv.second->timer.cancel();
+    }
+    entries_.clear();
+}
+
+uint64_t TimerService::schedule(const std::string& name, std::chrono::milliseconds interval, Task task,
+                                bool run_now) {
+    if (interval.count() <= 0) interval = std::chrono::milliseconds(1);
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto entry = std::make_shared<Entry>(io_, name, interval, std::move(task));
+    const uint64_t id = ++next_id_;
+    entries_.emplace(id, entry);
+    // Prvi rok postavlja pozivalac; dalje tajmer dira samo io nit (handler i cancel())
+    entry->timer.expires_after(run_now ? std::chrono::milliseconds(0) : interval);
+    entry->timer.async_wait([this, entry](const boost::system::error_code& ec) {
+        if (ec || entry->cancelled) return;
+        fire(entry);
+    });
+    return id;
+}
+
+bool TimerService::cancel(uint64_t id) {
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = entries_.find(id);
+        if (it == entries_.end()) return false;
+        entry = it->second;
+        entries_.erase(it);
+    }
+    // Na io niti: handler istog tajmera se možda upravo izvršava
+    boost::asio::post(io_, [entry] {
+        entry->cancelled = true;
+        entry->timer.cancel();
+    });
+    return true;
+}
+
+size_t TimerService::size() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return entries_.size();
+}
+
+void TimerService::fire(const std::shared_ptr<Entry>& entry) {
+    // Izvrši posao, pa sljedeći rok u fiksnom ritmu (bez nagomilavanja ako je posao kasnio)
+    try {
+        entry->task();
+    } catch (const std::exception& e) {
+        TP_LOG_ERROR(logger_, "Timer task '", entry->name, "' failed: ", e.what());
+    }
+    runs_++;
+    if (entry->cancelled || !running_) return;
+
+    const auto now = boost::asio::steady_timer::clock_type::now();
+    auto next      = entry->timer.expiry() + entry->interval;
+    if (next <= now) next = now + entry->interval;
+    entry->timer.expires_at(next);
+    entry->timer.async_wait([this, entry](const boost::system::error_code& ec) {
+        if (ec || entry->cancelled) return;
+        fire(entry);
+    });
+}
+
+} // namespace transport
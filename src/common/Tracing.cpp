@@ -0,0 +1,358 @@
+#include "common/Tracing.h"
+#include "common/Message.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace transport {
+namespace tracing {
+
+namespace {
+
+// Format fajla: "TPTRACE1", zatim zapisi
+//   u16 dužina ostatka zapisa | u64 trace_hi | u64 trace_lo | u64 span_id | u64 parent_id |
+//   i64 start_unix_ns | u64 duration_ns | u16 message_type | i32 status |
+//   u8 dužina imena | ime | u8 dužina servisa | servis
+// Svi brojevi little-endian.
+constexpr char   kMagic[8]    = {'T', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr size_t kFixedFields = 8 * 6 + 2 + 4;
+
+thread_local TraceContext tls_current;
+
+uint64_t randomId() {
+    thread_local std::mt19937_64 gen{[] {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    }()};
+    uint64_t id = 0;
+    while (id == 0) id = gen();
+    return id;
+}
+
+// steady_clock -> unix ns (pomak uhvaćen pri prvom pozivu)
+int64_t toUnixNanos(std::chrono::steady_clock::time_point t) {
+    static const int64_t offset = [] {
+        const auto sys    = std::chrono::system_clock::now().time_since_epoch();
+        const auto steady = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(sys).count() -
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(steady).count());
+    }();
+    return offset + static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+template <typename T>
+void putLE(std::vector<uint8_t>& out, T v) {
+    for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(v) >> (8 * i)));
+}
+
+template <typename T>
+T getLE(const uint8_t* p) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return static_cast<T>(v);
+}
+
+bool parseHex(std::string_view s, uint64_t& out) {
+    out = 0;
+    for (char c : s) {
+        int d;
+        if (c >= '0' && c <= '9') d = c - '0';
+        else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+        else return false;
+        out = (out << 4) | static_cast<uint64_t>(d);
+    }
+    return true;
+}
+
+void appendHex(std::string& out, uint64_t v, int digits) {
+    static const char* kHex = "0123456789abcdef";
+    for (int i = digits - 1; i >= 0; --i) out.push_back(kHex[(v >> (4 * i)) & 0xF]);
+}
+
+} // namespace
+
+// ------------------------ TraceContext ------------------------
+
+std::string TraceContext::toHeader() const {
+    std::string out;
+    out.reserve(55);
+    out += "00-";
+    appendHex(out, trace_hi, 16);
+    appendHex(out, trace_lo, 16);
+    out += '-';
+    appendHex(out, span_id, 16);
+    out += sampled ? "-01" : "-00";
+    return out;
+}
+
+TraceContext TraceContext::parse(std::string_view h) {
+    TraceContext ctx;
+    if (h.size() != 55 || h.substr(0, 3) != "00-" || h[35] != '-' || h[52] != '-') return ctx;
+    uint64_t flags = 0;
+    if (!parseHex(h.substr(3, 16), ctx.trace_hi) || !parseHex(h.substr(19, 16), ctx.trace_lo) ||
+        !parseHex(h.substr(36, 16), ctx.span_id) || !parseHex(h.substr(53, 2), flags)) {
+        return TraceContext{};
+    }
+    ctx.sampled = (flags & 0x01) != 0;
+    return ctx.valid() ? ctx : TraceContext{};
+}
+
+// ------------------------ Tracer ------------------------
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer() { shutdown(); }
+
+bool Tracer::configure(const Options& options) {
+    shutdown();
+    std::lock_guard<std::mutex> lk(mutex_);
+    options_ = options;
+    if (options_.queue_limit == 0) options_.queue_limit = 1;
+    const double rate = std::clamp(options_.sample_rate, 0.0, 1.0);
+    sample_threshold_ = rate >= 1.0 ? UINT64_MAX : static_cast<uint64_t>(rate * 18446744073709551616.0);
+    if (options_.export_path.empty()) return true;
+
+    file_ = std::fopen(options_.export_path.c_str(), "ab");
+    if (!file_) return false;
+    if (std::ftell(file_) == 0) std::fwrite(kMagic, 1, sizeof(kMagic), file_);
+    stop_ = false;
+    thread_ = std::make_unique<std::thread>(&Tracer::exportLoop, this);
+    enabled_ = true;
+    return true;
+}
+
+void Tracer::shutdown() {
+    std::unique_ptr<std::thread> thread;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        enabled_ = false;
+        stop_    = true;
+        thread   = std::move(thread_);
+    }
+    cv_.notify_all();
+    if (thread && thread->joinable()) thread->join();
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    pending_.clear();
+}
+
+bool Tracer::sampleRoot() {
+    const uint64_t threshold = sample_threshold_.load(std::memory_order_relaxed);
+    return threshold != 0 && enabled() && (threshold == UINT64_MAX || randomId() < threshold);
+}
+
+void Tracer::submit(SpanRecord&& span) {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!enabled_) return;
+        if (pending_.size() >= options_.queue_limit) {
+            dropped_++;
+            return;
+        }
+        pending_.push_back(std::move(span));
+    }
+    recorded_++;
+}
+
+bool Tracer::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lk(mutex_);
+    if (!thread_) return pending_.empty();
+    cv_.notify_all();
+    return flushed_cv_.wait_for(lk, timeout, [&] { return pending_.empty() && !writing_; });
+}
+
+Tracer::Stats Tracer::getStats() const {
+    Stats s;
+    s.recorded     = recorded_;
+    s.exported     = exported_;
+    s.dropped      = dropped_;
+    s.write_errors = write_errors_;
+    return s;
+}
+
+void Tracer::exportLoop() {
+    std::vector<SpanRecord> batch;
+    std::unique_lock<std::mutex> lk(mutex_);
+    while (true) {
+        cv_.wait_for(lk, options_.flush_interval, [&] { return stop_ || !pending_.empty(); });
+        batch.swap(pending_);
+        const bool stopping = stop_;
+        if (!batch.empty()) {
+            writing_ = true;
+            lk.unlock();
+            if (writeBatch(batch)) exported_ += batch.size();
+            else write_errors_++;
+            batch.clear();
+            lk.lock();
+            writing_ = false;
+        }
+        flushed_cv_.notify_all();
+        if (stopping && pending_.empty()) return;
+    }
+}
+
+bool Tracer::writeBatch(const std::vector<SpanRecord>& batch) {
+    std::vector<uint8_t> out;
+    out.reserve(batch.size() * 96);
+    const std::string& service = options_.service;
+    const size_t service_len   = std::min<size_t>(service.size(), 255);
+    for (const auto& s : batch) {
+        const size_t name_len = std::min<size_t>(std::strlen(s.name), 255);
+        putLE<uint16_t>(out, static_cast<uint16_t>(kFixedFields + 1 + name_len + 1 + service_len));
+        putLE(out, s.trace_hi);
+        putLE(out, s.trace_lo);
+        putLE(out, s.span_id);
+        putLE(out, s.parent_id);
+        putLE(out, s.start_unix_ns);
+        putLE(out, s.duration_ns);
+        putLE(out, s.message_type);
+        putLE(out, s.status);
+        out.push_back(static_cast<uint8_t>(name_len));
+        out.insert(out.end(), s.name, s.name + name_len);
+        out.push_back(static_cast<uint8_t>(service_len));
+        out.insert(out.end(), service.begin(), service.begin() + static_cast<std::ptrdiff_t>(service_len));
+    }
+    // file_ mijenja samo configure/shutdown, koji prvo zaustave ovu nit
+    return std::fwrite(out.data(), 1, out.size(), file_) == out.size() && std::fflush(file_) == 0;
+}
+
+bool Tracer::readSpans(const std::string& path, std::vector<SpanRecord>& out) {
+    out.clear();
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    std::fclose(f);
+
+    if (data.size() < sizeof(kMagic) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) return false;
+    size_t pos = sizeof(kMagic);
+    while (pos + 2 <= data.size()) {
+        const size_t len = getLE<uint16_t>(&data[pos]);
+        pos += 2;
+        if (len < kFixedFields + 2 || pos + len > data.size()) return false;
+        const uint8_t* p = &data[pos];
+        SpanRecord s;
+        s.trace_hi      = getLE<uint64_t>(p);
+        s.trace_lo      = getLE<uint64_t>(p + 8);
+        s.span_id       = getLE<uint64_t>(p + 16);
+        s.parent_id     = getLE<uint64_t>(p + 24);
+        s.start_unix_ns = getLE<int64_t>(p + 32);
+        s.duration_ns   = getLE<uint64_t>(p + 40);
+        s.message_type  = getLE<uint16_t>(p + 48);
+        s.status        = getLE<int32_t>(p + 50);
+        size_t off = kFixedFields;
+        const size_t name_len = p[off++];
+        if (off + name_len + 1 > len) return false;
+        s.decoded_name.assign(reinterpret_cast<const char*>(p + off), name_len);
+        off += name_len;
+        const size_t service_len = p[off++];
+        if (off + service_len > len) return false;
+        s.service.assign(reinterpret_cast<const char*>(p + off), service_len);
+        out.push_back(std::move(s));
+        pos += len;
+    }
+    return pos == data.size();
+}
+
+// ------------------------ Span ------------------------
+
+const TraceContext& current() { return tls_current; }
+
+Span::Span(const char* name, uint16_t message_type) {
+    if (tls_current.sampled) begin(name, tls_current, message_type, false);
+}
+
+Span::Span(const char* name, const TraceContext& parent, uint16_t message_type) {
+    auto& tracer = Tracer::instance();
+    if (!tracer.enabled()) return;
+    if (parent.valid()) {
+        if (parent.sampled) begin(name, parent, message_type, false);
+    } else if (tracer.sampleRoot()) {
+        begin(name, parent, message_type, true);
+    }
+}
+
+void Span::begin(const char* name, const TraceContext& parent, uint16_t message_type, bool root) {
+    active_       = true;
+    name_         = name;
+    message_type_ = message_type;
+    previous_     = tls_current;
+    if (root) {
+        context_.trace_hi = randomId();
+        context_.trace_lo = randomId();
+    } else {
+        context_.trace_hi = parent.trace_hi;
+        context_.trace_lo = parent.trace_lo;
+        parent_id_        = parent.span_id;
+    }
+    context_.span_id = randomId();
+    context_.sampled = true;
+    tls_current      = context_;
+    start_           = std::chrono::steady_clock::now();
+}
+
+Span::~Span() {
+    if (!active_) return;
+    const auto end = std::chrono::steady_clock::now();
+    tls_current = previous_;
+
+    SpanRecord r;
+    r.trace_hi      = context_.trace_hi;
+    r.trace_lo      = context_.trace_lo;
+    r.span_id       = context_.span_id;
+    r.parent_id     = parent_id_;
+    r.start_unix_ns = toUnixNanos(start_);
+    r.duration_ns   = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count());
+    r.message_type  = message_type_;
+    r.status        = status_;
+    r.name          = name_;
+    Tracer::instance().submit(std::move(r));
+}
+
+void recordSpan(const char* name, std::chrono::steady_clock::time_point start, uint64_t duration_ns,
+                uint16_t message_type) {
+    if (!tls_current.sampled) return;
+    SpanRecord r;
+    r.trace_hi      = tls_current.trace_hi;
+    r.trace_lo      = tls_current.trace_lo;
+    r.span_id       = randomId();
+    r.parent_id     = tls_current.span_id;
+    r.start_unix_ns = toUnixNanos(start);
+    r.duration_ns   = duration_ns;
+    r.message_type  = message_type;
+    r.name          = name;
+    Tracer::instance().submit(std::move(r));
+}
+
+// ------------------------ Propagacija ------------------------
+
+TraceContext extract(const MessageView& view) {
+    if (!Tracer::instance().enabled() || !view.hasKey(kTraceField)) return {};
+    return TraceContext::parse(view.getStringView(kTraceField));
+}
+
+TraceContext extract(const Message& message) {
+    if (!Tracer::instance().enabled() || !message.hasKey(kTraceField)) return {};
+    return TraceContext::parse(message.getString(kTraceField));
+}
+
+void inject(Message& message) {
+    if (!tls_current.sampled) return;
+    message.addString(kTraceField, tls_current.toHeader());
+    message.calculateChecksum();
+}
+
+} // namespace tracing
+} // namespace transport
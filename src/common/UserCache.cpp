@@ -0,0 +1,226 @@
+#include "common/UserCache.h"
+
+#include <algorithm>
+
+namespace transport {
+
+namespace {
+
+// Živi keševi procesa (CentralServer, testovi); Database ih poništava pri upisu
+std::mutex& cachesMutex() {
+    static std::mutex m;
+    return m;
+}
+std::vector<UserCache*>& caches() {
+    static std::vector<UserCache*> list;
+    return list;
+}
+
+metrics::Counter& lookupCounter(const char* result) {
+    return metrics::Registry::instance().counter(
+        "tp_user_cache_lookups_total", std::string("result=\"") + result + "\"",
+        "User cache lookups in front of Database::getUser");
+}
+
+} // namespace
+
+UserCache::UserCache() : UserCache(Options{}) {}
+
+UserCache::UserCache(Options options)
+    : hit_counter_(&lookupCounter("hit")),
+      negative_counter_(&lookupCounter("negative_hit")),
+      miss_counter_(&lookupCounter("miss")),
+      eviction_counter_(&metrics::Registry::instance().counter(
+          "tp_user_cache_evictions_total", "", "User cache entries evicted by the CLOCK hand")) {
+    build(options);
+    std::lock_guard<std::mutex> lk(cachesMutex());
+    caches().push_back(this);
+}
+
+UserCache::~UserCache() {
+    std::lock_guard<std::mutex> lk(cachesMutex());
+    auto& list = caches();
+    list.erase(std::remove(list.begin(), list.end(), this), list.end());
+}
+
+void UserCache::configure(Options options) {
+    // Pod bravom registra: invalidateEverywhere ne smije zateći shardove u zamjeni
+    std::lock_guard<std::mutex> lk(cachesMutex());
+    build(options);
+}
+
+void UserCache::build(const Options& options) {
+    const size_t shard_count = std::max<size_t>(1, options.shard_count);
+    shard_capacity_ = std::max<size_t>(1, (std::max<size_t>(1, options.capacity) + shard_count - 1) / shard_count);
+    negative_ttl_   = options.negative_ttl;
+    shards_.clear();
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) shards_.push_back(std::make_unique<Shard>());
+}
+
+void UserCache::invalidateEverywhere(const std::string& urn) {
+    std::lock_guard<std::mutex> lk(cachesMutex());
+    for (UserCache* cache : caches()) cache->invalidate(urn);
+}
+
+UserCache::Shard& UserCache::shardFor(const std::string& urn) {
+    return *shards_[std::hash<std::string>{}(urn) % shards_.size()];
+}
+
+UserCache::Lookup UserCache::lookup(const std::string& urn) {
+    Shard& shard = shardFor(urn);
+    Lookup out;
+    {
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        auto it = shard.index.find(urn);
+        if (it != shard.index.end()) {
+            Slot& slot = shard.slots[it->second];
+            if (slot.user || Clock::now() < slot.expires) {
+                slot.referenced = true;
+                out.user        = slot.user;
+                out.missing     = !slot.user;
+            } else {
+                removeLocked(shard, it->second);      // istekao negativan unos
+            }
+        }
+        out.ticket = shard.epoch;
+    }
+
+    if (out.user) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        hit_counter_->inc();
+    } else if (out.missing) {
+        negative_hits_.fetch_add(1, std::memory_order_relaxed);
+        negative_counter_->inc();
+    } else {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        miss_counter_->inc();
+    }
+    return out;
+}
+
+void UserCache::put(std::shared_ptr<const User> user, uint64_t ticket) {
+    if (!user) return;
+    const std::string urn = user->urn;
+    store(urn, std::move(user), ticket);
+}
+
+void UserCache::putMissing(const std::string& urn, uint64_t ticket) {
+    store(urn, nullptr, ticket);
+}
+
+void UserCache::store(const std::string& urn, std::shared_ptr<const User> user, uint64_t ticket) {
+    if (!user && negative_ttl_.count() <= 0) return;
+    Shard& shard = shardFor(urn);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    // Poništavanje u međuvremenu: pročitani red može biti stariji od upisa u bazu
+    if (ticket != shard.epoch) return;
+
+    auto it = shard.index.find(urn);
+    const size_t index = it != shard.index.end() ? it->second : claimSlotLocked(shard);
+    Slot& slot = shard.slots[index];
+    if (it == shard.index.end()) {
+        slot.urn = urn;
+        shard.index.emplace(urn, index);
+    }
+    slot.expires    = user ? Clock::time_point{} : Clock::now() + negative_ttl_;
+    slot.user       = std::move(user);
+    slot.referenced = false;      // nov unos: prvi krug kazaljke ga može uzeti ako se ne koristi
+}
+
+size_t UserCache::claimSlotLocked(Shard& shard) {
+    if (!shard.free.empty()) {
+        const size_t index = shard.free.back();
+        shard.free.pop_back();
+        return index;
+    }
+    if (shard.slots.size() < shard_capacity_) {
+        shard.slots.emplace_back();
+        return shard.slots.size() - 1;
+    }
+    // CLOCK: korišteni od zadnjeg prolaza dobijaju još jedan krug
+    while (true) {
+        const size_t index = shard.hand;
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+        Slot& slot = shard.slots[index];
+        if (slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        shard.index.erase(slot.urn);
+        slot = Slot{};
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        eviction_counter_->inc();
+        return index;
+    }
+}
+
+void UserCache::removeLocked(Shard& shard, size_t index) {
+    Slot& slot = shard.slots[index];
+    shard.index.erase(slot.urn);
+    slot = Slot{};
+    shard.free.push_back(index);
+}
+
+void UserCache::invalidate(const std::string& urn) {
+    Shard& shard = shardFor(urn);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    shard.epoch++;
+    auto it = shard.index.find(urn);
+    if (it != shard.index.end()) removeLocked(shard, it->second);
+}
+
+void UserCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lk(shard->mutex);
+        shard->epoch++;
+        shard->index.clear();
+        shard->slots.clear();
+        shard->free.clear();
+        shard->hand = 0;
+    }
+}
+
+std::shared_ptr<const User> UserCache::get(const std::string& urn,
+                                           const std::function<std::unique_ptr<User>()>& load,
+                                           const std::function<bool()>& failed) {
+    Lookup found = lookup(urn);
+    if (found.hit()) return found.user;
+
+    std::shared_ptr<const User> user(load());
+    if (user || !failed || !failed()) store(urn, user, found.ticket);
+    return user;
+}
+
+std::vector<std::string> UserCache::keys(size_t max) const {
+    std::vector<std::string> out;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lk(shard->mutex);
+        for (const auto& slot : shard->slots) {
+            if (out.size() >= max) return out;
+            if (slot.user) out.push_back(slot.urn);
+        }
+    }
+    return out;
+}
+
+UserCache::Stats UserCache::getStats() const {
+    Stats s;
+    s.hits          = hits_.load(std::memory_order_relaxed);
+    s.negative_hits = negative_hits_.load(std::memory_order_relaxed);
+    s.misses        = misses_.load(std::memory_order_relaxed);
+    s.evictions     = evictions_.load(std::memory_order_relaxed);
+    s.size          = size();
+    return s;
+}
+
+size_t UserCache::size() const {
+    size_t n = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lk(shard->mutex);
+        n += shard->index.size();
+    }
+    return n;
+}
+
+} // namespace transport
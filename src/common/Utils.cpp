@@ -1,34 +1,136 @@
 #include "common/Utils.h"
+#include "common/ClockService.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <random>
-#include <sstream>
-#include <iomanip>
-#include <ctime>
+#include <thread>
 
 namespace transport {
 
-std::string Utils::generateUUID() {
+namespace {
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** (Blackman/Vigna): par nanosekundi po broju, stanje 32 bajta po niti
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(uint64_t seed) {
+        for (auto& s : s_) s = splitmix64(seed);
+    }
+    uint64_t next() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t      = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t s_[4];
+};
+
+uint64_t threadSeed() {
+    // random_device samo jednom po niti; id niti i sat razdvajaju niti i sa lošim random_device
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
-    
-    std::stringstream ss;
-    for (int i = 0; i < 32; ++i) {
-        if (i == 8 || i == 12 || i == 16 || i == 20) {
-            ss << "-";
-        }
-        ss << std::hex << dis(gen);
+    uint64_t seed = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    seed ^= std::hash<std::thread::id>{}(std::this_thread::get_id());
+    seed ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return seed;
+}
+
+constexpr uint64_t kLoLimit = 1ULL << 62;   // lo nosi 62 bita (rand_b kod UUIDv7)
+
+struct IdState {
+    Xoshiro256 rng{threadSeed()};
+    uint64_t   ms{0};       // zadnja iskorištena ms (ne ide unazad ni kad sat ide)
+    uint16_t   hi{0};       // slučajni bitovi 79..64 (UUIDv7 rand_a = donjih 12)
+    uint64_t   lo{0};       // slučajni bitovi 61..0
+};
+
+const IdState& nextId() {
+    thread_local IdState st;
+    const uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    if (now > st.ms) {
+        st.ms = now;
+        st.hi = static_cast<uint16_t>(st.rng.next() >> 48);
+        st.lo = st.rng.next() >> 2;
+    } else if (++st.lo == kLoLimit) {
+        // Ista ms (ili sat unazad): nastavak niza; prenos u hi, a kad se i rand_a
+        // iscrpi, posuđuje se sljedeća ms
+        st.lo = 0;
+        if ((++st.hi & 0x0FFF) == 0) ++st.ms;
+    }
+    return st;
+}
+
+constexpr char kCrockford[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+constexpr char kHex[]       = "0123456789abcdef";
+
+} // namespace
+
+void Utils::formatULID(char* out) {
+    const IdState& id = nextId();
+    // 128 bita: ms(48) | hi(16) | 00 | lo(62); 26 znakova po 5 bita (prva dva bita nula)
+    unsigned __int128 v = (static_cast<unsigned __int128>(id.ms) << 80) |
+                          (static_cast<unsigned __int128>(id.hi) << 64) | id.lo;
+    for (int i = static_cast<int>(kUlidLength) - 1; i >= 0; --i) {
+        out[i] = kCrockford[static_cast<unsigned>(v & 31)];
+        v >>= 5;
+    }
+}
+
+void Utils::formatUUID(char* out) {
+    const IdState& id = nextId();
+    const uint16_t rand_a = id.hi & 0x0FFF;
+    uint8_t bytes[16];
+    for (int i = 0; i < 6; ++i) bytes[i] = static_cast<uint8_t>(id.ms >> (40 - 8 * i));
+    bytes[6] = static_cast<uint8_t>(0x70 | (rand_a >> 8));          // verzija 7
+    bytes[7] = static_cast<uint8_t>(rand_a);
+    bytes[8] = static_cast<uint8_t>(0x80 | ((id.lo >> 56) & 0x3F));  // varijanta 10
+    for (int i = 9; i < 16; ++i) bytes[i] = static_cast<uint8_t>(id.lo >> (8 * (15 - i)));
+
+    char* p = out;
+    for (int i = 0; i < 16; ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) *p++ = '-';
+        *p++ = kHex[bytes[i] >> 4];
+        *p++ = kHex[bytes[i] & 0x0F];
     }
-    
-    return ss.str();
+}
+
+std::string Utils::generateUUID() {
+    std::string uuid(kUuidLength, '\0');
+    formatUUID(&uuid[0]);
+    return uuid;
+}
+
+std::string Utils::generateULID() {
+    std::string ulid(kUlidLength, '\0');
+    formatULID(&ulid[0]);
+    return ulid;
+}
+
+std::string Utils::generateId(std::string_view prefix) {
+    std::string id(prefix.size() + kUlidLength, '\0');
+    std::memcpy(&id[0], prefix.data(), prefix.size());
+    formatULID(&id[prefix.size()]);
+    return id;
 }
 
 std::string Utils::getCurrentTimestamp() {
-    auto now = std::time(nullptr);
-    auto tm = *std::localtime(&now);
-    
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
+    return ClockService::timestamp();
 }
 
 } // namespace transport
@@ -0,0 +1,163 @@
+#include "common/VehicleStatus.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace transport {
+namespace vehicle_status {
+
+namespace {
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline bool getVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) return false;
+        const uint8_t b = in[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+inline void putShortString(std::vector<uint8_t>& out, const std::string& s) {
+    const size_t n = std::min<size_t>(s.size(), 255);
+    out.push_back(static_cast<uint8_t>(n));
+    out.insert(out.end(), s.begin(), s.begin() + static_cast<std::ptrdiff_t>(n));
+}
+
+inline bool getShortString(const std::vector<uint8_t>& in, size_t& pos, std::string& s) {
+    if (pos >= in.size()) return false;
+    const size_t n = in[pos++];
+    if (pos + n > in.size()) return false;
+    s.assign(reinterpret_cast<const char*>(in.data() + pos), n);
+    pos += n;
+    return true;
+}
+
+} // namespace
+
+void encodeRecords(const std::vector<VehicleStatusRecord>& records, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(1 + records.size() * 16);
+    putVarint(out, records.size());
+    for (const auto& r : records) {
+        putShortString(out, r.uri);
+        putShortString(out, r.route);
+        out.push_back(static_cast<uint8_t>(r.type));
+        out.push_back(r.active ? 1 : 0);
+        putVarint(out, static_cast<uint64_t>(std::max(0, r.capacity)));
+        putVarint(out, static_cast<uint64_t>(std::max(0, r.available)));
+        putVarint(out, r.version);
+    }
+}
+
+bool decodeRecords(const std::vector<uint8_t>& in, std::vector<VehicleStatusRecord>& records) {
+    records.clear();
+    if (in.empty()) return true;
+    size_t pos = 0;
+    uint64_t count = 0;
+    if (!getVarint(in, pos, count) || count > in.size()) return false;
+    records.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        VehicleStatusRecord r;
+        uint64_t cap = 0, avail = 0;
+        if (!getShortString(in, pos, r.uri) || !getShortString(in, pos, r.route)) return false;
+        if (pos + 2 > in.size()) return false;
+        r.type   = static_cast<VehicleType>(in[pos++]);
+        r.active = in[pos++] != 0;
+        if (!getVarint(in, pos, cap) || !getVarint(in, pos, avail) ||
+            !getVarint(in, pos, r.version)) return false;
+        r.capacity  = static_cast<int>(cap);
+        r.available = static_cast<int>(avail);
+        records.push_back(std::move(r));
+    }
+    return pos == in.size();
+}
+
+std::vector<std::string> parseRoutes(const std::string& csv) {
+    std::vector<std::string> routes;
+    if (csv.empty() || csv == "*") return routes;
+    std::istringstream is(csv);
+    std::string r;
+    while (std::getline(is, r, ',')) {
+        const auto first = r.find_first_not_of(" \t");
+        if (first == std::string::npos) continue;
+        r = r.substr(first, r.find_last_not_of(" \t") - first + 1);
+        if (std::find(routes.begin(), routes.end(), r) == routes.end()) routes.push_back(r);
+    }
+    return routes;
+}
+
+} // namespace vehicle_status
+
+bool VehicleStatusView::apply(const Message& status) {
+    if (status.getType() != MessageType::VEHICLE_STATUS) return false;
+    std::vector<VehicleStatusRecord> vehicles, removed;
+    if (!vehicle_status::decodeRecords(status.getBinary("vehicles"), vehicles) ||
+        !vehicle_status::decodeRecords(status.getBinary("removed"), removed)) {
+        return false;
+    }
+    const uint64_t version = std::strtoull(status.getString("version").c_str(), nullptr, 10);
+
+    if (status.getBool("full")) {
+        floor_        = std::max(floor_, version);
+        has_snapshot_ = true;
+        // Snapshot zamjenjuje sve što je starije od njega
+        for (auto it = vehicles_.begin(); it != vehicles_.end(); ) {
+            if (it->second.version <= version) it = vehicles_.erase(it);
+            else ++it;
+        }
+        for (auto it = removed_.begin(); it != removed_.end(); ) {
+            if (it->second <= version) it = removed_.erase(it);
+            else ++it;
+        }
+    }
+    for (auto& v : vehicles) {
+        auto gone = removed_.find(v.uri);
+        if (gone != removed_.end() && gone->second >= v.version) continue;
+        auto it = vehicles_.find(v.uri);
+        if (it != vehicles_.end() && it->second.version >= v.version) continue;
+        vehicles_[v.uri] = std::move(v);
+    }
+    for (const auto& r : removed) {
+        auto it = vehicles_.find(r.uri);
+        if (it != vehicles_.end() && it->second.version >= r.version) continue;
+        if (it != vehicles_.end()) vehicles_.erase(it);
+        removed_[r.uri] = std::max(removed_[r.uri], r.version);
+    }
+    version_ = std::max(version_, version);
+    return true;
+}
+
+VehicleStatusView::Delta VehicleStatusView::since(const std::vector<std::string>& routes,
+                                                  uint64_t since_version) const {
+    Delta d;
+    d.version = version_;
+    d.full    = since_version == 0 || since_version < floor_ || since_version > version_;
+    for (const auto& [uri, v] : vehicles_) {
+        if (!routes.empty() && std::find(routes.begin(), routes.end(), v.route) == routes.end()) continue;
+        if (d.full || v.version > since_version) d.vehicles.push_back(v);
+    }
+    if (!d.full) {
+        // Ruta obrisanog vozila nije poznata: klijent ignoriše URI koji nema
+        for (const auto& [uri, version] : removed_) {
+            if (version <= since_version) continue;
+            VehicleStatusRecord r;
+            r.uri     = uri;
+            r.version = version;
+            d.removed.push_back(std::move(r));
+        }
+    }
+    return d;
+}
+
+} // namespace transport
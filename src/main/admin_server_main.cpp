@@ -102,8 +102,16 @@ int main(int argc, char* argv[]) {
         logger->info("Key: " + key_file);
 
         // Create and configure server
-        server = std::make_unique<AdminServer>();
-        server->setCertificates(cert_file, key_file);
+        auto admin_server = std::make_unique<AdminServer>();
+        admin_server->setCertificates(cert_file, key_file);
+        {
+            // host:port centralnog servera kome se prosljeđuju admin izmjene
+            const auto colon = central_server.rfind(':');
+            const std::string host = colon == std::string::npos ? central_server : central_server.substr(0, colon);
+            const int central_port = colon == std::string::npos ? 8080 : std::stoi(central_server.substr(colon + 1));
+            admin_server->setCentralServer(host, central_port);
+        }
+        server = std::move(admin_server);
         
         if (verbose) {
             server->setLogLevel(Logger::LogLevel::DEBUG);
@@ -127,7 +135,7 @@ int main(int argc, char* argv[]) {
 
         logger->info("Admin Server started successfully");
         std::cout << "Admin Server is running on port " << port << std::endl;
-        std::cout << "Connected to Central Server: " << central_server << std::endl;
+        std::cout << "Relaying admin updates to Central Server: " << central_server << std::endl;
         std::cout << "Press Ctrl+C to stop the server" << std::endl;
 
         // Keep the server running
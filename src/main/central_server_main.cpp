@@ -32,6 +32,7 @@ void printUsage(const char* program_name) {
               << "  --mcast on|off           Enable UDP multicast DISCOVER/ANNOUNCE (default: off)\n"
               << "  --maddr <ip>             Multicast address (default: 239.192.0.1)\n"
               << "  --mport <port>           Multicast port    (default: 30001)\n"
+              << "  --mcast-data on|off      Send seat/ticket/price updates as signed UDP datagrams (needs --mcast on)\n"
               << "  -h, --help               Show this help message\n";
 }
 
@@ -49,6 +50,7 @@ int main(int argc, char* argv[]) {
     bool        mcast_on  = false;
     std::string mcast_addr = "239.192.0.1";
     int         mcast_port = 30001;
+    bool        mcast_data = false;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -81,6 +83,11 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc) mcast_addr = argv[++i];
         } else if (arg == "--mport") {
             if (i + 1 < argc) mcast_port = std::stoi(argv[++i]);
+        } else if (arg == "--mcast-data") {
+            if (i + 1 < argc) {
+                std::string v = argv[++i];
+                mcast_data = (v == "on" || v == "ON" || v == "1" || v == "true");
+            }
         }
     }
 
@@ -110,6 +117,7 @@ int main(int argc, char* argv[]) {
         server->setMulticastEnabled(mcast_on);
         server->setMulticastAddress(mcast_addr);
         server->setMulticastPort(mcast_port);
+        server->setMulticastDataPlane(mcast_data);
         
         if (verbose) {
             server->setLogLevel(Logger::LogLevel::DEBUG);
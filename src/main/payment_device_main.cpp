@@ -16,6 +16,7 @@ void printUsage(const char* program_name) {
     std::cout << "  -s, --server <address>   Vehicle server address (default: localhost)" << std::endl;
     std::cout << "  -p, --port <port>        Vehicle server port (default: 8081)" << std::endl;
     std::cout << "  --ca <file>              CA certificate file" << std::endl;
+    std::cout << "  --queue <file>           Offline purchase queue (default: payment_device.queue)" << std::endl;
     std::cout << "  -l, --log <file>         Log file path" << std::endl;
     std::cout << "  -v, --verbose            Enable verbose logging" << std::endl;
     std::cout << "  -h, --help               Show this help message" << std::endl;
@@ -28,6 +29,7 @@ int main(int argc, char* argv[]) {
     std::string server_address = "localhost";
     int port = 8081;
     std::string ca_file = "certs/ca.crt";
+    std::string queue_file = "payment_device.queue";
     std::string log_file = "logs/payment_device.log";
     bool verbose = false;
 
@@ -64,6 +66,11 @@ int main(int argc, char* argv[]) {
                 ca_file = argv[++i];
             }
         }
+        else if (arg == "--queue") {
+            if (i + 1 < argc) {
+                queue_file = argv[++i];
+            }
+        }
         else if (arg == "-l" || arg == "--log") {
             if (i + 1 < argc) {
                 log_file = argv[++i];
@@ -86,6 +93,11 @@ int main(int argc, char* argv[]) {
 
         // Create payment device
         auto device = std::make_unique<PaymentDevice>();
+        device->setDeviceUri(device_uri);
+        // Kupovine bez veze čekaju u redu i šalju se nakon ponovnog spajanja
+        if (!device->enableOfflineQueue(queue_file)) {
+            logger->warning("Offline queue disabled (" + queue_file + ")");
+        }
 
         // Connect to vehicle server
         logger->info("Connecting to vehicle server...");
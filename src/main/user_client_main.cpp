@@ -3,6 +3,7 @@
 #include <memory>
 #include "client/UserInterface.h"
 #include "common/Logger.h"
+#include "common/Tracing.h"
 
 using namespace transport;
 
@@ -15,6 +16,8 @@ void printUsage(const char* program_name) {
     std::cout << "  --ca <file>              CA certificate file (default: certs/ca.crt)\n";
     std::cout << "  -a, --discover           Use multicast auto-discovery (server='auto')\n";
     std::cout << "  -l, --log <file>         Log file path (default: logs/user_client.log)\n";
+    std::cout << "  --trace <file>           Export request spans to file (binary, see Tracing.h)\n";
+    std::cout << "  --trace-sample <rate>    Fraction of requests traced, 0..1 (default: 1)\n";
     std::cout << "  -v, --verbose            Enable verbose logging\n";
     std::cout << "  -h, --help               Show this help message\n";
 }
@@ -28,6 +31,8 @@ int main(int argc, char* argv[]) {
     std::string log_file       = "logs/user_client.log";
     bool        verbose        = false;
     bool        discover       = false;
+    std::string trace_file;
+    double      trace_sample   = 1.0;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -46,6 +51,10 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc) ca_file = argv[++i];
         } else if (arg == "-l" || arg == "--log") {
             if (i + 1 < argc) log_file = argv[++i];
+        } else if (arg == "--trace") {
+            if (i + 1 < argc) trace_file = argv[++i];
+        } else if (arg == "--trace-sample") {
+            if (i + 1 < argc) trace_sample = std::stod(argv[++i]);
         } else if (arg == "-v" || arg == "--verbose") {
             verbose = true;
         } else if (arg == "-a" || arg == "--discover") {
@@ -58,6 +67,16 @@ int main(int argc, char* argv[]) {
         auto logger = Logger::getLogger("UserClient");
         logger->initialize(log_file, verbose ? Logger::LogLevel::DEBUG : Logger::LogLevel::INFO);
         
+        if (!trace_file.empty()) {
+            tracing::Tracer::Options trace_opt;
+            trace_opt.service     = "user_client";
+            trace_opt.export_path = trace_file;
+            trace_opt.sample_rate = trace_sample;
+            if (!tracing::Tracer::instance().configure(trace_opt)) {
+                logger->warning("Could not open trace file: " + trace_file);
+            }
+        }
+
         if (discover) {
             server_address = "auto"; // UserInterface::connect() će pokrenuti multicast DISCOVER
         }
@@ -95,6 +114,7 @@ int main(int argc, char* argv[]) {
         std::cout << "\n=== Public Transport System Client ===\n";
         std::cout << "Type 'help' for available commands or 'quit' to exit\n";
         ui->startInteractiveSession();
+        tracing::Tracer::instance().shutdown();
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -109,8 +109,16 @@ int main(int argc, char* argv[]) {
         logger->info("Key: " + key_file);
 
         // Create and configure server (using VehicleServer)
-        server = std::make_unique<VehicleServer>();
-        server->setCertificates(cert_file, key_file);
+        auto vehicle_server = std::make_unique<VehicleServer>();
+        vehicle_server->setCertificates(cert_file, key_file);
+        {
+            // host:port centralnog servera za trajnu edge vezu
+            const auto colon = central_server.rfind(':');
+            const std::string host = colon == std::string::npos ? central_server : central_server.substr(0, colon);
+            const int central_port = colon == std::string::npos ? 8080 : std::stoi(central_server.substr(colon + 1));
+            vehicle_server->setCentralServer(host, central_port);
+        }
+        server = std::move(vehicle_server);
         
         if (verbose) {
             server->setLogLevel(Logger::LogLevel::DEBUG);
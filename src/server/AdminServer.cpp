@@ -2,6 +2,7 @@
 #include "common/Message.h"
 #include "common/Logger.h"
 
+#include <algorithm>
 #include <thread>
 #include <utility>
 #include <chrono>
@@ -10,29 +11,49 @@ namespace transport {
 
 AdminServer::AdminServer() : ServerBase("AdminServer") {}
 
-bool AdminServer::start(int port, const std::string& /* config_file */) {
-    port_ = port;
-
-    // TLS server — koristi infrastrukturu na Boost.Asio (TLSServer/TLSSocket)
-    tls_server_ = std::make_unique<TLSServer>();
-
-    tls_server_->setConnectionCallback([this](std::unique_ptr<TLSSocket> client) {
-        std::thread([this, c = std::move(client)]() mutable {
-            handleClientMessage(std::move(c), nullptr);
-        }).detach();
-    });
+AdminServer::~AdminServer() { stop(); }
 
-    if (!tls_server_->start(port_, cert_file_, key_file_)) {
+bool AdminServer::start(int port, const std::string& config_file) {
+    port_ = port;
+    if (!config_file.empty()) {
+        loadConfiguration(config_file);
+    }
+    const auto& cfg = getConfig();
+    if (central_host_.empty()) central_host_ = cfg.getString("admin", "central_host", "localhost");
+    if (central_port_ <= 0)    central_port_ = cfg.getInt("admin", "central_port", 8080);
+    max_bulk_items_ = std::max(1, cfg.getInt("admin", "max_bulk_items", max_bulk_items_));
+    relay_timeout_ms_ = std::max(0, cfg.getInt("admin", "relay_timeout_ms", relay_timeout_ms_));
+    if (admin_key_.empty()) admin_key_ = cfg.getString("admin", "admin_key", "");
+
+    // TLS server — zajednička ServerBase infrastruktura (thread-per-connection ili worker pool)
+    running_ = true;
+    if (!startServer()) {
+        running_ = false;
         logError("AdminServer: failed to start TLS server on port " + std::to_string(port_));
         return false;
     }
 
-    running_ = true;
     start_time_ = std::chrono::system_clock::now();
-    logInfo("Admin Server started on port " + std::to_string(port_));
+    logInfo("Admin Server started on port " + std::to_string(port_) + " (central server " +
+            central_host_ + ":" + std::to_string(central_port_) + ")");
     return true;
 }
 
+void AdminServer::stop() {
+    ServerBase::stop();
+    std::lock_guard<std::mutex> lk(upstream_mutex_);
+    if (upstream_) upstream_->close();
+    upstream_.reset();
+}
+
+AdminServer::RelayStats AdminServer::getRelayStats() const {
+    RelayStats s;
+    s.relayed     = relayed_.load();
+    s.rejected    = rejected_.load();
+    s.unavailable = unavailable_.load();
+    return s;
+}
+
 void AdminServer::handleClientMessage(std::unique_ptr<TLSSocket> client,
                                       std::unique_ptr<Message> /* message */) {
     if (!client) return;
@@ -44,22 +65,97 @@ void AdminServer::handleClientMessage(std::unique_ptr<TLSSocket> client,
             + ":" + std::to_string(client->getPeerPort()));
 
     // Ostavljen blokirajući tok 
+    TrackedConnection tracked(*this, client.get());
     while (running_ && client) {
         auto received = client->receiveMessage();  // blokirajuće čitanje kroz TLS
         if (!received) break;
         logDebug("[AdminServer] processing incoming message");
-        processMessage(std::move(received), client);
+        RequestScope scope(received->getSequenceId());
+        auto ticket = admitRequest(*received, client);
+        if (ticket) processMessage(std::move(received), client);
     }
 
     active_connections_--;
     logInfo("[AdminServer] client disconnected");
 }
 
-void AdminServer::processMessage(std::unique_ptr<Message> /* message */,
-                                 std::unique_ptr<TLSSocket>& /* client */) {
+void AdminServer::processMessage(std::unique_ptr<Message> message,
+                                 std::unique_ptr<TLSSocket>& client) {
+    if (!message || !client) return;
+
+    switch (message->getType()) {
+        case MessageType::CONNECT_REQUEST:
+            acceptConnect(message->getString("protocol_version"), client);
+            return;
+        case MessageType::HEARTBEAT:
+            sendSuccessResponse(client, "alive");
+            return;
+        case MessageType::BULK_UPDATE_VEHICLES:
+        case MessageType::BULK_UPDATE_PRICES:
+            // Preveliki batch se odbija ovdje, bez zauzimanja veze prema centralnom serveru
+            if (message->getInt("count") > max_bulk_items_) {
+                rejected_++;
+                logWarning("[AdminServer] bulk update too large: " + std::to_string(message->getInt("count")));
+                return sendErrorResponse(client, "Too many items (max " + std::to_string(max_bulk_items_) + ")", 413);
+            }
+            break;
+        case MessageType::LIST_RECORDS:
+            // Centralni server izvozi zapise samo uz admin ključ; klijent ga ne zna
+            message->addString("admin_key", admin_key_);
+            message->calculateChecksum();
+            break;
+        case MessageType::UPDATE_PRICE:
+        case MessageType::UPDATE_VEHICLE:
+        case MessageType::UPDATE_CAPACITY:
+        case MessageType::GET_PRICES:
+        case MessageType::GET_STATS:
+            break;
+        default:
+            rejected_++;
+            logWarning(std::string("[AdminServer] not an admin operation: ") +
+                       std::to_string(static_cast<int>(message->getType())));
+            return sendErrorResponse(client, "Not an admin operation", 403);
+    }
+
+    auto reply = relayToCentral(*message);
+    if (!reply) {
+        unavailable_++;
+        logError("[AdminServer] central server " + central_host_ + ":" + std::to_string(central_port_) +
+                 " unavailable");
+        return sendErrorResponse(client, "Central server unavailable", 502);
+    }
+    relayed_++;
+    sendResponse(client, std::move(reply));
+}
 
-    logDebug("[AdminServer] received message (stub)");
+std::unique_ptr<Message> AdminServer::relayToCentral(const Message& request) {
+    std::lock_guard<std::mutex> lk(upstream_mutex_);
+    // Drugi pokušaj samo na novoj vezi (npr. centralni server restartovan); admin izmjene
+    // postavljaju vrijednosti, pa ponovljen zahtjev daje isto stanje
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!upstream_) {
+            // Čeka se pod upstream_mutex_: rok, da zaglavljen centralni server ne blokira
+            // sve admin konekcije (rok važi za čitanje preko executor-a -> enableFullDuplex)
+            auto sock = std::make_unique<TLSSocket>();
+            SocketOptions options;
+            options.receive_timeout_ms = relay_timeout_ms_;
+            sock->setSocketOptions(options);
+            if (!sock->connect(central_host_, central_port_) || !sock->enableFullDuplex()) return nullptr;
+            upstream_ = std::move(sock);
+        }
+        if (upstream_->sendMessage(request)) {
+            // Veza nije prijavljena pa broadcast ne stiže, ali ga svejedno ne vraćaj kao odgovor
+            auto reply = upstream_->receiveMessage();
+            while (reply && reply->getType() == MessageType::MULTICAST_UPDATE) reply = upstream_->receiveMessage();
+            if (reply) return reply;
+        }
+        // Istekao rok: zahtjev je možda još u obradi, ne šalje se ponovo
+        const bool timed_out = upstream_->getLastError().find("receive timeout") != std::string::npos;
+        upstream_->close();
+        upstream_.reset();
+        if (timed_out) return nullptr;
+    }
+    return nullptr;
 }
 
 } // namespace transport
-
@@ -0,0 +1,116 @@
+#include "server/AdmissionControl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace transport {
+
+AdmissionControl::Ticket& AdmissionControl::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        reset();
+        owner_          = other.owner_;
+        admitted_       = other.admitted_;
+        other.owner_    = nullptr;
+        other.admitted_ = false;
+    }
+    return *this;
+}
+
+void AdmissionControl::Ticket::reset() {
+    if (owner_) owner_->inflight_.fetch_sub(1, std::memory_order_relaxed);
+    owner_    = nullptr;
+    admitted_ = false;
+}
+
+void AdmissionControl::configure(const Options& options) {
+    options_   = options;
+    capacity_  = options_.burst > 0.0 ? options_.burst : std::max(1.0, options_.rate);
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        shard.buckets.clear();
+        shard.lru.clear();
+    }
+}
+
+AdmissionControl::Ticket AdmissionControl::admit(std::string_view key, Decision& decision,
+                                                 uint32_t& retry_after_ms, Clock::time_point now) {
+    Ticket ticket;
+    retry_after_ms = 0;
+    if (options_.rate > 0.0 && !key.empty() && !take(key, now, retry_after_ms)) {
+        rate_limited_.fetch_add(1, std::memory_order_relaxed);
+        decision = Decision::RATE_LIMITED;
+        return ticket;
+    }
+    if (options_.max_inflight > 0) {
+        // Rezervacija pa provjera: bez CAS petlje, prekoračenje se odmah vraća
+        if (inflight_.fetch_add(1, std::memory_order_relaxed) >= options_.max_inflight) {
+            inflight_.fetch_sub(1, std::memory_order_relaxed);
+            overloaded_.fetch_add(1, std::memory_order_relaxed);
+            decision       = Decision::OVERLOADED;
+            retry_after_ms = options_.retry_after_ms;
+            return ticket;
+        }
+        ticket.owner_ = this;
+    }
+    admitted_.fetch_add(1, std::memory_order_relaxed);
+    ticket.admitted_ = true;
+    decision         = Decision::ADMIT;
+    return ticket;
+}
+
+AdmissionControl::Ticket AdmissionControl::bypass() {
+    Ticket ticket;
+    ticket.admitted_ = true;
+    return ticket;
+}
+
+bool AdmissionControl::take(std::string_view key, Clock::time_point now, uint32_t& retry_after_ms) {
+    Shard& shard = shards_[std::hash<std::string_view>{}(key) % kShards];
+    std::lock_guard<std::mutex> lk(shard.mutex);
+
+    auto it = shard.buckets.find(std::string(key));
+    if (it == shard.buckets.end()) {
+        if (shard.buckets.size() >= std::max<size_t>(1, options_.max_tracked_keys / kShards)) evictOldest(shard);
+        it = shard.buckets.emplace(std::string(key), Bucket{capacity_, now, {}}).first;
+        shard.lru.push_front(&it->first);
+        it->second.lru = shard.lru.begin();
+    } else {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+        const double elapsed = std::chrono::duration<double>(now - it->second.updated).count();
+        if (elapsed > 0.0) {
+            it->second.tokens  = std::min(capacity_, it->second.tokens + elapsed * options_.rate);
+            it->second.updated = now;
+        }
+    }
+
+    if (it->second.tokens >= 1.0) {
+        it->second.tokens -= 1.0;
+        return true;
+    }
+    retry_after_ms = static_cast<uint32_t>(std::ceil((1.0 - it->second.tokens) / options_.rate * 1000.0));
+    return false;
+}
+
+void AdmissionControl::evictOldest(Shard& shard) {
+    // Najdavnije korišteni bucket je najbliži punom (isto kao novi klijent)
+    if (shard.lru.empty()) return;
+    auto victim = shard.buckets.find(*shard.lru.back());
+    shard.lru.pop_back();
+    shard.buckets.erase(victim);
+}
+
+AdmissionControl::Stats AdmissionControl::getStats() const {
+    Stats s;
+    s.admitted     = admitted_.load(std::memory_order_relaxed);
+    s.rate_limited = rate_limited_.load(std::memory_order_relaxed);
+    s.overloaded   = overloaded_.load(std::memory_order_relaxed);
+    s.inflight     = inflight_.load(std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lk(shard.mutex);
+        s.tracked_keys += shard.buckets.size();
+    }
+    return s;
+}
+
+} // namespace transport
@@ -0,0 +1,286 @@
+#include "server/BroadcastHub.h"
+#include "common/TLSSocket.h"
+#include "common/Metrics.h"
+
+#include <algorithm>
+
+namespace transport {
+
+BroadcastHub::BroadcastHub() : BroadcastHub(Options{}) {}
+
+BroadcastHub::BroadcastHub(Options options)
+    : options_(options),
+      delivery_latency_(&metrics::Registry::instance().histogram(
+          "tp_broadcast_delivery_seconds", "", "Broadcast update time from publish() to send on a subscriber socket")),
+      send_latency_(&metrics::Registry::instance().histogram(
+          "tp_broadcast_send_seconds", "", "Time spent writing one batch of broadcast frames to a subscriber")),
+      queue_depth_(&metrics::Registry::instance().histogram(
+          "tp_broadcast_queue_depth", "", "Subscriber queue length after enqueue", 1.0)) {
+    if (options_.queue_limit == 0) options_.queue_limit = 1;
+    if (options_.max_batch == 0) options_.max_batch = 1;
+}
+
+BroadcastHub::~BroadcastHub() {
+    stop();
+}
+
+void BroadcastHub::setOptions(Options options) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    options_ = options;
+    if (options_.queue_limit == 0) options_.queue_limit = 1;
+    if (options_.max_batch == 0) options_.max_batch = 1;
+}
+
+void BroadcastHub::start() {
+    if (running_.exchange(true)) return;
+    lifeline_ = std::make_shared<Lifeline>();
+    lifeline_->hub = this;
+    thread_ = std::make_unique<std::thread>(&BroadcastHub::publisherLoop, this);
+}
+
+void BroadcastHub::stop() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!running_.exchange(false)) return;
+    }
+    cv_.notify_all();
+    if (thread_ && thread_->joinable()) thread_->join();
+    thread_.reset();
+    if (lifeline_) {
+        // Poslije ovoga completion-i upisa u letu više ne diraju hub
+        std::lock_guard<std::mutex> lk(lifeline_->mutex);
+        lifeline_->hub = nullptr;
+    }
+    lifeline_.reset();
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto& kv : subscribers_) {
+        kv.second->queue.clear();
+        kv.second->scheduled = false;
+    }
+    ready_.clear();
+    in_flight_ = 0;
+    idle_cv_.notify_all();
+}
+
+void BroadcastHub::subscribe(TLSSocket* socket, const std::string& topic) {
+    if (!socket) return;
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto& sub = subscribers_[socket];
+    if (!sub || sub->dropped) {
+        sub = std::make_shared<Subscriber>();
+        sub->socket = socket;
+        sub->async  = socket->usesAsyncIo();
+    }
+    sub->topics.insert(topic);              // ponovna prijava na istu temu ne mijenja ništa
+}
+
+void BroadcastHub::unsubscribe(TLSSocket* socket) {
+    std::shared_ptr<Subscriber> sub;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = subscribers_.find(socket);
+        if (it == subscribers_.end()) return;
+        sub = std::move(it->second);
+        subscribers_.erase(it);
+        sub->queue.clear();
+        sub->dropped = true;
+    }
+    // Sačekaj slanje u toku (ako ga ima); poslije ovoga socket se više ne koristi
+    std::lock_guard<std::mutex> send_lk(sub->send_mutex);
+    sub->alive = false;
+}
+
+void BroadcastHub::dropLocked(Subscriber& sub) {
+    // Ostaje u mapi dok ne stigne unsubscribe (on sinhronizuje sa slanjem u toku)
+    sub.queue.clear();
+    sub.dropped = true;
+    dropped_++;
+}
+
+void BroadcastHub::publish(std::unique_ptr<Message> update, std::string coalesce_key,
+                           const std::string& topic) {
+    if (!update) return;
+    update->finalize();   // okvir se gradi kasnije na publisher niti; checksum jednom, prije dijeljenja
+    auto shared = std::make_shared<Update>();
+    shared->message = std::move(update);
+    shared->key     = std::move(coalesce_key);
+    shared->published_at = std::chrono::steady_clock::now();
+    published_++;
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        for (auto& kv : subscribers_) {
+            Subscriber& sub = *kv.second;
+            if (sub.dropped || !sub.topics.count(topic)) continue;
+
+            if (options_.coalesce && !shared->key.empty()) {
+                auto it = std::find_if(sub.queue.begin(), sub.queue.end(),
+                    [&](const std::shared_ptr<Update>& u) { return u->key == shared->key; });
+                if (it != sub.queue.end()) {
+                    *it = shared;           // novije stanje vozila, isto mjesto u redu
+                    coalesced_++;
+                    continue;
+                }
+            }
+            if (sub.queue.size() >= options_.queue_limit) {
+                dropLocked(sub);
+                continue;
+            }
+            sub.queue.push_back(shared);
+            queue_depth_->record(sub.queue.size());
+            if (!sub.scheduled) {
+                sub.scheduled = true;
+                ready_.push_back(kv.second);
+                wake = true;
+            }
+        }
+    }
+    if (wake) cv_.notify_one();
+}
+
+const std::vector<uint8_t>& BroadcastHub::frameFor(Update& update, uint16_t version) {
+    if (version < PROTOCOL_V1 || version > PROTOCOL_MAX_VERSION) version = PROTOCOL_V1;
+    auto& frame = update.frames[version];
+    if (!frame) {
+        auto bytes = std::make_shared<std::vector<uint8_t>>();
+        update.message->serializeTo(*bytes, version);
+        frame = std::move(bytes);
+    }
+    return *frame;
+}
+
+void BroadcastHub::publisherLoop() {
+    std::vector<std::shared_ptr<Update>>   batch;
+    std::vector<boost::asio::const_buffer> frames;
+    while (true) {
+        std::shared_ptr<Subscriber> sub;
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            cv_.wait(lk, [&]{ return !running_ || !ready_.empty(); });
+            if (!running_) return;
+
+            sub = std::move(ready_.front());
+            ready_.pop_front();
+            if (sub->dropped || sub->queue.empty()) {
+                sub->scheduled = false;
+                if (ready_.empty() && in_flight_ == 0) idle_cv_.notify_all();
+                continue;
+            }
+            // Ono što čeka kod pretplatnika (do max_batch) jednim upisom, pa sljedeći (round-robin)
+            const size_t n = std::min(sub->queue.size(), options_.max_batch);
+            for (size_t i = 0; i < n; ++i) {
+                batch.push_back(std::move(sub->queue.front()));
+                sub->queue.pop_front();
+            }
+            // Async pretplatnik ostaje "scheduled" dok upis ne završi (completion ga vraća u ready_)
+            if (sub->async) sub->scheduled = true;
+            else if (sub->queue.empty()) sub->scheduled = false;
+            else ready_.push_back(sub);
+            in_flight_++;
+        }
+
+        bool sent    = false;
+        bool pending = false;
+        const auto started = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> send_lk(sub->send_mutex);
+            if (sub->alive) {
+                const uint16_t version = sub->socket->getProtocolVersion();
+                frames.clear();
+                for (auto& update : batch) {
+                    const auto& frame = frameFor(*update, version);
+                    frames.emplace_back(frame.data(), frame.size());
+                }
+                if (sub->async) {
+                    // Okviri se kopiraju u red socketa; upis radi strand sesije
+                    auto lifeline = lifeline_;
+                    pending = sub->socket->asyncSendFrames(frames.data(), frames.size(),
+                        [lifeline, sub, sent_batch = batch, started](bool ok) {
+                            std::lock_guard<std::mutex> lk(lifeline->mutex);
+                            if (lifeline->hub) lifeline->hub->finishSend(sub, sent_batch, ok, started);
+                        });
+                } else {
+                    sent = sub->socket->sendFrames(frames.data(), frames.size());
+                }
+            }
+        }
+        if (!pending) finishSend(sub, batch, sent, started);
+    }
+}
+
+void BroadcastHub::finishSend(const std::shared_ptr<Subscriber>& sub, const std::vector<std::shared_ptr<Update>>& batch,
+                              bool sent, std::chrono::steady_clock::time_point started) {
+    if (sent && metrics::Registry::instance().enabled()) {
+        send_latency_->record(metrics::ScopedTimer::elapsedNanos(started));
+        for (const auto& update : batch) {
+            delivery_latency_->record(metrics::ScopedTimer::elapsedNanos(update->published_at));
+        }
+    }
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (in_flight_ > 0) in_flight_--;
+        if (sent) {
+            delivered_ += batch.size();
+            send_batches_++;
+        } else if (!sub->dropped) {
+            send_failures_++;
+            dropLocked(*sub);
+        }
+        if (sub->async) {
+            if (running_ && !sub->dropped && !sub->queue.empty()) {
+                ready_.push_back(sub);
+                wake = true;
+            } else {
+                sub->scheduled = false;
+            }
+        }
+        if (ready_.empty() && in_flight_ == 0) idle_cv_.notify_all();
+    }
+    if (wake) cv_.notify_one();
+}
+
+bool BroadcastHub::waitIdle(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lk(mutex_);
+    return idle_cv_.wait_for(lk, timeout, [&]{ return ready_.empty() && in_flight_ == 0; });
+}
+
+BroadcastHub::Stats BroadcastHub::getStats() const {
+    Stats s;
+    s.published           = published_;
+    s.delivered           = delivered_;
+    s.coalesced           = coalesced_;
+    s.dropped_subscribers = dropped_;
+    s.send_failures       = send_failures_;
+    s.send_batches        = send_batches_;
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& kv : subscribers_) {
+        if (kv.second->dropped) continue;
+        s.subscribers++;
+        s.queued += kv.second->queue.size();
+        s.max_queue_depth = std::max(s.max_queue_depth, kv.second->queue.size());
+    }
+    return s;
+}
+
+std::vector<std::string> BroadcastHub::activeTopics() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::set<std::string> topics;
+    for (const auto& kv : subscribers_) {
+        if (!kv.second->dropped) topics.insert(kv.second->topics.begin(), kv.second->topics.end());
+    }
+    return {topics.begin(), topics.end()};
+}
+
+size_t BroadcastHub::subscriberCount() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    size_t n = 0;
+    for (const auto& kv : subscribers_) if (!kv.second->dropped) ++n;
+    return n;
+}
+
+} // namespace transport
@@ -1,12 +1,21 @@
 #include "server/CentralServer.h"
+#include "common/BufferPool.h"
+#include "common/ClockService.h"
 #include "common/Logger.h"
 #include "common/Message.h"  // MessageType / MessageFactory
+#include "common/McastDatagram.h"
+#include "common/Utils.h"
+#include "common/VehicleStatus.h"
+
 
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <iomanip>
 #include <ctime>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
 #include <algorithm>
 #include <sstream>
 #include <atomic>
@@ -23,17 +32,11 @@ namespace {
 // Default multicast
 static constexpr const char*    DEFAULT_MCAST_ADDR = "239.192.0.1";
 static constexpr unsigned short DEFAULT_MCAST_PORT = 30001;
-
-// Thread-safe lokalno vrijeme → std::tm
-inline std::tm localtime_safe(std::time_t t) {
-    std::tm tm{};
-#if defined(_WIN32)
-    localtime_s(&tm, &t);
-#else
-    localtime_r(&t, &tm);
-#endif
-    return tm;
-}
+// V1 klijenti ne dobijaju data plane: datagram ažuriranja im idu preko TLS-a na ovoj temi
+const std::string kDatagramFallbackTopic = "datagram:tls";
+// Zapis je u dnevniku ali commit nije potvrđen (EventJournal::failed): ishod odlučuje oporavak,
+// klijent ponavlja sa istim idempotency_key (za razliku od 503 = ništa nije zapisano)
+constexpr int kOutcomeUnknown = 504;
 
 // --- Helpers za log ---
 
@@ -60,7 +63,19 @@ inline const char* messageTypeToString(MessageType t) {
         case MessageType::UPDATE_PRICE:         return "UPDATE_PRICE";
         case MessageType::UPDATE_VEHICLE:       return "UPDATE_VEHICLE";
         case MessageType::UPDATE_CAPACITY:      return "UPDATE_CAPACITY";
+        case MessageType::MCAST_RESYNC:         return "MCAST_RESYNC";
+        case MessageType::VEHICLE_STATUS:       return "VEHICLE_STATUS";
+        case MessageType::BATCH:                return "BATCH";
+        case MessageType::REPLICA_SYNC:         return "REPLICA_SYNC";
+        case MessageType::REPLICA_BATCH:        return "REPLICA_BATCH";
+        case MessageType::GET_PRICES:           return "GET_PRICES";
+        case MessageType::BULK_UPDATE_VEHICLES: return "BULK_UPDATE_VEHICLES";
+        case MessageType::BULK_UPDATE_PRICES:   return "BULK_UPDATE_PRICES";
+        case MessageType::GET_STATS:            return "GET_STATS";
+        case MessageType::LIST_RECORDS:         return "LIST_RECORDS";
+        case MessageType::VEHICLE_TELEMETRY:    return "VEHICLE_TELEMETRY";
         case MessageType::ADD_MEMBER_TO_GROUP:  return "ADD_MEMBER_TO_GROUP";
+        case MessageType::ADD_MEMBERS_TO_GROUP: return "ADD_MEMBERS_TO_GROUP";
         default:                                return "<unknown>";
     }
 }
@@ -96,10 +111,31 @@ CentralServer::CentralServer()
     config_.max_connections          = 1000;
     config_.heartbeat_interval       = 30;
     config_.session_timeout          = 3600;
-    config_.data_collection_interval = 60;
     config_.enable_multicast         = false; 
     config_.multicast_address        = DEFAULT_MCAST_ADDR;
     config_.multicast_port           = DEFAULT_MCAST_PORT;
+
+    // Histogram po tipu zahtjeva koji centralni server obrađuje; ostali tipovi dijele "OTHER"
+    auto& registry = metrics::Registry::instance();
+    const char* help = "CentralServer request handling time by message type";
+    for (MessageType mt : {MessageType::CONNECT_REQUEST, MessageType::AUTH_REQUEST, MessageType::REGISTER_USER,
+                           MessageType::REGISTER_DEVICE, MessageType::RESERVE_SEAT, MessageType::PURCHASE_TICKET,
+                           MessageType::CREATE_GROUP, MessageType::DELETE_USER, MessageType::DELETE_GROUP_MEMBER,
+                           MessageType::ADD_MEMBER_TO_GROUP, MessageType::ADD_MEMBERS_TO_GROUP,
+                           MessageType::GET_VEHICLE_STATUS,
+                           MessageType::UPDATE_PRICE, MessageType::UPDATE_VEHICLE, MessageType::UPDATE_CAPACITY,
+                           MessageType::BULK_UPDATE_VEHICLES, MessageType::BULK_UPDATE_PRICES,
+                           MessageType::MCAST_RESYNC, MessageType::BATCH, MessageType::GET_PRICES,
+                           MessageType::GET_STATS, MessageType::LIST_RECORDS, MessageType::VEHICLE_TELEMETRY}) {
+        handler_latency_[static_cast<uint16_t>(mt)] = &registry.histogram(
+            "tp_handler_seconds", std::string("type=\"") + messageTypeToString(mt) + "\"", help);
+    }
+    handler_other_ = &registry.histogram("tp_handler_seconds", "type=\"OTHER\"", help);
+}
+
+LatencyHistogram* CentralServer::handlerHistogram(MessageType type) const {
+    auto it = handler_latency_.find(static_cast<uint16_t>(type));
+    return it != handler_latency_.end() ? it->second : handler_other_;
 }
 
 CentralServer::~CentralServer() {
@@ -115,15 +151,44 @@ bool CentralServer::start(int port, const std::string& config_file) {
         logError("Failed to initialize database");
         return false;
     }
-
-    // TLS server
-    tls_server_ = std::make_unique<TLSServer>();
-    tls_server_->setConnectionCallback([this](std::unique_ptr<TLSSocket> client) {
-        std::thread([this, c = std::move(client)]() mutable {
-            handleClientMessage(std::move(c), nullptr);
-        }).detach();
+    StateSnapshot::Data snapshot;
+    const bool warm = config_.snapshot_enabled && readSnapshot(snapshot);
+    {
+        auto db = DatabasePool::getInstance().acquire();
+        // Inventar iz clean snimka samo ako baza od upisa nije dobila/izgubila vozila
+        bool from_snapshot = false;
+        if (warm && snapshot.clean && db) {
+            size_t rows = 0;
+            int64_t max_rowid = 0;
+            from_snapshot = db->getVehicleTableStats(rows, max_rowid) && rows == snapshot.vehicles.size() &&
+                            max_rowid == snapshot.vehicles_max_rowid;
+            if (!from_snapshot) logWarning("State snapshot vehicles do not match database; inventory from database");
+        }
+        if (from_snapshot) {
+            const size_t n = seat_inventory_.load(snapshot.vehicles);
+            logInfo("Seat inventory loaded from snapshot: " + std::to_string(n) + " vehicles");
+        } else {
+            const size_t n = db ? seat_inventory_.load(*db) : 0;
+            logInfo("Seat inventory loaded: " + std::to_string(n) + " vehicles");
+        }
+        if (db) loadPrices(*db);
+    }
+    if (warm) warmFromSnapshot(snapshot);
+    telemetry_.start([this](const std::string& uri) -> std::optional<TelemetryAggregator::VehicleInfo> {
+        auto v = seat_inventory_.find(uri);
+        if (!v) return std::nullopt;
+        return TelemetryAggregator::VehicleInfo{v->route, v->capacity};
     });
-    if (!tls_server_->start(port, cert_file_, key_file_)) {
+    if (config_.journal_enabled && !openJournal()) {
+        journal_.close();
+        logError("Failed to open event journal " + config_.journal_path);
+        return false;
+    }
+
+    // TLS server (thread-per-connection ili worker pool, prema konfiguraciji)
+    running_ = true;
+    if (!startServer()) {
+        running_ = false;
         logError("Failed to start TLS server on port " + std::to_string(port));
         return false;
     }
@@ -134,7 +199,19 @@ bool CentralServer::start(int port, const std::string& config_file) {
         }
     }
 
-    running_    = true;
+    if (config_.regional_sync) {
+        // [regional] regional_servers = host:port,... (id = "host:port")
+        std::istringstream list(config_.regional_servers);
+        std::string entry;
+        while (std::getline(list, entry, ',')) {
+            entry.erase(0, entry.find_first_not_of(" \t"));
+            entry.erase(entry.find_last_not_of(" \t") + 1);
+            const auto colon = entry.rfind(':');
+            if (entry.empty() || colon == std::string::npos) continue;
+            registerRegionalServer(entry, entry.substr(0, colon), std::atoi(entry.c_str() + colon + 1));
+        }
+    }
+
     start_time_ = std::chrono::system_clock::now();
     startBackgroundTasks();
     logInfo("Central Server started on port " + std::to_string(port));
@@ -147,35 +224,162 @@ void CentralServer::stop() {
 
     stopBackgroundTasks();
     cleanupMulticast();
+    {
+        // Regionalni serveri vide kraj veze; pri sljedećem spajanju javljaju svoj offset
+        std::lock_guard<std::mutex> lk(servers_mutex_);
+        for (auto& kv : regional_servers_) {
+            if (kv.second.connection) kv.second.connection->close();
+            kv.second.connection.reset();
+            kv.second.active = false;
+        }
+    }
 
     if (tls_server_) {
         tls_server_->stop();
     }
+    closeAllAsyncSessions();
+    // Primljeni uzorci se obrade i zadnje stanje upiše prije dnevnika i snimka
+    telemetry_.stop();
+    collectVehicleData();
+    if (config_.telemetry_feed_seats) flushInventory();
+    if (journal_.isOpen()) {
+        // Nakon gašenja handlera: ostatak dnevnika u bazu, pa prazan dnevnik
+        if (auto db = DatabasePool::getInstance().acquire()) {
+            applyJournal(*db);
+            compactJournal(*db);
+        }
+        journal_.close();
+    }
+    // Inventar koji nije stigao u bazu (greška zadnjeg flush-a) ne smije se vratiti iz snimka
+    if (config_.snapshot_enabled) writeSnapshot(seat_inventory_.dirtyCount() == 0);
     logInfo("Central Server stopped");
 }
 
 bool CentralServer::loadConfiguration(const std::string& config_file) {
     logInfo("Loading configuration from: " + config_file);
+    if (!ServerBase::loadConfiguration(config_file)) return false;
+
+    const auto& cfg = getConfig();
+    config_.max_connections    = cfg.max_connections;
+    config_.heartbeat_interval = cfg.heartbeat_interval;
+    config_.session_timeout    = std::max(1, cfg.getInt("network", "session_timeout", config_.session_timeout));
+    sessions_.setIdleTimeout(std::chrono::seconds(config_.session_timeout));
+
+    UserCache::Options user_cache;
+    user_cache.capacity     = static_cast<size_t>(std::max(16, cfg.getInt("user_cache", "capacity", 8192)));
+    user_cache.negative_ttl = std::chrono::seconds(std::max(0, cfg.getInt("user_cache", "negative_ttl", 30)));
+    users_.configure(user_cache);
+
+    // Adresa/port multicast grupe dolaze sa CLI-a (isti default kao klijentski DISCOVER)
+    config_.multicast_data_plane    = cfg.getBool("multicast", "data_plane", config_.multicast_data_plane);
+    config_.multicast_ttl           = std::max(1, cfg.getInt("multicast", "multicast_ttl", config_.multicast_ttl));
+    config_.multicast_resync_window = std::max(1, cfg.getInt("multicast", "resync_window", config_.multicast_resync_window));
+    config_.multicast_signing_key   = cfg.getString("multicast", "signing_key", config_.multicast_signing_key);
+
+    config_.journal_enabled           = cfg.getBool("journal", "enabled", config_.journal_enabled);
+    config_.journal_path              = cfg.getString("journal", "path", config_.journal_path);
+    config_.journal_commit_delay_us   = cfg.getInt("journal", "commit_delay_us", config_.journal_commit_delay_us);
+    config_.journal_apply_interval_ms = cfg.getInt("journal", "apply_interval_ms", config_.journal_apply_interval_ms);
+    config_.journal_compact_bytes     = static_cast<long long>(cfg.getInt("journal", "compact_mb", 16)) << 20;
+
+    config_.batch_max_items = std::max(1, cfg.getInt("batch", "max_items", config_.batch_max_items));
+    config_.purchase_key_window = std::max(1, cfg.getInt("batch", "idempotency_window", config_.purchase_key_window));
+
+    config_.regional_sync          = cfg.getBool("regional", "enable_regional_sync", config_.regional_sync);
+    config_.regional_sync_interval = std::max(1, cfg.getInt("regional", "sync_interval", config_.regional_sync_interval));
+    config_.regional_servers       = cfg.getString("regional", "regional_servers", config_.regional_servers);
+    config_.regional_sync_key      = cfg.getString("regional", "sync_key", config_.regional_sync_key);
+    config_.regional_timeout_ms    = std::max(100, cfg.getInt("regional", "timeout_ms", config_.regional_timeout_ms));
+    config_.regional_batch_records = std::max(1, cfg.getInt("regional", "batch_records", config_.regional_batch_records));
+    config_.regional_compression   = std::clamp(cfg.getInt("regional", "compression_level", config_.regional_compression), 0, 9);
+    config_.admin_bulk_max_items   = std::max(1, cfg.getInt("admin", "max_bulk_items", config_.admin_bulk_max_items));
+    config_.admin_page_max_rows    = std::max(1, cfg.getInt("admin", "page_max_rows", config_.admin_page_max_rows));
+    config_.admin_key              = cfg.getString("admin", "admin_key", config_.admin_key);
+    config_.snapshot_enabled       = cfg.getBool("snapshot", "enabled", config_.snapshot_enabled);
+    config_.snapshot_path          = cfg.getString("snapshot", "path", config_.snapshot_path);
+    config_.snapshot_interval      = std::max(1, cfg.getInt("snapshot", "interval_s", config_.snapshot_interval));
+    config_.telemetry_persist_ms   = std::max(10, cfg.getInt("telemetry", "persist_interval_ms", config_.telemetry_persist_ms));
+    config_.telemetry_feed_seats   = cfg.getBool("telemetry", "feed_seats", config_.telemetry_feed_seats);
+    config_.telemetry_max_samples  = std::max(1, cfg.getInt("telemetry", "max_samples", config_.telemetry_max_samples));
+    TelemetryAggregator::Options telemetry;
+    telemetry.queue_size = static_cast<size_t>(std::max(16, cfg.getInt("telemetry", "queue_size", 65536)));
+    telemetry.window     = std::chrono::seconds(std::max(1, cfg.getInt("telemetry", "window_s", 300)));
+    telemetry.max_skew   = std::chrono::milliseconds(std::max(0, cfg.getInt("telemetry", "max_skew_ms", 60000)));
+    telemetry_.configure(telemetry);
+    // Vremenska mjerenja su na nivou procesa (isto za DB pool i BroadcastHub)
+    metrics::Registry::instance().setEnabled(cfg.getBool("metrics", "enabled", true));
+    replication_.setCapacity(static_cast<size_t>(std::max(1, cfg.getInt("regional", "log_capacity", 65536))));
     return true;
 }
 
 bool CentralServer::initializeDatabase() {
     auto& pool = DatabasePool::getInstance();
-    return pool.initialize(db_path_.empty() ? "central_server.db" : db_path_, 5);
+    const auto& cfg = getConfig();
+    const auto& opt = cfg.database_options;
+    logInfo("Database pool_size=" + std::to_string(cfg.database_pool_size) +
+            " wal=" + (opt.wal_mode ? "on" : "off") +
+            " synchronous=" + (opt.synchronous.empty() ? "default" : opt.synchronous) +
+            " cache_size=" + std::to_string(opt.cache_size) +
+            " mmap_size=" + std::to_string(opt.mmap_size));
+    // Fiksan broj worker niti/shard-ova -> svaka drži "svoju" konekciju (bez CAS-a na zajedničkom steku)
+    pool.setThreadAffinity(usesAsyncSessions() && cfg.database_thread_affinity);
+    return pool.initialize(databasePath(), cfg.database_pool_size, opt);
 }
 
 void CentralServer::startBackgroundTasks() {
-    background_running_     = true;
-    data_collection_thread_ = std::make_unique<std::thread>(&CentralServer::dataCollectionLoop, this);
-    heartbeat_thread_       = std::make_unique<std::thread>(&CentralServer::heartbeatLoop, this);
-    cleanup_thread_         = std::make_unique<std::thread>(&CentralServer::sessionCleanupLoop, this);
+    using std::chrono::milliseconds;
+    using std::chrono::seconds;
+    const auto& cfg = getConfig();
+
+    // Svi periodični poslovi dijele jednu nit (timers_); heartbeat/idle konekcija radi ServerBase
+    background_running_ = true;
+    status_pushed_      = seat_inventory_.version();
+    timers_.schedule("data_collection", milliseconds(std::max(10, config_.telemetry_persist_ms)),
+                     [this] { collectVehicleData(); });
+    // Wheel ima tick od 1 s: svaki prolaz obradi samo slotove dospjele od prošlog
+    timers_.schedule("session_cleanup", seconds(1), [this] { cleanupExpiredSessions(); }, /*run_now*/ true);
+    timers_.schedule("inventory_flush", milliseconds(std::max(10, cfg.getInt("capacity", "seat_flush_interval_ms", 200))),
+                     [this] { flushInventory(); });
+    timers_.schedule("status_delta", milliseconds(std::max(10, cfg.getInt("status", "delta_interval_ms", 250))),
+                     [this] { pushStatusDeltas(); });
+    if (journal_.isOpen()) {
+        timers_.schedule("journal_apply", milliseconds(std::max(1, config_.journal_apply_interval_ms)),
+                         [this] { drainJournal(); });
+    }
+    if (config_.snapshot_enabled) {
+        timers_.schedule("state_snapshot", seconds(config_.snapshot_interval), [this] { writeSnapshot(false); });
+    }
+    if (config_.regional_sync) {
+        regional_sync_thread_ = std::make_unique<std::thread>(&CentralServer::regionalSyncLoop, this);
+    }
+
+    BroadcastHub::Options bopt;
+    bopt.queue_limit = static_cast<size_t>(std::max(1, cfg.getInt("broadcast", "queue_limit", 64)));
+    bopt.coalesce    = cfg.getBool("broadcast", "coalesce", true);
+    broadcast_.setOptions(bopt);
+    broadcast_.start();
+
+    if (cfg.database_options.wal_mode && cfg.wal_checkpoint_interval > 0) {
+        timers_.schedule("wal_checkpoint", seconds(cfg.wal_checkpoint_interval), [this] { checkpointWal(); });
+    }
 }
 
 void CentralServer::stopBackgroundTasks() {
     background_running_ = false;
-    if (data_collection_thread_ && data_collection_thread_->joinable()) data_collection_thread_->join();
-    if (heartbeat_thread_       && heartbeat_thread_->joinable())       heartbeat_thread_->join();
-    if (cleanup_thread_         && cleanup_thread_->joinable())         cleanup_thread_->join();
+    broadcast_.stop();
+    timers_.stop();     // vraća se čim završi posao u toku, bez čekanja intervala
+    if (regional_sync_thread_ && regional_sync_thread_->joinable()) regional_sync_thread_->join();
+
+    // Zadnji write-behind prije gašenja (i prije završnog checkpointa)
+    if (auto db = DatabasePool::getInstance().acquire()) seat_inventory_.flush(*db);
+    const auto& cfg = getConfig();
+    if (cfg.database_options.wal_mode && cfg.wal_checkpoint_interval > 0) {
+        // Na gašenju prebaci sve iz -wal u glavni fajl i skrati ga
+        auto db = DatabasePool::getInstance().acquire();
+        if (db) {
+            if (!db->checkpoint(true)) logWarning("Final WAL checkpoint: " + db->getLastError());
+        }
+    }
 }
 
 void CentralServer::handleClientMessage(std::unique_ptr<TLSSocket> client, std::unique_ptr<Message> /* message */) {
@@ -184,40 +388,56 @@ void CentralServer::handleClientMessage(std::unique_ptr<TLSSocket> client, std::
     total_connections_++;
     active_connections_++;
 
-    logInfo("New client connected from " + client->getPeerAddress() + ":" + std::to_string(client->getPeerPort()));
+    TP_LOG_INFO(logger_, "New client connected from ", client->getPeerAddress(), ":", client->getPeerPort());
 
+    // View se parsira direktno iz bafera konekcije (bez kopiranja polja u mapu)
+    MessageView view;
+    TrackedConnection tracked(*this, client.get());
     while (running_ && client) {
-        auto received_message = client->receiveMessage();
-        if (!received_message) break;
-        logDebug(std::string("Incoming message type: ") +
-                 messageTypeToString(received_message->getType()));
-        processMessage(std::move(received_message), client);
+        if (!client->receiveMessageView(view)) break;
+        TP_LOG_DEBUG(logger_, "Incoming message type: ", messageTypeToString(view.getType()));
+        RequestScope scope(view.getSequenceId());
+        if (auto ticket = admitRequest(view, client)) processMessageView(view, client);
     }
 
     active_connections_--;
-    {
-        std::lock_guard<std::mutex> lock(broadcast_mutex_);
-        auto it = std::remove(subscribers_.begin(), subscribers_.end(), client.get());
-        subscribers_.erase(it, subscribers_.end());
-    }
+    onClientDisconnected(client.get());
     logInfo("Client disconnected");
 }
 
+void CentralServer::onClientDisconnected(TLSSocket* client) {
+    // Ugašen socket više ne smije primati multicast update-e (čeka slanje u toku)
+    broadcast_.unsubscribe(client);
+}
+
 void CentralServer::processMessage(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client) {
     if (!message || !client) return;
 
     const auto mt = message->getType();
-    logInfo(std::string("Process: ") + messageTypeToString(mt));
+    TP_LOG_DEBUG(logger_, "Process: ", messageTypeToString(mt));
 
     switch (mt) {
-        case MessageType::CONNECT_REQUEST:     handleConnectRequest(std::move(message), client); break;
+        // Handleri nad view-om: materijalizovanu poruku provuci kroz isti kod
+        case MessageType::CONNECT_REQUEST:
+        case MessageType::RESERVE_SEAT:
+        case MessageType::PURCHASE_TICKET:
+        case MessageType::BATCH:
+        case MessageType::VEHICLE_TELEMETRY: {
+            // Bafer iz pool-a niti (ne thread_local bafer: BATCH stavke ovdje ulaze rekurzivno)
+            auto& pool  = BufferPool::local();
+            auto  frame = pool.acquire();
+            message->serializeTo(frame);
+            MessageView view;
+            if (view.parse(frame.data(), frame.size())) dispatchView(view, client);
+            pool.release(std::move(frame));
+            break;
+        }
         case MessageType::AUTH_REQUEST:        handleAuthRequest(std::move(message), client); break;
         case MessageType::REGISTER_USER:       handleUserRegistration(std::move(message), client); break;
         case MessageType::REGISTER_DEVICE:     handleDeviceRegistration(std::move(message), client); break;
-        case MessageType::RESERVE_SEAT:        handleSeatReservation(std::move(message), client); break;
-        case MessageType::PURCHASE_TICKET:     handleTicketPurchase(std::move(message), client); break;
         case MessageType::CREATE_GROUP:        handleGroupCreation(std::move(message), client); break;
         case MessageType::ADD_MEMBER_TO_GROUP: handleAddMemberToGroup(std::move(message), client); break;
+        case MessageType::ADD_MEMBERS_TO_GROUP: handleAddMembersToGroup(std::move(message), client); break;
         case MessageType::DELETE_GROUP_MEMBER: handleRemoveMemberFromGroup(std::move(message), client); break;
         case MessageType::DELETE_USER:         handleUserDeletion(std::move(message), client); break;
 
@@ -225,6 +445,15 @@ void CentralServer::processMessage(std::unique_ptr<Message> message, std::unique
         case MessageType::UPDATE_PRICE:        handleUpdatePrice(std::move(message), client); break;
         case MessageType::UPDATE_VEHICLE:      handleUpdateVehicle(std::move(message), client); break;
         case MessageType::UPDATE_CAPACITY:     handleUpdateCapacity(std::move(message), client); break;
+        case MessageType::BULK_UPDATE_VEHICLES: handleBulkUpdateVehicles(std::move(message), client); break;
+        case MessageType::BULK_UPDATE_PRICES:  handleBulkUpdatePrices(std::move(message), client); break;
+        case MessageType::MCAST_RESYNC:        handleMcastResync(std::move(message), client); break;
+
+        case MessageType::GET_VEHICLE_STATUS:  handleVehicleStatus(std::move(message), client); break;
+        case MessageType::GET_PRICES:          sendResponse(client, MessageFactory::createPriceList(*prices_.get())); break;
+        case MessageType::GET_STATS:           handleGetStats(std::move(message), client); break;
+        case MessageType::LIST_RECORDS:        handleListRecords(std::move(message), client); break;
+        case MessageType::HEARTBEAT:           sendSuccessResponse(client, "alive"); break;
 
         default:
             logWarning("Unknown/unsupported message type");
@@ -233,38 +462,72 @@ void CentralServer::processMessage(std::unique_ptr<Message> message, std::unique
     }
 }
 
-void CentralServer::handleConnectRequest(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client) {
-    std::string client_id = message->getString("client_id");
-    logInfo("CONNECT_REQUEST from client_id=" + (client_id.empty() ? "<unknown>" : client_id));
-    auto response = MessageFactory::createConnectResponse(true, "Connection established");
-    sendResponse(client, std::move(response));
+void CentralServer::processMessageView(const MessageView& view, std::unique_ptr<TLSSocket>& client) {
+    if (!client) return;
+    metrics::ScopedTimer timer(handlerHistogram(view.getType()));
+    tracing::Span span("central.request", tracing::extract(view), static_cast<uint16_t>(view.getType()));
+    traceReceive(span, client);
+    if (dispatchView(view, client)) return;
+
+    // Ostali handleri još rade nad Message
+    processMessage(view.toMessage(), client);
+}
+
+bool CentralServer::dispatchView(const MessageView& view, std::unique_ptr<TLSSocket>& client) {
+    const auto mt = view.getType();
+    switch (mt) {
+        case MessageType::CONNECT_REQUEST: TP_LOG_DEBUG(logger_, "Process: ", messageTypeToString(mt));
+                                           handleConnectRequest(view, client);  return true;
+        case MessageType::RESERVE_SEAT:    TP_LOG_DEBUG(logger_, "Process: ", messageTypeToString(mt));
+                                           handleSeatReservation(view, client); return true;
+        case MessageType::PURCHASE_TICKET: TP_LOG_DEBUG(logger_, "Process: ", messageTypeToString(mt));
+                                           handleTicketPurchase(view, client);  return true;
+        case MessageType::BATCH:           TP_LOG_DEBUG(logger_, "Process: ", messageTypeToString(mt));
+                                           handleBatch(view, client);           return true;
+        case MessageType::VEHICLE_TELEMETRY:
+                                           handleTelemetry(view, client);       return true;
+        default:
+            return false;
+    }
+}
+
+void CentralServer::handleConnectRequest(const MessageView& view, std::unique_ptr<TLSSocket>& client) {
+    std::string client_id = view.getString("client_id");
+    const uint16_t version = acceptConnect(view.getStringView("protocol_version"), client);
+    logInfo("CONNECT_REQUEST from client_id=" + (client_id.empty() ? "<unknown>" : client_id) +
+            ", protocol v" + std::to_string(version));
 }
 
 void CentralServer::handleAuthRequest(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client) {
     const std::string urn = message->getString("urn"); // bez PIN-a
     logInfo("AUTH_REQUEST urn=" + (urn.empty() ? "<missing>" : urn));
 
-    auto db = DatabasePool::getInstance().getConnection();
     bool authenticated = false;
-
     if (!urn.empty()) {
-        authenticated = static_cast<bool>(db->getUser(urn)); // postoji user?
+        // Postoji user? Konekcija iz pool-a samo kad URN nije u kešu
+        bool failed = false;
+        authenticated = static_cast<bool>(findUser(urn, failed));
+        if (failed) {
+            logError("AUTH_REQUEST user lookup failed: " + urn);
+            sendErrorResponse(client, "User lookup failed", 503);
+            return;
+        }
     }
 
-    std::string session_id = authenticated ? generateSessionId() : "";
+    std::string session_id = authenticated ? sessions_.create(urn) : "";
     auto response = MessageFactory::createAuthResponse(authenticated, session_id);
-
+    // Datagrami nose V2 okvir: klijent koji je dogovorio V1 ih dobija preko TLS-a
+    bool datagram_fallback = false;
     if (authenticated) {
-        ClientSession s;
-        s.session_id    = session_id;
-        s.user_urn      = urn;
-        s.authenticated = true;
-        s.last_activity = std::chrono::system_clock::now();
-        s.socket        = nullptr;
-
-        {
-            std::lock_guard<std::mutex> lk(sessions_mutex_);
-            client_sessions_[session_id] = std::move(s);
+        // Parametri data plane-a idu preko TLS-a; mcast_key je javni ključ za provjeru potpisa
+        std::lock_guard<std::mutex> lk(mcast_pub_mutex_);
+        if (mcast_data_ready_ && client->getProtocolVersion() >= mcast::kFrameVersion) {
+            response->addString("mcast_group", config_.multicast_address);
+            response->addInt("mcast_port", config_.multicast_port);
+            response->addString("mcast_key", mcast::toHex(mcast_signer_.publicKey()));
+            response->addString("mcast_seq", std::to_string(mcast_seq_));
+        } else {
+            datagram_fallback = mcast_data_ready_;
         }
     }
 
@@ -272,13 +535,30 @@ void CentralServer::handleAuthRequest(std::unique_ptr<Message> message, std::uni
 
     if (authenticated) {
         logInfo("User authenticated: " + urn + " (session_id=" + session_id + ")");
-        std::lock_guard<std::mutex> lock(broadcast_mutex_);
-        subscribers_.push_back(client.get());
+        broadcast_.subscribe(client.get());
+        if (datagram_fallback) broadcast_.subscribe(client.get(), kDatagramFallbackTopic);
     } else {
         logWarning("Authentication failed for URN: " + urn);
     }
 
-    DatabasePool::getInstance().returnConnection(db);
+}
+
+std::shared_ptr<const User> CentralServer::findUser(const std::string& urn, bool& failed, Database* db) {
+    failed = false;
+    return users_.get(urn, [&]() -> std::unique_ptr<User> {
+        DatabasePool::Lease lease;
+        if (!db) {
+            lease = DatabasePool::getInstance().acquire();
+            if (!lease) {
+                failed = true;
+                return nullptr;
+            }
+        }
+        Database& conn = db ? *db : *lease;
+        auto user = conn.getUser(urn);
+        failed = !user && conn.getLastErrorCode() != 0;
+        return user;
+    }, [&] { return failed; });
 }
 
 void CentralServer::handleUserRegistration(std::unique_ptr<Message> message,
@@ -292,14 +572,17 @@ void CentralServer::handleUserRegistration(std::unique_ptr<Message> message,
         return;
     }
 
-    auto db = DatabasePool::getInstance().getConnection();
-
-    if (auto exists = db->getUser(urn)) {
-        DatabasePool::getInstance().returnConnection(db);
+    bool failed = false;
+    if (findUser(urn, failed)) {
         logInfo("REGISTER_USER already exists: " + urn);
         sendErrorResponse(client, "User already registered", 409);
         return;
     }
+    if (failed) {
+        logError("REGISTER_USER user lookup failed: " + urn);
+        sendErrorResponse(client, "User lookup failed", 503);
+        return;
+    }
 
     User user;
     user.urn               = urn;
@@ -309,12 +592,18 @@ void CentralServer::handleUserRegistration(std::unique_ptr<Message> message,
     user.active            = true;
     user.pin_hash          = message->hasKey("pin_hash") ? message->getString("pin_hash") : "default_hash";
 
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) {
+        sendErrorResponse(client, "Database unavailable", 503);
+        return;
+    }
     bool ok    = db->registerUser(user);
     auto dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
+    db.release();
 
     if (ok) {
         logInfo("User registered: " + urn);
+        replicateUser(urn, user.name);
         sendSuccessResponse(client, "User registered successfully");
     } else {
         logError("Failed to register user: " + urn + (dbErr.empty()? "" : (" | " + dbErr)));
@@ -343,13 +632,15 @@ void CentralServer::handleDeviceRegistration(std::unique_ptr<Message> message, s
     vehicle.active          = true;
     vehicle.last_update     = getCurrentTimestamp();
 
-    auto db = DatabasePool::getInstance().getConnection();
+    auto db = DatabasePool::getInstance().acquire();
     bool ok = db->registerVehicle(vehicle);
     const std::string dbErr = db->getLastError();
     const int dbCode        = db->getLastErrorCode();
-    DatabasePool::getInstance().returnConnection(db);
+    db.release();
 
     if (ok) {
+        seat_inventory_.upsert(vehicle);
+        replicateVehicle(uri);
         logInfo("Device registered: " + uri + " (route=" + vehicle.route + ")");
         sendSuccessResponse(client, "Device registered successfully");
     } else {
@@ -363,170 +654,182 @@ void CentralServer::handleDeviceRegistration(std::unique_ptr<Message> message, s
     }
 }
 
-void CentralServer::handleSeatReservation(std::unique_ptr<Message> message,
-                                          std::unique_ptr<TLSSocket>& client) {
-    VehicleType vehicle_type = static_cast<VehicleType>(message->getInt("vehicle_type"));
-    std::string route = message->hasKey("route") ? message->getString("route") : "";
-    std::string uri   = message->hasKey("uri")   ? message->getString("uri")   : "";
-    std::string urn   = message->hasKey("urn")   ? message->getString("urn")   : "";
-
-    logInfo("RESERVE_SEAT req: urn=" + (urn.empty()?"<missing>":urn) +
-            ", vt=" + std::string(vehicleTypeToString(vehicle_type)) +
-            ", route=" + (route.empty()? "<none>" : route) +
-            ", uri=" + (uri.empty()? "<none>" : uri));
+std::optional<SeatInventory::Snapshot>
+CentralServer::locateVehicle(const std::string& uri, const std::string& route,
+                             VehicleType type, bool any_type) {
+    if (!uri.empty()) {
+        if (auto v = seat_inventory_.find(uri)) return v;
+        // Vozilo upisano mimo servera (npr. direktno u bazu) -> učitaj ga jednom
+        auto db = DatabasePool::getInstance().acquire();
+        if (auto v = db ? db->getVehicle(uri) : nullptr) {
+            seat_inventory_.upsert(*v);
+            return seat_inventory_.find(uri);
+        }
+    }
+    if (route.empty()) return std::nullopt;
+
+    // Indeks ruta -> vozila po tipu; na promašaj jedan SQL upit (indeks na route/type)
+    auto v = any_type ? seat_inventory_.findOnRoute(route, type)
+                      : seat_inventory_.findByRouteAndType(route, type);
+    if (v) return v;
+
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return std::nullopt;
+    auto row = any_type ? db->getVehicleByRoute(route, type)
+                        : db->getVehicleByRouteAndType(route, type);
+    if (!row) return std::nullopt;
+    seat_inventory_.upsert(*row);
+    return seat_inventory_.find(row->uri);
+}
 
-    if (urn.empty()) {
-        logWarning("RESERVE_SEAT rejected: missing URN");
-        sendErrorResponse(client, "Missing user URN");
+void CentralServer::refreshInventory(const std::string& uri, std::optional<int> seats_seen) {
+    auto db = DatabasePool::getInstance().acquire();
+    auto v  = db ? db->getVehicle(uri) : nullptr;
+    if (!v) {
+        seat_inventory_.remove(uri);
         return;
     }
-
-    auto db = DatabasePool::getInstance().getConnection();
-    std::unique_ptr<Vehicle> vehicle;
-
-    if (!uri.empty()) {
-        if (auto v = db->getVehicle(uri)) {
-            vehicle      = std::move(v);
-            vehicle_type = vehicle->type;
-            route        = vehicle->route;
+    // Na mjestu: brojač u memoriji je noviji od baze (write-behind), a rezervacije
+    // između upisa u bazu i ove izmjene se ne gube
+    if (seat_inventory_.amend(*v, seats_seen.has_value(), seats_seen.value_or(0))) {
+        if (seats_seen && !journal_.isOpen() && !db->updateSeatAvailabilityBatch({uri}, liveSeats())) {
+            logWarning("Capacity refresh: seat write failed for " + uri + ": " + db->getLastError());
         }
+        return;
     }
+    seat_inventory_.upsert(*v);
+}
 
-    if (!vehicle && !route.empty()) {
-        vehicle = db->getVehicleByRouteAndType(route, vehicle_type);
-        if (!vehicle) {
-            for (VehicleType t : {VehicleType::BUS, VehicleType::TRAM, VehicleType::TROLLEYBUS}) {
-                if (t == vehicle_type) continue;
-                if (auto v2 = db->getVehicleByRouteAndType(route, t)) {
-                    vehicle      = std::move(v2);
-                    vehicle_type = t;
-                    break;
-                }
-            }
-        }
+int CentralServer::prepareReservation(const MessageView& view, journal_events::SeatChange& out,
+                                      std::string& error) {
+    VehicleType vehicle_type = static_cast<VehicleType>(view.getInt("vehicle_type"));
+    std::string route = view.hasKey("route") ? view.getString("route") : "";
+    std::string uri   = view.hasKey("uri")   ? view.getString("uri")   : "";
+    std::string urn   = view.hasKey("urn")   ? view.getString("urn")   : "";
+
+    TP_LOG_DEBUG(logger_, "RESERVE_SEAT req: urn=", urn.empty() ? "<missing>" : urn.c_str(),
+                 ", vt=", vehicleTypeToString(vehicle_type),
+                 ", route=", route.empty() ? "<none>" : route.c_str(),
+                 ", uri=", uri.empty() ? "<none>" : uri.c_str());
+
+    if (urn.empty()) {
+        logWarning("RESERVE_SEAT rejected: missing URN");
+        error = "Missing user URN";
+        return 400;
     }
 
+    // Vozilo i mjesta iz SeatInventory (SQLite samo ako vozilo još nije u inventaru)
+    auto vehicle = locateVehicle(uri, route, vehicle_type, /*any_type*/ true);
     if (!vehicle) {
-        DatabasePool::getInstance().returnConnection(db);
         logWarning("RESERVE_SEAT failed: vehicle/route not found (route=" +
                    (route.empty()?"<none>":route) + ", uri=" + (uri.empty()?"<none>":uri) + ")");
-        sendErrorResponse(client, "Vehicle/route not found");
-        return;
+        error = "Vehicle/route not found";
+        return 404;
     }
-    if (route.empty()) route = vehicle->route;
+    route = vehicle->route;
 
-    if (vehicle->available_seats <= 0) {
-        DatabasePool::getInstance().returnConnection(db);
+    const auto r = seat_inventory_.reserve(vehicle->uri, 1);
+    if (!r.ok) {
         logInfo("RESERVE_SEAT rejected: no seats (uri=" + vehicle->uri + ", route=" + route + ")");
-        sendErrorResponse(client, "No available seats for this route/vehicle");
-        return;
+        error = "No available seats for this route/vehicle";
+        return 409;
     }
-
-    const int new_available = vehicle->available_seats - 1;
-    if (!db->updateSeatAvailability(vehicle->uri, new_available)) {
-        auto err = db->getLastError();
-        DatabasePool::getInstance().returnConnection(db);
-        logError("RESERVE_SEAT DB error(update seats): " + (err.empty()?"<unknown>":err));
-        sendErrorResponse(client, "Failed to reserve seat");
-        return;
-    }
-    DatabasePool::getInstance().returnConnection(db);
-
-    logInfo("Seat reserved: urn=" + urn + ", uri=" + vehicle->uri + ", route=" + route +
-            ", remaining=" + std::to_string(new_available));
-
-    auto resp = MessageFactory::createSuccessResponse("Seat reserved successfully", {
-        {"route", route},
-        {"vehicle_uri", vehicle->uri},
-        {"available_seats", std::to_string(new_available)}
-    });
-    sendResponse(client, std::move(resp));
-
-    sendMulticastUpdate("seat_reserved", {
-        {"route", route},
-        {"vehicle_uri", vehicle->uri},
-        {"available_seats", std::to_string(new_available)}
-    });
+    out = {vehicle->uri, urn, route, 1, r.capacity, r.available, r.seat_seq};
+    return 200;
 }
 
-void CentralServer::handleTicketPurchase(std::unique_ptr<Message> message,
-                                         std::unique_ptr<TLSSocket>& client) {
+int CentralServer::preparePurchase(const MessageView& view, journal_events::Purchase& out,
+                                   std::string& error) {
     std::string urn;
-    if (message->hasKey("session_id")) {
-        const std::string sid = message->getString("session_id");
-        std::lock_guard<std::mutex> lk(sessions_mutex_);
-        auto it = client_sessions_.find(sid);
-        if (it == client_sessions_.end()) {
+    if (view.hasKey("session_id")) {
+        auto session_urn = sessions_.touch(view.getString("session_id"));
+        if (!session_urn) {
             logWarning("PURCHASE_TICKET rejected: invalid/expired session");
-            sendErrorResponse(client, "Invalid or expired session", 401);
-            return;
+            error = "Invalid or expired session";
+            return 401;
         }
-        it->second.last_activity = std::chrono::system_clock::now();
-        urn = it->second.user_urn;
-    } else if (message->hasKey("urn")) {
-        urn = message->getString("urn");
+        urn = std::move(*session_urn);
+    } else if (view.hasKey("urn")) {
+        urn = view.getString("urn");
     }
     if (urn.empty()) {
         logWarning("PURCHASE_TICKET rejected: missing identity");
-        sendErrorResponse(client, "Missing user identity (session_id or urn)", 400);
-        return;
+        error = "Missing user identity (session_id or urn)";
+        return 400;
     }
 
-    const TicketType ticket_type = static_cast<TicketType>(message->getInt("ticket_type"));
-    VehicleType vehicle_type     = static_cast<VehicleType>(message->getInt("vehicle_type"));
-    std::string route            = message->hasKey("route") ? message->getString("route") : "";
-    const std::string uri        = message->hasKey("uri")   ? message->getString("uri")   : "";
-    int passengers               = message->hasKey("passengers") ? message->getInt("passengers") : 1;
+    const TicketType ticket_type = static_cast<TicketType>(view.getInt("ticket_type"));
+    VehicleType vehicle_type     = static_cast<VehicleType>(view.getInt("vehicle_type"));
+    std::string route            = view.hasKey("route") ? view.getString("route") : "";
+    const std::string uri        = view.hasKey("uri")   ? view.getString("uri")   : "";
+    int passengers               = view.hasKey("passengers") ? view.getInt("passengers") : 1;
     if (passengers < 1) passengers = 1;
 
-    logInfo(std::string("PURCHASE_TICKET req: urn=") + urn +
-            ", tt=" + ticketTypeToString(ticket_type) +
-            ", vt=" + vehicleTypeToString(vehicle_type) +
-            ", route=" + (route.empty()?"<none>":route) +
-            ", uri=" + (uri.empty()?"<none>":uri) +
-            ", pax=" + std::to_string(passengers));
-
-    auto db = DatabasePool::getInstance().getConnection();
-    std::unique_ptr<Vehicle> vehicle;
-
-    if (!uri.empty()) {
-        auto v = db->getVehicle(uri);
-        if (v) { vehicle = std::move(v); vehicle_type = vehicle->type; route = vehicle->route; }
-    }
-    if (!vehicle && !route.empty()) {
-        vehicle = db->getVehicleByRouteAndType(route, vehicle_type);
-    }
+    TP_LOG_DEBUG(logger_, "PURCHASE_TICKET req: urn=", urn,
+                 ", tt=", ticketTypeToString(ticket_type),
+                 ", vt=", vehicleTypeToString(vehicle_type),
+                 ", route=", route.empty() ? "<none>" : route.c_str(),
+                 ", uri=", uri.empty() ? "<none>" : uri.c_str(),
+                 ", pax=", passengers);
 
+    auto vehicle = locateVehicle(uri, route, vehicle_type, /*any_type*/ false);
     if (!vehicle) {
-        DatabasePool::getInstance().returnConnection(db);
         logWarning("PURCHASE_TICKET failed: vehicle/route not found (route=" +
                    (route.empty()?"<none>":route) + ", uri=" + (uri.empty()?"<none>":uri) + ")");
-        sendErrorResponse(client, "Vehicle/route not found", 404);
-        return;
+        error = "Vehicle/route not found";
+        return 404;
+    }
+    vehicle_type = vehicle->type;
+    route        = vehicle->route;
+
+    // Ponovljena kupovina (isti idempotency_key) ne skida mjesta drugi put
+    std::string transaction_id;
+    if (view.hasKey("idempotency_key")) {
+        const std::string key = view.getString("idempotency_key");
+        if (key.empty() || key.size() > 64) {
+            error = "Invalid idempotency_key (1-64 characters)";
+            return 400;
+        }
+        transaction_id = "IK-" + key;
+        switch (claimPurchaseKey(transaction_id)) {
+            case PurchaseKeyState::CLAIMED:
+                break;
+            case PurchaseKeyState::RECORDED:
+                logInfo("PURCHASE_TICKET duplicate: " + transaction_id);
+                out.payment.transaction_id = transaction_id;
+                error = "Purchase already recorded";
+                return 208;
+            case PurchaseKeyState::IN_FLIGHT:
+                // Prvi pokušaj još nije upisan (ni odbijen): ishod se još ne zna, klijent ponavlja
+                logInfo("PURCHASE_TICKET in flight: " + transaction_id);
+                error = "Purchase with this idempotency_key in progress, retry later";
+                return 425;
+        }
     }
-    if (route.empty()) route = vehicle->route;
 
-    if (vehicle->available_seats < passengers) {
-        DatabasePool::getInstance().returnConnection(db);
+    // Mjesta se skidaju atomski u memoriji; baza dobija stanje kroz write-behind flush
+    const auto seats = seat_inventory_.reserve(vehicle->uri, passengers);
+    if (!seats.ok) {
+        if (!transaction_id.empty()) releasePurchaseKey(transaction_id);
         logInfo("PURCHASE_TICKET rejected: not enough seats (uri=" + vehicle->uri +
                 ", route=" + route + ", need=" + std::to_string(passengers) +
-                ", have=" + std::to_string(vehicle->available_seats) + ")");
-        sendErrorResponse(client, "Insufficient seats available", 409);
-        return;
+                ", have=" + std::to_string(seats.available) + ")");
+        error = "Insufficient seats available";
+        return 409;
     }
 
-    // Cijena (placeholder iz DB-a)
-    const double price_each   = db->calculateTicketPrice(vehicle_type, ticket_type, 1, 1.0, 30.0);
-    const double discount     = 0.0;
-    const double total_amount = price_each * passengers;
+    // Cijena i grupni popust iz snapshot-a cjenovnika (bez upita i bez brave)
+    const auto prices         = prices_.get();
+    const double price_each   = prices->ticketPrice(vehicle_type, ticket_type);
+    const double discount     = prices->groupDiscount(ticket_type);
+    const double total_amount = price_each * passengers * (1.0 - discount);
     const std::string when_buy = getCurrentTimestamp();
 
-    // Kreiraj karte
-    std::vector<std::string> ticket_ids;
-    ticket_ids.reserve(passengers);
-
-    for (int i = 0; i < passengers; ++i) {
-        Ticket t{};
+    // Karte (sjedišta dodijeljena iz inventara)
+    out.seats = {vehicle->uri, urn, route, passengers, seats.capacity, seats.available, seats.seat_seq};
+    out.tickets.assign(static_cast<size_t>(passengers), Ticket{});
+    for (size_t i = 0; i < out.tickets.size(); ++i) {
+        Ticket& t = out.tickets[i];
         t.ticket_id     = generateTicketId();
         t.user_urn      = urn;
         t.type          = ticket_type;
@@ -535,70 +838,310 @@ void CentralServer::handleTicketPurchase(std::unique_ptr<Message> message,
         t.price         = price_each;
         t.discount      = discount;
         t.purchase_date = when_buy;
-        t.seat_number   = std::to_string(vehicle->capacity - vehicle->available_seats + i + 1);
+        t.seat_number   = std::to_string(seats.first_seat + static_cast<int>(i));
         t.used          = false;
-
-        if (!db->createTicket(t)) {
-            std::string err = db->getLastError();
-            DatabasePool::getInstance().returnConnection(db);
-            logError("PURCHASE_TICKET DB error(createTicket): " + (err.empty()?"<unknown>":err));
-            sendErrorResponse(client, "Failed to create ticket record" + (err.empty() ? "" : (": " + err)), 500);
-            return;
-        }
-        ticket_ids.push_back(t.ticket_id);
     }
 
     // Plaćanje – vežemo prvu kartu da FK nije prazan
-    Payment p{};
-    p.transaction_id = generateTransactionId();
-    p.ticket_id      = ticket_ids.empty() ? "" : ticket_ids.front();
+    Payment& p = out.payment;
+    p.transaction_id = transaction_id.empty() ? generateTransactionId() : transaction_id;
+    p.ticket_id      = out.tickets.front().ticket_id;
     p.amount         = total_amount;
     p.payment_method = "card";
     p.payment_date   = when_buy;
     p.successful     = true;
+    return 200;
+}
 
-    if (!db->recordPayment(p)) {
-        std::string err = db->getLastError();
-        DatabasePool::getInstance().returnConnection(db);
-        logError("PURCHASE_TICKET DB error(recordPayment): " + (err.empty()?"<unknown>":err));
-        sendErrorResponse(client, "Failed to record payment" + (err.empty() ? "" : (": " + err)), 500);
+void CentralServer::handleSeatReservation(const MessageView& view,
+                                          std::unique_ptr<TLSSocket>& client) {
+    journal_events::SeatChange ev;
+    std::string error;
+    int status;
+    {
+        tracing::Span span("inventory.reserve");
+        status = prepareReservation(view, ev, error);
+    }
+    if (status != 200) {
+        sendErrorResponse(client, error, status);
         return;
     }
+    if (journal_.isOpen()) {
+        tracing::Span span("journal.commit");
+        const uint64_t lsn = journal_.append(EventJournal::EventType::SEAT_RESERVED, journal_events::encode(ev));
+        if (lsn == 0) {
+            seat_inventory_.release(ev.vehicle_uri, 1);
+            logError("RESERVE_SEAT journal error: " + journal_.lastError());
+            sendErrorResponse(client, "Reservation not recorded, journal unavailable", 503);
+            return;
+        }
+        if (!journal_.waitDurable(lsn)) {
+            // Zapis se može pojaviti pri oporavku -> mjesto ostaje zauzeto
+            logError("RESERVE_SEAT journal commit failed: " + journal_.lastError());
+            sendErrorResponse(client, "Reservation outcome unknown", kOutcomeUnknown);
+            return;
+        }
+    } else {
+        // Bez dnevnika brojač ide u bazu odmah: write-behind flush bi pri padu izgubio rezervaciju
+        tracing::Span span("db.reserve");
+        auto db = DatabasePool::getInstance().acquire();
+        if (!db || !db->updateSeatAvailabilityBatch({ev.vehicle_uri}, liveSeats())) {
+            const std::string err = db ? db->getLastError() : "no database connection available";
+            db.release();
+            seat_inventory_.release(ev.vehicle_uri, 1);
+            logError("RESERVE_SEAT DB error: " + (err.empty()?"<unknown>":err));
+            sendErrorResponse(client, "Failed to record reservation", db ? 500 : 503);
+            return;
+        }
+    }
+
+    TP_LOG_INFO(logger_, "Seat reserved: urn=", ev.user_urn, ", uri=", ev.vehicle_uri, ", route=", ev.route,
+                ", remaining=", ev.available);
+
+    sendResponse(client, MessageFactory::seatReservedTemplate(), {ev.route, ev.vehicle_uri, ev.available});
+
+    sendMulticastUpdate("seat_reserved", {
+        {"route", ev.route},
+        {"vehicle_uri", ev.vehicle_uri},
+        {"available_seats", std::to_string(ev.available)}
+    });
+}
 
-    // Update slobodnih mjesta
-    const int new_available = vehicle->available_seats - passengers;
-    if (!db->updateSeatAvailability(vehicle->uri, new_available)) {
-        std::string err = db->getLastError();
-        DatabasePool::getInstance().returnConnection(db);
-        logError("PURCHASE_TICKET DB error(update seats): " + (err.empty()?"<unknown>":err));
-        sendErrorResponse(client, "Failed to update seat availability" + (err.empty() ? "" : (": " + err)), 500);
+void CentralServer::handleTicketPurchase(const MessageView& view,
+                                         std::unique_ptr<TLSSocket>& client) {
+    journal_events::Purchase ev;
+    std::string error;
+    int status;
+    {
+        tracing::Span span("inventory.reserve");
+        status = preparePurchase(view, ev, error);
+    }
+    if (status == 208) {
+        sendResponse(client, MessageFactory::createSuccessResponse(error, {
+            {"duplicate",      "1"},
+            {"transaction_id", ev.payment.transaction_id}
+        }));
         return;
     }
+    if (status != 200) {
+        sendErrorResponse(client, error, status);
+        return;
+    }
+    const std::string& uri = ev.seats.vehicle_uri;
+    const int passengers   = ev.seats.seats;
+
+    if (journal_.isOpen()) {
+        // Trajno čim je zapis u dnevniku (group commit); karte u bazu upisuje journalApplyLoop
+        tracing::Span span("journal.commit");
+        const uint64_t lsn = journal_.append(EventJournal::EventType::TICKETS_PURCHASED, journal_events::encode(ev));
+        if (lsn == 0) {
+            seat_inventory_.release(uri, passengers);
+            releasePurchaseKey(ev.payment.transaction_id);
+            logError("PURCHASE_TICKET journal error: " + journal_.lastError());
+            sendErrorResponse(client, "Purchase not recorded, journal unavailable", 503);
+            return;
+        }
+        if (!journal_.waitDurable(lsn)) {
+            // Zapis koji nije potvrđen može se ipak pojaviti pri oporavku -> mjesta i ključ ostaju
+            logError("PURCHASE_TICKET journal commit failed: " + journal_.lastError());
+            sendErrorResponse(client, "Purchase outcome unknown, retry with the same idempotency_key",
+                              kOutcomeUnknown);
+            return;
+        }
+    } else {
+        // Karte, plaćanje i brojač mjesta (već skinut u inventaru) u jednoj transakciji
+        tracing::Span span("db.purchase");
+        auto db = DatabasePool::getInstance().acquire();
+        if (!db) {
+            // Pool ugašen/neinicijalizovan: kupovina nije upisana -> mjesta i ključ nazad
+            seat_inventory_.release(uri, passengers);
+            releasePurchaseKey(ev.payment.transaction_id);
+            logError("PURCHASE_TICKET: no database connection available");
+            sendErrorResponse(client, "Database unavailable", 503);
+            return;
+        }
+        if (!db->purchaseTickets(uri, ev.tickets, ev.payment, liveSeats())) {
+            const std::string err = db->getLastError();
+            db.release();
+            seat_inventory_.release(uri, passengers);
+            releasePurchaseKey(ev.payment.transaction_id);
+            logError("PURCHASE_TICKET DB error(purchaseTickets): " + (err.empty()?"<unknown>":err));
+            sendErrorResponse(client, "Failed to record purchase" + (err.empty() ? "" : (": " + err)), 500);
+            return;
+        }
+    }
+    recordPurchaseKey(ev.payment.transaction_id);
 
-    DatabasePool::getInstance().returnConnection(db);
-
-    logInfo("Ticket purchased: urn=" + urn + ", uri=" + vehicle->uri + ", route=" + route +
-            ", pax=" + std::to_string(passengers) + ", total=" + std::to_string(total_amount) +
-            ", remaining=" + std::to_string(new_available));
+    TP_LOG_INFO(logger_, "Ticket purchased: urn=", ev.seats.user_urn, ", uri=", uri, ", route=", ev.seats.route,
+                ", pax=", passengers, ", total=", ev.payment.amount, ", remaining=", ev.seats.available);
 
     auto resp = MessageFactory::createSuccessResponse("Ticket purchased successfully", {
-        {"total_amount",     std::to_string(total_amount)},
-        {"route",            route},
-        {"vehicle_uri",      vehicle->uri},
-        {"available_seats",  std::to_string(new_available)},
+        {"total_amount",     std::to_string(ev.payment.amount)},
+        {"route",            ev.seats.route},
+        {"vehicle_uri",      uri},
+        {"available_seats",  std::to_string(ev.seats.available)},
         {"passengers",       std::to_string(passengers)},
-        {"user_urn",         urn}
+        {"user_urn",         ev.seats.user_urn}
     });
     sendResponse(client, std::move(resp));
 
     sendMulticastUpdate("ticket_purchased", {
-        {"route",            route},
-        {"vehicle_uri",      vehicle->uri},
+        {"route",            ev.seats.route},
+        {"vehicle_uri",      uri},
         {"passengers",       std::to_string(passengers)},
-        {"available_seats",  std::to_string(new_available)}
+        {"available_seats",  std::to_string(ev.seats.available)}
     });
 }
 
+void CentralServer::handleBatch(const MessageView& view, std::unique_ptr<TLSSocket>& client) {
+    // Bafer mora živjeti dok se koriste view-ovi stavki
+    const std::vector<uint8_t> blob = view.getBinary("items");
+    std::vector<MessageView> items;
+    if (!splitBatchItems(blob.data(), blob.size(), items)) {
+        logWarning("BATCH rejected: malformed items");
+        sendErrorResponse(client, "Malformed batch items", 400);
+        return;
+    }
+    if (items.size() > static_cast<size_t>(config_.batch_max_items)) {
+        logWarning("BATCH rejected: " + std::to_string(items.size()) + " items (max " +
+                   std::to_string(config_.batch_max_items) + ")");
+        sendErrorResponse(client, "Too many batch items", 413);
+        return;
+    }
+
+    // 1) Svaka stavka redom skida mjesta u inventaru (bez odgovora i bez upisa)
+    struct Item {
+        int                      status{415};
+        bool                     purchase{false};
+        journal_events::Purchase ev;          // za rezervaciju se koristi samo ev.seats
+        uint64_t                 lsn{0};
+    };
+    std::vector<Item> results(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        Item& it = results[i];
+        std::string error;
+        switch (items[i].getType()) {
+            case MessageType::RESERVE_SEAT:
+                it.status = prepareReservation(items[i], it.ev.seats, error);
+                break;
+            case MessageType::PURCHASE_TICKET:
+                it.purchase = true;
+                it.status   = preparePurchase(items[i], it.ev, error);
+                break;
+            default:
+                break;   // 415: ugniježđeni BATCH i ostali tipovi nisu podržani
+        }
+    }
+
+    // 2) Jedan trajni upis za sve prihvaćene stavke
+    auto releaseSeats = [this](Item& it) {
+        seat_inventory_.release(it.ev.seats.vehicle_uri, it.ev.seats.seats);
+        if (it.purchase) releasePurchaseKey(it.ev.payment.transaction_id);
+        it.status = 500;
+    };
+    if (journal_.isOpen()) {
+        // Zapisi idu u dnevnik redom, group commit ih potvrđuje jednim msync-om
+        uint64_t last = 0;
+        for (auto& it : results) {
+            if (it.status != 200) continue;
+            it.lsn = it.purchase
+                ? journal_.append(EventJournal::EventType::TICKETS_PURCHASED, journal_events::encode(it.ev))
+                : journal_.append(EventJournal::EventType::SEAT_RESERVED, journal_events::encode(it.ev.seats));
+            if (it.lsn == 0) {
+                releaseSeats(it);
+                it.status = 503;
+            } else {
+                last = it.lsn;
+            }
+        }
+        if (last != 0 && !journal_.waitDurable(last)) {
+            logError("BATCH journal commit failed: " + journal_.lastError());
+            for (auto& it : results) if (it.lsn != 0) it.status = kOutcomeUnknown;
+        }
+    } else {
+        // Kupovine i brojači svih prihvaćenih stavki u jednoj transakciji
+        std::vector<TicketPurchase> purchases;
+        std::vector<std::string>    seat_uris;
+        for (const auto& it : results) {
+            if (it.status != 200) continue;
+            if (it.purchase) purchases.push_back({it.ev.tickets, it.ev.payment});
+            if (std::find(seat_uris.begin(), seat_uris.end(), it.ev.seats.vehicle_uri) == seat_uris.end()) {
+                seat_uris.push_back(it.ev.seats.vehicle_uri);
+            }
+        }
+        if (!seat_uris.empty()) {
+            auto db = DatabasePool::getInstance().acquire();
+            if (!db) {
+                logError("BATCH: no database connection available");
+                for (auto& it : results) if (it.status == 200) releaseSeats(it);
+            } else if (!db->purchaseTicketsBatch(purchases, seat_uris, liveSeats())) {
+                const std::string err = db->getLastError();
+                db.release();
+                logError("BATCH DB error(purchaseTicketsBatch): " + (err.empty()?"<unknown>":err));
+                for (auto& it : results) if (it.status == 200) releaseSeats(it);
+            }
+        }
+    }
+
+    for (const auto& it : results) {
+        if (it.purchase && it.status == 200) recordPurchaseKey(it.ev.payment.transaction_id);
+    }
+
+    // 3) Jedan kompaktan odgovor i jedan update po vozilu (zadnje stanje po seat_seq)
+    struct VehicleChange {
+        std::string route;
+        int         reserved{0};
+        int         purchased{0};
+        int         available{0};
+        uint32_t    seat_seq{0};
+    };
+    std::map<std::string, VehicleChange> changes;
+    std::string status;
+    size_t succeeded = 0;
+    double total_amount = 0.0;
+    for (const auto& it : results) {
+        if (!status.empty()) status += ",";
+        status += std::to_string(it.status);
+        if (it.status != 200) continue;
+        ++succeeded;
+        const auto& seats = it.ev.seats;
+        VehicleChange& c = changes[seats.vehicle_uri];
+        c.route = seats.route;
+        if (it.purchase) {
+            c.purchased  += seats.seats;
+            total_amount += it.ev.payment.amount;
+        } else {
+            c.reserved += seats.seats;
+        }
+        if (seats.seat_seq >= c.seat_seq) {
+            c.seat_seq  = seats.seat_seq;
+            c.available = seats.available;
+        }
+    }
+
+    TP_LOG_INFO(logger_, "BATCH processed: items=", results.size(), ", ok=", succeeded,
+                ", vehicles=", changes.size());
+
+    sendResponse(client, MessageFactory::createSuccessResponse("Batch processed", {
+        {"count",        std::to_string(results.size())},
+        {"succeeded",    std::to_string(succeeded)},
+        {"status",       status},
+        {"total_amount", std::to_string(total_amount)}
+    }));
+
+    for (const auto& kv : changes) {
+        const VehicleChange& c = kv.second;
+        std::map<std::string, std::string> data{
+            {"route",           c.route},
+            {"vehicle_uri",     kv.first},
+            {"available_seats", std::to_string(c.available)}
+        };
+        if (c.reserved > 0)  data["reserved"]   = std::to_string(c.reserved);
+        if (c.purchased > 0) data["passengers"] = std::to_string(c.purchased);
+        sendMulticastUpdate(c.purchased > 0 ? "ticket_purchased" : "seat_reserved", data);
+    }
+}
+
 void CentralServer::handleGroupCreation(std::unique_ptr<Message> message,
                                         std::unique_ptr<TLSSocket>& client) {
     const std::string group_name = message->getString("group_name");
@@ -618,12 +1161,14 @@ void CentralServer::handleGroupCreation(std::unique_ptr<Message> message,
     g.creation_date = getCurrentTimestamp();
     g.active        = true;
 
-    auto db = DatabasePool::getInstance().getConnection();
-    bool ok = db->createGroup(g);
+    auto db = DatabasePool::getInstance().acquire();
+    int group_id = 0;
+    bool ok = db->createGroup(g, &group_id);
     const std::string dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
+    db.release();
 
     if (ok) {
+        groups_.put(group_name, GroupIndex::Entry{group_id, leader_urn, {leader_urn}});
         logInfo("Group created: " + group_name + " (leader=" + leader_urn + ")");
         sendSuccessResponse(client, "Group created successfully");
     } else {
@@ -655,23 +1200,26 @@ void CentralServer::handleAddMemberToGroup(std::unique_ptr<Message> message, std
         return;
     }
 
-    {
-        std::lock_guard<std::mutex> lk(sessions_mutex_);
-        auto it = client_sessions_.find(sid);
-        if (it == client_sessions_.end()) {
-            logWarning("ADD_MEMBER_TO_GROUP rejected: invalid/expired session");
-            sendErrorResponse(client, "Invalid or expired session", 401);
-            return;
-        }
-        it->second.last_activity = std::chrono::system_clock::now();
+    if (!sessions_.touch(sid)) {
+        logWarning("ADD_MEMBER_TO_GROUP rejected: invalid/expired session");
+        sendErrorResponse(client, "Invalid or expired session", 401);
+        return;
     }
 
-    auto db = DatabasePool::getInstance().getConnection();
-    bool ok = db->addUserToGroup(urn, group);
-    const std::string dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
+    auto entry = findGroup(group);
+    bool ok = false;
+    std::string dbErr = "Group not found";
+    if (entry && entry->members.count(urn)) {
+        dbErr = "User already in group";        // odbijeno iz memorije
+    } else if (entry) {
+        auto db = DatabasePool::getInstance().acquire();
+        ok    = db->addUsersToGroup(entry->group_id, {urn});
+        dbErr = db->getLastError();
+        db.release();
+    }
 
     if (ok) {
+        groups_.addMembers(group, {urn});
         logInfo("Group member added: urn=" + urn + " -> " + group);
         sendSuccessResponse(client, "User added to group");
     } else {
@@ -684,23 +1232,16 @@ void CentralServer::handleAddMemberToGroup(std::unique_ptr<Message> message, std
 bool CentralServer::requireGroupLeader(const std::string& session_id,
                                        const std::string& group_name,
                                        std::unique_ptr<TLSSocket>& client) {
-    std::string caller_urn;
-    {
-        std::lock_guard<std::mutex> lk(sessions_mutex_);
-        auto it = client_sessions_.find(session_id);
-        if (it == client_sessions_.end()) {
-            logWarning("Group op rejected: invalid/expired session");
-            sendErrorResponse(client, "Invalid or expired session", 401);
-            return false;
-        }
-        caller_urn = it->second.user_urn;
-        it->second.last_activity = std::chrono::system_clock::now();
+    auto session_urn = sessions_.touch(session_id);
+    if (!session_urn) {
+        logWarning("Group op rejected: invalid/expired session");
+        sendErrorResponse(client, "Invalid or expired session", 401);
+        return false;
     }
+    const std::string caller_urn = std::move(*session_urn);
 
-    auto db = DatabasePool::getInstance().getConnection();
-    std::string leader = db->getGroupLeader(group_name);
-    DatabasePool::getInstance().returnConnection(db);
-
+    auto entry = findGroup(group_name);
+    const std::string leader = entry ? entry->leader_urn : "";
     if (leader.empty()) {
         logWarning("Group op rejected: group not found or no leader set (" + group_name + ")");
         sendErrorResponse(client, "Group not found or no leader set", 404);
@@ -730,12 +1271,13 @@ void CentralServer::handleRemoveMemberFromGroup(std::unique_ptr<Message> message
 
     if (!requireGroupLeader(sid, group, client)) return;
 
-    auto db = DatabasePool::getInstance().getConnection();
+    auto db = DatabasePool::getInstance().acquire();
     bool ok = db->removeUserFromGroup(urn, group);
     const std::string dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
+    db.release();
 
     if (ok) {
+        groups_.removeMember(group, urn);
         logInfo("Group member removed: urn=" + urn + " from " + group);
         sendSuccessResponse(client, "User removed from group");
     } else {
@@ -745,6 +1287,159 @@ void CentralServer::handleRemoveMemberFromGroup(std::unique_ptr<Message> message
     }
 }
 
+void CentralServer::handleAddMembersToGroup(std::unique_ptr<Message> message, std::unique_ptr<TLSSocket>& client) {
+    const std::string sid   = message->getString("session_id");
+    const std::string group = message->getString("group_name");
+    const int count         = message->getInt("count");
+
+    logInfo("ADD_MEMBERS_TO_GROUP group=" + (group.empty()?"<missing>":group) +
+            ", count=" + std::to_string(count) +
+            ", session=" + (sid.empty()?"<missing>":sid));
+
+    if (sid.empty() || group.empty() || count < 1) {
+        sendErrorResponse(client, "Missing required fields (session_id, group_name, count)", 400);
+        return;
+    }
+    if (count > config_.admin_bulk_max_items) {
+        sendErrorResponse(client, "Too many members (max " + std::to_string(config_.admin_bulk_max_items) + ")", 413);
+        return;
+    }
+
+    std::vector<std::string> urns;
+    urns.reserve(static_cast<size_t>(count));
+    std::set<std::string> seen;
+    for (int i = 0; i < count; ++i) {
+        std::string urn = message->getString("m." + std::to_string(i) + ".urn");
+        if (urn.empty() || !seen.insert(urn).second) {
+            sendErrorResponse(client, "Missing or duplicate urn in item " + std::to_string(i), 400);
+            return;
+        }
+        urns.push_back(std::move(urn));
+    }
+
+    // Lider i postojeći članovi iz memorije; baza vidi samo upis
+    if (!requireGroupLeader(sid, group, client)) return;
+    auto entry = findGroup(group);
+    if (!entry) {
+        sendErrorResponse(client, "Group not found or no leader set", 404);
+        return;
+    }
+    for (const auto& urn : urns) {
+        if (entry->members.count(urn)) {
+            sendErrorResponse(client, "User already in group: " + urn, 409);
+            return;
+        }
+    }
+
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return sendErrorResponse(client, "No database connection", 500);
+    const bool ok           = db->addUsersToGroup(entry->group_id, urns);
+    const std::string dbErr = db->getLastError();
+    const int dbCode        = db->getLastErrorCode();
+    db.release();
+
+    if (!ok) {
+        logError("ADD_MEMBERS_TO_GROUP failed: group=" + group + (dbErr.empty()? "" : (" | " + dbErr)));
+        const int code = dbCode == SQLITE_NOTFOUND ? 404 : dbCode == SQLITE_CONSTRAINT ? 409 : 500;
+        sendErrorResponse(client, dbErr.empty() ? "Failed to add users to group" : dbErr, code);
+        return;
+    }
+
+    groups_.addMembers(group, urns);
+    logInfo("Group members added: " + std::to_string(urns.size()) + " -> " + group);
+    sendResponse(client, MessageFactory::createSuccessResponse("Users added to group", {
+        {"group_name", group}, {"added", std::to_string(urns.size())}}));
+}
+
+// ======================= STATE SNAPSHOT (WARM RESTART) =======================
+
+bool CentralServer::readSnapshot(StateSnapshot::Data& data) {
+    std::string error;
+    const auto result = StateSnapshot::read(config_.snapshot_path, data, &error);
+    if (result != StateSnapshot::ReadResult::OK) {
+        // Nema fajla = prvo pokretanje; sve ostalo je neupotrebljiv snimak (hladan start)
+        if (result == StateSnapshot::ReadResult::INVALID) logWarning("State snapshot ignored: " + error);
+        return false;
+    }
+    if (data.source != databasePath()) {
+        logWarning("State snapshot " + config_.snapshot_path + " belongs to database " + data.source + "; ignored");
+        return false;
+    }
+    // Jednokratno: pad nakon ovog pokretanja ne smije ponovo vratiti isto stanje sesija/mjesta
+    if (data.clean && !StateSnapshot::markConsumed(config_.snapshot_path)) {
+        logWarning("State snapshot " + config_.snapshot_path + " could not be marked consumed; cold start");
+        return false;
+    }
+    return true;
+}
+
+void CentralServer::warmFromSnapshot(const StateSnapshot::Data& data) {
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const uint64_t downtime_ms = now_ms > static_cast<int64_t>(data.created_ms)
+                               ? static_cast<uint64_t>(now_ms) - data.created_ms : 0;
+    size_t users = 0, sessions = 0, groups = 0;
+    {
+        // Zapisi se čitaju iz baze (snimak nosi samo ključeve), jedna konekcija za sve
+        auto db = DatabasePool::getInstance().acquire();
+        if (db) {
+            auto load = [&](const std::string& urn) {
+                bool failed = false;
+                return static_cast<bool>(findUser(urn, failed, db.get()));
+            };
+            for (const auto& urn : data.users) users += load(urn) ? 1 : 0;
+            // Samo iz clean snimka (periodični može nositi odjavljenu sesiju). Vrijeme van rada
+            // se računa kao neaktivnost; sesija obrisanog korisnika se ne vraća
+            for (const auto& s : data.sessions) {
+                if (!data.clean || !load(s.user_urn)) continue;
+                const auto idle = std::chrono::milliseconds(s.idle_ms + downtime_ms);
+                sessions += sessions_.restore({s.session_id, s.user_urn, idle}) ? 1 : 0;
+            }
+        }
+    }
+    for (const auto& name : data.groups) groups += findGroup(name) ? 1 : 0;
+    logInfo(std::string("State snapshot loaded (") + (data.clean ? "clean" : "periodic") + "): " +
+            std::to_string(sessions) + " sessions, " + std::to_string(users) + " users, " +
+            std::to_string(groups) + " groups warmed");
+}
+
+void CentralServer::writeSnapshot(bool clean) {
+    StateSnapshot::Data data;
+    data.created_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    data.clean  = clean;
+    data.source = databasePath();
+    // Inventar i sesije se vraćaju samo iz clean snimka, pa ih periodični ne nosi
+    if (clean) {
+        if (auto db = DatabasePool::getInstance().acquire()) {
+            size_t rows = 0;
+            if (!db->getVehicleTableStats(rows, data.vehicles_max_rowid)) data.vehicles_max_rowid = 0;
+        }
+        data.vehicles = seat_inventory_.exportVehicles();
+        for (auto& s : sessions_.exportSessions()) {
+            data.sessions.push_back({std::move(s.session_id), std::move(s.user_urn),
+                                     static_cast<uint64_t>(s.idle.count())});
+        }
+    }
+    data.users  = users_.keys(std::numeric_limits<size_t>::max());
+    data.groups = groups_.names();
+
+    std::string error;
+    if (!StateSnapshot::write(config_.snapshot_path, data, &error)) {
+        logWarning("State snapshot not written: " + error);
+    } else if (clean) {
+        logInfo("State snapshot written: " + std::to_string(data.sessions.size()) + " sessions, " +
+                std::to_string(data.vehicles.size()) + " vehicles");
+    }
+}
+
+std::shared_ptr<const GroupIndex::Entry> CentralServer::findGroup(const std::string& group_name) {
+    return groups_.find(group_name, [&] {
+        auto db = DatabasePool::getInstance().acquire();
+        return db ? db->getGroupByName(group_name) : nullptr;
+    });
+}
+
 // ======================= ADMIN UPDATE HANDLERS =======================
 
 void CentralServer::handleUpdatePrice(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& c) {
@@ -759,26 +1454,103 @@ void CentralServer::handleUpdatePrice(std::unique_ptr<Message> msg, std::unique_
         logWarning("UPDATE_PRICE bad price format: " + msg->getString("price"));
         return sendErrorResponse(c, "Invalid price format", 400);
     }
+    if (!prices_.get()->find(vt, tt)) {
+        logWarning("UPDATE_PRICE unknown vehicle/ticket type");
+        return sendErrorResponse(c, "Unknown vehicle_type/ticket_type", 400);
+    }
 
     logInfo(std::string("UPDATE_PRICE vt=") + vehicleTypeToString(vt) +
             ", tt=" + ticketTypeToString(tt) + ", price=" + std::to_string(price));
 
-    auto db = DatabasePool::getInstance().getConnection();
-    bool ok = db->updatePrice(vt, tt, price);
-    const std::string dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
-
-    if (!ok) {
+    std::string dbErr;
+    if (!updatePriceList(vt, tt, price, &dbErr)) {
         logError("UPDATE_PRICE failed: " + (dbErr.empty()? "<unknown>" : dbErr));
         return sendErrorResponse(c, dbErr.empty() ? "Failed to update price" : dbErr, 500);
     }
-
     sendSuccessResponse(c, "Price updated");
-    sendMulticastUpdate("price_updated", {
-        {"vehicle_type", std::to_string(static_cast<int>(vt))},
-        {"ticket_type",  std::to_string(static_cast<int>(tt))},
-        {"price",        msg->getString("price")}
-    });
+}
+
+namespace {
+
+std::map<std::string, std::string> priceUpdateFields(VehicleType vt, TicketType tt,
+                                                     const PriceSnapshot::Fare& fare) {
+    return {
+        {"vehicle_type",  std::to_string(static_cast<int>(vt))},
+        {"ticket_type",   std::to_string(static_cast<int>(tt))},
+        {"price",         std::to_string(fare.base_price)},
+        {"price_version", std::to_string(fare.version)}
+    };
+}
+
+} // namespace
+
+bool CentralServer::updatePriceList(VehicleType vehicle_type, TicketType ticket_type, double price,
+                                    std::string* error) {
+    std::lock_guard<std::mutex> lk(price_write_mutex_);
+    auto db = DatabasePool::getInstance().acquire();
+    const bool ok = db && db->updatePrice(vehicle_type, ticket_type, price);
+    if (!ok) {
+        if (error) *error = db ? db->getLastError() : "No database connection";
+        return false;
+    }
+    db.release();
+
+    // Baza je izvor istine; snapshot se mijenja tek nakon commita
+    const auto snap = prices_.update(vehicle_type, ticket_type, price);
+    const auto* fare = snap->find(vehicle_type, ticket_type);
+    if (fare) {
+        replicatePrice(vehicle_type, ticket_type, *fare);
+        sendMulticastUpdate("price_updated", priceUpdateFields(vehicle_type, ticket_type, *fare));
+    }
+    return true;
+}
+
+void CentralServer::broadcastPriceUpdate() {
+    // Cijeli cjenovnik (npr. nakon ponovnog spajanja regionalnog servera)
+    const auto snap = prices_.get();
+    for (int v = 1; v <= static_cast<int>(PriceSnapshot::kVehicleTypes); ++v) {
+        for (int t = 1; t <= static_cast<int>(PriceSnapshot::kTicketTypes); ++t) {
+            const auto vt = static_cast<VehicleType>(v);
+            const auto tt = static_cast<TicketType>(t);
+            if (const auto* fare = snap->find(vt, tt)) {
+                sendMulticastUpdate("price_updated", priceUpdateFields(vt, tt, *fare));
+            }
+        }
+    }
+}
+
+void CentralServer::loadPrices(Database& db) {
+    static const char* const kVehicleKeys[] = {"bus", "tram", "trolleybus"};
+    static const char* const kTicketKeys[]  = {"individual", "group_family", "group_business", "group_tourist"};
+    static const char* const kDiscountKeys[] = {nullptr, "family_group_discount",
+                                                "business_group_discount", "tourist_group_discount"};
+    const auto& cfg = getConfig();
+
+    // Verzija iz sata: klijentske kopije ostaju ispravne i nakon restarta servera
+    auto snap = std::make_shared<PriceSnapshot>();
+    snap->setVersion(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    const double time_mult = cfg.getDouble("pricing", "time_multiplier", 0.0);
+    for (size_t v = 0; v < PriceSnapshot::kVehicleTypes; ++v) {
+        const std::string vkey = kVehicleKeys[v];
+        const double dist_mult = cfg.getDouble("pricing", vkey + "_distance_multiplier", 0.0);
+        for (size_t t = 0; t < PriceSnapshot::kTicketTypes; ++t) {
+            PriceSnapshot::Fare f;
+            f.base_price          = cfg.getDouble("pricing", vkey + "_" + kTicketKeys[t], PriceSnapshot::kDefaultFare);
+            f.distance_multiplier = dist_mult;
+            f.time_multiplier     = time_mult;
+            f.version             = snap->version();
+            snap->setFare(static_cast<VehicleType>(v + 1), static_cast<TicketType>(t + 1), f);
+        }
+    }
+    for (size_t t = 0; t < PriceSnapshot::kTicketTypes; ++t) {
+        if (!kDiscountKeys[t]) continue;
+        snap->setGroupDiscount(static_cast<TicketType>(t + 1), cfg.getDouble("discounts", kDiscountKeys[t], 0.0) / 100.0);
+    }
+    const auto rows = db.getAllPrices();
+    snap->applyRows(rows);
+    prices_.publish(std::move(snap));
+    logInfo("Price list loaded: " + std::to_string(rows.size()) + " rows from database");
 }
 
 void CentralServer::handleUpdateVehicle(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& c) {
@@ -803,15 +1575,17 @@ void CentralServer::handleUpdateVehicle(std::unique_ptr<Message> msg, std::uniqu
     if (type.has_value())   os << ", type="  << vehicleTypeToString(*type);
     logInfo(os.str());
 
-    auto db = DatabasePool::getInstance().getConnection();
+    auto db = DatabasePool::getInstance().acquire();
     bool ok = db->updateVehicle(uri, active, route, type);
     const std::string dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
+    db.release();
 
     if (!ok) {
         logError("UPDATE_VEHICLE failed: " + (dbErr.empty()? "<unknown>" : dbErr));
         return sendErrorResponse(c, dbErr.empty() ? "Failed to update vehicle" : dbErr, 500);
     }
+    refreshInventory(uri);
+    replicateVehicle(uri);
 
     sendSuccessResponse(c, "Vehicle updated");
     sendMulticastUpdate("vehicle_updated", {{"uri", uri}});
@@ -830,15 +1604,24 @@ void CentralServer::handleUpdateCapacity(std::unique_ptr<Message> msg, std::uniq
             ", capacity=" + std::to_string(capacity) +
             ", available=" + std::to_string(available));
 
-    auto db = DatabasePool::getInstance().getConnection();
+    // Stanje koje admin mijenja; rezervacije tokom upisa se prenose (SeatInventory::amend)
+    const int seen = seat_inventory_.availableOf(uri);
+    auto db = DatabasePool::getInstance().acquire();
     bool ok = db->updateVehicleCapacity(uri, capacity, available);
     const std::string dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
+    db.release();
 
     if (!ok) {
         logError("UPDATE_CAPACITY failed: " + (dbErr.empty()? "<unknown>" : dbErr));
         return sendErrorResponse(c, dbErr.empty() ? "Failed to update capacity" : dbErr, 500);
     }
+    refreshInventory(uri, seen < 0 ? std::nullopt : std::optional<int>(seen));
+    replicateVehicle(uri);
+    // Novo stanje ima veći seat_seq od ranijih zapisa -> oporavak ga ne prepiše starim
+    if (!journalCapacity({{uri, capacity}})) {
+        logError("UPDATE_CAPACITY journal error: " + journal_.lastError());
+        return sendErrorResponse(c, "Capacity updated, journal record not confirmed", kOutcomeUnknown);
+    }
 
     sendSuccessResponse(c, "Capacity updated");
     sendMulticastUpdate("capacity_updated", {
@@ -848,66 +1631,434 @@ void CentralServer::handleUpdateCapacity(std::unique_ptr<Message> msg, std::uniq
     });
 }
 
+namespace {
+
+// Kod odgovora za grešku grupne izmjene u bazi
+int bulkErrorCode(int sqlite_code) {
+    if (sqlite_code == SQLITE_NOTFOUND) return 404;
+    if (sqlite_code == SQLITE_MISUSE)   return 400;
+    return 500;
+}
+
+} // namespace
+
+void CentralServer::handleBulkUpdateVehicles(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& c) {
+    const int count = msg->getInt("count");
+    if (count < 1) {
+        logWarning("BULK_UPDATE_VEHICLES without items");
+        return sendErrorResponse(c, "Missing count", 400);
+    }
+    if (count > config_.admin_bulk_max_items) {
+        logWarning("BULK_UPDATE_VEHICLES too large: " + std::to_string(count));
+        return sendErrorResponse(c, "Too many items (max " + std::to_string(config_.admin_bulk_max_items) + ")", 413);
+    }
+
+    std::vector<VehicleUpdate> updates;
+    updates.reserve(static_cast<size_t>(count));
+    std::set<std::string> seen;
+    for (int i = 0; i < count; ++i) {
+        const std::string p = "v." + std::to_string(i) + ".";
+        VehicleUpdate u;
+        u.uri = msg->getString(p + "uri");
+        if (u.uri.empty() || !seen.insert(u.uri).second) {
+            logWarning("BULK_UPDATE_VEHICLES bad item " + std::to_string(i));
+            return sendErrorResponse(c, "Missing or duplicate uri in item " + std::to_string(i), 400);
+        }
+        if (msg->hasKey(p + "active"))          u.active          = (msg->getInt(p + "active") != 0);
+        if (msg->hasKey(p + "route"))           u.route           = msg->getString(p + "route");
+        if (msg->hasKey(p + "vehicle_type"))    u.type            = static_cast<VehicleType>(msg->getInt(p + "vehicle_type"));
+        if (msg->hasKey(p + "capacity"))        u.capacity        = msg->getInt(p + "capacity");
+        if (msg->hasKey(p + "available_seats")) u.available_seats = msg->getInt(p + "available_seats");
+        updates.push_back(std::move(u));
+    }
+    logInfo("BULK_UPDATE_VEHICLES items=" + std::to_string(count));
+
+    // Stanje mjesta prije upisa (kao UPDATE_CAPACITY): rezervacije u međuvremenu se prenose
+    std::map<std::string, int> seats_seen;
+    for (const auto& u : updates) {
+        if (!u.capacity) continue;
+        const int seen_now = seat_inventory_.availableOf(u.uri);
+        if (seen_now >= 0) seats_seen[u.uri] = seen_now;
+    }
+
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return sendErrorResponse(c, "No database connection", 500);
+    if (!db->updateVehiclesBatch(updates)) {
+        const std::string dbErr = db->getLastError();
+        logError("BULK_UPDATE_VEHICLES failed: " + (dbErr.empty()? "<unknown>" : dbErr));
+        return sendErrorResponse(c, dbErr.empty() ? "Failed to update vehicles" : dbErr,
+                                 bulkErrorCode(db->getLastErrorCode()));
+    }
+
+    // Novo stanje svih vozila, pa jedna izmjena u inventaru. Na mjestu: bez kapaciteta živi
+    // brojač ostaje (noviji od baze, write-behind), uz kapacitet se prenose rezervacije
+    std::vector<Vehicle>            vehicles;
+    std::vector<std::optional<int>> seen_available;
+    std::vector<std::string>        seat_uris;
+    vehicles.reserve(updates.size());
+    seen_available.reserve(updates.size());
+    for (const auto& u : updates) {
+        auto v = db->getVehicle(u.uri);
+        if (!v) continue;
+        auto it = u.capacity ? seats_seen.find(u.uri) : seats_seen.end();
+        seen_available.push_back(it != seats_seen.end() ? std::optional<int>(it->second) : std::nullopt);
+        if (seen_available.back()) seat_uris.push_back(u.uri);
+        vehicles.push_back(std::move(*v));
+    }
+    seat_inventory_.amendAll(vehicles, seen_available);
+    if (!seat_uris.empty() && !journal_.isOpen() && !db->updateSeatAvailabilityBatch(seat_uris, liveSeats())) {
+        logWarning("BULK_UPDATE_VEHICLES: seat write failed: " + db->getLastError());
+    }
+    db.release();
+
+    std::string uris;
+    std::vector<std::pair<std::string, int>> capacities;
+    for (const auto& u : updates) {
+        replicateVehicle(u.uri);
+        if (u.capacity) capacities.emplace_back(u.uri, *u.capacity);
+        if (!uris.empty()) uris += ",";
+        uris += u.uri;
+    }
+    if (!journalCapacity(capacities)) {
+        logError("BULK_UPDATE_VEHICLES journal error: " + journal_.lastError());
+        return sendErrorResponse(c, "Vehicles updated, journal record not confirmed", kOutcomeUnknown);
+    }
+
+    sendResponse(c, MessageFactory::createSuccessResponse("Vehicles updated",
+                                                          {{"count", std::to_string(updates.size())}}));
+    sendMulticastUpdate("vehicles_updated", {{"count", std::to_string(updates.size())}, {"uris", uris}});
+}
+
+void CentralServer::handleBulkUpdatePrices(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& c) {
+    // Stavke su fare.<vozilo>.<karta> kao u odgovoru na GET_PRICES
+    std::vector<PriceList> rows;
+    const auto snap = prices_.get();
+    for (int v = 1; v <= static_cast<int>(PriceSnapshot::kVehicleTypes); ++v) {
+        for (int t = 1; t <= static_cast<int>(PriceSnapshot::kTicketTypes); ++t) {
+            const std::string key = "fare." + std::to_string(v) + "." + std::to_string(t);
+            if (!msg->hasKey(key)) continue;
+            PriceList row{};
+            row.vehicle_type = static_cast<VehicleType>(v);
+            row.ticket_type  = static_cast<TicketType>(t);
+            try { row.base_price = msg->getDouble(key); } catch (...) { row.base_price = -1.0; }
+            if (!(row.base_price >= 0.0) || !snap->find(row.vehicle_type, row.ticket_type)) {
+                logWarning("BULK_UPDATE_PRICES bad price for " + key);
+                return sendErrorResponse(c, "Invalid price for " + key, 400);
+            }
+            rows.push_back(row);
+        }
+    }
+    if (rows.empty() || static_cast<int>(rows.size()) != msg->getInt("count")) {
+        logWarning("BULK_UPDATE_PRICES count mismatch or unknown vehicle/ticket type");
+        return sendErrorResponse(c, "Missing or unknown fare.<vehicle_type>.<ticket_type>", 400);
+    }
+    logInfo("BULK_UPDATE_PRICES items=" + std::to_string(rows.size()));
+
+    std::unique_lock<std::mutex> price_lock(price_write_mutex_);
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return sendErrorResponse(c, "No database connection", 500);
+    if (!db->updatePricesBatch(rows)) {
+        const std::string dbErr = db->getLastError();
+        logError("BULK_UPDATE_PRICES failed: " + (dbErr.empty()? "<unknown>" : dbErr));
+        return sendErrorResponse(c, dbErr.empty() ? "Failed to update prices" : dbErr,
+                                 bulkErrorCode(db->getLastErrorCode()));
+    }
+    db.release();
+
+    // Jedan novi snapshot za cijeli cjenovnik; baza je već commit-ovana
+    const auto next = prices_.updateAll(rows);
+    std::map<std::string, std::string> fields{{"price_version", std::to_string(next->version())}};
+    for (const auto& row : rows) {
+        const auto* fare = next->find(row.vehicle_type, row.ticket_type);
+        if (!fare) continue;
+        replicatePrice(row.vehicle_type, row.ticket_type, *fare);
+        fields["fare." + std::to_string(static_cast<int>(row.vehicle_type)) + "." +
+               std::to_string(static_cast<int>(row.ticket_type))] = std::to_string(fare->base_price);
+    }
+    sendMulticastUpdate("price_list_updated", fields);
+    price_lock.unlock();
+
+    sendResponse(c, MessageFactory::createSuccessResponse("Prices updated", {
+        {"count",         std::to_string(rows.size())},
+        {"price_version", std::to_string(next->version())}
+    }));
+}
+
 // ======================= BACKGROUND / UTILS =======================
 
-void CentralServer::dataCollectionLoop() {
-    while (background_running_) {
-        logDebug("Background: collectVehicleData()");
-        collectVehicleData();
-        std::this_thread::sleep_for(std::chrono::seconds(config_.data_collection_interval));
+void CentralServer::flushInventory() {
+    if (seat_inventory_.dirtyCount() == 0) return;
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return;
+    const size_t rows = seat_inventory_.flush(*db);
+    if (rows == 0) {
+        logWarning("Seat inventory flush failed: " + db->getLastError());
+    } else {
+        logDebug("Background: seat inventory flushed " + std::to_string(rows) + " vehicles");
     }
 }
 
-void CentralServer::heartbeatLoop() {
-    while (background_running_) {
-        logDebug("Background: heartbeat()");
-        std::this_thread::sleep_for(std::chrono::seconds(config_.heartbeat_interval));
+// ======================= EVENT JOURNAL =======================
+
+bool CentralServer::journalCapacity(const std::vector<std::pair<std::string, int>>& capacities) {
+    if (!journal_.isOpen()) return true;
+    uint64_t last = 0;
+    for (const auto& [uri, capacity] : capacities) {
+        auto v = seat_inventory_.find(uri);
+        if (!v) continue;
+        journal_events::SeatChange ev{v->uri, "", v->route, capacity, v->capacity, v->available, v->seat_seq};
+        last = journal_.append(EventJournal::EventType::CAPACITY_SET, journal_events::encode(ev));
+        if (last == 0) return false;
     }
+    return last == 0 || journal_.waitDurable(last);
 }
 
-void CentralServer::sessionCleanupLoop() {
-    while (background_running_) {
-        logDebug("Background: sessionCleanup()");
-        cleanupExpiredSessions();
-        std::this_thread::sleep_for(std::chrono::seconds(300));
+bool CentralServer::openJournal() {
+    EventJournal::Options opt;
+    opt.commit_delay = std::chrono::microseconds(std::max(0, config_.journal_commit_delay_us));
+    if (!journal_.open(config_.journal_path, opt)) {
+        logError("Event journal: " + journal_.lastError());
+        return false;
+    }
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return false;
+
+    // 1) Karte/plaćanja koja nisu stigla u bazu (već upisane se preskaču)
+    journal_applied_ = 0;
+    const size_t records = applyJournal(*db);
+    if (journal_applied_ != journal_.lastLsn()) {
+        logError("Event journal replay stopped at LSN " + std::to_string(journal_applied_.load()));
+        return false;
+    }
+
+    // 2) Mjesta: po vozilu važi zapis sa najvećim seat_seq (zapisi ne moraju biti po redu)
+    std::map<std::string, journal_events::SeatChange> seats;
+    for (uint64_t after = 0;;) {
+        const auto batch = journal_.read(after);
+        if (batch.empty()) break;
+        for (const auto& r : batch) {
+            after = r.lsn;
+            journal_events::SeatChange ev;
+            journal_events::Purchase purchase;
+            const bool decoded = r.type == EventJournal::EventType::TICKETS_PURCHASED
+                                     ? journal_events::decode(r.payload, purchase)
+                                     : journal_events::decode(r.payload, ev);
+            if (!decoded) continue;
+            if (r.type == EventJournal::EventType::TICKETS_PURCHASED) ev = purchase.seats;
+            auto it = seats.find(ev.vehicle_uri);
+            if (it == seats.end() || ev.seat_seq >= it->second.seat_seq) seats[ev.vehicle_uri] = ev;
+        }
+    }
+    for (const auto& kv : seats) seat_inventory_.restoreSeats(kv.first, kv.second.available);
+
+    // 3) Sve je u bazi -> dnevnik se prazni (seat_seq kreće ispočetka sa novim load-om)
+    if (seat_inventory_.dirtyCount() > 0 && seat_inventory_.flush(*db) == 0) {
+        logError("Event journal recovery: seat flush failed: " + db->getLastError());
+        return false;
+    }
+    // Bez pražnjenja bi stari zapisi (veći seat_seq) pri sljedećem oporavku pregazili novo stanje
+    if (!journal_.resetIfLast(journal_applied_)) {
+        logError("Event journal recovery: reset failed: " + journal_.lastError());
+        return false;
+    }
+    logInfo("Event journal " + config_.journal_path + ": replayed " + std::to_string(records) +
+            " records, restored seats for " + std::to_string(seats.size()) + " vehicles");
+    return true;
+}
+
+size_t CentralServer::applyJournal(Database& db) {
+    size_t applied = 0;
+    for (;;) {
+        const auto batch = journal_.read(journal_applied_);
+        if (batch.empty()) return applied;
+        for (const auto& r : batch) {
+            if (r.type == EventJournal::EventType::TICKETS_PURCHASED) {
+                journal_events::Purchase ev;
+                if (!journal_events::decode(r.payload, ev) || ev.tickets.empty()) {
+                    logError("Event journal: undecodable purchase at LSN " + std::to_string(r.lsn));
+                } else if (!db.getTicket(ev.tickets.front().ticket_id) &&
+                           !db.purchaseTickets(ev.seats.vehicle_uri, ev.tickets, ev.payment,
+                                               nullptr, /*update_seats*/ false)) {
+                    // Ograničenje se neće promijeniti ponavljanjem; ostalo (npr. disk) se ponavlja
+                    logError("Event journal apply LSN " + std::to_string(r.lsn) + ": " + db.getLastError());
+                    if ((db.getLastErrorCode() & 0xff) != SQLITE_CONSTRAINT) return applied;
+                }
+            }
+            journal_applied_ = r.lsn;
+            ++applied;
+        }
+    }
+}
+
+void CentralServer::compactJournal(Database& db) {
+    // Prazni se samo ako je sve upisano: karte (applied == last) i mjesta (flush bez ostatka)
+    const uint64_t last = journal_applied_;
+    if (last != journal_.lastLsn()) return;
+    if (seat_inventory_.dirtyCount() > 0 && seat_inventory_.flush(db) == 0) return;
+    if (seat_inventory_.dirtyCount() > 0) return;
+    if (journal_.resetIfLast(last)) {
+        logDebug("Event journal compacted at LSN " + std::to_string(last));
+    }
+}
+
+void CentralServer::drainJournal() {
+    if (journal_.durableLsn() <= journal_applied_) return;
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return;
+    applyJournal(*db);
+    if (journal_.getStats().bytes >= static_cast<uint64_t>(config_.journal_compact_bytes)) compactJournal(*db);
+}
+
+void CentralServer::checkpointWal() {
+    // Auto-checkpoint je isključen na konekcijama (wal_autocheckpoint=0), pa pisci
+    // nikad ne plaćaju checkpoint u svom zahtjevu; PASSIVE ne čeka čitaoce.
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return;
+    int frames = 0, done = 0;
+    if (db->checkpoint(false, &frames, &done)) {
+        logDebug("Background: WAL checkpoint " + std::to_string(done) + "/" +
+                 std::to_string(frames) + " frames");
+    } else {
+        logWarning("WAL checkpoint failed: " + db->getLastError());
     }
 }
 
 void CentralServer::collectVehicleData() {
+    // Izmjene vozila (ruta/kapacitet) agregator pokupi u sljedećem prolazu
+    telemetry_.refreshVehicles();
+    auto rows = telemetry_.takeChanged();
+    if (rows.empty()) return;
+
+    auto db = DatabasePool::getInstance().acquire();
+    if (db && config_.telemetry_feed_seats) {
+        // Ulazak/izlazak putnika pomjera slobodna mjesta za razliku od zadnjeg uzorka (prvi put
+        // od zadnjeg upisanog stanja), pa rezervacije ostaju; dirty brojače upiše inventory_flush
+        std::vector<std::pair<std::string, int>> changed;
+        for (const auto& row : rows) {
+            auto v = seat_inventory_.find(row.uri);
+            if (!v) continue;
+            auto it = fed_occupancy_.find(row.uri);
+            if (it == fed_occupancy_.end()) {
+                auto last = db->getVehicleTelemetry(row.uri);
+                it = fed_occupancy_.emplace(row.uri, last ? last->occupancy : 0).first;
+            }
+            const int delta = row.occupancy - it->second;
+            it->second = row.occupancy;
+            if (delta != 0 && seat_inventory_.adjustSeats(row.uri, -delta) >= 0) {
+                changed.emplace_back(row.uri, v->capacity);
+            }
+        }
+        if (!journalCapacity(changed)) logWarning("Telemetry seats: journal append failed");
+    }
 
+    if (!db || !db->upsertVehicleTelemetryBatch(rows)) {
+        telemetry_.markChanged(rows);
+        logWarning("Vehicle telemetry persist failed: " + (db ? db->getLastError() : std::string("no database")));
+        return;
+    }
+    logDebug("Background: vehicle telemetry persisted " + std::to_string(rows.size()) + " vehicles");
+}
+
+void CentralServer::handleTelemetry(const MessageView& view, std::unique_ptr<TLSSocket>& client) {
+    std::vector<TelemetrySample> samples;
+    if (!telemetry::decodeSamples(view.getBinary("samples"), samples)) {
+        logWarning("VEHICLE_TELEMETRY rejected: malformed samples");
+        sendErrorResponse(client, "Malformed telemetry samples", 400);
+        return;
+    }
+    if (samples.size() > static_cast<size_t>(config_.telemetry_max_samples)) {
+        logWarning("VEHICLE_TELEMETRY rejected: " + std::to_string(samples.size()) + " samples (max " +
+                   std::to_string(config_.telemetry_max_samples) + ")");
+        sendErrorResponse(client, "Too many telemetry samples", 413);
+        return;
+    }
+    const size_t accepted = telemetry_.submit(samples);
+    sendResponse(client, MessageFactory::createSuccessResponse("", {
+        {"accepted", std::to_string(accepted)},
+        {"dropped", std::to_string(samples.size() - accepted)}}));
 }
 
 void CentralServer::cleanupExpiredSessions() {
-    const auto now = std::chrono::system_clock::now();
-    const auto ttl = std::chrono::seconds(config_.session_timeout);
-    std::lock_guard<std::mutex> lk(sessions_mutex_);
-    for (auto it = client_sessions_.begin(); it != client_sessions_.end(); ) {
-        if (!it->second.authenticated || (now - it->second.last_activity) > ttl) it = client_sessions_.erase(it);
-        else ++it;
+    const size_t expired = sessions_.expire();
+    if (expired > 0) {
+        logDebug("Background: expired " + std::to_string(expired) + " sessions (" +
+                 std::to_string(sessions_.size()) + " active)");
     }
 }
 
 std::string CentralServer::generateSessionId() {
-    static std::atomic<int> counter{0};
-    return "session_" + std::to_string(++counter);
+    return SessionStore::generateToken();
 }
 
+// ULID sufiks: jedinstven i preko restarta (replay dnevnika prepoznaje upisane karte po
+// ticket_id), a rastući redoslijed drži umetanja na kraju indeksa tabele
 std::string CentralServer::generateTicketId() {
-    static std::atomic<int> counter{0};
-    return std::string("TKT_") + std::to_string(++counter) + "_" + std::to_string(std::time(nullptr));
+    return Utils::generateId("TKT_");
+}
+
+CentralServer::PurchaseKeyState CentralServer::claimPurchaseKey(const std::string& transaction_id) {
+    auto known = [this](const std::string& key) {
+        auto it = purchase_keys_.find(key);
+        if (it == purchase_keys_.end()) return PurchaseKeyState::CLAIMED;
+        return it->second.recorded ? PurchaseKeyState::RECORDED : PurchaseKeyState::IN_FLIGHT;
+    };
+    {
+        std::lock_guard<std::mutex> lk(purchase_keys_mutex_);
+        const auto state = known(transaction_id);
+        if (state != PurchaseKeyState::CLAIMED) return state;
+    }
+    // Van prozora (npr. zahtjev ponovljen nakon restarta): kupovina je možda već u bazi
+    if (auto db = DatabasePool::getInstance().acquire()) {
+        if (db->getPayment(transaction_id)) return PurchaseKeyState::RECORDED;
+    }
+
+    std::lock_guard<std::mutex> lk(purchase_keys_mutex_);
+    const auto state = known(transaction_id);   // paralelni duplikat
+    if (state != PurchaseKeyState::CLAIMED) return state;
+    const uint64_t gen = ++purchase_key_seq_;
+    purchase_keys_.emplace(transaction_id, PurchaseKey{gen, false});
+    purchase_key_order_.emplace_back(transaction_id, gen);
+
+    auto stale = [this](const std::pair<std::string, uint64_t>& entry) {
+        auto it = purchase_keys_.find(entry.first);
+        return it == purchase_keys_.end() || it->second.gen != entry.second;
+    };
+    const size_t window = static_cast<size_t>(config_.purchase_key_window);
+    while (purchase_keys_.size() > window) {
+        const auto& front = purchase_key_order_.front();
+        if (!stale(front)) purchase_keys_.erase(front.first);
+        purchase_key_order_.pop_front();
+    }
+    while (!purchase_key_order_.empty() && stale(purchase_key_order_.front())) purchase_key_order_.pop_front();
+    // Oslobođeni ključevi iza živih: povremeno sabij FIFO da ne raste preko prozora
+    if (purchase_key_order_.size() > 2 * window) {
+        purchase_key_order_.erase(std::remove_if(purchase_key_order_.begin(), purchase_key_order_.end(), stale),
+                                  purchase_key_order_.end());
+    }
+    return PurchaseKeyState::CLAIMED;
+}
+
+void CentralServer::recordPurchaseKey(const std::string& transaction_id) {
+    if (transaction_id.compare(0, 3, "IK-") != 0) return;
+    std::lock_guard<std::mutex> lk(purchase_keys_mutex_);
+    auto it = purchase_keys_.find(transaction_id);
+    if (it != purchase_keys_.end()) it->second.recorded = true;
+}
+
+void CentralServer::releasePurchaseKey(const std::string& transaction_id) {
+    // Kupovina nije zabilježena: ponovljen zahtjev smije ponovo. Unos u FIFO ostaje, ali
+    // mu generacija više ne odgovara pa ga izbacivanje preskače
+    if (transaction_id.compare(0, 3, "IK-") != 0) return;
+    std::lock_guard<std::mutex> lk(purchase_keys_mutex_);
+    purchase_keys_.erase(transaction_id);
 }
 
 std::string CentralServer::generateTransactionId() {
-    static std::atomic<int> counter{0};
-    return std::string("TX_") + std::to_string(++counter) + "_" + std::to_string(std::time(nullptr));
+    return Utils::generateId("TX_");
 }
 
 std::string CentralServer::getCurrentTimestamp() {
-    auto now = std::time(nullptr);
-    auto tm = localtime_safe(now);
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
+    return ClockService::timestamp();
 }
 
 bool CentralServer::validateURN(const std::string& urn) {
@@ -927,39 +2078,211 @@ void CentralServer::setCertificatePath(const std::string& cert_path, const std::
 
 void CentralServer::sendMulticastUpdate(const std::string& update_type,
                                         const std::map<std::string, std::string>& data) {
-    // LOGUJ ŠTA ŠALJEŠ
-    std::ostringstream os;
-    os << "Broadcast: " << update_type << " {";
-    bool first = true;
-    for (auto& kv : data) {
-        if (!first) os << ", ";
-        os << kv.first << "=" << kv.second;
-        first = false;
-    }
-    os << "}";
-    logInfo(os.str());
+    // Ispis svih polja samo uz uključen DEBUG
+    if (logger_ && logger_->isEnabled(Logger::LogLevel::DEBUG)) {
+        std::string fields;
+        for (auto& kv : data) {
+            if (!fields.empty()) fields += ", ";
+            fields += kv.first + "=" + kv.second;
+        }
+        logger_->logf(Logger::LogLevel::DEBUG, "Broadcast: ", update_type, " {", fields, "}");
+    }
+    tracing::Span span("broadcast.publish");
 
-    auto message = MessageFactory::createMulticastUpdate(update_type, data);
-    std::lock_guard<std::mutex> lock(broadcast_mutex_);
+    const bool datagram = publishDatagram(update_type, data);
 
-    // pokušaj slanja svim subscriberima; ukloni nevažeće
-    auto end_it = std::remove_if(subscribers_.begin(), subscribers_.end(),
-        [&](TLSSocket* sub){
-            if (!sub) return true;
-            bool ok = false;
-            try {
-                ok = sub->sendMessage(*message);
-            } catch (...) {
-                ok = false;
-            }
-            if (!ok) logWarning("Broadcast drop: one subscriber not reachable");
-            return !ok;
-        });
-    subscribers_.erase(end_it, subscribers_.end());
+    // Ažuriranje istog tipa za isto vozilo koje još čeka u redu zamjenjuje se novijim
+    std::string key;
+    auto uri = data.find("vehicle_uri");
+    if (uri == data.end()) uri = data.find("uri");
+    if (uri != data.end()) key = update_type + "|" + uri->second;
+
+    broadcast_.publish(MessageFactory::createMulticastUpdate(update_type, data), std::move(key),
+                       datagram ? kDatagramFallbackTopic : std::string());
 }
 
 // ======================= UDP Multicast (Boost.Asio) =======================
 
+bool CentralServer::publishDatagram(const std::string& update_type,
+                                    const std::map<std::string, std::string>& data) {
+    if (update_type != "seat_reserved" && update_type != "ticket_purchased" &&
+        update_type != "price_updated" && update_type != "price_list_updated") {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lk(mcast_pub_mutex_);
+    if (!mcast_data_ready_) return false;
+
+    // Redni broj se dodjeljuje pod mutex-om, pa je redoslijed u replay prozoru isti kao na mreži
+    const uint64_t seq = mcast_seq_ + 1;
+    auto message = MessageFactory::createMulticastUpdate(update_type, data);
+    message->addString("mcast_seq", std::to_string(seq));
+
+    std::vector<uint8_t> frame;
+    message->serializeTo(frame, mcast::kFrameVersion);
+    auto datagram = std::make_shared<std::vector<uint8_t>>();
+    if (!mcast::encodeDatagram(seq, frame.data(), frame.size(), mcast_signer_, *datagram)) {
+        logWarning("Multicast datagram too large for " + update_type + "; sending over TLS");
+        return false;
+    }
+    mcast_seq_ = seq;
+
+    mcast_replay_.push_back({seq, datagram});
+    while (mcast_replay_.size() > static_cast<size_t>(config_.multicast_resync_window)) {
+        mcast_replay_.pop_front();
+    }
+
+    // Slanje na mcast io niti; handler ne čeka mrežu
+    boost::asio::post(*mcast_io_, [this, datagram]() {
+        if (!mcast_sock_) return;
+        mcast_sock_->async_send_to(boost::asio::buffer(*datagram), mcast_group_,
+            [this, datagram](const boost::system::error_code& ec, std::size_t) {
+                if (ec) logWarning("Multicast data plane send_to error: " + ec.message());
+            });
+    });
+    return true;
+}
+
+void CentralServer::handleMcastResync(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& client) {
+    if (!sessions_.touch(msg->getString("session_id"))) {
+        sendErrorResponse(client, "Invalid or expired session", 401);
+        return;
+    }
+    uint64_t from = 0, to = 0;
+    try {
+        from = std::stoull(msg->getString("from_seq"));
+        to   = std::stoull(msg->getString("to_seq"));
+    } catch (...) {
+        from = to = 0;
+    }
+    if (from == 0 || to < from) {
+        sendErrorResponse(client, "Invalid resync range (from_seq, to_seq)", 400);
+        return;
+    }
+
+    std::vector<std::shared_ptr<const std::vector<uint8_t>>> frames;
+    uint64_t last_seq = 0;
+    {
+        std::lock_guard<std::mutex> lk(mcast_pub_mutex_);
+        last_seq = mcast_seq_;
+        if (!mcast_replay_.empty()) {
+            const uint64_t first = mcast_replay_.front().seq;
+            const uint64_t lo = std::max(from, first);
+            const uint64_t hi = std::min(to, mcast_replay_.back().seq);
+            for (uint64_t s = lo; s <= hi; ++s) frames.push_back(mcast_replay_[s - first].datagram);
+        }
+    }
+
+    // Propušteni update-i idu kao obični MULTICAST_UPDATE okviri, pa završni odgovor;
+    // okvir iz datagrama ide kakav jeste samo klijentu koji je dogovorio tu verziju
+    const uint16_t version = client->getProtocolVersion();
+    size_t replayed = 0;
+    std::vector<uint8_t> converted;
+    for (const auto& d : frames) {
+        const uint8_t* frame = d->data() + mcast::kHeaderLength;
+        const size_t len     = d->size() - mcast::kHeaderLength - mcast::kSignatureLength;
+        if (version != mcast::kFrameVersion) {
+            Message update;
+            if (!update.deserialize(frame, len)) continue;
+            converted.clear();
+            update.serializeTo(converted, version);
+            if (!client->sendFrame(converted.data(), converted.size())) return;
+        } else if (!client->sendFrame(frame, len)) {
+            return;
+        }
+        ++replayed;
+    }
+    const uint64_t upto    = std::min(to, last_seq);
+    const uint64_t wanted  = upto >= from ? upto - from + 1 : 0;
+    const uint64_t missing = wanted > replayed ? wanted - replayed : 0;
+    if (missing > 0) {
+        logWarning("MCAST_RESYNC: " + std::to_string(missing) + " updates older than the resync window");
+    }
+    sendResponse(client, MessageFactory::createSuccessResponse("Resync complete", {
+        {"replayed", std::to_string(replayed)},
+        {"missing",  std::to_string(missing)},
+        {"last_seq", std::to_string(last_seq)}
+    }));
+}
+
+namespace {
+
+std::vector<VehicleStatusRecord> toStatusRecords(const std::vector<SeatInventory::Snapshot>& snaps) {
+    std::vector<VehicleStatusRecord> out;
+    out.reserve(snaps.size());
+    for (const auto& s : snaps) {
+        VehicleStatusRecord r;
+        r.uri       = s.uri;
+        r.type      = s.type;
+        r.route     = s.route;
+        r.capacity  = s.capacity;
+        r.available = s.available;
+        r.active    = s.active;
+        r.version   = s.version;
+        out.push_back(std::move(r));
+    }
+    return out;
+}
+
+const std::string kStatusTopicPrefix = "status:";
+
+} // namespace
+
+void CentralServer::handleVehicleStatus(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& client) {
+    const std::string routes_csv = msg->getString("routes");
+    const auto routes = vehicle_status::parseRoutes(routes_csv);
+    const uint64_t since = std::strtoull(msg->getString("since_version").c_str(), nullptr, 10);
+    const bool subscribe = msg->getBool("subscribe");
+
+    if (subscribe) {
+        if (!sessions_.touch(msg->getString("session_id"))) {
+            sendErrorResponse(client, "Invalid or expired session", 401);
+            return;
+        }
+        // Pretplata prije snapshot-a: delta koja stigne prije odgovora nosi novije
+        // verzije vozila, a klijent primjenjuje zapise po verziji (VehicleStatusView)
+        if (routes.empty()) {
+            broadcast_.subscribe(client.get(), kStatusTopicPrefix + "*");
+        } else {
+            for (const auto& r : routes) broadcast_.subscribe(client.get(), kStatusTopicPrefix + r);
+        }
+    }
+
+    const auto st = seat_inventory_.statusSince(routes, since);
+    auto resp = MessageFactory::createVehicleStatus(st.version, since, st.full,
+                                                    toStatusRecords(st.vehicles),
+                                                    toStatusRecords(st.removed));
+    resp->addString("routes", routes.empty() ? "*" : routes_csv);
+    sendResponse(client, std::move(resp));
+}
+
+void CentralServer::pushStatusDeltas() {
+    const uint64_t pushed = status_pushed_;
+    if (seat_inventory_.version() == pushed) return;
+
+    // Svaka tema dobija deltu (pushed, v]; sljedeći krug kreće od najmanje v
+    // (duplikati su bezopasni, klijent ih odbaci po verziji vozila)
+    uint64_t reached = UINT64_MAX;
+    for (const auto& topic : broadcast_.activeTopics()) {
+        if (topic.compare(0, kStatusTopicPrefix.size(), kStatusTopicPrefix) != 0) continue;
+        const std::string route = topic.substr(kStatusTopicPrefix.size());
+        std::vector<std::string> routes;
+        if (route != "*") routes.push_back(route);
+
+        const auto st = seat_inventory_.statusSince(routes, pushed);
+        reached = std::min(reached, st.version);
+        if (!st.full && st.vehicles.empty() && st.removed.empty()) continue;
+
+        auto delta = MessageFactory::createVehicleStatus(st.version, pushed, st.full,
+                                                         toStatusRecords(st.vehicles),
+                                                         toStatusRecords(st.removed));
+        delta->addString("routes", route);
+        // Bez coalesce ključa: uzastopne delte nose različita vozila
+        broadcast_.publish(std::move(delta), "", topic);
+    }
+    status_pushed_ = reached == UINT64_MAX ? seat_inventory_.version() : reached;
+}
+
 bool CentralServer::setupMulticast() {
     using boost::asio::ip::udp;
 
@@ -977,6 +2300,19 @@ bool CentralServer::setupMulticast() {
         mcast_sock_->set_option(boost::asio::ip::multicast::enable_loopback(true));
 
         mcast_group_ = udp::endpoint(group_addr, static_cast<unsigned short>(config_.multicast_port));
+        mcast_sock_->set_option(boost::asio::ip::multicast::hops(config_.multicast_ttl));
+
+        if (config_.multicast_data_plane) {
+            std::string seed;
+            if (!config_.multicast_signing_key.empty() &&
+                (!mcast::fromHex(config_.multicast_signing_key, seed) || seed.size() != mcast::kKeyLength)) {
+                logWarning("Invalid [multicast] signing_key (expected 32 bytes hex); using a random key");
+                seed.clear();
+            }
+            std::lock_guard<std::mutex> lk(mcast_pub_mutex_);
+            if (!mcast_signer_.init(seed)) throw std::runtime_error("Ed25519 key setup failed for multicast data plane");
+            mcast_data_ready_ = true;
+        }
 
         startMulticastReceive_();
 
@@ -984,7 +2320,8 @@ bool CentralServer::setupMulticast() {
             try { io->run(); } catch (const std::exception&) {}
         });
 
-        logInfo("Multicast discovery started on " + config_.multicast_address + ":" + std::to_string(config_.multicast_port));
+        logInfo("Multicast discovery started on " + config_.multicast_address + ":" + std::to_string(config_.multicast_port) +
+                (config_.multicast_data_plane ? " (data plane on)" : ""));
         return true;
     } catch (const std::exception& e) {
         logWarning(std::string("setupMulticast failed: ") + e.what());
@@ -994,6 +2331,11 @@ bool CentralServer::setupMulticast() {
 }
 
 void CentralServer::cleanupMulticast() {
+    {
+        // Handleri koji još rade više ne šalju datagrame (ni ne diraju mcast_io_)
+        std::lock_guard<std::mutex> lk(mcast_pub_mutex_);
+        mcast_data_ready_ = false;
+    }
     try {
         if (mcast_sock_) {
             boost::system::error_code ec;
@@ -1018,7 +2360,9 @@ void CentralServer::startMulticastReceive_() {
         boost::asio::buffer(mcast_rx_buf_), *sender,
         [this, sender](const boost::system::error_code& ec, std::size_t n) {
             if (!mcast_sock_) return;
-            if (!ec && n > 0) {
+            // Vlastiti data plane datagrami se vraćaju preko loopback-a; ignoriši ih
+            if (!ec && n > 0 &&
+                !mcast::looksLikeDatagram(reinterpret_cast<const uint8_t*>(mcast_rx_buf_.data()), n)) {
                 std::string msg(mcast_rx_buf_.data(), mcast_rx_buf_.data() + n);
 
                 while (!msg.empty() && (msg.back() == '\r' || msg.back() == '\n' || msg.back() == ' '))
@@ -1039,6 +2383,229 @@ void CentralServer::startMulticastReceive_() {
     );
 }
 
+// ======================= REGIONAL REPLICATION =======================
+
+void CentralServer::replicateUser(const std::string& urn, const std::string& name, bool deleted) {
+    replication_.append(deleted ? ReplicationRecord::Kind::USER_DELETE : ReplicationRecord::Kind::USER_UPSERT,
+                        urn, name);
+}
+
+void CentralServer::replicateVehicle(const std::string& uri) {
+    // Stanje iz inventara (write-behind brojači su noviji od baze)
+    const auto v = seat_inventory_.find(uri);
+    if (!v) return;
+    Vehicle vehicle;
+    vehicle.uri             = v->uri;
+    vehicle.type            = v->type;
+    vehicle.route           = v->route;
+    vehicle.capacity        = v->capacity;
+    vehicle.available_seats = v->available;
+    vehicle.active          = v->active;
+    replication_.append(ReplicationRecord::Kind::VEHICLE_UPSERT, uri, replication::encodeVehicle(vehicle));
+}
+
+void CentralServer::replicatePrice(VehicleType vehicle_type, TicketType ticket_type, const PriceSnapshot::Fare& fare) {
+    replication_.append(ReplicationRecord::Kind::PRICE_UPSERT, replication::fareKey(vehicle_type, ticket_type),
+                        replication::encodeFare(fare));
+}
+
+void CentralServer::buildReplicaSnapshot(std::vector<ReplicationRecord>& records, uint64_t& to) {
+    // Head prije čitanja: promjene tokom čitanja stižu i kao zapisi poslije snapshot-a
+    // (upsert/brisanje su idempotentni, pa dupla primjena ne smeta)
+    to = replication_.head();
+    records.clear();
+    auto add = [&](ReplicationRecord::Kind kind, std::string key, std::string value) {
+        ReplicationRecord r;
+        r.offset = to;
+        r.kind   = kind;
+        r.key    = std::move(key);
+        r.value  = std::move(value);
+        records.push_back(std::move(r));
+    };
+
+    if (auto db = DatabasePool::getInstance().acquire()) {
+        db->forEachUser([&](const User& u) {
+            add(ReplicationRecord::Kind::USER_UPSERT, u.urn, u.name);
+            return true;
+        });
+        for (auto v : db->getAllVehicles()) {
+            if (const auto cur = seat_inventory_.find(v.uri)) {
+                v.capacity        = cur->capacity;
+                v.available_seats = cur->available;
+            }
+            add(ReplicationRecord::Kind::VEHICLE_UPSERT, v.uri, replication::encodeVehicle(v));
+        }
+    }
+    const auto snap = prices_.get();
+    for (int v = 1; v <= static_cast<int>(PriceSnapshot::kVehicleTypes); ++v) {
+        for (int t = 1; t <= static_cast<int>(PriceSnapshot::kTicketTypes); ++t) {
+            const auto vt = static_cast<VehicleType>(v);
+            const auto tt = static_cast<TicketType>(t);
+            if (const auto* fare = snap->find(vt, tt)) {
+                add(ReplicationRecord::Kind::PRICE_UPSERT, replication::fareKey(vt, tt), replication::encodeFare(*fare));
+            }
+        }
+    }
+}
+
+bool CentralServer::registerRegionalServer(const std::string& server_id, const std::string& address, int port) {
+    if (server_id.empty() || address.empty() || port <= 0) return false;
+    std::lock_guard<std::mutex> lk(servers_mutex_);
+    auto& info = regional_servers_[server_id];
+    // Ponovna registracija otvara novu vezu; kursor se ponovo uzima od regionalnog servera
+    if (info.connection) info.connection->close();
+    info.connection.reset();
+    info.active    = false;
+    info.server_id = server_id;
+    info.address   = address;
+    info.port      = port;
+    logInfo("Regional server registered: " + server_id + " (" + address + ":" + std::to_string(port) + ")");
+    return true;
+}
+
+bool CentralServer::connectToRegionalServer(RegionalServerInfo& server) {
+    // Sync petlja čeka odgovor pod servers_mutex_: rok, da zaglavljen regionalni server
+    // ne drži bravu (ni join u stopBackgroundTasks) neograničeno
+    auto sock = std::make_unique<TLSSocket>();
+    SocketOptions options;
+    options.receive_timeout_ms = config_.regional_timeout_ms;
+    sock->setSocketOptions(options);
+    if (!sock->connect(server.address, server.port) || !sock->enableFullDuplex()) {
+        logWarning("Regional server " + server.server_id + " unreachable");
+        return false;
+    }
+    server.connection = std::move(sock);
+    server.active     = true;
+
+    // Regionalni server javlja epoch i offset svoje kopije -> nastavak od tog offset-a
+    const auto hello = MessageFactory::createReplicaSync(server.server_id, replication_.epoch(),
+                                                         config_.regional_sync_key);
+    const auto reply = exchangeWithRegional(server, *hello);
+    if (!reply || reply->getType() != MessageType::RESPONSE_SUCCESS) {
+        logWarning("Regional server " + server.server_id + " rejected REPLICA_SYNC" +
+                   (reply ? ": " + reply->getString("error") : std::string()));
+        if (server.connection) server.connection->close();
+        server.connection.reset();
+        server.active = false;
+        return false;
+    }
+    const uint64_t epoch = std::strtoull(reply->getString("epoch").c_str(), nullptr, 10);
+    server.stats.acked     = std::strtoull(reply->getString("offset").c_str(), nullptr, 10);
+    server.snapshot_needed = epoch != replication_.epoch();
+    server.stats.connects++;
+    logInfo("Regional server " + server.server_id + " connected at offset " + std::to_string(server.stats.acked) +
+            (server.snapshot_needed ? " (snapshot needed)" : ""));
+    return true;
+}
+
+std::unique_ptr<Message> CentralServer::exchangeWithRegional(RegionalServerInfo& server, const Message& request) {
+    if (!server.connection) return nullptr;
+    std::unique_ptr<Message> reply;
+    if (server.connection->sendMessage(request)) reply = server.connection->receiveMessage();
+    if (!reply) {
+        logWarning("Regional server " + server.server_id + " link lost");
+        server.connection->close();
+        server.connection.reset();
+        server.active = false;
+    }
+    return reply;
+}
+
+bool CentralServer::syncWithRegionalServer(const std::string& server_id) {
+    std::lock_guard<std::mutex> lk(servers_mutex_);
+    auto it = regional_servers_.find(server_id);
+    if (it == regional_servers_.end()) return false;
+    auto& server = it->second;
+    if (!server.active && !connectToRegionalServer(server)) return false;
+
+    int rejected = 0;
+    for (;;) {
+        std::vector<ReplicationRecord> records;
+        uint64_t from = server.stats.acked, to = 0;
+        const bool snapshot = server.snapshot_needed ||
+            !replication_.since(from, static_cast<size_t>(config_.regional_batch_records), records);
+        if (snapshot) {
+            from = 0;
+            buildReplicaSnapshot(records, to);
+        } else {
+            if (records.empty()) return true;   // regionalni server ima sve
+            to = records.back().offset;
+        }
+
+        const auto frame = MessageFactory::createReplicaBatch(replication_.epoch(), from, to, snapshot, records,
+                                                              config_.regional_compression);
+        const size_t wire = frame->getBinary("records").size();
+        const auto reply = exchangeWithRegional(server, *frame);
+        if (!reply) return false;
+        if (reply->getType() != MessageType::RESPONSE_SUCCESS) {
+            // Kopija se razišla (npr. regionalni restart): nastavi od njenog offset-a ili snapshot
+            logWarning("Regional server " + server_id + " rejected batch (" + std::to_string(from) + ", " +
+                       std::to_string(to) + "]: " + reply->getString("error"));
+            if (++rejected > 1) return false;
+            server.snapshot_needed = !reply->hasKey("offset");
+            server.stats.acked     = std::strtoull(reply->getString("offset").c_str(), nullptr, 10);
+            continue;
+        }
+
+        server.snapshot_needed = false;
+        server.stats.acked     = to;
+        server.stats.frames++;
+        if (snapshot) server.stats.snapshots++;
+        server.stats.records    += records.size();
+        server.stats.raw_bytes  += static_cast<uint64_t>(std::max(0, frame->getInt("raw_size")));
+        server.stats.wire_bytes += wire;
+        TP_LOG_DEBUG(logger_, "REPLICA_BATCH -> ", server_id, ": ", records.size(), " records (",
+                     from, ", ", to, "]", snapshot ? " snapshot" : "");
+    }
+}
+
+void CentralServer::sendToRegionalServer(const std::string& server_id, std::unique_ptr<Message> message) {
+    if (!message) return;
+    std::lock_guard<std::mutex> lk(servers_mutex_);
+    auto it = regional_servers_.find(server_id);
+    if (it == regional_servers_.end()) return;
+    if (!it->second.active && !connectToRegionalServer(it->second)) return;
+    exchangeWithRegional(it->second, *message);
+}
+
+void CentralServer::broadcastToRegionalServers(std::unique_ptr<Message> message) {
+    if (!message) return;
+    std::vector<std::string> ids;
+    {
+        std::lock_guard<std::mutex> lk(servers_mutex_);
+        for (const auto& kv : regional_servers_) ids.push_back(kv.first);
+    }
+    for (const auto& id : ids) sendToRegionalServer(id, std::make_unique<Message>(*message));
+}
+
+std::optional<CentralServer::RegionalSyncStats> CentralServer::getRegionalSyncStats(const std::string& server_id) {
+    std::lock_guard<std::mutex> lk(servers_mutex_);
+    auto it = regional_servers_.find(server_id);
+    if (it == regional_servers_.end()) return std::nullopt;
+    auto stats   = it->second.stats;
+    stats.active = it->second.active;
+    return stats;
+}
+
+void CentralServer::regionalSyncLoop() {
+    auto next = std::chrono::steady_clock::now();
+    while (background_running_) {
+        if (std::chrono::steady_clock::now() >= next) {
+            std::vector<std::string> ids;
+            {
+                std::lock_guard<std::mutex> lk(servers_mutex_);
+                for (const auto& kv : regional_servers_) ids.push_back(kv.first);
+            }
+            for (const auto& id : ids) {
+                if (!background_running_) break;
+                syncWithRegionalServer(id);
+            }
+            next = std::chrono::steady_clock::now() + std::chrono::seconds(config_.regional_sync_interval);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
 // ========================================================
 // ====== Stubs / no-op helpers to avoid linker errors =====
 // ========================================================
@@ -1046,13 +2613,15 @@ void CentralServer::startMulticastReceive_() {
 bool CentralServer::unregisterVehicleServer(const std::string& /*server_id*/) { return true; }
 std::vector<std::string> CentralServer::getRegisteredVehicleServers() { return {}; }
 
-bool CentralServer::registerRegionalServer(const std::string& /*server_id*/, const std::string& /*address*/, int /*port*/) { return true; }
-bool CentralServer::syncWithRegionalServer(const std::string& /*server_id*/) { return true; }
-void CentralServer::broadcastToRegionalServers(std::unique_ptr<Message> /*message*/) {}
-
-bool CentralServer::updatePriceList(VehicleType /*vehicle_type*/, TicketType /*ticket_type*/, double /*price*/) { return true; }
-bool CentralServer::updateVehicleCapacity(const std::string& /*uri*/, int /*capacity*/, int /*available_seats*/) { return true; }
-void CentralServer::broadcastPriceUpdate() {}
+bool CentralServer::updateVehicleCapacity(const std::string& uri, int capacity, int available_seats) {
+    const int seen = seat_inventory_.availableOf(uri);
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db || !db->updateVehicleCapacity(uri, capacity, available_seats)) return false;
+    db.release();
+    refreshInventory(uri, seen < 0 ? std::nullopt : std::optional<int>(seen));
+    replicateVehicle(uri);
+    return true;
+}
 
 bool CentralServer::processGroupCreation(const std::string& /*group_name*/, const std::string& /*leader_urn*/,
                                          const std::vector<std::string>& /*members*/) { return true; }
@@ -1063,7 +2632,7 @@ bool CentralServer::processUserDeletion(const std::string& urn, bool admin_appro
         return false;
     }
 
-    auto db = DatabasePool::getInstance().getConnection();
+    auto db = DatabasePool::getInstance().acquire();
     if (!db) {
         logError("DB connection unavailable in processUserDeletion");
         return false;
@@ -1072,14 +2641,13 @@ bool CentralServer::processUserDeletion(const std::string& urn, bool admin_appro
     // Mora postojati
     auto userPtr = db->getUser(urn);
     if (!userPtr) {
-        DatabasePool::getInstance().returnConnection(db);
         logWarning("User not found for deletion: " + urn);
         return false;
     }
 
     bool ok = db->deleteUser(urn);
     const std::string dbErr = db->getLastError();
-    DatabasePool::getInstance().returnConnection(db);
+    db.release();
 
     if (!ok) {
         logError("Failed to delete user " + urn + (dbErr.empty() ? "" : (" | " + dbErr)));
@@ -1087,6 +2655,7 @@ bool CentralServer::processUserDeletion(const std::string& urn, bool admin_appro
     }
 
     logInfo("User deleted with ADMIN approval: " + urn);
+    replicateUser(urn, "", /*deleted*/ true);
     return true;
 }
 
@@ -1098,30 +2667,161 @@ bool CentralServer::processTicketPurchase(const std::string& /*user_urn*/, Ticke
 
 void CentralServer::processVehicleUpdate(const std::string& /*server_id*/, std::unique_ptr<Message> /*message*/) {}
 
-std::map<std::string,int> CentralServer::getSystemStatistics() { return {}; }
-std::vector<std::string> CentralServer::getActiveUsers() { return {}; }
-std::map<VehicleType,int> CentralServer::getVehicleCapacityStatus() { return {}; }
+std::map<std::string,int> CentralServer::getSystemStatistics() {
+    const auto inventory = seat_inventory_.getStats();
+    const auto broadcast = broadcast_.getStats();
+    const auto pool      = DatabasePool::getInstance().getStats();
+    const auto journal   = journal_.getStats();
+    const auto admission = admission_.getStats();
+    const auto sat = [](uint64_t v) { return static_cast<int>(std::min<uint64_t>(v, INT32_MAX)); };
+
+    std::map<std::string, int> s;
+    s["active_connections"]        = active_connections_;
+    s["total_connections"]         = total_connections_;
+    s["active_sessions"]           = sat(sessions_.size());
+    s["uptime_seconds"]            = sat(static_cast<uint64_t>(std::max<int64_t>(0,
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - start_time_).count())));
+    s["inventory_vehicles"]        = sat(inventory.vehicles);
+    s["inventory_dirty"]           = sat(seat_inventory_.dirtyCount());
+    s["seat_reservations"]         = sat(inventory.reservations);
+    s["seat_rejections"]           = sat(inventory.rejections);
+    s["broadcast_subscribers"]     = sat(broadcast.subscribers);
+    s["broadcast_queued"]          = sat(broadcast.queued);
+    s["broadcast_max_queue_depth"] = sat(broadcast.max_queue_depth);
+    s["broadcast_dropped"]         = sat(broadcast.dropped_subscribers);
+    s["db_pool_size"]              = sat(pool.size);
+    s["db_pool_waits"]             = sat(pool.waits);
+    s["db_pool_max_wait_us"]       = sat(pool.max_wait_us);
+    s["journal_pending"]           = sat(journal.last_lsn > journal_applied_ ? journal.last_lsn - journal_applied_ : 0);
+    s["replication_head"]          = sat(replication_.head());
+    s["requests_inflight"]         = admission.inflight;
+    s["admission_rate_limited"]    = sat(admission.rate_limited);
+    s["admission_overloaded"]      = sat(admission.overloaded);
+    s["admission_tracked_keys"]    = sat(admission.tracked_keys);
+
+    const auto users = users_.getStats();
+    const uint64_t user_lookups = users.hits + users.negative_hits + users.misses;
+    s["user_cache_size"]           = sat(users.size);
+    s["user_cache_hits"]           = sat(users.hits + users.negative_hits);
+    s["user_cache_misses"]         = sat(users.misses);
+    s["user_cache_hit_rate_pct"]   = user_lookups ? sat((users.hits + users.negative_hits) * 100 / user_lookups) : 0;
+
+    const auto telemetry = telemetry_.getStats();
+    s["telemetry_accepted"]        = sat(telemetry.accepted);
+    s["telemetry_dropped"]         = sat(telemetry.dropped);
+    s["telemetry_vehicles"]        = sat(telemetry.vehicles);
+    s["telemetry_routes"]          = sat(telemetry.routes);
+    return s;
+}
+
+std::vector<std::string> CentralServer::getActiveUsers() { return sessions_.users(); }
+
+std::map<VehicleType,int> CentralServer::getVehicleCapacityStatus() {
+    std::map<VehicleType, int> out;
+    for (const auto& v : seat_inventory_.statusSince({}, 0).vehicles) {
+        if (v.active) out[v.type] += v.available;
+    }
+    return out;
+}
+
+void CentralServer::handleGetStats(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& client) {
+    auto& registry = metrics::Registry::instance();
+    for (const auto& kv : getSystemStatistics()) registry.gauge("tp_" + kv.first).set(kv.second);
+
+    std::map<std::string, std::string> fields;
+    registry.collect(fields);
+    if (msg->getString("format") == "prometheus") fields["text"] = registry.renderPrometheus();
+    sendResponse(client, MessageFactory::createSuccessResponse("", fields));
+}
+
+void CentralServer::handleListRecords(std::unique_ptr<Message> msg, std::unique_ptr<TLSSocket>& client) {
+    // Izvoz korisnika/karata/plaćanja je na javnom portu: samo uz admin ključ (AdminServer)
+    if (config_.admin_key.empty()) {
+        logWarning("LIST_RECORDS rejected: no [admin] admin_key configured");
+        return sendErrorResponse(client, "Record listing disabled (no admin_key configured)", 403);
+    }
+    if (msg->getString("admin_key") != config_.admin_key) {
+        logWarning("LIST_RECORDS rejected: bad admin key from " + client->getPeerAddress());
+        return sendErrorResponse(client, "Invalid admin key", 401);
+    }
+    const std::string table = msg->getString("table");
+    const std::string after = msg->getString("after");
+    int limit = msg->getInt("limit");
+    if (limit <= 0) limit = 100;
+    limit = std::min(limit, config_.admin_page_max_rows);
+
+    auto db = DatabasePool::getInstance().acquire();
+    if (!db) return sendErrorResponse(client, "No database connection", 500);
+
+    // Jedna stranica po zahtjevu; next je ključ zadnjeg reda kad stranica nije zadnja
+    auto reply = std::make_unique<Message>(MessageType::RESPONSE_SUCCESS);
+    size_t count = 0;
+    std::string last;
+    auto field = [&](const char* name) { return "r." + std::to_string(count) + "." + name; };
+
+    if (table == "users") {
+        for (const auto& u : db->getUsersPage(after, static_cast<size_t>(limit))) {
+            reply->addString(field("urn"), u.urn);
+            reply->addString(field("name"), u.name);
+            reply->addInt(field("age"), u.age);
+            reply->addString(field("registration_date"), u.registration_date);
+            reply->addInt(field("active"), u.active ? 1 : 0);
+            last = u.urn;
+            ++count;
+        }
+    } else if (table == "tickets") {
+        for (const auto& t : db->getTicketsPage(after, static_cast<size_t>(limit))) {
+            reply->addString(field("ticket_id"), t.ticket_id);
+            reply->addString(field("user_urn"), t.user_urn);
+            reply->addInt(field("type"), static_cast<int>(t.type));
+            reply->addInt(field("vehicle_type"), static_cast<int>(t.vehicle_type));
+            reply->addString(field("route"), t.route);
+            reply->addDouble(field("price"), t.price);
+            reply->addDouble(field("discount"), t.discount);
+            reply->addString(field("purchase_date"), t.purchase_date);
+            reply->addString(field("seat_number"), t.seat_number);
+            reply->addInt(field("used"), t.used ? 1 : 0);
+            last = t.ticket_id;
+            ++count;
+        }
+    } else if (table == "payments") {
+        for (const auto& p : db->getPaymentsPage(after, static_cast<size_t>(limit))) {
+            reply->addString(field("transaction_id"), p.transaction_id);
+            reply->addString(field("ticket_id"), p.ticket_id);
+            reply->addDouble(field("amount"), p.amount);
+            reply->addString(field("payment_method"), p.payment_method);
+            reply->addString(field("payment_date"), p.payment_date);
+            reply->addInt(field("successful"), p.successful ? 1 : 0);
+            last = p.transaction_id;
+            ++count;
+        }
+    } else {
+        db.release();
+        return sendErrorResponse(client, "Unknown table (users, tickets, payments)", 400);
+    }
+    db.release();
+
+    reply->addString("table", table);
+    reply->addInt("count", static_cast<int>(count));
+    reply->addString("next", count == static_cast<size_t>(limit) ? last : "");
+    reply->calculateChecksum();
+    sendResponse(client, std::move(reply));
+}
 
 bool CentralServer::connectToVehicleServer(VehicleServerInfo& /*server*/) { return true; }
 void CentralServer::disconnectFromVehicleServer(const std::string& /*server_id*/) {}
 void CentralServer::sendToVehicleServer(const std::string& /*server_id*/, std::unique_ptr<Message> /*message*/) {}
 
-bool CentralServer::connectToRegionalServer(RegionalServerInfo& /*server*/) { return true; }
-void CentralServer::sendToRegionalServer(const std::string& /*server_id*/, std::unique_ptr<Message> /*message*/) {}
-
 std::string CentralServer::createSession(const std::string& user_urn, std::unique_ptr<TLSSocket> /*socket*/) {
-    (void)user_urn;
-    return generateSessionId();
+    return sessions_.create(user_urn);
 }
 
 bool CentralServer::validateSession(const std::string& session_id) {
-    std::lock_guard<std::mutex> lk(sessions_mutex_);
-    return client_sessions_.find(session_id) != client_sessions_.end();
+    return sessions_.contains(session_id);
 }
 
 void CentralServer::removeSession(const std::string& session_id) {
-    std::lock_guard<std::mutex> lk(sessions_mutex_);
-    client_sessions_.erase(session_id);
+    sessions_.remove(session_id);
 }
 
 } // namespace transport
@@ -0,0 +1,490 @@
+#include "server/EventJournal.h"
+#include "common/Crc32.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace transport {
+
+namespace {
+
+const char kMagic[4] = {'T', 'P', 'J', '1'};
+
+void put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+void put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+uint32_t get32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+uint64_t get64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+size_t align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+uint64_t nowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+EventJournal::~EventJournal() {
+    close();
+}
+
+bool EventJournal::open(const std::string& path) {
+    return open(path, Options{});
+}
+
+bool EventJournal::open(const std::string& path, const Options& options) {
+    close();
+    std::lock_guard<std::mutex> lk(mutex_);
+    path_    = path;
+    options_ = options;
+    options_.grow_bytes = std::max<size_t>(options_.grow_bytes, 4096);
+    last_error_.clear();
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        last_error_ = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        last_error_ = std::string("fstat: ") + std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    const bool fresh = static_cast<size_t>(st.st_size) < kHeaderSize;
+    const size_t size = fresh ? options_.grow_bytes : static_cast<size_t>(st.st_size);
+    if ((fresh && ::ftruncate(fd_, static_cast<off_t>(size)) != 0) || !mapLocked(size)) {
+        if (last_error_.empty()) last_error_ = std::string("ftruncate: ") + std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    if (fresh || std::memcmp(map_, kMagic, sizeof(kMagic)) != 0 || get32(map_ + 4) != kVersion) {
+        if (!fresh) {
+            last_error_ = "not a journal file (bad magic/version): " + path;
+            ::munmap(map_, map_size_);
+            map_ = nullptr;
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        base_lsn_ = 1;
+        writeHeaderLocked();
+        ::msync(map_, kHeaderSize, MS_SYNC);
+        ::fsync(fd_);
+    } else {
+        base_lsn_ = get64(map_ + 8);
+    }
+    recoverLocked();
+
+    stop_      = false;
+    failed_    = false;
+    committer_ = std::thread(&EventJournal::committerLoop, this);
+    return true;
+}
+
+void EventJournal::close() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (fd_ < 0) return;
+        stop_ = true;
+    }
+    commit_cv_.notify_all();
+    if (committer_.joinable()) committer_.join();    // zadnji commit radi sama nit
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    durable_cv_.notify_all();
+    {
+        std::unique_lock<std::shared_mutex> ml(map_mutex_);
+        if (map_) ::munmap(map_, map_size_);
+        map_      = nullptr;
+        map_size_ = 0;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    offsets_.clear();
+}
+
+bool EventJournal::mapLocked(size_t size) {
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        last_error_ = std::string("mmap: ") + std::strerror(errno);
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> ml(map_mutex_);
+    if (map_) ::munmap(map_, map_size_);
+    map_      = static_cast<uint8_t*>(p);
+    map_size_ = size;
+    return true;
+}
+
+bool EventJournal::growLocked(size_t need) {
+    size_t size = map_size_;
+    while (size < need) size += options_.grow_bytes;
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        last_error_ = std::string("ftruncate: ") + std::strerror(errno);
+        return false;
+    }
+    if (!mapLocked(size)) return false;
+    grew_ = true;
+    return true;
+}
+
+void EventJournal::writeHeaderLocked() {
+    std::memset(map_, 0, kHeaderSize);
+    std::memcpy(map_, kMagic, sizeof(kMagic));
+    put32(map_ + 4, kVersion);
+    put64(map_ + 8, base_lsn_);
+}
+
+void EventJournal::recoverLocked() {
+    offsets_.clear();
+    size_t off = kHeaderSize;
+    uint64_t expected = base_lsn_;
+    while (off + kRecordHeaderSize <= map_size_) {
+        const uint8_t* p = map_ + off;
+        const uint32_t len = get32(p);
+        const size_t total = align8(kRecordHeaderSize + len);
+        if (off + total > map_size_) break;
+        if (get64(p + 8) != expected) break;
+        if (Crc32::compute(p + 8, kRecordHeaderSize - 8 + len) != get32(p + 4)) break;
+        offsets_.push_back(off);
+        off += total;
+        ++expected;
+    }
+    // Pokidan rep: obriši zaglavlje da ga ni sljedeće otvaranje ne pokuša čitati
+    if (off + kRecordHeaderSize <= map_size_) {
+        std::memset(map_ + off, 0, kRecordHeaderSize);
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t start = off & ~(page - 1);
+        ::msync(map_ + start, std::min(map_size_, off + kRecordHeaderSize) - start, MS_SYNC);
+    }
+    write_off_  = off;
+    synced_off_ = off;
+    last_lsn_   = expected - 1;
+    durable_lsn_.store(last_lsn_);
+}
+
+uint64_t EventJournal::append(EventType type, const std::vector<uint8_t>& payload) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (fd_ < 0 || stop_ || failed_) return 0;
+    const size_t total = align8(kRecordHeaderSize + payload.size());
+    if (write_off_ + total > map_size_ && !growLocked(write_off_ + total)) return 0;
+
+    const uint64_t lsn = last_lsn_ + 1;
+    uint8_t* p = map_ + write_off_;
+    put32(p, static_cast<uint32_t>(payload.size()));
+    put64(p + 8, lsn);
+    put64(p + 16, nowMs());
+    p[24] = static_cast<uint8_t>(type);
+    if (!payload.empty()) std::memcpy(p + kRecordHeaderSize, payload.data(), payload.size());
+    put32(p + 4, Crc32::compute(p + 8, kRecordHeaderSize - 8 + payload.size()));
+
+    offsets_.push_back(write_off_);
+    write_off_ += total;
+    last_lsn_   = lsn;
+    appended_++;
+    return lsn;
+}
+
+bool EventJournal::waitDurable(uint64_t lsn) {
+    if (durable_lsn_.load() >= lsn) return true;
+    std::unique_lock<std::mutex> lk(mutex_);
+    if (fd_ < 0) return false;
+    ++waiters_;
+    commit_cv_.notify_one();
+    durable_cv_.wait(lk, [&] { return durable_lsn_.load() >= lsn || stop_ || failed_; });
+    --waiters_;
+    return durable_lsn_.load() >= lsn;
+}
+
+void EventJournal::committerLoop() {
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    std::unique_lock<std::mutex> lk(mutex_);
+    for (;;) {
+        // Bez čekača se commit radi periodično (append bez waitDurable)
+        commit_cv_.wait_for(lk, std::chrono::milliseconds(10), [&] {
+            return stop_ || (!failed_ && waiters_ > 0 && last_lsn_ > durable_lsn_.load());
+        });
+        if (failed_ || last_lsn_ <= durable_lsn_.load()) {
+            if (stop_) break;
+            continue;
+        }
+        if (waiters_ > 0 && !stop_ && options_.commit_delay.count() > 0) {
+            // Kratko sačekaj da se uz prvog čekača nakupi još zapisa (isti msync)
+            lk.unlock();
+            std::this_thread::sleep_for(options_.commit_delay);
+            lk.lock();
+        }
+        const uint64_t upto  = last_lsn_;
+        const size_t   begin = synced_off_ & ~(page - 1);
+        const size_t   end   = write_off_;
+        const bool     grew  = grew_;
+        grew_ = false;
+        lk.unlock();
+
+        bool ok = true;
+        {
+            std::shared_lock<std::shared_mutex> ml(map_mutex_);
+            if (end > begin) ok = ::msync(map_ + begin, end - begin, MS_SYNC) == 0;
+        }
+        if (ok && grew) ok = ::fdatasync(fd_) == 0;
+
+        lk.lock();
+        if (ok) {
+            synced_off_ = std::max(synced_off_, end);
+            if (upto > durable_lsn_.load()) durable_lsn_.store(upto);
+            commits_++;
+        } else {
+            // Ponovljeni msync može "uspjeti" bez stranica koje je kernel već odbacio
+            last_error_ = std::string("msync: ") + std::strerror(errno);
+            failed_     = true;
+        }
+        durable_cv_.notify_all();
+    }
+    durable_cv_.notify_all();
+}
+
+std::vector<EventJournal::Record> EventJournal::read(uint64_t after_lsn, size_t max_records) const {
+    std::vector<Record> out;
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!map_) return out;
+    const uint64_t durable = std::min(durable_lsn_.load(), last_lsn_);
+    for (uint64_t lsn = std::max(after_lsn + 1, base_lsn_); lsn <= durable && out.size() < max_records; ++lsn) {
+        const uint8_t* p = map_ + offsets_[lsn - base_lsn_];
+        Record r;
+        r.lsn          = lsn;
+        r.timestamp_ms = get64(p + 16);
+        r.type         = static_cast<EventType>(p[24]);
+        r.payload.assign(p + kRecordHeaderSize, p + kRecordHeaderSize + get32(p));
+        out.push_back(std::move(r));
+    }
+    return out;
+}
+
+bool EventJournal::resetIfLast(uint64_t expected_last) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!map_ || failed_ || last_lsn_ != expected_last || durable_lsn_.load() < expected_last) return false;
+    if (offsets_.empty()) return true;
+
+    // Novo zaglavlje + obrisan prvi zapis, u istoj stranici -> jedan msync
+    uint8_t first[kRecordHeaderSize];
+    std::memcpy(first, map_ + kHeaderSize, kRecordHeaderSize);
+    const uint64_t base = base_lsn_;
+    base_lsn_ = last_lsn_ + 1;
+    writeHeaderLocked();
+    std::memset(map_ + kHeaderSize, 0, kRecordHeaderSize);
+    if (::msync(map_, kHeaderSize + kRecordHeaderSize, MS_SYNC) != 0) {
+        // Zapisi ostaju čitljivi u memoriji (read) do zatvaranja
+        last_error_ = std::string("msync: ") + std::strerror(errno);
+        failed_     = true;
+        base_lsn_   = base;
+        writeHeaderLocked();
+        std::memcpy(map_ + kHeaderSize, first, kRecordHeaderSize);
+        return false;
+    }
+    offsets_.clear();
+    write_off_  = kHeaderSize;
+    synced_off_ = kHeaderSize;
+    return true;
+}
+
+bool EventJournal::failed() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return failed_;
+}
+
+uint64_t EventJournal::lastLsn() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return last_lsn_;
+}
+
+EventJournal::Stats EventJournal::getStats() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    Stats s;
+    s.appended    = appended_.load();
+    s.commits     = commits_.load();
+    s.bytes       = write_off_ - kHeaderSize;
+    s.last_lsn    = last_lsn_;
+    s.durable_lsn = durable_lsn_.load();
+    return s;
+}
+
+std::string EventJournal::lastError() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return last_error_;
+}
+
+// ======================= payload događaja =======================
+
+namespace journal_events {
+
+namespace {
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool getVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        const uint8_t b = in[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& s) {
+    putVarint(out, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+bool getString(const std::vector<uint8_t>& in, size_t& pos, std::string& s) {
+    uint64_t n = 0;
+    if (!getVarint(in, pos, n) || n > in.size() - pos) return false;
+    s.assign(reinterpret_cast<const char*>(in.data() + pos), static_cast<size_t>(n));
+    pos += static_cast<size_t>(n);
+    return true;
+}
+
+void putDouble(std::vector<uint8_t>& out, double d) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &d, sizeof(bits));
+    uint8_t b[8];
+    put64(b, bits);
+    out.insert(out.end(), b, b + 8);
+}
+
+bool getDouble(const std::vector<uint8_t>& in, size_t& pos, double& d) {
+    if (in.size() - pos < 8) return false;
+    const uint64_t bits = get64(in.data() + pos);
+    std::memcpy(&d, &bits, sizeof(d));
+    pos += 8;
+    return true;
+}
+
+template <typename T>
+bool getInt(const std::vector<uint8_t>& in, size_t& pos, T& v) {
+    uint64_t x = 0;
+    if (!getVarint(in, pos, x)) return false;
+    v = static_cast<T>(x);
+    return true;
+}
+
+void putSeats(std::vector<uint8_t>& out, const SeatChange& e) {
+    putString(out, e.vehicle_uri);
+    putString(out, e.user_urn);
+    putString(out, e.route);
+    putVarint(out, static_cast<uint32_t>(e.seats));
+    putVarint(out, static_cast<uint32_t>(e.capacity));
+    putVarint(out, static_cast<uint32_t>(e.available));
+    putVarint(out, e.seat_seq);
+}
+
+bool getSeats(const std::vector<uint8_t>& in, size_t& pos, SeatChange& e) {
+    uint32_t seats = 0, capacity = 0, available = 0;
+    if (!getString(in, pos, e.vehicle_uri) || !getString(in, pos, e.user_urn) ||
+        !getString(in, pos, e.route) || !getInt(in, pos, seats) || !getInt(in, pos, capacity) ||
+        !getInt(in, pos, available) || !getInt(in, pos, e.seat_seq)) {
+        return false;
+    }
+    e.seats     = static_cast<int>(seats);
+    e.capacity  = static_cast<int>(capacity);
+    e.available = static_cast<int>(available);
+    return true;
+}
+
+} // namespace
+
+std::vector<uint8_t> encode(const SeatChange& e) {
+    std::vector<uint8_t> out;
+    out.reserve(64);
+    putSeats(out, e);
+    return out;
+}
+
+std::vector<uint8_t> encode(const Purchase& e) {
+    std::vector<uint8_t> out;
+    out.reserve(128 + 96 * e.tickets.size());
+    putSeats(out, e.seats);
+    putVarint(out, e.tickets.size());
+    for (const auto& t : e.tickets) {
+        putString(out, t.ticket_id);
+        putString(out, t.user_urn);
+        putVarint(out, static_cast<uint32_t>(t.type));
+        putVarint(out, static_cast<uint32_t>(t.vehicle_type));
+        putString(out, t.route);
+        putDouble(out, t.price);
+        putDouble(out, t.discount);
+        putString(out, t.purchase_date);
+        putString(out, t.seat_number);
+        out.push_back(t.used ? 1 : 0);
+    }
+    const Payment& p = e.payment;
+    putString(out, p.transaction_id);
+    putString(out, p.ticket_id);
+    putDouble(out, p.amount);
+    putString(out, p.payment_method);
+    putString(out, p.payment_date);
+    out.push_back(p.successful ? 1 : 0);
+    return out;
+}
+
+bool decode(const std::vector<uint8_t>& in, SeatChange& e) {
+    size_t pos = 0;
+    return getSeats(in, pos, e) && pos == in.size();
+}
+
+bool decode(const std::vector<uint8_t>& in, Purchase& e) {
+    size_t pos = 0;
+    uint64_t count = 0;
+    if (!getSeats(in, pos, e.seats) || !getVarint(in, pos, count) || count > in.size()) return false;
+    e.tickets.assign(static_cast<size_t>(count), Ticket{});
+    for (auto& t : e.tickets) {
+        uint32_t type = 0, vtype = 0;
+        if (!getString(in, pos, t.ticket_id) || !getString(in, pos, t.user_urn) ||
+            !getInt(in, pos, type) || !getInt(in, pos, vtype) || !getString(in, pos, t.route) ||
+            !getDouble(in, pos, t.price) || !getDouble(in, pos, t.discount) ||
+            !getString(in, pos, t.purchase_date) || !getString(in, pos, t.seat_number) ||
+            pos >= in.size()) {
+            return false;
+        }
+        t.type         = static_cast<TicketType>(type);
+        t.vehicle_type = static_cast<VehicleType>(vtype);
+        t.used         = in[pos++] != 0;
+    }
+    Payment& p = e.payment;
+    if (!getString(in, pos, p.transaction_id) || !getString(in, pos, p.ticket_id) ||
+        !getDouble(in, pos, p.amount) || !getString(in, pos, p.payment_method) ||
+        !getString(in, pos, p.payment_date) || pos >= in.size()) {
+        return false;
+    }
+    p.successful = in[pos++] != 0;
+    return pos == in.size();
+}
+
+} // namespace journal_events
+
+} // namespace transport
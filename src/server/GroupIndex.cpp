@@ -0,0 +1,91 @@
+#include "server/GroupIndex.h"
+
+namespace transport {
+
+std::shared_ptr<const GroupIndex::Entry> GroupIndex::find(const std::string& group_name) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = groups_.find(group_name);
+    return it != groups_.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<const GroupIndex::Entry> GroupIndex::find(const std::string& group_name, const Loader& load) {
+    uint64_t ticket = 0;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = groups_.find(group_name);
+        if (it != groups_.end()) return it->second;
+        ticket = epoch_;
+    }
+
+    auto group = load ? load() : nullptr;
+    if (!group) return nullptr;
+
+    auto entry = std::make_shared<Entry>();
+    entry->group_id   = group->group_id;
+    entry->leader_urn = group->leader_urn;
+    entry->members.insert(group->members.begin(), group->members.end());
+
+    // Dvije niti mogu učitati istu grupu; prva upisana ostaje (možda je već i izmijenjena)
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = groups_.find(group_name);
+    if (it != groups_.end()) return it->second;
+    // Izmjena tokom čitanja (npr. član dodan u bazu dok grupa nije bila učitana): pročitani
+    // red može biti stariji od upisa -> vraća se, ali se ne pamti
+    if (ticket != epoch_) return entry;
+    groups_.emplace(group_name, entry);
+    return entry;
+}
+
+void GroupIndex::put(const std::string& group_name, Entry entry) {
+    auto shared = std::make_shared<const Entry>(std::move(entry));
+    std::lock_guard<std::mutex> lk(mutex_);
+    epoch_++;
+    groups_[group_name] = std::move(shared);
+}
+
+void GroupIndex::addMembers(const std::string& group_name, const std::vector<std::string>& urns) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    epoch_++;
+    auto it = groups_.find(group_name);
+    if (it == groups_.end()) return;      // nije učitana: sljedeći pristup čita bazu
+    auto copy = std::make_shared<Entry>(*it->second);
+    copy->members.insert(urns.begin(), urns.end());
+    it->second = std::move(copy);
+}
+
+void GroupIndex::removeMember(const std::string& group_name, const std::string& urn) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    epoch_++;
+    auto it = groups_.find(group_name);
+    if (it == groups_.end() || !it->second->members.count(urn)) return;
+    auto copy = std::make_shared<Entry>(*it->second);
+    copy->members.erase(urn);
+    it->second = std::move(copy);
+}
+
+void GroupIndex::erase(const std::string& group_name) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    epoch_++;
+    groups_.erase(group_name);
+}
+
+void GroupIndex::clear() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    epoch_++;
+    groups_.clear();
+}
+
+size_t GroupIndex::size() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return groups_.size();
+}
+
+std::vector<std::string> GroupIndex::names() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::vector<std::string> out;
+    out.reserve(groups_.size());
+    for (const auto& kv : groups_) out.push_back(kv.first);
+    return out;
+}
+
+} // namespace transport
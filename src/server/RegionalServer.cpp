@@ -0,0 +1,246 @@
+#include "server/RegionalServer.h"
+#include "common/Message.h"
+#include "common/Logger.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <utility>
+
+namespace transport {
+
+RegionalServer::RegionalServer() : ServerBase("RegionalServer") {}
+
+RegionalServer::~RegionalServer() { stop(); }
+
+bool RegionalServer::start(int port, const std::string& config_file) {
+    port_ = port;
+    if (!config_file.empty()) {
+        loadConfiguration(config_file);
+    }
+    if (sync_key_.empty()) sync_key_ = getConfig().getString("regional", "sync_key", "");
+    if (sync_key_.empty()) logWarning("RegionalServer: no [regional] sync_key, REPLICA_SYNC will be refused");
+    sessions_.setIdleTimeout(std::chrono::seconds(std::max(1, getConfig().getInt("network", "session_timeout", 3600))));
+
+    running_ = true;
+    if (!startServer()) {
+        running_ = false;
+        logError("RegionalServer: failed to start TLS server on port " + std::to_string(port_));
+        return false;
+    }
+    start_time_ = std::chrono::system_clock::now();
+    logInfo("Regional Server started on port " + std::to_string(port_) + " (waiting for central server sync)");
+    return true;
+}
+
+RegionalServer::ReplicaStats RegionalServer::getReplicaStats() const {
+    ReplicaStats s;
+    s.batches     = batches_.load();
+    s.snapshots   = snapshots_.load();
+    s.records     = records_.load();
+    s.rejected    = rejected_.load();
+    s.local_auth  = local_auth_.load();
+    s.price_reads = price_reads_.load();
+    std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+    s.epoch    = epoch_;
+    s.offset   = offset_;
+    s.users    = users_.size();
+    s.vehicles = vehicles_.size();
+    return s;
+}
+
+bool RegionalServer::hasUser(const std::string& urn) const {
+    std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+    return users_.count(urn) != 0;
+}
+
+bool RegionalServer::getVehicle(const std::string& uri, Vehicle& out) const {
+    std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+    auto it = vehicles_.find(uri);
+    if (it == vehicles_.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void RegionalServer::handleClientMessage(std::unique_ptr<TLSSocket> client,
+                                         std::unique_ptr<Message> /*message*/) {
+    if (!client) return;
+
+    total_connections_++;
+    active_connections_++;
+
+    logInfo("[RegionalServer] client connected from " + client->getPeerAddress()
+            + ":" + std::to_string(client->getPeerPort()));
+
+    TrackedConnection tracked(*this, client.get());
+    while (running_ && client) {
+        auto received = client->receiveMessage();
+        if (!received) break;
+        RequestScope scope(received->getSequenceId());
+        auto ticket = admitRequest(*received, client);
+        if (ticket) processMessage(std::move(received), client);
+    }
+
+    active_connections_--;
+    onClientDisconnected(client.get());
+    logInfo("[RegionalServer] client disconnected");
+}
+
+void RegionalServer::onClientDisconnected(TLSSocket* client) {
+    std::lock_guard<std::mutex> lk(peers_mutex_);
+    replica_peers_.erase(client);
+}
+
+void RegionalServer::processMessage(std::unique_ptr<Message> message,
+                                    std::unique_ptr<TLSSocket>& client) {
+    if (!message || !client) return;
+
+    switch (message->getType()) {
+        case MessageType::CONNECT_REQUEST:
+            acceptConnect(message->getString("protocol_version"), client);
+            return;
+        case MessageType::HEARTBEAT:
+            sendSuccessResponse(client, "alive");
+            return;
+        case MessageType::REPLICA_SYNC:
+            handleReplicaSync(*message, client);
+            return;
+        case MessageType::REPLICA_BATCH:
+            handleReplicaBatch(*message, client);
+            return;
+        case MessageType::AUTH_REQUEST:
+            handleAuthRequest(*message, client);
+            return;
+        case MessageType::GET_PRICES:
+            price_reads_++;
+            sendResponse(client, MessageFactory::createPriceList(*prices_.get()));
+            return;
+        default:
+            // Izmjene stanja ostaju na centralnom serveru
+            sendErrorResponse(client, "Not served by regional server", 501);
+            return;
+    }
+}
+
+void RegionalServer::handleReplicaSync(const Message& request, std::unique_ptr<TLSSocket>& client) {
+    // Bez ključa nema replikacije: inače bi svako mogao poslati snapshot kopije
+    if (sync_key_.empty()) {
+        logWarning("REPLICA_SYNC rejected: no sync_key configured (peer " + client->getPeerAddress() + ")");
+        return sendErrorResponse(client, "Replica sync disabled (no sync_key configured)", 403);
+    }
+    if (request.getString("key") != sync_key_) {
+        logWarning("REPLICA_SYNC rejected: bad key from " + client->getPeerAddress());
+        return sendErrorResponse(client, "Invalid sync key", 401);
+    }
+    {
+        std::lock_guard<std::mutex> lk(peers_mutex_);
+        replica_peers_.insert(client.get());
+    }
+
+    uint64_t epoch = 0, offset = 0;
+    {
+        std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+        epoch  = epoch_;
+        offset = offset_;
+    }
+    logInfo("REPLICA_SYNC from central server (id=" + request.getString("server_id") +
+            "), replica at offset " + std::to_string(offset));
+    sendResponse(client, MessageFactory::createSuccessResponse("", {
+        {"epoch",  std::to_string(epoch)},
+        {"offset", std::to_string(offset)}
+    }));
+}
+
+void RegionalServer::handleReplicaBatch(const Message& request, std::unique_ptr<TLSSocket>& client) {
+    {
+        std::lock_guard<std::mutex> lk(peers_mutex_);
+        if (!replica_peers_.count(client.get())) {
+            return sendErrorResponse(client, "REPLICA_SYNC required", 401);
+        }
+    }
+
+    const uint64_t epoch    = std::strtoull(request.getString("epoch").c_str(), nullptr, 10);
+    const uint64_t from     = std::strtoull(request.getString("from").c_str(), nullptr, 10);
+    const uint64_t to       = std::strtoull(request.getString("to").c_str(), nullptr, 10);
+    const bool     snapshot = request.getBool("snapshot");
+
+    std::vector<uint8_t> raw = request.getBinary("records");
+    if (request.getString("encoding") == "zlib") {
+        std::vector<uint8_t> packed;
+        packed.swap(raw);
+        if (!replication::decompress(packed, static_cast<size_t>(std::max(0, request.getInt("raw_size"))), raw)) {
+            return sendErrorResponse(client, "Corrupt replica batch", 400);
+        }
+    }
+    std::vector<ReplicationRecord> records;
+    if (!replication::decodeRecords(raw, records)) {
+        return sendErrorResponse(client, "Corrupt replica batch", 400);
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lk(replica_mutex_);
+        if (!snapshot && (epoch != epoch_ || from != offset_)) {
+            // Rupa ili drugi dnevnik: centralni nastavlja od našeg offset-a (isti epoch) ili šalje snapshot
+            rejected_++;
+            auto err = MessageFactory::createErrorResponse("Batch does not continue replica", 409);
+            if (epoch == epoch_) err->addString("offset", std::to_string(offset_));
+            lk.unlock();
+            return sendResponse(client, std::move(err));
+        }
+
+        PriceSnapshot prices = snapshot ? PriceSnapshot{} : *prices_.get();
+        bool prices_changed  = snapshot;
+        if (snapshot) {
+            users_.clear();
+            vehicles_.clear();
+            epoch_ = epoch;
+        }
+        for (const auto& r : records) {
+            switch (r.kind) {
+                case ReplicationRecord::Kind::USER_UPSERT:  users_[r.key] = r.value; break;
+                case ReplicationRecord::Kind::USER_DELETE:  users_.erase(r.key);     break;
+                case ReplicationRecord::Kind::VEHICLE_UPSERT: {
+                    Vehicle v;
+                    if (replication::decodeVehicle(r, v)) vehicles_[v.uri] = std::move(v);
+                    break;
+                }
+                case ReplicationRecord::Kind::PRICE_UPSERT: {
+                    VehicleType vt;
+                    TicketType  tt;
+                    PriceSnapshot::Fare fare;
+                    if (replication::decodeFare(r, vt, tt, fare) && prices.setFare(vt, tt, fare)) {
+                        prices.setVersion(std::max(prices.version(), fare.version));
+                        prices_changed = true;
+                    }
+                    break;
+                }
+            }
+        }
+        offset_ = to;
+        if (prices_changed) prices_.publish(std::make_shared<const PriceSnapshot>(prices));
+    }
+
+    batches_++;
+    if (snapshot) snapshots_++;
+    records_ += records.size();
+    TP_LOG_DEBUG(logger_, "REPLICA_BATCH applied: ", records.size(), " records, offset ", to,
+                 snapshot ? " (snapshot)" : "");
+    sendResponse(client, MessageFactory::createSuccessResponse("", {{"offset", std::to_string(to)}}));
+}
+
+void RegionalServer::handleAuthRequest(const Message& request, std::unique_ptr<TLSSocket>& client) {
+    const std::string urn = request.getString("urn");
+    const bool authenticated = !urn.empty() && hasUser(urn);
+    sessions_.expire();
+
+    const std::string session_id = authenticated ? sessions_.create(urn) : "";
+    sendResponse(client, MessageFactory::createAuthResponse(authenticated, session_id));
+    if (authenticated) {
+        local_auth_++;
+        logInfo("User authenticated from replica: " + urn);
+    } else {
+        logWarning("Authentication failed for URN: " + urn);
+    }
+}
+
+} // namespace transport
@@ -0,0 +1,71 @@
+#include "server/ReplicationLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace transport {
+
+namespace {
+
+uint64_t newEpoch() {
+    // Sat + slučajni bitovi: dva pokretanja u istoj milisekundi ne dijele epoch
+    std::random_device rd;
+    const uint64_t ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    return (ms << 16) ^ (static_cast<uint64_t>(rd()) & 0xFFFF);
+}
+
+} // namespace
+
+ReplicationLog::ReplicationLog(size_t capacity)
+    : epoch_(newEpoch()), capacity_(std::max<size_t>(1, capacity)) {}
+
+uint64_t ReplicationLog::head() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return head_;
+}
+
+void ReplicationLog::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    capacity_ = std::max<size_t>(1, capacity);
+    while (records_.size() > capacity_) records_.pop_front();
+}
+
+uint64_t ReplicationLog::append(ReplicationRecord::Kind kind, std::string key, std::string value) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    ReplicationRecord r;
+    r.offset = ++head_;
+    r.kind   = kind;
+    r.key    = std::move(key);
+    r.value  = std::move(value);
+    records_.push_back(std::move(r));
+    if (records_.size() > capacity_) records_.pop_front();
+    return head_;
+}
+
+bool ReplicationLog::since(uint64_t from, size_t max, std::vector<ReplicationRecord>& out) const {
+    out.clear();
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (from > head_) return false;
+    if (from == head_) return true;
+    // Treba zapis from + 1; offset-i u deque su uzastopni
+    if (records_.empty() || records_.front().offset > from + 1) return false;
+    const size_t begin = static_cast<size_t>(from + 1 - records_.front().offset);
+    const size_t end   = std::min(records_.size(), begin + std::max<size_t>(1, max));
+    out.assign(records_.begin() + static_cast<std::ptrdiff_t>(begin),
+               records_.begin() + static_cast<std::ptrdiff_t>(end));
+    return true;
+}
+
+ReplicationLog::Stats ReplicationLog::getStats() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    Stats s;
+    s.epoch    = epoch_;
+    s.head     = head_;
+    s.first    = records_.empty() ? 0 : records_.front().offset;
+    s.retained = records_.size();
+    return s;
+}
+
+} // namespace transport
@@ -0,0 +1,418 @@
+#include "server/SeatInventory.h"
+
+#include <algorithm>
+
+namespace transport {
+
+size_t SeatInventory::typeSlot(VehicleType type) {
+    const size_t slot = static_cast<size_t>(type) - 1;
+    return slot < kVehicleTypes ? slot : 0;
+}
+
+bool SeatInventory::RouteVehicles::empty() const {
+    for (const auto& g : by_type) if (!g.empty()) return false;
+    return true;
+}
+
+SeatInventory::Snapshot SeatInventory::snapshotOf(const Entry& e) {
+    Snapshot s;
+    s.uri       = e.uri;
+    s.type      = e.type;
+    s.route     = e.route;
+    s.capacity  = e.capacity.load();
+    const uint64_t w = e.seats.load();
+    s.available = availableOf(w);
+    s.seat_seq  = seatSeqOf(w);
+    s.active    = e.active;
+    s.version   = e.version.load();
+    return s;
+}
+
+uint64_t SeatInventory::storeSeats(Entry& e, int available) {
+    uint64_t cur = e.seats.load();
+    uint64_t next = 0;
+    do {
+        next = packSeats(seatSeqOf(cur) + 1, available);
+    } while (!e.seats.compare_exchange_weak(cur, next));
+    return next;
+}
+
+void SeatInventory::tombstoneLocked(const Entry& e, uint64_t version) {
+    tombstones_.push_back({e.uri, e.route, version});
+    if (tombstones_.size() > kMaxTombstones) {
+        // Klijent stariji od izbačenog zapisa ne bi saznao za brisanje -> dobija snapshot
+        delta_floor_ = tombstones_.front().version;
+        tombstones_.pop_front();
+    }
+}
+
+void SeatInventory::indexLocked(const std::shared_ptr<Entry>& e) {
+    by_route_[e->route].by_type[typeSlot(e->type)].push_back(e);
+}
+
+void SeatInventory::unindexLocked(const std::shared_ptr<Entry>& e) {
+    auto it = by_route_.find(e->route);
+    if (it == by_route_.end()) return;
+    auto& vec = it->second.by_type[typeSlot(e->type)];
+    vec.erase(std::remove(vec.begin(), vec.end(), e), vec.end());
+    if (it->second.empty()) by_route_.erase(it);
+}
+
+std::optional<SeatInventory::Snapshot>
+SeatInventory::pick(const std::vector<std::shared_ptr<Entry>>& group) {
+    if (group.empty()) return std::nullopt;
+    for (const auto& e : group) {
+        if (e->active && availableOf(e->seats.load()) > 0) return snapshotOf(*e);
+    }
+    return snapshotOf(*group.front());
+}
+
+size_t SeatInventory::load(Database& db) {
+    return load(db.getAllVehicles());
+}
+
+size_t SeatInventory::load(const std::vector<Vehicle>& vehicles) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    by_uri_.clear();
+    by_route_.clear();
+    tombstones_.clear();
+    const uint64_t ver = nextVersion();
+    delta_floor_ = ver;                 // stare delte ne važe nakon ponovnog učitavanja
+    for (const auto& v : vehicles) {
+        auto e = std::make_shared<Entry>();
+        e->uri    = v.uri;
+        e->type   = v.type;
+        e->route  = v.route;
+        e->active = v.active;
+        e->capacity.store(v.capacity);
+        e->seats.store(packSeats(0, v.available_seats));
+        e->next_seat.store(std::max(0, v.capacity - v.available_seats));
+        e->version.store(ver);
+        by_uri_[v.uri] = e;
+        indexLocked(e);
+    }
+    return by_uri_.size();
+}
+
+void SeatInventory::upsert(const Vehicle& v) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    upsertLocked(v, nextVersion());
+}
+
+void SeatInventory::upsertAll(const std::vector<Vehicle>& vehicles) {
+    if (vehicles.empty()) return;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const uint64_t ver = nextVersion();
+    for (const auto& v : vehicles) upsertLocked(v, ver);
+}
+
+void SeatInventory::upsertLocked(const Vehicle& v, uint64_t ver) {
+    auto it = by_uri_.find(v.uri);
+    const bool existed = (it != by_uri_.end());
+    std::shared_ptr<Entry> e;
+    if (!existed) {
+        e = std::make_shared<Entry>();
+        e->uri = v.uri;
+        e->next_seat.store(std::max(0, v.capacity - v.available_seats));
+        by_uri_[v.uri] = e;
+    } else {
+        e = it->second;
+        unindexLocked(e);
+    }
+    if (existed && e->route != v.route) tombstoneLocked(*e, ver);   // nestaje sa stare rute
+    e->type   = v.type;
+    e->route  = v.route;
+    e->active = v.active;
+    e->capacity.store(v.capacity);
+    storeSeats(*e, v.available_seats);
+    // Baza je upravo upisana, ali flush koji je već u toku može je prepisati
+    // starom vrijednošću -> označi dirty da sljedeći flush upiše ovo stanje.
+    e->dirty.store(existed);
+    e->version.store(ver);
+    indexLocked(e);
+}
+
+bool SeatInventory::amend(const Vehicle& v, bool set_seats, int seen_available) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(v.uri);
+    if (it == by_uri_.end()) return false;
+    amendLocked(*it->second, v, set_seats, seen_available, nextVersion());
+    return true;
+}
+
+void SeatInventory::amendAll(const std::vector<Vehicle>& vehicles,
+                             const std::vector<std::optional<int>>& seen_available) {
+    if (vehicles.empty()) return;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const uint64_t ver = nextVersion();
+    for (size_t i = 0; i < vehicles.size(); ++i) {
+        const auto& v    = vehicles[i];
+        const auto  seen = i < seen_available.size() ? seen_available[i] : std::nullopt;
+        auto it = by_uri_.find(v.uri);
+        if (it == by_uri_.end()) upsertLocked(v, ver);
+        else                     amendLocked(*it->second, v, seen.has_value(), seen.value_or(0), ver);
+    }
+}
+
+void SeatInventory::amendLocked(Entry& e, const Vehicle& v, bool set_seats, int seen_available, uint64_t ver) {
+    const auto sp = by_uri_.at(e.uri);
+    unindexLocked(sp);
+    if (e.route != v.route) tombstoneLocked(e, ver);   // nestaje sa stare rute
+    e.type   = v.type;
+    e.route  = v.route;
+    e.active = v.active;
+    if (set_seats) {
+        e.capacity.store(v.capacity);
+        // Razlika od stanja koje je admin vidio (prodato/vraćeno u međuvremenu) ostaje
+        uint64_t w = e.seats.load();
+        uint64_t next = 0;
+        do {
+            const int moved = seen_available - availableOf(w);
+            next = packSeats(seatSeqOf(w) + 1, std::clamp(v.available_seats - moved, 0, std::max(0, v.capacity)));
+        } while (!e.seats.compare_exchange_weak(w, next));
+        e.dirty.store(true);
+    }
+    e.version.store(ver);
+    indexLocked(sp);
+}
+
+bool SeatInventory::remove(const std::string& uri) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(uri);
+    if (it == by_uri_.end()) return false;
+    tombstoneLocked(*it->second, nextVersion());
+    unindexLocked(it->second);
+    by_uri_.erase(it);
+    return true;
+}
+
+std::optional<SeatInventory::Snapshot> SeatInventory::find(const std::string& uri) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(uri);
+    if (it == by_uri_.end()) return std::nullopt;
+    return snapshotOf(*it->second);
+}
+
+int SeatInventory::availableOf(const std::string& uri) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(uri);
+    return it == by_uri_.end() ? -1 : availableOf(it->second->seats.load());
+}
+
+std::optional<SeatInventory::Snapshot>
+SeatInventory::findByRouteAndType(const std::string& route, VehicleType type) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_route_.find(route);
+    if (it == by_route_.end()) return std::nullopt;
+    return pick(it->second.by_type[typeSlot(type)]);
+}
+
+std::optional<SeatInventory::Snapshot>
+SeatInventory::findOnRoute(const std::string& route, VehicleType preferred) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_route_.find(route);
+    if (it == by_route_.end()) return std::nullopt;
+
+    const auto& groups = it->second.by_type;
+    const size_t first = typeSlot(preferred);
+    if (auto v = pick(groups[first])) return v;
+
+    // Drugi tipovi: prvo vozilo sa slobodnim mjestom, inače bilo koje
+    std::optional<Snapshot> fallback;
+    for (size_t k = 0; k < kVehicleTypes; ++k) {
+        if (k == first || groups[k].empty()) continue;
+        auto v = pick(groups[k]);
+        if (v->active && v->available > 0) return v;
+        if (!fallback) fallback = std::move(v);
+    }
+    return fallback;
+}
+
+SeatInventory::Reservation SeatInventory::reserve(const std::string& uri, int seats) {
+    Reservation r;
+    if (seats < 1) return r;
+
+    // Shared lock i tokom CAS-a: verzija promjene mora biti upisana prije nego što
+    // statusSince (unique lock) pročita trenutnu verziju
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(uri);
+    if (it == by_uri_.end()) return r;
+    Entry* e = it->second.get();
+    r.found    = true;
+    r.capacity = e->capacity.load();
+
+    uint64_t w = e->seats.load();
+    uint64_t next = 0;
+    int cur = 0;
+    do {
+        cur = availableOf(w);
+        if (cur < seats) {
+            r.available = cur;
+            r.seat_seq  = seatSeqOf(w);
+            rejections_++;
+            return r;
+        }
+        next = packSeats(seatSeqOf(w) + 1, cur - seats);
+    } while (!e->seats.compare_exchange_weak(w, next));
+
+    e->dirty.store(true);
+    e->version.store(nextVersion());
+    reservations_++;
+    r.ok         = true;
+    r.available  = cur - seats;
+    r.seat_seq   = seatSeqOf(next);
+    r.first_seat = e->next_seat.fetch_add(seats) + 1;
+    return r;
+}
+
+void SeatInventory::release(const std::string& uri, int seats) {
+    if (seats < 1) return;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(uri);
+    if (it == by_uri_.end()) return;
+    Entry& e = *it->second;
+    uint64_t w = e.seats.load();
+    while (!e.seats.compare_exchange_weak(w, packSeats(seatSeqOf(w) + 1, availableOf(w) + seats))) {}
+    e.dirty.store(true);
+    e.version.store(nextVersion());
+}
+
+bool SeatInventory::restoreSeats(const std::string& uri, int available) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(uri);
+    if (it == by_uri_.end()) return false;
+    storeSeats(*it->second, std::max(0, available));
+    it->second->dirty.store(true);
+    it->second->version.store(nextVersion());
+    return true;
+}
+
+int SeatInventory::adjustSeats(const std::string& uri, int delta) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_uri_.find(uri);
+    if (it == by_uri_.end()) return -1;
+    Entry& e = *it->second;
+    uint64_t w = e.seats.load();
+    int next = 0;
+    do {
+        next = std::clamp(availableOf(w) + delta, 0, std::max(0, e.capacity.load()));
+        if (next == availableOf(w)) return next;
+    } while (!e.seats.compare_exchange_weak(w, packSeats(seatSeqOf(w) + 1, next)));
+    e.dirty.store(true);
+    e.version.store(nextVersion());
+    return next;
+}
+
+size_t SeatInventory::flush(Database& db) {
+    std::lock_guard<std::mutex> guard(flush_mutex_);
+
+    std::vector<std::string>            rows;
+    std::vector<std::shared_ptr<Entry>> entries;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& kv : by_uri_) {
+            // dirty se briše PRIJE čitanja brojača: promjena nakon čitanja ga ponovo postavi
+            if (kv.second->dirty.exchange(false)) {
+                rows.push_back(kv.first);
+                entries.push_back(kv.second);
+            }
+        }
+    }
+    if (rows.empty()) return 0;
+
+    // Brojač se čita iz Entry-ja (i za vozilo uklonjeno u međuvremenu), tek pod write lock-om
+    size_t next = 0;
+    auto current = [&](const std::string&) { return availableOf(entries[next++]->seats.load()); };
+    if (!db.updateSeatAvailabilityBatch(rows, current)) {
+        for (auto& e : entries) e->dirty.store(true);   // pokušaj ponovo u sljedećem krugu
+        return 0;
+    }
+    flushes_++;
+    rows_flushed_ += rows.size();
+    return rows.size();
+}
+
+std::vector<Vehicle> SeatInventory::exportVehicles() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<Vehicle> out;
+    out.reserve(by_uri_.size());
+    for (const auto& kv : by_uri_) {
+        const Entry& e = *kv.second;
+        Vehicle v{};
+        v.uri             = e.uri;
+        v.type            = e.type;
+        v.route           = e.route;
+        v.active          = e.active;
+        v.capacity        = e.capacity.load();
+        v.available_seats = availableOf(e.seats.load());
+        out.push_back(std::move(v));
+    }
+    return out;
+}
+
+size_t SeatInventory::dirtyCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto& kv : by_uri_) n += kv.second->dirty.load() ? 1 : 0;
+    return n;
+}
+
+SeatInventory::Stats SeatInventory::getStats() const {
+    Stats st;
+    st.reservations = reservations_;
+    st.rejections   = rejections_;
+    st.flushes      = flushes_;
+    st.rows_flushed = rows_flushed_;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    st.vehicles = by_uri_.size();
+    return st;
+}
+
+SeatInventory::RouteStatus
+SeatInventory::statusSince(const std::vector<std::string>& routes, uint64_t since) const {
+    RouteStatus st;
+    {
+        // Nijedna promjena nije između dodjele verzije i upisa u Entry
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        st.version = version_.load();
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    st.full = since == 0 || since < delta_floor_ || since > st.version;
+
+    auto wanted = [&](const std::string& route) {
+        return routes.empty() || std::find(routes.begin(), routes.end(), route) != routes.end();
+    };
+    auto collect = [&](const RouteVehicles& rv) {
+        for (const auto& group : rv.by_type) {
+            for (const auto& e : group) {
+                if (st.full || e->version.load() > since) st.vehicles.push_back(snapshotOf(*e));
+            }
+        }
+    };
+
+    if (routes.empty()) {
+        for (const auto& kv : by_route_) collect(kv.second);
+    } else {
+        for (const auto& r : routes) {
+            auto it = by_route_.find(r);
+            if (it != by_route_.end()) collect(it->second);
+        }
+    }
+    if (!st.full) {
+        for (const auto& t : tombstones_) {
+            if (t.version <= since || !wanted(t.route)) continue;
+            // Vozilo premješteno na drugu traženu rutu je već u 'vehicles'
+            const bool present = std::any_of(st.vehicles.begin(), st.vehicles.end(),
+                [&](const Snapshot& s) { return s.uri == t.uri; });
+            if (present) continue;
+            Snapshot gone;
+            gone.uri     = t.uri;
+            gone.route   = t.route;
+            gone.version = t.version;
+            st.removed.push_back(std::move(gone));
+        }
+    }
+    return st;
+}
+
+} // namespace transport
@@ -1,12 +1,31 @@
 #include "server/ServerBase.h"
+#include "common/BufferPool.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <cctype>
+#include <algorithm>
 
 namespace transport {
 
 ServerBase::ServerBase(const std::string& server_name) 
     : server_name_(server_name) {
     logger_ = Logger::getLogger(server_name_);
+    error_responses_ = &metrics::Registry::instance().counter(
+        "tp_error_responses_total", "server=\"" + server_name_ + "\"", "Error responses sent to clients");
+    auto rejected = [&](const char* reason) {
+        return &metrics::Registry::instance().counter(
+            "tp_admission_rejected_total", "server=\"" + server_name_ + "\",reason=\"" + reason + "\"",
+            "Connections and requests refused by admission control");
+    };
+    rejected_connections_  = rejected("connections");
+    rejected_rate_limited_ = rejected("rate_limited");
+    rejected_overloaded_   = rejected("overloaded");
+    heartbeats_sent_    = &metrics::Registry::instance().counter(
+        "tp_heartbeats_sent_total", "server=\"" + server_name_ + "\"", "HEARTBEAT probes sent to idle connections");
+    connections_reaped_ = &metrics::Registry::instance().counter(
+        "tp_connections_reaped_total", "server=\"" + server_name_ + "\"",
+        "Connections closed after connection_timeout without traffic or a failed heartbeat");
     setupDefaultConfiguration();
 }
 
@@ -17,11 +36,15 @@ ServerBase::~ServerBase() {
 void ServerBase::stop() {
     if (!running_) return;
     running_ = false;
+    timers_.stop();
     
     // Zaustavi TLS/Asio server
     if (tls_server_) {
         tls_server_->stop();
     }
+
+    // Worker niti su stale -> sigurno zatvori preostale async sesije
+    closeAllAsyncSessions();
     
     // Pričekaj accept nit 
     if (accept_thread_ && accept_thread_->joinable()) {
@@ -43,12 +66,61 @@ void ServerBase::stop() {
 }
 
 bool ServerBase::loadConfiguration(const std::string& config_file) {
-    // Basic configuration loading (stub)
-    std::ifstream file(config_file);
-    if (!file.is_open()) {
+    ServerConfig cfg;
+    if (!cfg.loadFromFile(config_file)) {
         logWarning("Could not open configuration file: " + config_file);
         return false;
     }
+
+    max_connections_        = cfg.max_connections;
+    connection_timeout_     = cfg.connection_timeout;
+    require_authentication_ = cfg.require_authentication;
+    enable_heartbeat_       = cfg.enable_heartbeat;
+    heartbeat_interval_     = cfg.heartbeat_interval;
+    worker_pool_            = cfg.worker_pool;
+    worker_threads_         = cfg.worker_threads;
+    io_shards_              = cfg.io_shards;
+    io_cpu_affinity_        = cfg.io_cpu_affinity;
+
+    // [logging]: async red je zajednički za sve Logger-e u procesu
+    Logger::AsyncOptions log_opt;
+    log_opt.enabled    = cfg.getBool("logging", "async", log_opt.enabled);
+    log_opt.queue_size = static_cast<size_t>(std::max(16, cfg.getInt("logging", "queue_size",
+                                                                     static_cast<int>(log_opt.queue_size))));
+    log_opt.overflow   = cfg.getString("logging", "overflow", "block") == "drop"
+                             ? Logger::OverflowPolicy::DROP : Logger::OverflowPolicy::BLOCK;
+    Logger::configureAsync(log_opt);
+
+    // [admission]: rate limit po klijentu (zahtjeva/s, burst) i granica zahtjeva u obradi
+    AdmissionControl::Options adm_opt;
+    adm_opt.rate             = std::max(0.0, cfg.getDouble("admission", "rate_limit", adm_opt.rate));
+    adm_opt.burst            = std::max(0.0, cfg.getDouble("admission", "burst", adm_opt.burst));
+    adm_opt.max_inflight     = std::max(0, cfg.getInt("admission", "max_inflight", adm_opt.max_inflight));
+    adm_opt.retry_after_ms   = static_cast<uint32_t>(std::max(1, cfg.getInt("admission", "retry_after_ms",
+                                                                           static_cast<int>(adm_opt.retry_after_ms))));
+    adm_opt.max_tracked_keys = static_cast<size_t>(std::max(16, cfg.getInt("admission", "max_tracked_keys",
+                                                                          static_cast<int>(adm_opt.max_tracked_keys))));
+    admission_.configure(adm_opt);
+    if (logger_) {
+        logger_->setRotation(static_cast<uint64_t>(std::max(0.0, cfg.getDouble("logging", "max_log_size", 0))),
+                             cfg.getInt("logging", "max_log_files", 0));
+    }
+
+    // [tracing]: bez export_path tracing ostaje isključen (Span ne čita sat)
+    const std::string trace_path = cfg.getString("tracing", "export_path", "");
+    if (!trace_path.empty()) {
+        tracing::Tracer::Options trace_opt;
+        trace_opt.service     = server_name_;
+        trace_opt.export_path = trace_path;
+        trace_opt.sample_rate = std::min(1.0, std::max(0.0, cfg.getDouble("tracing", "sample_rate", 0.0)));
+        trace_opt.queue_limit = static_cast<size_t>(std::max(16, cfg.getInt("tracing", "queue_limit",
+                                                                            static_cast<int>(trace_opt.queue_limit))));
+        if (!tracing::Tracer::instance().configure(trace_opt)) {
+            logWarning("Could not open trace export file: " + trace_path);
+        }
+    }
+    server_config_          = std::move(cfg);
+
     logInfo("Configuration loaded from: " + config_file);
     return true;
 }
@@ -81,20 +153,74 @@ void ServerBase::logWarning(const std::string& message) { if (logger_) logger_->
 void ServerBase::logError(const std::string& message)   { if (logger_) logger_->error(message); }
 void ServerBase::logDebug(const std::string& message)   { if (logger_) logger_->debug(message); }
 
+namespace {
+thread_local uint32_t t_request_sequence_id = 0;   // zahtjev koji nit trenutno obrađuje
+} // namespace
+
+ServerBase::RequestScope::RequestScope(uint32_t sequence_id)
+    : previous_(t_request_sequence_id) {
+    t_request_sequence_id = sequence_id;
+}
+
+ServerBase::RequestScope::~RequestScope() {
+    t_request_sequence_id = previous_;
+}
+
+void ServerBase::traceReceive(tracing::Span& root, const std::unique_ptr<TLSSocket>& client) {
+    if (!root.sampled() || !client) return;
+    const auto& rx = client->lastReceiveTiming();
+    if (rx.header_at == std::chrono::steady_clock::time_point{}) return;
+    root.setStartTime(rx.header_at);
+    tracing::recordSpan("tls.read", rx.header_at, rx.read_ns);
+    tracing::recordSpan("decode", rx.header_at + std::chrono::nanoseconds(rx.read_ns), rx.decode_ns);
+}
+
 void ServerBase::sendResponse(std::unique_ptr<TLSSocket>& client, std::unique_ptr<Message> response) {
     if (client && response) {
+        if (response->getSequenceId() == 0) response->setSequenceId(t_request_sequence_id);
+        tracing::Span span("tls.write", static_cast<uint16_t>(response->getType()));
         client->sendMessage(*response);
     }
 }
 
+void ServerBase::sendResponse(std::unique_ptr<TLSSocket>& client, const ResponseTemplate& response,
+                              std::initializer_list<ResponseTemplate::Value> values) {
+    if (!client) return;
+    tracing::Span span("tls.write", static_cast<uint16_t>(response.type()));
+    auto& pool = BufferPool::local();
+    auto frame = pool.acquire();
+    response.render(frame, client->getProtocolVersion(), t_request_sequence_id, values);
+    client->sendFrame(frame.data(), frame.size());
+    pool.release(std::move(frame));
+}
+
 void ServerBase::sendErrorResponse(std::unique_ptr<TLSSocket>& client, const std::string& error, int code) {
+    error_responses_->inc();
+    sendResponse(client, MessageFactory::errorResponseTemplate(), {error, code});
+}
+
+void ServerBase::sendRetryLater(std::unique_ptr<TLSSocket>& client, const std::string& error, int code,
+                                uint32_t retry_after_ms) {
+    error_responses_->inc();
     auto response = MessageFactory::createErrorResponse(error, code);
+    response->addInt("retry_after_ms", static_cast<int32_t>(retry_after_ms));
+    response->calculateChecksum();
     sendResponse(client, std::move(response));
 }
 
 void ServerBase::sendSuccessResponse(std::unique_ptr<TLSSocket>& client, const std::string& message) {
-    auto response = MessageFactory::createSuccessResponse(message);
-    sendResponse(client, std::move(response));
+    if (message.empty()) {
+        sendResponse(client, MessageFactory::createSuccessResponse(message));
+        return;
+    }
+    sendResponse(client, MessageFactory::successResponseTemplate(), {message});
+}
+
+uint16_t ServerBase::acceptConnect(std::string_view requested_version, std::unique_ptr<TLSSocket>& client) {
+    const uint16_t version = parseProtocolVersion(requested_version);
+    sendResponse(client, MessageFactory::connectAcceptedTemplate(), {std::to_string(version) + ".0"});
+    if (client) client->setProtocolVersion(version);
+    return version;
 }
 
 void ServerBase::setupDefaultConfiguration() {
@@ -121,30 +247,57 @@ void ServerBase::cleanupFinishedThreads() {
 
 // ------------------------ Boost.Asio TLS server kroz TLSServer ------------------------
 
-void ServerBase::startServer() {
+bool ServerBase::startServer() {
     // Kreiraj TLS server ako nije već kreiran
     if (!tls_server_) {
         tls_server_ = std::make_unique<TLSServer>();
     }
 
-    // Postavi connection callback: svaku novu TLS konekciju obradi u zasebnoj niti,
-    // kako accept/handshake (Asio) ne bi bili blokirani aplikativnim kodom.
-    tls_server_->setConnectionCallback([this](std::unique_ptr<TLSSocket> client) {
-        auto th = std::make_unique<std::thread>(
-            [this, c = std::move(client)]() mutable {
-                handleClient(std::move(c));
-            }
-        );
-        {
-            std::lock_guard<std::mutex> g(threads_mutex_);
-            client_threads_.emplace_back(std::move(th));
-        }
-    });
-)
+    if (io_shards_ > 0) {
+        // io_context po jezgru: accept raspoređuje sockete round-robin, handshake i
+        // sesija ostaju na shard-u koji posjeduje socket
+        tls_server_->setExecutionMode(TLSServer::ExecutionMode::SHARDED, io_shards_);
+        tls_server_->setCpuAffinity(io_cpu_affinity_);
+        tls_server_->setConnectionCallback([this](std::unique_ptr<TLSSocket> client) {
+            startAsyncSession(std::move(client));
+        });
+    } else if (worker_pool_) {
+        // Fiksni pool worker niti; svaka konekcija je async read/dispatch sesija
+        tls_server_->setExecutionMode(TLSServer::ExecutionMode::WORKER_POOL, worker_threads_);
+        tls_server_->setConnectionCallback([this](std::unique_ptr<TLSSocket> client) {
+            startAsyncSession(std::move(client));
+        });
+    } else {
+        // Svaku novu TLS konekciju obradi u zasebnoj niti,
+        // kako accept/handshake (Asio) ne bi bili blokirani aplikativnim kodom.
+        tls_server_->setExecutionMode(TLSServer::ExecutionMode::THREAD_PER_CONNECTION);
+        tls_server_->setConnectionCallback([this](std::unique_ptr<TLSSocket> client) {
+            handleClient(std::move(client));
+        });
+    }
+
+    // [security] tls_handshake_timeout (s), session_resumption, session_lifetime (s)
+    tls_server_->setHandshakeTimeout(std::chrono::seconds(std::max(0, server_config_.tls_handshake_timeout)));
+    tls_server_->setSessionResumption(server_config_.getBool("security", "session_resumption", true),
+                                      server_config_.getInt("security", "session_lifetime", 7200));
+    tls_server_->setSocketOptions(server_config_.socket_options);
+    tls_server_->setConnectionFilter([this](std::unique_ptr<TLSSocket>& client) { return admitConnection(client); });
+
     if (!tls_server_->start(port_, cert_file_, key_file_)) {
         logError("Failed to start TLSServer on port " + std::to_string(port_));
-        throw std::runtime_error("TLSServer start failed");
+        return false;
     }
+    if (io_shards_ > 0) {
+        logInfo("IO shards: " + std::to_string(tls_server_->getShardCount()) +
+                (io_cpu_affinity_ ? " (pinned)" : "") + ", " +
+                std::to_string(tls_server_->getAcceptorCount()) + " acceptor(s)");
+    } else if (worker_pool_) {
+        logInfo("Worker pool: " + std::to_string(tls_server_->getWorkerThreads()) + " io threads, " +
+                std::to_string(tls_server_->getAcceptorCount()) + " acceptor(s)");
+    }
+    timers_.schedule("connections", std::chrono::seconds(1), [this] { maintainConnections(); });
+    timers_.start();
+    return true;
 }
 
 void ServerBase::acceptConnections() {
@@ -156,19 +309,215 @@ void ServerBase::handleClient(std::unique_ptr<TLSSocket> client_socket) {
     // Delegiraj na aplikativni handler izvedene klase.
     // Poruka na startu nije poznata proslijedi nullptr kao drugi argument.
     handleClientMessage(std::move(client_socket), nullptr);
+    releaseConnectionSlot();   // mjesto rezervisano u admitConnection
+}
+
+void ServerBase::onClientDisconnected(TLSSocket* /*client*/) {}
+
+void ServerBase::processMessageView(const MessageView& view, std::unique_ptr<TLSSocket>& client) {
+    // Podrazumijevano: materijalizuj i koristi postojeći handler
+    processMessage(view.toMessage(), client);
+}
+
+// ------------------------ Async sesije (WORKER_POOL) ------------------------
+
+void ServerBase::startAsyncSession(std::unique_ptr<TLSSocket> client) {
+    if (!client) {
+        releaseConnectionSlot();
+        return;
+    }
+
+    total_connections_++;
+    active_connections_++;
+    TP_LOG_INFO(logger_, "New client connected from ", client->getPeerAddress(), ":", client->getPeerPort());
+
+    auto session = std::make_shared<AsyncSession>();
+    session->socket = std::move(client);
+    {
+        std::lock_guard<std::mutex> lk(async_sessions_mutex_);
+        async_sessions_.insert(session);
+    }
+    trackConnection(session->socket.get());
+    readNextMessage(session);
+}
+
+void ServerBase::readNextMessage(const std::shared_ptr<AsyncSession>& session) {
+    if (!running_ || !session->socket || !session->socket->isConnected()) {
+        closeAsyncSession(session);
+        return;
+    }
+
+    session->socket->asyncReceiveView(
+        [this, session](const MessageView& view) {
+            // Jedna poruka po sesiji u obradi: sljedeći read tek nakon obrade (view ostaje
+            // važeći); klijent svejedno može poslati više zahtjeva, odgovori idu redom
+            RequestScope scope(view.getSequenceId());
+            if (auto ticket = admitRequest(view, session->socket)) processMessageView(view, session->socket);
+            readNextMessage(session);
+        },
+        [this, session](const std::string& error) {
+            TP_LOG_DEBUG(logger_, "Session read ended: ", error);
+            closeAsyncSession(session);
+        });
+}
+
+void ServerBase::closeAsyncSession(const std::shared_ptr<AsyncSession>& session) {
+    {
+        std::lock_guard<std::mutex> lk(async_sessions_mutex_);
+        if (session->closed) return;
+        session->closed = true;
+        async_sessions_.erase(session);
+    }
+    untrackConnection(session->socket.get());
+    active_connections_--;
+    releaseConnectionSlot();
+    onClientDisconnected(session->socket.get());
+    // Tvrdo zatvaranje: sync TLS shutdown bi blokirao worker nit čekajući peer-a
+    if (session->socket) session->socket->close();
+    logInfo("Client disconnected");
+}
+
+void ServerBase::closeAllAsyncSessions() {
+    std::set<std::shared_ptr<AsyncSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lk(async_sessions_mutex_);
+        sessions.swap(async_sessions_);
+    }
+    for (auto& session : sessions) {
+        {
+            std::lock_guard<std::mutex> lk(async_sessions_mutex_);
+            if (session->closed) continue;
+            session->closed = true;
+        }
+        untrackConnection(session->socket.get());
+        active_connections_--;
+        releaseConnectionSlot();
+        onClientDisconnected(session->socket.get());
+        if (session->socket) session->socket->close();
+    }
 }
 
 // ------------------------ Connection helpers (minimalni stubovi) ------------------------
 
 bool ServerBase::validateClient(std::unique_ptr<TLSSocket>& /*client*/) {
-    // Minimalna provjera na nivou baze klase (limit konekcija)
-    if (active_connections_ >= max_connections_) {
-        logWarning("Max connections reached");
-        return false;
-    }
+    // Limit konekcija (<= 0 -> bez limita): provjera i rezervacija u jednom CAS-u, pa ni
+    // talas paralelnih handshake-ova ne prođe preko limita prije nego sesije krenu
+    int admitted = admitted_connections_.load();
+    do {
+        if (max_connections_ > 0 && admitted >= max_connections_) {
+            logWarning("Max connections reached");
+            return false;
+        }
+    } while (!admitted_connections_.compare_exchange_weak(admitted, admitted + 1));
     return true;
 }
 
+void ServerBase::releaseConnectionSlot() {
+    admitted_connections_--;
+}
+
+bool ServerBase::admitConnection(std::unique_ptr<TLSSocket>& client) {
+    // Prihvaćena konekcija drži mjesto od filtera do kraja sesije (handleClient /
+    // closeAsyncSession); odbijena ga nikad ne dobije
+    if (validateClient(client)) return true;
+    rejected_connections_->inc();
+    sendRetryLater(client, "Server is at connection capacity", 503, admission_.options().retry_after_ms);
+    return false;
+}
+
+AdmissionControl::Ticket ServerBase::admitRequest(const MessageView& view, std::unique_ptr<TLSSocket>& client) {
+    if (!admission_.enabled()) return admitKey(view.getType(), {}, client);
+    for (const char* field : {"urn", "uri", "session_id"}) {
+        if (view.hasKey(field)) return admitKey(view.getType(), view.getStringView(field), client);
+    }
+    return admitKey(view.getType(), client ? client->getPeerAddress() : std::string(), client);
+}
+
+AdmissionControl::Ticket ServerBase::admitRequest(const Message& message, std::unique_ptr<TLSSocket>& client) {
+    if (!admission_.enabled()) return admitKey(message.getType(), {}, client);
+    for (const char* field : {"urn", "uri", "session_id"}) {
+        if (message.hasKey(field)) return admitKey(message.getType(), message.getString(field), client);
+    }
+    return admitKey(message.getType(), client ? client->getPeerAddress() : std::string(), client);
+}
+
+AdmissionControl::Ticket ServerBase::admitKey(MessageType type, std::string_view key,
+                                               std::unique_ptr<TLSSocket>& client) {
+    // Kontrolne poruke konekcije ne troše tokene (heartbeat ne smije oboriti sesiju)
+    if (type == MessageType::CONNECT_REQUEST || type == MessageType::HEARTBEAT || type == MessageType::DISCONNECT) {
+        return AdmissionControl::bypass();
+    }
+    AdmissionControl::Decision decision = AdmissionControl::Decision::ADMIT;
+    uint32_t retry_after_ms = 0;
+    auto ticket = admission_.admit(key, decision, retry_after_ms);
+    if (ticket) return ticket;
+
+    if (decision == AdmissionControl::Decision::RATE_LIMITED) {
+        rejected_rate_limited_->inc();
+        sendRetryLater(client, "Rate limit exceeded", 429, retry_after_ms);
+    } else {
+        rejected_overloaded_->inc();
+        sendRetryLater(client, "Server overloaded", 503, retry_after_ms);
+    }
+    return ticket;
+}
+
+ServerBase::TrackedConnection::TrackedConnection(ServerBase& server, TLSSocket* socket)
+    : server_(server), socket_(socket) {
+    server_.trackConnection(socket_);
+}
+
+ServerBase::TrackedConnection::~TrackedConnection() {
+    server_.untrackConnection(socket_);
+}
+
+void ServerBase::trackConnection(TLSSocket* socket) {
+    if (!socket) return;
+    std::lock_guard<std::mutex> lk(live_connections_mutex_);
+    live_connections_[socket] = LiveConnection{};
+}
+
+void ServerBase::untrackConnection(TLSSocket* socket) {
+    std::lock_guard<std::mutex> lk(live_connections_mutex_);
+    live_connections_.erase(socket);
+}
+
+void ServerBase::maintainConnections() {
+    const auto now       = std::chrono::steady_clock::now();
+    const auto heartbeat = std::chrono::seconds(heartbeat_interval_);
+    const auto timeout   = std::chrono::seconds(connection_timeout_);
+    std::unique_ptr<Message> probe;
+
+    // Pod mutex-om: vlasnik ne može zatvoriti socket dok ga ovdje diramo. Klijent na sondu
+    // odgovara keepalive-om (v. TLSSocket::receiveFrame), pa živ slušalac ne ističe
+    std::lock_guard<std::mutex> lk(live_connections_mutex_);
+    for (auto& kv : live_connections_) {
+        TLSSocket*      socket = kv.first;
+        LiveConnection& conn   = kv.second;
+        if (conn.reaped) continue;
+        const auto idle = now - socket->lastActivity();
+
+        if (connection_timeout_ > 0 && idle >= timeout) {
+            conn.reaped = true;
+            connections_reaped_->inc();
+            TP_LOG_INFO(logger_, "Closing idle connection ", socket->getPeerAddress(), ":", socket->getPeerPort(),
+                        " (", std::chrono::duration_cast<std::chrono::seconds>(idle).count(), " s without traffic)");
+            socket->shutdownTransport();
+            continue;
+        }
+        if (!enable_heartbeat_ || heartbeat_interval_ <= 0 || idle < heartbeat || now - conn.last_probe < heartbeat) {
+            continue;
+        }
+        if (!probe) probe = MessageFactory::createKeepalive();
+        conn.last_probe = now;
+        // Sonda ide u red upisa na strand-u konekcije (i sync handler čita preko njega), pa
+        // tajmer ne blokira niti dira SSL stanje paralelno s read-om; neuspjeh upisa ne
+        // zatvara ovdje - bez odgovora konekcija ističe na connection_timeout
+        if (socket->getPendingWrites() > 0) continue;   // upis u toku, sonda ništa ne dodaje
+        if (socket->asyncSendMessage(*probe)) heartbeats_sent_->inc();
+    }
+}
+
 void ServerBase::disconnectClient(std::unique_ptr<TLSSocket>& client) {
     // Ako TLSSocket ima close/shutdown – pozovi; inače reset je dovoljan
     if (client) {
@@ -184,16 +533,133 @@ void ServerBase::broadcastMessage(std::unique_ptr<Message> /*message*/) {
 
 // ------------------------ ServerConfig impl ------------------------
 
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t b = 0, e = s.size();
+    while (b < e && std::isspace(static_cast<unsigned char>(s[b]))) ++b;
+    while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1]))) --e;
+    return s.substr(b, e - b);
+}
+
+} // namespace
+
 bool ServerConfig::loadFromFile(const std::string& config_file) {
-    // Basic config file parsing (stub)
+    // INI format: [sekcija], kljuc = vrijednost, komentari '#'/';'
     std::ifstream file(config_file);
     if (!file.is_open()) {
         return false;
     }
-    // TODO: parse key=value (nije predmet ove prepravke)
+
+    values_.clear();
+    std::string section;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+
+        if (line.front() == '[' && line.back() == ']') {
+            section = trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+
+        auto eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key   = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+        values_[section + "." + key] = value;
+    }
+
+    port                   = getInt("server", "port", port);
+    bind_address           = getString("server", "bind_address", bind_address);
+    max_connections        = getInt("server", "max_connections", max_connections);
+    connection_timeout     = getInt("server", "connection_timeout", connection_timeout);
+    enable_ipv6            = getBool("server", "enable_ipv6", enable_ipv6);
+    worker_pool            = getBool("server", "worker_pool", worker_pool);
+    worker_threads         = getInt("server", "worker_threads", worker_threads);
+    io_shards              = getInt("server", "io_shards", io_shards);
+    io_cpu_affinity        = getBool("server", "io_cpu_affinity", io_cpu_affinity);
+
+    enable_tls             = getBool("security", "enable_tls", enable_tls);
+    cert_file              = getString("security", "cert_file", cert_file);
+    key_file               = getString("security", "key_file", key_file);
+    tls_handshake_timeout  = getInt("security", "tls_handshake_timeout", tls_handshake_timeout);
+    require_authentication = getBool("security", "require_authentication", require_authentication);
+
+    database_path          = getString("database", "database_path", database_path);
+    database_pool_size     = getInt("database", "pool_size", database_pool_size);
+    wal_checkpoint_interval = getInt("database", "wal_checkpoint_interval", wal_checkpoint_interval);
+    database_thread_affinity = getBool("database", "thread_affinity", database_thread_affinity);
+    {
+        auto& db = database_options;
+        db.wal_mode        = getBool("database", "wal_mode", db.wal_mode);
+        db.synchronous     = getString("database", "synchronous", db.synchronous);
+        db.cache_size      = getInt("database", "cache_size", db.cache_size);
+        db.busy_timeout_ms = getInt("database", "busy_timeout", db.busy_timeout_ms);
+        db.mmap_size       = static_cast<int64_t>(getDouble("database", "mmap_size",
+                                                            static_cast<double>(db.mmap_size)));
+        db.temp_store      = getString("database", "temp_store", db.temp_store);
+        // Pozadinski checkpoint preuzima posao auto-checkpointa; bez njega SQLite default (1000)
+        db.wal_autocheckpoint = getInt("database", "wal_autocheckpoint",
+                                       wal_checkpoint_interval > 0 ? 0 : 1000);
+    }
+
+    log_file               = getString("logging", "log_file", log_file);
+
+    heartbeat_interval     = getInt("network", "heartbeat_interval", heartbeat_interval);
+    socket_buffer_size     = getInt("network", "socket_buffer_size", socket_buffer_size);
+    {
+        auto& so = socket_options;
+        so.tcp_nodelay        = getBool("server", "tcp_nodelay", so.tcp_nodelay);
+        so.keepalive          = getBool("server", "tcp_keepalive",
+                                        getBool("network", "enable_keepalive", so.keepalive));
+        so.reuse_address      = getBool("server", "socket_reuse_addr", so.reuse_address);
+        so.reuse_port         = getBool("server", "socket_reuse_port", so.reuse_port);
+        so.keepalive_idle     = getInt("network", "keepalive_idle", so.keepalive_idle);
+        so.keepalive_interval = getInt("network", "keepalive_interval", so.keepalive_interval);
+        so.keepalive_count    = getInt("network", "keepalive_count", so.keepalive_count);
+        so.max_frame_bytes    = static_cast<size_t>(std::max(0, getInt("network", "max_frame_bytes",
+                                                                       static_cast<int>(so.max_frame_bytes))));
+        // Bez ključa ostaje kernel autotuning (fiksni SO_RCVBUF ga isključuje)
+        if (has("network", "socket_buffer_size")) so.buffer_size = socket_buffer_size;
+    }
     return true;
 }
 
+bool ServerConfig::has(const std::string& section, const std::string& key) const {
+    return values_.find(section + "." + key) != values_.end();
+}
+
+std::string ServerConfig::getString(const std::string& section, const std::string& key,
+                                    const std::string& def) const {
+    auto it = values_.find(section + "." + key);
+    return it != values_.end() ? it->second : def;
+}
+
+int ServerConfig::getInt(const std::string& section, const std::string& key, int def) const {
+    auto it = values_.find(section + "." + key);
+    if (it == values_.end()) return def;
+    try { return std::stoi(it->second); } catch (...) { return def; }
+}
+
+double ServerConfig::getDouble(const std::string& section, const std::string& key, double def) const {
+    auto it = values_.find(section + "." + key);
+    if (it == values_.end()) return def;
+    try { return std::stod(it->second); } catch (...) { return def; }
+}
+
+bool ServerConfig::getBool(const std::string& section, const std::string& key, bool def) const {
+    auto it = values_.find(section + "." + key);
+    if (it == values_.end()) return def;
+    const std::string& v = it->second;
+    if (v == "true" || v == "1" || v == "yes" || v == "on")  return true;
+    if (v == "false" || v == "0" || v == "no" || v == "off") return false;
+    return def;
+}
+
 bool ServerConfig::saveToFile(const std::string& config_file) const {
     std::ofstream file(config_file);
     if (!file.is_open()) {
@@ -201,6 +667,10 @@ bool ServerConfig::saveToFile(const std::string& config_file) const {
     }
     file << "port = " << port << "\n";
     file << "max_connections = " << max_connections << "\n";
+    file << "worker_pool = " << (worker_pool ? "true" : "false") << "\n";
+    file << "worker_threads = " << worker_threads << "\n";
+    file << "io_shards = " << io_shards << "\n";
+    file << "io_cpu_affinity = " << (io_cpu_affinity ? "true" : "false") << "\n";
     // Ostali parametri po potrebi...
     return true;
 }
@@ -219,6 +689,11 @@ void ServerConfig::setDefaults() {
     socket_buffer_size = 65536;
     enable_tls = true;
     tls_handshake_timeout = 10;
+    socket_options = SocketOptions{};
+    worker_pool = false;
+    worker_threads = 0;
+    io_shards = 0;
+    io_cpu_affinity = false;
 }
 
 bool ServerConfig::validate() const {
@@ -0,0 +1,219 @@
+#include "server/SessionStore.h"
+
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <random>
+
+namespace transport {
+
+namespace {
+inline uint64_t hexValue(char c) {
+    if (c >= '0' && c <= '9') return static_cast<uint64_t>(c - '0');
+    if (c >= 'a' && c <= 'f') return static_cast<uint64_t>(c - 'a' + 10);
+    return 0;
+}
+} // namespace
+
+size_t SessionStore::TokenHash::operator()(const std::string& token) const noexcept {
+    // Token je slučajan: prvih 64 bita su već dobar hash
+    if (token.size() == kTokenLength) {
+        uint64_t h = 0;
+        for (size_t i = 0; i < 16; ++i) h = (h << 4) | hexValue(token[i]);
+        return static_cast<size_t>(h);
+    }
+    return std::hash<std::string>{}(token);
+}
+
+SessionStore::SessionStore(std::chrono::seconds idle_timeout, size_t shard_count,
+                           std::chrono::milliseconds tick)
+    : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1000)),
+      idle_timeout_ms_(std::chrono::duration_cast<std::chrono::milliseconds>(idle_timeout).count()),
+      epoch_(Clock::now()) {
+    if (shard_count == 0) shard_count = 1;
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) shards_.push_back(std::make_unique<Shard>());
+}
+
+std::string SessionStore::generateToken() {
+    unsigned char raw[kTokenLength / 2];
+    if (RAND_bytes(raw, sizeof(raw)) != 1) {
+        // OpenSSL CSPRNG nedostupan (ne bi se trebalo desiti) -> random_device
+        std::random_device rd;
+        for (auto& b : raw) b = static_cast<unsigned char>(rd());
+    }
+    static const char* kHex = "0123456789abcdef";
+    std::string token(kTokenLength, '0');
+    for (size_t i = 0; i < sizeof(raw); ++i) {
+        token[2 * i]     = kHex[raw[i] >> 4];
+        token[2 * i + 1] = kHex[raw[i] & 0x0F];
+    }
+    return token;
+}
+
+SessionStore::Shard& SessionStore::shardFor(const std::string& session_id) {
+    // Viši biti hash-a za shard, niži ostaju unordered_map-u
+    return *shards_[(TokenHash{}(session_id) >> 32) % shards_.size()];
+}
+
+const SessionStore::Shard& SessionStore::shardFor(const std::string& session_id) const {
+    return *shards_[(TokenHash{}(session_id) >> 32) % shards_.size()];
+}
+
+uint64_t SessionStore::tickOf(Clock::time_point t) const {
+    if (t <= epoch_) return 0;
+    return static_cast<uint64_t>((t - epoch_) / tick_);
+}
+
+void SessionStore::TimerWheel::schedule(Timer t) {
+    if (t.deadline <= current) t.deadline = current + 1;
+    const uint64_t delta = t.deadline - current;
+    if (delta < kLevel0) {
+        level0[t.deadline % kLevel0].push_back(std::move(t));
+    } else if (delta < kLevel0 * kLevel1) {
+        level1[(t.deadline / kLevel0) % kLevel1].push_back(std::move(t));
+    } else {
+        // Dalje od dometa wheel-a: najdalji L1 slot, pri kaskadi se ponovo zakaže
+        level1[(current / kLevel0 + kLevel1 - 1) % kLevel1].push_back(std::move(t));
+    }
+}
+
+std::string SessionStore::create(const std::string& user_urn) {
+    const auto now = Clock::now();
+    const auto ttl = std::chrono::milliseconds(idle_timeout_ms_.load());
+    for (;;) {
+        std::string token = generateToken();
+        Shard& shard = shardFor(token);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.sessions.count(token)) continue;        // praktično nemoguće, ali jeftino
+        shard.sessions.emplace(token, Session{user_urn, now});
+        shard.wheel.schedule({token, tickOf(now + ttl) + 1});
+        return token;
+    }
+}
+
+std::optional<std::string> SessionStore::touch(const std::string& session_id) {
+    Shard& shard = shardFor(session_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(session_id);
+    if (it == shard.sessions.end()) return std::nullopt;
+    it->second.last_activity = Clock::now();
+    return it->second.user_urn;
+}
+
+bool SessionStore::contains(const std::string& session_id) const {
+    const Shard& shard = shardFor(session_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.sessions.find(session_id) != shard.sessions.end();
+}
+
+bool SessionStore::remove(const std::string& session_id) {
+    Shard& shard = shardFor(session_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(session_id);
+    if (it == shard.sessions.end()) return false;
+    shard.sessions.erase(it);        // timer ostaje u wheel-u i ignoriše se kad okine
+    return true;
+}
+
+size_t SessionStore::expireShard(Shard& shard, uint64_t to_tick, Clock::time_point now) {
+    using Wheel = TimerWheel;
+    const auto ttl = std::chrono::milliseconds(idle_timeout_ms_.load());
+    size_t expired = 0;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& w = shard.wheel;
+    while (w.current < to_tick) {
+        w.current++;
+
+        // Početak novog L0 kruga: spusti odgovarajući L1 slot u L0
+        if (w.current % Wheel::kLevel0 == 0) {
+            auto cascade = std::move(w.level1[(w.current / Wheel::kLevel0) % Wheel::kLevel1]);
+            w.level1[(w.current / Wheel::kLevel0) % Wheel::kLevel1].clear();
+            for (auto& t : cascade) w.schedule(std::move(t));
+        }
+
+        auto due = std::move(w.level0[w.current % Wheel::kLevel0]);
+        w.level0[w.current % Wheel::kLevel0].clear();
+        for (auto& t : due) {
+            if (t.deadline > w.current) {          // još nije vrijeme (ne bi trebalo)
+                w.schedule(std::move(t));
+                continue;
+            }
+            auto it = shard.sessions.find(t.session_id);
+            if (it == shard.sessions.end()) continue;   // već uklonjena
+            const auto deadline = it->second.last_activity + ttl;
+            if (deadline <= now) {
+                shard.sessions.erase(it);
+                expired++;
+            } else {
+                // Bila je aktivna u međuvremenu -> zakaži prema stvarnom roku
+                t.deadline = tickOf(deadline) + 1;
+                w.schedule(std::move(t));
+            }
+        }
+    }
+    return expired;
+}
+
+size_t SessionStore::expire(Clock::time_point now) {
+    const uint64_t to_tick = tickOf(now);
+    size_t expired = 0;
+    for (auto& shard : shards_) expired += expireShard(*shard, to_tick, now);
+    return expired;
+}
+
+void SessionStore::setIdleTimeout(std::chrono::seconds timeout) {
+    // Već zakazani timeri se pri okidanju usklađuju s novim rokom
+    idle_timeout_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+}
+
+size_t SessionStore::size() const {
+    size_t n = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        n += shard->sessions.size();
+    }
+    return n;
+}
+
+std::vector<std::string> SessionStore::users() const {
+    std::vector<std::string> out;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& kv : shard->sessions) out.push_back(kv.second.user_urn);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+std::vector<SessionStore::Exported> SessionStore::exportSessions() const {
+    const auto now = Clock::now();
+    std::vector<Exported> out;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& kv : shard->sessions) {
+            const auto idle = now > kv.second.last_activity ? now - kv.second.last_activity : Clock::duration::zero();
+            out.push_back({kv.first, kv.second.user_urn,
+                           std::chrono::duration_cast<std::chrono::milliseconds>(idle)});
+        }
+    }
+    return out;
+}
+
+bool SessionStore::restore(const Exported& session) {
+    const auto ttl = std::chrono::milliseconds(idle_timeout_ms_.load());
+    if (session.session_id.size() != kTokenLength || session.user_urn.empty() ||
+        session.idle.count() < 0 || session.idle >= ttl) {
+        return false;
+    }
+    const auto last_activity = Clock::now() - session.idle;
+    Shard& shard = shardFor(session.session_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.sessions.emplace(session.session_id, Session{session.user_urn, last_activity}).second) return false;
+    shard.wheel.schedule({session.session_id, tickOf(last_activity + ttl) + 1});
+    return true;
+}
+
+} // namespace transport
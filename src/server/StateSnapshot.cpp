@@ -0,0 +1,281 @@
+#include "server/StateSnapshot.h"
+#include "common/Crc32.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace transport {
+
+namespace {
+
+const char kMagic[4] = {'T', 'P', 'S', '1'};
+
+void put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+void put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+uint32_t get32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+uint64_t get64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+struct Writer {
+    std::vector<uint8_t> out;
+
+    void u8(uint8_t v) { out.push_back(v); }
+    void u32(uint32_t v) { const size_t n = out.size(); out.resize(n + 4); put32(out.data() + n, v); }
+    void u64(uint64_t v) { const size_t n = out.size(); out.resize(n + 8); put64(out.data() + n, v); }
+    void str(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+};
+
+// Čitanje iz mapiranog fajla; svaka greška (kraj sekcije) ostavlja ok = false
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool           ok{true};
+
+    bool need(size_t n) {
+        if (!ok || static_cast<size_t>(end - p) < n) ok = false;
+        return ok;
+    }
+    uint8_t  u8()  { if (!need(1)) return 0; return *p++; }
+    uint32_t u32() { if (!need(4)) return 0; const uint32_t v = get32(p); p += 4; return v; }
+    uint64_t u64() { if (!need(8)) return 0; const uint64_t v = get64(p); p += 8; return v; }
+    std::string str() {
+        const uint32_t n = u32();
+        if (!need(n)) return {};
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+void setError(std::string* error, const std::string& message) {
+    if (error) *error = message;
+}
+
+void headerCrc(uint8_t* header) {
+    put32(header + 36, Crc32::compute(header, 36));
+}
+
+} // namespace
+
+bool StateSnapshot::write(const std::string& path, const Data& data, std::string* error) {
+    struct Built {
+        Section  type;
+        uint32_t items;
+        Writer   body;
+    };
+    std::vector<Built> sections(5);
+
+    sections[0].type = Section::META;
+    sections[0].items = 1;
+    sections[0].body.str(data.source);
+    sections[0].body.u64(static_cast<uint64_t>(data.vehicles_max_rowid));
+
+    sections[1].type  = Section::VEHICLES;
+    sections[1].items = static_cast<uint32_t>(data.vehicles.size());
+    for (const auto& v : data.vehicles) {
+        Writer& w = sections[1].body;
+        w.str(v.uri);
+        w.u8(static_cast<uint8_t>(v.type));
+        w.str(v.route);
+        w.u32(static_cast<uint32_t>(v.capacity));
+        w.u32(static_cast<uint32_t>(v.available_seats));
+        w.u8(v.active ? 1 : 0);
+    }
+
+    sections[2].type  = Section::SESSIONS;
+    sections[2].items = static_cast<uint32_t>(data.sessions.size());
+    for (const auto& s : data.sessions) {
+        sections[2].body.str(s.session_id);
+        sections[2].body.str(s.user_urn);
+        sections[2].body.u64(s.idle_ms);
+    }
+
+    sections[3].type  = Section::USERS;
+    sections[3].items = static_cast<uint32_t>(data.users.size());
+    for (const auto& urn : data.users) sections[3].body.str(urn);
+
+    sections[4].type  = Section::GROUPS;
+    sections[4].items = static_cast<uint32_t>(data.groups.size());
+    for (const auto& name : data.groups) sections[4].body.str(name);
+
+    // Tijelo: tabela sekcija pa sadržaj (offset od početka fajla)
+    Writer body;
+    uint64_t offset = kHeaderSize + sections.size() * 24;
+    for (const auto& s : sections) {
+        body.u32(static_cast<uint32_t>(s.type));
+        body.u32(s.items);
+        body.u64(offset);
+        body.u64(s.body.out.size());
+        offset += s.body.out.size();
+    }
+    for (const auto& s : sections) body.out.insert(body.out.end(), s.body.out.begin(), s.body.out.end());
+
+    uint8_t header[kHeaderSize] = {};
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    put32(header + 4, kVersion);
+    put32(header + 8, data.clean ? kFlagClean : 0);
+    put32(header + 12, static_cast<uint32_t>(sections.size()));
+    put64(header + 16, data.created_ms);
+    put64(header + 24, body.out.size());
+    put32(header + 32, Crc32::compute(body.out.data(), body.out.size()));
+    headerCrc(header);
+
+    // Novi fajl pored starog: pad tokom upisa ostavlja prethodni snimak netaknut
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        setError(error, "open " + tmp + ": " + std::strerror(errno));
+        return false;
+    }
+    bool ok = ::write(fd, header, kHeaderSize) == static_cast<ssize_t>(kHeaderSize);
+    for (size_t done = 0; ok && done < body.out.size(); ) {
+        const ssize_t n = ::write(fd, body.out.data() + done, body.out.size() - done);
+        if (n <= 0) ok = false;
+        else        done += static_cast<size_t>(n);
+    }
+    ok = ok && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        setError(error, "write " + tmp + ": " + std::strerror(errno));
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+StateSnapshot::ReadResult StateSnapshot::read(const std::string& path, Data& data, std::string* error) {
+    data = Data{};
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        const bool missing = errno == ENOENT;
+        setError(error, "open " + path + ": " + std::strerror(errno));
+        return missing ? ReadResult::MISSING : ReadResult::INVALID;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kHeaderSize) {
+        ::close(fd);
+        setError(error, "not a snapshot (too short): " + path);
+        return ReadResult::INVALID;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* m = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+        setError(error, std::string("mmap: ") + std::strerror(errno));
+        return ReadResult::INVALID;
+    }
+    const uint8_t* map = static_cast<const uint8_t*>(m);
+
+    auto fail = [&](const std::string& message) {
+        ::munmap(m, size);
+        setError(error, message + ": " + path);
+        return ReadResult::INVALID;
+    };
+    if (std::memcmp(map, kMagic, sizeof(kMagic)) != 0 || get32(map + 4) != kVersion ||
+        Crc32::compute(map, 36) != get32(map + 36)) {
+        return fail("not a snapshot (bad magic/version/header)");
+    }
+    const uint64_t body_size = get64(map + 24);
+    if (body_size != size - kHeaderSize || Crc32::compute(map + kHeaderSize, body_size) != get32(map + 32)) {
+        return fail("snapshot body corrupt");
+    }
+    data.clean      = (get32(map + 8) & kFlagClean) != 0;
+    data.created_ms = get64(map + 16);
+
+    const uint32_t count = get32(map + 12);
+    Reader table{map + kHeaderSize, map + size};
+    for (uint32_t i = 0; i < count && table.ok; ++i) {
+        const uint32_t type   = table.u32();
+        const uint32_t items  = table.u32();
+        const uint64_t offset = table.u64();
+        const uint64_t length = table.u64();
+        if (!table.ok || offset > size || length > size - offset) return fail("snapshot section out of bounds");
+
+        Reader r{map + offset, map + offset + length};
+        switch (static_cast<Section>(type)) {
+            case Section::META:
+                data.source = r.str();
+                // Snimak bez polja (starija verzija pisca): 0 -> inventar ide iz baze
+                if (r.ok && r.p != r.end) data.vehicles_max_rowid = static_cast<int64_t>(r.u64());
+                break;
+            case Section::VEHICLES:
+                for (uint32_t k = 0; k < items && r.ok; ++k) {
+                    Vehicle v{};
+                    v.uri             = r.str();
+                    v.type            = static_cast<VehicleType>(r.u8());
+                    v.route           = r.str();
+                    v.capacity        = static_cast<int>(r.u32());
+                    v.available_seats = static_cast<int>(r.u32());
+                    v.active          = r.u8() != 0;
+                    if (r.ok) data.vehicles.push_back(std::move(v));
+                }
+                break;
+            case Section::SESSIONS:
+                for (uint32_t k = 0; k < items && r.ok; ++k) {
+                    Session s;
+                    s.session_id = r.str();
+                    s.user_urn   = r.str();
+                    s.idle_ms    = r.u64();
+                    if (r.ok) data.sessions.push_back(std::move(s));
+                }
+                break;
+            case Section::USERS:
+                for (uint32_t k = 0; k < items && r.ok; ++k) {
+                    std::string urn = r.str();
+                    if (r.ok) data.users.push_back(std::move(urn));
+                }
+                break;
+            case Section::GROUPS:
+                for (uint32_t k = 0; k < items && r.ok; ++k) {
+                    std::string name = r.str();
+                    if (r.ok) data.groups.push_back(std::move(name));
+                }
+                break;
+            default:
+                break;      // nepoznata sekcija (novija verzija pisca): preskoči
+        }
+        if (!r.ok) return fail("snapshot section truncated");
+    }
+    ::munmap(m, size);
+    if (!table.ok) {
+        setError(error, "snapshot section table truncated: " + path);
+        return ReadResult::INVALID;
+    }
+    return ReadResult::OK;
+}
+
+bool StateSnapshot::markConsumed(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return false;
+    void* m = ::mmap(nullptr, kHeaderSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+    uint8_t* header = static_cast<uint8_t*>(m);
+    const bool valid = std::memcmp(header, kMagic, sizeof(kMagic)) == 0 &&
+                       Crc32::compute(header, 36) == get32(header + 36);
+    if (valid) {
+        put32(header + 8, get32(header + 8) & ~kFlagClean);
+        headerCrc(header);
+        ::msync(header, kHeaderSize, MS_SYNC);
+    }
+    ::munmap(m, kHeaderSize);
+    return valid;
+}
+
+} // namespace transport
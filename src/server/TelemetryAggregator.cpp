@@ -0,0 +1,334 @@
+#include "server/TelemetryAggregator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace transport {
+
+namespace {
+
+constexpr uint32_t kNoRoute = UINT32_MAX;
+
+metrics::Counter& sampleCounter(const char* result) {
+    return metrics::Registry::instance().counter(
+        "tp_telemetry_samples_total", std::string("result=\"") + result + "\"",
+        "Vehicle telemetry samples by ingestion result");
+}
+
+} // namespace
+
+TelemetryAggregator::TelemetryAggregator()
+    : accepted_counter_(&sampleCounter("accepted")),
+      dropped_counter_(&sampleCounter("dropped")),
+      unknown_counter_(&sampleCounter("unknown")),
+      stale_counter_(&sampleCounter("stale")) {}
+
+TelemetryAggregator::~TelemetryAggregator() {
+    stop();
+}
+
+void TelemetryAggregator::configure(const Options& options) {
+    if (running_) return;
+    options_ = options;
+}
+
+void TelemetryAggregator::start(Resolver resolver) {
+    if (running_.exchange(true)) return;
+    resolver_ = std::move(resolver);
+
+    size_t size = 16;
+    while (size < options_.queue_size) size <<= 1;
+    cells_ = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    mask_ = size - 1;
+    head_.store(0, std::memory_order_relaxed);
+    tail_ = 0;
+    {
+        std::lock_guard<std::mutex> lk(drain_mutex_);
+        finished_ = false;
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+void TelemetryAggregator::stop() {
+    if (!running_.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lk(wake_mutex_);
+    }
+    wake_cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+bool TelemetryAggregator::tryPush(TelemetrySample& sample) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& c = cells_[pos & mask_];
+        const size_t seq = c.seq.load(std::memory_order_acquire);
+        const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (dif == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                c.sample = std::move(sample);
+                c.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false;                // pun
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TelemetryAggregator::tryPop(TelemetrySample& out) {
+    Cell& c = cells_[tail_ & mask_];
+    const size_t seq = c.seq.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(tail_ + 1) < 0) return false;
+    out = std::move(c.sample);
+    c.seq.store(tail_ + mask_ + 1, std::memory_order_release);
+    ++tail_;
+    return true;
+}
+
+size_t TelemetryAggregator::submit(std::vector<TelemetrySample>& samples) {
+    size_t accepted = 0;
+    if (running_) {
+        for (auto& s : samples) {
+            if (!tryPush(s)) break;      // pun red: ostatak okvira se odbacuje
+            ++accepted;
+        }
+    }
+    const size_t dropped = samples.size() - accepted;
+    if (accepted) {
+        enqueued_.fetch_add(accepted, std::memory_order_release);
+        accepted_.fetch_add(accepted, std::memory_order_relaxed);
+        accepted_counter_->inc(accepted);
+        wake();
+    }
+    if (dropped) {
+        dropped_.fetch_add(dropped, std::memory_order_relaxed);
+        dropped_counter_->inc(dropped);
+    }
+    return accepted;
+}
+
+void TelemetryAggregator::refreshVehicles() {
+    refresh_.store(true, std::memory_order_release);
+    wake();
+}
+
+void TelemetryAggregator::wake() {
+    // Par s fence-om u run(): ili nit vidi novi uzorak/refresh prije spavanja, ili
+    // ovdje vidimo sleeping_ i budimo je pod wake_mutex_ (nema izgubljenog buđenja)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!sleeping_.load(std::memory_order_relaxed)) return;
+    {
+        std::lock_guard<std::mutex> lk(wake_mutex_);
+    }
+    wake_cv_.notify_one();
+}
+
+bool TelemetryAggregator::pendingWork() const {
+    const size_t seq = cells_[tail_ & mask_].seq.load(std::memory_order_acquire);
+    return seq == tail_ + 1 || refresh_.load(std::memory_order_acquire) || !running_;
+}
+
+void TelemetryAggregator::drain() {
+    const uint64_t target = enqueued_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lk(drain_mutex_);
+    // Izašla nit je obradila sve što je stiglo u red (stop() prazni red prije izlaska)
+    drain_cv_.wait(lk, [&] { return done_ >= target || finished_; });
+}
+
+void TelemetryAggregator::run() {
+    constexpr size_t kBatch = 512;
+    std::vector<TelemetrySample> batch;
+    batch.reserve(kBatch);
+
+    for (;;) {
+        TelemetrySample s;
+        while (batch.size() < kBatch && tryPop(s)) batch.push_back(std::move(s));
+        const bool refresh = refresh_.exchange(false, std::memory_order_acq_rel);
+
+        if (batch.empty() && !refresh) {
+            if (!running_) break;
+            // Proizvođači bude nit samo kad spava (v. wake())
+            std::unique_lock<std::mutex> lk(wake_mutex_);
+            sleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wake_cv_.wait(lk, [this] { return pendingWork(); });
+            sleeping_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        // Sat vozila može bježati naprijed: uzorak iz "budućnosti" bi zauvijek proglasio
+        // sve sljedeće zastarjelim, pa se vrijeme ograniči na sat servera + max_skew
+        const uint64_t max_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch() + options_.max_skew).count());
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (refresh) refreshLocked();
+            for (const auto& sample : batch) applyLocked(sample, max_ms);
+        }
+        {
+            std::lock_guard<std::mutex> lk(drain_mutex_);
+            done_ += batch.size();
+        }
+        drain_cv_.notify_all();
+        batch.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lk(drain_mutex_);
+        finished_ = true;
+    }
+    drain_cv_.notify_all();
+}
+
+uint32_t TelemetryAggregator::routeSlotLocked(const std::string& route) {
+    auto it = route_index_.find(route);
+    if (it != route_index_.end()) return it->second;
+    const auto r = static_cast<uint32_t>(r_name_.size());
+    route_index_.emplace(route, r);
+    r_name_.push_back(route);
+    r_vehicles_.push_back(0);
+    r_occupancy_.push_back(0);
+    r_capacity_.push_back(0);
+    r_avg_.push_back(0.0);
+    r_samples_.push_back(0);
+    r_last_ms_.push_back(0);
+    return r;
+}
+
+void TelemetryAggregator::detachLocked(uint32_t v) {
+    const uint32_t r = v_route_[v];
+    if (r == kNoRoute) return;
+    r_vehicles_[r]--;
+    r_capacity_[r]  -= v_capacity_[v];
+    r_occupancy_[r] -= v_occupancy_[v];
+    v_route_[v] = kNoRoute;
+}
+
+void TelemetryAggregator::attachLocked(uint32_t v, const VehicleInfo& info) {
+    const uint32_t r = routeSlotLocked(info.route);
+    v_route_[v]    = r;
+    v_capacity_[v] = info.capacity;
+    r_vehicles_[r]++;
+    r_capacity_[r]  += info.capacity;
+    r_occupancy_[r] += v_occupancy_[v];
+}
+
+void TelemetryAggregator::refreshLocked() {
+    for (uint32_t v = 0; v < v_uri_.size(); ++v) {
+        auto info = resolver_(v_uri_[v]);
+        if (!info) continue;            // uklonjeno vozilo zadržava zadnju rutu
+        if (v_route_[v] != kNoRoute && r_name_[v_route_[v]] == info->route && v_capacity_[v] == info->capacity) continue;
+        detachLocked(v);
+        attachLocked(v, *info);
+    }
+}
+
+void TelemetryAggregator::applyLocked(const TelemetrySample& s, uint64_t max_ms) {
+    uint32_t v = 0;
+    auto it = vehicle_index_.find(s.uri);
+    if (it != vehicle_index_.end()) {
+        v = it->second;
+    } else {
+        auto info = resolver_ ? resolver_(s.uri) : std::nullopt;
+        if (!info) {
+            ++unknown_;
+            unknown_counter_->inc();
+            return;
+        }
+        v = static_cast<uint32_t>(v_uri_.size());
+        vehicle_index_.emplace(s.uri, v);
+        v_uri_.push_back(s.uri);
+        v_route_.push_back(kNoRoute);
+        v_capacity_.push_back(0);
+        v_occupancy_.push_back(0);
+        v_lat_.push_back(0);
+        v_lon_.push_back(0);
+        v_sample_ms_.push_back(0);
+        v_samples_.push_back(0);
+        v_changed_.push_back(0);
+        attachLocked(v, *info);
+    }
+    // Uzorci istog vozila mogu stići preko dva edge čvora: stariji od zadnjeg se ne primjenjuje
+    const uint64_t ts = std::min(s.timestamp_ms, max_ms);
+    if (v_samples_[v] && ts < v_sample_ms_[v]) {
+        ++stale_;
+        stale_counter_->inc();
+        return;
+    }
+
+    const uint32_t r   = v_route_[v];
+    const int      occ = std::max(0, s.occupancy);
+    r_occupancy_[r] += occ - v_occupancy_[v];
+    v_occupancy_[v]  = occ;
+    v_lat_[v]        = s.lat_e6;
+    v_lon_[v]        = s.lon_e6;
+    v_sample_ms_[v]  = ts;
+    v_samples_[v]++;
+    v_changed_[v]    = 1;
+
+    // Eksponencijalni prosjek po vremenu: neravnomjerni uzorci imaju težinu po razmaku
+    const double window_ms = std::max<double>(1.0, static_cast<double>(options_.window.count()) * 1000.0);
+    const uint64_t dt = ts > r_last_ms_[r] ? ts - r_last_ms_[r] : 0;
+    const double a = r_samples_[r] == 0 ? 1.0 : 1.0 - std::exp(-static_cast<double>(dt) / window_ms);
+    r_avg_[r] += a * (static_cast<double>(r_occupancy_[r]) - r_avg_[r]);
+    r_samples_[r]++;
+    r_last_ms_[r] = std::max(r_last_ms_[r], ts);
+    ++processed_;
+}
+
+std::vector<VehicleTelemetry> TelemetryAggregator::takeChanged() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::vector<VehicleTelemetry> out;
+    for (uint32_t v = 0; v < v_changed_.size(); ++v) {
+        if (!v_changed_[v]) continue;
+        v_changed_[v] = 0;
+        out.push_back({v_uri_[v], v_occupancy_[v], v_lat_[v], v_lon_[v], v_sample_ms_[v], v_samples_[v]});
+    }
+    return out;
+}
+
+void TelemetryAggregator::markChanged(const std::vector<VehicleTelemetry>& rows) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& row : rows) {
+        auto it = vehicle_index_.find(row.uri);
+        if (it != vehicle_index_.end()) v_changed_[it->second] = 1;
+    }
+}
+
+std::vector<TelemetryAggregator::RouteAggregate> TelemetryAggregator::routes() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::vector<RouteAggregate> out;
+    out.reserve(r_name_.size());
+    for (uint32_t r = 0; r < r_name_.size(); ++r) {
+        out.push_back({r_name_[r], r_vehicles_[r], r_occupancy_[r], r_capacity_[r],
+                       r_avg_[r], r_samples_[r], r_last_ms_[r]});
+    }
+    return out;
+}
+
+std::optional<TelemetryAggregator::RouteAggregate> TelemetryAggregator::route(const std::string& name) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = route_index_.find(name);
+    if (it == route_index_.end()) return std::nullopt;
+    const uint32_t r = it->second;
+    return RouteAggregate{r_name_[r], r_vehicles_[r], r_occupancy_[r], r_capacity_[r],
+                          r_avg_[r], r_samples_[r], r_last_ms_[r]};
+}
+
+TelemetryAggregator::Stats TelemetryAggregator::getStats() const {
+    Stats s;
+    s.accepted = accepted_.load(std::memory_order_relaxed);
+    s.dropped  = dropped_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lk(mutex_);
+    s.processed       = processed_;
+    s.unknown_vehicle = unknown_;
+    s.stale           = stale_;
+    s.vehicles        = v_uri_.size();
+    s.routes          = r_name_.size();
+    return s;
+}
+
+} // namespace transport
@@ -2,37 +2,118 @@
 #include "common/Message.h"
 #include "common/Logger.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <future>
 #include <thread>
 #include <utility>
 
 namespace transport {
 
-VehicleServer::VehicleServer() : ServerBase("VehicleServer") {}
+namespace {
 
-bool VehicleServer::start(int port, const std::string& /*config_file*/) {
-    port_ = port;
+const std::string kStatusTopicPrefix = "status:";
+constexpr size_t  kMaxEdgeSessions   = 100000;
+constexpr size_t  kMaxTelemetryVehicles = 100000;
+
+// Noviji uzorak istog vozila zamjenjuje stariji
+void coalesce(std::unordered_map<std::string, TelemetrySample>& pending, TelemetrySample&& s) {
+    auto it = pending.find(s.uri);
+    if (it == pending.end()) {
+        std::string uri = s.uri;
+        pending.emplace(std::move(uri), std::move(s));
+    } else if (s.timestamp_ms >= it->second.timestamp_ms) {
+        it->second = std::move(s);
+    }
+}
 
-    // TLS server — identično kao kod CentralServer-a; ne diramo certifikate/ključeve
-    tls_server_ = std::make_unique<TLSServer>();
+} // namespace
 
-    // Connection callback: ne blokiramo Asio nit, već svaku sesiju obrađujemo u posebnoj niti
-    tls_server_->setConnectionCallback([this](std::unique_ptr<TLSSocket> client) {
-        std::thread([this, c = std::move(client)]() mutable {
-            handleClientMessage(std::move(c), nullptr);
-        }).detach();
-    });
+VehicleServer::VehicleServer() : ServerBase("VehicleServer") {}
+
+VehicleServer::~VehicleServer() { stop(); }
+
+bool VehicleServer::start(int port, const std::string& config_file) {
+    port_ = port;
+    if (!config_file.empty()) {
+        loadConfiguration(config_file);
+    }
+    configureEdge();
 
-    if (!tls_server_->start(port_, cert_file_, key_file_)) {
+    // TLS server — zajednička ServerBase infrastruktura (thread-per-connection ili worker pool)
+    running_ = true;
+    if (!startServer()) {
+        running_ = false;
         logError("VehicleServer: failed to start TLS server on port " + std::to_string(port_));
         return false;
     }
+    broadcast_.start();
+    timers_.schedule("telemetry_flush", telemetry_flush_, [this] { flushTelemetry(); });
+
+    // Veza prema centralnom serveru se (ponovo) uspostavlja u pozadini; do prvog
+    // snapshot-a lokalna čitanja vraćaju 503, a mijenjanja stanja čekaju vezu
+    if (!central_host_.empty() && central_port_ > 0) {
+        link_running_ = true;
+        link_thread_ = std::thread([this] { linkLoop(); });
+    } else {
+        logWarning("VehicleServer: no central server configured ([edge] central_host/central_port)");
+    }
 
-    running_ = true;
     start_time_ = std::chrono::system_clock::now();
-    logInfo("Vehicle Server started on port " + std::to_string(port_));
+    logInfo("Vehicle Server started on port " + std::to_string(port_) + " (edge for " +
+            (central_host_.empty() ? std::string("<none>") : central_host_ + ":" + std::to_string(central_port_)) +
+            ", routes=" + (routes_.empty() ? std::string("*") : routes_csv_) + ")");
     return true;
 }
 
+void VehicleServer::stop() {
+    if (!running_) return;
+    flushTelemetry();           // zadnji uzorci dok je veza još otvorena
+
+    // Prvo veza: zahtjevi u letu dobijaju 503, a RX nit izlazi iz receiveMessage
+    link_running_ = false;
+    {
+        std::lock_guard<std::mutex> lk(link_mutex_);
+        if (upstream_) upstream_->close();
+    }
+    if (link_thread_.joinable()) link_thread_.join();
+    failUpstream();
+
+    broadcast_.stop();
+    ServerBase::stop();
+}
+
+void VehicleServer::configureEdge() {
+    const auto& cfg = getConfig();
+    if (central_host_.empty()) central_host_ = cfg.getString("edge", "central_host", "");
+    if (central_port_ <= 0)    central_port_ = cfg.getInt("edge", "central_port", 0);
+    if (edge_urn_.empty())     edge_urn_     = cfg.getString("edge", "urn", "");
+    if (routes_csv_.empty())   routes_csv_   = cfg.getString("edge", "routes", "*");
+    routes_ = vehicle_status::parseRoutes(routes_csv_);
+    forward_timeout_    = std::chrono::milliseconds(std::max(1, cfg.getInt("edge", "forward_timeout_ms", 5000)));
+    reconnect_interval_ = std::chrono::milliseconds(std::max(10, cfg.getInt("edge", "reconnect_interval_ms", 1000)));
+    telemetry_flush_    = std::chrono::milliseconds(std::max(10, cfg.getInt("edge", "telemetry_flush_ms", 200)));
+    telemetry_batch_    = static_cast<size_t>(std::max(1, cfg.getInt("edge", "telemetry_batch", 1024)));
+}
+
+VehicleServer::EdgeStats VehicleServer::getEdgeStats() const {
+    EdgeStats s;
+    s.local_reads      = local_reads_.load();
+    s.local_rejects    = local_rejects_.load();
+    s.forwarded        = forwarded_.load();
+    s.forward_failures = forward_failures_.load();
+    s.link_connects    = link_connects_.load();
+    s.telemetry_received  = telemetry_received_.load();
+    s.telemetry_forwarded = telemetry_forwarded_.load();
+    s.telemetry_dropped   = telemetry_dropped_.load();
+    s.link_up          = link_up_.load();
+    std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+    s.replica_version  = replica_.version();
+    s.replica_vehicles = replica_.vehicles().size();
+    s.synced           = replica_.hasSnapshot();
+    return s;
+}
+
 void VehicleServer::handleClientMessage(std::unique_ptr<TLSSocket> client,
                                         std::unique_ptr<Message> /*message*/) {
     if (!client) return;
@@ -44,22 +125,431 @@ void VehicleServer::handleClientMessage(std::unique_ptr<TLSSocket> client,
             + ":" + std::to_string(client->getPeerPort()));
 
     // Ostavljen blokirajući tok
+    TrackedConnection tracked(*this, client.get());
     while (running_ && client) {
         auto received = client->receiveMessage();   // blokirajuće čitanje poruke kroz TLS
         if (!received) break;
-        logDebug("[VehicleServer] processing incoming message");
-        processMessage(std::move(received), client);
+        TP_LOG_DEBUG(logger_, "[VehicleServer] processing incoming message");
+        RequestScope scope(received->getSequenceId());
+        auto ticket = admitRequest(*received, client);
+        if (ticket) processMessage(std::move(received), client);
     }
 
     active_connections_--;
+    onClientDisconnected(client.get());
     logInfo("[VehicleServer] client disconnected");
 }
 
-void VehicleServer::processMessage(std::unique_ptr<Message> /*message*/,
-                                   std::unique_ptr<TLSSocket>& /*client*/) {
+void VehicleServer::onClientDisconnected(TLSSocket* client) {
+    broadcast_.unsubscribe(client);
+}
+
+void VehicleServer::processMessage(std::unique_ptr<Message> message,
+                                   std::unique_ptr<TLSSocket>& client) {
+    if (!message || !client) return;
 
-    logDebug("[VehicleServer] received message (stub)");
+    switch (message->getType()) {
+        case MessageType::CONNECT_REQUEST: {
+            // Payment uređaji dogovaraju kompaktno (V2) enkodiranje
+            const uint16_t version = acceptConnect(message->getString("protocol_version"), client);
+            logInfo("[VehicleServer] CONNECT_REQUEST from " + message->getString("client_id") +
+                    ", protocol v" + std::to_string(version));
+            return;
+        }
+        case MessageType::HEARTBEAT:
+            sendSuccessResponse(client, "alive");
+            return;
+        case MessageType::GET_VEHICLE_STATUS:
+            handleVehicleStatus(*message, client);
+            return;
+        case MessageType::VEHICLE_TELEMETRY:
+            handleTelemetry(*message, client);
+            return;
+        case MessageType::MCAST_RESYNC:
+            // Replay prozor data plane-a postoji samo na centralnom serveru
+            sendErrorResponse(client, "MCAST_RESYNC is not served by edge nodes", 501);
+            return;
+        case MessageType::RESERVE_SEAT:
+        case MessageType::PURCHASE_TICKET: {
+            std::string error;
+            const int status = validateLocally(*message, error);
+            if (status != 0) {
+                local_rejects_++;
+                sendErrorResponse(client, error, status);
+                return;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    forward(std::move(message), client);
 }
 
-} // namespace transport
+// ------------------------ Lokalna čitanja i provjere ------------------------
+
+void VehicleServer::handleVehicleStatus(const Message& request, std::unique_ptr<TLSSocket>& client) {
+    const std::string routes_csv = request.getString("routes");
+    const auto routes = vehicle_status::parseRoutes(routes_csv);
+    const uint64_t since = std::strtoull(request.getString("since_version").c_str(), nullptr, 10);
+
+    if (request.getBool("subscribe")) {
+        // Sesije izdaje centralni server; lokalno važe one čiji je AUTH prošao kroz ovaj čvor
+        bool known = false;
+        {
+            std::lock_guard<std::mutex> lk(sessions_mutex_);
+            known = edge_sessions_.count(request.getString("session_id")) > 0;
+        }
+        if (!known) {
+            sendErrorResponse(client, "Invalid or expired session", 401);
+            return;
+        }
+        if (routes.empty()) {
+            broadcast_.subscribe(client.get(), kStatusTopicPrefix + "*");
+        } else {
+            for (const auto& r : routes) broadcast_.subscribe(client.get(), kStatusTopicPrefix + r);
+        }
+    }
+
+    VehicleStatusView::Delta d;
+    {
+        std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+        if (!replica_.hasSnapshot()) {
+            lk.unlock();
+            sendErrorResponse(client, "Edge replica not synchronized with the central server", 503);
+            return;
+        }
+        d = replica_.since(routes, since);
+    }
+    local_reads_++;
+    auto resp = MessageFactory::createVehicleStatus(d.version, since, d.full, d.vehicles, d.removed);
+    resp->addString("routes", routes.empty() ? "*" : routes_csv);
+    sendResponse(client, std::move(resp));
+}
+
+int VehicleServer::validateLocally(const Message& request, std::string& error) const {
+    const bool purchase = request.getType() == MessageType::PURCHASE_TICKET;
+    const std::string uri   = request.getString("uri");
+    const std::string route = request.getString("route");
+    const auto vehicle_type = static_cast<VehicleType>(request.getInt("vehicle_type"));
+    const int needed = purchase ? std::max(1, request.hasKey("passengers") ? request.getInt("passengers") : 1) : 1;
+
+    // Ista pravila kao CentralServer::prepareReservation/preparePurchase
+    if (!purchase && request.getString("urn").empty()) {
+        error = "Missing user URN";
+        return 400;
+    }
+    if (purchase && request.getString("session_id").empty() && request.getString("urn").empty()) {
+        error = "Missing user identity (session_id or urn)";
+        return 400;
+    }
+
+    std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+    if (!replica_.hasSnapshot()) return 0;
+    const auto& vehicles = replica_.vehicles();
+
+    // Odluka samo za vozila/rute koje kopija pokriva; ostalo odlučuje centralni server
+    const bool all_routes = routes_.empty();
+    bool found = false, seats = false;
+    if (!uri.empty()) {
+        auto it = vehicles.find(uri);
+        if (it == vehicles.end()) {
+            if (!all_routes) return 0;
+        } else {
+            found = true;
+            seats = it->second.available >= needed;
+        }
+    }
+    if (!found) {
+        if (route.empty()) return 0;
+        if (!all_routes && std::find(routes_.begin(), routes_.end(), route) == routes_.end()) return 0;
+        for (const auto& [u, v] : vehicles) {
+            if (v.route != route || !v.active) continue;
+            if (purchase && v.type != vehicle_type) continue;
+            found = true;
+            seats = seats || v.available >= needed;
+        }
+    }
+    if (!found) {
+        error = "Vehicle/route not found";
+        return 404;
+    }
+    if (!seats) {
+        // Kopija zaostaje najviše jedan delta interval; oslobođena mjesta stižu delta porukom
+        error = purchase ? "Insufficient seats available" : "No available seats for this route/vehicle";
+        return 409;
+    }
+    return 0;
+}
 
+// ------------------------ Prosljeđivanje preko trajne veze ------------------------
+
+void VehicleServer::forward(std::unique_ptr<Message> request, std::unique_ptr<TLSSocket>& client) {
+    const uint32_t client_seq = request->getSequenceId();
+    const MessageType type    = request->getType();
+    // Span čvora obuhvata i čekanje na centralni; centralni nastavlja isti trace
+    tracing::Span span("vehicle.forward", tracing::extract(*request), static_cast<uint16_t>(type));
+    tracing::inject(*request);
+
+    auto promise = std::make_shared<std::promise<std::unique_ptr<Message>>>();
+    auto reply   = promise->get_future();
+    if (!sendUpstream(*request, [promise](std::unique_ptr<Message> m) { promise->set_value(std::move(m)); })) {
+        forward_failures_++;
+        sendErrorResponse(client, "Central server unavailable", 503);
+        return;
+    }
+    std::unique_ptr<Message> response;
+    if (reply.wait_for(forward_timeout_) == std::future_status::ready) {
+        response = reply.get();
+    } else {
+        // Odgovor koji zakasni nema kome; bez brisanja pending_ raste sa svakim isteklim rokom
+        std::lock_guard<std::mutex> lk(pending_mutex_);
+        pending_.erase(request->getSequenceId());
+    }
+    if (!response) {
+        forward_failures_++;
+        sendErrorResponse(client, "Central server unavailable", 503);
+        return;
+    }
+    forwarded_++;
+
+    // Odgovor nosi sequence_id klijenta, ne veze
+    response->setSequenceId(client_seq);
+    const bool authenticated = type == MessageType::AUTH_REQUEST &&
+                               response->getType() == MessageType::AUTH_RESPONSE && response->getBool("success");
+    if (authenticated) {
+        std::lock_guard<std::mutex> lk(sessions_mutex_);
+        if (edge_sessions_.size() >= kMaxEdgeSessions) edge_sessions_.clear();   // grubo ograničenje
+        edge_sessions_.insert(response->getString("token"));
+    }
+    sendResponse(client, std::move(response));
+    // Centralni server je pretplatio vezu; lokalni uređaj dobija update-e od ovog čvora
+    if (authenticated) broadcast_.subscribe(client.get());
+}
+
+void VehicleServer::handleTelemetry(const Message& request, std::unique_ptr<TLSSocket>& client) {
+    std::vector<TelemetrySample> samples;
+    if (!telemetry::decodeSamples(request.getBinary("samples"), samples)) {
+        sendErrorResponse(client, "Malformed telemetry samples", 400);
+        return;
+    }
+    size_t accepted = 0;
+    {
+        std::lock_guard<std::mutex> lk(telemetry_mutex_);
+        for (auto& s : samples) {
+            if (telemetry_pending_.size() >= kMaxTelemetryVehicles && !telemetry_pending_.count(s.uri)) continue;
+            coalesce(telemetry_pending_, std::move(s));
+            ++accepted;
+        }
+    }
+    telemetry_received_ += accepted;
+    telemetry_dropped_  += samples.size() - accepted;
+    // Vozilo ne čeka centralni server: uzorak je primljen kad je u baferu ovog čvora
+    sendResponse(client, MessageFactory::createSuccessResponse("", {
+        {"accepted", std::to_string(accepted)},
+        {"dropped", std::to_string(samples.size() - accepted)}}));
+}
+
+void VehicleServer::flushTelemetry() {
+    if (!link_up_) return;      // bafer čeka vezu (po vozilu samo najnoviji uzorak)
+    std::unordered_map<std::string, TelemetrySample> batch;
+    {
+        std::lock_guard<std::mutex> lk(telemetry_mutex_);
+        if (telemetry_pending_.empty()) return;
+        batch.swap(telemetry_pending_);
+    }
+
+    std::vector<TelemetrySample> chunk;
+    chunk.reserve(std::min(batch.size(), telemetry_batch_));
+    auto send = [this, &chunk] {
+        auto frame = MessageFactory::createVehicleTelemetry(chunk);
+        const uint64_t n = chunk.size();
+        const bool sent = sendUpstream(*frame, [this, n](std::unique_ptr<Message> m) {
+            if (m && m->getType() == MessageType::RESPONSE_SUCCESS) {
+                const uint64_t accepted = static_cast<uint64_t>(std::max(0, std::atoi(m->getString("accepted").c_str())));
+                telemetry_forwarded_ += std::min(accepted, n);
+                telemetry_dropped_   += n - std::min(accepted, n);
+            } else {
+                telemetry_dropped_ += n;
+            }
+        });
+        if (!sent) {
+            // Veza je pala usred slanja: uzorci se vraćaju u bafer (noviji u međuvremenu pobjeđuju)
+            std::lock_guard<std::mutex> lk(telemetry_mutex_);
+            for (auto& s : chunk) coalesce(telemetry_pending_, std::move(s));
+        }
+        chunk.clear();
+    };
+    for (auto& kv : batch) {
+        chunk.push_back(std::move(kv.second));
+        if (chunk.size() >= telemetry_batch_) send();
+    }
+    if (!chunk.empty()) send();
+}
+
+bool VehicleServer::sendUpstream(Message& request, UpstreamCallback callback) {
+    uint32_t seq = 0;
+    do { seq = ++next_upstream_seq_; } while (seq == 0);   // 0 = nezatražena poruka
+    request.setSequenceId(seq);
+    {
+        std::lock_guard<std::mutex> lk(pending_mutex_);
+        pending_[seq] = std::move(callback);
+    }
+    bool sent = false;
+    {
+        std::lock_guard<std::mutex> lk(upstream_write_mutex_);
+        if (link_up_ && upstream_) sent = upstream_->sendMessage(request);
+    }
+    if (!sent) {
+        std::lock_guard<std::mutex> lk(pending_mutex_);
+        pending_.erase(seq);
+    }
+    return sent;
+}
+
+void VehicleServer::failUpstream() {
+    std::unordered_map<uint32_t, UpstreamCallback> failed;
+    {
+        std::lock_guard<std::mutex> lk(pending_mutex_);
+        failed.swap(pending_);
+    }
+    for (auto& [seq, cb] : failed) cb(nullptr);
+}
+
+void VehicleServer::linkLoop() {
+    while (link_running_) {
+        if (!openLink()) {
+            const auto until = std::chrono::steady_clock::now() + reconnect_interval_;
+            while (link_running_ && std::chrono::steady_clock::now() < until) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            continue;
+        }
+        // Jedina nit koja čita sa veze; odgovori se uparuju po sequence_id
+        while (link_running_) {
+            auto m = upstream_->receiveMessage();
+            if (!m) break;
+            onUpstreamMessage(std::move(m));
+        }
+        closeLink();
+        failUpstream();
+        if (link_running_) logWarning("[VehicleServer] central link lost, reconnecting");
+    }
+}
+
+bool VehicleServer::openLink() {
+    auto sock = std::make_unique<TLSSocket>();
+    if (!sock->connect(central_host_, central_port_)) return false;
+    // RX petlja čita dok handler niti šalju (forward): obje strane kroz io nit socketa
+    if (!sock->enableFullDuplex()) {
+        logWarning("[VehicleServer] full-duplex mode unavailable: " + sock->getLastError());
+        return false;
+    }
+
+    // Servisni identitet: sesija za pretplatu na delte statusa
+    std::string session;
+    if (!edge_urn_.empty()) {
+        sock->sendMessage(*MessageFactory::createAuthRequest(edge_urn_));
+        for (int i = 0; i < 16; ++i) {
+            auto m = sock->receiveMessage();
+            if (!m) return false;
+            if (m->getType() != MessageType::AUTH_RESPONSE) continue;
+            if (m->getBool("success")) session = m->getString("token");
+            break;
+        }
+        if (session.empty()) logWarning("[VehicleServer] edge URN " + edge_urn_ + " rejected by central server");
+    }
+    if (session.empty()) {
+        logWarning("[VehicleServer] no edge session: replica is refreshed only on reconnect");
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(link_mutex_);
+        std::lock_guard<std::mutex> wlk(upstream_write_mutex_);
+        upstream_ = std::move(sock);
+        upstream_session_ = session;
+        link_up_ = true;
+    }
+    link_connects_++;
+
+    // Snapshot (ili delta od zadnje poznate verzije) + pretplata; odgovor obrađuje RX petlja
+    uint64_t since = 0;
+    {
+        std::shared_lock<std::shared_mutex> lk(replica_mutex_);
+        since = replica_.version();
+    }
+    auto status = MessageFactory::createGetVehicleStatus(routes_.empty() ? "*" : routes_csv_, since,
+                                                         !session.empty(), session);
+    sendUpstream(*status, [this](std::unique_ptr<Message> m) {
+        if (m) onUpstreamMessage(std::move(m));
+    });
+    logInfo("[VehicleServer] central link up (" + central_host_ + ":" + std::to_string(central_port_) + ")");
+    return true;
+}
+
+void VehicleServer::closeLink() {
+    std::lock_guard<std::mutex> lk(link_mutex_);
+    std::lock_guard<std::mutex> wlk(upstream_write_mutex_);
+    link_up_ = false;
+    if (upstream_) upstream_->close();
+    upstream_.reset();
+}
+
+void VehicleServer::onUpstreamMessage(std::unique_ptr<Message> message) {
+    if (message->getSequenceId() != 0) {
+        UpstreamCallback cb;
+        {
+            std::lock_guard<std::mutex> lk(pending_mutex_);
+            auto it = pending_.find(message->getSequenceId());
+            if (it != pending_.end()) {
+                cb = std::move(it->second);
+                pending_.erase(it);
+            }
+        }
+        if (cb) {
+            // Odgovor na status zahtjev veze se vraća ovamo sa sequence_id 0
+            if (message->getType() == MessageType::VEHICLE_STATUS) message->setSequenceId(0);
+            cb(std::move(message));
+        }
+        return;
+    }
+
+    switch (message->getType()) {
+        case MessageType::VEHICLE_STATUS: {
+            // Primijeni na kopiju, pa lokalnim temama pošalji ono što je novo od prije
+            std::vector<std::pair<std::string, VehicleStatusView::Delta>> deltas;
+            uint64_t before = 0;
+            {
+                std::unique_lock<std::shared_mutex> lk(replica_mutex_);
+                before = replica_.version();
+                if (!replica_.apply(*message)) return;
+                for (const auto& topic : broadcast_.activeTopics()) {
+                    if (topic.compare(0, kStatusTopicPrefix.size(), kStatusTopicPrefix) != 0) continue;
+                    const std::string route = topic.substr(kStatusTopicPrefix.size());
+                    std::vector<std::string> routes;
+                    if (route != "*") routes.push_back(route);
+                    auto d = replica_.since(routes, before);
+                    if (!d.full && d.vehicles.empty() && d.removed.empty()) continue;
+                    deltas.emplace_back(topic, std::move(d));
+                }
+            }
+            for (auto& [topic, d] : deltas) {
+                auto delta = MessageFactory::createVehicleStatus(d.version, d.full ? 0 : before, d.full,
+                                                                 d.vehicles, d.removed);
+                delta->addString("routes", topic.substr(kStatusTopicPrefix.size()));
+                broadcast_.publish(std::move(delta), "", topic);
+            }
+            return;
+        }
+        case MessageType::MULTICAST_UPDATE: {
+            // Jedan update sa veze -> svi lokalni uređaji (isti ključ kao na centralnom serveru)
+            std::string key = message->getString("update_type") + "|" + message->getString("vehicle_uri");
+            broadcast_.publish(std::move(message), std::move(key));
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+} // namespace transport
@@ -0,0 +1,230 @@
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/AdmissionControl.h"
+#include "server/CentralServer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::unique_ptr<Message> call(TLSSocket& sock, std::unique_ptr<Message> m) {
+    if (!sock.sendMessage(*m)) return nullptr;
+    auto reply = sock.receiveMessage();
+    while (reply && reply->getType() == MessageType::MULTICAST_UPDATE) reply = sock.receiveMessage();
+    return reply;
+}
+
+int main() {
+    using Clock    = AdmissionControl::Clock;
+    using Decision = AdmissionControl::Decision;
+
+    // -------- 1) Token bucket --------
+    {
+        AdmissionControl::Options opt;
+        opt.rate  = 10.0;    // token na 100 ms
+        opt.burst = 3.0;
+        AdmissionControl ac(opt);
+        const auto t0 = Clock::now();
+        Decision d;
+        uint32_t retry = 0;
+        int admitted = 0;
+        for (int i = 0; i < 3; ++i) {
+            if (ac.admit("user-a", d, retry, t0)) admitted++;
+        }
+        ok("burst admitted", admitted == 3);
+        ok("bucket empty -> rate limited", !ac.admit("user-a", d, retry, t0) && d == Decision::RATE_LIMITED);
+        ok("retry-after until next token", retry == 100);
+        ok("other client unaffected", static_cast<bool>(ac.admit("user-b", d, retry, t0)) && d == Decision::ADMIT);
+        ok("partial refill", !ac.admit("user-a", d, retry, t0 + std::chrono::milliseconds(50)) && retry == 50);
+        ok("refill after interval", static_cast<bool>(ac.admit("user-a", d, retry, t0 + std::chrono::milliseconds(110))));
+        ok("refill capped at burst", [&] {
+            const auto later = t0 + std::chrono::seconds(10);
+            int n = 0;
+            while (ac.admit("user-a", d, retry, later)) n++;
+            return n == 3;
+        }());
+        const auto s = ac.getStats();
+        ok("stats", s.admitted == 8 && s.rate_limited == 3 && s.tracked_keys == 2);
+    }
+
+    // -------- 2) Granica zahtjeva u obradi --------
+    {
+        AdmissionControl::Options opt;
+        opt.max_inflight   = 2;
+        opt.retry_after_ms = 250;
+        AdmissionControl ac(opt);
+        Decision d;
+        uint32_t retry = 0;
+        auto a = ac.admit("x", d, retry);
+        auto b = ac.admit("y", d, retry);
+        ok("inflight within limit", a && b && ac.getStats().inflight == 2);
+        auto c = ac.admit("z", d, retry);
+        ok("full -> overloaded", !c && d == Decision::OVERLOADED && retry == 250);
+        a.reset();
+        ok("ticket release frees slot", ac.getStats().inflight == 1);
+        auto moved = std::move(b);
+        ok("moved ticket keeps slot", moved && !b && ac.getStats().inflight == 1);
+        {
+            auto e = ac.admit("z", d, retry);
+            ok("admitted after release", e && ac.getStats().inflight == 2);
+        }
+        moved.reset();
+        ok("all released", ac.getStats().inflight == 0 && ac.getStats().overloaded == 1);
+        ok("bypass ticket", AdmissionControl::bypass() && ac.getStats().inflight == 0);
+    }
+
+    // -------- 3) Ograničena memorija bucket-a --------
+    {
+        AdmissionControl::Options opt;
+        opt.rate             = 1.0;
+        opt.burst            = 1.0;
+        opt.max_tracked_keys = 160;     // 10 po shardu
+        AdmissionControl ac(opt);
+        Decision d;
+        uint32_t retry = 0;
+        const auto t0 = Clock::now();
+        for (int i = 0; i < 10000; ++i) ac.admit("key-" + std::to_string(i), d, retry, t0);
+        ok("tracked keys bounded", ac.getStats().tracked_keys <= 160);
+        for (int i = 0; i < 10000; ++i) ac.admit("late-" + std::to_string(i), d, retry, t0 + std::chrono::seconds(5));
+        ok("idle buckets evicted", ac.getStats().tracked_keys <= 160 && ac.getStats().rate_limited == 0);
+
+        // Poplava novih ključeva ne vraća token aktivnom klijentu (izbacuje se najstariji)
+        const auto t1 = t0 + std::chrono::seconds(10);
+        ac.admit("hot", d, retry, t1);
+        int hot_admitted = 0;
+        for (int i = 0; i < 10000; ++i) {
+            ac.admit("flood-" + std::to_string(i), d, retry, t1);
+            if (i % 4 == 0 && ac.admit("hot", d, retry, t1)) ++hot_admitted;
+        }
+        ok("active bucket survives key flood", hot_admitted == 0 && ac.getStats().tracked_keys <= 160);
+    }
+
+    // -------- 4) CentralServer: limit konekcija i rate limit po URN-u --------
+    const std::string db_path = "test_admission.db";
+    std::remove(db_path.c_str());
+    {
+        const int port = pick_port();
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        central.setMaxConnections(1);
+        AdmissionControl::Options opt;
+        opt.rate           = 2.0;
+        opt.burst          = 4.0;
+        opt.retry_after_ms = 300;
+        central.setAdmission(opt);
+        ok("central start", central.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket first;
+        ok("first connection", first.connect("127.0.0.1", port));
+        const std::string urn = "7474747474747";
+        call(first, MessageFactory::createRegisterUser(urn));
+        auto auth = call(first, MessageFactory::createAuthRequest(urn));
+        ok("auth", auth && auth->getBool("success"));
+
+        TLSSocket second;
+        ok("second connection handshake", second.connect("127.0.0.1", port));
+        auto refused = second.receiveMessage();
+        ok("connection cap -> 503", refused && refused->getType() == MessageType::RESPONSE_ERROR &&
+                                    refused->getInt("error_code") == 503 && refused->getInt("retry_after_ms") == 300);
+        ok("refused connection closed", !second.receiveMessage());
+        ok("rejection counted", central.getTlsStats().rejected == 1);
+
+        // burst 4: register + auth su potrošili dva tokena
+        int limited = 0, retry_after = 0;
+        for (int i = 0; i < 4; ++i) {
+            auto r = MessageFactory::createReserveSeat(VehicleType::BUS, "R74");
+            r->addString("urn", urn);
+            auto reply = call(first, std::move(r));
+            if (reply && reply->getInt("error_code") == 429) {
+                limited++;
+                retry_after = reply->getInt("retry_after_ms");
+            }
+        }
+        ok("rate limited requests get 429", limited == 2);
+        ok("retry-after hint", retry_after > 0 && retry_after <= 500);
+        const auto stats = central.getSystemStatistics();
+        ok("admission stats", stats.at("admission_rate_limited") == 2 && stats.at("requests_inflight") == 0);
+
+        auto hb = call(first, MessageFactory::createHeartbeat());
+        ok("heartbeat not rate limited", !hb || hb->getInt("error_code") != 429);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        auto r = MessageFactory::createReserveSeat(VehicleType::BUS, "R74");
+        r->addString("urn", urn);
+        auto after = call(first, std::move(r));
+        ok("admitted after refill", after && after->getInt("error_code") != 429);
+
+        first.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        TLSSocket third;
+        ok("slot free after disconnect", third.connect("127.0.0.1", port));
+        auto reply = call(third, MessageFactory::createRegisterUser("7575757575757"));
+        ok("third connection served", reply && reply->getInt("error_code") != 503);
+        third.close();
+        central.stop();
+    }
+    std::remove(db_path.c_str());
+
+    // -------- 5) Talas paralelnih handshake-ova ne prelazi limit konekcija --------
+    for (const bool worker_pool : {false, true}) {
+        std::remove(db_path.c_str());
+        const int port = pick_port();
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        central.setMaxConnections(2);
+        if (worker_pool) central.setWorkerPool(true, 4);
+        ok("burst central start", central.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        constexpr int kClients = 12;
+        std::vector<std::unique_ptr<TLSSocket>> clients(kClients);
+        std::vector<int> code(kClients, -1);   // 0 = poslužen, inače error_code odgovora
+        std::vector<std::thread> th;
+        for (int i = 0; i < kClients; ++i) {
+            th.emplace_back([&, i] {
+                clients[i] = std::make_unique<TLSSocket>();
+                if (!clients[i]->connect("127.0.0.1", port)) return;
+                auto reply = call(*clients[i], MessageFactory::createHeartbeat());
+                if (reply) code[i] = reply->getType() == MessageType::RESPONSE_SUCCESS ? 0 : reply->getInt("error_code");
+            });
+        }
+        for (auto& t : th) t.join();
+        int served = 0, refused = 0;
+        for (int c : code) {
+            if (c == 0) served++;
+            else if (c == 503) refused++;
+        }
+        std::cout << (worker_pool ? "worker pool" : "thread per connection") << ": served=" << served
+                  << " refused=" << refused << std::endl;
+        ok("burst served within cap", served == 2);
+        ok("burst rest refused", refused == kClients - 2);
+        for (auto& c : clients) if (c) c->close();
+        central.stop();
+    }
+    std::remove(db_path.c_str());
+
+    std::cout << "All admission tests passed" << std::endl;
+    return 0;
+}
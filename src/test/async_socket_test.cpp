@@ -0,0 +1,117 @@
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "common/TLSServer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+int main() {
+    const int kMessages = 200;
+
+    // -------- 1) Async echo server (worker pool, bez ijedne dodatne niti) --------
+    std::mutex sessions_mutex;
+    std::vector<std::unique_ptr<TLSSocket>> sessions;
+    std::atomic<int> server_rx{0};
+
+    TLSServer server;
+    server.setExecutionMode(TLSServer::ExecutionMode::WORKER_POOL, 2);
+    server.setConnectionCallback([&](std::unique_ptr<TLSSocket> client) {
+        TLSSocket* raw = client.get();
+        raw->setMessageCallback([raw, &server_rx](std::unique_ptr<Message> msg) {
+            server_rx++;
+            auto resp = MessageFactory::createSuccessResponse(
+                "echo", {{"seq", msg->getString("seq")}});
+            raw->asyncSendMessage(*resp);
+        });
+        // Klijent je zatvorio vezu -> zatvori i server stranu (klijentov shutdown čeka odgovor)
+        raw->setErrorCallback([raw](const std::string&) { raw->close(); });
+        {
+            std::lock_guard<std::mutex> lk(sessions_mutex);
+            sessions.push_back(std::move(client));
+        }
+        raw->startAsyncReceive();
+    });
+
+    int port = pick_port();
+    ok("TLS server start (worker pool)", server.start(port, "certs/server.crt", "certs/server.key"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // -------- 2) Klijent: burst async slanja, async prijem --------
+    TLSSocket client;
+    ok("client connect", client.connect("127.0.0.1", port));
+
+    std::mutex rx_mutex;
+    std::condition_variable rx_cv;
+    std::vector<int> received;
+    bool in_order = true;
+
+    client.setMessageCallback([&](std::unique_ptr<Message> msg) {
+        std::lock_guard<std::mutex> lk(rx_mutex);
+        int seq = std::stoi(msg->getString("seq"));
+        if (seq != static_cast<int>(received.size())) in_order = false;
+        received.push_back(seq);
+        rx_cv.notify_all();
+    });
+    ok("client startAsyncReceive", client.startAsyncReceive());
+
+    std::atomic<int> write_acks{0};
+    bool all_queued = true;
+    for (int i = 0; i < kMessages; ++i) {
+        auto m = MessageFactory::createConnectRequest("async-client");
+        m->addString("seq", std::to_string(i));
+        all_queued &= client.asyncSendMessage(*m, [&write_acks](bool sent) {
+            if (sent) write_acks++;
+        });
+    }
+    ok("all frames queued", all_queued);
+
+    {
+        std::unique_lock<std::mutex> lk(rx_mutex);
+        rx_cv.wait_for(lk, std::chrono::seconds(10),
+                       [&]{ return received.size() == static_cast<size_t>(kMessages); });
+    }
+
+    ok("all echoes received", received.size() == static_cast<size_t>(kMessages));
+    ok("echoes in order", in_order);
+    ok("server received all", server_rx == kMessages);
+    ok("write callbacks fired", write_acks == kMessages);
+    ok("write queue drained", client.getPendingWrites() == 0);
+
+    // -------- 3) Gašenje --------
+    client.stopAsyncReceive();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    client.disconnect();
+    ok("client disconnected", !client.isConnected());
+
+    server.stop();
+    {
+        std::lock_guard<std::mutex> lk(sessions_mutex);
+        for (auto& s : sessions) s->close();
+        sessions.clear();
+    }
+
+    std::cout << "Async socket test passed.\n";
+    return 0;
+}
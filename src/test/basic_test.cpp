@@ -72,8 +72,59 @@ int main() {
     pay.payment_method="card"; pay.payment_date="now"; pay.successful=true;
     print_ok("record payment", db->recordPayment(pay));
 
+    // 11) Prepared-statement cache: ponovljeni upiti idu iz keša, rebind radi
+    auto before = db->getStatementCacheStats();
+    bool same = true;
+    for (int i = 0; i < 100; ++i) {
+        auto u = db->getUser(i % 2 ? a.urn : b.urn);
+        same &= u && u->name == (i % 2 ? "Ana" : "Boris");
+        auto veh = db->getVehicle("veh-001");
+        same &= veh && veh->route == "R1";
+    }
+    auto after = db->getStatementCacheStats();
+    std::cout << "stmt cache: hits=" << after.hits << " misses=" << after.misses
+              << " cached=" << after.cached << "\n";
+    print_ok("cached lookups return rebound rows", same);
+    print_ok("stmt cache hits", after.hits - before.hits >= 198);
+    print_ok("stmt cache no new misses", after.misses - before.misses <= 2);
+    print_ok("unknown user after cached hits", db->getUser("0000000000000") == nullptr);
+
+    db->clearStatementCache();
+    auto cleared = db->getStatementCacheStats();
+    print_ok("cache invalidated", cleared.cached == 0 && cleared.invalidations > after.invalidations);
+    print_ok("lookup after invalidation", db->getUser(a.urn) != nullptr);
+
     pool.returnConnection(db);
     pool.shutdown();
+
+    // 12) PRAGMA opcije iz [database] + ručni WAL checkpoint
+    DatabaseOptions opt;
+    opt.wal_mode           = true;
+    opt.synchronous        = "normal";
+    opt.cache_size         = 4000;
+    opt.mmap_size          = 1 << 20;
+    opt.temp_store         = "MEMORY";
+    opt.wal_autocheckpoint = 0;
+    Database wal;
+    print_ok("open with options", wal.initialize("test_wal.db", opt));
+    print_ok("journal_mode == wal", wal.getPragma("journal_mode") == "wal");
+    print_ok("synchronous == NORMAL(1)", wal.getPragma("synchronous") == "1");
+    print_ok("cache_size == 4000", wal.getPragma("cache_size") == "4000");
+    print_ok("temp_store == MEMORY(2)", wal.getPragma("temp_store") == "2");
+    print_ok("wal_autocheckpoint == 0", wal.getPragma("wal_autocheckpoint") == "0");
+
+    User w{"4444444444444","Wal",40,"",true,"hashW"};
+    wal.deleteUser(w.urn);
+    wal.registerUser(w);
+    int frames = -1, done = -1;
+    print_ok("passive checkpoint", wal.checkpoint(false, &frames, &done));
+    print_ok("checkpoint copied all frames", frames >= 0 && frames == done);
+    print_ok("truncate checkpoint", wal.checkpoint(true, &frames, &done) && frames == 0);
+
+    DatabaseOptions bad;
+    bad.synchronous = "SOMETIMES";
+    Database rejected;
+    print_ok("invalid synchronous rejected", !rejected.initialize("test_wal.db", bad));
     return 0;
 }
 
@@ -0,0 +1,181 @@
+#include "common/Database.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static bool request(TLSSocket& sock, const Message& m) {
+    if (!sock.sendMessage(m)) return false;
+    auto r = sock.receiveMessage();
+    return r && r->getType() == MessageType::RESPONSE_SUCCESS;
+}
+
+static std::unique_ptr<Message> purchase(const std::string& urn, int passengers) {
+    auto m = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "R_9", passengers);
+    m->addString("urn", urn);
+    return m;
+}
+
+// Validator nakon rada van mreže: kupovine, rezervacija i neispravne stavke u jednom okviru
+static std::unique_ptr<Message> offlineBatch(const std::string& urn) {
+    std::vector<std::unique_ptr<Message>> items;
+    items.push_back(purchase(urn, 2));
+    auto reserve = MessageFactory::createReserveSeat(VehicleType::BUS, "R_9");
+    reserve->addString("urn", urn);
+    items.push_back(std::move(reserve));
+    items.push_back(purchase(urn, 5));                                   // 409: nema mjesta
+    auto bad_session = purchase(urn, 1);
+    bad_session->addString("session_id", "no-such-session");
+    items.push_back(std::move(bad_session));                             // 401
+    items.push_back(MessageFactory::createHeartbeat());                  // 415
+    items.push_back(purchase(urn, 1));
+    return MessageFactory::createBatch(items);
+}
+
+static void setupVehicle(TLSSocket& c, const std::string& urn) {
+    ok("register vehicle", request(c, *MessageFactory::createRegisterDevice("bus://9", VehicleType::BUS)));
+    ok("route", request(c, *MessageFactory::createUpdateVehicle("bus://9", true, std::string("R_9"))));
+    ok("capacity", request(c, *MessageFactory::createUpdateCapacity("bus://9", 5, 5)));
+    request(c, *MessageFactory::createRegisterUser(urn));
+}
+
+int main() {
+    // -------- 1) Enkodiranje: stavke su uzastopni okviri --------
+    {
+        auto batch = offlineBatch("1111111111111");
+        const auto blob = batch->getBinary("items");
+        std::vector<MessageView> items;
+        ok("split items", splitBatchItems(blob.data(), blob.size(), items) && items.size() == 6 &&
+                          batch->getInt("count") == 6);
+        ok("item fields", items[0].getType() == MessageType::PURCHASE_TICKET && items[0].getInt("passengers") == 2 &&
+                          items[1].getType() == MessageType::RESERVE_SEAT &&
+                          items[3].getString("session_id") == "no-such-session");
+        ok("truncated items rejected", !splitBatchItems(blob.data(), blob.size() - 1, items));
+        ok("empty batch", splitBatchItems(nullptr, 0, items) && items.empty());
+    }
+
+    const std::string db_path = "test_batch_message.db";
+    const std::string jpath   = "test_batch_message.bin";
+    const std::string urn     = "9999999999999";
+    std::remove(db_path.c_str());
+    std::remove(jpath.c_str());
+
+    // -------- 2) CentralServer: jedan odgovor, jedna transakcija, jedan update po vozilu --------
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("server start", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket c, watcher;
+        ok("connect", c.connect("127.0.0.1", port) && watcher.connect("127.0.0.1", port));
+        setupVehicle(c, urn);
+        watcher.sendMessage(*MessageFactory::createAuthRequest(urn));
+        auto auth = watcher.receiveMessage();
+        ok("watcher auth", auth && auth->getBool("success"));
+        for (int i = 0; i < 100 && server.getBroadcastStats().subscribers == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        auto batch = offlineBatch(urn);
+        batch->setSequenceId(77);
+        c.sendMessage(*batch);
+        auto resp = c.receiveMessage();
+        ok("one batch response", resp && resp->getType() == MessageType::RESPONSE_SUCCESS &&
+                                 resp->getSequenceId() == 77);
+        std::cout << "  status=" << (resp ? resp->getString("status") : "") << "\n";
+        ok("per-item status", resp->getString("status") == "200,200,409,401,415,200" &&
+                              resp->getString("succeeded") == "3" && resp->getString("count") == "6");
+
+        // Coalesced: jedan ticket_purchased za bus://9 sa zbirom i zadnjim stanjem
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto upd = watcher.receiveMessage();
+        ok("coalesced update", upd && upd->getType() == MessageType::MULTICAST_UPDATE &&
+                               upd->getString("update_type") == "ticket_purchased" &&
+                               upd->getString("vehicle_uri") == "bus://9" &&
+                               upd->getString("passengers") == "3" && upd->getString("reserved") == "1" &&
+                               upd->getString("available_seats") == "1");
+        watcher.sendMessage(*MessageFactory::createHeartbeat());
+        auto next = watcher.receiveMessage();
+        ok("no further updates for the batch", next && next->getType() != MessageType::MULTICAST_UPDATE);
+
+        // Previše stavki -> cijeli BATCH odbijen
+        std::vector<std::unique_ptr<Message>> many;
+        for (int i = 0; i < 257; ++i) many.push_back(MessageFactory::createHeartbeat());
+        c.sendMessage(*MessageFactory::createBatch(many));
+        auto big = c.receiveMessage();
+        ok("oversized batch rejected", big && big->getType() == MessageType::RESPONSE_ERROR &&
+                                       big->getInt("error_code") == 413);
+
+        c.close();
+        watcher.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+    }
+    {
+        Database db;
+        ok("db open", db.initialize(db_path));
+        auto v = db.getVehicle("bus://9");
+        ok("tickets committed", db.getUserTickets(urn).size() == 3);
+        ok("seats flushed", v && v->available_seats == 1);
+    }
+
+    // -------- 3) Isti BATCH kroz dnevnik (jedan group commit) --------
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        server.setJournalPath(jpath);
+        ok("server start with journal", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket c;
+        ok("connect", c.connect("127.0.0.1", port));
+        ok("capacity reset", request(c, *MessageFactory::createUpdateCapacity("bus://9", 5, 5)));
+        const auto before = server.getJournalStats();
+        auto batch = offlineBatch(urn);
+        c.sendMessage(*batch);
+        auto resp = c.receiveMessage();
+        ok("journal batch status", resp && resp->getString("status") == "200,200,409,401,415,200");
+        const auto after = server.getJournalStats();
+        ok("accepted items journaled", after.appended == before.appended + 3 &&
+                                       after.durable_lsn == after.last_lsn);
+        c.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+    }
+    {
+        Database db;
+        ok("db reopen", db.initialize(db_path));
+        ok("journaled tickets applied", db.getUserTickets(urn).size() == 6);
+    }
+    std::remove(db_path.c_str());
+    std::remove(jpath.c_str());
+
+    std::cout << "Batch message test passed.\n";
+    return 0;
+}
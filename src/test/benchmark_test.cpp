@@ -1,198 +1,513 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <array>
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <mutex>
 #include <memory>
+#include <random>
+#include <algorithm>
+#include <unistd.h>
 #include "common/TLSSocket.h"
 #include "common/Message.h"
 #include "common/Logger.h"
+#include "common/LatencyHistogram.h"
 
 using namespace transport;
 
-class BenchmarkTester {
+// Open-loop generator opterećenja: zahtjevi stižu po Poissonovom procesu zadane
+// brzine bez obzira na to koliko server kasni, a latencija se mjeri od planiranog
+// (ne stvarnog) trenutka slanja -> zastoj servera se vidi u repu (bez coordinated omission).
+// Odgovori se uparuju po sequence_id (pipelining na istoj vezi).
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Op { RESERVE, PURCHASE, AUTH, PRICES, STATUS };
+
+struct OpInfo {
+    Op          op;
+    const char* name;       // ključ u --mix
+    MessageType type;       // ključ u rezultatima
+};
+
+const OpInfo kOps[] = {
+    {Op::RESERVE,  "reserve",  MessageType::RESERVE_SEAT},
+    {Op::PURCHASE, "purchase", MessageType::PURCHASE_TICKET},
+    {Op::AUTH,     "auth",     MessageType::AUTH_REQUEST},
+    {Op::PRICES,   "prices",   MessageType::GET_PRICES},
+    {Op::STATUS,   "status",   MessageType::GET_VEHICLE_STATUS},
+};
+constexpr size_t kOpCount = sizeof(kOps) / sizeof(kOps[0]);
+
+const char* typeName(MessageType t) {
+    switch (t) {
+        case MessageType::RESERVE_SEAT:       return "RESERVE_SEAT";
+        case MessageType::PURCHASE_TICKET:    return "PURCHASE_TICKET";
+        case MessageType::AUTH_REQUEST:       return "AUTH_REQUEST";
+        case MessageType::GET_PRICES:         return "GET_PRICES";
+        case MessageType::GET_VEHICLE_STATUS: return "GET_VEHICLE_STATUS";
+        default:                              return "OTHER";
+    }
+}
+
+struct Options {
+    std::string      server = "localhost";
+    int              port = 8080;
+    std::vector<int> connections{10};   // ramp: jedan korak po broju konekcija
+    int              duration = 10;     // sekundi po koraku
+    int              warmup = 1;        // sekundi na početku koraka koje se ne bilježe
+    double           rate = 1000.0;     // zahtjeva/s ukupno
+    int              threads = 2;       // niti koje šalju po rasporedu
+    int              routes = 10;
+    int              capacity = 1000000;
+    bool             setup = true;      // registruj vozila na BENCH_<i> rutama
+    size_t           max_inflight = 4096;   // po konekciji; preko toga zahtjev se broji kao "shed"
+    std::string      mix = "reserve=40,purchase=30,auth=10,prices=10,status=10";
+    std::string      json_path;
+    std::string      label;
+};
+
+struct TypeStats {
+    LatencyHistogram      latency;      // ns, od planiranog slanja do odgovora
+    std::atomic<uint64_t> ok{0};
+    std::atomic<uint64_t> errors{0};
+};
+
+struct StepResult {
+    int      connections{0};
+    double   target_rate{0};
+    double   seconds{0};
+    uint64_t sent{0};
+    uint64_t completed{0};
+    uint64_t shed{0};
+    uint64_t timeouts{0};
+    uint64_t connect_failures{0};
+    uint64_t broadcasts{0};
+    std::map<std::string, LatencyHistogram::Snapshot> latency;
+    std::map<std::string, std::pair<uint64_t, uint64_t>> outcome;   // ok, errors
+};
+
+class Connection {
 public:
-    BenchmarkTester() : total_messages_(0), successful_messages_(0), failed_messages_(0) {}
-    
-    void runBenchmark(const std::string& server, int port, int connections, int duration_seconds) {
-        std::cout << "=== Transport Protocol Benchmark Test ===" << std::endl;
-        std::cout << "Server: " << server << ":" << port << std::endl;
-        std::cout << "Concurrent connections: " << connections << std::endl;
-        std::cout << "Duration: " << duration_seconds << " seconds" << std::endl;
-        
-        auto logger = Logger::getLogger("BenchmarkTest");
-        logger->initialize("logs/benchmark_test.log", Logger::LogLevel::INFO);
-        
-        std::vector<std::thread> threads;
-        std::atomic<bool> stop_flag(false);
-        
-        auto start_time = std::chrono::high_resolution_clock::now();
-        
-        // Start benchmark threads
-        for (int i = 0; i < connections; ++i) {
-            threads.emplace_back([this, &server, port, &stop_flag, i]() {
-                runClientBenchmark(server, port, stop_flag, i);
-            });
-        }
-        
-        // Run for specified duration
-        std::this_thread::sleep_for(std::chrono::seconds(duration_seconds));
-        stop_flag = true;
-        
-        // Wait for all threads to complete
-        for (auto& thread : threads) {
-            thread.join();
+    Connection(int id, std::array<TypeStats, kOpCount>& stats, std::atomic<uint64_t>& broadcasts)
+        : id_(id), stats_(stats), broadcasts_(broadcasts) {}
+
+    ~Connection() { close(); }
+
+    // Sinhrono: CONNECT, registracija i prijava; zatim prelazak na async prijem
+    bool open(const Options& opt) {
+        if (!socket_.connect(opt.server, opt.port)) return false;
+        auto resp = call(MessageFactory::createConnectRequest("bench_" + std::to_string(id_)));
+        if (!resp || resp->getType() != MessageType::CONNECT_RESPONSE) return false;
+
+        // Jedinstven URN (13 cifara) po konekciji i pokretanju
+        std::ostringstream os;
+        os << "9" << std::setw(6) << std::setfill('0') << (getpid() % 1000000)
+           << std::setw(6) << std::setfill('0') << id_;
+        urn_ = os.str();
+        call(MessageFactory::createRegisterUser(urn_));
+        auto auth = call(MessageFactory::createAuthRequest(urn_));
+        if (!auth || !auth->getBool("success")) return false;
+        session_ = auth->getString("token");
+        route_   = "BENCH_" + std::to_string(id_ % std::max(1, opt.routes));
+
+        socket_.setMessageCallback([this](std::unique_ptr<Message> m) { onMessage(std::move(m)); });
+        socket_.setErrorCallback([this](const std::string&) { closed_ = true; });
+        return socket_.startAsyncReceive();
+    }
+
+    // false -> zahtjev nije poslan (previše u letu ili veza pala); counted=false za zagrijavanje
+    bool send(const OpInfo& op, Clock::time_point intended, bool counted, size_t max_inflight) {
+        if (closed_) return false;
+        auto msg = build(op.op);
+        uint32_t seq;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (inflight_.size() >= max_inflight) return false;
+            seq = ++next_seq_;
+            if (seq == 0) seq = ++next_seq_;   // 0 je rezervisan za nezatražene poruke
+            inflight_[seq] = {static_cast<size_t>(&op - kOps), intended, counted};
         }
-        
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-        
-        // Print results
-        printResults(elapsed.count());
+        msg->setSequenceId(seq);
+        return socket_.asyncSendMessage(*msg);
+    }
+
+    size_t inflight() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return inflight_.size();
+    }
+
+    size_t dropInflight() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        const size_t n = inflight_.size();
+        inflight_.clear();
+        return n;
+    }
+
+    void close() {
+        if (stopped_.exchange(true)) return;
+        socket_.stopAsyncReceive();
+        socket_.close();
     }
 
 private:
-    std::atomic<int> total_messages_;
-    std::atomic<int> successful_messages_;
-    std::atomic<int> failed_messages_;
-    
-    void runClientBenchmark(const std::string& server, int port, std::atomic<bool>& stop_flag, int client_id) {
-        try {
-            TLSSocket socket(TLSSocket::Mode::CLIENT);
-            
-            if (!socket.connect(server, port)) {
-                std::cerr << "Client " << client_id << " failed to connect" << std::endl;
-                return;
-            }
-            
-            // Send connect message
-            auto connect_msg = MessageFactory::createConnectRequest("benchmark_client_" + std::to_string(client_id));
-            if (!socket.sendMessage(*connect_msg)) {
-                return;
-            }
-            
-            auto response = socket.receiveMessage();
-            if (!response || response->getType() != MessageType::CONNECT_RESPONSE) {
-                return;
-            }
-            
-            // Benchmark loop
-            while (!stop_flag) {
-                // Send various message types
-                if (sendBenchmarkMessages(socket, client_id)) {
-                    successful_messages_++;
-                } else {
-                    failed_messages_++;
-                }
-                total_messages_++;
-                
-                // Small delay to prevent overwhelming the server
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    struct Pending {
+        size_t            op;
+        Clock::time_point intended;
+        bool              counted;
+    };
+
+    std::unique_ptr<Message> call(std::unique_ptr<Message> m) {
+        if (!socket_.sendMessage(*m)) return nullptr;
+        for (;;) {
+            auto r = socket_.receiveMessage();
+            if (!r || r->getType() != MessageType::MULTICAST_UPDATE) return r;
+        }
+    }
+
+    std::unique_ptr<Message> build(Op op) const {
+        std::unique_ptr<Message> m;
+        switch (op) {
+            case Op::RESERVE:
+                m = MessageFactory::createReserveSeat(VehicleType::BUS, route_);
+                m->addString("urn", urn_);
+                break;
+            case Op::PURCHASE:
+                m = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, route_);
+                m->addString("urn", urn_);
+                break;
+            case Op::AUTH:   m = MessageFactory::createAuthRequest(urn_); break;
+            case Op::PRICES: m = MessageFactory::createGetPrices(); break;
+            case Op::STATUS: m = MessageFactory::createGetVehicleStatus(route_); break;
+        }
+        m->addString("session_id", session_);
+        m->calculateChecksum();
+        return m;
+    }
+
+    void onMessage(std::unique_ptr<Message> m) {
+        const auto now = Clock::now();
+        if (m->getSequenceId() == 0) {   // MULTICAST_UPDATE
+            broadcasts_++;
+            return;
+        }
+        Pending p;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            auto it = inflight_.find(m->getSequenceId());
+            if (it == inflight_.end()) return;
+            p = it->second;
+            inflight_.erase(it);
+        }
+        if (!p.counted) return;
+        auto& s = stats_[p.op];
+        s.latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - p.intended).count()));
+        if (m->getType() == MessageType::RESPONSE_ERROR ||
+            (m->getType() == MessageType::AUTH_RESPONSE && !m->getBool("success"))) {
+            s.errors++;
+        } else {
+            s.ok++;
+        }
+    }
+
+    const int                         id_;
+    std::array<TypeStats, kOpCount>&  stats_;
+    std::atomic<uint64_t>&            broadcasts_;
+    TLSSocket                         socket_{TLSSocket::Mode::CLIENT};
+    std::string                       urn_, session_, route_;
+    mutable std::mutex                mutex_;
+    std::unordered_map<uint32_t, Pending> inflight_;
+    uint32_t                          next_seq_{0};
+    std::atomic<bool>                 closed_{false};
+    std::atomic<bool>                 stopped_{false};
+};
+
+class LoadGenerator {
+public:
+    explicit LoadGenerator(Options opt) : opt_(std::move(opt)) {}
+
+    bool parseMix() {
+        std::stringstream ss(opt_.mix);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            const auto eq = item.find('=');
+            const std::string name = item.substr(0, eq);
+            const double w = eq == std::string::npos ? 1.0 : std::atof(item.c_str() + eq + 1);
+            size_t i = 0;
+            while (i < kOpCount && name != kOps[i].name) ++i;
+            if (i == kOpCount || w < 0) {
+                std::cerr << "Unknown mix entry: " << item << std::endl;
+                return false;
             }
-            
-        } catch (const std::exception& e) {
-            std::cerr << "Client " << client_id << " exception: " << e.what() << std::endl;
-        }
-    }
-    
-    bool sendBenchmarkMessages(TLSSocket& socket, int client_id) {
-        try {
-            // Test different message types
-            std::vector<std::unique_ptr<Message>> test_messages;
-            
-            // User registration
-            test_messages.push_back(MessageFactory::createRegisterUser("1234567890" + std::to_string(client_id % 1000)));
-            
-            // Authentication
-            test_messages.push_back(MessageFactory::createAuthRequest("1234567890" + std::to_string(client_id % 1000)));
-            
-            // Seat reservation
-            test_messages.push_back(MessageFactory::createReserveSeat(VehicleType::BUS, "Route" + std::to_string(client_id % 10)));
-            
-            // Ticket purchase
-            test_messages.push_back(MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "Route" + std::to_string(client_id % 10)));
-            
-            for (auto& message : test_messages) {
-                if (!socket.sendMessage(*message)) {
-                    return false;
+            weights_[i] = w;
+        }
+        double total = 0;
+        for (double w : weights_) total += w;
+        return total > 0;
+    }
+
+    bool setupVehicles() {
+        TLSSocket admin;
+        if (!admin.connect(opt_.server, opt_.port)) return false;
+        auto call = [&](std::unique_ptr<Message> m) {
+            if (!admin.sendMessage(*m)) return false;
+            auto r = admin.receiveMessage();
+            return r != nullptr;
+        };
+        for (int i = 0; i < opt_.routes; ++i) {
+            const std::string uri = "bench://bus/" + std::to_string(i);
+            call(MessageFactory::createRegisterDevice(uri, VehicleType::BUS));
+            call(MessageFactory::createUpdateVehicle(uri, true, "BENCH_" + std::to_string(i)));
+            if (!call(MessageFactory::createUpdateCapacity(uri, opt_.capacity, opt_.capacity))) return false;
+        }
+        admin.close();
+        return true;
+    }
+
+    StepResult runStep(int connections) {
+        StepResult r;
+        r.connections = connections;
+        r.target_rate = opt_.rate;
+
+        std::array<TypeStats, kOpCount> stats;
+        std::atomic<uint64_t> broadcasts{0};
+        std::atomic<uint64_t> shed{0};
+
+        std::vector<std::unique_ptr<Connection>> conns;
+        for (int i = 0; i < connections; ++i) {
+            auto c = std::make_unique<Connection>(next_conn_id_++, stats, broadcasts);
+            if (c->open(opt_)) conns.push_back(std::move(c));
+            else               r.connect_failures++;
+        }
+        if (conns.empty()) return r;
+
+        const int threads = std::max(1, std::min<int>(opt_.threads, static_cast<int>(conns.size())));
+        const auto start       = Clock::now();
+        const auto record_from = start + std::chrono::seconds(opt_.warmup);
+        const auto end         = record_from + std::chrono::seconds(opt_.duration);
+        std::atomic<uint64_t> sent_recorded{0};
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937_64 rng(std::random_device{}() + static_cast<uint64_t>(t));
+                std::exponential_distribution<double> gap(opt_.rate / threads);
+                std::discrete_distribution<size_t> pick(weights_.begin(), weights_.end());
+                // Nit t vodi konekcije t, t + threads, ...
+                std::vector<Connection*> mine;
+                for (size_t i = static_cast<size_t>(t); i < conns.size(); i += static_cast<size_t>(threads)) {
+                    mine.push_back(conns[i].get());
                 }
-                
-                auto response = socket.receiveMessage();
-                if (!response) {
-                    return false;
+                size_t next_conn = 0;
+                auto due = start;
+                for (;;) {
+                    due += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap(rng)));
+                    if (due >= end) break;
+                    std::this_thread::sleep_until(due);   // kasnimo li, šaljemo odmah (raspored se ne pomjera)
+                    auto& conn = *mine[next_conn];
+                    next_conn = (next_conn + 1) % mine.size();
+                    const bool counted = due >= record_from;
+                    if (conn.send(kOps[pick(rng)], due, counted, opt_.max_inflight)) {
+                        if (counted) sent_recorded++;
+                    } else if (counted) {
+                        shed++;
+                    }
                 }
+            });
+        }
+        for (auto& w : workers) w.join();
+
+        // Odgovori na zadnje zahtjeve: najviše 5 s, ostatak su timeouts
+        const auto drain_until = Clock::now() + std::chrono::seconds(5);
+        auto pending = [&] {
+            size_t n = 0;
+            for (auto& c : conns) n += c->inflight();
+            return n;
+        };
+        while (pending() > 0 && Clock::now() < drain_until) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        for (auto& c : conns) r.timeouts += c->dropInflight();
+        for (auto& c : conns) c->close();
+
+        r.seconds    = static_cast<double>(opt_.duration);
+        r.sent       = sent_recorded;
+        r.shed       = shed;
+        r.broadcasts = broadcasts;
+        for (size_t i = 0; i < kOpCount; ++i) {
+            const auto snap = stats[i].latency.snapshot();
+            if (snap.count == 0 && stats[i].errors == 0) continue;
+            const std::string name = typeName(kOps[i].type);
+            r.latency[name] = snap;
+            r.outcome[name] = {stats[i].ok.load(), stats[i].errors.load()};
+            r.completed    += snap.count;
+        }
+        return r;
+    }
+
+    int run() {
+        if (!parseMix()) return 1;
+        std::cout << "=== Transport Protocol Load Generator ===" << std::endl;
+        std::cout << "Server: " << opt_.server << ":" << opt_.port << ", rate " << opt_.rate
+                  << " req/s, mix " << opt_.mix << std::endl;
+
+        if (opt_.setup && !setupVehicles()) {
+            std::cerr << "Vehicle setup failed (server unreachable?)" << std::endl;
+            return 1;
+        }
+        std::vector<StepResult> steps;
+        for (int c : opt_.connections) {
+            std::cout << "\n--- " << c << " connections, " << opt_.duration << " s ---" << std::endl;
+            steps.push_back(runStep(c));
+            printStep(steps.back());
+        }
+        if (!opt_.json_path.empty()) {
+            if (opt_.json_path == "-") {
+                writeJson(std::cout, steps);
+            } else {
+                std::ofstream f(opt_.json_path);
+                writeJson(f, steps);
+                std::cout << "\nResults written to " << opt_.json_path << std::endl;
             }
-            
-            return true;
-            
-        } catch (const std::exception& e) {
-            return false;
-        }
-    }
-    
-    void printResults(long long elapsed_ms) {
-        std::cout << "\n=== Benchmark Results ===" << std::endl;
-        std::cout << "Total messages sent: " << total_messages_.load() << std::endl;
-        std::cout << "Successful messages: " << successful_messages_.load() << std::endl;
-        std::cout << "Failed messages: " << failed_messages_.load() << std::endl;
-        std::cout << "Success rate: " << (100.0 * successful_messages_.load() / total_messages_.load()) << "%" << std::endl;
-        std::cout << "Elapsed time: " << elapsed_ms << " ms" << std::endl;
-        std::cout << "Messages per second: " << (1000.0 * total_messages_.load() / elapsed_ms) << std::endl;
-        std::cout << "Average response time: " << (elapsed_ms / static_cast<double>(total_messages_.load())) << " ms" << std::endl;
+        }
+        for (const auto& s : steps) {
+            if (s.connect_failures == static_cast<uint64_t>(s.connections)) return 1;
+        }
+        return 0;
     }
+
+private:
+    static double us(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+    static void printStep(const StepResult& s) {
+        std::cout << "Sent: " << s.sent << ", completed: " << s.completed << ", shed: " << s.shed
+                  << ", timeouts: " << s.timeouts << ", connect failures: " << s.connect_failures
+                  << ", broadcasts: " << s.broadcasts << std::endl;
+        std::cout << "Achieved: " << std::fixed << std::setprecision(1)
+                  << (s.seconds > 0 ? s.completed / s.seconds : 0.0) << " req/s (target " << s.target_rate << ")"
+                  << std::endl;
+        std::cout << std::left << std::setw(20) << "type" << std::right << std::setw(9) << "count"
+                  << std::setw(8) << "errors" << std::setw(11) << "p50 us" << std::setw(11) << "p99 us"
+                  << std::setw(11) << "p999 us" << std::setw(11) << "max us" << std::endl;
+        for (const auto& kv : s.latency) {
+            const auto& h = kv.second;
+            std::cout << std::left << std::setw(20) << kv.first << std::right << std::setw(9) << h.count
+                      << std::setw(8) << s.outcome.at(kv.first).second << std::setprecision(1)
+                      << std::setw(11) << us(h.percentile(0.50)) << std::setw(11) << us(h.percentile(0.99))
+                      << std::setw(11) << us(h.percentile(0.999)) << std::setw(11) << us(h.max) << std::endl;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    void writeJson(std::ostream& out, const std::vector<StepResult>& steps) const {
+        out << std::fixed << std::setprecision(1);
+        out << "{\n  \"server\": \"" << opt_.server << ":" << opt_.port << "\",\n";
+        if (!opt_.label.empty()) out << "  \"label\": \"" << opt_.label << "\",\n";
+        out << "  \"mix\": \"" << opt_.mix << "\",\n  \"target_rate\": " << opt_.rate
+            << ",\n  \"duration_s\": " << opt_.duration << ",\n  \"steps\": [";
+        for (size_t i = 0; i < steps.size(); ++i) {
+            const auto& s = steps[i];
+            out << (i ? "," : "") << "\n    {\"connections\": " << s.connections
+                << ", \"sent\": " << s.sent << ", \"completed\": " << s.completed
+                << ", \"shed\": " << s.shed << ", \"timeouts\": " << s.timeouts
+                << ", \"connect_failures\": " << s.connect_failures
+                << ", \"achieved_rate\": " << (s.seconds > 0 ? s.completed / s.seconds : 0.0)
+                << ",\n     \"types\": {";
+            bool first = true;
+            for (const auto& kv : s.latency) {
+                const auto& h = kv.second;
+                out << (first ? "" : ",") << "\n       \"" << kv.first << "\": {\"count\": " << h.count
+                    << ", \"errors\": " << s.outcome.at(kv.first).second
+                    << ", \"mean_us\": " << us(static_cast<uint64_t>(h.mean()))
+                    << ", \"p50_us\": " << us(h.percentile(0.50)) << ", \"p90_us\": " << us(h.percentile(0.90))
+                    << ", \"p99_us\": " << us(h.percentile(0.99)) << ", \"p999_us\": " << us(h.percentile(0.999))
+                    << ", \"max_us\": " << us(h.max) << "}";
+                first = false;
+            }
+            out << "\n     }}";
+        }
+        out << "\n  ]\n}\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+    Options                        opt_;
+    std::array<double, kOpCount>   weights_{};
+    int                            next_conn_id_{0};
 };
 
+std::vector<int> parseList(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(std::max(1, std::stoi(item)));
+    }
+    return out;
+}
+
+} // namespace
+
 void printUsage(const char* program_name) {
     std::cout << "Usage: " << program_name << " [options]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  --server <address>       Server address (default: localhost)" << std::endl;
     std::cout << "  --port <port>            Server port (default: 8080)" << std::endl;
-    std::cout << "  --connections <num>      Number of concurrent connections (default: 10)" << std::endl;
-    std::cout << "  --duration <seconds>     Test duration in seconds (default: 60)" << std::endl;
+    std::cout << "  --connections <n[,n..]>  Connections per ramp step (default: 10)" << std::endl;
+    std::cout << "  --duration <seconds>     Measured seconds per step (default: 10)" << std::endl;
+    std::cout << "  --warmup <seconds>       Unrecorded seconds before each step (default: 1)" << std::endl;
+    std::cout << "  --rate <req/s>           Open-loop arrival rate, all connections (default: 1000)" << std::endl;
+    std::cout << "  --mix <op=w,...>         reserve, purchase, auth, prices, status" << std::endl;
+    std::cout << "                           (default: reserve=40,purchase=30,auth=10,prices=10,status=10)" << std::endl;
+    std::cout << "  --threads <num>          Sender threads (default: 2)" << std::endl;
+    std::cout << "  --routes <num>           Benchmark routes/vehicles to set up (default: 10)" << std::endl;
+    std::cout << "  --no-setup               Do not register benchmark vehicles" << std::endl;
+    std::cout << "  --max-inflight <num>     Per-connection limit before requests are shed (default: 4096)" << std::endl;
+    std::cout << "  --json <file|->          Write JSON results (for comparing builds)" << std::endl;
+    std::cout << "  --label <text>           Build label stored in the JSON results" << std::endl;
     std::cout << "  -h, --help               Show this help message" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
-    // Default configuration
-    std::string server = "localhost";
-    int port = 8080;
-    int connections = 10;
-    int duration = 60;
+    Options opt;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
-        
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+
         if (arg == "-h" || arg == "--help") {
             printUsage(argv[0]);
             return 0;
         }
-        else if (arg == "--server") {
-            if (i + 1 < argc) {
-                server = argv[++i];
-            }
-        }
-        else if (arg == "--port") {
-            if (i + 1 < argc) {
-                port = std::stoi(argv[++i]);
-            }
-        }
-        else if (arg == "--connections") {
-            if (i + 1 < argc) {
-                connections = std::stoi(argv[++i]);
-            }
-        }
-        else if (arg == "--duration") {
-            if (i + 1 < argc) {
-                duration = std::stoi(argv[++i]);
-            }
-        }
+        else if (arg == "--server")       opt.server = next();
+        else if (arg == "--port")         opt.port = std::stoi(next());
+        else if (arg == "--connections")  opt.connections = parseList(next());
+        else if (arg == "--duration")     opt.duration = std::max(1, std::stoi(next()));
+        else if (arg == "--warmup")       opt.warmup = std::max(0, std::stoi(next()));
+        else if (arg == "--rate")         opt.rate = std::max(1.0, std::stod(next()));
+        else if (arg == "--mix")          opt.mix = next();
+        else if (arg == "--threads")      opt.threads = std::max(1, std::stoi(next()));
+        else if (arg == "--routes")       opt.routes = std::max(1, std::stoi(next()));
+        else if (arg == "--no-setup")     opt.setup = false;
+        else if (arg == "--max-inflight") opt.max_inflight = static_cast<size_t>(std::max(1, std::stoi(next())));
+        else if (arg == "--json")         opt.json_path = next();
+        else if (arg == "--label")        opt.label = next();
     }
+    if (opt.connections.empty()) opt.connections = {10};
 
     try {
-        BenchmarkTester tester;
-        tester.runBenchmark(server, port, connections, duration);
-        return 0;
+        auto logger = Logger::getLogger("BenchmarkTest");
+        logger->initialize("logs/benchmark_test.log", Logger::LogLevel::INFO);
+
+        LoadGenerator generator(opt);
+        return generator.run();
     } catch (const std::exception& e) {
         std::cerr << "Benchmark test failed with exception: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,377 @@
+#include "server/BroadcastHub.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "common/TLSServer.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::unique_ptr<Message> update(const std::string& uri, int seq) {
+    return MessageFactory::createMulticastUpdate("seat_reserved", {
+        {"vehicle_uri", uri}, {"seq", std::to_string(seq)}});
+}
+
+int main() {
+    // Server strana: čuvamo prihvaćene sockete, hub piše direktno u njih
+    std::mutex accepted_mutex;
+    std::condition_variable accepted_cv;
+    std::vector<std::unique_ptr<TLSSocket>> accepted;
+
+    TLSServer server;
+    server.setConnectionCallback([&](std::unique_ptr<TLSSocket> client) {
+        std::lock_guard<std::mutex> lk(accepted_mutex);
+        accepted.push_back(std::move(client));
+        accepted_cv.notify_all();
+    });
+    const int port = pick_port();
+    ok("TLS server start", server.start(port, "certs/server.crt", "certs/server.key"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const int kClients = 3;
+    std::vector<std::unique_ptr<TLSSocket>> clients;
+    for (int i = 0; i < kClients; ++i) {
+        clients.push_back(std::make_unique<TLSSocket>());
+        ok("client connect", clients.back()->connect("127.0.0.1", port));
+    }
+    // v2 klijent: hub gradi poseban okvir za tu verziju
+    {
+        std::unique_lock<std::mutex> lk(accepted_mutex);
+        accepted_cv.wait_for(lk, std::chrono::seconds(5), [&]{ return accepted.size() == kClients; });
+    }
+    ok("all connections accepted", accepted.size() == kClients);
+    accepted[0]->setProtocolVersion(PROTOCOL_V2);
+
+    // -------- 1) Fan-out svim pretplatnicima, redoslijed očuvan --------
+    {
+        BroadcastHub hub;
+        for (auto& s : accepted) hub.subscribe(s.get());
+        hub.subscribe(accepted[0].get());             // dupla prijava se ignoriše
+        ok("subscribers", hub.subscriberCount() == kClients);
+        hub.start();
+
+        const int kUpdates = 20;
+        for (int i = 0; i < kUpdates; ++i) hub.publish(update("V" + std::to_string(i), i), "");
+        ok("hub drained", hub.waitIdle(std::chrono::seconds(5)));
+
+        bool all_ok = true;
+        for (auto& c : clients) {
+            for (int i = 0; i < kUpdates; ++i) {
+                auto m = c->receiveMessage();
+                all_ok &= m && m->getType() == MessageType::MULTICAST_UPDATE &&
+                          m->getString("seq") == std::to_string(i);
+            }
+        }
+        ok("every client got every update in order", all_ok);
+        const auto st = hub.getStats();
+        ok("stats delivered", st.published == kUpdates && st.delivered == kUpdates * kClients);
+        hub.stop();
+    }
+
+    // -------- 2) Spajanje po ključu dok ažuriranje čeka u redu --------
+    {
+        BroadcastHub hub;
+        hub.subscribe(accepted[1].get());
+        for (int i = 0; i < 10; ++i) hub.publish(update("BUS-1", i), "seat_reserved|BUS-1");
+        hub.publish(update("BUS-2", 100), "seat_reserved|BUS-2");
+        hub.start();                                  // tek sad počinje slanje
+        ok("coalesced drained", hub.waitIdle(std::chrono::seconds(5)));
+
+        auto a = clients[1]->receiveMessage();
+        auto b = clients[1]->receiveMessage();
+        ok("latest BUS-1 state first", a && a->getString("vehicle_uri") == "BUS-1" && a->getString("seq") == "9");
+        ok("BUS-2 after it", b && b->getString("vehicle_uri") == "BUS-2");
+        const auto st = hub.getStats();
+        ok("coalesced count", st.coalesced == 9 && st.delivered == 2);
+        hub.stop();
+    }
+
+    // -------- 3) Spor pretplatnik: pun red -> izbačen, ostali nastavljaju --------
+    {
+        BroadcastHub::Options opt;
+        opt.queue_limit = 4;
+        BroadcastHub hub(opt);
+        hub.subscribe(accepted[2].get());
+        for (int i = 0; i < 10; ++i) hub.publish(update("T-" + std::to_string(i), i), "");
+        auto st = hub.getStats();
+        ok("slow subscriber dropped", st.dropped_subscribers == 1 && hub.subscriberCount() == 0);
+
+        // Nova prijava istog socketa poslije izbacivanja radi normalno
+        hub.subscribe(accepted[2].get());
+        hub.start();
+        hub.publish(update("T-x", 42), "");
+        ok("resubscribed drained", hub.waitIdle(std::chrono::seconds(5)));
+        auto m = clients[2]->receiveMessage();
+        ok("resubscribed receives", m && m->getString("seq") == "42");
+
+        // Nakon unsubscribe hub više ne šalje na socket
+        hub.unsubscribe(accepted[2].get());
+        hub.publish(update("T-y", 43), "");
+        ok("unsubscribed", hub.subscriberCount() == 0 && hub.waitIdle(std::chrono::seconds(1)));
+        ok("nothing delivered after unsubscribe", hub.getStats().delivered == 1);
+        hub.stop();
+    }
+
+    // -------- 4) Teme: objava ide samo pretplatnicima te teme --------
+    {
+        BroadcastHub hub;
+        hub.subscribe(accepted[0].get(), "status:A");
+        hub.subscribe(accepted[1].get(), "status:B");
+        hub.subscribe(accepted[1].get());             // ista veza i na MULTICAST_UPDATE
+        ok("active topics", hub.activeTopics() == std::vector<std::string>({"", "status:A", "status:B"}));
+        hub.start();
+        hub.publish(update("A-1", 1), "", "status:A");
+        hub.publish(update("B-1", 2), "", "status:B");
+        hub.publish(update("ALL", 3), "");
+        ok("topics drained", hub.waitIdle(std::chrono::seconds(5)));
+
+        auto a0 = clients[0]->receiveMessage();
+        auto b0 = clients[1]->receiveMessage();
+        auto b1 = clients[1]->receiveMessage();
+        ok("topic A delivered only to A", a0 && a0->getString("seq") == "1");
+        ok("topic B and default to B", b0 && b0->getString("seq") == "2" && b1 && b1->getString("seq") == "3");
+        ok("topic delivery count", hub.getStats().delivered == 3);
+        hub.stop();
+    }
+
+    // -------- 5) Ažuriranja na čekanju idu jednim upisom (jedan TLS record) --------
+    {
+        BroadcastHub hub;
+        hub.subscribe(accepted[1].get());
+        const int kQueued = 20;
+        for (int i = 0; i < kQueued; ++i) hub.publish(update("Q-" + std::to_string(i), i), "");
+        const uint64_t writes_before = accepted[1]->getWriteCalls();
+        hub.start();
+        ok("batched drained", hub.waitIdle(std::chrono::seconds(5)));
+
+        bool in_order = true;
+        for (int i = 0; i < kQueued; ++i) {
+            auto m = clients[1]->receiveMessage();
+            in_order &= m && m->getString("seq") == std::to_string(i);
+        }
+        ok("batched updates arrive in order", in_order);
+        const auto st = hub.getStats();
+        ok("one send for the whole queue", st.delivered == kQueued && st.send_batches == 1);
+        ok("one TLS write for the batch", accepted[1]->getWriteCalls() - writes_before == 1);
+        hub.stop();
+    }
+
+    // -------- 6) Gather upis: frejmovi preko granice record-a --------
+    // Sync gather je klijentski put; server-side socket okvire uvijek stavlja u red upisa
+    {
+        auto small = update("G-1", 1)->serialize();
+        Message big_msg(MessageType::MULTICAST_UPDATE);
+        big_msg.addString("blob", std::string(TLSSocket::kMaxRecordPayload + 100, 'b'));
+        big_msg.calculateChecksum();
+        auto big = big_msg.serialize();
+        const boost::asio::const_buffer frames[] = {
+            boost::asio::buffer(small), boost::asio::buffer(small), boost::asio::buffer(big),
+            boost::asio::buffer(small)};
+        const uint64_t writes_before = clients[0]->getWriteCalls();
+        ok("sendFrames", clients[0]->sendFrames(frames, 4));
+        ok("small frames packed, big one direct", clients[0]->getWriteCalls() - writes_before == 3);
+        int received = 0;
+        for (int i = 0; i < 4; ++i) {
+            auto m = accepted[0]->receiveMessage();
+            if (m && (i == 2 ? m->getString("blob").size() == TLSSocket::kMaxRecordPayload + 100
+                             : m->getString("seq") == "1")) ++received;
+        }
+        ok("gathered frames received intact", received == 4);
+    }
+
+    // -------- 7) Async sesija (WORKER_POOL): broadcast dok čitanje čeka na strand-u --------
+    {
+        std::mutex async_mutex;
+        std::condition_variable async_cv;
+        std::unique_ptr<TLSSocket> session;
+        TLSServer pool_server;
+        pool_server.setExecutionMode(TLSServer::ExecutionMode::WORKER_POOL, 2);
+
+        // Kao ServerBase: odgovor (sync API) iz completion-a čitanja, pa sljedeće čitanje
+        std::function<void(TLSSocket*)> readLoop = [&](TLSSocket* s) {
+            s->asyncReceiveView([&, s](const MessageView& view) {
+                auto reply = MessageFactory::createSuccessResponse("echo");
+                reply->setSequenceId(view.getSequenceId());
+                s->sendMessage(*reply);
+                readLoop(s);
+            }, [](const std::string&) {});
+        };
+        pool_server.setConnectionCallback([&](std::unique_ptr<TLSSocket> client) {
+            TLSSocket* s = client.get();
+            readLoop(s);
+            std::lock_guard<std::mutex> lk(async_mutex);
+            session = std::move(client);
+            async_cv.notify_all();
+        });
+        const int pool_port = pick_port();
+        ok("worker pool server start", pool_server.start(pool_port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket client;
+        ok("async client connect", client.connect("127.0.0.1", pool_port));
+        {
+            std::unique_lock<std::mutex> lk(async_mutex);
+            async_cv.wait_for(lk, std::chrono::seconds(5), [&]{ return session != nullptr; });
+        }
+        ok("session in async read", session && session->usesAsyncIo());
+
+        BroadcastHub::Options opt;
+        opt.queue_limit = 1024;                       // klijent čita tek nakon slanja zahtjeva
+        BroadcastHub hub(opt);
+        hub.subscribe(session.get());
+        hub.start();
+        const int kUpdates = 200, kRequests = 50;
+        std::thread publisher([&] {
+            for (int i = 0; i < kUpdates; ++i) hub.publish(update("AS-" + std::to_string(i), i), "");
+        });
+        bool sent_all = true;
+        for (int i = 1; i <= kRequests; ++i) {
+            Message hb(MessageType::HEARTBEAT);
+            hb.setSequenceId(static_cast<uint32_t>(i));
+            hb.calculateChecksum();
+            sent_all &= client.sendMessage(hb);
+        }
+        publisher.join();
+        ok("requests sent during broadcast", sent_all);
+
+        int updates = 0, replies = 0, next_seq = 0, next_reply = 1;
+        bool in_order = true;
+        for (int i = 0; i < kUpdates + kRequests; ++i) {
+            auto m = client.receiveMessage();
+            if (!m) break;
+            if (m->getType() == MessageType::MULTICAST_UPDATE) {
+                in_order &= m->getString("seq") == std::to_string(next_seq++);
+                ++updates;
+            } else if (m->getType() == MessageType::RESPONSE_SUCCESS) {
+                in_order &= m->getSequenceId() == static_cast<uint32_t>(next_reply++);
+                ++replies;
+            }
+        }
+        ok("all updates and replies intact", updates == kUpdates && replies == kRequests && in_order);
+        ok("hub idle after async writes", hub.waitIdle(std::chrono::seconds(5)));
+        const auto st = hub.getStats();
+        ok("async delivery counted", st.delivered == kUpdates && st.send_failures == 0 && st.dropped_subscribers == 0);
+        hub.unsubscribe(session.get());
+        hub.stop();
+
+        pool_server.stop();
+        {
+            std::lock_guard<std::mutex> lk(async_mutex);
+            session.reset();            // prije pool_server-a: stream živi na njegovom kontekstu
+        }
+        client.close();
+    }
+
+    // -------- 8) THREAD_PER_CONNECTION: handler nit čita sync, hub piše na isti socket --------
+    // Publisher ne smije dirati SSL stream paralelno sa SSL_read-om handler niti
+    {
+        std::mutex tpc_mutex;
+        std::condition_variable tpc_cv;
+        TLSSocket* handler_socket = nullptr;
+        bool handler_done = false;
+        TLSServer tpc_server;          // podrazumijevano THREAD_PER_CONNECTION
+        tpc_server.setConnectionCallback([&](std::unique_ptr<TLSSocket> conn) {
+            {
+                std::lock_guard<std::mutex> lk(tpc_mutex);
+                handler_socket = conn.get();
+                tpc_cv.notify_all();
+            }
+            while (auto m = conn->receiveMessage()) {
+                auto reply = MessageFactory::createSuccessResponse("echo");
+                reply->setSequenceId(m->getSequenceId());
+                if (!conn->sendMessage(*reply)) break;
+            }
+            conn.reset();
+            std::lock_guard<std::mutex> lk(tpc_mutex);
+            handler_done = true;
+            tpc_cv.notify_all();
+        });
+        const int tpc_port = pick_port();
+        ok("thread-per-connection server start", tpc_server.start(tpc_port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket client;
+        ok("tpc client connect", client.connect("127.0.0.1", tpc_port));
+        {
+            std::unique_lock<std::mutex> lk(tpc_mutex);
+            tpc_cv.wait_for(lk, std::chrono::seconds(5), [&]{ return handler_socket != nullptr; });
+        }
+        ok("handler socket on its strand", handler_socket && handler_socket->usesAsyncIo());
+
+        BroadcastHub::Options opt;
+        opt.queue_limit = 1024;
+        BroadcastHub hub(opt);
+        hub.subscribe(handler_socket);
+        hub.start();
+        const int kUpdates = 300, kRequests = 100;
+        std::thread publisher([&] {
+            for (int i = 0; i < kUpdates; ++i) hub.publish(update("TP-" + std::to_string(i), i), "");
+        });
+        bool sent_all = true;
+        for (int i = 1; i <= kRequests; ++i) {
+            Message hb(MessageType::HEARTBEAT);
+            hb.setSequenceId(static_cast<uint32_t>(i));
+            hb.calculateChecksum();
+            sent_all &= client.sendMessage(hb);
+        }
+        publisher.join();
+        ok("tpc requests sent during broadcast", sent_all);
+
+        int updates = 0, replies = 0, next_seq = 0, next_reply = 1;
+        bool in_order = true;
+        for (int i = 0; i < kUpdates + kRequests; ++i) {
+            auto m = client.receiveMessage();
+            if (!m) break;
+            if (m->getType() == MessageType::MULTICAST_UPDATE) {
+                in_order &= m->getString("seq") == std::to_string(next_seq++);
+                ++updates;
+            } else if (m->getType() == MessageType::RESPONSE_SUCCESS) {
+                in_order &= m->getSequenceId() == static_cast<uint32_t>(next_reply++);
+                ++replies;
+            }
+        }
+        ok("tpc updates and replies intact", updates == kUpdates && replies == kRequests && in_order);
+        ok("tpc hub idle", hub.waitIdle(std::chrono::seconds(5)));
+        hub.unsubscribe(handler_socket);
+        hub.stop();
+
+        client.close();                // handler vidi kraj i uništava socket
+        {
+            std::unique_lock<std::mutex> lk(tpc_mutex);
+            ok("tpc handler finished", tpc_cv.wait_for(lk, std::chrono::seconds(5), [&]{ return handler_done; }));
+        }
+        tpc_server.stop();
+    }
+
+    // Server strana prva (klijentov TLS shutdown inače čeka odgovor)
+    server.stop();
+    {
+        std::lock_guard<std::mutex> lk(accepted_mutex);
+        for (auto& s : accepted) s->close();
+        accepted.clear();
+    }
+    for (auto& c : clients) c->close();
+
+    std::cout << "Broadcast hub test passed.\n";
+    return 0;
+}
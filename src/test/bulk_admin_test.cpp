@@ -0,0 +1,236 @@
+#include "common/Database.h"
+#include "common/Message.h"
+#include "common/PriceCache.h"
+#include "common/TLSSocket.h"
+#include "common/VehicleStatus.h"
+#include "server/AdminServer.h"
+#include "server/CentralServer.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static bool near(double a, double b) { return std::fabs(a - b) < 1e-6; }
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::unique_ptr<Message> call(TLSSocket& sock, std::unique_ptr<Message> m) {
+    if (!sock.sendMessage(*m)) return nullptr;
+    return sock.receiveMessage();
+}
+
+static VehicleUpdate reroute(const std::string& uri, const std::string& route) {
+    VehicleUpdate u;
+    u.uri   = uri;
+    u.route = route;
+    return u;
+}
+
+static PriceList fare(VehicleType vt, TicketType tt, double price) {
+    PriceList p{};
+    p.vehicle_type = vt;
+    p.ticket_type  = tt;
+    p.base_price   = price;
+    return p;
+}
+
+int main() {
+    const std::string db_path = "test_bulk_admin.db";
+    std::remove(db_path.c_str());
+
+    // -------- 1) Baza: cijeli batch u jednoj transakciji --------
+    {
+        Database db;
+        ok("db init", db.initialize(db_path));
+        for (int i = 1; i <= 3; ++i) {
+            db.registerVehicle(Vehicle{"bus://9" + std::to_string(i), VehicleType::BUS, 50, 50, "R1", true, ""});
+        }
+
+        std::vector<VehicleUpdate> bad{reroute("bus://91", "R2"), reroute("bus://99", "R2")};
+        ok("missing vehicle fails batch", !db.updateVehiclesBatch(bad) && db.getLastErrorCode() == SQLITE_NOTFOUND);
+        ok("batch rolled back", db.getVehicle("bus://91")->route == "R1");
+
+        VehicleUpdate cap;
+        cap.uri             = "bus://93";
+        cap.capacity        = 30;
+        cap.available_seats = 40;
+        ok("invalid capacity rejected", !db.updateVehiclesBatch({cap}) && db.getLastErrorCode() == SQLITE_MISUSE);
+
+        cap.available_seats.reset();    // capacity bez available -> puno vozilo prazno
+        std::vector<VehicleUpdate> good{reroute("bus://91", "R2"), reroute("bus://92", "R2"), cap};
+        good[1].active = false;
+        ok("batch applied", db.updateVehiclesBatch(good));
+        auto v2 = db.getVehicle("bus://92");
+        auto v3 = db.getVehicle("bus://93");
+        ok("route and flags", db.getVehicle("bus://91")->route == "R2" && v2->route == "R2" && !v2->active);
+        ok("capacity untouched fields kept", v3->route == "R1" && v3->capacity == 30 && v3->available_seats == 30);
+
+        ok("price batch", db.updatePricesBatch({fare(VehicleType::BUS, TicketType::INDIVIDUAL, 1.8),
+                                                fare(VehicleType::TRAM, TicketType::GROUP_FAMILY, 3.2)}));
+        ok("price rows", near(db.getPrice(VehicleType::BUS, TicketType::INDIVIDUAL)->base_price, 1.8) &&
+                         near(db.getPrice(VehicleType::TRAM, TicketType::GROUP_FAMILY)->base_price, 3.2));
+    }
+    std::remove(db_path.c_str());
+
+    // -------- 2) Klijentska kopija: price_list_updated --------
+    {
+        PriceCache cache;
+        auto upd = MessageFactory::createMulticastUpdate("price_list_updated", {
+            {"price_version", "7"}, {"fare.1.1", "2.5"}, {"fare.3.4", "4.0"}});
+        ok("list update applied", cache.applyUpdate(*upd) && cache.get()->version() == 7 &&
+                                  near(cache.get()->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 2.5) &&
+                                  near(cache.get()->ticketPrice(VehicleType::TROLLEYBUS, TicketType::GROUP_TOURIST), 4.0));
+        ok("stale list ignored", !cache.applyUpdate(*upd));
+        auto all = cache.updateAll({fare(VehicleType::TRAM, TicketType::INDIVIDUAL, 1.5),
+                                    fare(VehicleType::BUS, TicketType::INDIVIDUAL, 2.0)});
+        ok("updateAll is one snapshot", all->version() == 8 && all->find(VehicleType::TRAM, TicketType::INDIVIDUAL)->version == 8 &&
+                                        near(all->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 2.0));
+    }
+
+    // -------- 3) AdminServer -> CentralServer --------
+    const std::string conf = "test_bulk_admin.conf";
+    {
+        std::ofstream f(conf);
+        f << "[admin]\nmax_bulk_items = 4\n";
+    }
+    const int central_port = pick_port();
+    const int admin_port   = pick_port() + 1;
+    {
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        central.setWorkerPool(true, 2);   // stop() zatvara i vezu admin servera
+        ok("central start", central.start(central_port, ""));
+
+        AdminServer admin_server;
+        admin_server.setCertificates("certs/server.crt", "certs/server.key");
+        admin_server.setCentralServer("127.0.0.1", central_port);
+        ok("admin start", admin_server.start(admin_port, conf));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket setup, watcher, admin;
+        ok("connect", setup.connect("127.0.0.1", central_port) && watcher.connect("127.0.0.1", central_port) &&
+                      admin.connect("127.0.0.1", admin_port));
+        for (int i = 1; i <= 3; ++i) {
+            call(setup, MessageFactory::createRegisterDevice("bus://8" + std::to_string(i), VehicleType::BUS));
+            call(setup, MessageFactory::createUpdateVehicle("bus://8" + std::to_string(i), true, std::string("R_OLD")));
+        }
+
+        // Prijavljen klijent dobija broadcast-e
+        const std::string urn = "8181818181818";
+        call(watcher, MessageFactory::createRegisterUser(urn));
+        auto auth = call(watcher, MessageFactory::createAuthRequest(urn));
+        ok("watcher auth", auth && auth->getBool("success"));
+        for (int i = 0; i < 100 && central.getBroadcastStats().subscribers == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        VehicleUpdate cap;
+        cap.uri             = "bus://83";
+        cap.route           = "R_NEW";
+        cap.capacity        = 20;
+        cap.available_seats = 15;
+        auto res = call(admin, MessageFactory::createBulkUpdateVehicles({reroute("bus://81", "R_NEW"),
+                                                                         reroute("bus://82", "R_NEW"), cap}));
+        ok("bulk vehicles relayed", res && res->getType() == MessageType::RESPONSE_SUCCESS && res->getString("count") == "3");
+
+        auto status = call(setup, MessageFactory::createGetVehicleStatus("R_NEW,R_OLD"));
+        VehicleStatusView view;
+        ok("status", status && view.apply(*status));
+        int on_new = 0, on_old = 0;
+        for (const auto& kv : view.vehicles()) (kv.second.route == "R_NEW" ? on_new : on_old)++;
+        ok("inventory swapped together", on_new == 3 && on_old == 0);
+        ok("capacity applied", view.vehicles().at("bus://83").capacity == 20 &&
+                               view.vehicles().at("bus://83").available == 15);
+
+        auto missing = call(admin, MessageFactory::createBulkUpdateVehicles({reroute("bus://81", "R_X"),
+                                                                             reroute("bus://89", "R_X")}));
+        ok("unknown vehicle -> 404", missing && missing->getInt("error_code") == 404);
+        auto again = call(setup, MessageFactory::createGetVehicleStatus("R_X"));
+        VehicleStatusView none;
+        ok("nothing applied", again && none.apply(*again) && none.vehicles().empty());
+
+        const uint64_t v0 = central.getPrices()->version();
+        std::vector<PriceList> matrix;
+        for (int v = 1; v <= 3; ++v) {
+            for (int t = 1; t <= 4; ++t) {
+                matrix.push_back(fare(static_cast<VehicleType>(v), static_cast<TicketType>(t), v + t / 10.0));
+            }
+        }
+        auto too_big = call(admin, MessageFactory::createBulkUpdatePrices(matrix));
+        ok("admin limit -> 413", too_big && too_big->getInt("error_code") == 413);
+        matrix.resize(4);
+        auto pr = call(admin, MessageFactory::createBulkUpdatePrices(matrix));
+        ok("bulk prices relayed", pr && pr->getType() == MessageType::RESPONSE_SUCCESS);
+        ok("one snapshot swap", central.getPrices()->version() == v0 + 1 &&
+                                near(central.getPrices()->ticketPrice(VehicleType::BUS, TicketType::GROUP_TOURIST), 1.4));
+        auto list = call(admin, MessageFactory::createGetPrices());
+        ok("GET_PRICES via admin", list && near(list->getDouble("fare.1.2"), 1.2));
+
+        auto bad_price = call(admin, MessageFactory::createBulkUpdatePrices({fare(VehicleType::BUS, TicketType::INDIVIDUAL, -1.0)}));
+        ok("negative price rejected", bad_price && bad_price->getInt("error_code") == 400);
+        auto denied = call(admin, MessageFactory::createRegisterUser("8282828282828"));
+        ok("non-admin message -> 403", denied && denied->getInt("error_code") == 403);
+
+        // Jedan broadcast po grupnoj izmjeni
+        int vehicles_updated = 0, price_lists = 0, single = 0;
+        PriceCache local;
+        // Broadcast ide kroz red BroadcastHub-a: GET_PRICES tek kad je red prazan i upisi završeni
+        // (delivered se broji po završenom upisu), inače odgovor pretekne ažuriranja
+        for (uint64_t last = ~0ull, i = 0; i < 100; ++i) {
+            const auto bs = central.getBroadcastStats();
+            if (bs.queued == 0 && bs.delivered == last) break;
+            last = bs.delivered;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        watcher.sendMessage(*MessageFactory::createGetPrices());
+        while (auto m = watcher.receiveMessage()) {
+            if (m->getType() != MessageType::MULTICAST_UPDATE) break;   // odgovor na GET_PRICES
+            const std::string type = m->getString("update_type");
+            if (type == "vehicles_updated") vehicles_updated++;
+            if (type == "price_list_updated") price_lists++;
+            if (type == "price_updated" || type == "vehicle_updated" || type == "capacity_updated") single++;
+            local.applyUpdate(*m);
+        }
+        ok("single vehicles broadcast", vehicles_updated == 1 && single == 0);
+        ok("single price list broadcast", price_lists == 1 &&
+                                          near(local.get()->ticketPrice(VehicleType::BUS, TicketType::GROUP_TOURIST), 1.4));
+
+        const auto st = admin_server.getRelayStats();
+        ok("relay stats", st.relayed == 5 && st.rejected == 2 && st.unavailable == 0);
+
+        setup.close();
+        watcher.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        central.stop();
+
+        auto down = call(admin, MessageFactory::createUpdatePrice(VehicleType::BUS, TicketType::INDIVIDUAL, 1.0));
+        ok("central down -> 502", down && down->getInt("error_code") == 502);
+        admin.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        admin_server.stop();
+    }
+    std::remove(db_path.c_str());
+    std::remove(conf.c_str());
+
+    std::cout << "Bulk admin test passed.\n";
+    return 0;
+}
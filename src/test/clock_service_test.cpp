@@ -0,0 +1,97 @@
+#include "common/ClockService.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static std::string reference(std::time_t sec) {
+    std::tm tm{};
+    localtime_r(&sec, &tm);
+    char buf[32];
+    const size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    return std::string(buf, n);
+}
+
+static bool wellFormed(const char* ts) {
+    for (size_t i = 0; i < ClockService::kTimestampLength; ++i) {
+        const char c = ts[i];
+        const bool sep = i == 4 || i == 7 || i == 10 || i == 13 || i == 16;
+        if (sep ? c != (i < 10 ? '-' : i == 10 ? ' ' : ':') : (c < '0' || c > '9')) return false;
+    }
+    return true;
+}
+
+int main() {
+    // -------- 1) Format, isti kao strftime --------
+    {
+        const std::time_t before = ClockService::seconds();
+        const std::string ts = ClockService::timestamp();
+        const std::time_t after = ClockService::seconds();
+        ok("timestamp length", ts.size() == ClockService::kTimestampLength);
+        ok("timestamp matches strftime", ts == reference(before) || ts == reference(after));
+
+        char buf[ClockService::kTimestampLength + 1];
+        buf[ClockService::kTimestampLength] = '#';
+        const std::time_t past = before - 86400 * 40 - 3600;
+        ClockService::formatTimestamp(past, buf);
+        ok("explicit second formatted", std::string(buf, ClockService::kTimestampLength) == reference(past));
+        ok("no write past buffer", buf[ClockService::kTimestampLength] == '#');
+        const std::string current = ClockService::timestamp();
+        ok("explicit past second does not replace current",
+           current == reference(after) || current == reference(ClockService::seconds()));
+    }
+
+    // -------- 2) Formatira se jednom po sekundi, ne po pozivu --------
+    {
+        ClockService::timestamp();
+        const uint64_t formats0 = ClockService::formatCount();
+        const auto t0 = std::chrono::steady_clock::now();
+        constexpr int kCalls = 200000;
+        for (int i = 0; i < kCalls; ++i) ClockService::timestamp();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        const uint64_t formats = ClockService::formatCount() - formats0;
+        std::cout << "timestamp(): " << secs * 1e9 / kCalls << " ns/call, " << formats << " formats" << std::endl;
+        ok("formatted about once per second", formats <= static_cast<uint64_t>(secs) + 2);
+    }
+
+    // -------- 3) Paralelni čitaoci: nikad pokidan bafer --------
+    {
+        std::atomic<bool> bad{false};
+        std::vector<std::thread> threads;
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);   // preko granice sekunde
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                char buf[ClockService::kTimestampLength];
+                while (std::chrono::steady_clock::now() < until) {
+                    ClockService::formatTimestamp(buf);
+                    if (!wellFormed(buf)) bad = true;
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        ok("concurrent readers see whole timestamps", !bad);
+    }
+
+    // -------- 4) Monotoni ns --------
+    {
+        const uint64_t a = ClockService::monotonicNanos();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const uint64_t elapsed = ClockService::nanosSince(a);
+        ok("monotonic nanos advance", elapsed >= 5000000ULL && elapsed < 1000000000ULL);
+    }
+
+    std::cout << "All clock service tests passed" << std::endl;
+    return 0;
+}
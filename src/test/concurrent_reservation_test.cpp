@@ -6,6 +6,8 @@
 #include <atomic>
 #include <chrono>
 #include <cassert>
+#include <map>
+#include <mutex>
 
 using namespace transport;
 
@@ -93,6 +95,177 @@ int main() {
     // Pokušaj još jednu rezervaciju -> mora pasti
     ok("extra reserve fails", try_reserve_one(db, uri) == false);
 
+    pool.returnConnection(db);
+
+    // 4) Batch kupovina (purchaseTickets): uslovni UPDATE u BEGIN IMMEDIATE ne smije preprodati
+    {
+        auto d = pool.getConnection();
+        Vehicle tram{};
+        tram.uri = "tram://7"; tram.type = VehicleType::TRAM; tram.capacity = 9;
+        tram.available_seats = 9; tram.route = "R_7"; tram.active = true; tram.last_update = "now";
+        d->registerVehicle(tram);
+        d->updateVehicleCapacity(tram.uri, 9, 9);    // ponovno pokretanje testa nad istim fajlom
+        User u{"7777777777777", "Tramvaj", 30, "now", true, "hash"};
+        d->registerUser(u);                          // tickets.user_urn je FK na users
+        pool.returnConnection(d);
+    }
+
+    std::atomic<int> sold{0};
+    std::atomic<int> rejected{0};
+    std::atomic<int> ticket_seq{0};
+    std::mutex       sold_mutex;
+    std::string      sold_ticket;                   // jedna prodana karta za test duplikata
+    const std::string run = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    auto buyer = [&](int attempts) {
+        auto d = pool.getConnection();
+        for (int i = 0; i < attempts; ++i) {
+            std::vector<Ticket> tickets(2);
+            for (auto& t : tickets) {
+                t.ticket_id = "T_" + run + "_" + std::to_string(ticket_seq++);
+                t.user_urn = "7777777777777";
+                t.type = TicketType::INDIVIDUAL; t.vehicle_type = VehicleType::TRAM;
+                t.route = "R_7"; t.price = 1.0; t.purchase_date = "now";
+            }
+            Payment p{};
+            p.transaction_id = "P_" + tickets.front().ticket_id;
+            p.ticket_id = tickets.front().ticket_id; p.amount = 2.0; p.successful = true;
+            if (d->purchaseTickets("tram://7", tickets, p)) {
+                sold += 2;
+                std::lock_guard<std::mutex> lk(sold_mutex);
+                if (sold_ticket.empty()) sold_ticket = tickets.front().ticket_id;
+            } else if (d->getLastErrorCode() == SQLITE_FULL) rejected++;
+            else std::cout << "purchase error: " << d->getLastError() << std::endl;
+        }
+        pool.returnConnection(d);
+    };
+    std::vector<std::thread> buyers;
+    for (int k = 0; k < 4; ++k) buyers.emplace_back(buyer, 3);
+    for (auto& t : buyers) t.join();
+
+    db = pool.getConnection();
+    auto tram = db->getVehicle("tram://7");
+    ok("batch: sold 8 of 9 seats (pairs)", sold == 8);
+    ok("batch: remaining seat == 1", tram && tram->available_seats == 1);
+    ok("batch: others rejected as full", rejected == 12 - 4);
+
+    // Neuspjeh usred transakcije (duplikat ticket_id) -> mjesta se ne skidaju
+    std::vector<Ticket> dup(1);
+    dup[0].ticket_id = sold_ticket; dup[0].user_urn = "7777777777777"; dup[0].route = "R_7";
+    Payment p{}; p.transaction_id = "P_dup_" + run; p.ticket_id = dup[0].ticket_id;
+    ok("batch: duplicate ticket fails", !db->purchaseTickets("tram://7", dup, p));
+    tram = db->getVehicle("tram://7");
+    ok("batch: rollback keeps seats", tram && tram->available_seats == 1);
+
+    std::vector<Ticket> one(1);
+    one[0].ticket_id = "T_" + run + "_missing";
+    ok("batch: unknown vehicle -> NOTFOUND",
+       !db->purchaseTickets("tram://404", one, p) && db->getLastErrorCode() == SQLITE_NOTFOUND);
+    pool.returnConnection(db);
+
+    // 5) Lease API: RAII povrat, ekskluzivnost i metrike čekanja (pool od 2, 8 niti)
+    ok("reinit small pool", pool.initialize("concurrent_reservation_test.db", 2));
+    {
+        auto l1 = pool.acquire();
+        auto l2 = pool.acquire();
+        ok("two leases", l1 && l2 && l1.get() != l2.get());
+    }   // oba se vraćaju ovdje
+    std::mutex owners_mutex;
+    std::map<const Database*, int> owners;
+    std::atomic<bool> exclusive{true};
+    auto leaser = [&](int rounds) {
+        for (int i = 0; i < rounds; ++i) {
+            auto lease = pool.acquire();
+            if (!lease) { exclusive = false; return; }
+            {
+                std::lock_guard<std::mutex> lk(owners_mutex);
+                if (++owners[lease.get()] != 1) exclusive = false;
+            }
+            lease->getVehicle("tram://7");
+            {
+                std::lock_guard<std::mutex> lk(owners_mutex);
+                --owners[lease.get()];
+            }
+        }
+    };
+    for (bool affinity : {false, true}) {
+        pool.setThreadAffinity(affinity);
+        std::vector<std::thread> th;
+        for (int k = 0; k < 8; ++k) th.emplace_back(leaser, 200);
+        for (auto& t : th) t.join();
+    }
+    auto st = pool.getStats();
+    std::cout << "pool: acquisitions=" << st.acquisitions << " waits=" << st.waits
+              << " max_wait_us=" << st.max_wait_us << " affinity_hits=" << st.affinity_hits
+              << " steals=" << st.steals << std::endl;
+    ok("lease exclusive under contention", exclusive);
+    ok("all acquisitions counted", st.acquisitions >= 2 * 8 * 200);
+    ok("affinity hits recorded", st.affinity_hits > 0);
+    {
+        auto l1 = pool.acquire();
+        auto l2 = pool.acquire();
+        ok("parked connections reusable by other leases", l1 && l2 && l1.get() != l2.get());
+        ok("parked connections stolen", pool.getStats().steals >= st.steals + 2);
+    }
+    pool.setThreadAffinity(false);
+    {
+        // Čekač na punom pool-u spava na cv-u dok ga povrat ne probudi
+        auto l1 = pool.acquire();
+        auto l2 = pool.acquire();
+        std::atomic<bool> got{false};
+        std::thread waiter([&] { auto l = pool.acquire(); got = (bool)l; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ok("waiter blocked on full pool", !got);
+        l1.release();
+        waiter.join();
+        ok("waiter woken by return", got);
+    }
+
+    // 6) Zakup preživi shutdown i re-init: stari set živi do povrata, novi pool je pun
+    {
+        auto held = pool.acquire();
+        ok("lease before shutdown", (bool)held);
+        pool.shutdown();
+        ok("no lease after shutdown", !pool.acquire());
+        ok("held lease still usable", held->getVehicle("tram://7") != nullptr);
+        ok("reinit with lease out", pool.initialize("concurrent_reservation_test.db", 2));
+        auto n1 = pool.acquire();
+        auto n2 = pool.acquire();
+        ok("new pool fully available", n1 && n2 && n1.get() != held.get() && n2.get() != held.get());
+        const Database* old_db = held.get();
+        held.release();                      // povrat u povučeni set, ne u novi pool
+        n1.release();
+        n2.release();
+        auto a = pool.acquire();
+        auto b = pool.acquire();
+        ok("old connection not handed out again", a && b && a.get() != old_db && b.get() != old_db);
+    }
+    {
+        // Zakupi u letu dok se pool više puta re-inicijalizuje
+        std::atomic<bool> stop{false};
+        std::atomic<int>  used{0};
+        auto churn = [&] {
+            while (!stop) {
+                auto lease = pool.acquire();
+                if (lease && lease->getVehicle("tram://7")) used++;
+            }
+        };
+        std::vector<std::thread> th;
+        for (int k = 0; k < 4; ++k) th.emplace_back(churn);
+        bool reinit_ok = true;
+        for (int i = 0; i < 5; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            reinit_ok = pool.initialize("concurrent_reservation_test.db", 2) && reinit_ok;
+        }
+        stop = true;
+        for (auto& t : th) t.join();
+        ok("reinit under load", reinit_ok && used > 0);
+        auto l1 = pool.acquire();
+        auto l2 = pool.acquire();
+        ok("pool consistent after churn", l1 && l2 && l1.get() != l2.get());
+    }
+    pool.shutdown();
+
     std::cout << "Concurrent reservation test passed.\n";
     return 0;
 }
@@ -0,0 +1,92 @@
+#include "common/Crc32.h"
+#include "common/Message.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+// Vrati MB/s za jednu implementaciju nad baferom veličine 'size'
+template <typename Fn>
+static double measure(Fn fn, const std::vector<uint8_t>& buf, size_t size, uint32_t& sink) {
+    const size_t target_bytes = 64u * 1024u * 1024u;
+    const size_t iterations   = std::max<size_t>(1, target_bytes / size);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        sink += fn(buf.data(), size);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    return (static_cast<double>(iterations * size) / (1024.0 * 1024.0)) / seconds;
+}
+
+int main() {
+    // -------- 1) Ispravnost --------
+    const char* check = "123456789";
+    const auto* cb = reinterpret_cast<const uint8_t*>(check);
+    ok("bitwise check value 0xCBF43926",  Crc32::bitwise(cb, 9)  == 0xCBF43926u);
+    ok("slicing8 check value 0xCBF43926", Crc32::slicing8(cb, 9) == 0xCBF43926u);
+    ok("hardware check value 0xCBF43926", Crc32::hardware(cb, 9) == 0xCBF43926u);
+    ok("compute check value 0xCBF43926",  Crc32::compute(cb, 9)  == 0xCBF43926u);
+    ok("empty input",                     Crc32::compute(cb, 0)  == 0u);
+
+    std::mt19937 gen(42);
+    std::vector<uint8_t> buf(64 * 1024);
+    for (auto& b : buf) b = static_cast<uint8_t>(gen());
+
+    bool all_same = true;
+    for (size_t len : {1, 3, 7, 8, 9, 15, 16, 63, 64, 65, 511, 4096, 65535}) {
+        for (size_t off : {0, 1, 3}) {
+            const uint32_t ref = Crc32::bitwise(buf.data() + off, len);
+            all_same &= Crc32::slicing8(buf.data() + off, len) == ref;
+            all_same &= Crc32::hardware(buf.data() + off, len) == ref;
+        }
+    }
+    ok("all implementations agree (lengths/alignments)", all_same);
+
+    const uint32_t split = Crc32::update(Crc32::compute(buf.data(), 1000), buf.data() + 1000, 3000);
+    ok("update() continues over chunks", split == Crc32::compute(buf.data(), 4000));
+
+    // Message checksum ostaje isti kao sa originalnom bitwise implementacijom
+    auto msg = MessageFactory::createSuccessResponse("Seat reserved successfully", {
+        {"route", "R_42"}, {"vehicle_uri", "bus://42"}, {"available_seats", "17"}});
+    auto frame = msg->serialize();
+    Message parsed;
+    ok("message frame parses", parsed.deserialize(frame));
+    ok("message checksum valid", parsed.verifyChecksum());
+    std::vector<uint8_t> zeroed = frame;
+    std::memset(zeroed.data() + offsetof(Message::Header, checksum), 0, sizeof(uint32_t));
+    ok("wire checksum == bitwise CRC-32",
+       Message::decodeHeader(frame.data()).checksum == Crc32::bitwise(zeroed.data(), zeroed.size()));
+
+    // -------- 2) Mikro-benchmark --------
+    std::cout << "\nCRC-32 implementation in use: " << Crc32::implementation() << "\n";
+    std::cout << std::left << std::setw(10) << "size"
+              << std::setw(14) << "bitwise" << std::setw(14) << "slicing8"
+              << std::setw(14) << "hardware" << "(MB/s)\n";
+
+    uint32_t sink = 0;
+    for (size_t size : {static_cast<size_t>(64), frame.size(), static_cast<size_t>(1024), static_cast<size_t>(65536)}) {
+        double b = measure(Crc32::bitwise,  buf, size, sink);
+        double s = measure(Crc32::slicing8, buf, size, sink);
+        double h = measure(Crc32::hardware, buf, size, sink);
+        std::cout << std::left << std::setw(10) << size << std::fixed << std::setprecision(0)
+                  << std::setw(14) << b << std::setw(14) << s << std::setw(14) << h << "\n";
+    }
+    std::cout << "(sink " << sink << ")\n";
+
+    std::cout << "CRC32 benchmark finished.\n";
+    return 0;
+}
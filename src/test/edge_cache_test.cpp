@@ -0,0 +1,211 @@
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "common/VehicleStatus.h"
+#include "server/CentralServer.h"
+#include "server/VehicleServer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static bool waitUntil(const std::function<bool()>& cond, int ms = 3000) {
+    for (int i = 0; i < ms / 10; ++i) {
+        if (cond()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return cond();
+}
+
+// Preskoči MULTICAST_UPDATE/VEHICLE_STATUS delte do odgovora sa traženim sequence_id
+static std::unique_ptr<Message> call(TLSSocket& sock, std::unique_ptr<Message> m, uint32_t seq) {
+    m->setSequenceId(seq);
+    if (!sock.sendMessage(*m)) return nullptr;
+    for (int i = 0; i < 20; ++i) {
+        auto r = sock.receiveMessage();
+        if (!r || r->getSequenceId() == seq) return r;
+    }
+    return nullptr;
+}
+
+static std::unique_ptr<Message> purchase(const std::string& urn, const std::string& route, int passengers) {
+    auto m = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, route, passengers);
+    m->addString("urn", urn);
+    return m;
+}
+
+static int availableOn(const Message& status, const std::string& uri) {
+    VehicleStatusView view;
+    if (!view.apply(status)) return -1;
+    auto it = view.vehicles().find(uri);
+    return it == view.vehicles().end() ? -1 : it->second.available;
+}
+
+static bool startCentral(CentralServer& server, const std::string& db, int port) {
+    server.setDatabasePath(db);
+    server.setCertificatePath("certs/server.crt", "certs/server.key");
+    server.setWorkerPool(true, 2);   // stop() zatvara i žive async sesije (veza edge čvora pada)
+    return server.start(port, "");
+}
+
+int main() {
+    const std::string db_path  = "test_edge_cache.db";
+    const std::string edge_urn = "6100000000001";
+    const std::string user_urn = "6100000000002";
+    std::remove(db_path.c_str());
+
+    const int central_port = pick_port();
+    auto central = std::make_unique<CentralServer>();
+    ok("central start", startCentral(*central, db_path, central_port));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    {
+        TLSSocket admin;
+        ok("admin connect", admin.connect("127.0.0.1", central_port));
+        uint32_t seq = 1;
+        call(admin, MessageFactory::createRegisterDevice("bus://61", VehicleType::BUS), seq++);
+        call(admin, MessageFactory::createUpdateVehicle("bus://61", true, std::string("R_61")), seq++);
+        call(admin, MessageFactory::createUpdateCapacity("bus://61", 3, 3), seq++);
+        call(admin, MessageFactory::createRegisterUser(edge_urn), seq++);
+        auto r = call(admin, MessageFactory::createRegisterUser(user_urn), seq++);
+        ok("central setup", r != nullptr);
+        admin.close();
+    }
+
+    // -------- 1) Edge čvor: kopija stanja preko jedne veze --------
+    const int edge_port = pick_port();
+    VehicleServer edge;
+    edge.setCertificates("certs/server.crt", "certs/server.key");
+    edge.setCentralServer("127.0.0.1", central_port);
+    edge.setEdgeIdentity(edge_urn);
+    ok("edge start", edge.start(edge_port, ""));
+    ok("replica synced", waitUntil([&] { return edge.getEdgeStats().synced; }));
+    ok("replica holds the vehicle", edge.getEdgeStats().replica_vehicles == 1 && edge.getEdgeStats().link_up);
+
+    TLSSocket dev;
+    ok("device connect", dev.connect("127.0.0.1", edge_port));
+
+    // -------- 2) Čitanja i provjere lokalno --------
+    {
+        auto st = call(dev, MessageFactory::createGetVehicleStatus("*"), 10);
+        ok("status from replica", st && st->getType() == MessageType::VEHICLE_STATUS && st->getBool("full") &&
+                                  availableOn(*st, "bus://61") == 3);
+        auto reserve = MessageFactory::createReserveSeat(VehicleType::BUS, "R_404");
+        reserve->addString("urn", user_urn);
+        auto miss = call(dev, std::move(reserve), 11);
+        ok("unknown route rejected locally", miss && miss->getType() == MessageType::RESPONSE_ERROR &&
+                                             miss->getInt("error_code") == 404);
+        auto full = call(dev, purchase(user_urn, "R_61", 5), 12);
+        ok("too many passengers rejected locally", full && full->getInt("error_code") == 409);
+        const auto s = edge.getEdgeStats();
+        ok("nothing forwarded yet", s.local_reads == 1 && s.local_rejects == 2 && s.forwarded == 0);
+    }
+
+    // -------- 3) Izmjene idu na centralni server; update se širi lokalno --------
+    {
+        TLSSocket watcher;
+        ok("watcher connect", watcher.connect("127.0.0.1", edge_port));
+        auto auth = call(watcher, MessageFactory::createAuthRequest(user_urn), 20);
+        ok("auth forwarded", auth && auth->getType() == MessageType::AUTH_RESPONSE && auth->getBool("success") &&
+                             auth->getSequenceId() == 20);
+        const std::string token = auth->getString("token");
+
+        auto bad = call(watcher, MessageFactory::createGetVehicleStatus("R_61", 0, true, "forged"), 21);
+        ok("unknown session cannot subscribe", bad && bad->getInt("error_code") == 401);
+        auto sub = call(watcher, MessageFactory::createGetVehicleStatus("R_61", 0, true, token), 22);
+        ok("subscribe with edge session", sub && sub->getType() == MessageType::VEHICLE_STATUS);
+
+        auto bought = call(dev, purchase(user_urn, "R_61", 3), 42);
+        ok("purchase forwarded", bought && bought->getType() == MessageType::RESPONSE_SUCCESS &&
+                                 bought->getSequenceId() == 42);
+        ok("forward counted", edge.getEdgeStats().forwarded == 2);
+
+        bool got_update = false, got_delta = false;
+        for (int i = 0; i < 6 && !(got_update && got_delta); ++i) {
+            auto m = watcher.receiveMessage();
+            if (!m) break;
+            if (m->getType() == MessageType::MULTICAST_UPDATE &&
+                m->getString("update_type") == "ticket_purchased") got_update = true;
+            if (m->getType() == MessageType::VEHICLE_STATUS && availableOn(*m, "bus://61") == 0) got_delta = true;
+        }
+        ok("multicast update relayed by edge", got_update);
+        ok("status delta relayed by edge", got_delta);
+
+        ok("replica caught up", waitUntil([&] {
+            auto st = call(dev, MessageFactory::createGetVehicleStatus("R_61"), 43);
+            return st && availableOn(*st, "bus://61") == 0;
+        }));
+        auto sold_out = call(dev, purchase(user_urn, "R_61", 1), 44);
+        ok("sold out answered locally", sold_out && sold_out->getInt("error_code") == 409);
+        watcher.close();
+    }
+
+    // -------- 4) Više uređaja dijeli vezu (zahtjevi u letu istovremeno) --------
+    {
+        const uint64_t before = edge.getEdgeStats().forwarded;
+        const int kDevices = 4;
+        std::vector<std::thread> devices;
+        std::atomic<int> answered{0};
+        for (int d = 0; d < kDevices; ++d) {
+            devices.emplace_back([&, d] {
+                TLSSocket c;
+                if (!c.connect("127.0.0.1", edge_port)) return;
+                for (int i = 0; i < 5; ++i) {
+                    const std::string urn = "62000000000" + std::to_string(10 + d * 5 + i);
+                    auto r = call(c, MessageFactory::createRegisterUser(urn), static_cast<uint32_t>(100 + i));
+                    if (r && r->getSequenceId() == static_cast<uint32_t>(100 + i)) answered++;
+                }
+                c.close();
+            });
+        }
+        for (auto& t : devices) t.join();
+        ok("concurrent forwards answered in order", answered == kDevices * 5);
+        ok("single upstream link", edge.getEdgeStats().forwarded == before + kDevices * 5 &&
+                                   edge.getEdgeStats().link_connects == 1);
+    }
+
+    // -------- 5) Pad centralnog servera: čitanja ostaju, izmjene 503; ponovno spajanje --------
+    {
+        central->stop();
+        central.reset();
+        ok("link down detected", waitUntil([&] { return !edge.getEdgeStats().link_up; }));
+        auto st = call(dev, MessageFactory::createGetVehicleStatus("*"), 50);
+        ok("reads served while central is down", st && st->getType() == MessageType::VEHICLE_STATUS);
+        auto w = call(dev, MessageFactory::createRegisterUser("6300000000001"), 51);
+        ok("writes fail fast", w && w->getType() == MessageType::RESPONSE_ERROR && w->getInt("error_code") == 503);
+
+        central = std::make_unique<CentralServer>();
+        ok("central restart", startCentral(*central, db_path, central_port));
+        ok("edge reconnected", waitUntil([&] { return edge.getEdgeStats().link_connects == 2 &&
+                                                      edge.getEdgeStats().link_up; }, 5000));
+        auto w2 = call(dev, MessageFactory::createRegisterUser("6300000000002"), 52);
+        ok("writes resume", w2 && w2->getType() == MessageType::RESPONSE_SUCCESS);
+    }
+
+    dev.close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    edge.stop();
+    central->stop();
+    std::remove(db_path.c_str());
+
+    std::cout << "Edge cache test passed.\n";
+    return 0;
+}
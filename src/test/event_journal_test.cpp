@@ -0,0 +1,229 @@
+#include "common/Database.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include "server/EventJournal.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::vector<uint8_t> bytes(const std::string& s) { return {s.begin(), s.end()}; }
+
+static bool request(TLSSocket& sock, const Message& m) {
+    if (!sock.sendMessage(m)) return false;
+    auto r = sock.receiveMessage();
+    return r && r->getType() == MessageType::RESPONSE_SUCCESS;
+}
+
+static journal_events::Purchase makePurchase(const std::string& uri, const std::string& urn, int n,
+                                             int available, uint32_t seq, const std::string& id_prefix) {
+    journal_events::Purchase ev;
+    ev.seats = {uri, urn, "R_1", n, 10, available, seq};
+    for (int i = 0; i < n; ++i) {
+        Ticket t{};
+        t.ticket_id     = id_prefix + std::to_string(i);
+        t.user_urn      = urn;
+        t.type          = TicketType::INDIVIDUAL;
+        t.vehicle_type  = VehicleType::BUS;
+        t.route         = "R_1";
+        t.price         = 1.5;
+        t.discount      = 0.25;
+        t.purchase_date = "2024-01-01 10:00:00";
+        t.seat_number   = std::to_string(i + 1);
+        t.used          = false;
+        ev.tickets.push_back(t);
+    }
+    ev.payment = {"TX-" + id_prefix, ev.tickets.front().ticket_id, 1.5 * n, "card", "2024-01-01 10:00:00", true};
+    return ev;
+}
+
+int main() {
+    const std::string path = "test_event_journal.bin";
+    std::remove(path.c_str());
+
+    // -------- 1) Group commit: mnogo pisaca, manje msync-ova --------
+    {
+        EventJournal j;
+        EventJournal::Options opt;
+        opt.grow_bytes = 64 * 1024;   // više remap-ova tokom testa
+        ok("open new journal", j.open(path, opt));
+        const int kThreads = 8, kPer = 300;
+        std::vector<std::thread> ts;
+        for (int t = 0; t < kThreads; ++t) {
+            ts.emplace_back([&j, t] {
+                for (int i = 0; i < kPer; ++i) {
+                    const uint64_t lsn = j.append(EventJournal::EventType::SEAT_RESERVED,
+                                                  bytes("t" + std::to_string(t) + "-" + std::to_string(i)));
+                    if (lsn == 0 || !j.waitDurable(lsn)) std::abort();
+                }
+            });
+        }
+        for (auto& th : ts) th.join();
+        const auto st = j.getStats();
+        std::cout << "  appended=" << st.appended << " commits=" << st.commits << "\n";
+        ok("all appended and durable", st.appended == kThreads * kPer && st.durable_lsn == kThreads * kPer);
+        ok("commits are grouped", st.commits < st.appended);
+        const auto recs = j.read(0, 100000);
+        bool in_order = recs.size() == static_cast<size_t>(kThreads * kPer);
+        for (size_t i = 0; in_order && i < recs.size(); ++i) in_order = recs[i].lsn == i + 1;
+        ok("read returns all records in LSN order", in_order);
+        ok("read after lsn", j.read(kThreads * kPer - 2).size() == 2);
+    }
+
+    // -------- 2) Ponovno otvaranje + pokidan rep --------
+    {
+        EventJournal j;
+        ok("reopen", j.open(path));
+        ok("records recovered", j.lastLsn() == 2400 && j.durableLsn() == 2400);
+        const uint64_t lsn = j.append(EventJournal::EventType::CAPACITY_SET, bytes("tail"));
+        ok("lsn continues", lsn == 2401 && j.waitDurable(lsn));
+    }
+    {
+        // Zapis je [25 B zaglavlje]["tail"] na kraju: pokvari zadnji bajt payload-a
+        EventJournal j;
+        ok("reopen before corruption", j.open(path));
+        const auto last = j.read(2400);
+        ok("tail record readable", last.size() == 1 && std::string(last[0].payload.begin(), last[0].payload.end()) == "tail");
+        j.close();
+    }
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        size_t pos = std::string(data.begin(), data.end()).rfind("tail");
+        ok("found tail bytes", pos != std::string::npos);
+        std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(pos + 3));
+        out.put('X');
+    }
+    {
+        EventJournal j;
+        ok("open with torn tail", j.open(path));
+        ok("torn record dropped", j.lastLsn() == 2400);
+        const uint64_t lsn = j.append(EventJournal::EventType::CAPACITY_SET, bytes("again"));
+        ok("lsn reused after torn tail", lsn == 2401 && j.waitDurable(lsn));
+
+        // -------- 3) Pražnjenje: samo ako nema novih zapisa, LSN ostaje monoton --------
+        ok("reset refused when stale", !j.resetIfLast(2400));
+        ok("reset", j.resetIfLast(2401));
+        ok("empty after reset", j.read(0).empty() && j.getStats().bytes == 0);
+        const uint64_t next = j.append(EventJournal::EventType::SEAT_RESERVED, bytes("x"));
+        ok("lsn monotonic after reset", next == 2402 && j.waitDurable(next));
+    }
+    {
+        EventJournal j;
+        ok("reopen after reset", j.open(path));
+        const auto recs = j.read(0);
+        ok("only post-reset record", j.lastLsn() == 2402 && recs.size() == 1 && recs[0].lsn == 2402);
+    }
+    std::remove(path.c_str());
+
+    // -------- 4) Enkodiranje događaja --------
+    {
+        const auto ev = makePurchase("bus://1", "1234567890123", 3, 7, 42, "TK-");
+        journal_events::Purchase back;
+        ok("purchase roundtrip", journal_events::decode(journal_events::encode(ev), back) &&
+                                 back.tickets.size() == 3 && back.tickets[2].ticket_id == "TK-2" &&
+                                 back.tickets[1].discount == 0.25 && back.payment.amount == 4.5 &&
+                                 back.payment.successful && back.seats.seat_seq == 42 &&
+                                 back.seats.available == 7);
+        auto enc = journal_events::encode(ev);
+        enc.pop_back();
+        ok("truncated purchase rejected", !journal_events::decode(enc, back));
+        journal_events::SeatChange sc{"tram://2", "", "R_2", 5, 40, 35, 9}, sc_back;
+        ok("seat change roundtrip", journal_events::decode(journal_events::encode(sc), sc_back) &&
+                                    sc_back.vehicle_uri == "tram://2" && sc_back.available == 35 &&
+                                    sc_back.capacity == 40 && sc_back.seat_seq == 9);
+    }
+
+    // -------- 5) CentralServer: kupovina kroz dnevnik + oporavak nakon pada --------
+    const std::string db_path = "test_event_journal.db";
+    const std::string jpath   = "test_event_journal_server.bin";
+    const std::string urn     = "5555555555555";
+    std::remove(db_path.c_str());
+    std::remove(jpath.c_str());
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        server.setJournalPath(jpath);
+        ok("server start with journal", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket c;
+        ok("connect", c.connect("127.0.0.1", port));
+        ok("register vehicle", request(c, *MessageFactory::createRegisterDevice("bus://1", VehicleType::BUS)));
+        ok("route", request(c, *MessageFactory::createUpdateVehicle("bus://1", true, std::string("R_1"))));
+        ok("capacity", request(c, *MessageFactory::createUpdateCapacity("bus://1", 10, 10)));
+        request(c, *MessageFactory::createRegisterUser(urn));
+        auto buy = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "R_1", 2);
+        buy->addString("urn", urn);
+        ok("purchase acknowledged", request(c, *buy));
+        ok("purchase journaled", server.getJournalStats().appended >= 2);
+        c.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+    }
+    {
+        Database db;
+        ok("db open", db.initialize(db_path));
+        auto v = db.getVehicle("bus://1");
+        ok("tickets applied to db", db.getUserTickets(urn).size() == 2);
+        ok("seats flushed", v && v->available_seats == 8);
+    }
+    {
+        // "Pad": kupovina je u dnevniku, ali karte nisu stigle u bazu
+        EventJournal j;
+        ok("open server journal", j.open(jpath));
+        const auto ev = makePurchase("bus://1", urn, 3, 5, 1000, "TK-crash-");
+        const uint64_t lsn = j.append(EventJournal::EventType::TICKETS_PURCHASED, journal_events::encode(ev));
+        // Stariji zapis (manji seat_seq) ne smije prepisati stanje
+        journal_events::SeatChange stale{"bus://1", urn, "R_1", 1, 10, 9, 999};
+        j.append(EventJournal::EventType::SEAT_RESERVED, journal_events::encode(stale));
+        ok("crash records durable", lsn != 0 && j.waitDurable(lsn + 1));
+    }
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        server.setJournalPath(jpath);
+        ok("server restart replays journal", server.start(port, ""));
+        ok("journal emptied after recovery", server.getJournalStats().bytes == 0);
+        server.stop();
+    }
+    {
+        Database db;
+        ok("db reopen", db.initialize(db_path));
+        auto v = db.getVehicle("bus://1");
+        ok("replayed tickets", db.getUserTickets(urn).size() == 5 && db.getTicket("TK-crash-2"));
+        ok("replayed payment", db.getPayment("TX-TK-crash-") != nullptr);
+        ok("seats from newest seat_seq", v && v->available_seats == 5);
+    }
+    std::remove(db_path.c_str());
+    std::remove(jpath.c_str());
+
+    std::cout << "Event journal test passed.\n";
+    return 0;
+}
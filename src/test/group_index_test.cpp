@@ -0,0 +1,113 @@
+#include "common/Database.h"
+#include "server/GroupIndex.h"
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static User makeUser(const std::string& urn) {
+    User u;
+    u.urn = urn;
+    u.name = "Member " + urn.substr(urn.size() - 2);
+    u.age = 30;
+    u.registration_date = "2026-01-01 00:00:00";
+    u.active = true;
+    u.pin_hash = "hash";
+    return u;
+}
+
+int main() {
+    const std::string db_path = "test_group_index.db";
+    std::remove(db_path.c_str());
+
+    Database db;
+    ok("db open", db.initialize(db_path));
+    for (int i = 0; i < 6; ++i) {
+        ok("register user", db.registerUser(makeUser("70000000000" + std::to_string(10 + i))));
+    }
+    const std::string leader = "7000000000010";
+
+    // -------- 1) createGroup vraća id; getGroupByName --------
+    Group g{};
+    g.group_name = "tim";
+    g.leader_urn = leader;
+    g.active     = true;
+    int gid = 0;
+    ok("create group", db.createGroup(g, &gid) && gid > 0);
+    auto loaded = db.getGroupByName("tim");
+    ok("group by name", loaded && loaded->group_id == gid && loaded->leader_urn == leader);
+    ok("leader is member", loaded && loaded->members.size() == 1 && loaded->members[0] == leader);
+    ok("unknown group", !db.getGroupByName("nema"));
+
+    // -------- 2) addUsersToGroup: sve ili ništa --------
+    ok("bulk add", db.addUsersToGroup(gid, {"7000000000011", "7000000000012"}));
+    ok("members stored", db.getGroupByName("tim")->members.size() == 3);
+
+    ok("unknown user rejected", !db.addUsersToGroup(gid, {"7000000000013", "7999999999999"}));
+    ok("unknown user code", db.getLastErrorCode() == SQLITE_NOTFOUND);
+    ok("rolled back", db.getGroupByName("tim")->members.size() == 3);
+
+    ok("duplicate rejected", !db.addUsersToGroup(gid, {"7000000000013", "7000000000011"}));
+    ok("duplicate code", db.getLastErrorCode() == SQLITE_CONSTRAINT);
+    ok("rolled back again", db.getGroupByName("tim")->members.size() == 3);
+
+    ok("remove member", db.removeUserFromGroup("7000000000012", "tim"));
+    ok("removed member re-added", db.addUsersToGroup(gid, {"7000000000012", "7000000000013"}));
+    ok("reactivated", db.getGroupByName("tim")->members.size() == 4);
+
+    // -------- 3) GroupIndex: učitavanje jednom, write-through izmjene --------
+    {
+        GroupIndex index;
+        int loads = 0;
+        auto load = [&] { ++loads; return db.getGroupByName("tim"); };
+
+        auto a = index.find("tim", load);
+        auto b = index.find("tim", load);
+        ok("loaded once", a && b && loads == 1 && a.get() == b.get());
+        ok("index entry", a->group_id == gid && a->leader_urn == leader && a->members.size() == 4);
+        ok("missing group not cached", !index.find("nema", [&] { ++loads; return db.getGroupByName("nema"); }) &&
+                                       !index.find("nema") && loads == 2);
+
+        index.addMembers("tim", {"7000000000014"});
+        auto c = index.find("tim");
+        ok("add members copies entry", c->members.count("7000000000014") && !a->members.count("7000000000014"));
+
+        index.removeMember("tim", "7000000000011");
+        ok("remove member", !index.find("tim")->members.count("7000000000011"));
+
+        index.addMembers("drugi", {"7000000000015"});
+        ok("update of unloaded group ignored", !index.find("drugi") && index.size() == 1);
+
+        index.put("drugi", GroupIndex::Entry{99, "7000000000015", {"7000000000015"}});
+        ok("put", index.find("drugi") && index.find("drugi")->group_id == 99 && index.size() == 2);
+
+        index.erase("drugi");
+        index.clear();
+        ok("clear", index.size() == 0 && index.find("tim", load) && loads == 3);
+
+        // Izmjena dok se grupa čita iz baze: zakašnjeli red se ne pamti
+        index.clear();
+        auto racing = [&] {
+            auto g = db.getGroupByName("tim");
+            index.addMembers("tim", {"7000000000016"});   // upis druge niti, grupa još nije učitana
+            return g;
+        };
+        ok("racing load answered", index.find("tim", racing) != nullptr);
+        ok("racing load not cached", !index.find("tim") && index.size() == 0);
+    }
+
+    db.close();
+    std::remove(db_path.c_str());
+
+    std::cout << "All group index tests passed" << std::endl;
+    return 0;
+}
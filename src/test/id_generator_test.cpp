@@ -0,0 +1,110 @@
+#include "common/Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+// Prvih 10 znakova ULID-a = 48 bita ms (Crockford base32)
+static uint64_t ulidMillis(const std::string& ulid) {
+    static const std::string alphabet = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+    uint64_t ms = 0;
+    for (size_t i = 0; i < 10; ++i) ms = (ms << 5) | alphabet.find(ulid[i]);
+    return ms;
+}
+
+static uint64_t nowMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+int main() {
+    // -------- 1) Format --------
+    {
+        const std::string uuid = Utils::generateUUID();
+        ok("uuid length", uuid.size() == Utils::kUuidLength);
+        ok("uuid dashes", uuid[8] == '-' && uuid[13] == '-' && uuid[18] == '-' && uuid[23] == '-');
+        ok("uuid version 7", uuid[14] == '7');
+        ok("uuid variant 10", std::strchr("89ab", uuid[19]) != nullptr);
+        ok("uuid lowercase hex", std::all_of(uuid.begin(), uuid.end(), [](char c) {
+            return c == '-' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+        }));
+
+        const std::string ulid = Utils::generateULID();
+        ok("ulid length", ulid.size() == Utils::kUlidLength);
+        ok("ulid crockford alphabet", ulid.find_first_not_of("0123456789ABCDEFGHJKMNPQRSTVWXYZ") == std::string::npos);
+        ok("ulid first char <= 7", ulid[0] <= '7');
+        const uint64_t ms = ulidMillis(ulid), now = nowMillis();
+        ok("ulid carries current time", ms <= now && now - ms < 1000);
+
+        const std::string id = Utils::generateId("TKT_");
+        ok("prefixed id", id.size() == 4 + Utils::kUlidLength && id.compare(0, 4, "TKT_") == 0);
+
+        char buf[Utils::kUuidLength + 1];
+        buf[Utils::kUuidLength] = '#';
+        Utils::formatUUID(buf);
+        ok("format into caller buffer", buf[Utils::kUuidLength] == '#' && buf[14] == '7');
+    }
+
+    // -------- 2) Redoslijed: strogo rastući na niti, sortirani po vremenu --------
+    {
+        std::vector<std::string> ulids, uuids;
+        for (int i = 0; i < 20000; ++i) {
+            ulids.push_back(Utils::generateULID());
+            uuids.push_back(Utils::generateUUID());
+        }
+        ok("ulids strictly increasing", std::adjacent_find(ulids.begin(), ulids.end(),
+            [](const std::string& a, const std::string& b) { return a >= b; }) == ulids.end());
+        ok("uuids strictly increasing", std::adjacent_find(uuids.begin(), uuids.end(),
+            [](const std::string& a, const std::string& b) { return a >= b; }) == uuids.end());
+
+        const std::string before = Utils::generateUUID();
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        std::string after;
+        std::thread([&] { after = Utils::generateUUID(); }).join();
+        ok("later id sorts after (other thread)", after > before);
+    }
+
+    // -------- 3) Jedinstvenost preko niti --------
+    {
+        constexpr int kThreads = 4, kPerThread = 50000;
+        std::vector<std::vector<std::string>> out(kThreads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&out, t] {
+                out[t].reserve(kPerThread);
+                for (int i = 0; i < kPerThread; ++i) out[t].push_back(Utils::generateId("TX_"));
+            });
+        }
+        for (auto& th : threads) th.join();
+        std::set<std::string> all;
+        for (auto& v : out) all.insert(v.begin(), v.end());
+        ok("no duplicates across threads", all.size() == static_cast<size_t>(kThreads * kPerThread));
+    }
+
+    // -------- 4) Cijena --------
+    {
+        constexpr int kCount = 200000;
+        char buf[Utils::kUlidLength];
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCount; ++i) Utils::formatULID(buf);
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / kCount;
+        std::cout << "formatULID: " << ns << " ns/id" << std::endl;
+        ok("id generation is cheap", ns < 2000.0);
+    }
+
+    std::cout << "All id generator tests passed" << std::endl;
+    return 0;
+}
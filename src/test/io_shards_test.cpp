@@ -0,0 +1,190 @@
+#include "common/Message.h"
+#include "common/TLSServer.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static int connectMany(int port, int n) {
+    int connected = 0;
+    for (int i = 0; i < n; ++i) {
+        TLSSocket c;
+        if (c.connect("127.0.0.1", port)) connected++;
+        c.close();
+    }
+    return connected;
+}
+
+static uint64_t total(const std::vector<uint64_t>& v) {
+    uint64_t sum = 0;
+    for (auto x : v) sum += x;
+    return sum;
+}
+
+static void waitFor(const TLSServer& server, uint64_t n) {
+    for (int i = 0; i < 200 && total(server.getShardConnections()) < n; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+int main() {
+    // -------- 1) Round-robin: handshake i callback na niti shard-a --------
+    {
+        const int port = pick_port();
+        const int kShards = 4, kClients = 16;
+        TLSServer server;
+        server.setExecutionMode(TLSServer::ExecutionMode::SHARDED, kShards);
+        std::mutex mu;
+        std::set<std::thread::id> threads;
+        server.setConnectionCallback([&](std::unique_ptr<TLSSocket>) {
+            std::lock_guard<std::mutex> lk(mu);
+            threads.insert(std::this_thread::get_id());
+        });
+        ok("server start (sharded)", server.start(port, "certs/server.crt", "certs/server.key"));
+        ok("shard count", server.getShardCount() == kShards && server.getWorkerThreads() == kShards &&
+                          server.getAcceptorCount() == 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        ok("clients connect", connectMany(port, kClients) == kClients);
+        waitFor(server, kClients);
+        const auto per_shard = server.getShardConnections();
+        std::cout << "  per shard:";
+        for (auto n : per_shard) std::cout << " " << n;
+        std::cout << "\n";
+        bool even = per_shard.size() == static_cast<size_t>(kShards);
+        for (auto n : per_shard) even = even && n == kClients / kShards;
+        ok("sockets spread round-robin", even);
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            ok("each shard runs on its own thread", threads.size() == static_cast<size_t>(kShards));
+        }
+        ok("handshake stats", server.getStats().handshakes == static_cast<uint64_t>(kClients));
+        server.stop();
+        ok("no shard stats outside sharded mode", TLSServer().getShardConnections().empty());
+    }
+
+    // -------- 2) CPU pinning --------
+    {
+        const int port = pick_port();
+        const int cpus = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        TLSServer server;
+        server.setExecutionMode(TLSServer::ExecutionMode::SHARDED, 2);
+        server.setCpuAffinity(true);
+        std::mutex mu;
+        std::map<std::thread::id, std::set<int>> masks;
+        server.setConnectionCallback([&](std::unique_ptr<TLSSocket>) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+            std::set<int> cores;
+            for (int c = 0; c < CPU_SETSIZE; ++c) if (CPU_ISSET(c, &set)) cores.insert(c);
+            std::lock_guard<std::mutex> lk(mu);
+            masks[std::this_thread::get_id()] = cores;
+        });
+        ok("server start (pinned)", server.start(port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ok("clients connect", connectMany(port, 4) == 4);
+        waitFor(server, 4);
+        std::set<int> pinned;
+        bool single = true;
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            for (auto& m : masks) {
+                single = single && m.second.size() == 1;
+                if (!m.second.empty()) pinned.insert(*m.second.begin());
+            }
+            ok("both shards served", masks.size() == 2);
+        }
+        ok("each shard pinned to one core", single);
+        ok("shards on distinct cores when available", pinned.size() == static_cast<size_t>(std::min(2, cpus)));
+        server.stop();
+    }
+
+    // -------- 3) SO_REUSEPORT: acceptor po shard-u --------
+    {
+        SocketOptions opts;
+        opts.reuse_port = true;
+        const int port = pick_port();
+        TLSServer server;
+        server.setSocketOptions(opts);
+        server.setExecutionMode(TLSServer::ExecutionMode::SHARDED, 3);
+        server.setConnectionCallback([](std::unique_ptr<TLSSocket>) {});
+        ok("server start (sharded, reuse_port)", server.start(port, "certs/server.crt", "certs/server.key"));
+        ok("acceptor per shard", server.getAcceptorCount() == 3);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ok("clients connect", connectMany(port, 9) == 9);
+        waitFor(server, 9);
+        ok("all handshakes counted", total(server.getShardConnections()) == 9);
+        server.stop();
+    }
+
+    // -------- 4) CentralServer: [server] io_shards -> async sesije na shard-ovima --------
+    {
+        const std::string conf = "test_io_shards.conf";
+        {
+            std::ofstream f(conf);
+            f << "[server]\nworker_pool = false\nio_shards = 2\nio_cpu_affinity = true\n";
+        }
+        ServerConfig cfg;
+        ok("config parsed", cfg.loadFromFile(conf) && cfg.io_shards == 2 && cfg.io_cpu_affinity);
+        std::remove(conf.c_str());
+
+        const std::string db_path = "test_io_shards.db";
+        std::remove(db_path.c_str());
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        server.setIoShards(2, true);
+        ok("central server start (sharded)", server.start(port, ""));
+        ok("async sessions", server.usesAsyncSessions());
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket a, b;
+        ok("two clients", a.connect("127.0.0.1", port) && b.connect("127.0.0.1", port));
+        for (TLSSocket* c : {&a, &b}) {
+            auto m = MessageFactory::createRegisterUser(c == &a ? "2525252525251" : "2525252525252");
+            m->setSequenceId(9);
+            c->sendMessage(*m);
+            auto r = c->receiveMessage();
+            ok("request served on shard", r && r->getSequenceId() == 9);
+        }
+        ok("register device", a.sendMessage(*MessageFactory::createRegisterDevice("bus://25", VehicleType::BUS)) &&
+                              a.receiveMessage() != nullptr);
+        a.close();
+        b.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+        std::remove(db_path.c_str());
+    }
+
+    std::cout << "IO shards test passed.\n";
+    return 0;
+}
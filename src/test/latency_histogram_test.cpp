@@ -0,0 +1,77 @@
+#include "common/LatencyHistogram.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static bool within(uint64_t got, uint64_t want, double rel) {
+    return std::fabs(static_cast<double>(got) - static_cast<double>(want)) <= rel * static_cast<double>(want);
+}
+
+int main() {
+    // -------- 1) Bucketi: tačno ispod 32, zatim ~3% relativne greške --------
+    {
+        bool exact = true, bounded = true, monotonic = true;
+        for (uint64_t v = 0; v < 32; ++v) exact &= LatencyHistogram::upperBound(LatencyHistogram::bucketOf(v)) == v;
+        size_t prev = 0;
+        for (uint64_t v = 32; v < (uint64_t{1} << 36); v = v + v / 7 + 1) {
+            const size_t b = LatencyHistogram::bucketOf(v);
+            const uint64_t ub = LatencyHistogram::upperBound(b);
+            bounded   &= ub >= v && static_cast<double>(ub - v) <= 0.032 * static_cast<double>(v);
+            monotonic &= b >= prev;
+            prev = b;
+        }
+        ok("exact small values", exact);
+        ok("bucket error within 1/32", bounded);
+        ok("buckets monotonic", monotonic);
+        ok("huge values clamp", LatencyHistogram::bucketOf(UINT64_MAX) == LatencyHistogram::kBuckets - 1);
+    }
+
+    // -------- 2) Percentili nad poznatom raspodjelom --------
+    {
+        LatencyHistogram h;
+        for (uint64_t v = 1; v <= 100000; ++v) h.record(v * 1000);   // 1 us .. 100 ms
+        const auto s = h.snapshot();
+        ok("count/min/max", s.count == 100000 && s.min == 1000 && s.max == 100000000);
+        ok("p50", within(s.percentile(0.50), 50000000, 0.035));
+        ok("p99", within(s.percentile(0.99), 99000000, 0.035));
+        ok("p999", within(s.percentile(0.999), 99900000, 0.035));
+        ok("p100 is max", s.percentile(1.0) == s.max);
+        ok("mean", within(static_cast<uint64_t>(s.mean()), 50000500, 1e-6));
+        ok("empty percentile", LatencyHistogram().snapshot().percentile(0.99) == 0);
+    }
+
+    // -------- 3) Više niti + merge --------
+    {
+        LatencyHistogram a, b;
+        std::vector<std::thread> th;
+        for (int t = 0; t < 4; ++t) {
+            th.emplace_back([&a, t] {
+                std::mt19937_64 rng(static_cast<uint64_t>(t));
+                std::uniform_int_distribution<uint64_t> d(1000, 2000);
+                for (int i = 0; i < 50000; ++i) a.record(d(rng));
+            });
+        }
+        for (auto& x : th) x.join();
+        for (int i = 0; i < 1000; ++i) b.record(1000000);   // spori rep
+        auto s = a.snapshot();
+        ok("concurrent records", s.count == 200000 && s.min >= 1000 && s.max <= 2000);
+        s.merge(b.snapshot());
+        ok("merged count", s.count == 201000 && s.max == 1000000);
+        ok("merged tail", within(s.percentile(0.999), 1000000, 0.035) && s.percentile(0.99) <= 2048);
+        a.reset();
+        ok("reset", a.count() == 0 && a.snapshot().percentile(0.5) == 0);
+    }
+
+    std::cout << "Latency histogram test passed.\n";
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "common/Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static size_t countLines(const std::string& path) {
+    std::ifstream in(path);
+    size_t n = 0;
+    for (std::string line; std::getline(in, line); ) ++n;
+    return n;
+}
+
+static size_t fileSize(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+static void removeLogs(const std::string& path) {
+    std::remove(path.c_str());
+    for (int i = 1; i <= 5; ++i) std::remove((path + "." + std::to_string(i)).c_str());
+}
+
+static void hammer(Logger& log, int threads, int per_thread) {
+    std::vector<std::thread> ts;
+    for (int t = 0; t < threads; ++t) {
+        ts.emplace_back([&log, t, per_thread] {
+            for (int i = 0; i < per_thread; ++i) {
+                log.info("thread " + std::to_string(t) + " message " + std::to_string(i));
+            }
+        });
+    }
+    for (auto& th : ts) th.join();
+}
+
+int main() {
+    // Mali red da se prelijevanje desi; konzola isključena zbog količine linija
+    Logger::AsyncOptions opt;
+    opt.queue_size = 64;
+    opt.overflow   = Logger::OverflowPolicy::BLOCK;
+    Logger::configureAsync(opt);
+    Logger::setConsoleOutput(false);
+
+    const int kThreads = 4, kPerThread = 5000;
+
+    // -------- 1) BLOCK: nijedna poruka se ne gubi --------
+    const std::string block_path = "logs/logger_block_test.log";
+    removeLogs(block_path);
+    auto blocking = Logger::getLogger("BlockTest");
+    blocking->initialize(block_path, Logger::LogLevel::INFO);
+    auto t0 = std::chrono::steady_clock::now();
+    hammer(*blocking, kThreads, kPerThread);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    Logger::flush();
+    std::cout << "  async log (4 threads): " << ns / (kThreads * kPerThread) << " ns/msg\n";
+    ok("all lines written", countLines(block_path) == static_cast<size_t>(kThreads * kPerThread));
+    ok("nothing dropped in block mode", Logger::droppedMessages() == 0);
+
+    blocking->debug("below level");
+    Logger::flush();
+    ok("level filter", countLines(block_path) == static_cast<size_t>(kThreads * kPerThread));
+
+    // -------- 2) DROP: zapisane + odbačene = poslane --------
+    opt.overflow = Logger::OverflowPolicy::DROP;
+    Logger::configureAsync(opt);
+    const std::string drop_path = "logs/logger_drop_test.log";
+    removeLogs(drop_path);
+    auto dropping = Logger::getLogger("DropTest");
+    dropping->initialize(drop_path, Logger::LogLevel::INFO);
+    hammer(*dropping, kThreads, kPerThread);
+    Logger::flush();
+    const uint64_t dropped = Logger::droppedMessages();
+    std::cout << "  dropped with 64-slot queue: " << dropped << "\n";
+    ok("written + dropped == sent", countLines(drop_path) + dropped == static_cast<uint64_t>(kThreads * kPerThread));
+
+    // -------- 3) Rotacija po veličini --------
+    opt.overflow = Logger::OverflowPolicy::BLOCK;
+    Logger::configureAsync(opt);
+    const std::string rot_path = "logs/logger_rotate_test.log";
+    removeLogs(rot_path);
+    auto rotating = Logger::getLogger("RotateTest");
+    rotating->initialize(rot_path, Logger::LogLevel::INFO);
+    rotating->setRotation(4096, 2);
+    for (int i = 0; i < 400; ++i) rotating->info("rotation line " + std::to_string(i));
+    Logger::flush();
+    ok("rotated files kept", fileSize(rot_path + ".1") > 0 && fileSize(rot_path + ".2") > 0);
+    ok("older files removed", fileSize(rot_path + ".3") == 0);
+    ok("files within limit", fileSize(rot_path) <= 4096 && fileSize(rot_path + ".1") <= 4096);
+    {
+        std::ifstream in(rot_path);
+        std::string last, line;
+        while (std::getline(in, line)) last = line;
+        ok("newest line in current file", last.find("rotation line 399") != std::string::npos);
+    }
+
+    // -------- 4) Lijeni makroi: argumenti se ne evaluiraju ispod nivoa --------
+    {
+        int evaluated = 0;
+        auto expensive = [&evaluated] { ++evaluated; return std::string("costly"); };
+        rotating->setLogLevel(Logger::LogLevel::INFO);
+        TP_LOG_DEBUG(rotating, "debug ", expensive());
+        ok("disabled level skips arguments", evaluated == 0);
+        const size_t lines = countLines(rot_path);
+        TP_LOG_INFO(rotating, "info ", expensive(), " n=", 42, " ok=", true, " x=", 1.5, ' ', std::string_view("sv"));
+        Logger::flush();
+        ok("enabled level formats once", evaluated == 1 && countLines(rot_path) == lines + 1);
+        std::ifstream in(rot_path);
+        std::string last, line;
+        while (std::getline(in, line)) last = line;
+        ok("logf formatting", last.find("[INFO] [RotateTest] info costly n=42 ok=true x=1.5 sv") != std::string::npos);
+
+        auto t1 = std::chrono::steady_clock::now();
+        const int kSkipped = 1000000;
+        for (int i = 0; i < kSkipped; ++i) TP_LOG_DEBUG(rotating, "skipped ", i, " ", expensive());
+        auto skip_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t1).count();
+        std::cout << "  disabled TP_LOG_DEBUG: " << static_cast<double>(skip_ns) / kSkipped << " ns/call\n";
+        ok("still nothing evaluated", evaluated == 1);
+    }
+
+    // -------- 5) Sinhroni režim (async isključen) --------
+    opt.enabled = false;
+    Logger::configureAsync(opt);
+    rotating->setRotation(0, 0);
+    const size_t before = countLines(rot_path);
+    rotating->warning("sync line");
+    ok("sync write is immediate", countLines(rot_path) == before + 1);
+
+    removeLogs(block_path);
+    removeLogs(drop_path);
+    removeLogs(rot_path);
+    Logger::setConsoleOutput(true);
+    std::cout << "Logger test passed.\n";
+    return 0;
+}
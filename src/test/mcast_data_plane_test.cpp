@@ -0,0 +1,207 @@
+#include "common/McastDatagram.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+int main() {
+    // -------- 1) Datagram: potpis, izmjena, pogrešan ključ --------
+    {
+        const std::string seed = "0123456789abcdef0123456789abcdef";
+        mcast::Signer signer, other;
+        ok("signer from seed", signer.init(seed) && signer.publicKey().size() == mcast::kKeyLength &&
+                               other.init() && other.publicKey() != signer.publicKey());
+        mcast::Signer again;
+        ok("same seed, same key", again.init(seed) && again.publicKey() == signer.publicKey());
+        ok("short seed refused", !again.init("short") && !again.ready());
+        const std::string key = signer.publicKey();
+        auto msg = MessageFactory::createMulticastUpdate("seat_reserved", {{"vehicle_uri", "bus125"}});
+        const auto frame = msg->serialize();
+
+        std::vector<uint8_t> dgram;
+        ok("encode", mcast::encodeDatagram(42, frame.data(), frame.size(), signer, dgram));
+        ok("size", dgram.size() == mcast::kHeaderLength + frame.size() + mcast::kSignatureLength);
+
+        uint64_t seq = 0;
+        const uint8_t* f = nullptr;
+        size_t flen = 0;
+        ok("decode", mcast::decodeDatagram(dgram.data(), dgram.size(), key, seq, f, flen));
+        Message decoded;
+        ok("decoded seq and frame", seq == 42 && flen == frame.size() &&
+                                    decoded.deserialize(f, flen) &&
+                                    decoded.getString("vehicle_uri") == "bus125");
+
+        auto tampered = dgram;
+        tampered[mcast::kHeaderLength + 3] ^= 0x01;
+        ok("tampered payload rejected", !mcast::decodeDatagram(tampered.data(), tampered.size(), key, seq, f, flen));
+        ok("wrong key rejected", !mcast::decodeDatagram(dgram.data(), dgram.size(), other.publicKey(), seq, f, flen));
+        ok("key of wrong size rejected", !mcast::decodeDatagram(dgram.data(), dgram.size(), "other-key", seq, f, flen));
+
+        const std::string discover = "DISCOVER";
+        ok("DISCOVER is not a datagram",
+           !mcast::looksLikeDatagram(reinterpret_cast<const uint8_t*>(discover.data()), discover.size()));
+        std::vector<uint8_t> big(mcast::kMaxDatagram, 0);
+        ok("oversized frame refused", !mcast::encodeDatagram(1, big.data(), big.size(), signer, dgram));
+
+        std::string raw;
+        ok("hex roundtrip", mcast::fromHex(mcast::toHex(seed), raw) && raw == seed && !mcast::fromHex("zz", raw));
+    }
+
+    // -------- 2) Praćenje rednih brojeva --------
+    {
+        mcast::SequenceTracker t;
+        t.reset(10);
+        auto r = t.onSequence(11);
+        ok("in order", r.accept && !r.gap);
+        r = t.onSequence(15);
+        ok("gap 12..14", r.accept && r.gap && r.gap_from == 12 && r.gap_to == 14);
+        ok("duplicate dropped", !t.onSequence(15).accept && !t.onSequence(13).accept);
+        mcast::SequenceTracker fresh;
+        ok("first packet starts the stream", fresh.onSequence(7).accept && fresh.lastSeen() == 7);
+    }
+
+    // -------- 3) CentralServer: seq, ključ u AUTH odgovoru, MCAST_RESYNC preko TLS-a --------
+    std::remove("test_mcast_data.db");
+    const int port  = pick_port();
+    const int mport = pick_port();
+    CentralServer server;
+    server.setDatabasePath("test_mcast_data.db");
+    server.setCertificatePath("certs/server.crt", "certs/server.key");
+    server.setMulticastEnabled(true);
+    server.setMulticastPort(mport);
+    server.setMulticastDataPlane(true);
+    ok("central server start", server.start(port, ""));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    TLSSocket client;
+    ok("client connect", client.connect("127.0.0.1", port));
+    // Data plane nosi V2 okvire: parametre dobija samo klijent koji je dogovorio V2
+    client.sendMessage(*MessageFactory::createConnectRequest("mcast-client", PROTOCOL_V2));
+    auto hello = client.receiveMessage();
+    ok("negotiated v2", hello && parseProtocolVersion(hello->getString("protocol_version")) == PROTOCOL_V2);
+    client.setProtocolVersion(PROTOCOL_V2);
+    const std::string urn = "5555555555555";
+    client.sendMessage(*MessageFactory::createRegisterUser(urn));
+    client.receiveMessage();
+    client.sendMessage(*MessageFactory::createAuthRequest(urn));
+    auto auth = client.receiveMessage();
+    ok("auth", auth && auth->getBool("success"));
+    TLSSocket legacy;
+    std::unique_ptr<Message> legacy_auth;
+
+    if (!auth->hasKey("mcast_key")) {
+        // Bez multicast rute (npr. sandbox) server radi samo preko TLS-a
+        std::cout << "[SKIP] multicast group not available; data plane disabled\n";
+    } else {
+        std::string key;
+        ok("mcast key delivered over TLS", mcast::fromHex(auth->getString("mcast_key"), key) && key.size() == 32);
+        ok("mcast seq starts at 0", auth->getString("mcast_seq") == "0");
+
+        // V1 klijent: bez data plane-a, ista ažuriranja preko TLS-a u V1 okvirima
+        ok("v1 client connect", legacy.connect("127.0.0.1", port));
+        legacy.sendMessage(*MessageFactory::createAuthRequest(urn));
+        legacy_auth = legacy.receiveMessage();
+        ok("v1 client gets no data plane", legacy_auth && legacy_auth->getBool("success") &&
+                                           !legacy_auth->hasKey("mcast_key"));
+
+        // Primalac na grupi (ako loopback multicast radi, provjeri i sam datagram)
+        boost::asio::io_context io;
+        boost::asio::ip::udp::socket usock(io);
+        bool udp_ready = false;
+        try {
+            usock.open(boost::asio::ip::udp::v4());
+            usock.set_option(boost::asio::socket_base::reuse_address(true));
+            usock.bind({boost::asio::ip::udp::v4(), static_cast<unsigned short>(mport)});
+            usock.set_option(boost::asio::ip::multicast::join_group(
+                boost::asio::ip::make_address(auth->getString("mcast_group"))));
+            usock.non_blocking(true);
+            udp_ready = true;
+        } catch (const std::exception&) {}
+
+        for (int i = 0; i < 2; ++i) {
+            client.sendMessage(*MessageFactory::createUpdatePrice(VehicleType::BUS, TicketType::INDIVIDUAL, 1.5 + i));
+            auto r = client.receiveMessage();
+            ok("price update accepted", r && r->getType() == MessageType::RESPONSE_SUCCESS);
+        }
+
+        if (udp_ready) {
+            std::array<uint8_t, mcast::kMaxDatagram> buf{};
+            uint64_t last = 0;
+            for (int i = 0; i < 100 && last < 2; ++i) {
+                boost::system::error_code ec;
+                boost::asio::ip::udp::endpoint from;
+                const size_t n = usock.receive_from(boost::asio::buffer(buf), from, 0, ec);
+                if (ec) { std::this_thread::sleep_for(std::chrono::milliseconds(20)); continue; }
+                uint64_t seq = 0; const uint8_t* f = nullptr; size_t flen = 0;
+                if (mcast::decodeDatagram(buf.data(), n, key, seq, f, flen)) last = seq;
+            }
+            std::cout << (last == 2 ? "[OK] " : "[SKIP] ") << "signed datagrams received over UDP" << std::endl;
+        }
+
+        // Klijent je "propustio" oba paketa: traži ih preko TLS-a
+        client.sendMessage(*MessageFactory::createMcastResync(auth->getString("token"), 1, 5));
+        auto r1 = client.receiveMessage();
+        auto r2 = client.receiveMessage();
+        auto done = client.receiveMessage();
+        ok("replayed in order", r1 && r2 && r1->getType() == MessageType::MULTICAST_UPDATE &&
+                                r1->getString("mcast_seq") == "1" && r2->getString("mcast_seq") == "2" &&
+                                r2->getString("update_type") == "price_updated");
+        ok("resync summary", done && done->getType() == MessageType::RESPONSE_SUCCESS &&
+                             done->getString("replayed") == "2" && done->getString("missing") == "0" &&
+                             done->getString("last_seq") == "2");
+
+        client.sendMessage(*MessageFactory::createMcastResync("no-such-session", 1, 1));
+        auto denied = client.receiveMessage();
+        ok("resync needs a session", denied && denied->getType() == MessageType::RESPONSE_ERROR &&
+                                     denied->getInt("error_code") == 401);
+
+        int over_tls = 0;
+        for (int i = 0; i < 8 && over_tls < 2; ++i) {
+            auto m = legacy.receiveMessage();
+            if (!m) break;
+            if (m->getType() == MessageType::MULTICAST_UPDATE && m->getString("update_type") == "price_updated" &&
+                m->getVersion() == PROTOCOL_V1) {
+                ++over_tls;
+            }
+        }
+        ok("v1 client gets datagram updates over TLS", over_tls == 2);
+        legacy.sendMessage(*MessageFactory::createMcastResync(legacy_auth->getString("token"), 1, 1));
+        auto v1_replay = legacy.receiveMessage();
+        ok("resync frame in negotiated version", v1_replay && v1_replay->getVersion() == PROTOCOL_V1 &&
+                                                 v1_replay->getString("mcast_seq") == "1");
+        legacy.receiveMessage();   // sažetak
+    }
+    legacy.close();
+
+    client.close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    server.stop();
+    std::remove("test_mcast_data.db");
+
+    std::cout << "Multicast data plane test passed.\n";
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "common/BufferPool.h"
+#include "common/Message.h"
+#include "common/SmallVector.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+// Broji globalne alokacije (malloc) ove niti
+static thread_local size_t tls_allocations = 0;
+
+void* operator new(size_t size) {
+    ++tls_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+int main() {
+    // -------- 1) SmallVector --------
+    {
+        SmallVector<std::string, 4> v;
+        for (const char* s : {"d", "b", "a"}) v.push_back(s);
+        ok("inline while within N", v.isInline() && v.size() == 3);
+        v.emplace(v.begin() + 2, "c");
+        ok("insert in the middle", v[0] == "d" && v[1] == "b" && v[2] == "c" && v[3] == "a");
+        v.emplace(v.begin(), std::string(40, 'x'));
+        ok("grows to heap past N", !v.isInline() && v.size() == 5 && v[0].size() == 40 && v[4] == "a");
+        v.erase(v.begin() + 1);
+        ok("erase shifts tail", v.size() == 4 && v[0].size() == 40 && v[1] == "b");
+
+        SmallVector<std::string, 4> copy = v;
+        ok("copy", copy.size() == 4 && copy[3] == "a" && v.size() == 4);
+        SmallVector<std::string, 4> moved = std::move(copy);
+        ok("move takes heap block", moved.size() == 4 && copy.empty() && copy.isInline());
+
+        SmallVector<std::string, 4> small;
+        small.push_back("one");
+        SmallVector<std::string, 4> small_moved = std::move(small);
+        ok("move inline elements", small_moved.size() == 1 && small_moved[0] == "one" && small.empty());
+        moved = std::move(small_moved);
+        ok("move assign", moved.size() == 1 && moved[0] == "one");
+        v.clear();
+        ok("clear keeps capacity", v.empty() && v.capacity() >= 5);
+    }
+
+    // -------- 2) Polja poruke: isti okvir nezavisno od redoslijeda dodavanja --------
+    {
+        Message a(MessageType::RESERVE_SEAT), b(MessageType::RESERVE_SEAT);
+        a.addString("urn", "1234567890123");
+        a.addString("route", "R1");
+        a.addInt("vehicle_type", 1);
+        a.addBool("flag", true);
+        b.addBool("flag", true);
+        b.addInt("vehicle_type", 1);
+        b.addString("route", "R1");
+        b.addString("urn", "1234567890123");
+        ok("wire order independent of insertion order", a.serialize() == b.serialize());
+
+        a.addString("route", "R2");
+        ok("overwrite keeps one field", a.getString("route") == "R2" && a.size() == b.size());
+
+        Message big(MessageType::RESPONSE_SUCCESS);
+        for (int i = 19; i >= 0; --i) big.addInt("k" + std::to_string(100 + i), i);
+        Message back;
+        ok("many fields roundtrip", back.deserialize(big.serialize()) && back.getInt("k100") == 0 &&
+                                    back.getInt("k119") == 19 && back.hasKey("k110") && !back.hasKey("k99"));
+        Message copy = big;
+        ok("message copy", copy.getInt("k115") == 15 && copy.serialize() == big.serialize());
+    }
+
+    // -------- 3) Bez malloc-a u stabilnom stanju --------
+    {
+        // Zagrijavanje: slobodni blokovi ove niti
+        for (int i = 0; i < 4; ++i) {
+            auto e = MessageFactory::createErrorResponse("Invalid session", 401);
+            auto r = MessageFactory::createSuccessResponse("alive");
+            auto h = MessageFactory::createHeartbeat();
+        }
+        const size_t before = tls_allocations;
+        for (int i = 0; i < 1000; ++i) {
+            auto err = MessageFactory::createErrorResponse("Invalid session", 401);
+            auto ok_reply = MessageFactory::createSuccessResponse("alive");
+            auto hb = MessageFactory::createHeartbeat();
+        }
+        const size_t steady = tls_allocations - before;
+        std::cout << "allocations for 3000 fixed-shape replies: " << steady << std::endl;
+        ok("fixed-shape replies do not hit malloc", steady == 0);
+
+        // Poruka oslobođena na drugoj niti: ide u listu te niti, bez greške
+        auto msg = MessageFactory::createHeartbeat();
+        std::thread([m = std::move(msg)]() mutable { m.reset(); }).join();
+        ok("cross-thread free", true);
+    }
+
+    // -------- 4) BufferPool --------
+    {
+        BufferPool pool(2, 1024);
+        auto a = pool.acquire();
+        a.resize(200);
+        const auto* data = a.data();
+        pool.release(std::move(a));
+        auto b = pool.acquire();
+        ok("buffer reused with capacity", b.empty() && b.capacity() >= 200 && b.data() == data && pool.reused() == 1);
+        std::vector<uint8_t> huge(4096);
+        pool.release(std::move(huge));
+        ok("oversized buffer not kept", pool.size() == 0);
+        for (int i = 0; i < 4; ++i) pool.release(std::vector<uint8_t>(16));
+        ok("pool bounded", pool.size() == 2);
+
+        std::vector<uint8_t> frame = pool.acquire();
+        const size_t before = tls_allocations;
+        Message m(MessageType::RESPONSE_SUCCESS);
+        m.addString("message", "ok");
+        m.serializeTo(frame);
+        ok("serialize into pooled buffer", !frame.empty() && tls_allocations - before <= 1);
+    }
+
+    std::cout << "All message arena tests passed" << std::endl;
+    return 0;
+}
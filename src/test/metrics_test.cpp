@@ -0,0 +1,163 @@
+#include "common/Message.h"
+#include "common/Metrics.h"
+#include "common/TLSSocket.h"
+#include "server/AdminServer.h"
+#include "server/CentralServer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+// Prijavljeni klijent između odgovora dobija i MULTICAST_UPDATE poruke
+static std::unique_ptr<Message> call(TLSSocket& sock, std::unique_ptr<Message> m) {
+    if (!sock.sendMessage(*m)) return nullptr;
+    auto reply = sock.receiveMessage();
+    while (reply && reply->getType() == MessageType::MULTICAST_UPDATE) reply = sock.receiveMessage();
+    return reply;
+}
+
+static bool contains(const std::string& text, const std::string& needle) {
+    return text.find(needle) != std::string::npos;
+}
+
+int main() {
+    auto& registry = metrics::Registry::instance();
+
+    // -------- 1) Brojači po nitima, registar, izvoz --------
+    {
+        auto& c = registry.counter("test_events_total", "kind=\"a\"", "Test events");
+        ok("same metric for same name/labels", &c == &registry.counter("test_events_total", "kind=\"a\""));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&] { for (int i = 0; i < 10000; ++i) c.inc(); });
+        }
+        for (auto& t : threads) t.join();
+        ok("striped counter sums all threads", c.value() == 80000);
+
+        auto& g = registry.gauge("test_depth", "", "Test depth");
+        g.set(5);
+        g.add(-2);
+        ok("gauge", g.value() == 3);
+
+        auto& h = registry.histogram("test_latency_seconds", "op=\"x\"", "Test latency");
+        for (int i = 1; i <= 100; ++i) h.record(static_cast<uint64_t>(i) * 1000);   // 1..100 us
+        {
+            metrics::ScopedTimer timer(&h);
+        }
+        ok("scoped timer records", h.count() == 101);
+
+        const std::string text = registry.renderPrometheus();
+        ok("prometheus help/type", contains(text, "# HELP test_events_total Test events\n") &&
+                                   contains(text, "# TYPE test_events_total counter\n"));
+        ok("prometheus counter", contains(text, "test_events_total{kind=\"a\"} 80000\n"));
+        ok("prometheus gauge", contains(text, "test_depth 3\n"));
+        ok("prometheus summary", contains(text, "# TYPE test_latency_seconds summary\n") &&
+                                 contains(text, "test_latency_seconds{op=\"x\",quantile=\"0.99\"}") &&
+                                 contains(text, "test_latency_seconds_count{op=\"x\"} 101\n"));
+
+        std::map<std::string, std::string> flat;
+        registry.collect(flat);
+        ok("flat counter", flat["test_events_total.a"] == "80000");
+        ok("flat histogram", flat["test_latency_seconds.x.count"] == "101" &&
+                             std::atof(flat["test_latency_seconds.x.p50_us"].c_str()) >= 45.0 &&
+                             std::atof(flat["test_latency_seconds.x.p50_us"].c_str()) <= 55.0);
+
+        registry.setEnabled(false);
+        {
+            metrics::ScopedTimer timer(&h);
+        }
+        registry.setEnabled(true);
+        ok("disabled registry skips timers", h.count() == 101);
+    }
+
+    // -------- 2) CentralServer GET_STATS (direktno i preko AdminServer-a) --------
+    const std::string db_path = "test_metrics.db";
+    std::remove(db_path.c_str());
+    const int central_port = pick_port();
+    const int admin_port   = pick_port() + 1;
+    {
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("central start", central.start(central_port, ""));
+
+        AdminServer admin_server;
+        admin_server.setCertificates("certs/server.crt", "certs/server.key");
+        admin_server.setCentralServer("127.0.0.1", central_port);
+        ok("admin start", admin_server.start(admin_port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket client, admin;
+        ok("connect", client.connect("127.0.0.1", central_port) && admin.connect("127.0.0.1", admin_port));
+
+        const std::string urn = "7171717171717";
+        call(client, MessageFactory::createRegisterUser(urn));
+        auto auth = call(client, MessageFactory::createAuthRequest(urn));
+        ok("auth", auth && auth->getBool("success"));
+        call(client, MessageFactory::createRegisterDevice("bus://71", VehicleType::BUS));
+        call(client, MessageFactory::createUpdateVehicle("bus://71", true, std::string("R71")));
+        for (int i = 0; i < 5; ++i) {
+            auto r = MessageFactory::createReserveSeat(VehicleType::BUS, "R71");
+            r->addString("urn", urn);
+            call(client, std::move(r));
+        }
+        auto bad = call(client, std::make_unique<Message>(MessageType::UPDATE_PRICE));   // bez polja -> 400
+        ok("error response", bad && bad->getType() == MessageType::RESPONSE_ERROR);
+
+        auto stats = call(client, MessageFactory::createGetStats());
+        ok("GET_STATS", stats && stats->getType() == MessageType::RESPONSE_SUCCESS && !stats->hasKey("text"));
+        ok("per-handler histogram", stats->getString("tp_handler_seconds.RESERVE_SEAT.count") == "5" &&
+                                    stats->hasKey("tp_handler_seconds.RESERVE_SEAT.p99_us") &&
+                                    stats->getString("tp_handler_seconds.AUTH_REQUEST.count") == "1");
+        ok("statement timing", std::atoi(stats->getString("tp_db_statement_seconds.count").c_str()) > 0);
+        ok("pool wait", std::atoi(stats->getString("tp_db_pool_wait_seconds.count").c_str()) > 0);
+        ok("error counter", std::atoi(stats->getString("tp_error_responses_total.CentralServer").c_str()) >= 1);
+        ok("system gauges", stats->getString("tp_active_sessions") == "1" &&
+                            stats->getString("tp_inventory_vehicles") == "1" &&
+                            stats->getString("tp_broadcast_subscribers") == "1");
+
+        ok("active users", central.getActiveUsers() == std::vector<std::string>{urn});
+        const auto capacity = central.getVehicleCapacityStatus();
+        ok("capacity by type", capacity.count(VehicleType::BUS) && capacity.at(VehicleType::BUS) > 0);
+
+        auto prom = call(admin, MessageFactory::createGetStats("prometheus"));
+        ok("GET_STATS via admin", prom && prom->getType() == MessageType::RESPONSE_SUCCESS);
+        const std::string text = prom->getString("text");
+        ok("prometheus handler summary", contains(text, "# TYPE tp_handler_seconds summary\n") &&
+                                         contains(text, "tp_handler_seconds_count{type=\"RESERVE_SEAT\"} 5\n"));
+        ok("prometheus gauges", contains(text, "tp_active_sessions 1\n") && contains(text, "# TYPE tp_db_statement_seconds summary\n"));
+
+        ok("broadcast fan-out timed", registry.histogram("tp_broadcast_delivery_seconds").count() > 0 &&
+                                      registry.histogram("tp_broadcast_queue_depth").count() > 0);
+
+        client.close();
+        admin.close();
+        admin_server.stop();
+        central.stop();
+    }
+    std::remove(db_path.c_str());
+
+    std::cout << "All metrics tests passed" << std::endl;
+    return 0;
+}
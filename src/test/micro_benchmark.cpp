@@ -0,0 +1,234 @@
+#include "common/Crc32.h"
+#include "common/Database.h"
+#include "common/Logger.h"
+#include "common/McastDatagram.h"
+#include "common/Message.h"
+#include "common/PriceCache.h"
+#include "common/Utils.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace transport;
+
+// Mikro-benchmark vrućih putanja (Google Benchmark). Primjeri:
+//   micro_benchmark --benchmark_filter=Message
+//   micro_benchmark --benchmark_format=json --benchmark_out=before.json
+// Poruke imaju broj polja kao stvarni zahtjevi/odgovori (range(0) = broj polja,
+// range(1) = verzija protokola); Database koristi fajl u radnom direktoriju.
+
+namespace {
+
+// RESERVE_SEAT ~6 polja, PURCHASE_TICKET ~8, cjenovnik ~14; veće poruke dopunjene poljima
+std::unique_ptr<Message> makeMessage(int fields) {
+    auto m = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "R_42", 2);
+    m->addString("urn", "1234567890123");
+    m->addString("session_id", "4f1c2b9a7d3e4c5f8a9b0c1d2e3f4a5b");
+    for (int i = 6; i < fields; ++i) {   // factory + urn/session_id = 6 polja
+        if (i % 3 == 0) m->addInt("n" + std::to_string(i), i * 7);
+        else if (i % 3 == 1) m->addDouble("d" + std::to_string(i), i * 0.25);
+        else m->addString("s" + std::to_string(i), "value_" + std::to_string(i));
+    }
+    m->setSequenceId(42);
+    m->calculateChecksum();
+    return m;
+}
+
+void MessageArgs(benchmark::internal::Benchmark* b) {
+    for (int v : {static_cast<int>(PROTOCOL_V1), static_cast<int>(PROTOCOL_V2)}) {
+        for (int f : {6, 16, 64}) b->Args({f, v});
+    }
+}
+
+void BM_MessageSerialize(benchmark::State& state) {
+    const auto m = makeMessage(static_cast<int>(state.range(0)));
+    const auto version = static_cast<uint16_t>(state.range(1));
+    std::vector<uint8_t> out;
+    for (auto _ : state) {
+        out.clear();
+        m->serializeTo(out, version);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * out.size()));
+}
+BENCHMARK(BM_MessageSerialize)->Apply(MessageArgs);
+
+void BM_MessageDeserialize(benchmark::State& state) {
+    const auto m = makeMessage(static_cast<int>(state.range(0)));
+    std::vector<uint8_t> frame;
+    m->serializeTo(frame, static_cast<uint16_t>(state.range(1)));
+    for (auto _ : state) {
+        Message out;
+        benchmark::DoNotOptimize(out.deserialize(frame.data(), frame.size()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+BENCHMARK(BM_MessageDeserialize)->Apply(MessageArgs);
+
+void BM_MessageViewParse(benchmark::State& state) {
+    const auto m = makeMessage(static_cast<int>(state.range(0)));
+    std::vector<uint8_t> frame;
+    m->serializeTo(frame, static_cast<uint16_t>(state.range(1)));
+    MessageView view;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view.parse(frame.data(), frame.size()));
+        benchmark::DoNotOptimize(view.getString("session_id"));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+BENCHMARK(BM_MessageViewParse)->Apply(MessageArgs);
+
+void BM_PriceListResponse(benchmark::State& state) {
+    PriceSnapshot prices;
+    std::vector<uint8_t> out;
+    for (auto _ : state) {
+        auto m = MessageFactory::createPriceList(prices);
+        out.clear();
+        m->serializeTo(out, PROTOCOL_V2);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_PriceListResponse);
+
+// ---------------- CRC32 ----------------
+
+std::vector<uint8_t> randomBytes(size_t n) {
+    std::mt19937 gen(42);
+    std::vector<uint8_t> buf(n);
+    for (auto& b : buf) b = static_cast<uint8_t>(gen());
+    return buf;
+}
+
+void BM_Crc32(benchmark::State& state) {
+    const auto buf = randomBytes(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(Crc32::compute(buf.data(), buf.size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buf.size()));
+    state.SetLabel(Crc32::implementation());
+}
+BENCHMARK(BM_Crc32)->Arg(64)->Arg(512)->Arg(4096)->Arg(65536);
+
+void BM_Crc32Bitwise(benchmark::State& state) {
+    const auto buf = randomBytes(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(Crc32::bitwise(buf.data(), buf.size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buf.size()));
+}
+BENCHMARK(BM_Crc32Bitwise)->Arg(512);
+
+// ---------------- Multicast datagram (Ed25519 potpis) ----------------
+
+void BM_McastEncodeDatagram(benchmark::State& state) {
+    std::vector<uint8_t> frame;
+    makeMessage(16)->serializeTo(frame, PROTOCOL_V2);
+    mcast::Signer signer;
+    signer.init(std::string(mcast::kKeyLength, 'k'));
+    std::vector<uint8_t> dgram;
+    uint64_t seq = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mcast::encodeDatagram(++seq, frame.data(), frame.size(), signer, dgram));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+BENCHMARK(BM_McastEncodeDatagram);
+
+// ---------------- ID-jevi (karta/transakcija po putniku) ----------------
+
+void BM_GenerateTicketId(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(Utils::generateId("TKT_"));
+}
+BENCHMARK(BM_GenerateTicketId);
+
+void BM_GenerateUUID(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(Utils::generateUUID());
+}
+BENCHMARK(BM_GenerateUUID);
+
+// ---------------- Database ----------------
+
+class DatabaseFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State&) override {
+        if (db_) return;
+        std::remove(kPath);
+        db_ = std::make_unique<Database>();
+        if (!db_->initialize(kPath)) return;
+        for (int i = 0; i < kVehicles; ++i) {
+            db_->registerVehicle(Vehicle{uri(i), VehicleType::BUS, 60, 60, "R" + std::to_string(i % 20), true, ""});
+        }
+    }
+    static std::string uri(int i) { return "bus://bench/" + std::to_string(i); }
+
+protected:
+    static constexpr const char* kPath = "micro_benchmark.db";
+    static constexpr int kVehicles = 1000;
+    static std::unique_ptr<Database> db_;
+};
+std::unique_ptr<Database> DatabaseFixture::db_;
+
+BENCHMARK_F(DatabaseFixture, GetVehicle)(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        auto v = db_->getVehicle(uri(i++ % kVehicles));
+        benchmark::DoNotOptimize(v.get());
+    }
+}
+
+BENCHMARK_F(DatabaseFixture, UpdateSeatAvailability)(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db_->updateSeatAvailability(uri(i % kVehicles), i % 60));
+        ++i;
+    }
+}
+
+// Write-behind flush iz SeatInventory: 64 vozila u jednoj transakciji
+BENCHMARK_F(DatabaseFixture, UpdateSeatAvailabilityBatch64)(benchmark::State& state) {
+    std::vector<std::pair<std::string, int>> seats;
+    for (int i = 0; i < 64; ++i) seats.emplace_back(uri(i), i % 60);
+    for (auto _ : state) benchmark::DoNotOptimize(db_->updateSeatAvailabilityBatch(seats));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * seats.size()));
+}
+
+// ---------------- Logger ----------------
+
+std::shared_ptr<Logger> benchLogger() {
+    static auto logger = [] {
+        auto l = Logger::getLogger("MicroBenchmark");
+        Logger::setConsoleOutput(false);
+        l->initialize("micro_benchmark.log", Logger::LogLevel::INFO);
+        return l;
+    }();
+    return logger;
+}
+
+void BM_LoggerInfo(benchmark::State& state) {
+    auto logger = benchLogger();
+    int i = 0;
+    for (auto _ : state) logger->info("RESERVE_SEAT ok: uri=bus://42, seat=" + std::to_string(++i));
+    Logger::flush();
+}
+BENCHMARK(BM_LoggerInfo);
+
+void BM_LoggerFormatted(benchmark::State& state) {
+    auto logger = benchLogger();
+    int i = 0;
+    for (auto _ : state) TP_LOG_INFO(logger, "RESERVE_SEAT ok: uri=", "bus://42", ", seat=", ++i);
+    Logger::flush();
+}
+BENCHMARK(BM_LoggerFormatted);
+
+// Isključen nivo: cijena provjere bez formatiranja poruke
+void BM_LoggerFilteredDebug(benchmark::State& state) {
+    auto logger = benchLogger();
+    int i = 0;
+    for (auto _ : state) TP_LOG_DEBUG(logger, "RESERVE_SEAT req: urn=", "1234567890123", ", i=", ++i);
+}
+BENCHMARK(BM_LoggerFilteredDebug);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,230 @@
+#include "client/OfflineQueue.h"
+#include "client/PaymentDevice.h"
+#include "common/Database.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::vector<uint8_t> bytes(const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); }
+static std::string text(const std::vector<uint8_t>& b) { return std::string(b.begin(), b.end()); }
+
+// Prepiše bajt u fajlu (simulacija pokidanog upisa)
+static void corrupt(const std::string& path, long offset) {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(offset);
+    char c = 0;
+    f.get(c);
+    f.seekp(offset);
+    f.put(static_cast<char>(c ^ 0x5A));
+}
+
+static bool request(TLSSocket& sock, const Message& m) {
+    if (!sock.sendMessage(m)) return false;
+    auto r = sock.receiveMessage();
+    return r && r->getType() == MessageType::RESPONSE_SUCCESS;
+}
+
+static std::unique_ptr<Message> purchase(const std::string& urn) {
+    auto m = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "R_7", 1);
+    m->addString("urn", urn);
+    return m;
+}
+
+int main() {
+    const std::string qpath = "test_offline_queue.bin";
+    std::remove(qpath.c_str());
+
+    // -------- 1) FIFO, perzistencija kroz ponovno otvaranje --------
+    {
+        OfflineQueue q;
+        ok("open fresh", q.open(qpath, 4096) && q.empty());
+        ok("append", q.append(bytes("one")) == 1 && q.append(bytes("two")) == 2 && q.append(bytes("three")) == 3);
+        auto head = q.peek(2);
+        ok("peek oldest", head.size() == 2 && text(head[0].payload) == "one" && head[1].id == 2 && q.size() == 3);
+        ok("pop", q.pop(1) == 1 && text(q.peek(1)[0].payload) == "two");
+        q.close();
+
+        ok("reopen", q.open(qpath, 1u << 20) && q.size() == 2);
+        ok("capacity kept from file", q.getStats().capacity == 4096);
+        ok("ids continue", q.append(bytes("four")) == 4 && text(q.peek(3)[2].payload) == "four");
+        ok("pop all", q.pop(10) == 3 && q.empty());
+        q.close();
+        ok("empty after reopen", q.open(qpath) && q.empty() && q.append(bytes("five")) == 5);
+    }
+    std::remove(qpath.c_str());
+
+    // -------- 2) Ring: prelazak preko kraja, pun red --------
+    {
+        OfflineQueue q;
+        ok("open small", q.open(qpath, 4096));
+        const std::vector<uint8_t> rec(1000, 0xAB);          // 1016 B sa zaglavljem
+        int appended = 0;
+        while (q.append(rec) != 0) ++appended;
+        ok("bounded", appended == 4 && q.getStats().rejected_full == 1 && q.lastError() == "queue full");
+
+        uint64_t next_id = 5;
+        for (int lap = 0; lap < 20; ++lap) {                 // zapisi prelaze kraj fajla
+            if (q.pop(1) != 1) ok("pop in lap", false);
+            std::vector<uint8_t> r(1000 - lap, static_cast<uint8_t>(lap));
+            if (q.append(r) != next_id++) ok("append in lap", false);
+        }
+        ok("wraps", q.size() == 4 && q.getStats().bytes_used <= 4096);
+        q.close();
+
+        ok("reopen wrapped", q.open(qpath) && q.size() == 4);
+        auto all = q.peek(10);
+        ok("order across wrap", all.size() == 4 && all.front().id == next_id - 4 && all.back().id == next_id - 1 &&
+                                all.back().payload.size() == 981 && all.back().payload[0] == 19);
+        ok("too large", q.append(std::vector<uint8_t>(5000)) == 0);
+    }
+    std::remove(qpath.c_str());
+
+    // -------- 3) Pokidan zadnji zapis i pokidan slot stanja --------
+    {
+        OfflineQueue q;
+        ok("open torn", q.open(qpath, 4096));
+        q.append(bytes("aaaa"));
+        q.append(bytes("bbbb"));
+        q.append(bytes("cccc"));                              // zapisi po 24 B od 128
+        q.close();
+        corrupt(qpath, 128 + 2 * 24 + 16);                    // payload trećeg
+        ok("torn tail dropped", q.open(qpath) && q.size() == 2 && text(q.peek(2)[1].payload) == "bbbb");
+        ok("append after recovery", q.append(bytes("dddd")) == 3 && text(q.peek(3)[2].payload) == "dddd");
+
+        ok("pop before torn slot", q.pop(1) == 1);            // novo stanje u drugom slotu
+        q.close();
+        corrupt(qpath, 64);                                   // jedan od slotova
+        corrupt(qpath, 96);                                   // i drugi -> nema ispravnog
+        OfflineQueue broken;
+        ok("no valid slot rejected", !broken.open(qpath));
+        corrupt(qpath, 96);                                   // vrati drugi slot
+        ok("older state after torn slot", q.open(qpath) && q.size() >= 2);
+    }
+    std::remove(qpath.c_str());
+
+    // -------- 4) PaymentDevice: kupovine van mreže, drain u BATCH, bez dvostruke naplate --------
+    const std::string db_path = "test_offline_queue.db";
+    const std::string urn     = "7777777777777";
+    std::remove(db_path.c_str());
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("server start", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket admin;
+        ok("admin connect", admin.connect("127.0.0.1", port));
+        ok("register vehicle", request(admin, *MessageFactory::createRegisterDevice("bus://7", VehicleType::BUS)));
+        ok("route", request(admin, *MessageFactory::createUpdateVehicle("bus://7", true, std::string("R_7"))));
+        ok("capacity", request(admin, *MessageFactory::createUpdateCapacity("bus://7", 10, 10)));
+        request(admin, *MessageFactory::createRegisterUser(urn));
+
+        PaymentDevice device;
+        device.setDeviceUri("dev://7/" + std::string(80, 'x'));   // ključ ne smije nositi cijeli URI
+        ok("queue enabled", device.enableOfflineQueue(qpath, 64 * 1024));
+
+        // Bez veze: tri kupovine u redu
+        for (int i = 0; i < 3; ++i) {
+            auto r = device.submitPurchase(purchase(urn)).get();
+            ok("queued offline", r && r->getString("queued") == "1" && !r->getString("idempotency_key").empty() &&
+                                 r->getString("idempotency_key").size() <= 64);
+        }
+        ok("three pending", device.offlineQueueSize() == 3);
+
+        // connect() prazni red u pozadini
+        ok("device connect", device.connect("127.0.0.1", port));
+        for (int i = 0; i < 200 && device.offlineQueueSize() > 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ok("queue drained", device.offlineQueueSize() == 0);
+
+        auto online = device.submitPurchase(purchase(urn)).get();
+        ok("online purchase", online && online->getType() == MessageType::RESPONSE_SUCCESS &&
+                              online->getString("available_seats") == "6");
+
+        // Ista kupovina ponovo (npr. odgovor izgubljen): server je prepoznaje po ključu
+        auto again = purchase(urn);
+        again->addString("idempotency_key", "dev7-retry");
+        auto first  = device.sendRequest(std::make_unique<Message>(*again)).get();
+        auto second = device.sendRequest(std::make_unique<Message>(*again)).get();
+        ok("first keyed purchase", first && first->getString("available_seats") == "5");
+        ok("duplicate not charged", second && second->getType() == MessageType::RESPONSE_SUCCESS &&
+                                    second->getString("duplicate") == "1" &&
+                                    second->getString("transaction_id") == "IK-dev7-retry");
+
+        std::vector<std::unique_ptr<Message>> items;
+        items.push_back(std::make_unique<Message>(*again));
+        items.push_back(purchase(urn));
+        auto batch = device.sendRequest(MessageFactory::createBatch(items)).get();
+        ok("duplicate in batch", batch && batch->getString("status") == "208,200");
+
+        // Isti ključ dok prvi pokušaj još nije upisan: 425 (ponovi), ne 208
+        auto twice = purchase(urn);
+        twice->addString("idempotency_key", "dev7-inflight");
+        std::vector<std::unique_ptr<Message>> pair;
+        pair.push_back(std::make_unique<Message>(*twice));
+        pair.push_back(std::make_unique<Message>(*twice));
+        auto inflight = device.sendRequest(MessageFactory::createBatch(pair)).get();
+        ok("in-flight duplicate retryable", inflight && inflight->getString("status") == "200,425");
+
+        device.disconnect();
+        admin.close();
+        server.stop();
+    }
+    {
+        // Ključevi van memorije (restart): dvostruka kupovina se prepoznaje po transaction_id u bazi
+        Database db;
+        ok("db reopen", db.initialize(db_path));
+        ok("keyed payment stored", db.getPayment("IK-dev7-retry") != nullptr);
+        size_t payments = db.forEachPayment([](const Payment&) { return true; });
+        ok("one payment per purchase", payments == 7);
+        db.close();
+
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("server restart", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        TLSSocket c;
+        ok("connect after restart", c.connect("127.0.0.1", port));
+        auto again = purchase(urn);
+        again->addString("idempotency_key", "dev7-retry");
+        c.sendMessage(*again);
+        auto dup = c.receiveMessage();
+        ok("duplicate after restart", dup && dup->getString("duplicate") == "1");
+        c.close();
+        server.stop();
+    }
+    std::remove(db_path.c_str());
+    std::remove(qpath.c_str());
+
+    std::cout << "All offline queue tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "client/PaymentDevice.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static bool ready(std::future<std::unique_ptr<Message>>& f) {
+    return f.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+}
+
+// Više zahtjeva poslanih odjednom; odgovori nose sequence_id zahtjeva, redom
+static void pipelineRaw(int port, const char* label) {
+    TLSSocket c;
+    ok(label, c.connect("127.0.0.1", port));
+    std::vector<std::unique_ptr<Message>> reqs;
+    reqs.push_back(MessageFactory::createRegisterDevice("bus://7", VehicleType::BUS));
+    reqs.push_back(MessageFactory::createUpdateVehicle("bus://7", true, std::string("R_7")));
+    reqs.push_back(MessageFactory::createUpdateCapacity("bus://7", 20, 20));
+    reqs.push_back(MessageFactory::createRegisterUser("7777777777777"));
+    uint32_t seq = 500;
+    for (auto& r : reqs) {
+        r->setSequenceId(seq++);
+        ok("pipelined send", c.sendMessage(*r));
+    }
+    bool matched = true;
+    for (uint32_t expect = 500; expect < seq; ++expect) {
+        auto resp = c.receiveMessage();
+        matched = matched && resp && resp->getSequenceId() == expect;
+    }
+    ok("responses echo sequence_id in order", matched);
+
+    // Zahtjev bez sequence_id (stari klijent) -> odgovor sa 0
+    c.sendMessage(*MessageFactory::createHeartbeat());
+    auto hb = c.receiveMessage();
+    ok("legacy request keeps sequence_id 0", hb && hb->getSequenceId() == 0);
+    c.close();
+}
+
+int main() {
+    const std::string db_path = "test_pipelining.db";
+    std::remove(db_path.c_str());
+
+    // -------- 1) Nit po konekciji --------
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("server start", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        pipelineRaw(port, "connect (thread per connection)");
+
+        // -------- 2) PaymentDevice: register/auth/purchase u letu istovremeno --------
+        PaymentDevice dev;
+        ok("device connect", dev.connect("127.0.0.1", port));
+        const std::string urn = "8888888888888";
+        auto reg  = dev.sendRequest(MessageFactory::createRegisterUser(urn));
+        auto auth = dev.sendRequest(MessageFactory::createAuthRequest(urn));
+        auto buy_msg = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "R_7", 1);
+        buy_msg->addString("urn", urn);
+        auto buy  = dev.sendRequest(std::move(buy_msg));
+
+        ok("futures resolve", ready(reg) && ready(auth) && ready(buy));
+        auto r = reg.get(), a = auth.get(), b = buy.get();
+        ok("register answered", r != nullptr);
+        ok("auth answered", a && a->getBool("success"));
+        ok("purchase answered", b && b->getType() == MessageType::RESPONSE_SUCCESS);
+        ok("pending table empty", dev.pendingRequests() == 0);
+
+        // Callback varijanta
+        std::promise<bool> got;
+        auto got_f = got.get_future();
+        ok("callback request sent", dev.sendRequest(MessageFactory::createHeartbeat(),
+            [&got](std::unique_ptr<Message> m) { got.set_value(m != nullptr); }));
+        ok("callback invoked", got_f.wait_for(std::chrono::seconds(5)) == std::future_status::ready && got_f.get());
+
+        dev.disconnect();
+        auto late = dev.sendRequest(MessageFactory::createHeartbeat());
+        ok("request after disconnect fails fast", ready(late) && late.get() == nullptr);
+
+        server.stop();
+    }
+
+    // -------- 3) Worker pool (async sesije) --------
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        server.setWorkerPool(true, 2);
+        ok("server start (worker pool)", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        pipelineRaw(port, "connect (worker pool)");
+        server.stop();
+    }
+    std::remove(db_path.c_str());
+
+    std::cout << "Pipelining test passed.\n";
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "common/Message.h"
+#include "common/PriceCache.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static bool near(double a, double b) { return std::fabs(a - b) < 1e-9; }
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::unique_ptr<Message> priceUpdated(VehicleType vt, TicketType tt, double price, uint64_t version) {
+    return MessageFactory::createMulticastUpdate("price_updated", {
+        {"vehicle_type",  std::to_string(static_cast<int>(vt))},
+        {"ticket_type",   std::to_string(static_cast<int>(tt))},
+        {"price",         std::to_string(price)},
+        {"price_version", std::to_string(version)}
+    });
+}
+
+// Preskoči MULTICAST_UPDATE do odgovora na zahtjev
+static std::unique_ptr<Message> nextResponse(TLSSocket& sock, PriceCache* prices = nullptr) {
+    for (int i = 0; i < 20; ++i) {
+        auto m = sock.receiveMessage();
+        if (!m) return nullptr;
+        if (m->getType() != MessageType::MULTICAST_UPDATE) return m;
+        if (prices) prices->applyUpdate(*m);
+    }
+    return nullptr;
+}
+
+int main() {
+    // -------- 1) Snapshot: ravni niz po (vozilo, karta) --------
+    {
+        PriceSnapshot s;
+        ok("default fare", near(s.ticketPrice(VehicleType::TRAM, TicketType::GROUP_TOURIST), PriceSnapshot::kDefaultFare));
+        ok("out of range type", s.find(static_cast<VehicleType>(9), TicketType::INDIVIDUAL) == nullptr &&
+                                near(s.ticketPrice(static_cast<VehicleType>(9), TicketType::INDIVIDUAL), PriceSnapshot::kDefaultFare));
+        PriceSnapshot::Fare f;
+        f.base_price = 2.0; f.distance_multiplier = 0.5; f.time_multiplier = 0.1;
+        ok("set fare", s.setFare(VehicleType::BUS, TicketType::GROUP_FAMILY, f));
+        ok("fare formula", near(s.ticketPrice(VehicleType::BUS, TicketType::GROUP_FAMILY, 2.0, 10.0), 2.0 + 1.0 + 1.0));
+        ok("other cells untouched", near(s.ticketPrice(VehicleType::TRAM, TicketType::GROUP_FAMILY), 1.0));
+        s.setGroupDiscount(TicketType::GROUP_FAMILY, 0.15);
+        s.setGroupDiscount(TicketType::GROUP_TOURIST, 3.0);
+        ok("group discount", near(s.groupDiscount(TicketType::GROUP_FAMILY), 0.15) &&
+                             near(s.groupDiscount(TicketType::GROUP_TOURIST), 1.0) &&
+                             near(s.groupDiscount(TicketType::INDIVIDUAL), 0.0));
+        PriceList row{VehicleType::BUS, TicketType::GROUP_FAMILY, 3.0, 1.0, 1.0, ""};
+        s.applyRows({row});
+        ok("db row overrides base price only", near(s.ticketPrice(VehicleType::BUS, TicketType::GROUP_FAMILY, 2.0, 10.0), 3.0 + 1.0 + 1.0));
+    }
+
+    // -------- 2) PriceCache: kopija pri upisu, stari snapshot ostaje nepromijenjen --------
+    {
+        PriceCache cache;
+        auto before = cache.get();
+        auto after  = cache.update(VehicleType::BUS, TicketType::INDIVIDUAL, 2.5);
+        ok("update publishes new version", cache.get() == after && after->version() == before->version() + 1);
+        ok("old snapshot immutable", near(before->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 1.0) &&
+                                     near(after->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 2.5));
+
+        // Klijentska kopija: redoslijed update-a nije bitan (verzija po cijeni)
+        PriceCache client;
+        ok("apply newer", client.applyUpdate(*priceUpdated(VehicleType::TRAM, TicketType::INDIVIDUAL, 2.0, 10)));
+        ok("stale ignored", !client.applyUpdate(*priceUpdated(VehicleType::TRAM, TicketType::INDIVIDUAL, 1.8, 9)));
+        ok("other cell independent", client.applyUpdate(*priceUpdated(VehicleType::BUS, TicketType::INDIVIDUAL, 1.2, 5)));
+        ok("client prices", near(client.get()->ticketPrice(VehicleType::TRAM, TicketType::INDIVIDUAL), 2.0) &&
+                            near(client.get()->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 1.2));
+        ok("non-price update ignored", !client.applyUpdate(*MessageFactory::createMulticastUpdate("seat_reserved", {})));
+    }
+
+    // -------- 3) Čitaoci bez brave dok pisac mijenja cijene --------
+    {
+        PriceCache cache;
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> reads{0}, bad{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&] {
+                uint64_t last = 0;
+                while (!stop) {
+                    auto s = cache.get();
+                    const double p = s->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL);
+                    if (s->version() < last || p < 1.0) bad++;
+                    last = s->version();
+                    reads++;
+                }
+            });
+        }
+        while (reads < 4) std::this_thread::yield();    // čitaoci su pokrenuti
+        auto t0 = std::chrono::steady_clock::now();
+        const int kWrites = 20000;
+        for (int i = 1; i <= kWrites; ++i) cache.update(VehicleType::BUS, TicketType::INDIVIDUAL, 1.0 + i);
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+        stop = true;
+        for (auto& th : readers) th.join();
+        std::cout << "  " << kWrites << " swaps in " << us << " us, " << reads.load() << " lock-free reads\n";
+        ok("readers saw monotonic, valid snapshots", bad == 0 && reads > 0);
+        ok("last write visible", near(cache.get()->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 1.0 + kWrites));
+    }
+
+    // -------- 4) CentralServer: UPDATE_PRICE -> snapshot, broadcast i cijena kupovine --------
+    const std::string db_path = "test_price_cache.db";
+    std::remove(db_path.c_str());
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("server start", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket admin, client;
+        ok("connect", admin.connect("127.0.0.1", port) && client.connect("127.0.0.1", port));
+        admin.sendMessage(*MessageFactory::createRegisterDevice("bus://42", VehicleType::BUS));
+        nextResponse(admin);
+        admin.sendMessage(*MessageFactory::createUpdateVehicle("bus://42", true, std::string("R_42")));
+        nextResponse(admin);
+        admin.sendMessage(*MessageFactory::createUpdateCapacity("bus://42", 10, 10));
+        nextResponse(admin);
+
+        const std::string urn = "4242424242424";
+        client.sendMessage(*MessageFactory::createRegisterUser(urn));
+        nextResponse(client);
+        client.sendMessage(*MessageFactory::createAuthRequest(urn));
+        auto auth = nextResponse(client);
+        ok("auth", auth && auth->getBool("success"));
+        // Pretplata se upisuje nakon AUTH odgovora
+        for (int i = 0; i < 100 && server.getBroadcastStats().subscribers == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        const uint64_t v0 = server.getPrices()->version();
+        admin.sendMessage(*MessageFactory::createUpdatePrice(VehicleType::BUS, TicketType::INDIVIDUAL, 2.5));
+        auto upd = nextResponse(admin);
+        ok("price update accepted", upd && upd->getType() == MessageType::RESPONSE_SUCCESS);
+        ok("server snapshot swapped", server.getPrices()->version() == v0 + 1 &&
+                                      near(server.getPrices()->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 2.5));
+
+        admin.sendMessage(*MessageFactory::createUpdatePrice(static_cast<VehicleType>(7), TicketType::INDIVIDUAL, 1.0));
+        auto bad = nextResponse(admin);
+        ok("unknown type rejected", bad && bad->getType() == MessageType::RESPONSE_ERROR);
+
+        // Pretplaćeni klijent dobija price_updated i osvježava svoju kopiju
+        PriceCache local;
+        for (int i = 0; i < 10 && !near(local.get()->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 2.5); ++i) {
+            auto m = client.receiveMessage();
+            if (!m) break;
+            local.applyUpdate(*m);
+        }
+        ok("client copy refreshed", near(local.get()->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 2.5));
+
+        auto buy = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "R_42", 2);
+        buy->addString("session_id", auth->getString("token"));
+        client.sendMessage(*buy);
+        auto bought = nextResponse(client, &local);
+        ok("purchase priced from snapshot", bought && bought->getType() == MessageType::RESPONSE_SUCCESS &&
+                                            near(std::stod(bought->getString("total_amount")), 5.0));
+
+        client.close();
+        admin.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+    }
+    {
+        // Restart: cijena iz price_list tabele, nova (veća) verzija snapshot-a
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("server restart", server.start(port, ""));
+        ok("price loaded from db", near(server.getPrices()->ticketPrice(VehicleType::BUS, TicketType::INDIVIDUAL), 2.5) &&
+                                   near(server.getPrices()->ticketPrice(VehicleType::TRAM, TicketType::INDIVIDUAL), 1.0));
+        server.stop();
+    }
+    std::remove(db_path.c_str());
+
+    std::cout << "Price cache test passed.\n";
+    return 0;
+}
@@ -23,6 +23,9 @@ public:
         
         // Test message serialization/deserialization
         testMessageSerialization();
+
+        // Test zero-copy view decode
+        testMessageView();
         
         // Test TLS socket functionality (basic)
         testTLSSocketBasics();
@@ -90,6 +93,45 @@ private:
         }
     }
     
+    void testMessageView() {
+        std::cout << "\n--- Testing MessageView Decode ---" << std::endl;
+        
+        try {
+            auto message = MessageFactory::createPurchaseTicket(
+                TicketType::GROUP_FAMILY, VehicleType::TRAM, "R_7", 3);
+            message->addDouble("price", 2.5);
+            auto serialized = message->serialize();
+            
+            // View pokazuje direktno u serialized bafer
+            MessageView view;
+            assert(view.parse(serialized.data(), serialized.size()));
+            assert(view.getType() == MessageType::PURCHASE_TICKET);
+            assert(view.fieldCount() == 5);
+            assert(view.getInt("ticket_type") == static_cast<int>(TicketType::GROUP_FAMILY));
+            assert(view.getInt("passengers") == 3);
+            assert(view.getDouble("price") == 2.5);
+            assert(view.getStringView("route") == "R_7");
+            assert(view.getStringView("route").data() >= reinterpret_cast<const char*>(serialized.data()));
+            assert(!view.hasKey("missing") && view.getString("missing").empty());
+            
+            // Materijalizacija daje istu poruku kao deserialize
+            auto materialized = view.toMessage();
+            assert(materialized->getString("route") == "R_7");
+            assert(materialized->serialize() == serialized);
+            
+            // Skraćen okvir se odbija
+            assert(!view.parse(serialized.data(), serialized.size() - 1));
+            assert(view.fieldCount() == 0);
+            
+            std::cout << "MessageView tests passed" << std::endl;
+            test_passed_++;
+            
+        } catch (const std::exception& e) {
+            std::cout << "MessageView tests failed: " << e.what() << std::endl;
+            test_failed_++;
+        }
+    }
+    
     void testTLSSocketBasics() {
         std::cout << "\n--- Testing TLS Socket Basics ---" << std::endl;
         
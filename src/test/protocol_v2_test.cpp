@@ -0,0 +1,110 @@
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/VehicleServer.h"
+#include "client/PaymentDevice.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::unique_ptr<Message> sampleMessage() {
+    auto m = MessageFactory::createPurchaseTicket(TicketType::GROUP_BUSINESS, VehicleType::BUS, "R_42", 4);
+    m->addDouble("price", 1.2345678);
+    m->addBool("active", true);
+    m->addInt("offset", -300);                       // nije u tabeli -> eksplicitni ključ
+    std::vector<uint8_t> blob(64);
+    for (size_t i = 0; i < blob.size(); ++i) blob[i] = static_cast<uint8_t>(200 + i);
+    m->addBinary("card", blob);
+    m->calculateChecksum();
+    return m;
+}
+
+int main() {
+    // -------- 1) V2 roundtrip kroz Message --------
+    auto m = sampleMessage();
+    const size_t v1_size = m->size();
+    m->setVersion(PROTOCOL_V2);
+    auto v2 = m->serialize();
+    ok("v2 frame size == size()", v2.size() == m->size());
+
+    Message d;
+    ok("deserialize(v2)", d.deserialize(v2));
+    ok("version on wire", d.getVersion() == PROTOCOL_V2);
+    ok("int field",     d.getInt("passengers") == 4);
+    ok("negative int",  d.getInt("offset") == -300);
+    ok("double exact",  d.getDouble("price") == 1.2345678);
+    ok("bool field",    d.getBool("active"));
+    ok("string field",  d.getString("route") == "R_42");
+    ok("binary raw",    d.getBinary("card") == m->getBinary("card"));
+    ok("getString on int (V1 tekst)", d.getString("passengers") == "4");
+    ok("v2 checksum valid", d.verifyChecksum());
+    ok("v2 isValid", d.isValid());
+
+    std::cout << "  v1 frame: " << v1_size << " B, v2 frame: " << v2.size() << " B\n";
+    ok("v2 smaller than v1", v2.size() * 2 < v1_size);
+
+    // Ista poruka i dalje ide u V1 kad socket nije dogovorio V2
+    std::vector<uint8_t> v1;
+    m->serializeTo(v1, PROTOCOL_V1);
+    Message d1;
+    ok("deserialize(v1 of same message)", d1.deserialize(v1));
+    ok("v1 checksum valid", d1.verifyChecksum());
+    ok("v1 binary text roundtrip", d1.getBinary("card") == m->getBinary("card"));
+    ok("v1 double text", d1.getString("price") == std::to_string(1.2345678));
+
+    // -------- 2) View nad V2 okvirom --------
+    MessageView view;
+    ok("view.parse(v2)", view.parse(v2.data(), v2.size()));
+    ok("view int",           view.getInt("ticket_type") == static_cast<int>(TicketType::GROUP_BUSINESS));
+    ok("view double",        view.getDouble("price") == 1.2345678);
+    ok("view text of int",   view.getStringView("passengers") == "4");
+    ok("view text of bool",  view.getStringView("active") == "true");
+    ok("view unknown key",   view.getInt("offset") == -300);
+    ok("view binary",        view.getBinary("card") == m->getBinary("card"));
+    ok("view->Message->v2 identical", view.toMessage()->serialize() == v2);
+
+    std::vector<uint8_t> truncated(v2.begin(), v2.end() - 1);
+    ok("truncated v2 rejected", !view.parse(truncated.data(), truncated.size()));
+
+    // -------- 3) Dogovor verzije preko TLS-a (PaymentDevice <-> VehicleServer) --------
+    int port = pick_port();
+    VehicleServer server;
+    ok("certificates", server.setCertificates("certs/server.crt", "certs/server.key"));
+    ok("vehicle server start", server.start(port, ""));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    PaymentDevice device;
+    ok("device connect", device.connect("127.0.0.1", port));
+    ok("negotiated v2", device.getProtocolVersion() == PROTOCOL_V2);
+    device.disconnect();
+
+    // Stari klijent (nudi 1.0) ostaje na V1
+    TLSSocket legacy;
+    ok("legacy connect", legacy.connect("127.0.0.1", port));
+    ok("legacy CONNECT_REQUEST", legacy.sendMessage(*MessageFactory::createConnectRequest("legacy")));
+    auto resp = legacy.receiveMessage();
+    ok("legacy CONNECT_RESPONSE", resp && resp->getType() == MessageType::CONNECT_RESPONSE);
+    ok("legacy response frame is v1", resp && resp->getVersion() == PROTOCOL_V1);
+    ok("legacy negotiated v1", resp && parseProtocolVersion(resp->getString("protocol_version")) == PROTOCOL_V1);
+    legacy.disconnect();
+
+    server.stop();
+    std::cout << "Protocol v2 test passed.\n";
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "common/Database.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+
+using namespace transport;
+using namespace std::chrono;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::string urnOf(int i) { return "80000000" + std::to_string(10000 + i); }
+
+int main() {
+    const std::string db_path = "test_record_paging.db";
+    std::remove(db_path.c_str());
+
+    const int kUsers = 250;
+    {
+        Database db;
+        ok("db open", db.initialize(db_path));
+        // Obrnut redoslijed upisa: stranice idu po ključu, ne po rowid-u
+        for (int i = kUsers - 1; i >= 0; --i) {
+            User u{};
+            u.urn = urnOf(i); u.name = "U" + std::to_string(i); u.age = 20 + i % 50;
+            u.registration_date = "2026-01-01 00:00:00"; u.active = true; u.pin_hash = "hash";
+            if (!db.registerUser(u)) ok("register user", false);
+        }
+        for (int i = 0; i < 40; ++i) {
+            Ticket t{};
+            t.ticket_id = "TK-" + std::to_string(100 + i); t.user_urn = urnOf(i % 10);
+            t.type = TicketType::INDIVIDUAL; t.vehicle_type = VehicleType::BUS; t.route = "R1";
+            t.price = 1.5; t.discount = 0.0; t.purchase_date = "now"; t.seat_number = "1"; t.used = false;
+            Payment p{};
+            p.transaction_id = "TX-" + std::to_string(100 + i); p.ticket_id = t.ticket_id; p.amount = 1.5;
+            p.payment_method = "card"; p.payment_date = "now"; p.successful = true;
+            if (!db.createTicket(t) || !db.recordPayment(p)) ok("ticket and payment", false);
+        }
+
+        // -------- 1) Keyset stranice --------
+        auto first = db.getUsersPage("", 100);
+        ok("first page", first.size() == 100 && first.front().urn == urnOf(0) && first.back().urn == urnOf(99));
+        auto second = db.getUsersPage(first.back().urn, 100);
+        ok("second page continues after key", second.size() == 100 && second.front().urn == urnOf(100));
+        auto last = db.getUsersPage(second.back().urn, 100);
+        ok("last page is short", last.size() == 50 && last.back().urn == urnOf(kUsers - 1));
+        ok("past the end", db.getUsersPage(last.back().urn, 100).empty());
+        ok("zero limit", db.getUsersPage("", 0).empty());
+
+        ok("tickets page", db.getTicketsPage("TK-119", 100).size() == 20);
+        ok("payments page", db.getPaymentsPage("", 15).size() == 15);
+
+        // -------- 2) forEach: sve, bez duplikata; rani prekid; konekcija slobodna između stranica --------
+        std::set<std::string> seen;
+        size_t visited = db.forEachUser([&](const User& u) { seen.insert(u.urn); return true; }, 64);
+        ok("visits every user once", visited == kUsers && seen.size() == kUsers);
+
+        size_t reads_inside = 0;
+        visited = db.forEachUser([&](const User& u) {
+            if (db.getUser(u.urn)) ++reads_inside;     // isti objekat: db_mutex_ nije zauzet u visit-u
+            return reads_inside < 70;
+        }, 32);
+        ok("stops when visit returns false", visited == 70 && reads_inside == 70);
+
+        ok("tickets visited", db.forEachTicket([](const Ticket&) { return true; }, 7) == 40);
+        ok("payments visited", db.forEachPayment([](const Payment&) { return true; }, 16) == 40);
+        ok("page size equal to table", db.forEachPayment([](const Payment&) { return true; }, 40) == 40);
+        ok("getAllUsers via pages", db.getAllUsers().size() == kUsers);
+        db.close();
+    }
+
+    // -------- 3) LIST_RECORDS kroz CentralServer --------
+    {
+        const std::string conf = "record_paging_test.conf";
+        std::ofstream(conf) << "[admin]\nadmin_key = k3y\n";
+        const int port = pick_port();
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("central start", central.start(port, conf));
+        std::this_thread::sleep_for(milliseconds(100));
+
+        TLSSocket admin;
+        ok("connect", admin.connect("127.0.0.1", port));
+
+        ok("keyless request", admin.sendMessage(*MessageFactory::createListRecords("users")));
+        auto denied = admin.receiveMessage();
+        ok("listing without admin key rejected", denied && denied->getType() == MessageType::RESPONSE_ERROR &&
+                                                 denied->getInt("error_code") == 401);
+
+        std::set<std::string> urns;
+        std::string after;
+        int pages = 0;
+        do {
+            ok("list request", admin.sendMessage(*MessageFactory::createListRecords("users", after, 100, "k3y")));
+            auto page = admin.receiveMessage();
+            ok("list reply", page && page->getType() == MessageType::RESPONSE_SUCCESS);
+            const int count = page->getInt("count");
+            for (int i = 0; i < count; ++i) urns.insert(page->getString("r." + std::to_string(i) + ".urn"));
+            if (count > 0 && page->hasKey("r.0.pin_hash")) ok("pin hash not exported", false);
+            after = page->getString("next");
+            ++pages;
+        } while (!after.empty() && pages < 10);
+        ok("all users paged", urns.size() == kUsers && pages == 3);
+
+        ok("tickets request", admin.sendMessage(*MessageFactory::createListRecords("tickets", "", 25, "k3y")));
+        auto tickets = admin.receiveMessage();
+        ok("tickets page", tickets && tickets->getInt("count") == 25 && tickets->getString("next") == "TK-124" &&
+                           tickets->getString("r.0.ticket_id") == "TK-100");
+
+        ok("unknown table request", admin.sendMessage(*MessageFactory::createListRecords("vehicles", "", 0, "k3y")));
+        auto bad = admin.receiveMessage();
+        ok("unknown table rejected", bad && bad->getType() == MessageType::RESPONSE_ERROR &&
+                                     bad->getInt("error_code") == 400);
+        admin.close();
+        central.stop();
+        std::remove(conf.c_str());
+    }
+    std::remove(db_path.c_str());
+
+    std::cout << "All record paging tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include "common/Message.h"
+#include "common/Replication.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include "server/RegionalServer.h"
+#include "server/ReplicationLog.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static bool waitUntil(const std::function<bool()>& cond, int ms = 5000) {
+    for (int i = 0; i < ms / 10; ++i) {
+        if (cond()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return cond();
+}
+
+static std::unique_ptr<Message> call(TLSSocket& sock, std::unique_ptr<Message> m) {
+    if (!sock.sendMessage(*m)) return nullptr;
+    return sock.receiveMessage();
+}
+
+static std::string urnFor(int i) {
+    std::string n = std::to_string(i);
+    return "7100000" + std::string(6 - n.size(), '0') + n;
+}
+
+static void writeConfig(const std::string& path, int regional_port, int interval, int log_capacity) {
+    std::ofstream f(path);
+    f << "[regional]\nenable_regional_sync = true\nsync_interval = " << interval << "\n"
+      << "regional_servers = 127.0.0.1:" << regional_port << "\nsync_key = s3cret\n"
+      << "batch_records = 16\ncompression_level = 6\nlog_capacity = " << log_capacity << "\n";
+}
+
+int main() {
+    // -------- 1) Dnevnik i format okvira --------
+    {
+        ReplicationLog log(4);
+        for (int i = 1; i <= 6; ++i) log.append(ReplicationRecord::Kind::USER_UPSERT, urnFor(i), "User");
+        std::vector<ReplicationRecord> out;
+        ok("head", log.head() == 6 && log.getStats().first == 3 && log.getStats().retained == 4);
+        ok("since within window", log.since(3, 10, out) && out.size() == 3 && out.front().offset == 4);
+        ok("since limited by max", log.since(2, 2, out) && out.size() == 2 && out.back().offset == 4);
+        ok("caught up", log.since(6, 10, out) && out.empty());
+        ok("truncated -> snapshot", !log.since(1, 10, out));
+        ok("ahead of log -> snapshot", !log.since(7, 10, out));
+        ok("epoch per log", ReplicationLog().epoch() != log.epoch());
+
+        std::vector<ReplicationRecord> recs;
+        for (int i = 0; i < 200; ++i) {
+            ReplicationRecord r;
+            r.offset = static_cast<uint64_t>(i + 1);
+            r.kind   = ReplicationRecord::Kind::USER_UPSERT;
+            r.key    = urnFor(i);
+            r.value  = "User_" + urnFor(i);
+            recs.push_back(r);
+        }
+        auto frame = MessageFactory::createReplicaBatch(42, 0, 200, false, recs);
+        const auto packed = frame->getBinary("records");
+        ok("frame compressed", frame->getString("encoding") == "zlib" &&
+                               packed.size() < static_cast<size_t>(frame->getInt("raw_size")) / 2);
+        std::vector<uint8_t> raw;
+        std::vector<ReplicationRecord> back;
+        ok("frame round trip", replication::decompress(packed, static_cast<size_t>(frame->getInt("raw_size")), raw) &&
+                               replication::decodeRecords(raw, back) && back.size() == 200 &&
+                               back[7].key == urnFor(7) && back[199].offset == 200);
+        ok("raw when compression off", MessageFactory::createReplicaBatch(42, 0, 200, false, recs, 0)
+                                           ->getString("encoding") == "raw");
+
+        Vehicle v{"tram://7", VehicleType::TRAM, 40, 12, "R|7", true, ""};
+        ReplicationRecord vr{1, ReplicationRecord::Kind::VEHICLE_UPSERT, v.uri, replication::encodeVehicle(v)};
+        Vehicle dv{};
+        ok("vehicle fields", replication::decodeVehicle(vr, dv) && dv.route == "R|7" && dv.capacity == 40 &&
+                             dv.available_seats == 12 && dv.type == VehicleType::TRAM && dv.active);
+    }
+
+    const std::string db_path = "test_regional_replication.db";
+    const std::string conf    = "test_regional_replication.conf";
+    std::remove(db_path.c_str());
+
+    const int regional_port = pick_port();
+    RegionalServer regional;
+    regional.setCertificates("certs/server.crt", "certs/server.key");
+    regional.setSyncKey("s3cret");
+    ok("regional start", regional.start(regional_port, ""));
+
+    // -------- 2) Periodično slanje (sync_interval) sa snapshot-om za novu kopiju --------
+    const int central_port = pick_port();
+    const std::string rid = "127.0.0.1:" + std::to_string(regional_port);
+    {
+        writeConfig(conf, regional_port, 1, 65536);
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("central start", central.start(central_port, conf));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket admin;
+        ok("admin connect", admin.connect("127.0.0.1", central_port));
+        for (int i = 0; i < 40; ++i) call(admin, MessageFactory::createRegisterUser(urnFor(i)));
+        call(admin, MessageFactory::createRegisterDevice("bus://71", VehicleType::BUS));
+        auto up = call(admin, MessageFactory::createUpdatePrice(VehicleType::BUS, TicketType::INDIVIDUAL, 2.75));
+        ok("central updates", up && up->getType() == MessageType::RESPONSE_SUCCESS);
+        admin.close();
+
+        ok("replicated by background sync", waitUntil([&] {
+            const auto s = regional.getReplicaStats();
+            return s.offset == central.getReplicationStats().head && s.users == 40 && s.vehicles == 1;
+        }));
+        const auto st = central.getRegionalSyncStats(rid);
+        ok("first sync is a snapshot", st && st->active && st->snapshots == 1 && st->connects == 1);
+        ok("frames compressed on the wire", st->wire_bytes < st->raw_bytes);
+        ok("replica epoch", regional.getReplicaStats().epoch == central.getReplicationStats().epoch);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        central.stop();
+    }
+
+    // -------- 3) Regionalni server odgovara bez centralnog servera --------
+    {
+        TLSSocket dev;
+        ok("device connect to regional", dev.connect("127.0.0.1", regional_port));
+        auto auth = call(dev, MessageFactory::createAuthRequest(urnFor(3)));
+        ok("auth from replica", auth && auth->getType() == MessageType::AUTH_RESPONSE && auth->getBool("success") &&
+                                !auth->getString("token").empty());
+        auto bad = call(dev, MessageFactory::createAuthRequest("7199999999999"));
+        ok("unknown user rejected", bad && bad->getType() == MessageType::AUTH_RESPONSE && !bad->getBool("success"));
+        auto prices = call(dev, MessageFactory::createGetPrices());
+        ok("prices from replica", prices && prices->getType() == MessageType::RESPONSE_SUCCESS &&
+                                  prices->getInt("count") == 12 && prices->getDouble("fare.1.1") == 2.75);
+        auto write = call(dev, MessageFactory::createRegisterUser("7188888888888"));
+        ok("writes stay on central", write && write->getInt("error_code") == 501);
+
+        auto forged = call(dev, MessageFactory::createReplicaBatch(1, 0, 1, true, {}));
+        ok("batch without REPLICA_SYNC rejected", forged && forged->getInt("error_code") == 401);
+        auto badkey = call(dev, MessageFactory::createReplicaSync("x", 1, "wrong"));
+        ok("wrong sync key rejected", badkey && badkey->getInt("error_code") == 401);
+        ok("replica untouched", regional.getReplicaStats().users == 40);
+        dev.close();
+    }
+
+    // -------- 4) Restart centralnog servera: novi epoch -> snapshot; zatim inkrementalno --------
+    {
+        writeConfig(conf, regional_port, 3600, 8);   // samo sync na startu, ostalo ručno
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("central restart", central.start(central_port, conf));
+        ok("new epoch resynced with snapshot", waitUntil([&] {
+            const auto st = central.getRegionalSyncStats(rid);
+            return st && st->snapshots == 1 && regional.getReplicaStats().epoch == central.getReplicationStats().epoch;
+        }));
+        ok("regional counted two snapshots", regional.getReplicaStats().snapshots == 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket admin;
+        ok("admin connect", admin.connect("127.0.0.1", central_port));
+        call(admin, MessageFactory::createRegisterUser(urnFor(100)));
+        call(admin, MessageFactory::createUpdateCapacity("bus://71", 60, 60));
+        ok("incremental sync", central.syncWithRegionalServer(rid) && regional.hasUser(urnFor(100)));
+        Vehicle v{};
+        ok("vehicle change replicated", regional.getVehicle("bus://71", v) && v.capacity == 60);
+        auto st = central.getRegionalSyncStats(rid);
+        ok("no extra snapshot", st->snapshots == 1 && st->acked == central.getReplicationStats().head);
+
+        // Nova veza: centralni server nastavlja od offset-a koji javi regionalni
+        ok("re-register", central.registerRegionalServer(rid, "127.0.0.1", regional_port));
+        call(admin, MessageFactory::createRegisterUser(urnFor(101)));
+        ok("catch-up from offset", central.syncWithRegionalServer(rid) && regional.hasUser(urnFor(101)));
+        st = central.getRegionalSyncStats(rid);
+        ok("catch-up without snapshot", st->snapshots == 1 && st->connects == 2 &&
+                                        regional.getReplicaStats().offset == central.getReplicationStats().head);
+
+        // Zaostatak veći od log_capacity (8) -> snapshot
+        ok("re-register again", central.registerRegionalServer(rid, "127.0.0.1", regional_port));
+        for (int i = 0; i < 10; ++i) call(admin, MessageFactory::createRegisterUser(urnFor(200 + i)));
+        ok("lagging replica resynced", central.syncWithRegionalServer(rid) && regional.hasUser(urnFor(209)));
+        st = central.getRegionalSyncStats(rid);
+        ok("snapshot after log window", st->snapshots == 2 && regional.getReplicaStats().users == 52);
+
+        ok("delete replicated", central.processUserDeletion(urnFor(0), /*admin_approved*/ true) &&
+                                central.syncWithRegionalServer(rid) && !regional.hasUser(urnFor(0)));
+
+        // Pogrešan ključ: regionalni server odbija vezu
+        const int other_port = pick_port();
+        RegionalServer other;
+        other.setCertificates("certs/server.crt", "certs/server.key");
+        other.setSyncKey("different");
+        ok("second regional start", other.start(other_port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ok("register second", central.registerRegionalServer("other", "127.0.0.1", other_port));
+        ok("sync refused with wrong key", !central.syncWithRegionalServer("other") &&
+                                          !central.getRegionalSyncStats("other")->active &&
+                                          other.getReplicaStats().users == 0);
+
+        // Regionalni server bez ključa ne prima kopiju ni od koga
+        const int open_port = pick_port();
+        RegionalServer keyless;
+        keyless.setCertificates("certs/server.crt", "certs/server.key");
+        ok("keyless regional start", keyless.start(open_port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        {
+            TLSSocket peer;
+            ok("peer connect to keyless", peer.connect("127.0.0.1", open_port));
+            auto refused = call(peer, MessageFactory::createReplicaSync("x", 1, ""));
+            ok("sync refused without configured key", refused && refused->getInt("error_code") == 403 &&
+                                                      keyless.getReplicaStats().users == 0);
+            peer.close();
+        }
+
+        admin.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        central.stop();
+        other.stop();
+        keyless.stop();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    regional.stop();
+    std::remove(db_path.c_str());
+    std::remove(conf.c_str());
+
+    std::cout << "Regional replication test passed.\n";
+    return 0;
+}
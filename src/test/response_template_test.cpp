@@ -0,0 +1,133 @@
+#include "common/Crc32.h"
+#include "common/Message.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static std::vector<uint8_t> frameOf(Message& message, uint16_t version, uint32_t seq) {
+    message.setSequenceId(seq);
+    std::vector<uint8_t> out;
+    message.serializeTo(out, version);
+    return out;
+}
+
+static std::vector<uint8_t> render(const ResponseTemplate& tmpl, uint16_t version, uint32_t seq,
+                                   std::initializer_list<ResponseTemplate::Value> values) {
+    std::vector<uint8_t> out;
+    tmpl.render(out, version, seq, values);
+    return out;
+}
+
+int main() {
+    // -------- 1) Crc32::combine --------
+    {
+        std::vector<uint8_t> a(37), b(1000);
+        for (size_t i = 0; i < a.size(); ++i) a[i] = static_cast<uint8_t>(i * 7 + 1);
+        for (size_t i = 0; i < b.size(); ++i) b[i] = static_cast<uint8_t>(i * 13 + 5);
+        std::vector<uint8_t> ab(a);
+        ab.insert(ab.end(), b.begin(), b.end());
+        const uint32_t whole = Crc32::compute(ab.data(), ab.size());
+        const uint32_t ca = Crc32::compute(a.data(), a.size());
+        const uint32_t cb = Crc32::compute(b.data(), b.size());
+        ok("combine equals crc of concatenation", Crc32::combine(ca, cb, b.size()) == whole);
+        ok("combineFactor with precomputed shift",
+           Crc32::combineFactor(ca, cb, Crc32::shiftFactor(b.size())) == whole);
+        ok("combine with empty tail", Crc32::combine(ca, 0, 0) == ca);
+    }
+
+    // -------- 2) Šabloni iz MessageFactory == odgovarajući Message okvir --------
+    for (uint16_t version : {PROTOCOL_V1, PROTOCOL_V2}) {
+        const std::string v = " (v" + std::to_string(version) + ")";
+
+        auto error = MessageFactory::createErrorResponse("Route not found", -404);
+        ok(("error template" + v).c_str(),
+           render(MessageFactory::errorResponseTemplate(), version, 42, {"Route not found", -404}) ==
+               frameOf(*error, version, 42));
+
+        auto success = MessageFactory::createSuccessResponse("alive");
+        ok(("success template" + v).c_str(),
+           render(MessageFactory::successResponseTemplate(), version, 7, {"alive"}) ==
+               frameOf(*success, version, 7));
+
+        auto connect = MessageFactory::createConnectResponse(true, "Connection established", 2);
+        ok(("connect template" + v).c_str(),
+           render(MessageFactory::connectAcceptedTemplate(), version, 1, {"2.0"}) ==
+               frameOf(*connect, version, 1));
+
+        auto seat = MessageFactory::createSuccessResponse("Seat reserved successfully", {
+            {"route", "R12"}, {"vehicle_uri", "bus://sarajevo/12"}, {"available_seats", "17"}});
+        ok(("seat reserved template, number in string slot" + v).c_str(),
+           render(MessageFactory::seatReservedTemplate(), version, 99, {"R12", "bus://sarajevo/12", 17}) ==
+               frameOf(*seat, version, 99));
+
+        // Nepoznati ključ (V2 nosi ključ u okviru), dug statični dio (CRC spajanjem), INT iz teksta
+        Message fixed(MessageType::RESPONSE_SUCCESS);
+        fixed.addString("message", std::string(300, 'm'));
+        fixed.addString("zz_trailer", "end");
+        fixed.addBool("success", true);
+        const ResponseTemplate custom(fixed, {{"custom_key", ResponseTemplate::SlotType::STRING},
+                                              {"error_code", ResponseTemplate::SlotType::INT},
+                                              {"aa_first", ResponseTemplate::SlotType::STRING}});
+        auto frame = render(custom, version, 5, {"", "-12", std::string(200, 'x')});
+        Message expected(fixed);
+        expected.addString("custom_key", "");
+        expected.addInt("error_code", -12);
+        expected.addString("aa_first", std::string(200, 'x'));
+        expected.calculateChecksum();
+        ok(("custom template" + v).c_str(), frame == frameOf(expected, version, 5));
+        ok(("toMessage matches render" + v).c_str(),
+           frameOf(*custom.toMessage({"", -12, std::string(200, 'x')}), version, 5) == frame);
+
+        Message parsed;
+        ok(("rendered frame parses" + v).c_str(), parsed.deserialize(frame) && parsed.verifyChecksum());
+        ok(("rendered fields" + v).c_str(),
+           parsed.getInt("error_code") == -12 && parsed.getString("zz_trailer") == "end" &&
+               parsed.getSequenceId() == 5);
+
+        // Više okvira u istom baferu (render dodaje na kraj)
+        std::vector<uint8_t> both;
+        MessageFactory::successResponseTemplate().render(both, version, 1, {"a"});
+        const size_t first = both.size();
+        MessageFactory::successResponseTemplate().render(both, version, 2, {"b"});
+        ok(("render appends" + v).c_str(),
+           both.size() == 2 * first &&
+               std::vector<uint8_t>(both.begin() + first, both.end()) ==
+                   render(MessageFactory::successResponseTemplate(), version, 2, {"b"}));
+    }
+
+    // -------- 3) Pogrešna upotreba --------
+    {
+        bool threw = false;
+        try {
+            std::vector<uint8_t> out;
+            MessageFactory::errorResponseTemplate().render(out, PROTOCOL_V2, 1, {"only error"});
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        ok("slot count mismatch rejected", threw);
+
+        threw = false;
+        try {
+            Message fixed(MessageType::RESPONSE_SUCCESS);
+            fixed.addString("message", "x");
+            ResponseTemplate clash(fixed, {{"message", ResponseTemplate::SlotType::STRING}});
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        ok("slot shadowing a fixed field rejected", threw);
+    }
+
+    std::cout << "All response template tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "server/SeatInventory.h"
+#include "common/Database.h"
+#include "common/VehicleStatus.h"
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+int main() {
+    Database db;
+    ok("db init", db.initialize("seat_inventory_test.db"));
+
+    Vehicle bus{};
+    bus.uri = "bus://100"; bus.type = VehicleType::BUS; bus.capacity = 100; bus.available_seats = 100;
+    bus.route = "R_100"; bus.active = true; bus.last_update = "now";
+    db.registerVehicle(bus);
+    db.updateVehicleCapacity(bus.uri, 100, 100);      // ponovno pokretanje nad istim fajlom
+
+    Vehicle tram = bus;
+    tram.uri = "tram://5"; tram.type = VehicleType::TRAM; tram.capacity = 4; tram.available_seats = 4;
+    tram.route = "R_5";
+    db.registerVehicle(tram);
+    db.updateVehicleCapacity(tram.uri, 4, 4);
+
+    // -------- 1) Učitavanje iz baze --------
+    SeatInventory inv;
+    ok("load from db", inv.load(db) >= 2);
+    auto s = inv.find("bus://100");
+    ok("find by uri", s && s->capacity == 100 && s->available == 100);
+    auto r = inv.findByRouteAndType("R_5", VehicleType::TRAM);
+    ok("find by route/type", r && r->uri == "tram://5");
+    ok("route/type miss", !inv.findByRouteAndType("R_5", VehicleType::BUS));
+
+    // -------- 2) Konkurentne rezervacije: tačno capacity uspjeha --------
+    std::atomic<int> reserved{0};
+    std::atomic<int> rejected{0};
+    std::vector<std::atomic<int>> seat_taken(101);
+    std::atomic<bool> unique_seats{true};
+    std::vector<std::thread> th;
+    for (int t = 0; t < 8; ++t) {
+        th.emplace_back([&]() {
+            for (int i = 0; i < 20; ++i) {
+                auto res = inv.reserve("bus://100", 1);
+                if (res.ok) {
+                    reserved++;
+                    if (res.first_seat < 1 || res.first_seat > 100 || seat_taken[res.first_seat]++ != 0)
+                        unique_seats = false;
+                } else {
+                    rejected++;
+                }
+            }
+        });
+    }
+    for (auto& t : th) t.join();
+    ok("exactly capacity reserved", reserved == 100);
+    ok("rest rejected", rejected == 160 - 100);
+    ok("unique seat numbers", unique_seats);
+    ok("inventory at zero", inv.find("bus://100")->available == 0);
+
+    // -------- 3) Grupna rezervacija i storno --------
+    auto g = inv.reserve("tram://5", 3);
+    ok("group reserve", g.ok && g.available == 1 && g.first_seat == 1);
+    ok("group over capacity rejected", !inv.reserve("tram://5", 2).ok);
+    inv.release("tram://5", 3);
+    ok("release restores seats", inv.find("tram://5")->available == 4);
+    ok("unknown vehicle", !inv.reserve("bus://404", 1).found);
+
+    // -------- 4) Write-behind: baza se mijenja tek na flush --------
+    ok("db not yet updated", db.getVehicle("bus://100")->available_seats == 100);
+    ok("two dirty vehicles", inv.dirtyCount() == 2);
+    ok("flush writes both", inv.flush(db) == 2);
+    ok("db updated after flush", db.getVehicle("bus://100")->available_seats == 0);
+    ok("db tram restored", db.getVehicle("tram://5")->available_seats == 4);
+    ok("nothing left to flush", inv.dirtyCount() == 0 && inv.flush(db) == 0);
+
+    // -------- 5) Admin izmjena (upsert) --------
+    db.updateVehicleCapacity("bus://100", 120, 20);
+    bus.capacity = 120; bus.available_seats = 20;
+    inv.upsert(bus);
+    ok("upsert applies db values", inv.find("bus://100")->available == 20);
+    ok("upsert of existing re-flushes", inv.flush(db) == 1);
+
+    // -------- 6) Indeks ruta -> vozila po tipu --------
+    ok("findOnRoute: preferred type present", inv.findOnRoute("R_5", VehicleType::TRAM)->uri == "tram://5");
+    ok("findOnRoute: other type fallback", inv.findOnRoute("R_5", VehicleType::BUS)->uri == "tram://5");
+    ok("findOnRoute: unknown route", !inv.findOnRoute("R_none", VehicleType::BUS));
+
+    // Promjena rute (admin updateVehicle) premješta vozilo u indeksu
+    db.updateVehicle("tram://5", std::nullopt, std::string("R_6"), std::nullopt);
+    inv.upsert(*db.getVehicle("tram://5"));
+    ok("index follows route change", !inv.findOnRoute("R_5", VehicleType::TRAM) &&
+                                     inv.findOnRoute("R_6", VehicleType::BUS)->uri == "tram://5");
+
+    // Pun autobus na ruti: prednost ima drugi autobus sa slobodnim mjestom
+    Vehicle bus2 = bus;
+    bus2.uri = "bus://101"; bus2.capacity = 10; bus2.available_seats = 10; bus2.route = "R_100";
+    db.registerVehicle(bus2);
+    db.updateVehicleCapacity(bus2.uri, 10, 10);
+    inv.upsert(bus2);
+    db.updateVehicleCapacity("bus://100", 120, 0);
+    inv.upsert(*db.getVehicle("bus://100"));
+    ok("route lookup skips full vehicle", inv.findOnRoute("R_100", VehicleType::BUS)->uri == "bus://101");
+
+    // SQL strana: jedan upit za bilo koji tip na ruti
+    auto any = db.getVehicleByRoute("R_6", VehicleType::BUS);
+    ok("db getVehicleByRoute other type", any && any->uri == "tram://5");
+    auto pref = db.getVehicleByRoute("R_100", VehicleType::BUS);
+    ok("db getVehicleByRoute prefers seats", pref && pref->uri == "bus://101");
+    db.updateVehicle("tram://5", std::nullopt, std::string("R_5"), std::nullopt);   // vrati za sljedeće pokretanje
+
+    // -------- 7) Verzije: snapshot pa delta po ruti --------
+    auto full = inv.statusSince({"R_100"}, 0);
+    ok("status snapshot is full", full.full && full.vehicles.size() == 2 && full.version == inv.version());
+    auto none = inv.statusSince({"R_100"}, full.version);
+    ok("no changes -> empty delta", !none.full && none.vehicles.empty() && none.removed.empty());
+
+    inv.reserve("bus://101", 1);
+    inv.reserve("tram://5", 1);                 // druga ruta (R_6) ne ulazi u deltu za R_100
+    auto delta = inv.statusSince({"R_100"}, full.version);
+    ok("delta holds only changed vehicle", !delta.full && delta.vehicles.size() == 1 &&
+                                           delta.vehicles[0].uri == "bus://101" &&
+                                           delta.vehicles[0].version > full.version);
+    ok("all-routes delta", inv.statusSince({}, full.version).vehicles.size() == 2);
+    inv.release("bus://101", 1);
+    inv.release("tram://5", 1);
+
+    // Premještanje rute i brisanje -> tombstone u delti stare rute
+    const uint64_t before_move = inv.version();
+    Vehicle moved = *db.getVehicle("bus://101");
+    moved.route = "R_7";
+    inv.upsert(moved);
+    auto gone = inv.statusSince({"R_100"}, before_move);
+    ok("route change tombstones old route", gone.vehicles.empty() && gone.removed.size() == 1 &&
+                                            gone.removed[0].uri == "bus://101");
+    ok("route change appears on new route", inv.statusSince({"R_7"}, before_move).vehicles.size() == 1);
+    ok("future version -> full snapshot", inv.statusSince({"R_7"}, inv.version() + 10).full);
+    inv.upsert(bus2);                           // vrati na R_100
+
+    // -------- 8) VehicleStatus kodek i klijentska kopija --------
+    std::vector<VehicleStatusRecord> recs(2);
+    recs[0].uri = "bus://1"; recs[0].route = "R_1"; recs[0].capacity = 50; recs[0].available = 7; recs[0].version = 3;
+    recs[1].uri = "tram://2"; recs[1].type = VehicleType::TRAM; recs[1].route = "R_2"; recs[1].active = false;
+    recs[1].version = 300;
+    std::vector<uint8_t> blob;
+    vehicle_status::encodeRecords(recs, blob);
+    std::vector<VehicleStatusRecord> back;
+    ok("records roundtrip", vehicle_status::decodeRecords(blob, back) && back.size() == 2 &&
+                            back[1].type == VehicleType::TRAM && !back[1].active &&
+                            back[1].version == 300 && back[0].available == 7);
+    blob.pop_back();
+    ok("truncated records rejected", !vehicle_status::decodeRecords(blob, back));
+    ok("parseRoutes", vehicle_status::parseRoutes(" R_1, R_2 ,") == std::vector<std::string>({"R_1", "R_2"}) &&
+                      vehicle_status::parseRoutes("*").empty());
+
+    VehicleStatusView view;
+    ok("view applies snapshot", view.apply(*MessageFactory::createVehicleStatus(300, 0, true, recs, {})) &&
+                                view.version() == 300 && view.vehicles().size() == 2);
+    // Zakašnjela delta sa starijom verzijom vozila ne gazi novije stanje
+    auto stale = recs[0];
+    stale.available = 1; stale.version = 2;
+    view.apply(*MessageFactory::createVehicleStatus(250, 1, false, {stale}, {}));
+    ok("stale delta ignored", view.vehicles().at("bus://1").available == 7 && view.version() == 300);
+    auto removed = recs[1];
+    removed.version = 301;
+    view.apply(*MessageFactory::createVehicleStatus(301, 300, false, {}, {removed}));
+    ok("delta removal", view.vehicles().size() == 1 && view.version() == 301);
+
+    // -------- 9) Brojevi sjedišta i admin izmjena na mjestu --------
+    auto first  = inv.reserve("bus://101", 1);
+    inv.release("bus://101", 1);
+    auto second = inv.reserve("bus://101", 1);
+    ok("seat number not reused after release", first.ok && second.ok && second.first_seat > first.first_seat);
+    inv.release("bus://101", 1);
+
+    // Rezervacija između čitanja admina i izmjene se prenosi na novi kapacitet
+    const int seen = inv.availableOf("bus://101");
+    inv.reserve("bus://101", 1);
+    Vehicle grown = bus2;
+    grown.capacity = 20; grown.available_seats = seen + 10;
+    ok("amend keeps concurrent reservation", inv.amend(grown, true, seen) &&
+                                             inv.find("bus://101")->available == seen + 9 &&
+                                             inv.find("bus://101")->capacity == 20);
+    grown.uri = "bus://404";
+    ok("amend of unknown vehicle", !inv.amend(grown) && inv.availableOf("bus://404") == -1);
+
+    // Grupna izmjena: bez kapaciteta živi brojač ostaje, nepoznato vozilo se dodaje
+    const int live = inv.availableOf("bus://101");
+    Vehicle rerouted = bus2;
+    rerouted.route = "R_bulk"; rerouted.capacity = 20; rerouted.available_seats = 0;   // stanje iz baze (staro)
+    inv.amendAll({rerouted, grown}, {std::nullopt, std::nullopt});
+    ok("amendAll keeps live counter", inv.find("bus://101")->available == live &&
+                                      inv.find("bus://101")->route == "R_bulk");
+    ok("amendAll adds unknown vehicle", inv.availableOf("bus://404") == grown.available_seats);
+
+    // Brojač putnika: pomak za razliku, u granicama kapaciteta
+    const int before = inv.availableOf("bus://101");
+    ok("adjust by delta", inv.adjustSeats("bus://101", -2) == before - 2);
+    ok("adjust clamped", inv.adjustSeats("bus://101", 1000) == 20 && inv.adjustSeats("bus://101", -1000) == 0);
+    ok("adjust unknown", inv.adjustSeats("bus://nope", 1) == -1);
+
+    auto st = inv.getStats();
+    ok("stats counted", st.reservations >= 101 && st.rejections >= 61 && st.flushes >= 2);
+
+    std::cout << "Seat inventory test passed.\n";
+    return 0;
+}
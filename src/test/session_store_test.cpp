@@ -0,0 +1,105 @@
+#include "server/SessionStore.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+using namespace std::chrono;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+int main() {
+    // -------- 1) Tokeni: fiksna dužina, hex, bez ponavljanja --------
+    {
+        std::set<std::string> seen;
+        bool format_ok = true;
+        for (int i = 0; i < 10000; ++i) {
+            const std::string t = SessionStore::generateToken();
+            format_ok &= t.size() == SessionStore::kTokenLength &&
+                         t.find_first_not_of("0123456789abcdef") == std::string::npos;
+            seen.insert(t);
+        }
+        ok("token format (32 hex)", format_ok);
+        ok("tokens unique", seen.size() == 10000);
+    }
+
+    // -------- 2) create / touch / remove --------
+    {
+        SessionStore store(seconds(60), 8);
+        const std::string sid = store.create("1234567890123");
+        ok("create returns token", sid.size() == SessionStore::kTokenLength);
+        auto urn = store.touch(sid);
+        ok("touch returns urn", urn && *urn == "1234567890123");
+        ok("contains", store.contains(sid));
+        ok("unknown session rejected", !store.touch("session_1") && !store.contains("session_1"));
+        ok("remove", store.remove(sid) && !store.contains(sid) && store.size() == 0);
+        ok("remove twice", !store.remove(sid));
+    }
+
+    // -------- 3) Istek kroz wheel (tick 10 ms) --------
+    {
+        SessionStore store(seconds(1), 4, milliseconds(10));
+        const std::string idle = store.create("1111111111111");
+        const std::string busy = store.create("2222222222222");
+        const auto t0 = SessionStore::Clock::now();
+
+        ok("nothing expired early", store.expire(t0 + milliseconds(500)) == 0 && store.size() == 2);
+        // busy je aktivna do kraja perioda -> timer se pri okidanju ponovo zakaže
+        for (int i = 0; i < 8; ++i) {
+            std::this_thread::sleep_for(milliseconds(100));
+            store.touch(busy);
+        }
+        const auto t1 = SessionStore::Clock::now();
+        ok("idle expired", store.expire(t1 + milliseconds(300)) == 1);
+        ok("busy survives", !store.contains(idle) && store.contains(busy));
+        ok("busy expires after idle period", store.expire(t1 + milliseconds(1200)) == 1);
+        ok("store empty", store.size() == 0);
+    }
+
+    // -------- 4) Kaskada: rok iza L0 kruga (256 tickova) --------
+    {
+        SessionStore store(seconds(5), 2, milliseconds(10));   // 500 tickova -> L1
+        const std::string sid = store.create("3333333333333");
+        const auto t0 = SessionStore::Clock::now();
+        ok("not expired after L0 wrap", store.expire(t0 + milliseconds(3000)) == 0 && store.contains(sid));
+        ok("expired after cascade", store.expire(t0 + milliseconds(5100)) == 1 && !store.contains(sid));
+        // Rok dalje od dometa wheel-a (256*64 tickova)
+        SessionStore far(seconds(200), 2, milliseconds(10));
+        const std::string f = far.create("4444444444444");
+        const auto t2 = SessionStore::Clock::now();
+        ok("far deadline kept", far.expire(t2 + seconds(190)) == 0 && far.contains(f));
+        ok("far deadline expires", far.expire(t2 + seconds(201)) == 1);
+    }
+
+    // -------- 5) Konkurentno: više niti, različiti shardovi --------
+    {
+        SessionStore store(seconds(60), 16);
+        const int kThreads = 8, kPerThread = 2000;
+        std::atomic<int> touched{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                const std::string urn = std::to_string(1000000000000LL + t);
+                for (int i = 0; i < kPerThread; ++i) {
+                    const std::string sid = store.create(urn);
+                    auto u = store.touch(sid);
+                    if (u && *u == urn) touched++;
+                    if (i % 2) store.remove(sid);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        ok("concurrent create/touch", touched == kThreads * kPerThread);
+        ok("concurrent remove", store.size() == static_cast<size_t>(kThreads * kPerThread / 2));
+    }
+
+    std::cout << "Session store test passed.\n";
+    return 0;
+}
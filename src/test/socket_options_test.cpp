@@ -0,0 +1,223 @@
+#include "common/Message.h"
+#include "common/TLSServer.h"
+#include "common/TLSSocket.h"
+#include "server/ServerBase.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+int main() {
+    // -------- 1) ServerConfig -> SocketOptions --------
+    {
+        ServerConfig def;
+        ok("defaults", def.socket_options.tcp_nodelay && !def.socket_options.keepalive &&
+                       def.socket_options.buffer_size == 0 && !def.socket_options.reuse_port);
+
+        const std::string path = "test_socket_options.conf";
+        {
+            std::ofstream f(path);
+            f << "[server]\ntcp_nodelay = false\ntcp_keepalive = true\nsocket_reuse_port = true\n"
+              << "[network]\nsocket_buffer_size = 131072\nkeepalive_idle = 30\nkeepalive_interval = 5\n"
+              << "keepalive_count = 4\nmax_frame_bytes = 4096\n";
+        }
+        ServerConfig cfg;
+        ok("load config", cfg.loadFromFile(path));
+        const auto& so = cfg.socket_options;
+        ok("parsed options", !so.tcp_nodelay && so.keepalive && so.reuse_port && so.reuse_address &&
+                             so.buffer_size == 131072 && so.keepalive_idle == 30 &&
+                             so.keepalive_interval == 5 && so.keepalive_count == 4 &&
+                             so.max_frame_bytes == 4096);
+
+        {
+            std::ofstream f(path);
+            f << "[network]\nenable_keepalive = true\n";
+        }
+        ServerConfig legacy;
+        ok("legacy [network] enable_keepalive", legacy.loadFromFile(path) && legacy.socket_options.keepalive &&
+                                                legacy.socket_options.buffer_size == 0);
+        std::remove(path.c_str());
+    }
+
+    // -------- 2) Opcije na oba kraja konekcije (getsockopt) --------
+    {
+        SocketOptions opts;
+        opts.tcp_nodelay        = true;
+        opts.keepalive          = true;
+        opts.keepalive_idle     = 45;
+        opts.keepalive_interval = 7;
+        opts.keepalive_count    = 3;
+        opts.buffer_size        = 64 * 1024;
+
+        std::mutex mu;
+        SocketOptions accepted;
+        std::atomic<bool> queried{false};
+
+        const int port = pick_port();
+        TLSServer server;
+        server.setSocketOptions(opts);
+        server.setConnectionCallback([&](std::unique_ptr<TLSSocket> c) {
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                if (c->querySocketOptions(accepted)) queried = true;
+            }
+            auto m = c->receiveMessage();
+            if (m) c->sendMessage(*m);
+        });
+        ok("server start", server.start(port, "certs/server.crt", "certs/server.key"));
+        ok("single acceptor without reuse_port", server.getAcceptorCount() == 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket client;
+        SocketOptions client_opts = opts;
+        client_opts.keepalive_idle = 20;
+        client.setSocketOptions(client_opts);
+        ok("connect", client.connect("127.0.0.1", port));
+        ok("echo", client.sendMessage(*MessageFactory::createHeartbeat()) && client.receiveMessage() != nullptr);
+
+        SocketOptions c;
+        ok("client query", client.querySocketOptions(c));
+        ok("client options applied", c.tcp_nodelay && c.keepalive && c.keepalive_idle == 20 &&
+                                     c.keepalive_interval == 7 && c.keepalive_count == 3 &&
+                                     c.buffer_size >= opts.buffer_size);
+
+        for (int i = 0; i < 100 && !queried; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            ok("accepted socket options applied", queried && accepted.tcp_nodelay && accepted.keepalive &&
+                                                  accepted.keepalive_idle == 45 && accepted.keepalive_count == 3 &&
+                                                  accepted.buffer_size >= opts.buffer_size);
+        }
+
+        // Promjena na otvorenoj konekciji se primjenjuje odmah
+        SocketOptions off;
+        off.tcp_nodelay = false;
+        client.setSocketOptions(off);
+        ok("live update", client.querySocketOptions(c) && !c.tcp_nodelay && !c.keepalive);
+        client.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));   // nit konekcije završava
+        server.stop();
+    }
+
+    // -------- 3) SO_REUSEPORT: acceptor po worker niti --------
+    {
+        SocketOptions opts;
+        opts.reuse_port = true;
+
+        const int port = pick_port();
+        TLSServer server;
+        server.setSocketOptions(opts);
+        server.setExecutionMode(TLSServer::ExecutionMode::WORKER_POOL, 3);
+        std::atomic<int> connections{0};
+        server.setConnectionCallback([&](std::unique_ptr<TLSSocket>) { connections++; });
+        ok("server start (reuse_port)", server.start(port, "certs/server.crt", "certs/server.key"));
+        ok("one acceptor per worker", server.getAcceptorCount() == 3 && server.getWorkerThreads() == 3);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const int kClients = 12;
+        int connected = 0;
+        for (int i = 0; i < kClients; ++i) {
+            TLSSocket c;
+            if (c.connect("127.0.0.1", port)) connected++;
+            c.close();
+        }
+        for (int i = 0; i < 100 && connections < kClients; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ok("all connections accepted", connected == kClients && connections == kClients);
+        server.stop();
+
+        // Thread-per-connection zadržava jedan acceptor i uz reuse_port
+        TLSServer single;
+        single.setSocketOptions(opts);
+        ok("start (thread per connection)", single.start(pick_port(), "certs/server.crt", "certs/server.key"));
+        ok("single acceptor", single.getAcceptorCount() == 1);
+        single.stop();
+    }
+
+    // -------- 4) receive_timeout_ms: server ne odgovara --------
+    {
+        const int port = pick_port();
+        TLSServer server;
+        server.setConnectionCallback([](std::unique_ptr<TLSSocket> c) {
+            while (c->receiveMessage()) {}    // prima, nikad ne odgovara
+        });
+        ok("server start (silent)", server.start(port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket client;
+        SocketOptions opts;
+        opts.receive_timeout_ms = 300;
+        client.setSocketOptions(opts);
+        ok("connect (timeout)", client.connect("127.0.0.1", port) && client.enableFullDuplex());
+        const auto t0 = std::chrono::steady_clock::now();
+        ok("send", client.sendMessage(*MessageFactory::createHeartbeat()));
+        ok("receive times out", client.receiveMessage() == nullptr);
+        const auto waited = std::chrono::steady_clock::now() - t0;
+        ok("within deadline", waited >= std::chrono::milliseconds(300) && waited < std::chrono::seconds(2));
+        ok("link unusable after timeout", client.receiveMessage() == nullptr);
+        client.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+    }
+
+    // -------- 5) max_frame_bytes: server odbija okvir prije alokacije payload-a --------
+    {
+        const int port = pick_port();
+        TLSServer server;
+        SocketOptions opts;
+        opts.max_frame_bytes = 4096;
+        server.setSocketOptions(opts);
+        std::atomic<int> received{0};
+        std::atomic<bool> rejected{false};
+        std::string reject_error;
+        std::mutex reject_mutex;
+        server.setConnectionCallback([&](std::unique_ptr<TLSSocket> c) {
+            while (c->receiveMessage()) received++;
+            std::lock_guard<std::mutex> lk(reject_mutex);
+            reject_error = c->getLastError();
+            rejected = true;
+        });
+        ok("server start (max frame)", server.start(port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket client;
+        ok("connect (max frame)", client.connect("127.0.0.1", port));
+        ok("small frame", client.sendMessage(*MessageFactory::createHeartbeat()));
+        auto big = MessageFactory::createSuccessResponse("big");
+        big->addString("blob", std::string(8192, 'x'));
+        client.sendMessage(*big);
+        for (int i = 0; i < 100 && !rejected; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        {
+            std::lock_guard<std::mutex> lk(reject_mutex);
+            ok("oversized frame rejected", rejected && received == 1 &&
+                                           reject_error.find("Frame too large") != std::string::npos);
+        }
+        client.close();
+        server.stop();
+    }
+
+    std::cout << "Socket options test passed.\n";
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+#include "server/SessionStore.h"
+#include "server/StateSnapshot.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+// Prepiše bajt u fajlu (oštećen snimak)
+static void corrupt(const std::string& path, long offset) {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(offset);
+    char c = 0;
+    f.get(c);
+    f.seekp(offset);
+    f.put(static_cast<char>(c ^ 0x5A));
+}
+
+static std::unique_ptr<Message> exchange(TLSSocket& sock, const Message& m) {
+    if (!sock.sendMessage(m)) return nullptr;
+    return sock.receiveMessage();
+}
+
+static bool request(TLSSocket& sock, const Message& m) {
+    auto r = exchange(sock, m);
+    return r && r->getType() == MessageType::RESPONSE_SUCCESS;
+}
+
+// Slobodna mjesta nakon kupovine ili "E<kod greške>"; sa sesijom se korisnik ne šalje
+static std::string buy(TLSSocket& sock, const std::string& urn, const std::string& session = "") {
+    auto m = MessageFactory::createPurchaseTicket(TicketType::INDIVIDUAL, VehicleType::BUS, "R_4", 1);
+    if (session.empty()) m->addString("urn", urn);
+    else                 m->addString("session_id", session);
+    auto r = exchange(sock, *m);
+    if (!r) return "";
+    if (r->getType() != MessageType::RESPONSE_SUCCESS) return "E" + std::to_string(r->getInt("error_code"));
+    return r->getString("available_seats");
+}
+
+int main() {
+    const std::string snap = "test_state_snapshot.bin";
+    std::remove(snap.c_str());
+
+    // -------- 1) Format: upis/čitanje, CRC, markConsumed --------
+    {
+        StateSnapshot::Data d;
+        d.created_ms = 1234567;
+        d.clean      = true;
+        d.source     = "x.db";
+        d.vehicles_max_rowid = 7;
+        Vehicle v{};
+        v.uri = "bus://1"; v.type = VehicleType::TRAM; v.route = "R_1";
+        v.capacity = 40; v.available_seats = 17; v.active = true;
+        d.vehicles.push_back(v);
+        d.sessions.push_back({std::string(SessionStore::kTokenLength, 'a'), "1111111111111", 500});
+        d.users  = {"1111111111111", "2222222222222"};
+        d.groups = {"tim"};
+        std::string err;
+        ok("write", StateSnapshot::write(snap, d, &err));
+
+        StateSnapshot::Data r;
+        ok("read", StateSnapshot::read(snap, r, &err) == StateSnapshot::ReadResult::OK);
+        ok("header fields", r.clean && r.created_ms == 1234567 && r.source == "x.db" && r.vehicles_max_rowid == 7);
+        ok("vehicle", r.vehicles.size() == 1 && r.vehicles[0].uri == "bus://1" &&
+                      r.vehicles[0].type == VehicleType::TRAM && r.vehicles[0].route == "R_1" &&
+                      r.vehicles[0].capacity == 40 && r.vehicles[0].available_seats == 17 && r.vehicles[0].active);
+        ok("session", r.sessions.size() == 1 && r.sessions[0].user_urn == "1111111111111" &&
+                      r.sessions[0].idle_ms == 500);
+        ok("keys", r.users == d.users && r.groups == d.groups);
+
+        ok("mark consumed", StateSnapshot::markConsumed(snap));
+        ok("consumed: still readable, not clean", StateSnapshot::read(snap, r) == StateSnapshot::ReadResult::OK && !r.clean && r.sessions.size() == 1);
+
+        corrupt(snap, 100);
+        ok("corrupt body rejected", StateSnapshot::read(snap, r, &err) == StateSnapshot::ReadResult::INVALID && !err.empty());
+        ok("rewrite", StateSnapshot::write(snap, d));
+        corrupt(snap, 2);
+        ok("corrupt header not consumable", !StateSnapshot::markConsumed(snap) &&
+                                            StateSnapshot::read(snap, r) == StateSnapshot::ReadResult::INVALID);
+        ok("missing file", StateSnapshot::read("nema_snimka.bin", r) == StateSnapshot::ReadResult::MISSING);
+    }
+    std::remove(snap.c_str());
+
+    // -------- 2) SessionStore: izvoz/vraćanje sa neaktivnošću --------
+    {
+        SessionStore a(std::chrono::seconds(60));
+        const std::string t = a.create("1111111111111");
+        auto exported = a.exportSessions();
+        ok("exported", exported.size() == 1 && exported[0].session_id == t && exported[0].idle.count() < 1000);
+
+        SessionStore b(std::chrono::seconds(60));
+        ok("restore", b.restore(exported[0]) && b.contains(t));
+        ok("duplicate restore rejected", !b.restore(exported[0]));
+        ok("expired not restored", !b.restore({SessionStore::generateToken(), "1", std::chrono::seconds(60)}));
+        ok("bad token rejected", !b.restore({"abc", "1", std::chrono::seconds(0)}));
+        // Neaktivna 59 s od 60: ističe za ~1 s
+        const std::string old = SessionStore::generateToken();
+        ok("restore old", b.restore({old, "2", std::chrono::seconds(59)}));
+        ok("old expires", b.expire(SessionStore::Clock::now() + std::chrono::seconds(3)) >= 1 && !b.contains(old));
+        ok("fresh kept", b.contains(t));
+    }
+
+    // -------- 3) CentralServer: uredan restart vraća sesije i inventar --------
+    const std::string db_path = "test_state_snapshot.db";
+    const std::string urn     = "4444444444444";
+    std::remove(db_path.c_str());
+    std::string session;
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setSnapshotPath(snap);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("server start (no snapshot)", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket c;
+        ok("connect", c.connect("127.0.0.1", port));
+        ok("register vehicle", request(c, *MessageFactory::createRegisterDevice("bus://4", VehicleType::BUS)));
+        ok("route", request(c, *MessageFactory::createUpdateVehicle("bus://4", true, std::string("R_4"))));
+        ok("capacity", request(c, *MessageFactory::createUpdateCapacity("bus://4", 10, 10)));
+        ok("register user", request(c, *MessageFactory::createRegisterUser(urn)));
+        auto auth = exchange(c, *MessageFactory::createAuthRequest(urn));
+        session = auth ? auth->getString("token") : "";
+        ok("session", session.size() == SessionStore::kTokenLength && server.getActiveSessionCount() == 1);
+        ok("group", request(c, *MessageFactory::createGroupCreate("snap_tim", urn)));
+        ok("purchase", buy(c, urn) == "9");
+        c.close();
+        server.stop();
+    }
+    {
+        StateSnapshot::Data d;
+        ok("clean snapshot on stop", StateSnapshot::read(snap, d) == StateSnapshot::ReadResult::OK && d.clean && d.source == db_path);
+        ok("snapshot content", d.sessions.size() == 1 && d.sessions[0].session_id == session &&
+                               d.vehicles.size() == 1 && d.vehicles[0].available_seats == 9);
+        bool has_group = false;
+        for (const auto& g : d.groups) has_group = has_group || g == "snap_tim";
+        ok("hot keys", !d.users.empty() && has_group);
+    }
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setSnapshotPath(snap);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("warm restart", server.start(port, ""));
+        ok("session restored", server.getActiveSessionCount() == 1);
+        StateSnapshot::Data d;
+        ok("snapshot consumed", StateSnapshot::read(snap, d) == StateSnapshot::ReadResult::OK && !d.clean);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        TLSSocket c;
+        ok("connect after restart", c.connect("127.0.0.1", port));
+        ok("restored session accepted, inventory continues", buy(c, urn, session) == "8");
+        c.close();
+        server.stop();
+    }
+    {
+        // Pad: zadnji snimak je periodični (nije clean) -> sesije se ne vraćaju, inventar iz baze
+        StateSnapshot::Data d;
+        ok("read before crash", StateSnapshot::read(snap, d) == StateSnapshot::ReadResult::OK && d.clean);
+        d.clean = false;
+        ok("periodic snapshot", StateSnapshot::write(snap, d));
+
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setSnapshotPath(snap);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("restart after crash", server.start(port, ""));
+        ok("sessions not restored", server.getActiveSessionCount() == 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        TLSSocket c;
+        ok("connect after crash", c.connect("127.0.0.1", port));
+        ok("old session rejected", buy(c, urn, session) == "E401");
+        ok("inventory from database", buy(c, urn) == "7");
+        c.close();
+        server.stop();
+    }
+    {
+        // Snimak druge baze se ignoriše
+        StateSnapshot::Data d;
+        ok("read", StateSnapshot::read(snap, d) == StateSnapshot::ReadResult::OK && d.clean);
+        d.source = "druga.db";
+        ok("foreign snapshot", StateSnapshot::write(snap, d));
+
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setSnapshotPath(snap);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("start with foreign snapshot", server.start(port, ""));
+        ok("foreign sessions ignored", server.getActiveSessionCount() == 0);
+        server.stop();
+    }
+    {
+        // Clean snimak, a baza je van servera dobila vozilo: inventar se učita iz baze
+        {
+            Database db;
+            ok("open db", db.initialize(db_path));
+            Vehicle v{};
+            v.uri = "bus://5"; v.type = VehicleType::BUS; v.route = "R_5";
+            v.capacity = 5; v.available_seats = 5; v.active = true;
+            ok("vehicle added offline", db.registerVehicle(v));
+        }
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setSnapshotPath(snap);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("start with stale snapshot", server.start(port, ""));
+        ok("inventory reloaded from database", server.getSeatInventoryStats().vehicles == 2);
+        server.stop();
+    }
+    std::remove(db_path.c_str());
+    std::remove(snap.c_str());
+
+    std::cout << "All state snapshot tests passed" << std::endl;
+    return 0;
+}
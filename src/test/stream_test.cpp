@@ -1,6 +1,7 @@
 #include "common/Message.h"
 #include <cassert>
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <cstring>
 #include <arpa/inet.h>
@@ -119,6 +120,45 @@ int main() {
     bool ok_bad = bad.deserializeStream(half); // treba biti false
     ok("deserializeStream(incomplete) fails", !ok_bad);
 
+    // 8) Inkrementalna dužina + serializeTo u bafer pozivaoca (checksum u istom prolazu)
+    Message inc(MessageType::RESPONSE_SUCCESS);
+    inc.addString("k", "short");
+    inc.addString("k", "a much longer value");   // prepis postojećeg ključa
+    inc.addInt("n", 7);
+    inc.calculateChecksum();
+    std::vector<uint8_t> pooled = {0xAA, 0xBB};  // bafer već sadrži nešto
+    inc.serializeTo(pooled);
+    ok("serializeTo appends", pooled.size() == 2 + inc.size());
+    std::vector<uint8_t> frame_only(pooled.begin() + 2, pooled.end());
+    ok("serializeTo == serialize", frame_only == inc.serialize());
+    Message inc2;
+    ok("deserialize(serializeTo)", inc2.deserialize(frame_only));
+    ok("incremental length matches payload", inc2.getLength() == inc.getLength());
+    ok("checksum from single pass valid", inc2.verifyChecksum());
+
+    // 9) serializeTo je const: paralelna serijalizacija iste poruke daje iste okvire,
+    //    a finalize() zapamti checksum (isti bajtovi kao odgođeni)
+    Message shared(MessageType::RESPONSE_SUCCESS);
+    shared.addString("route", "Sarajevo-Mostar");
+    shared.addInt("seats", 42);
+    shared.calculateChecksum();
+    const auto reference = shared.serialize();
+    std::vector<std::vector<uint8_t>> frames(4);
+    {
+        std::vector<std::thread> threads;
+        for (auto& f : frames)
+            threads.emplace_back([&shared, &f] { for (int i = 0; i < 200; ++i) { f.clear(); shared.serializeTo(f); } });
+        for (auto& t : threads) t.join();
+    }
+    bool identical = true;
+    for (const auto& f : frames) identical = identical && f == reference;
+    ok("concurrent serializeTo frames identical", identical);
+    shared.finalize();
+    ok("finalize keeps frame", shared.serialize() == reference);
+    ok("finalized checksum valid", shared.verifyChecksum());
+    Message shared2;
+    ok("finalized frame verifies", shared2.deserialize(reference) && shared2.verifyChecksum());
+
     std::cout << "All stream/byte tests passed.\n";
     return 0;
 }
@@ -0,0 +1,282 @@
+#include "common/Database.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "common/Telemetry.h"
+#include "server/CentralServer.h"
+#include "server/TelemetryAggregator.h"
+#include "server/VehicleServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static bool waitUntil(const std::function<bool()>& cond, int ms = 3000) {
+    for (int i = 0; i < ms / 10; ++i) {
+        if (cond()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return cond();
+}
+
+static std::unique_ptr<Message> exchange(TLSSocket& sock, const Message& m) {
+    if (!sock.sendMessage(m)) return nullptr;
+    return sock.receiveMessage();
+}
+
+static bool request(TLSSocket& sock, const Message& m) {
+    auto r = exchange(sock, m);
+    return r && r->getType() == MessageType::RESPONSE_SUCCESS;
+}
+
+static TelemetrySample sample(const std::string& uri, uint64_t ts, int occupancy) {
+    return TelemetrySample{uri, ts, occupancy, 43856000, 18413000};
+}
+
+int main() {
+    // -------- 1) Kodiranje uzoraka --------
+    {
+        std::vector<TelemetrySample> in = {
+            {"bus://1", 1700000000000ull, 12, 43856430, 18413029},
+            {"bus://1", 1700000001000ull, 0, -33868820, -151209290},
+            {"tram://2", 1699999999000ull, 250, 0, 0},       // vrijeme unazad (delta < 0)
+        };
+        std::vector<uint8_t> blob;
+        telemetry::encodeSamples(in, blob);
+        std::vector<TelemetrySample> out;
+        ok("decode", telemetry::decodeSamples(blob, out) && out.size() == in.size());
+        bool same = true;
+        for (size_t i = 0; i < in.size(); ++i) {
+            same = same && out[i].uri == in[i].uri && out[i].timestamp_ms == in[i].timestamp_ms &&
+                   out[i].occupancy == in[i].occupancy && out[i].lat_e6 == in[i].lat_e6 && out[i].lon_e6 == in[i].lon_e6;
+        }
+        ok("round trip (negative coordinates, time going back)", same);
+        ok("compact", blob.size() < in.size() * 24);
+
+        std::vector<uint8_t> cut(blob.begin(), blob.end() - 2);
+        ok("truncated rejected", !telemetry::decodeSamples(cut, out));
+        std::vector<uint8_t> empty;
+        telemetry::encodeSamples({}, empty);
+        ok("empty frame", telemetry::decodeSamples(empty, out) && out.empty());
+    }
+
+    // -------- 2) Agregator: zadnje stanje po vozilu, zbir i prosjek po ruti --------
+    {
+        std::map<std::string, TelemetryAggregator::VehicleInfo> fleet = {
+            {"bus://1", {"R_1", 50}}, {"bus://2", {"R_1", 30}}, {"tram://3", {"R_3", 100}}};
+        std::mutex fleet_mutex;
+        TelemetryAggregator::Options opt;
+        opt.window = std::chrono::seconds(1);
+        TelemetryAggregator agg;
+        agg.configure(opt);
+        agg.start([&](const std::string& uri) -> std::optional<TelemetryAggregator::VehicleInfo> {
+            std::lock_guard<std::mutex> lk(fleet_mutex);
+            auto it = fleet.find(uri);
+            if (it == fleet.end()) return std::nullopt;
+            return it->second;
+        });
+
+        std::vector<TelemetrySample> frame = {sample("bus://1", 1000, 10), sample("bus://2", 1000, 5),
+                                              sample("tram://3", 1000, 40), sample("bus://9", 1000, 1),
+                                              sample("bus://1", 2000, 20)};
+        ok("submit", agg.submit(frame) == 5);
+        agg.drain();
+        auto r1 = agg.route("R_1");
+        ok("route sum", r1 && r1->vehicles == 2 && r1->occupancy == 25 && r1->capacity == 80 && r1->samples == 3);
+        ok("route average moves toward sum", r1 && r1->avg_occupancy > 15.0 && r1->avg_occupancy < 25.0);
+        auto st = agg.getStats();
+        ok("unknown vehicle counted", st.unknown_vehicle == 1 && st.processed == 4 && st.vehicles == 3 && st.routes == 2);
+
+        std::vector<TelemetrySample> old = {sample("bus://1", 1500, 99)};
+        agg.submit(old);
+        agg.drain();
+        ok("stale sample ignored", agg.getStats().stale == 1 && agg.route("R_1")->occupancy == 25);
+
+        auto changed = agg.takeChanged();
+        bool latest = false;
+        for (const auto& row : changed) latest = latest || (row.uri == "bus://1" && row.occupancy == 20 && row.samples == 2);
+        ok("changed vehicles", changed.size() == 3 && latest);
+        ok("taken once", agg.takeChanged().empty());
+        agg.markChanged(changed);
+        ok("failed write marked again", agg.takeChanged().size() == 3);
+
+        // Vozilo prebačeno na drugu rutu (admin izmjena)
+        {
+            std::lock_guard<std::mutex> lk(fleet_mutex);
+            fleet["bus://2"] = {"R_3", 30};
+        }
+        agg.refreshVehicles();
+        std::vector<TelemetrySample> next = {sample("bus://2", 3000, 7)};
+        agg.submit(next);
+        agg.drain();
+        ok("vehicle moved between routes", agg.route("R_1")->occupancy == 20 && agg.route("R_1")->vehicles == 1 &&
+                                           agg.route("R_3")->occupancy == 47 && agg.route("R_3")->capacity == 130);
+
+        // Sat vozila ispred servera: vrijeme se ograniči na sat + max_skew, sljedeći uzorak nije zastario
+        const uint64_t now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        std::vector<TelemetrySample> ahead = {sample("tram://3", now_ms + 3600 * 1000, 41)};
+        agg.submit(ahead);
+        std::vector<TelemetrySample> later = {sample("tram://3", now_ms + 120 * 1000, 42)};
+        agg.submit(later);
+        agg.drain();
+        ok("future timestamp clamped", agg.getStats().stale == 1 && agg.route("R_3")->occupancy == 49);
+        agg.stop();
+    }
+
+    // -------- 3) Pun red odbacuje uzorke --------
+    {
+        std::atomic<bool> entered{false}, release{false};
+        TelemetryAggregator::Options opt;
+        opt.queue_size = 16;
+        TelemetryAggregator agg;
+        agg.configure(opt);
+        agg.start([&](const std::string&) -> std::optional<TelemetryAggregator::VehicleInfo> {
+            entered = true;
+            while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return TelemetryAggregator::VehicleInfo{"R", 10};
+        });
+        std::vector<TelemetrySample> first = {sample("bus://1", 1, 1)};
+        agg.submit(first);
+        ok("aggregator busy", waitUntil([&] { return entered.load(); }));
+
+        std::vector<TelemetrySample> burst;
+        for (int i = 0; i < 100; ++i) burst.push_back(sample("bus://1", 2 + i, i));
+        const size_t accepted = agg.submit(burst);
+        release = true;
+        ok("bounded queue", accepted == 16 && agg.getStats().dropped == 84);
+        agg.stop();
+        ok("queued samples processed on stop", agg.getStats().processed == 17 && agg.route("R")->occupancy == 15);
+        std::vector<TelemetrySample> late = {sample("bus://1", 500, 1)};
+        ok("stopped aggregator rejects", agg.submit(late) == 0);
+        agg.drain();
+        ok("drain after stop returns", agg.getStats().processed == 17);
+    }
+
+    // -------- 4) CentralServer: VEHICLE_TELEMETRY -> baza i slobodna mjesta --------
+    const std::string db_path = "test_telemetry.db";
+    std::remove(db_path.c_str());
+    {
+        const int port = pick_port();
+        CentralServer server;
+        server.setDatabasePath(db_path);
+        server.setCertificatePath("certs/server.crt", "certs/server.key");
+        server.setTelemetryFeedSeats(true);
+        ok("central start", server.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket c;
+        ok("connect", c.connect("127.0.0.1", port));
+        ok("register vehicle", request(c, *MessageFactory::createRegisterDevice("bus://7", VehicleType::BUS)));
+        ok("route", request(c, *MessageFactory::createUpdateVehicle("bus://7", true, std::string("R_7"))));
+        ok("capacity", request(c, *MessageFactory::createUpdateCapacity("bus://7", 10, 10)));
+
+        auto r = exchange(c, *MessageFactory::createVehicleTelemetry(
+            {sample("bus://7", 1000, 3), sample("bus://7", 2000, 4), sample("bus://404", 2000, 1)}));
+        ok("telemetry accepted", r && r->getType() == MessageType::RESPONSE_SUCCESS &&
+                                 r->getString("accepted") == "3" && r->getString("dropped") == "0");
+
+        Message bad(MessageType::VEHICLE_TELEMETRY);
+        bad.addBinary("samples", std::vector<uint8_t>{0x05, 0x10});
+        bad.calculateChecksum();
+        auto e = exchange(c, bad);
+        ok("malformed frame 400", e && e->getType() == MessageType::RESPONSE_ERROR && e->getInt("error_code") == 400);
+
+        ok("aggregated", waitUntil([&] {
+            auto s = server.getTelemetryStats();
+            return s.processed == 2 && s.unknown_vehicle == 1;
+        }));
+        bool route_ok = false;
+        for (const auto& a : server.getRouteTelemetry()) {
+            route_ok = route_ok || (a.route == "R_7" && a.occupancy == 4 && a.capacity == 10 && a.vehicles == 1);
+        }
+        ok("route aggregate", route_ok);
+        ok("stats exported", server.getSystemStatistics()["telemetry_accepted"] == 3);
+        c.close();
+        server.stop();
+    }
+    {
+        Database db;
+        ok("open db", db.initialize(db_path));
+        auto t = db.getVehicleTelemetry("bus://7");
+        ok("latest state persisted", t && t->occupancy == 4 && t->sample_ms == 2000 && t->samples == 2);
+        ok("unknown vehicle not persisted", db.getVehicleTelemetry("bus://404") == nullptr);
+        auto v = db.getVehicle("bus://7");
+        ok("seats from occupancy", v && v->available_seats == 6);
+    }
+
+    // -------- 5) Edge čvor: spajanje po vozilu i slanje u okvirima --------
+    {
+        const std::string edge_urn = "7100000000001";
+        const int central_port = pick_port();
+        auto central = std::make_unique<CentralServer>();
+        central->setDatabasePath(db_path);
+        central->setCertificatePath("certs/server.crt", "certs/server.key");
+        central->setWorkerPool(true, 2);
+        ok("central restart", central->start(central_port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        {
+            TLSSocket admin;
+            ok("admin connect", admin.connect("127.0.0.1", central_port));
+            ok("edge user", request(admin, *MessageFactory::createRegisterUser(edge_urn)));
+            admin.close();
+        }
+
+        const int edge_port = pick_port();
+        VehicleServer edge;
+        edge.setCertificates("certs/server.crt", "certs/server.key");
+        edge.setCentralServer("127.0.0.1", central_port);
+        edge.setEdgeIdentity(edge_urn);
+        ok("edge start", edge.start(edge_port, ""));
+        ok("edge link up", waitUntil([&] { return edge.getEdgeStats().link_up; }));
+
+        TLSSocket dev;
+        ok("device connect", dev.connect("127.0.0.1", edge_port));
+        auto a = exchange(dev, *MessageFactory::createVehicleTelemetry({sample("bus://7", 5000, 8)}));
+        auto b = exchange(dev, *MessageFactory::createVehicleTelemetry({sample("bus://7", 6000, 9)}));
+        ok("acknowledged by edge", a && b && a->getType() == MessageType::RESPONSE_SUCCESS &&
+                                   b->getString("accepted") == "1");
+        ok("forwarded to central", waitUntil([&] {
+            for (const auto& r : central->getRouteTelemetry()) {
+                if (r.route == "R_7" && r.occupancy == 9) return true;
+            }
+            return false;
+        }));
+        const auto es = edge.getEdgeStats();
+        ok("coalesced per vehicle", es.telemetry_received == 2 && es.telemetry_forwarded <= 2 && es.telemetry_dropped == 0);
+        dev.close();
+        edge.stop();
+        central->stop();
+        central.reset();
+
+        Database db;
+        ok("open db", db.initialize(db_path));
+        auto t = db.getVehicleTelemetry("bus://7");
+        ok("edge sample persisted", t && t->occupancy == 9 && t->sample_ms == 6000);
+    }
+    std::remove(db_path.c_str());
+
+    std::cout << "All telemetry tests passed" << std::endl;
+    return 0;
+}
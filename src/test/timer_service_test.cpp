@@ -0,0 +1,149 @@
+#include "common/Message.h"
+#include "common/Metrics.h"
+#include "common/TimerService.h"
+#include "common/TLSSocket.h"
+#include "server/CentralServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+int main() {
+    using std::chrono::milliseconds;
+
+    // -------- 1) Periodični poslovi, otkazivanje, run_now --------
+    {
+        TimerService timers;
+        std::atomic<int> fast{0}, slow{0}, now{0}, cancelled{0};
+        timers.schedule("fast", milliseconds(20), [&] { fast++; });
+        timers.schedule("slow", milliseconds(100), [&] { slow++; });
+        timers.schedule("now", std::chrono::hours(1), [&] { now++; }, /*run_now*/ true);
+        const auto id = timers.schedule("cancelled", milliseconds(20), [&] { cancelled++; });
+        timers.schedule("throws", milliseconds(30), [] { throw std::runtime_error("task failure"); });
+        ok("tasks scheduled", timers.size() == 5);
+        ok("cancel known id", timers.cancel(id) && !timers.cancel(id));
+
+        timers.start();
+        std::this_thread::sleep_for(milliseconds(450));
+        ok("fast task repeats", fast >= 10);
+        ok("slow task runs less often", slow >= 2 && slow < fast);
+        ok("run_now runs once immediately", now == 1);
+        ok("cancelled task never runs", cancelled == 0);
+        ok("failing task does not stop service", timers.running() && timers.runs() > 0);
+
+        // Dugi intervali: stop() ne čeka sljedeći rok
+        timers.schedule("long", std::chrono::hours(1), [] {});
+        const auto t0 = std::chrono::steady_clock::now();
+        timers.stop();
+        ok("stop is immediate", elapsed_ms(t0) < 100.0);
+        ok("stop clears tasks", timers.size() == 0 && !timers.running());
+        const int after_stop = fast;
+        std::this_thread::sleep_for(milliseconds(60));
+        ok("no runs after stop", fast == after_stop);
+
+        // Ponovno pokretanje
+        std::atomic<int> again{0};
+        timers.schedule("again", milliseconds(10), [&] { again++; });
+        timers.start();
+        std::this_thread::sleep_for(milliseconds(100));
+        ok("restart after stop", again >= 3);
+
+        // stop() iz samog posla
+        std::atomic<bool> stopped{false};
+        timers.schedule("self-stop", milliseconds(10), [&] { timers.stop(); stopped = true; });
+        std::this_thread::sleep_for(milliseconds(100));
+        ok("stop from task", stopped && !timers.running());
+    }
+
+    // -------- 2) CentralServer: heartbeat i zatvaranje neaktivne konekcije --------
+    // Oba moda: thread-per-connection (sync sonda) i WORKER_POOL (sonda na strand-u)
+    const std::string db_path = "test_timer_service.db";
+    for (const bool worker_pool : {false, true}) {
+        std::remove(db_path.c_str());
+        std::cout << "-- " << (worker_pool ? "worker pool" : "thread per connection") << std::endl;
+        auto& registry  = metrics::Registry::instance();
+        auto& sent      = registry.counter("tp_heartbeats_sent_total", "server=\"CentralServer\"");
+        auto& reaped    = registry.counter("tp_connections_reaped_total", "server=\"CentralServer\"");
+        const auto sent0   = sent.value();
+        const auto reaped0 = reaped.value();
+
+        const int port = pick_port();
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        central.setHeartbeat(true, 1);
+        central.setConnectionTimeout(4);
+        if (worker_pool) central.setWorkerPool(true, 2);
+        ok("central start", central.start(port, ""));
+        std::this_thread::sleep_for(milliseconds(100));
+
+        // Aktivan klijent: odgovor na HEARTBEAT, konekcija ostaje
+        TLSSocket active;
+        ok("active connect", active.connect("127.0.0.1", port));
+        ok("heartbeat request", active.sendMessage(*MessageFactory::createHeartbeat()));
+        auto alive = active.receiveMessage();
+        ok("heartbeat answered", alive && alive->getType() == MessageType::RESPONSE_SUCCESS);
+        active.close();
+
+        // Slušalac: samo čeka push poruke, na sonde uzvraća keepalive-om
+        TLSSocket listener;
+        ok("listener connect", listener.connect("127.0.0.1", port));
+        std::atomic<bool> listener_failed{false};
+        std::atomic<int>  listener_reply{-1};
+        listener.asyncReceiveMessage(
+            [&](std::unique_ptr<Message> msg) { listener_reply = static_cast<int>(msg->getType()); },
+            [&](const std::string&) { listener_failed = true; });
+
+        // Mrtav peer: konekcija otvorena, ali ne čita pa ni ne odgovara na sonde
+        TLSSocket dead;
+        ok("dead peer connect", dead.connect("127.0.0.1", port));
+        std::this_thread::sleep_for(milliseconds(6000));
+        ok("heartbeats sent to idle connections", sent.value() - sent0 >= 2);
+        ok("dead peer reaped", reaped.value() - reaped0 == 1);
+        const auto t0 = std::chrono::steady_clock::now();
+        auto nothing = dead.receiveMessage();    // baferisane sonde, pa kraj
+        ok("dead peer connection closed by server", !nothing);
+        ok("dead peer sees close promptly", elapsed_ms(t0) < 2000.0);
+
+        // Slušalac je preživio connection_timeout i konekcija i dalje radi
+        ok("idle listener not closed", !listener_failed && listener_reply == -1);
+        ok("listener request", listener.asyncSendMessage(*MessageFactory::createHeartbeat()));
+        for (int i = 0; i < 200 && listener_reply == -1 && !listener_failed; ++i)
+            std::this_thread::sleep_for(milliseconds(10));
+        ok("idle listener still served",
+           listener_reply == static_cast<int>(MessageType::RESPONSE_SUCCESS));
+        ok("only the dead peer reaped", reaped.value() - reaped0 == 1);
+
+        const auto t1 = std::chrono::steady_clock::now();
+        central.stop();
+        ok("central stop does not wait for intervals", elapsed_ms(t1) < 1500.0);
+        listener.close();
+        dead.close();
+    }
+    std::remove(db_path.c_str());
+
+    std::cout << "All timer service tests passed" << std::endl;
+    return 0;
+}
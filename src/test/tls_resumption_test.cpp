@@ -0,0 +1,129 @@
+#include "common/Message.h"
+#include "common/TLSServer.h"
+#include "common/TLSSocket.h"
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+// Echo jedne poruke: klijent čitanjem odgovora preuzme i TLS 1.3 ticket
+static void echoOnce(std::unique_ptr<TLSSocket> c) {
+    auto m = c->receiveMessage();
+    if (m) c->sendMessage(*m);
+}
+
+struct Round {
+    double avg_us{0};
+    int    resumed{0};
+};
+
+static Round reconnects(int port, int n, bool resumption) {
+    Round r;
+    double total = 0;
+    for (int i = 0; i < n; ++i) {
+        TLSSocket c;
+        c.setSessionResumption(resumption);
+        const auto t0 = std::chrono::steady_clock::now();
+        if (!c.connect("127.0.0.1", port)) return r;
+        total += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        if (c.isSessionResumed()) r.resumed++;
+        c.sendMessage(*MessageFactory::createHeartbeat());
+        c.receiveMessage();
+        c.close();
+    }
+    r.avg_us = total / n;
+    return r;
+}
+
+int main() {
+    // -------- 1) Puni handshake vs nastavak sesije --------
+    {
+        const int port = pick_port();
+        TLSServer server;
+        server.setConnectionCallback(echoOnce);
+        ok("server start", server.start(port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const int kRounds = 30;
+        const Round full    = reconnects(port, kRounds, /*resumption*/ false);
+        const Round resumed = reconnects(port, kRounds, /*resumption*/ true);
+        std::cout << "  full handshake:    " << full.avg_us << " us avg (" << kRounds << " connects)\n"
+                  << "  resumed handshake: " << resumed.avg_us << " us avg, "
+                  << resumed.resumed << "/" << kRounds << " resumed\n";
+        ok("no resumption when disabled", full.resumed == 0 && full.avg_us > 0);
+        // Prva konekcija u drugoj rundi može koristiti ticket iz prve (isti kontekst)
+        ok("reconnects resume the session", resumed.resumed >= kRounds - 1);
+        const auto st = server.getStats();
+        ok("server counted resumed handshakes", st.handshakes == 2u * kRounds &&
+                                                st.resumed == static_cast<uint64_t>(resumed.resumed));
+        server.stop();
+    }
+
+    // -------- 2) Server bez nastavka sesije: klijent radi puni handshake --------
+    {
+        const int port = pick_port();
+        TLSServer server;
+        server.setSessionResumption(false);
+        server.setConnectionCallback(echoOnce);
+        ok("server start (no resumption)", server.start(port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const Round r = reconnects(port, 5, /*resumption*/ true);
+        ok("server-side resumption off", r.avg_us > 0 && r.resumed == 0 && server.getStats().resumed == 0);
+        server.stop();
+    }
+
+    // -------- 3) Rok za handshake: TCP bez ClientHello se zatvara --------
+    {
+        const int port = pick_port();
+        TLSServer server;
+        server.setHandshakeTimeout(std::chrono::milliseconds(200));
+        server.setConnectionCallback(echoOnce);
+        ok("server start (handshake timeout)", server.start(port, "certs/server.crt", "certs/server.key"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        boost::asio::io_context io;
+        boost::asio::ip::tcp::socket idle(io);
+        boost::system::error_code ec;
+        idle.connect({boost::asio::ip::make_address("127.0.0.1"), static_cast<unsigned short>(port)}, ec);
+        ok("idle tcp connect", !ec);
+        const auto t0 = std::chrono::steady_clock::now();
+        char byte;
+        idle.read_some(boost::asio::buffer(&byte, 1), ec);   // EOF kad server zatvori
+        const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        std::cout << "  idle connection closed after " << waited << " ms\n";
+        ok("stalled handshake closed", ec && waited < 5000);
+        // Brojač se uvećava u handshake completion-u, odmah nakon zatvaranja
+        for (int i = 0; i < 100 && server.getStats().timed_out == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ok("timeout counted", server.getStats().timed_out == 1 && server.getStats().handshakes == 0);
+
+        // Normalan klijent i dalje prolazi
+        TLSSocket c;
+        ok("regular client after timeout", c.connect("127.0.0.1", port));
+        c.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        server.stop();
+    }
+
+    std::cout << "TLS resumption test passed.\n";
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "common/Tracing.h"
+#include "server/CentralServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+static std::unique_ptr<Message> call(TLSSocket& sock, std::unique_ptr<Message> m) {
+    if (!sock.sendMessage(*m)) return nullptr;
+    auto reply = sock.receiveMessage();
+    while (reply && reply->getType() == MessageType::MULTICAST_UPDATE) reply = sock.receiveMessage();
+    return reply;
+}
+
+// Isti trace, pa korijenski zahtjev klijenta kao predak
+static std::vector<tracing::SpanRecord> ofTrace(const std::vector<tracing::SpanRecord>& spans,
+                                                const tracing::TraceContext& ctx) {
+    std::vector<tracing::SpanRecord> out;
+    for (const auto& s : spans) {
+        if (s.trace_hi == ctx.trace_hi && s.trace_lo == ctx.trace_lo) out.push_back(s);
+    }
+    return out;
+}
+
+static const tracing::SpanRecord* byName(const std::vector<tracing::SpanRecord>& spans, const std::string& name) {
+    for (const auto& s : spans) {
+        if (s.decoded_name == name) return &s;
+    }
+    return nullptr;
+}
+
+int main() {
+    auto& tracer = tracing::Tracer::instance();
+
+    // -------- 1) traceparent --------
+    {
+        tracing::TraceContext ctx{0x0123456789abcdefULL, 0xfedcba9876543210ULL, 0x1122334455667788ULL, true};
+        const std::string header = ctx.toHeader();
+        ok("header format", header == "00-0123456789abcdeffedcba9876543210-1122334455667788-01");
+        const auto parsed = tracing::TraceContext::parse(header);
+        ok("header round-trip", parsed.trace_hi == ctx.trace_hi && parsed.trace_lo == ctx.trace_lo &&
+                                parsed.span_id == ctx.span_id && parsed.sampled);
+        ok("unsampled flag", !tracing::TraceContext::parse(header.substr(0, 53) + "00").sampled);
+        ok("invalid header", !tracing::TraceContext::parse("00-xyz").valid() &&
+                             !tracing::TraceContext::parse(std::string(55, '0')).valid() &&
+                             !tracing::TraceContext::parse("00-00000000000000000000000000000000-1122334455667788-01").valid());
+    }
+
+    // -------- 2) Isključen tracer: spanovi bez efekta --------
+    {
+        tracing::Span span("noop", tracing::TraceContext{}, 0);
+        ok("disabled tracer records nothing", !span.sampled() && !tracing::current().valid());
+        Message m(MessageType::RESERVE_SEAT);
+        tracing::inject(m);
+        ok("disabled tracer injects nothing", !m.hasKey(tracing::kTraceField));
+    }
+
+    // -------- 3) Uzorkovanje, ugniježđeni spanovi, izvoz --------
+    const std::string trace_path = "test_tracing.bin";
+    std::remove(trace_path.c_str());
+    {
+        tracing::Tracer::Options opt;
+        opt.service     = "tracing_test";
+        opt.export_path = trace_path;
+        opt.sample_rate = 0.0;
+        ok("configure", tracer.configure(opt));
+        {
+            tracing::Span root("root", tracing::TraceContext{}, 7);
+            ok("sample rate 0", !root.sampled());
+        }
+        opt.sample_rate = 1.0;
+        ok("reconfigure", tracer.configure(opt));
+
+        tracing::TraceContext root_ctx, child_ctx;
+        {
+            tracing::Span root("root", tracing::TraceContext{}, 7);
+            ok("sample rate 1", root.sampled() && root.context().valid());
+            root_ctx = root.context();
+            {
+                tracing::Span child("child");
+                child_ctx = child.context();
+                child.setStatus(404);
+                ok("child is current", tracing::current().span_id == child_ctx.span_id);
+                tracing::recordSpan("step", std::chrono::steady_clock::now() - std::chrono::microseconds(50), 50000);
+            }
+            ok("parent restored", tracing::current().span_id == root_ctx.span_id);
+            Message m(MessageType::RESERVE_SEAT);
+            tracing::inject(m);
+            const auto ctx = tracing::extract(m);
+            ok("inject/extract", ctx.sampled && ctx.span_id == root_ctx.span_id && ctx.trace_lo == root_ctx.trace_lo);
+        }
+        ok("no context after root", !tracing::current().valid());
+        ok("flush", tracer.flush());
+
+        std::vector<tracing::SpanRecord> spans;
+        ok("read export", tracing::Tracer::readSpans(trace_path, spans) && spans.size() == 3);
+        const auto* root  = byName(spans, "root");
+        const auto* child = byName(spans, "child");
+        const auto* step  = byName(spans, "step");
+        ok("span names", root && child && step);
+        ok("root has no parent", root->parent_id == 0 && root->message_type == 7 && root->service == "tracing_test");
+        ok("child parent/status", child->parent_id == root_ctx.span_id && child->status == 404 &&
+                                  child->trace_hi == root_ctx.trace_hi && child->trace_lo == root_ctx.trace_lo);
+        ok("recorded step", step->parent_id == child_ctx.span_id && step->duration_ns == 50000);
+        ok("timestamps", root->start_unix_ns > 0 && child->start_unix_ns >= root->start_unix_ns &&
+                         root->duration_ns >= child->duration_ns);
+    }
+
+    // -------- 4) Klijent -> CentralServer: server nastavlja trace iz poruke --------
+    std::remove(trace_path.c_str());
+    const std::string db_path = "test_tracing.db";
+    std::remove(db_path.c_str());
+    {
+        tracing::Tracer::Options opt;
+        opt.service     = "CentralServer";
+        opt.export_path = trace_path;
+        opt.sample_rate = 0.0;          // server ne započinje vlastite trace-ove
+        ok("configure for server", tracer.configure(opt));
+
+        const int port = pick_port();
+        CentralServer central;
+        central.setDatabasePath(db_path);
+        central.setCertificatePath("certs/server.crt", "certs/server.key");
+        ok("central start", central.start(port, ""));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        TLSSocket client;
+        ok("connect", client.connect("127.0.0.1", port));
+
+        const std::string urn = "7272727272727";
+        call(client, MessageFactory::createRegisterUser(urn));
+        auto auth = call(client, MessageFactory::createAuthRequest(urn));
+        ok("auth", auth && auth->getBool("success"));
+        call(client, MessageFactory::createRegisterDevice("bus://72", VehicleType::BUS));
+        call(client, MessageFactory::createUpdateVehicle("bus://72", true, std::string("R72")));
+
+        // Uzorkovan kontekst "klijenta" (sample_rate procesa je 0)
+        const tracing::TraceContext client_ctx{0xa1a2a3a4a5a6a7a8ULL, 0xb1b2b3b4b5b6b7b8ULL, 0xc1c2c3c4c5c6c7c8ULL, true};
+        tracing::TraceContext reserve_ctx, register_ctx;
+        {
+            tracing::Span span("client.request", client_ctx, static_cast<uint16_t>(MessageType::RESERVE_SEAT));
+            reserve_ctx = span.context();
+            auto r = MessageFactory::createReserveSeat(VehicleType::BUS, "R72");
+            r->addString("urn", urn);
+            tracing::inject(*r);
+            auto reply = call(client, std::move(r));
+            ok("traced reservation", reply && reply->getType() == MessageType::RESPONSE_SUCCESS);
+        }
+        const tracing::TraceContext db_ctx{0xd1d2d3d4d5d6d7d8ULL, 0xe1e2e3e4e5e6e7e8ULL, 0xf1f2f3f4f5f6f7f8ULL, true};
+        {
+            tracing::Span span("client.request", db_ctx, static_cast<uint16_t>(MessageType::REGISTER_USER));
+            register_ctx = span.context();
+            auto r = MessageFactory::createRegisterUser("7373737373737");
+            tracing::inject(*r);
+            call(client, std::move(r));
+        }
+        {
+            // Bez traceparent-a nema spanova na serveru
+            auto r = MessageFactory::createReserveSeat(VehicleType::BUS, "R72");
+            r->addString("urn", urn);
+            call(client, std::move(r));
+        }
+        client.close();
+        central.stop();
+        ok("flush after requests", tracer.flush());
+
+        std::vector<tracing::SpanRecord> spans;
+        ok("read server export", tracing::Tracer::readSpans(trace_path, spans));
+        const auto reserve = ofTrace(spans, client_ctx);
+        const auto* request = byName(reserve, "central.request");
+        ok("central.request continues trace", request && request->parent_id == reserve_ctx.span_id &&
+                                              request->message_type == static_cast<uint16_t>(MessageType::RESERVE_SEAT));
+        std::set<uint64_t> ids;
+        for (const auto& s : reserve) ids.insert(s.span_id);
+        for (const char* name : {"tls.read", "decode", "inventory.reserve", "tls.write", "broadcast.publish"}) {
+            const auto* s = byName(reserve, name);
+            std::cout << "  span " << name << std::endl;
+            ok("server span present", s && ids.count(s->parent_id));
+        }
+        const auto* read = byName(reserve, "tls.read");
+        ok("receive before handler", read->parent_id == request->span_id && read->start_unix_ns <= request->start_unix_ns &&
+                                     request->start_unix_ns <= byName(reserve, "inventory.reserve")->start_unix_ns);
+
+        const auto reg = ofTrace(spans, db_ctx);
+        const auto* reg_request = byName(reg, "central.request");
+        ok("register traced", reg_request && reg_request->parent_id == register_ctx.span_id);
+        ok("db spans", byName(reg, "db.pool.acquire") && byName(reg, "sqlite.statement"));
+
+        size_t other = 0;
+        for (const auto& s : spans) {
+            const bool known = (s.trace_hi == client_ctx.trace_hi && s.trace_lo == client_ctx.trace_lo) ||
+                               (s.trace_hi == db_ctx.trace_hi && s.trace_lo == db_ctx.trace_lo);
+            if (!known) other++;
+        }
+        ok("untraced requests export nothing", other == 0);
+        ok("nothing dropped", tracer.getStats().dropped == 0 && tracer.getStats().write_errors == 0);
+    }
+    tracer.shutdown();
+    std::remove(trace_path.c_str());
+    std::remove(db_path.c_str());
+
+    std::cout << "All tracing tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "common/Database.h"
+#include "common/UserCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+using namespace std::chrono;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static std::unique_ptr<User> makeUser(const std::string& urn, const std::string& name = "Test") {
+    auto u = std::make_unique<User>();
+    u->urn = urn;
+    u->name = name;
+    u->age = 30;
+    u->registration_date = "2026-01-01 00:00:00";
+    u->active = true;
+    u->pin_hash = "hash";
+    return u;
+}
+
+int main() {
+    // -------- 1) Čitanje kroz keš, negativni unosi --------
+    {
+        UserCache cache;
+        int loads = 0;
+        auto load_known = [&] { ++loads; return makeUser("1000000000001", "Ana"); };
+        auto load_none  = [&] { ++loads; return std::unique_ptr<User>(); };
+
+        auto a = cache.get("1000000000001", load_known);
+        auto b = cache.get("1000000000001", load_known);
+        ok("hit after first load", a && b && b->name == "Ana" && loads == 1);
+        ok("same record shared", a.get() == b.get());
+
+        ok("unknown urn", !cache.get("9999999999999", load_none) && loads == 2);
+        ok("negative entry answers without load", !cache.get("9999999999999", load_none) && loads == 2);
+        ok("negative entry visible in lookup", cache.lookup("9999999999999").missing);
+
+        const auto st = cache.getStats();
+        ok("stats", st.hits == 1 && st.negative_hits == 2 && st.misses == 2 && st.size == 2);
+
+        cache.invalidate("1000000000001");
+        ok("invalidate forces reload", cache.get("1000000000001", load_known) && loads == 3);
+
+        // Greška baze nije "ne postoji": sljedeći pokušaj opet ide u bazu
+        auto failed = [] { return true; };
+        ok("failed load", !cache.get("9000000000001", load_none, failed) && loads == 4);
+        ok("failed load not cached", !cache.lookup("9000000000001").hit());
+        ok("not-found still cached", !cache.get("9000000000002", load_none, [] { return false; }) &&
+                                     cache.lookup("9000000000002").missing);
+    }
+
+    // -------- 2) TTL negativnih unosa; negative_ttl = 0 --------
+    {
+        UserCache::Options opt;
+        opt.negative_ttl = seconds(1);
+        UserCache cache(opt);
+        auto t = cache.lookup("2000000000001");
+        cache.putMissing("2000000000001", t.ticket);
+        ok("negative cached", cache.lookup("2000000000001").missing);
+        std::this_thread::sleep_for(milliseconds(1100));
+        ok("negative expired", !cache.lookup("2000000000001").hit() && cache.size() == 0);
+
+        opt.negative_ttl = seconds(0);
+        cache.configure(opt);
+        t = cache.lookup("2000000000001");
+        cache.putMissing("2000000000001", t.ticket);
+        ok("negative disabled", !cache.lookup("2000000000001").hit());
+    }
+
+    // -------- 3) Učitavanje preteklo poništavanjem se ne upisuje --------
+    {
+        UserCache cache;
+        auto t = cache.lookup("3000000000001");                 // promašaj, čitanje "u toku"
+        cache.invalidate("3000000000001");                      // upis u bazu u međuvremenu
+        cache.put(makeUser("3000000000001", "stale"), t.ticket);
+        ok("stale load dropped", !cache.lookup("3000000000001").hit());
+
+        t = cache.lookup("3000000000001");
+        cache.put(makeUser("3000000000001", "fresh"), t.ticket);
+        auto hit = cache.lookup("3000000000001");
+        ok("fresh load stored", hit.user && hit.user->name == "fresh");
+    }
+
+    // -------- 4) CLOCK: korišteni unosi preživljavaju izbacivanje --------
+    {
+        UserCache::Options opt;
+        opt.capacity    = 4;
+        opt.shard_count = 1;
+        UserCache cache(opt);
+        auto none = [] { return std::unique_ptr<User>(); };
+        for (int i = 0; i < 4; ++i) {
+            const std::string urn = "400000000000" + std::to_string(i);
+            cache.get(urn, [&] { return makeUser(urn); });
+        }
+        cache.lookup("4000000000000");      // vruć
+        cache.lookup("4000000000002");      // vruć
+        cache.get("4000000000009", none);   // izbacuje prvi nekorišten (…01)
+        cache.get("4000000000008", none);   // pa sljedeći (…03)
+        ok("capacity bounded", cache.size() == 4 && cache.getStats().evictions == 2);
+        ok("referenced survive", cache.lookup("4000000000000").user && cache.lookup("4000000000002").user);
+        ok("cold evicted", !cache.lookup("4000000000001").hit() && !cache.lookup("4000000000003").hit());
+    }
+
+    // -------- 5) Upisi kroz Database poništavaju keš --------
+    const std::string db_path = "test_user_cache.db";
+    std::remove(db_path.c_str());
+    {
+        Database db;
+        ok("db open", db.initialize(db_path));
+        UserCache cache;
+        auto load = [&] { return db.getUser("5000000000001"); };
+
+        ok("not registered yet", !cache.get("5000000000001", load));
+        ok("register", db.registerUser(*makeUser("5000000000001", "Boris")));
+        auto user = cache.get("5000000000001", load);
+        ok("register clears negative entry", user && user->name == "Boris");
+
+        auto changed = makeUser("5000000000001", "Boris B.");
+        ok("update", db.updateUser(*changed));
+        user = cache.get("5000000000001", load);
+        ok("update invalidates", user && user->name == "Boris B.");
+
+        ok("delete", db.deleteUser("5000000000001"));
+        ok("delete invalidates", !cache.get("5000000000001", load));
+        db.close();
+    }
+    std::remove(db_path.c_str());
+
+    // -------- 6) Paralelna čitanja istih URN-ova --------
+    {
+        UserCache cache;
+        std::atomic<int> loads{0};
+        std::vector<std::thread> threads;
+        std::atomic<bool> all_found{true};
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < 2000; ++i) {
+                    const std::string urn = "60000000000" + std::to_string(10 + i % 50);
+                    auto u = cache.get(urn, [&] { loads++; return makeUser(urn); });
+                    if (!u || u->urn != urn) all_found = false;
+                    if (i % 500 == 0) cache.invalidate(urn);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        ok("concurrent reads consistent", all_found);
+        ok("most reads served from cache", loads < 8 * 2000 / 10);
+    }
+
+    std::cout << "All user cache tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include "common/VehicleStatus.h"
+#include "server/CentralServer.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+// Preskoči MULTICAST_UPDATE (AUTH prijavljuje i na njih) do sljedećeg VEHICLE_STATUS
+static std::unique_ptr<Message> nextStatus(TLSSocket& sock) {
+    for (int i = 0; i < 10; ++i) {
+        auto m = sock.receiveMessage();
+        if (!m || m->getType() == MessageType::VEHICLE_STATUS) return m;
+    }
+    return nullptr;
+}
+
+static bool request(TLSSocket& sock, const Message& m) {
+    if (!sock.sendMessage(m)) return false;
+    auto r = sock.receiveMessage();
+    return r && r->getType() == MessageType::RESPONSE_SUCCESS;
+}
+
+int main() {
+    std::remove("test_vehicle_status.db");
+    const int port = pick_port();
+    CentralServer server;
+    server.setDatabasePath("test_vehicle_status.db");
+    server.setCertificatePath("certs/server.crt", "certs/server.key");
+    ok("central server start", server.start(port, ""));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // -------- 1) Admin: dva vozila na ruti R_7 --------
+    TLSSocket admin;
+    ok("admin connect", admin.connect("127.0.0.1", port));
+    for (const std::string uri : {"bus://7", "bus://8"}) {
+        ok("register vehicle", request(admin, *MessageFactory::createRegisterDevice(uri, VehicleType::BUS)));
+        ok("route R_7", request(admin, *MessageFactory::createUpdateVehicle(uri, true, std::string("R_7"))));
+        ok("capacity", request(admin, *MessageFactory::createUpdateCapacity(uri, 10, 10)));
+    }
+
+    // -------- 2) Snapshot bez sesije; pretplata traži sesiju --------
+    TLSSocket client;
+    ok("client connect", client.connect("127.0.0.1", port));
+    client.sendMessage(*MessageFactory::createGetVehicleStatus("R_7"));
+    auto snap = nextStatus(client);
+    VehicleStatusView view;
+    ok("snapshot", snap && snap->getBool("full") && view.apply(*snap) && view.vehicles().size() == 2 &&
+                   view.vehicles().at("bus://7").available == 10);
+    const uint64_t v1 = view.version();
+
+    client.sendMessage(*MessageFactory::createGetVehicleStatus("R_7", 0, true, "no-such-session"));
+    auto denied = client.receiveMessage();
+    ok("subscribe needs a session", denied && denied->getType() == MessageType::RESPONSE_ERROR &&
+                                    denied->getInt("error_code") == 401);
+
+    const std::string urn = "7777777777777";
+    client.sendMessage(*MessageFactory::createRegisterUser(urn));
+    client.receiveMessage();
+    client.sendMessage(*MessageFactory::createAuthRequest(urn));
+    auto auth = client.receiveMessage();
+    ok("auth", auth && auth->getBool("success"));
+
+    // -------- 3) Ponovno spajanje: since = zadnja verzija -> prazna delta + pretplata --------
+    client.sendMessage(*MessageFactory::createGetVehicleStatus("R_7", v1, true, auth->getString("token")));
+    auto resumed = nextStatus(client);
+    ok("resume with no changes", resumed && !resumed->getBool("full") && view.apply(*resumed) &&
+                                 resumed->getBinary("vehicles").size() <= 1 && view.version() >= v1);
+
+    // -------- 4) Promjena jednog vozila -> delta za R_7 --------
+    // Prvi krug pushera može još nositi i ranije izmjene (duplikati), pa čekamo stanje
+    ok("capacity change", request(admin, *MessageFactory::createUpdateCapacity("bus://8", 10, 3)));
+    bool routed = true;
+    for (int i = 0; i < 5 && view.vehicles().at("bus://8").available != 3; ++i) {
+        auto delta = nextStatus(client);
+        if (!delta || delta->getBool("full") || delta->getString("routes") != "R_7") routed = false;
+        if (!delta || !view.apply(*delta)) break;
+    }
+    ok("pushed delta for route", routed && view.vehicles().at("bus://8").available == 3 &&
+                                 view.vehicles().at("bus://7").available == 10);
+
+    // Premještanje na drugu rutu -> brisanje iz R_7
+    ok("route change", request(admin, *MessageFactory::createUpdateVehicle("bus://7", {}, std::string("R_9"))));
+    for (int i = 0; i < 5 && view.vehicles().count("bus://7"); ++i) {
+        auto moved = nextStatus(client);
+        if (!moved || !view.apply(*moved)) break;
+    }
+    ok("removal delta", view.vehicles().size() == 1 && !view.vehicles().count("bus://7"));
+
+    client.close();
+    admin.close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    server.stop();
+    std::remove("test_vehicle_status.db");
+
+    std::cout << "Vehicle status test passed.\n";
+    return 0;
+}
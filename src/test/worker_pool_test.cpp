@@ -0,0 +1,117 @@
+#include "server/ServerBase.h"
+#include "common/Message.h"
+#include "common/TLSSocket.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace transport;
+
+static void ok(const char* what, bool cond) {
+    std::cout << (cond ? "[OK] " : "[FAIL] ") << what << std::endl;
+    if (!cond) std::abort();
+}
+
+static int pick_port() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(20000, 40000);
+    return dis(gen);
+}
+
+// Minimalni echo server: svaka poruka -> RESPONSE_SUCCESS sa istim client_id
+class EchoServer : public ServerBase {
+public:
+    EchoServer() : ServerBase("EchoServer") {}
+
+    bool start(int port, const std::string& /*config_file*/) override {
+        port_ = port;
+        running_ = true;
+        if (!startServer()) {
+            running_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    std::atomic<int> processed{0};
+    std::atomic<int> disconnected{0};
+
+protected:
+    void handleClientMessage(std::unique_ptr<TLSSocket> client,
+                             std::unique_ptr<Message> /*message*/) override {
+        // thread-per-connection mod (ovdje se ne koristi)
+        while (running_ && client) {
+            auto m = client->receiveMessage();
+            if (!m) break;
+            processMessage(std::move(m), client);
+        }
+    }
+
+    void processMessage(std::unique_ptr<Message> message,
+                        std::unique_ptr<TLSSocket>& client) override {
+        auto resp = MessageFactory::createSuccessResponse(
+            "echo", {{"client_id", message->getString("client_id")}});
+        client->sendMessage(*resp);
+        processed++;
+    }
+
+    void onClientDisconnected(TLSSocket* /*client*/) override { disconnected++; }
+};
+
+int main() {
+    const int kClients  = 16;
+    const int kMessages = 5;
+
+    EchoServer server;
+    ok("certificates", server.setCertificates("certs/server.crt", "certs/server.key"));
+    server.setWorkerPool(true, 2);
+
+    int port = pick_port();
+    ok("server start (worker pool)", server.start(port, ""));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Više konekcija od broja worker niti: sve moraju biti opslužene
+    std::atomic<int> echoed{0};
+    std::vector<std::thread> clients;
+    for (int i = 0; i < kClients; ++i) {
+        clients.emplace_back([&, i]() {
+            TLSSocket sock;
+            if (!sock.connect("127.0.0.1", port)) return;
+            const std::string id = "client-" + std::to_string(i);
+            for (int k = 0; k < kMessages; ++k) {
+                auto m = MessageFactory::createConnectRequest(id);
+                if (!sock.sendMessage(*m)) return;
+                auto r = sock.receiveMessage();
+                if (r && r->getType() == MessageType::RESPONSE_SUCCESS &&
+                    r->getString("client_id") == id) {
+                    echoed++;
+                }
+            }
+            sock.disconnect();
+        });
+    }
+    for (auto& t : clients) t.join();
+
+    ok("all messages echoed", echoed == kClients * kMessages);
+    ok("server processed all", server.processed == kClients * kMessages);
+
+    // Sesije se zatvaraju asinhrono nakon disconnect-a klijenta
+    for (int i = 0; i < 50 && server.getActiveConnections() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    ok("total connections", server.getTotalConnections() == kClients);
+    ok("no active connections", server.getActiveConnections() == 0);
+    ok("onClientDisconnected per session", server.disconnected == kClients);
+
+    server.stop();
+    ok("server stopped", !server.isRunning());
+
+    std::cout << "Worker pool test passed.\n";
+    return 0;
+}